@@ -462,6 +462,8 @@
         'callback_unittest.nc',
         'cancelable_callback_unittest.cc',
         'command_line_unittest.cc',
+        'containers/flat_hash_map_unittest.cc',
+        'containers/flat_hash_set_unittest.cc',
         'containers/hash_tables_unittest.cc',
         'containers/linked_list_unittest.cc',
         'containers/mru_cache_unittest.cc',
@@ -490,6 +492,7 @@
         'files/scoped_temp_dir_unittest.cc',
         'gmock_unittest.cc',
         'guid_unittest.cc',
+        'hash_unittest.cc',
         'id_map_unittest.cc',
         'i18n/break_iterator_unittest.cc',
         'i18n/char_iterator_unittest.cc',
@@ -534,6 +537,7 @@
         'memory/singleton_unittest.cc',
         'memory/weak_ptr_unittest.cc',
         'memory/weak_ptr_unittest.nc',
+        'message_loop/incoming_task_queue_unittest.cc',
         'message_loop/message_loop_proxy_impl_unittest.cc',
         'message_loop/message_loop_proxy_unittest.cc',
         'message_loop/message_loop_unittest.cc',
@@ -542,6 +546,7 @@
         'message_loop/message_pump_libevent_unittest.cc',
         'metrics/sample_map_unittest.cc',
         'metrics/sample_vector_unittest.cc',
+        'metrics/shared_histogram_allocator_unittest.cc',
         'metrics/bucket_ranges_unittest.cc',
         'metrics/field_trial_unittest.cc',
         'metrics/histogram_base_unittest.cc',
@@ -819,6 +824,26 @@
         }],
       ],  # target_conditions
     },
+    {
+      'target_name': 'base_perftests',
+      'type': '<(gtest_target_type)',
+      'dependencies': [
+        'base',
+        'test_support_base',
+        'test_support_perf',
+        '../testing/gtest.gyp:gtest',
+        '../testing/perf/perf_test.gyp:perf_test',
+      ],
+      'sources': [
+        'containers/flat_hash_map_perftest.cc',
+        'debug/trace_event_perftest.cc',
+        'hash_perftest.cc',
+        'json/json_perftest.cc',
+        'message_loop/message_loop_perftest.cc',
+        'threading/sequenced_worker_pool_perftest.cc',
+        'values_perftest.cc',
+      ],
+    },
     {
       'target_name': 'base_i18n_perftests',
       'type': '<(gtest_target_type)',
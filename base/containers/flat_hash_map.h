@@ -0,0 +1,99 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_MAP_H_
+#define BASE_CONTAINERS_FLAT_HASH_MAP_H_
+
+#include <functional>
+#include <utility>
+
+#include "base/containers/flat_hash_table.h"
+
+namespace base {
+
+namespace internal {
+
+template <typename Pair>
+struct SelectFirst {
+  const typename Pair::first_type& operator()(const Pair& pair) const {
+    return pair.first;
+  }
+};
+
+}  // namespace internal
+
+// An unordered map with open addressing, for hot maps where base::hash_map's
+// allocation per element and pointer chasing per lookup show up in profiles.
+// It takes the same key types and hash functions as base::hash_map and
+// supports the common subset of its interface:
+//
+//   base::FlatHashMap<int, std::string> names;
+//   names[1] = "one";
+//   base::FlatHashMap<int, std::string>::iterator it = names.find(1);
+//
+// Elements are stored inline in one array, so the differences from
+// base::hash_map are:
+//
+//  - Inserting can rehash, which moves every element and invalidates all
+//    iterators, pointers and references. Call reserve() up front if you need
+//    them to stay valid while inserting a known number of elements. Erasing
+//    only invalidates the erased element.
+//  - Key and mapped types are copied when the table grows, so they should be
+//    cheap to copy. Store a pointer (or use ScopedPtrHashMap) for large or
+//    non-copyable values.
+//  - Iteration visits every slot, so iterating a map that has shrunk a lot
+//    from erasing is slower than its size suggests.
+//
+// See base/containers/flat_hash_table.h for the table layout.
+template <typename Key,
+          typename Mapped,
+          typename Hash = internal::FlatHashDefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class FlatHashMap
+    : public internal::FlatHashTable<std::pair<const Key, Mapped>,
+                                     Key,
+                                     internal::SelectFirst<
+                                         std::pair<const Key, Mapped> >,
+                                     Hash,
+                                     KeyEqual> {
+ private:
+  typedef internal::FlatHashTable<
+      std::pair<const Key, Mapped>,
+      Key,
+      internal::SelectFirst<std::pair<const Key, Mapped> >,
+      Hash,
+      KeyEqual> Table;
+
+ public:
+  typedef Mapped mapped_type;
+  typedef typename Table::key_type key_type;
+  typedef typename Table::value_type value_type;
+  typedef typename Table::hasher hasher;
+  typedef typename Table::key_equal key_equal;
+
+  explicit FlatHashMap(const hasher& hash = hasher(),
+                       const key_equal& equal = key_equal())
+      : Table(hash, equal) {}
+
+  template <typename InputIterator>
+  FlatHashMap(InputIterator first, InputIterator last) {
+    this->insert(first, last);
+  }
+
+  mapped_type& operator[](const key_type& key) {
+    return this->FindOrInsert(key, DefaultConstructor())->second;
+  }
+
+ private:
+  // Builds the element operator[]() inserts for a missing key.
+  struct DefaultConstructor {
+    void operator()(void* slot, const key_type& key) const {
+      new (slot) value_type(key, mapped_type());
+    }
+  };
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_MAP_H_
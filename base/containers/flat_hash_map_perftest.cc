@@ -0,0 +1,133 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares FlatHashMap with base::hash_map and std::map on integer and string
+// keys, the two shapes of the hot maps in net and cc.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/containers/hash_tables.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace {
+
+const int kLookupRounds = 10;
+
+// Visits 0..count-1 in a scattered order, since looking keys up in insertion
+// order would favor node-based maps, whose nodes sit in allocation order.
+int Scatter(int i, int count) {
+  return static_cast<int>((static_cast<int64>(i) * 7919) % count);
+}
+
+void Report(const std::string& measurement,
+            const std::string& trace,
+            TimeTicks begin,
+            int operations) {
+  perf_test::PrintResult(
+      measurement, "", trace,
+      (TimeTicks::HighResNow() - begin).InMicroseconds() * 1000.0 / operations,
+      "ns/op", true);
+}
+
+template <typename Map, typename Key>
+void RunMapBench(const std::string& name,
+                 const std::vector<Key>& keys,
+                 const std::vector<Key>& missing_keys) {
+  const int num_keys = static_cast<int>(keys.size());
+  std::string trace = StringPrintf("%s_%d", name.c_str(), num_keys);
+
+  TimeTicks begin = TimeTicks::HighResNow();
+  Map map;
+  for (int i = 0; i < num_keys; ++i)
+    map[keys[i]] = i;
+  Report("map_insert", trace, begin, num_keys);
+
+  int sum = 0;
+  begin = TimeTicks::HighResNow();
+  for (int round = 0; round < kLookupRounds; ++round) {
+    for (int i = 0; i < num_keys; ++i)
+      sum += map.find(keys[Scatter(i, num_keys)])->second;
+  }
+  Report("map_find_hit", trace, begin, num_keys * kLookupRounds);
+  EXPECT_EQ(kLookupRounds * (num_keys * (num_keys - 1) / 2), sum);
+
+  int found = 0;
+  begin = TimeTicks::HighResNow();
+  for (int round = 0; round < kLookupRounds; ++round) {
+    for (int i = 0; i < num_keys; ++i)
+      found += map.count(missing_keys[Scatter(i, num_keys)]);
+  }
+  Report("map_find_miss", trace, begin, num_keys * kLookupRounds);
+  EXPECT_EQ(0, found);
+
+  begin = TimeTicks::HighResNow();
+  for (int round = 0; round < kLookupRounds; ++round) {
+    for (int i = 0; i < num_keys; ++i)
+      ++map[keys[Scatter(i, num_keys)]];
+  }
+  Report("map_subscript_hit", trace, begin, num_keys * kLookupRounds);
+  EXPECT_EQ(static_cast<size_t>(num_keys), map.size());
+
+  begin = TimeTicks::HighResNow();
+  for (int i = 0; i < num_keys; ++i)
+    map.erase(keys[Scatter(i, num_keys)]);
+  Report("map_erase", trace, begin, num_keys);
+  EXPECT_TRUE(map.empty());
+}
+
+void RunIntBench(int num_keys) {
+  // Spread out, like IDs and pointers, rather than dense.
+  std::vector<int> keys;
+  std::vector<int> missing_keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(i * 7919);
+    missing_keys.push_back(i * 7919 + 1);
+  }
+  RunMapBench<std::map<int, int> >("int_std_map", keys, missing_keys);
+  RunMapBench<hash_map<int, int> >("int_hash_map", keys, missing_keys);
+  RunMapBench<FlatHashMap<int, int> >("int_flat_hash_map", keys,
+                                      missing_keys);
+}
+
+void RunStringBench(int num_keys) {
+  std::vector<std::string> keys;
+  std::vector<std::string> missing_keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(StringPrintf("www.example%d.com:443", i));
+    missing_keys.push_back(StringPrintf("www.example%d.org:443", i));
+  }
+  RunMapBench<std::map<std::string, int> >("string_std_map", keys,
+                                           missing_keys);
+  RunMapBench<hash_map<std::string, int> >("string_hash_map", keys,
+                                           missing_keys);
+  RunMapBench<FlatHashMap<std::string, int> >("string_flat_hash_map", keys,
+                                              missing_keys);
+}
+
+TEST(FlatHashMapPerfTest, IntKeysSmall) {
+  RunIntBench(100);
+}
+
+TEST(FlatHashMapPerfTest, IntKeysLarge) {
+  RunIntBench(100000);
+}
+
+TEST(FlatHashMapPerfTest, StringKeysSmall) {
+  RunStringBench(100);
+}
+
+TEST(FlatHashMapPerfTest, StringKeysLarge) {
+  RunStringBench(100000);
+}
+
+}  // namespace
+}  // namespace base
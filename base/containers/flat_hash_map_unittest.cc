@@ -0,0 +1,216 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <map>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Counts live instances, to check that the table destroys what it builds.
+class Counted {
+ public:
+  Counted() : value_(0) { ++live_; }
+  explicit Counted(int value) : value_(value) { ++live_; }
+  Counted(const Counted& other) : value_(other.value_) { ++live_; }
+  ~Counted() { --live_; }
+
+  int value() const { return value_; }
+  static int live() { return live_; }
+
+ private:
+  int value_;
+  static int live_;
+};
+
+int Counted::live_ = 0;
+
+// Sends every key to the same group, so lookups have to probe.
+struct CollidingHash {
+  size_t operator()(int key) const { return 0; }
+};
+
+}  // namespace
+
+TEST(FlatHashMapTest, Basic) {
+  FlatHashMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(0u, map.size());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_TRUE(map.find(1) == map.end());
+  EXPECT_EQ(0u, map.erase(1));
+
+  map[1] = "one";
+  EXPECT_TRUE(map.insert(std::make_pair(2, std::string("two"))).second);
+  EXPECT_FALSE(map.insert(std::make_pair(2, std::string("deux"))).second);
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ("one", map[1]);
+  EXPECT_EQ("two", map.find(2)->second);
+  EXPECT_EQ(1u, map.count(2));
+  EXPECT_EQ(0u, map.count(3));
+
+  map.find(2)->second = "deux";
+  EXPECT_EQ("deux", map[2]);
+
+  EXPECT_EQ(1u, map.erase(1));
+  EXPECT_EQ(0u, map.erase(1));
+  EXPECT_EQ(1u, map.size());
+  EXPECT_TRUE(map.find(1) == map.end());
+
+  map.erase(map.find(2));
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+}
+
+// Checks the map against std::map through growth, erasure and reinsertion.
+TEST(FlatHashMapTest, MatchesStdMap) {
+  FlatHashMap<int, int> map;
+  std::map<int, int> expected;
+  for (int i = 0; i < 5000; ++i) {
+    map[i * 3] = i;
+    expected[i * 3] = i;
+  }
+  for (int i = 0; i < 5000; i += 2) {
+    EXPECT_EQ(1u, map.erase(i * 3));
+    expected.erase(i * 3);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    map[i * 5] = -i;
+    expected[i * 5] = -i;
+  }
+
+  EXPECT_EQ(expected.size(), map.size());
+  EXPECT_LE(map.load_factor(), map.max_load_factor());
+  std::map<int, int> contents;
+  for (FlatHashMap<int, int>::const_iterator it = map.begin();
+       it != map.end(); ++it) {
+    EXPECT_TRUE(contents.insert(*it).second);
+  }
+  EXPECT_TRUE(expected == contents);
+  for (int i = 0; i < 15000; ++i)
+    EXPECT_EQ(expected.count(i), map.count(i)) << i;
+}
+
+TEST(FlatHashMapTest, Collisions) {
+  FlatHashMap<int, int, CollidingHash> map;
+  for (int i = 0; i < 100; ++i)
+    map[i] = i * i;
+  for (int i = 0; i < 100; i += 3)
+    map.erase(i);
+  for (int i = 0; i < 100; ++i) {
+    FlatHashMap<int, int, CollidingHash>::iterator it = map.find(i);
+    if (i % 3 == 0) {
+      EXPECT_TRUE(it == map.end());
+    } else {
+      ASSERT_TRUE(it != map.end());
+      EXPECT_EQ(i * i, it->second);
+    }
+  }
+}
+
+// Erasing and inserting the same number of keys over and over leaves
+// tombstones behind, which must not make the table grow forever or loop.
+TEST(FlatHashMapTest, ChurnDoesNotGrow) {
+  FlatHashMap<int, int> map;
+  for (int i = 0; i < 100; ++i)
+    map[i] = i;
+  size_t bucket_count = map.bucket_count();
+  for (int i = 100; i < 100000; ++i) {
+    map.erase(i - 100);
+    map[i] = i;
+  }
+  EXPECT_EQ(100u, map.size());
+  EXPECT_EQ(bucket_count, map.bucket_count());
+  for (int i = 100000 - 100; i < 100000; ++i)
+    EXPECT_EQ(i, map[i]);
+}
+
+TEST(FlatHashMapTest, StringKeys) {
+  FlatHashMap<std::string, int> map;
+  for (int i = 0; i < 1000; ++i)
+    map[IntToString(i)] = i;
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(i, map[IntToString(i)]);
+  EXPECT_TRUE(map.find("1000") == map.end());
+}
+
+TEST(FlatHashMapTest, Reserve) {
+  FlatHashMap<int, int> map;
+  map.reserve(1000);
+  size_t bucket_count = map.bucket_count();
+  EXPECT_GE(bucket_count * map.max_load_factor(), 1000u);
+
+  map[0] = 0;
+  int* first = &map[0];
+  for (int i = 1; i < 1000; ++i)
+    map[i] = i;
+  // Nothing moved, since the table didn't grow.
+  EXPECT_EQ(bucket_count, map.bucket_count());
+  EXPECT_EQ(first, &map[0]);
+}
+
+TEST(FlatHashMapTest, MaxLoadFactor) {
+  FlatHashMap<int, int> dense;
+  dense.max_load_factor(0.95f);
+  FlatHashMap<int, int> sparse;
+  sparse.max_load_factor(0.25f);
+  for (int i = 0; i < 1000; ++i) {
+    dense[i] = i;
+    sparse[i] = i;
+  }
+  EXPECT_LE(dense.load_factor(), 0.95f);
+  EXPECT_LE(sparse.load_factor(), 0.25f);
+  EXPECT_LT(dense.bucket_count(), sparse.bucket_count());
+}
+
+TEST(FlatHashMapTest, CopyAndSwap) {
+  FlatHashMap<int, std::string> map;
+  for (int i = 0; i < 100; ++i)
+    map[i] = IntToString(i);
+
+  FlatHashMap<int, std::string> copy(map);
+  map[0] = "changed";
+  EXPECT_EQ(100u, copy.size());
+  EXPECT_EQ("0", copy[0]);
+
+  FlatHashMap<int, std::string> other;
+  other[1000] = "1000";
+  other = copy;
+  EXPECT_EQ(100u, other.size());
+  EXPECT_TRUE(other.find(1000) == other.end());
+
+  FlatHashMap<int, std::string> empty;
+  empty.swap(other);
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(100u, empty.size());
+  EXPECT_EQ("99", empty[99]);
+}
+
+TEST(FlatHashMapTest, DestroysValues) {
+  {
+    FlatHashMap<int, Counted> map;
+    for (int i = 0; i < 100; ++i)
+      map[i] = Counted(i);
+    EXPECT_EQ(100, Counted::live());
+    for (int i = 0; i < 50; ++i)
+      map.erase(i);
+    EXPECT_EQ(50, Counted::live());
+    EXPECT_EQ(75, map[75].value());
+
+    FlatHashMap<int, Counted> copy(map);
+    EXPECT_EQ(100, Counted::live());
+    copy.clear();
+    EXPECT_EQ(50, Counted::live());
+  }
+  EXPECT_EQ(0, Counted::live());
+}
+
+}  // namespace base
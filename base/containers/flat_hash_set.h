@@ -0,0 +1,70 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_SET_H_
+#define BASE_CONTAINERS_FLAT_HASH_SET_H_
+
+#include <functional>
+
+#include "base/containers/flat_hash_table.h"
+
+namespace base {
+
+namespace internal {
+
+template <typename Key>
+struct Identity {
+  const Key& operator()(const Key& key) const { return key; }
+};
+
+}  // namespace internal
+
+// The set counterpart of FlatHashMap; see base/containers/flat_hash_map.h for
+// when to use it and how it differs from base::hash_set.
+template <typename Key,
+          typename Hash = internal::FlatHashDefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class FlatHashSet
+    : public internal::FlatHashTable<Key, Key, internal::Identity<Key>, Hash,
+                                     KeyEqual> {
+ private:
+  typedef internal::FlatHashTable<Key, Key, internal::Identity<Key>, Hash,
+                                  KeyEqual> Table;
+
+ public:
+  typedef typename Table::hasher hasher;
+  typedef typename Table::key_equal key_equal;
+
+  // Elements of a set can't be modified in place, since that could change
+  // their hash.
+  typedef typename Table::const_iterator iterator;
+  typedef typename Table::const_iterator const_iterator;
+
+  explicit FlatHashSet(const hasher& hash = hasher(),
+                       const key_equal& equal = key_equal())
+      : Table(hash, equal) {}
+
+  template <typename InputIterator>
+  FlatHashSet(InputIterator first, InputIterator last) {
+    this->insert(first, last);
+  }
+
+  iterator begin() const { return Table::begin(); }
+  iterator end() const { return Table::end(); }
+  iterator find(const Key& key) const { return Table::find(key); }
+
+  std::pair<iterator, bool> insert(const Key& key) {
+    std::pair<typename Table::iterator, bool> result = Table::insert(key);
+    return std::make_pair(iterator(result.first), result.second);
+  }
+
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    Table::insert(first, last);
+  }
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_SET_H_
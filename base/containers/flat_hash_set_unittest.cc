@@ -0,0 +1,42 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_set.h"
+
+#include <set>
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(FlatHashSetTest, Basic) {
+  FlatHashSet<std::string> set;
+  EXPECT_TRUE(set.insert("a").second);
+  EXPECT_TRUE(set.insert("b").second);
+  EXPECT_FALSE(set.insert("a").second);
+  EXPECT_EQ(2u, set.size());
+  EXPECT_EQ("a", *set.find("a"));
+  EXPECT_TRUE(set.find("c") == set.end());
+
+  std::set<std::string> contents(set.begin(), set.end());
+  EXPECT_EQ(2u, contents.size());
+  EXPECT_EQ(1u, contents.count("b"));
+
+  set.erase(set.find("a"));
+  EXPECT_EQ(0u, set.count("a"));
+  EXPECT_EQ(1u, set.erase("b"));
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(FlatHashSetTest, RangeConstructor) {
+  const int kValues[] = { 3, 1, 4, 1, 5, 9, 2, 6 };
+  FlatHashSet<int> set(kValues, kValues + arraysize(kValues));
+  EXPECT_EQ(7u, set.size());
+  for (size_t i = 0; i < arraysize(kValues); ++i)
+    EXPECT_EQ(1u, set.count(kValues[i]));
+  EXPECT_EQ(0u, set.count(7));
+}
+
+}  // namespace base
@@ -0,0 +1,640 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_TABLE_H_
+#define BASE_CONTAINERS_FLAT_HASH_TABLE_H_
+
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/logging.h"
+#include "base/sys_byteorder.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include <emmintrin.h>
+#endif
+
+namespace base {
+namespace internal {
+
+// The default hash function, which accepts the same key types as
+// base::hash_map.
+#if defined(COMPILER_MSVC)
+template <typename Key>
+struct FlatHashDefaultHash : public std::hash<Key> {};
+#else
+template <typename Key>
+struct FlatHashDefaultHash : public BASE_HASH_NAMESPACE::hash<Key> {};
+#endif
+
+// The open-addressing hash table behind FlatHashMap and FlatHashSet. Use
+// those instead of this class.
+//
+// LAYOUT
+// ------
+//
+// Elements live in one array of |capacity_| slots, with no per-element
+// allocation. A parallel array holds one control byte per slot:
+//
+//   kEmpty    the slot has never been used since the last rehash,
+//   kDeleted  the slot held an element that was erased (a tombstone),
+//   0..127    the slot is full, and the byte is 7 bits of the element's hash.
+//
+// The slots are split into groups of kGroupWidth. A lookup hashes the key to
+// a group and compares the 7 hash bits against all the control bytes of the
+// group at once, with SSE2 on x86-64 and with word-sized bit tricks elsewhere,
+// so it only touches the slots whose bits match. If the group has no match and no
+// empty slot, the lookup moves on to the next group in a triangular probe
+// sequence, which visits every group because the number of groups is a power
+// of two. A group with an empty slot ends the search, since an insert would
+// have used that slot.
+//
+// The control byte array has one extra trailing kSentinel byte, which stops
+// iteration.
+//
+// KeyOfValue is a functor returning the key of a stored value.
+template <typename Value, typename Key, typename KeyOfValue, typename Hash,
+          typename KeyEqual>
+class FlatHashTable {
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+  template <typename T>
+  class IteratorBase
+      : public std::iterator<std::forward_iterator_tag, T> {
+   public:
+    IteratorBase() : ctrl_(NULL), slot_(NULL) {}
+
+    // Allows converting an iterator to a const_iterator, but not back.
+    template <typename U>
+    IteratorBase(const IteratorBase<U>& other)
+        : ctrl_(other.ctrl_), slot_(other.slot_) {}
+
+    T& operator*() const { return *slot_; }
+    T* operator->() const { return slot_; }
+
+    IteratorBase& operator++() {
+      ++ctrl_;
+      ++slot_;
+      SkipEmptyOrDeleted();
+      return *this;
+    }
+    IteratorBase operator++(int) {
+      IteratorBase result(*this);
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const IteratorBase& other) const {
+      return ctrl_ == other.ctrl_;
+    }
+    bool operator!=(const IteratorBase& other) const {
+      return ctrl_ != other.ctrl_;
+    }
+
+   private:
+    friend class FlatHashTable;
+    template <typename U> friend class IteratorBase;
+
+    IteratorBase(const int8* ctrl, T* slot) : ctrl_(ctrl), slot_(slot) {}
+
+    void SkipEmptyOrDeleted() {
+      while (*ctrl_ < kSentinel) {
+        ++ctrl_;
+        ++slot_;
+      }
+      if (*ctrl_ == kSentinel) {
+        ctrl_ = NULL;
+        slot_ = NULL;
+      }
+    }
+
+    // Both are NULL for end().
+    const int8* ctrl_;
+    T* slot_;
+  };
+
+  class const_iterator;
+
+  class iterator : public IteratorBase<value_type> {
+   public:
+    iterator() {}
+
+   private:
+    friend class FlatHashTable;
+
+    iterator(const IteratorBase<value_type>& base)
+        : IteratorBase<value_type>(base) {}
+  };
+
+  class const_iterator : public IteratorBase<const value_type> {
+   public:
+    const_iterator() {}
+    const_iterator(const iterator& other)
+        : IteratorBase<const value_type>(other) {}
+
+   private:
+    friend class FlatHashTable;
+
+    const_iterator(const IteratorBase<const value_type>& base)
+        : IteratorBase<const value_type>(base) {}
+  };
+
+  explicit FlatHashTable(const hasher& hash = hasher(),
+                         const key_equal& equal = key_equal())
+      : ctrl_(NULL),
+        slots_(NULL),
+        capacity_(0),
+        size_(0),
+        growth_left_(0),
+        max_load_factor_(0.875f),
+        hash_(hash),
+        equal_(equal) {
+  }
+
+  FlatHashTable(const FlatHashTable& other)
+      : ctrl_(NULL),
+        slots_(NULL),
+        capacity_(0),
+        size_(0),
+        growth_left_(0),
+        max_load_factor_(other.max_load_factor_),
+        hash_(other.hash_),
+        equal_(other.equal_) {
+    reserve(other.size());
+    for (const_iterator it = other.begin(); it != other.end(); ++it)
+      InsertUnique(*it);
+  }
+
+  ~FlatHashTable() {
+    DestroyAndDeallocate();
+  }
+
+  FlatHashTable& operator=(const FlatHashTable& other) {
+    if (this != &other) {
+      FlatHashTable copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  iterator begin() {
+    if (!size_)
+      return end();
+    IteratorBase<value_type> it(ctrl_, slots_);
+    it.SkipEmptyOrDeleted();
+    return it;
+  }
+  iterator end() { return iterator(); }
+
+  const_iterator begin() const {
+    if (!size_)
+      return end();
+    IteratorBase<const value_type> it(ctrl_, slots_);
+    it.SkipEmptyOrDeleted();
+    return it;
+  }
+  const_iterator end() const { return const_iterator(); }
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+  size_type max_size() const {
+    return std::allocator<value_type>().max_size();
+  }
+
+  // The number of slots, which is a power of two (or 0).
+  size_type bucket_count() const { return capacity_; }
+
+  float load_factor() const {
+    return capacity_ ? static_cast<float>(size_) / capacity_ : 0.0f;
+  }
+  float max_load_factor() const { return max_load_factor_; }
+
+  // Sets how full the table may get before it grows. Higher values save
+  // memory at the cost of longer probe sequences; the default keeps lookups
+  // within a group or two. Takes effect at the next rehash.
+  void max_load_factor(float factor) {
+    DCHECK_GT(factor, 0.0f);
+    DCHECK_LT(factor, 1.0f);
+    max_load_factor_ = factor;
+  }
+
+  // Makes room for |count| elements without further rehashing.
+  void reserve(size_type count) {
+    if (count > size_ + growth_left_)
+      Rehash(CapacityFor(count));
+  }
+
+  void clear() {
+    DestroyAndDeallocate();
+    ctrl_ = NULL;
+    slots_ = NULL;
+    capacity_ = 0;
+    size_ = 0;
+    growth_left_ = 0;
+  }
+
+  void swap(FlatHashTable& other) {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(max_load_factor_, other.max_load_factor_);
+    std::swap(hash_, other.hash_);
+    std::swap(equal_, other.equal_);
+  }
+
+  iterator find(const key_type& key) {
+    size_t index;
+    if (!Find(key, &index))
+      return end();
+    return iterator(IteratorBase<value_type>(ctrl_ + index, slots_ + index));
+  }
+
+  const_iterator find(const key_type& key) const {
+    size_t index;
+    if (!Find(key, &index))
+      return end();
+    return const_iterator(
+        IteratorBase<const value_type>(ctrl_ + index, slots_ + index));
+  }
+
+  size_type count(const key_type& key) const {
+    size_t index;
+    return Find(key, &index) ? 1 : 0;
+  }
+
+  // Inserts |value| unless an element with the same key exists. Like every
+  // insertion, this invalidates all iterators, pointers and references when
+  // the table grows.
+  std::pair<iterator, bool> insert(const value_type& value) {
+    size_t index;
+    bool inserted = FindOrPrepareInsert(KeyOfValue()(value), &index);
+    if (inserted) {
+      new (slots_ + index) value_type(value);
+      ++size_;
+    }
+    return std::make_pair(
+        iterator(IteratorBase<value_type>(ctrl_ + index, slots_ + index)),
+        inserted);
+  }
+
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+
+  // Erasing never moves other elements, so it only invalidates iterators,
+  // pointers and references to the erased element.
+  void erase(const_iterator position) {
+    DCHECK(position != end());
+    EraseAt(position.ctrl_ - ctrl_);
+  }
+  void erase(iterator position) {
+    erase(const_iterator(position));
+  }
+
+  size_type erase(const key_type& key) {
+    size_t index;
+    if (!Find(key, &index))
+      return 0;
+    EraseAt(index);
+    return 1;
+  }
+
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return equal_; }
+
+ protected:
+  // Returns the element with |key|. If there is none, |construct| is called
+  // with the uninitialized slot and |key| to build it in place, so nothing is
+  // constructed when the key is already present.
+  template <typename Constructor>
+  value_type* FindOrInsert(const key_type& key, const Constructor& construct) {
+    size_t index;
+    if (FindOrPrepareInsert(key, &index)) {
+      construct(static_cast<void*>(slots_ + index), key);
+      ++size_;
+    }
+    return slots_ + index;
+  }
+
+ private:
+  // Control byte values. Full slots hold a value in [0, 127].
+  static const int8 kEmpty = -128;
+  static const int8 kDeleted = -2;
+  static const int8 kSentinel = -1;
+
+#if defined(ARCH_CPU_X86_64)
+  // SSE2 is always available on x86-64, and compares 16 bytes at once.
+  static const size_t kGroupWidth = 16;
+  static const size_t kBitsPerSlot = 1;
+#else
+  static const size_t kGroupWidth = 8;
+  static const size_t kBitsPerSlot = 8;
+  static const uint64 kLsbs = GG_UINT64_C(0x0101010101010101);
+  static const uint64 kMsbs = GG_UINT64_C(0x8080808080808080);
+#endif
+
+  // A bitmask with kBitsPerSlot bits per slot of a group, where the lowest
+  // bit of a slot is set if the slot matches.
+  class GroupMask {
+   public:
+    explicit GroupMask(uint64 mask) : mask_(mask) {}
+
+    bool empty() const { return !mask_; }
+
+    // Returns the index within the group of the lowest match and removes it.
+    size_t PopLowest() {
+      size_t index = CountTrailingZeros(mask_) / kBitsPerSlot;
+      mask_ &= mask_ - 1;
+      return index;
+    }
+
+   private:
+    static size_t CountTrailingZeros(uint64 x) {
+      DCHECK(x);
+#if defined(COMPILER_GCC)
+      return __builtin_ctzll(x);
+#else
+      size_t count = 0;
+      while (!(x & 1)) {
+        x >>= 1;
+        ++count;
+      }
+      return count;
+#endif
+    }
+
+    uint64 mask_;
+  };
+
+#if defined(ARCH_CPU_X86_64)
+  // The control bytes of one group in an SSE2 register.
+  class Group {
+   public:
+    explicit Group(const int8* ctrl)
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    // Full bytes equal to |h2|.
+    GroupMask Match(int8 h2) const {
+      return ToMask(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+    }
+
+    GroupMask MatchEmpty() const {
+      return ToMask(_mm_cmpeq_epi8(_mm_set1_epi8(kEmpty), ctrl_));
+    }
+
+    // kEmpty and kDeleted are the values below kSentinel.
+    GroupMask MatchEmptyOrDeleted() const {
+      return ToMask(_mm_cmpgt_epi8(_mm_set1_epi8(kSentinel), ctrl_));
+    }
+
+   private:
+    static GroupMask ToMask(__m128i bytes) {
+      return GroupMask(static_cast<uint16>(_mm_movemask_epi8(bytes)));
+    }
+
+    __m128i ctrl_;
+  };
+#else
+  // The control bytes of one group, loaded into a word so byte i of the group
+  // is byte i of the little-endian value. The matches are computed with bit
+  // tricks on the whole word, and each sets the high bit of its byte.
+  class Group {
+   public:
+    explicit Group(const int8* ctrl) {
+      memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+      ctrl_ = ByteSwapToLE64(ctrl_);
+    }
+
+    // Full bytes equal to |h2|. This can report false positives for a byte
+    // right after a true match, which the key comparison weeds out.
+    GroupMask Match(int8 h2) const {
+      uint64 x = ctrl_ ^ (kLsbs * static_cast<uint8>(h2));
+      return ToMask((x - kLsbs) & ~x & kMsbs);
+    }
+
+    // kEmpty is the only value with the high bit set and bit 1 clear.
+    GroupMask MatchEmpty() const {
+      return ToMask(ctrl_ & (~ctrl_ << 6) & kMsbs);
+    }
+
+    // kEmpty and kDeleted are the values with the high bit set and bit 0
+    // clear.
+    GroupMask MatchEmptyOrDeleted() const {
+      return ToMask(ctrl_ & ~(ctrl_ << 7) & kMsbs);
+    }
+
+   private:
+    // Moves the high bit of each byte down to the lowest bit of the byte.
+    static GroupMask ToMask(uint64 high_bits) {
+      return GroupMask(high_bits >> 7);
+    }
+
+    uint64 ctrl_;
+  };
+#endif
+
+  // Walks the groups in triangular order: g, g + 1, g + 3, g + 6, ...
+  class ProbeSequence {
+   public:
+    ProbeSequence(size_t hash, size_t num_groups)
+        : mask_(num_groups - 1), group_(hash & mask_), step_(0) {}
+
+    // The index of the first slot of the current group.
+    size_t offset() const { return group_ * kGroupWidth; }
+
+    void Next() {
+      ++step_;
+      group_ = (group_ + step_) & mask_;
+      DCHECK_LE(step_, mask_);
+    }
+
+   private:
+    size_t mask_;
+    size_t group_;
+    size_t step_;
+  };
+
+  // Spreads the bits of the user's hash, which is often the identity for
+  // integers, over the whole word. The top 7 bits become the control byte and
+  // the rest pick the group.
+  size_t MixedHash(const key_type& key) const {
+    uint64 hash = static_cast<uint64>(hash_(key)) *
+        GG_UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<size_t>(hash ^ (hash >> 32));
+  }
+  static int8 H2(size_t hash) {
+    return static_cast<int8>(hash >> (sizeof(size_t) * 8 - 7));
+  }
+  static size_t H1(size_t hash) { return hash; }
+
+  size_t num_groups() const { return capacity_ / kGroupWidth; }
+
+  // The smallest power-of-two capacity that holds |count| elements within
+  // the load factor.
+  size_t CapacityFor(size_t count) const {
+    size_t capacity = kGroupWidth;
+    while (count > MaxElementsFor(capacity))
+      capacity *= 2;
+    return capacity;
+  }
+  size_t MaxElementsFor(size_t capacity) const {
+    // Always leave one empty slot, which ends unsuccessful searches.
+    size_t max_elements = static_cast<size_t>(capacity * max_load_factor_);
+    return std::min(max_elements, capacity - 1);
+  }
+
+  bool Find(const key_type& key, size_t* index) const {
+    return size_ && Find(key, MixedHash(key), index);
+  }
+
+  bool Find(const key_type& key, size_t hash, size_t* index) const {
+    int8 h2 = H2(hash);
+    ProbeSequence seq(H1(hash), num_groups());
+    while (true) {
+      Group group(ctrl_ + seq.offset());
+      GroupMask match = group.Match(h2);
+      while (!match.empty()) {
+        size_t i = seq.offset() + match.PopLowest();
+        if (ctrl_[i] == h2 && equal_(KeyOfValue()(slots_[i]), key)) {
+          *index = i;
+          return true;
+        }
+      }
+      if (!group.MatchEmpty().empty())
+        return false;
+      seq.Next();
+    }
+  }
+
+  // Returns the first empty or deleted slot on the probe sequence of |hash|.
+  size_t FindFirstNonFull(size_t hash) const {
+    ProbeSequence seq(H1(hash), num_groups());
+    while (true) {
+      GroupMask mask = Group(ctrl_ + seq.offset()).MatchEmptyOrDeleted();
+      if (!mask.empty())
+        return seq.offset() + mask.PopLowest();
+      seq.Next();
+    }
+  }
+
+  // Sets |*index| to the slot holding |key| and returns false, or claims a
+  // slot for a new element with |key|, sets |*index| to it and returns true.
+  // The caller must construct the element and increment |size_|.
+  bool FindOrPrepareInsert(const key_type& key, size_t* index) {
+    size_t hash = MixedHash(key);
+    if (size_ && Find(key, hash, index))
+      return false;
+    size_t target = capacity_ ? FindFirstNonFull(hash) : 0;
+    if (!capacity_ || (!growth_left_ && ctrl_[target] == kEmpty)) {
+      // Rehashing also drops the tombstones, so only grow if the live
+      // elements need the room.
+      Rehash(CapacityFor(size_ + 1));
+      target = FindFirstNonFull(hash);
+    }
+    if (ctrl_[target] == kEmpty)
+      --growth_left_;
+    ctrl_[target] = H2(hash);
+    *index = target;
+    return true;
+  }
+
+  // Inserts a value whose key is known not to be present, into a table with
+  // room for it.
+  void InsertUnique(const value_type& value) {
+    size_t hash = MixedHash(KeyOfValue()(value));
+    size_t target = FindFirstNonFull(hash);
+    DCHECK(ctrl_[target] == kEmpty);
+    DCHECK_GT(growth_left_, 0u);
+    --growth_left_;
+    ctrl_[target] = H2(hash);
+    new (slots_ + target) value_type(value);
+    ++size_;
+  }
+
+  void EraseAt(size_t index) {
+    DCHECK_GE(ctrl_[index], 0);
+    slots_[index].~value_type();
+    --size_;
+    // If the group still has an empty slot, every search reaching this group
+    // stops here anyway, so the slot can go back to empty instead of becoming
+    // a tombstone.
+    size_t group_offset = index & ~(kGroupWidth - 1);
+    if (!Group(ctrl_ + group_offset).MatchEmpty().empty()) {
+      ctrl_[index] = kEmpty;
+      ++growth_left_;
+    } else {
+      ctrl_[index] = kDeleted;
+    }
+  }
+
+  void Rehash(size_t new_capacity) {
+    DCHECK_GE(new_capacity, CapacityFor(size_));
+    int8* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    size_t old_capacity = capacity_;
+
+    ctrl_ = new int8[new_capacity + 1];
+    memset(ctrl_, kEmpty, new_capacity);
+    ctrl_[new_capacity] = kSentinel;
+    slots_ = std::allocator<value_type>().allocate(new_capacity);
+    capacity_ = new_capacity;
+    size_ = 0;
+    growth_left_ = MaxElementsFor(new_capacity);
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] >= 0) {
+        InsertUnique(old_slots[i]);
+        old_slots[i].~value_type();
+      }
+    }
+    if (old_ctrl) {
+      delete[] old_ctrl;
+      std::allocator<value_type>().deallocate(old_slots, old_capacity);
+    }
+  }
+
+  void DestroyAndDeallocate() {
+    if (!ctrl_)
+      return;
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0)
+        slots_[i].~value_type();
+    }
+    delete[] ctrl_;
+    std::allocator<value_type>().deallocate(slots_, capacity_);
+  }
+
+  int8* ctrl_;
+  value_type* slots_;
+  size_t capacity_;
+  size_t size_;
+  // How many more elements can go into empty slots before a rehash.
+  size_t growth_left_;
+  float max_load_factor_;
+  hasher hash_;
+  key_equal equal_;
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_TABLE_H_
@@ -0,0 +1,412 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/trace_event_binary.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/debug/trace_event.h"
+#include "base/debug/trace_event_impl.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+const char kMagic[] = "TRCB";
+const size_t kMagicLength = arraysize(kMagic) - 1;
+const unsigned char kVersion = 1;
+
+const char kStringRecord = 'S';
+const char kEventRecord = 'E';
+
+void AppendVarint(uint64 value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendSignedVarint(int64 value, std::string* out) {
+  // Zigzag encoding keeps small negative numbers short.
+  AppendVarint((static_cast<uint64>(value) << 1) ^
+                   static_cast<uint64>(value >> 63),
+               out);
+}
+
+void AppendBytes(const char* data, size_t length, std::string* out) {
+  AppendVarint(length, out);
+  out->append(data, length);
+}
+
+void AppendValue(unsigned char type,
+                 TraceEvent::TraceValue value,
+                 std::string* out) {
+  switch (type) {
+    case TRACE_VALUE_TYPE_BOOL:
+      out->push_back(value.as_bool ? 1 : 0);
+      break;
+    case TRACE_VALUE_TYPE_UINT:
+      AppendVarint(value.as_uint, out);
+      break;
+    case TRACE_VALUE_TYPE_INT:
+      AppendSignedVarint(value.as_int, out);
+      break;
+    case TRACE_VALUE_TYPE_DOUBLE: {
+      uint64 bits;
+      memcpy(&bits, &value.as_double, sizeof(bits));
+      for (size_t i = 0; i < sizeof(bits); ++i)
+        out->push_back(static_cast<char>(bits >> (8 * i)));
+      break;
+    }
+    case TRACE_VALUE_TYPE_POINTER:
+      AppendVarint(reinterpret_cast<uintptr_t>(value.as_pointer), out);
+      break;
+    case TRACE_VALUE_TYPE_STRING:
+    case TRACE_VALUE_TYPE_COPY_STRING: {
+      // Matches what TraceEvent::AppendValueAsJSON() prints for NULL.
+      const char* str = value.as_string ? value.as_string : "NULL";
+      AppendBytes(str, strlen(str), out);
+      break;
+    }
+    default:
+      NOTREACHED() << "Don't know how to encode this value";
+      break;
+  }
+}
+
+// Reads the records written by TraceEventBinaryWriter. Every method returns
+// false once the input is exhausted or malformed.
+class BinaryReader {
+ public:
+  explicit BinaryReader(const std::string& data) : data_(data), pos_(0) {}
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+  bool ReadByte(unsigned char* value) {
+    if (pos_ >= data_.size())
+      return false;
+    *value = static_cast<unsigned char>(data_[pos_++]);
+    return true;
+  }
+
+  bool ReadVarint(uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      unsigned char byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64* value) {
+    uint64 zigzag;
+    if (!ReadVarint(&zigzag))
+      return false;
+    *value = static_cast<int64>(zigzag >> 1) ^ -static_cast<int64>(zigzag & 1);
+    return true;
+  }
+
+  bool ReadBytes(std::string* value) {
+    uint64 length;
+    if (!ReadVarint(&length) || length > data_.size() - pos_)
+      return false;
+    value->assign(data_, pos_, static_cast<size_t>(length));
+    pos_ += static_cast<size_t>(length);
+    return true;
+  }
+
+  bool ReadMagic() {
+    if (data_.compare(pos_, kMagicLength, kMagic) != 0)
+      return false;
+    pos_ += kMagicLength;
+    return true;
+  }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryReader);
+};
+
+// Holds a convertable argument as the JSON it was rendered to when the trace
+// was written.
+class RenderedConvertable : public ConvertableToTraceFormat {
+ public:
+  explicit RenderedConvertable(const std::string& json) : json_(json) {}
+
+  virtual void AppendAsTraceFormat(std::string* out) const OVERRIDE {
+    out->append(json_);
+  }
+
+ private:
+  virtual ~RenderedConvertable() {}
+
+  std::string json_;
+
+  DISALLOW_COPY_AND_ASSIGN(RenderedConvertable);
+};
+
+bool ReadValue(BinaryReader* reader,
+               unsigned char type,
+               std::string* string_storage,
+               scoped_refptr<ConvertableToTraceFormat>* convertable,
+               unsigned long long* arg_value) {
+  TraceEvent::TraceValue value;
+  value.as_uint = 0;
+  switch (type) {
+    case TRACE_VALUE_TYPE_BOOL: {
+      unsigned char byte;
+      if (!reader->ReadByte(&byte))
+        return false;
+      value.as_bool = byte != 0;
+      break;
+    }
+    case TRACE_VALUE_TYPE_UINT: {
+      uint64 uint_value;
+      if (!reader->ReadVarint(&uint_value))
+        return false;
+      value.as_uint = uint_value;
+      break;
+    }
+    case TRACE_VALUE_TYPE_INT: {
+      int64 int_value;
+      if (!reader->ReadSignedVarint(&int_value))
+        return false;
+      value.as_int = int_value;
+      break;
+    }
+    case TRACE_VALUE_TYPE_DOUBLE: {
+      uint64 bits = 0;
+      for (size_t i = 0; i < sizeof(bits); ++i) {
+        unsigned char byte;
+        if (!reader->ReadByte(&byte))
+          return false;
+        bits |= static_cast<uint64>(byte) << (8 * i);
+      }
+      memcpy(&value.as_double, &bits, sizeof(bits));
+      break;
+    }
+    case TRACE_VALUE_TYPE_POINTER: {
+      uint64 pointer;
+      if (!reader->ReadVarint(&pointer))
+        return false;
+      value.as_pointer =
+          reinterpret_cast<const void*>(static_cast<uintptr_t>(pointer));
+      break;
+    }
+    case TRACE_VALUE_TYPE_STRING:
+    case TRACE_VALUE_TYPE_COPY_STRING:
+      if (!reader->ReadBytes(string_storage))
+        return false;
+      value.as_string = string_storage->c_str();
+      break;
+    case TRACE_VALUE_TYPE_CONVERTABLE: {
+      std::string json;
+      if (!reader->ReadBytes(&json))
+        return false;
+      *convertable = new RenderedConvertable(json);
+      break;
+    }
+    default:
+      return false;
+  }
+  *arg_value = value.as_uint;
+  return true;
+}
+
+bool ReadStringId(BinaryReader* reader,
+                  const std::vector<std::string>& strings,
+                  const char** str) {
+  uint64 id;
+  if (!reader->ReadVarint(&id) || id >= strings.size())
+    return false;
+  *str = strings[static_cast<size_t>(id)].c_str();
+  return true;
+}
+
+}  // namespace
+
+TraceEventBinaryWriter::TraceEventBinaryWriter(int process_id)
+    : process_id_(process_id) {
+}
+
+TraceEventBinaryWriter::~TraceEventBinaryWriter() {
+}
+
+void TraceEventBinaryWriter::AppendHeader(std::string* out) const {
+  out->append(kMagic, kMagicLength);
+  out->push_back(kVersion);
+  AppendSignedVarint(process_id_, out);
+}
+
+void TraceEventBinaryWriter::AppendEvent(const TraceEvent& event,
+                                         std::string* out) {
+  // All strings are defined before the event record that refers to them.
+  uint32 category_id = InternString(
+      TraceLog::GetCategoryGroupName(event.category_group_enabled_), out);
+  uint32 name_id = InternString(event.name_, out);
+  int num_args = 0;
+  uint32 arg_name_ids[kTraceMaxNumArgs];
+  for (; num_args < kTraceMaxNumArgs && event.arg_names_[num_args];
+       ++num_args) {
+    arg_name_ids[num_args] = InternString(event.arg_names_[num_args], out);
+  }
+
+  out->push_back(kEventRecord);
+  out->push_back(event.phase_);
+  AppendVarint(category_id, out);
+  AppendVarint(name_id, out);
+  AppendSignedVarint(event.thread_id_, out);
+  AppendSignedVarint(event.timestamp_.ToInternalValue(), out);
+  AppendSignedVarint(event.thread_timestamp_.ToInternalValue(), out);
+  out->push_back(event.flags_);
+  if (event.flags_ & TRACE_EVENT_FLAG_HAS_ID)
+    AppendVarint(event.id_, out);
+  if (event.phase_ == TRACE_EVENT_PHASE_COMPLETE) {
+    AppendSignedVarint(event.duration_.ToInternalValue(), out);
+    AppendSignedVarint(event.thread_duration_.ToInternalValue(), out);
+  }
+
+  out->push_back(static_cast<char>(num_args));
+  for (int i = 0; i < num_args; ++i) {
+    AppendVarint(arg_name_ids[i], out);
+    out->push_back(event.arg_types_[i]);
+    if (event.arg_types_[i] == TRACE_VALUE_TYPE_CONVERTABLE) {
+      // Convertables are only known by the JSON they append.
+      std::string json;
+      event.convertable_values_[i]->AppendAsTraceFormat(&json);
+      AppendBytes(json.data(), json.size(), out);
+    } else {
+      AppendValue(event.arg_types_[i], event.arg_values_[i], out);
+    }
+  }
+}
+
+uint32 TraceEventBinaryWriter::InternString(const char* str,
+                                            std::string* out) {
+  StringPiece key(str);
+  hash_map<StringPiece, uint32>::const_iterator it = string_ids_.find(key);
+  if (it != string_ids_.end())
+    return it->second;
+
+  uint32 id = static_cast<uint32>(string_ids_.size());
+  string_ids_[key] = id;
+  out->push_back(kStringRecord);
+  AppendBytes(key.data(), key.size(), out);
+  return id;
+}
+
+bool ConvertBinaryTraceToJSON(const std::string& binary, std::string* json) {
+  BinaryReader reader(binary);
+  unsigned char version;
+  int64 process_id;
+  if (!reader.ReadMagic() || !reader.ReadByte(&version) ||
+      version != kVersion || !reader.ReadSignedVarint(&process_id)) {
+    return false;
+  }
+
+  std::vector<std::string> strings;
+  bool first_event = true;
+  while (!reader.AtEnd()) {
+    unsigned char record;
+    if (!reader.ReadByte(&record))
+      return false;
+
+    if (record == kStringRecord) {
+      strings.push_back(std::string());
+      if (!reader.ReadBytes(&strings.back()))
+        return false;
+      continue;
+    }
+    if (record != kEventRecord)
+      return false;
+
+    unsigned char phase;
+    const char* category_group_name;
+    const char* name;
+    int64 thread_id;
+    int64 timestamp;
+    int64 thread_timestamp;
+    unsigned char flags;
+    if (!reader.ReadByte(&phase) ||
+        !ReadStringId(&reader, strings, &category_group_name) ||
+        !ReadStringId(&reader, strings, &name) ||
+        !reader.ReadSignedVarint(&thread_id) ||
+        !reader.ReadSignedVarint(&timestamp) ||
+        !reader.ReadSignedVarint(&thread_timestamp) ||
+        !reader.ReadByte(&flags)) {
+      return false;
+    }
+    uint64 id = 0;
+    if ((flags & TRACE_EVENT_FLAG_HAS_ID) && !reader.ReadVarint(&id))
+      return false;
+    int64 duration = -1;
+    int64 thread_duration = -1;
+    if (phase == TRACE_EVENT_PHASE_COMPLETE &&
+        (!reader.ReadSignedVarint(&duration) ||
+         !reader.ReadSignedVarint(&thread_duration))) {
+      return false;
+    }
+
+    unsigned char num_args;
+    if (!reader.ReadByte(&num_args) || num_args > kTraceMaxNumArgs)
+      return false;
+    const char* arg_names[kTraceMaxNumArgs];
+    unsigned char arg_types[kTraceMaxNumArgs];
+    unsigned long long arg_values[kTraceMaxNumArgs];
+    std::string arg_strings[kTraceMaxNumArgs];
+    scoped_refptr<ConvertableToTraceFormat> convertables[kTraceMaxNumArgs];
+    for (int i = 0; i < num_args; ++i) {
+      if (!ReadStringId(&reader, strings, &arg_names[i]) ||
+          !reader.ReadByte(&arg_types[i]) ||
+          !ReadValue(&reader, arg_types[i], &arg_strings[i], &convertables[i],
+                     &arg_values[i])) {
+        return false;
+      }
+    }
+
+    // All strings are owned by |strings| and |arg_strings|, so the event
+    // doesn't need to copy them.
+    TraceEvent event;
+    event.Initialize(static_cast<int>(thread_id),
+                     TimeTicks::FromInternalValue(timestamp),
+                     TimeTicks::FromInternalValue(thread_timestamp),
+                     static_cast<char>(phase),
+                     NULL,
+                     name,
+                     id,
+                     num_args,
+                     arg_names,
+                     arg_types,
+                     arg_values,
+                     convertables,
+                     flags & ~TRACE_EVENT_FLAG_COPY);
+    if (duration != -1) {
+      event.UpdateDuration(
+          TimeTicks::FromInternalValue(timestamp + duration),
+          TimeTicks::FromInternalValue(thread_timestamp + thread_duration));
+    }
+
+    if (!first_event)
+      json->append(",");
+    first_event = false;
+    event.AppendAsJSON(json, category_group_name,
+                       static_cast<int>(process_id));
+  }
+  return true;
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,73 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A compact binary encoding of trace events, used by TraceLog::FlushAsBinary()
+// so that flushing does not have to format every event as JSON. Event names,
+// category groups and argument names are interned: each distinct string is
+// written once and later referenced by a small integer id.
+//
+// The stream is a header followed by records. Integers are LEB128 varints,
+// signed ones zigzag-encoded first:
+//
+//   header:  "TRCB" <u8 version> <svarint pid>
+//   string:  'S' <varint length> <bytes>      (ids are assigned in order)
+//   event:   'E' <u8 phase> <varint category id> <varint name id>
+//            <svarint tid> <svarint ts> <svarint tts> <u8 flags>
+//            [<varint id>]                    (if TRACE_EVENT_FLAG_HAS_ID)
+//            [<svarint dur> <svarint tdur>]   (if phase is 'X')
+//            <u8 num args> { <varint name id> <u8 type> <value> }
+//
+// ConvertBinaryTraceToJSON() turns the stream back into the same JSON that
+// TraceLog::Flush() produces, for consumers such as about:tracing.
+
+#ifndef BASE_DEBUG_TRACE_EVENT_BINARY_H_
+#define BASE_DEBUG_TRACE_EVENT_BINARY_H_
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+namespace debug {
+
+class TraceEvent;
+
+// Encodes trace events of one flush. The strings of the encoded events must
+// stay alive as long as the writer, since it keys its string table on them.
+class BASE_EXPORT TraceEventBinaryWriter {
+ public:
+  explicit TraceEventBinaryWriter(int process_id);
+  ~TraceEventBinaryWriter();
+
+  // Appends the stream header. Must be called once, before any event.
+  void AppendHeader(std::string* out) const;
+
+  // Appends |event|, preceded by definitions of strings it uses for the first
+  // time.
+  void AppendEvent(const TraceEvent& event, std::string* out);
+
+ private:
+  // Returns the id of |str|, first appending its definition to |out| when
+  // |str| hasn't been seen yet.
+  uint32 InternString(const char* str, std::string* out);
+
+  int process_id_;
+  hash_map<StringPiece, uint32> string_ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceEventBinaryWriter);
+};
+
+// Converts the concatenated output of TraceLog::FlushAsBinary() to the
+// comma-separated JSON events that TraceLog::Flush() would have produced, and
+// appends them to |json|. Returns false if |binary| is malformed.
+BASE_EXPORT bool ConvertBinaryTraceToJSON(const std::string& binary,
+                                          std::string* json);
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_TRACE_EVENT_BINARY_H_
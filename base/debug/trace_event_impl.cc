@@ -11,6 +11,7 @@
 #include "base/command_line.h"
 #include "base/debug/leak_annotations.h"
 #include "base/debug/trace_event.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/debug/trace_event_synthetic_delay.h"
 #include "base/float_util.h"
 #include "base/format_macros.h"
@@ -32,6 +33,7 @@
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_id_name_manager.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/time/time.h"
 
 #if defined(OS_WIN)
@@ -108,6 +110,12 @@ int g_category_index = g_num_builtin_categories; // Skip default categories.
 LazyInstance<ThreadLocalPointer<const char> >::Leaky
     g_current_thread_name = LAZY_INSTANCE_INITIALIZER;
 
+// Holds the ThreadLocalEventBuffer of threads without a usable message loop so
+// that the buffer is flushed and deleted when the thread exits. A static slot
+// rather than a TraceLog member because TLS slots are never reused and tests
+// create many TraceLogs.
+ThreadLocalStorage::StaticSlot g_thread_exit_event_buffer = TLS_INITIALIZER;
+
 TimeTicks ThreadNow() {
   return TimeTicks::IsThreadNowSupported() ?
       TimeTicks::ThreadNow() : TimeTicks();
@@ -688,14 +696,21 @@ void TraceEvent::AppendValueAsJSON(unsigned char type,
 }
 
 void TraceEvent::AppendAsJSON(std::string* out) const {
+  AppendAsJSON(out,
+               TraceLog::GetCategoryGroupName(category_group_enabled_),
+               TraceLog::GetInstance()->process_id());
+}
+
+void TraceEvent::AppendAsJSON(std::string* out,
+                              const char* category_group_name,
+                              int process_id) const {
   int64 time_int64 = timestamp_.ToInternalValue();
-  int process_id = TraceLog::GetInstance()->process_id();
   // Category group checked at category creation time.
   DCHECK(!strchr(name_, '"'));
   StringAppendF(out,
       "{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ","
       "\"ph\":\"%c\",\"name\":\"%s\",\"args\":{",
-      TraceLog::GetCategoryGroupName(category_group_enabled_),
+      category_group_name,
       process_id,
       thread_id_,
       time_int64,
@@ -969,10 +984,40 @@ TraceBucketData::~TraceBucketData() {
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+// Every thread that adds events gets a ThreadLocalEventBuffer, so events are
+// written without taking TraceLog::lock_ except to swap a full chunk.
+// - A thread with a message loop flushes its own buffer; Flush() posts a task
+//   to it and the buffer goes away with the message loop.
+// - A thread without a usable message loop (none, or one that blocks) has a
+//   "detached" buffer. Its writes are guarded by a per-buffer lock that is
+//   only ever contended by Flush(), which takes the chunk directly. The buffer
+//   is deleted when the thread exits.
 class TraceLog::ThreadLocalEventBuffer
     : public MessageLoop::DestructionObserver {
  public:
-  ThreadLocalEventBuffer(TraceLog* trace_log);
+  // Keeps a detached buffer locked while the owning thread writes to it. Does
+  // nothing for buffers flushed through their message loop, or if |buffer| is
+  // NULL.
+  class AutoWriteLock {
+   public:
+    explicit AutoWriteLock(ThreadLocalEventBuffer* buffer)
+        : lock_(buffer && !buffer->message_loop_ ? &buffer->lock_ : NULL) {
+      if (lock_)
+        lock_->Acquire();
+    }
+    ~AutoWriteLock() {
+      if (lock_)
+        lock_->Release();
+    }
+
+   private:
+    Lock* lock_;
+    DISALLOW_COPY_AND_ASSIGN(AutoWriteLock);
+  };
+
+  // |message_loop| is the message loop of the current thread, or NULL to
+  // create a detached buffer.
+  ThreadLocalEventBuffer(TraceLog* trace_log, MessageLoop* message_loop);
   virtual ~ThreadLocalEventBuffer();
 
   TraceEvent* AddTraceEvent(TraceEventHandle* handle);
@@ -990,6 +1035,13 @@ class TraceLog::ThreadLocalEventBuffer
 
   int generation() const { return generation_; }
 
+  // Returns the chunk of a detached buffer to the main buffer. Called by
+  // Flush() on any thread with |thread_detached_buffers_lock_| held.
+  void FlushDetached();
+
+  // TLS destructor of |g_thread_exit_event_buffer|.
+  static void OnThreadExit(void* buffer);
+
  private:
   // MessageLoop::DestructionObserver
   virtual void WillDestroyCurrentMessageLoop() OVERRIDE;
@@ -1003,6 +1055,10 @@ class TraceLog::ThreadLocalEventBuffer
   // Since TraceLog is a leaky singleton, trace_log_ will always be valid
   // as long as the thread exists.
   TraceLog* trace_log_;
+  // NULL for detached buffers.
+  MessageLoop* message_loop_;
+  // Protects |chunk_| and |chunk_index_| of detached buffers.
+  Lock lock_;
   scoped_ptr<TraceBufferChunk> chunk_;
   size_t chunk_index_;
   int event_count_;
@@ -1012,27 +1068,40 @@ class TraceLog::ThreadLocalEventBuffer
   DISALLOW_COPY_AND_ASSIGN(ThreadLocalEventBuffer);
 };
 
-TraceLog::ThreadLocalEventBuffer::ThreadLocalEventBuffer(TraceLog* trace_log)
+TraceLog::ThreadLocalEventBuffer::ThreadLocalEventBuffer(
+    TraceLog* trace_log,
+    MessageLoop* message_loop)
     : trace_log_(trace_log),
+      message_loop_(message_loop),
       chunk_index_(0),
       event_count_(0),
       generation_(trace_log->generation()) {
-  // ThreadLocalEventBuffer is created only if the thread has a message loop, so
-  // the following message_loop won't be NULL.
-  MessageLoop* message_loop = MessageLoop::current();
-  message_loop->AddDestructionObserver(this);
+  if (!message_loop_) {
+    g_thread_exit_event_buffer.Set(this);
+    AutoLock lock(trace_log->thread_detached_buffers_lock_);
+    trace_log->thread_detached_buffers_.insert(this);
+    return;
+  }
+
+  message_loop_->AddDestructionObserver(this);
 
   AutoLock lock(trace_log->lock_);
-  trace_log->thread_message_loops_.insert(message_loop);
+  trace_log->thread_message_loops_.insert(message_loop_);
 }
 
 TraceLog::ThreadLocalEventBuffer::~ThreadLocalEventBuffer() {
   CheckThisIsCurrentBuffer();
-  MessageLoop::current()->RemoveDestructionObserver(this);
+  if (message_loop_) {
+    message_loop_->RemoveDestructionObserver(this);
+  } else {
+    // Once unregistered, Flush() can't reach this buffer any more, so the rest
+    // of the destructor needs no buffer lock.
+    AutoLock lock(trace_log_->thread_detached_buffers_lock_);
+    trace_log_->thread_detached_buffers_.erase(this);
+  }
 
   // Zero event_count_ happens in either of the following cases:
   // - no event generated for the thread;
-  // - the thread has no message loop;
   // - trace_event_overhead is disabled.
   if (event_count_) {
     InitializeMetadataEvent(AddTraceEvent(NULL),
@@ -1044,8 +1113,11 @@ TraceLog::ThreadLocalEventBuffer::~ThreadLocalEventBuffer() {
   {
     AutoLock lock(trace_log_->lock_);
     FlushWhileLocked();
-    trace_log_->thread_message_loops_.erase(MessageLoop::current());
+    if (message_loop_)
+      trace_log_->thread_message_loops_.erase(message_loop_);
   }
+  if (!message_loop_)
+    g_thread_exit_event_buffer.Set(NULL);
   trace_log_->thread_local_event_buffer_.Set(NULL);
 }
 
@@ -1087,6 +1159,7 @@ void TraceLog::ThreadLocalEventBuffer::ReportOverhead(
   TimeTicks now = trace_log_->OffsetNow();
   TimeDelta overhead = now - event_timestamp;
   if (overhead.InMicroseconds() >= kOverheadReportThresholdInMicroseconds) {
+    AutoWriteLock write_lock(this);
     TraceEvent* trace_event = AddTraceEvent(NULL);
     if (trace_event) {
       trace_event->Initialize(
@@ -1101,6 +1174,23 @@ void TraceLog::ThreadLocalEventBuffer::ReportOverhead(
   overhead_ += overhead;
 }
 
+void TraceLog::ThreadLocalEventBuffer::FlushDetached() {
+  DCHECK(!message_loop_);
+  trace_log_->thread_detached_buffers_lock_.AssertAcquired();
+  AutoLock buffer_lock(lock_);
+  AutoLock lock(trace_log_->lock_);
+  FlushWhileLocked();
+}
+
+// static
+void TraceLog::ThreadLocalEventBuffer::OnThreadExit(void* value) {
+  ThreadLocalEventBuffer* buffer = static_cast<ThreadLocalEventBuffer*>(value);
+  // Other thread local values may already have been cleared by the time TLS
+  // destructors run.
+  buffer->trace_log_->thread_local_event_buffer_.Set(buffer);
+  delete buffer;
+}
+
 void TraceLog::ThreadLocalEventBuffer::WillDestroyCurrentMessageLoop() {
   delete this;
 }
@@ -1138,6 +1228,7 @@ TraceLog::TraceLog()
       event_callback_category_filter_(
           CategoryFilter::kDefaultCategoryFilterString),
       thread_shared_chunk_index_(0),
+      flush_as_binary_(false),
       generation_(0) {
   // Trace is enabled or disabled on one thread while other threads are
   // accessing the enabled flag. We don't care whether edge-case events are
@@ -1151,6 +1242,8 @@ TraceLog::TraceLog()
     ANNOTATE_BENIGN_RACE(&g_category_group_enabled[i],
                          "trace_event category enabled");
   }
+  if (!g_thread_exit_event_buffer.initialized())
+    g_thread_exit_event_buffer.Initialize(&ThreadLocalEventBuffer::OnThreadExit);
 #if defined(OS_NACL)  // NaCl shouldn't expose the process id.
   SetProcessID(0);
 #else
@@ -1178,6 +1271,9 @@ TraceLog::TraceLog()
 }
 
 TraceLog::~TraceLog() {
+  // Only reached in tests. Don't leave the current thread's buffer pointing at
+  // a deleted TraceLog.
+  delete thread_local_event_buffer_.Get();
 }
 
 const unsigned char* TraceLog::GetCategoryGroupEnabled(
@@ -1547,6 +1643,15 @@ void TraceLog::SetEventCallbackDisabled() {
 //    If this is the last message loop, finish the flush;
 // 4. If any thread hasn't finish its flush in time, finish the flush.
 void TraceLog::Flush(const TraceLog::OutputCallback& cb) {
+  FlushInternal(cb, false);
+}
+
+void TraceLog::FlushAsBinary(const TraceLog::OutputCallback& cb) {
+  FlushInternal(cb, true);
+}
+
+void TraceLog::FlushInternal(const TraceLog::OutputCallback& cb,
+                             bool binary) {
   if (IsEnabled()) {
     // Can't flush when tracing is enabled because otherwise PostTask would
     // - generate more trace events;
@@ -1560,12 +1665,14 @@ void TraceLog::Flush(const TraceLog::OutputCallback& cb) {
   }
 
   int generation = this->generation();
+  FlushDetachedThreadBuffers();
   {
     AutoLock lock(lock_);
     DCHECK(!flush_message_loop_proxy_.get());
     flush_message_loop_proxy_ = MessageLoopProxy::current();
     DCHECK(!thread_message_loops_.size() || flush_message_loop_proxy_.get());
     flush_output_callback_ = cb;
+    flush_as_binary_ = binary;
 
     if (thread_shared_chunk_) {
       logged_events_->ReturnChunk(thread_shared_chunk_index_,
@@ -1622,9 +1729,44 @@ void TraceLog::ConvertTraceEventsToTraceFormat(
   } while (has_more_events);
 }
 
+void TraceLog::ConvertTraceEventsToBinaryFormat(
+    scoped_ptr<TraceBuffer> logged_events,
+    const TraceLog::OutputCallback& flush_output_callback) {
+  if (flush_output_callback.is_null())
+    return;
+
+  // One writer for the whole flush so that strings are only written once.
+  // The events it has seen stay alive in |logged_events| until it's done.
+  TraceEventBinaryWriter writer(process_id_);
+  bool has_more_events = true;
+  bool first_batch = true;
+  do {
+    scoped_refptr<RefCountedString> binary_events_str_ptr =
+        new RefCountedString();
+    std::string* out = &binary_events_str_ptr->data();
+    if (first_batch) {
+      writer.AppendHeader(out);
+      first_batch = false;
+    }
+
+    for (size_t i = 0; i < kTraceEventBatchChunks; ++i) {
+      const TraceBufferChunk* chunk = logged_events->NextChunk();
+      if (!chunk) {
+        has_more_events = false;
+        break;
+      }
+      for (size_t j = 0; j < chunk->size(); ++j)
+        writer.AppendEvent(*chunk->GetEventAt(j), out);
+    }
+
+    flush_output_callback.Run(binary_events_str_ptr, has_more_events);
+  } while (has_more_events);
+}
+
 void TraceLog::FinishFlush(int generation) {
   scoped_ptr<TraceBuffer> previous_logged_events;
   OutputCallback flush_output_callback;
+  bool flush_as_binary;
 
   if (!CheckGeneration(generation))
     return;
@@ -1639,10 +1781,16 @@ void TraceLog::FinishFlush(int generation) {
     flush_message_loop_proxy_ = NULL;
     flush_output_callback = flush_output_callback_;
     flush_output_callback_.Reset();
+    flush_as_binary = flush_as_binary_;
   }
 
-  ConvertTraceEventsToTraceFormat(previous_logged_events.Pass(),
-                                  flush_output_callback);
+  if (flush_as_binary) {
+    ConvertTraceEventsToBinaryFormat(previous_logged_events.Pass(),
+                                     flush_output_callback);
+  } else {
+    ConvertTraceEventsToTraceFormat(previous_logged_events.Pass(),
+                                    flush_output_callback);
+  }
 }
 
 // Run in each thread holding a local event buffer.
@@ -1690,9 +1838,22 @@ void TraceLog::OnFlushTimeout(int generation) {
   FinishFlush(generation);
 }
 
+void TraceLog::FlushDetachedThreadBuffers() {
+  // Threads without a message loop can't be asked to flush, so take their
+  // chunks from here.
+  AutoLock lock(thread_detached_buffers_lock_);
+  for (std::set<ThreadLocalEventBuffer*>::const_iterator it =
+       thread_detached_buffers_.begin();
+       it != thread_detached_buffers_.end(); ++it) {
+    (*it)->FlushDetached();
+  }
+}
+
 void TraceLog::FlushButLeaveBufferIntact(
     const TraceLog::OutputCallback& flush_output_callback) {
   scoped_ptr<TraceBuffer> previous_logged_events;
+  // Sampling events come from a thread without a message loop.
+  FlushDetachedThreadBuffers();
   {
     AutoLock lock(lock_);
     AddMetadataEventsWhileLocked();
@@ -1768,23 +1929,20 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamp(
   TimeTicks now = OffsetTimestamp(timestamp);
   TimeTicks thread_now = ThreadNow();
 
-  ThreadLocalEventBuffer* thread_local_event_buffer = NULL;
-  // A ThreadLocalEventBuffer needs the message loop
-  // - to know when the thread exits;
-  // - to handle the final flush.
-  // For a thread without a message loop or the message loop may be blocked, the
-  // trace events will be added into the main buffer directly.
-  if (!thread_blocks_message_loop_.Get() && MessageLoop::current()) {
-    thread_local_event_buffer = thread_local_event_buffer_.Get();
-    if (thread_local_event_buffer &&
-        !CheckGeneration(thread_local_event_buffer->generation())) {
-      delete thread_local_event_buffer;
-      thread_local_event_buffer = NULL;
-    }
-    if (!thread_local_event_buffer) {
-      thread_local_event_buffer = new ThreadLocalEventBuffer(this);
-      thread_local_event_buffer_.Set(thread_local_event_buffer);
-    }
+  ThreadLocalEventBuffer* thread_local_event_buffer =
+      thread_local_event_buffer_.Get();
+  if (thread_local_event_buffer &&
+      !CheckGeneration(thread_local_event_buffer->generation())) {
+    delete thread_local_event_buffer;
+    thread_local_event_buffer = NULL;
+  }
+  if (!thread_local_event_buffer) {
+    // A thread whose message loop may be blocked can't be relied on to run
+    // the flush task, so it gets a detached buffer like a thread without one.
+    thread_local_event_buffer = new ThreadLocalEventBuffer(
+        this,
+        thread_blocks_message_loop_.Get() ? NULL : MessageLoop::current());
+    thread_local_event_buffer_.Set(thread_local_event_buffer);
   }
 
   // Check and update the current thread name only if the event is for the
@@ -1827,15 +1985,10 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamp(
   std::string console_message;
   if (*category_group_enabled &
       (ENABLED_FOR_RECORDING | ENABLED_FOR_MONITORING)) {
-    OptionalAutoLock lock(lock_);
+    ThreadLocalEventBuffer::AutoWriteLock write_lock(thread_local_event_buffer);
 
-    TraceEvent* trace_event = NULL;
-    if (thread_local_event_buffer) {
-      trace_event = thread_local_event_buffer->AddTraceEvent(&handle);
-    } else {
-      lock.EnsureAcquired();
-      trace_event = AddEventToThreadSharedChunkWhileLocked(&handle, true);
-    }
+    TraceEvent* trace_event =
+        thread_local_event_buffer->AddTraceEvent(&handle);
 
     if (trace_event) {
       trace_event->Initialize(thread_id, now, thread_now, phase,
@@ -1886,8 +2039,7 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamp(
     }
   }
 
-  if (thread_local_event_buffer)
-    thread_local_event_buffer->ReportOverhead(now, thread_now);
+  thread_local_event_buffer->ReportOverhead(now, thread_now);
 
   return handle;
 }
@@ -1980,6 +2132,9 @@ void TraceLog::UpdateTraceEventDuration(
 
   std::string console_message;
   if (*category_group_enabled & ENABLED_FOR_RECORDING) {
+    // Must be taken before |lock_|.
+    ThreadLocalEventBuffer::AutoWriteLock write_lock(
+        thread_local_event_buffer_.Get());
     OptionalAutoLock lock(lock_);
 
     TraceEvent* trace_event = GetEventByHandleInternal(handle, &lock);
@@ -6,6 +6,7 @@
 #ifndef BASE_DEBUG_TRACE_EVENT_IMPL_H_
 #define BASE_DEBUG_TRACE_EVENT_IMPL_H_
 
+#include <set>
 #include <stack>
 #include <string>
 #include <vector>
@@ -126,6 +127,11 @@ class BASE_EXPORT TraceEvent {
 
   // Serialize event data to JSON
   void AppendAsJSON(std::string* out) const;
+  // As above, for events that don't belong to this process' TraceLog, e.g.
+  // ones decoded from a binary trace.
+  void AppendAsJSON(std::string* out,
+                    const char* category_group_name,
+                    int process_id) const;
   void AppendPrettyPrinted(std::ostringstream* out) const;
 
   static void AppendValueAsJSON(unsigned char type,
@@ -158,6 +164,8 @@ class BASE_EXPORT TraceEvent {
 #endif
 
  private:
+  friend class TraceEventBinaryWriter;
+
   // Note: these are ordered by size (largest first) for optimal packing.
   TimeTicks timestamp_;
   TimeTicks thread_timestamp_;
@@ -495,6 +503,11 @@ class BASE_EXPORT TraceLog {
   typedef base::Callback<void(const scoped_refptr<base::RefCountedString>&,
                               bool has_more_events)> OutputCallback;
   void Flush(const OutputCallback& cb);
+  // Like Flush(), but the chunks form a compact binary stream that interns
+  // strings instead of JSON; see trace_event_binary.h. Each chunk can be
+  // written out as it arrives, and ConvertBinaryTraceToJSON() turns their
+  // concatenation into JSON.
+  void FlushAsBinary(const OutputCallback& cb);
   void FlushButLeaveBufferIntact(const OutputCallback& flush_output_callback);
 
   // Called by TRACE_EVENT* macros, don't call this directly.
@@ -592,9 +605,10 @@ class BASE_EXPORT TraceLog {
 
   size_t GetObserverCountForTest() const;
 
-  // Call this method if the current thread may block the message loop to
-  // prevent the thread from using the thread-local buffer because the thread
-  // may not handle the flush request in time causing lost of unflushed events.
+  // Call this method if the current thread may block the message loop. The
+  // thread then uses a thread-local buffer that Flush() drains directly,
+  // because the thread may not handle the flush request in time causing loss
+  // of unflushed events.
   void SetCurrentThreadBlocksMessageLoop();
 
  private:
@@ -646,10 +660,16 @@ class BASE_EXPORT TraceLog {
 
   // |generation| is used in the following callbacks to check if the callback
   // is called for the flush of the current |logged_events_|.
+  void FlushInternal(const OutputCallback& cb, bool binary);
   void FlushCurrentThread(int generation);
   void ConvertTraceEventsToTraceFormat(scoped_ptr<TraceBuffer> logged_events,
       const TraceLog::OutputCallback& flush_output_callback);
+  void ConvertTraceEventsToBinaryFormat(scoped_ptr<TraceBuffer> logged_events,
+      const TraceLog::OutputCallback& flush_output_callback);
   void FinishFlush(int generation);
+  // Returns the chunks of all detached thread local buffers to the main
+  // buffer.
+  void FlushDetachedThreadBuffers();
   void OnFlushTimeout(int generation);
 
   int generation() const {
@@ -721,13 +741,21 @@ class BASE_EXPORT TraceLog {
   // need to know the life time of the message loops.
   hash_set<MessageLoop*> thread_message_loops_;
 
-  // For events which can't be added into the thread local buffer, e.g. events
-  // from threads without a message loop.
+  // Contains the local event buffers of threads without a usable message loop.
+  // Flush() takes their chunks directly instead of posting a task to them.
+  // Lock order: |thread_detached_buffers_lock_|, then the lock of a buffer,
+  // then |lock_|.
+  Lock thread_detached_buffers_lock_;
+  std::set<ThreadLocalEventBuffer*> thread_detached_buffers_;
+
+  // For events which can't be added into the thread local buffer, e.g.
+  // metadata and sampling events.
   scoped_ptr<TraceBufferChunk> thread_shared_chunk_;
   size_t thread_shared_chunk_index_;
 
   // Set when asynchronous Flush is in progress.
   OutputCallback flush_output_callback_;
+  bool flush_as_binary_;
   scoped_refptr<MessageLoopProxy> flush_message_loop_proxy_;
   subtle::AtomicWord generation_;
 
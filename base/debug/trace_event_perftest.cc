@@ -0,0 +1,150 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the cost of recording a trace event while tracing is enabled, on
+// threads with and without a message loop.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace debug {
+namespace {
+
+// Small enough that the events of all threads fit in the trace buffer, so
+// every event is actually recorded.
+const int kEventsPerThread = 20000;
+
+void AddEvents(WaitableEvent* start) {
+  start->Wait();
+  for (int i = 0; i < kEventsPerThread; ++i)
+    TRACE_EVENT_INSTANT1("perf", "event", TRACE_EVENT_SCOPE_THREAD, "i", i);
+}
+
+class AddEventsDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  explicit AddEventsDelegate(WaitableEvent* start) : start_(start) {}
+
+  virtual void Run() OVERRIDE {
+    AddEvents(start_);
+  }
+
+ private:
+  WaitableEvent* start_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddEventsDelegate);
+};
+
+void OnTraceDataCollected(WaitableEvent* flush_complete_event,
+                          const scoped_refptr<RefCountedString>& events_str,
+                          bool has_more_events) {
+  if (!has_more_events)
+    flush_complete_event->Signal();
+}
+
+void EndTraceAndFlush(WaitableEvent* flush_complete_event) {
+  TraceLog::GetInstance()->SetDisabled();
+  TraceLog::GetInstance()->Flush(
+      Bind(&OnTraceDataCollected, flush_complete_event));
+}
+
+class TraceEventPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    TraceLog::GetInstance()->SetEnabled(CategoryFilter("perf"),
+                                        TraceLog::RECORDING_MODE,
+                                        TraceLog::RECORD_UNTIL_FULL);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    // Flush from a thread with a message loop so that the buffers of threads
+    // with message loops can be collected too.
+    Thread flush_thread("TraceEventPerfTestFlush");
+    ASSERT_TRUE(flush_thread.Start());
+    WaitableEvent flush_complete_event(false, false);
+    flush_thread.message_loop()->PostTask(
+        FROM_HERE, Bind(&EndTraceAndFlush, &flush_complete_event));
+    flush_complete_event.Wait();
+  }
+
+  // Reports the wall time per event of |num_threads| threads that added
+  // events concurrently for |elapsed|. Contention on shared state shows up as
+  // a higher cost with more threads.
+  void Report(const std::string& trace, int num_threads, TimeDelta elapsed) {
+    perf_test::PrintResult(
+        "trace_event_overhead", "", trace,
+        elapsed.InMicroseconds() * 1000.0 / (num_threads * kEventsPerThread),
+        "ns/event", true);
+  }
+
+  void RunWithoutMessageLoop(int num_threads) {
+    WaitableEvent start(true, false);
+    ScopedVector<AddEventsDelegate> delegates;
+    ScopedVector<DelegateSimpleThread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      delegates.push_back(new AddEventsDelegate(&start));
+      threads.push_back(new DelegateSimpleThread(
+          delegates.back(), StringPrintf("TraceEventPerfTest%d", i)));
+      threads.back()->Start();
+    }
+    TimeTicks begin = TimeTicks::HighResNow();
+    start.Signal();
+    for (int i = 0; i < num_threads; ++i)
+      threads[i]->Join();
+    Report(StringPrintf("no_message_loop_%d_threads", num_threads),
+           num_threads, TimeTicks::HighResNow() - begin);
+  }
+
+  void RunWithMessageLoop(int num_threads) {
+    WaitableEvent start(true, false);
+    WaitableEvent done(false, false);
+    ScopedVector<Thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(
+          new Thread(StringPrintf("TraceEventPerfTest%d", i).c_str()));
+      ASSERT_TRUE(threads.back()->Start());
+      threads.back()->message_loop()->PostTask(
+          FROM_HERE, Bind(&AddEvents, &start));
+      threads.back()->message_loop()->PostTask(
+          FROM_HERE, Bind(&WaitableEvent::Signal, Unretained(&done)));
+    }
+    TimeTicks begin = TimeTicks::HighResNow();
+    start.Signal();
+    for (int i = 0; i < num_threads; ++i)
+      done.Wait();
+    Report(StringPrintf("message_loop_%d_threads", num_threads),
+           num_threads, TimeTicks::HighResNow() - begin);
+  }
+};
+
+TEST_F(TraceEventPerfTest, NoMessageLoopOneThread) {
+  RunWithoutMessageLoop(1);
+}
+
+TEST_F(TraceEventPerfTest, NoMessageLoopFourThreads) {
+  RunWithoutMessageLoop(4);
+}
+
+TEST_F(TraceEventPerfTest, MessageLoopOneThread) {
+  RunWithMessageLoop(1);
+}
+
+TEST_F(TraceEventPerfTest, MessageLoopFourThreads) {
+  RunWithMessageLoop(4);
+}
+
+}  // namespace
+}  // namespace debug
+}  // namespace base
@@ -10,6 +10,7 @@
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/debug/trace_event_synthetic_delay.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
@@ -55,6 +56,10 @@ class TraceEventTestFixture : public testing::Test {
       WaitableEvent* flush_complete_event,
       const scoped_refptr<base::RefCountedString>& events_str,
       bool has_more_events);
+  void OnBinaryTraceDataCollected(
+      WaitableEvent* flush_complete_event,
+      const scoped_refptr<base::RefCountedString>& events_str,
+      bool has_more_events);
   void OnWatchEventMatched() {
     ++event_watch_notification_;
   }
@@ -111,6 +116,17 @@ class TraceEventTestFixture : public testing::Test {
                    base::Unretained(flush_complete_event)));
   }
 
+  void EndTraceAndFlushAsBinary() {
+    WaitableEvent flush_complete_event(false, false);
+    binary_trace_.clear();
+    TraceLog::GetInstance()->SetDisabled();
+    TraceLog::GetInstance()->FlushAsBinary(
+        base::Bind(&TraceEventTestFixture::OnBinaryTraceDataCollected,
+                   base::Unretained(static_cast<TraceEventTestFixture*>(this)),
+                   base::Unretained(&flush_complete_event)));
+    flush_complete_event.Wait();
+  }
+
   void FlushMonitoring() {
     WaitableEvent flush_complete_event(false, false);
     FlushMonitoring(&flush_complete_event);
@@ -149,6 +165,7 @@ class TraceEventTestFixture : public testing::Test {
   ListValue trace_parsed_;
   base::debug::TraceResultBuffer trace_buffer_;
   base::debug::TraceResultBuffer::SimpleOutput json_output_;
+  std::string binary_trace_;
   int event_watch_notification_;
 
  private:
@@ -190,6 +207,21 @@ void TraceEventTestFixture::OnTraceDataCollected(
     flush_complete_event->Signal();
 }
 
+void TraceEventTestFixture::OnBinaryTraceDataCollected(
+    WaitableEvent* flush_complete_event,
+    const scoped_refptr<base::RefCountedString>& events_str,
+    bool has_more_events) {
+  binary_trace_.append(events_str->data());
+  if (has_more_events)
+    return;
+
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(binary_trace_, &json));
+  OnTraceDataCollected(flush_complete_event,
+                       RefCountedString::TakeString(&json),
+                       false);
+}
+
 static bool CompareJsonValues(const std::string& lhs,
                               const std::string& rhs,
                               CompareOp op) {
@@ -812,6 +844,35 @@ void TraceManyInstantEvents(int thread_id, int num_events,
     task_complete_event->Signal();
 }
 
+// Runs TraceManyInstantEvents() on a thread without a message loop, then
+// waits for |exit_event| (if any) before exiting.
+class TraceManyInstantEventsDelegate : public PlatformThread::Delegate {
+ public:
+  TraceManyInstantEventsDelegate(int thread_id,
+                                 int num_events,
+                                 WaitableEvent* task_complete_event,
+                                 WaitableEvent* exit_event)
+      : thread_id_(thread_id),
+        num_events_(num_events),
+        task_complete_event_(task_complete_event),
+        exit_event_(exit_event) {
+  }
+
+  virtual void ThreadMain() OVERRIDE {
+    TraceManyInstantEvents(thread_id_, num_events_, task_complete_event_);
+    if (exit_event_)
+      exit_event_->Wait();
+  }
+
+ private:
+  int thread_id_;
+  int num_events_;
+  WaitableEvent* task_complete_event_;
+  WaitableEvent* exit_event_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceManyInstantEventsDelegate);
+};
+
 void ValidateInstantEventPresentOnEveryThread(const ListValue& trace_parsed,
                                               int num_threads,
                                               int num_events) {
@@ -866,6 +927,38 @@ TEST_F(TraceEventTestFixture, DataCaptured) {
   ValidateAllTraceMacrosCreatedData(trace_parsed_);
 }
 
+// Test that the binary flush converts back to the same events.
+TEST_F(TraceEventTestFixture, DataCapturedAsBinary) {
+  TraceLog::GetInstance()->SetEnabled(CategoryFilter("*"),
+                                      base::debug::TraceLog::RECORDING_MODE,
+                                      TraceLog::RECORD_UNTIL_FULL);
+
+  TraceWithAllMacroVariants(NULL);
+
+  EndTraceAndFlushAsBinary();
+
+  ValidateAllTraceMacrosCreatedData(trace_parsed_);
+}
+
+TEST_F(TraceEventTestFixture, ConvertBinaryTraceRejectsMalformedInput) {
+  TraceLog::GetInstance()->SetEnabled(CategoryFilter("*"),
+                                      base::debug::TraceLog::RECORDING_MODE,
+                                      TraceLog::RECORD_UNTIL_FULL);
+  TRACE_EVENT_INSTANT1("all", "event", TRACE_EVENT_SCOPE_THREAD, "arg", 1);
+  EndTraceAndFlushAsBinary();
+
+  std::string json;
+  EXPECT_TRUE(ConvertBinaryTraceToJSON(binary_trace_, &json));
+  EXPECT_FALSE(json.empty());
+
+  // Cut off in the middle of the last event.
+  json.clear();
+  EXPECT_FALSE(ConvertBinaryTraceToJSON(
+      binary_trace_.substr(0, binary_trace_.size() - 1), &json));
+  EXPECT_FALSE(ConvertBinaryTraceToJSON("JSON", &json));
+  EXPECT_FALSE(ConvertBinaryTraceToJSON(std::string(), &json));
+}
+
 class MockEnabledStateChangedObserver :
       public base::debug::TraceLog::EnabledStateObserver {
  public:
@@ -1443,6 +1536,46 @@ TEST_F(TraceEventTestFixture, DataCapturedManyThreads) {
   }
 }
 
+// Test that data sent from threads without a message loop is gathered, both
+// from threads that exited before the flush and from threads still running.
+TEST_F(TraceEventTestFixture, DataCapturedManyThreadsWithoutMessageLoop) {
+  BeginTrace();
+
+  const int num_threads = 4;
+  const int num_events = 4000;
+  WaitableEvent exit_event(true, false);
+  PlatformThreadHandle handles[num_threads];
+  TraceManyInstantEventsDelegate* delegates[num_threads];
+  WaitableEvent* task_complete_events[num_threads];
+  for (int i = 0; i < num_threads; i++) {
+    task_complete_events[i] = new WaitableEvent(false, false);
+    delegates[i] = new TraceManyInstantEventsDelegate(
+        i, num_events, task_complete_events[i],
+        i < num_threads / 2 ? NULL : &exit_event);
+    ASSERT_TRUE(PlatformThread::Create(0, delegates[i], &handles[i]));
+  }
+
+  for (int i = 0; i < num_threads; i++) {
+    task_complete_events[i]->Wait();
+  }
+
+  // Let half of the threads exit before flush.
+  for (int i = 0; i < num_threads / 2; i++)
+    PlatformThread::Join(handles[i]);
+
+  EndTraceAndFlush();
+  ValidateInstantEventPresentOnEveryThread(trace_parsed_,
+                                           num_threads, num_events);
+
+  exit_event.Signal();
+  for (int i = num_threads / 2; i < num_threads; i++)
+    PlatformThread::Join(handles[i]);
+  for (int i = 0; i < num_threads; i++) {
+    delete delegates[i];
+    delete task_complete_events[i];
+  }
+}
+
 // Test that thread and process names show up in the trace
 TEST_F(TraceEventTestFixture, ThreadNames) {
   // Create threads before we enable tracing to make sure
@@ -1989,6 +2122,46 @@ TEST_F(TraceEventTestFixture, ConvertableTypes) {
   EXPECT_EQ(1, foo_val);
 }
 
+TEST_F(TraceEventTestFixture, ConvertableAndPrimitiveArgsAsBinary) {
+  TraceLog::GetInstance()->SetEnabled(CategoryFilter("*"),
+      base::debug::TraceLog::RECORDING_MODE,
+      TraceLog::RECORD_UNTIL_FULL);
+
+  {
+    scoped_refptr<ConvertableToTraceFormat> data(new MyData());
+    TRACE_EVENT2("foo", "convert", "data", data, "neg", -10);
+    TRACE_EVENT2("foo", "double", "half", -.5, "flag", true);
+  }
+  EndTraceAndFlushAsBinary();
+
+  const DictionaryValue* args_dict = NULL;
+  DictionaryValue* dict = FindNamePhase("convert", "X");
+  ASSERT_TRUE(dict);
+  EXPECT_TRUE(dict->HasKey("dur"));
+  dict->GetDictionary("args", &args_dict);
+  ASSERT_TRUE(args_dict);
+  const DictionaryValue* convertable_dict = NULL;
+  EXPECT_TRUE(args_dict->GetDictionary("data", &convertable_dict));
+  int int_value = 0;
+  ASSERT_TRUE(convertable_dict);
+  EXPECT_TRUE(convertable_dict->GetInteger("foo", &int_value));
+  EXPECT_EQ(1, int_value);
+  EXPECT_TRUE(args_dict->GetInteger("neg", &int_value));
+  EXPECT_EQ(-10, int_value);
+
+  dict = FindNamePhase("double", "X");
+  ASSERT_TRUE(dict);
+  args_dict = NULL;
+  dict->GetDictionary("args", &args_dict);
+  ASSERT_TRUE(args_dict);
+  double double_value = 0;
+  EXPECT_TRUE(args_dict->GetDouble("half", &double_value));
+  EXPECT_EQ(-.5, double_value);
+  bool bool_value = false;
+  EXPECT_TRUE(args_dict->GetBoolean("flag", &bool_value));
+  EXPECT_TRUE(bool_value);
+}
+
 TEST_F(TraceEventTestFixture, PrimitiveArgs) {
   TraceLog::GetInstance()->SetEnabled(CategoryFilter("*"),
       base::debug::TraceLog::RECORDING_MODE,
@@ -69,6 +69,9 @@ class BASE_EXPORT FileEnumerator {
 #elif defined(OS_POSIX)
     struct stat stat_;
     FilePath filename_;
+    // True when the directory entry already gave the file type, so only
+    // |stat_.st_mode| is set. FileEnumerator::GetInfo() fills in the rest.
+    bool stat_pending_;
 #endif
   };
 
@@ -131,9 +134,10 @@ class BASE_EXPORT FileEnumerator {
   HANDLE find_handle_;
 #elif defined(OS_POSIX)
 
-  // Read the filenames in source into the vector of DirectoryEntryInfo's
-  static bool ReadDirectory(std::vector<FileInfo>* entries,
-                            const FilePath& source, bool show_links);
+  // Read the filenames in source into the vector of DirectoryEntryInfo's,
+  // leaving out entries that ShouldSkip() or |pattern_| reject. Entries are
+  // only stat()ed here when the directory entry does not give their type.
+  bool ReadDirectory(std::vector<FileInfo>* entries, const FilePath& source);
 
   // The files in the current directory
   std::vector<FileInfo> directory_entries_;
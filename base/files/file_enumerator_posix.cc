@@ -15,7 +15,7 @@ namespace base {
 
 // FileEnumerator::FileInfo ----------------------------------------------------
 
-FileEnumerator::FileInfo::FileInfo() {
+FileEnumerator::FileInfo::FileInfo() : stat_pending_(false) {
   memset(&stat_, 0, sizeof(stat_));
 }
 
@@ -84,23 +84,15 @@ FilePath FileEnumerator::Next() {
     pending_paths_.pop();
 
     std::vector<FileInfo> entries;
-    if (!ReadDirectory(&entries, root_path_, file_type_ & SHOW_SYM_LINKS))
+    if (!ReadDirectory(&entries, root_path_))
       continue;
 
     directory_entries_.clear();
     current_directory_entry_ = 0;
     for (std::vector<FileInfo>::const_iterator i = entries.begin();
          i != entries.end(); ++i) {
-      FilePath full_path = root_path_.Append(i->filename_);
-      if (ShouldSkip(full_path))
-        continue;
-
-      if (pattern_.size() &&
-          fnmatch(pattern_.c_str(), full_path.value().c_str(), FNM_NOESCAPE))
-        continue;
-
       if (recursive_ && S_ISDIR(i->stat_.st_mode))
-        pending_paths_.push(full_path);
+        pending_paths_.push(root_path_.Append(i->filename_));
 
       if ((S_ISDIR(i->stat_.st_mode) && (file_type_ & DIRECTORIES)) ||
           (!S_ISDIR(i->stat_.st_mode) && (file_type_ & FILES)))
@@ -113,11 +105,28 @@ FilePath FileEnumerator::Next() {
 }
 
 FileEnumerator::FileInfo FileEnumerator::GetInfo() const {
-  return directory_entries_[current_directory_entry_];
+  FileInfo info = directory_entries_[current_directory_entry_];
+  if (info.stat_pending_) {
+    base::ThreadRestrictions::AssertIOAllowed();
+    FilePath full_name = root_path_.Append(info.filename_);
+    mode_t type = info.stat_.st_mode;
+    int ret;
+    if (file_type_ & SHOW_SYM_LINKS)
+      ret = lstat(full_name.value().c_str(), &info.stat_);
+    else
+      ret = stat(full_name.value().c_str(), &info.stat_);
+    if (ret < 0) {
+      // The entry went away since it was listed; keep reporting its type.
+      memset(&info.stat_, 0, sizeof(info.stat_));
+      info.stat_.st_mode = type;
+    }
+    info.stat_pending_ = false;
+  }
+  return info;
 }
 
 bool FileEnumerator::ReadDirectory(std::vector<FileInfo>* entries,
-                                   const FilePath& source, bool show_links) {
+                                   const FilePath& source) {
   base::ThreadRestrictions::AssertIOAllowed();
   DIR* dir = opendir(source.value().c_str());
   if (!dir)
@@ -129,13 +138,39 @@ bool FileEnumerator::ReadDirectory(std::vector<FileInfo>* entries,
          additional space for pathname may be needed
 #endif
 
+  const bool show_links = (file_type_ & SHOW_SYM_LINKS) != 0;
   struct dirent dent_buf;
   struct dirent* dent;
   while (readdir_r(dir, &dent_buf, &dent) == 0 && dent) {
+    FilePath full_name = source.Append(dent->d_name);
+    if (ShouldSkip(full_name))
+      continue;
+
+    if (pattern_.size() &&
+        fnmatch(pattern_.c_str(), full_name.value().c_str(), FNM_NOESCAPE))
+      continue;
+
     FileInfo info;
     info.filename_ = FilePath(dent->d_name);
 
-    FilePath full_name = source.Append(dent->d_name);
+#if !defined(OS_SOLARIS)
+    // Most file systems report the entry type, which is all Next() needs.
+    // A symlink still has to be stat()ed when links are followed.
+    mode_t type = 0;
+    if (dent->d_type == DT_DIR)
+      type = S_IFDIR;
+    else if (dent->d_type == DT_REG)
+      type = S_IFREG;
+    else if (dent->d_type == DT_LNK && show_links)
+      type = S_IFLNK;
+    if (type) {
+      info.stat_.st_mode = type;
+      info.stat_pending_ = true;
+      entries->push_back(info);
+      continue;
+    }
+#endif
+
     int ret;
     if (show_links)
       ret = lstat(full_name.value().c_str(), &info.stat_);
@@ -2,6 +2,10 @@
 
 #include "base/hash.h"
 
+#include <string.h>
+
+#include "base/sys_byteorder.h"
+
 typedef uint32 uint32_t;
 typedef uint16 uint16_t;
 
@@ -70,4 +74,97 @@ uint32 SuperFastHash(const char * data, int len) {
   return hash;
 }
 
+namespace {
+
+// xxHash64, from https://github.com/Cyan4973/xxHash (BSD license).
+const uint64 kPrime64_1 = GG_UINT64_C(11400714785074694791);
+const uint64 kPrime64_2 = GG_UINT64_C(14029467366897019727);
+const uint64 kPrime64_3 = GG_UINT64_C(1609587929392839161);
+const uint64 kPrime64_4 = GG_UINT64_C(9650029242287828579);
+const uint64 kPrime64_5 = GG_UINT64_C(2870177450012600261);
+
+inline uint64 RotateLeft64(uint64 x, int bits) {
+  return (x << bits) | (x >> (64 - bits));
+}
+
+// Reads little-endian values; memcpy() keeps unaligned reads legal.
+inline uint64 Read64(const char* p) {
+  uint64 value;
+  memcpy(&value, p, sizeof(value));
+  return ByteSwapToLE64(value);
+}
+
+inline uint32 Read32(const char* p) {
+  uint32 value;
+  memcpy(&value, p, sizeof(value));
+  return ByteSwapToLE32(value);
+}
+
+inline uint64 Round64(uint64 acc, uint64 input) {
+  acc += input * kPrime64_2;
+  acc = RotateLeft64(acc, 31);
+  return acc * kPrime64_1;
+}
+
+inline uint64 MergeRound64(uint64 acc, uint64 value) {
+  acc ^= Round64(0, value);
+  return acc * kPrime64_1 + kPrime64_4;
+}
+
+}  // namespace
+
+uint64 Hash64(const char* data, size_t length) {
+  const char* p = data;
+  const char* end = data + length;
+  uint64 hash;
+
+  if (length >= 32) {
+    // Four independent lanes, so the multiplies of one step can overlap.
+    const char* limit = end - 32;
+    uint64 v1 = kPrime64_1 + kPrime64_2;
+    uint64 v2 = kPrime64_2;
+    uint64 v3 = 0;
+    uint64 v4 = 0 - kPrime64_1;
+    do {
+      v1 = Round64(v1, Read64(p));
+      v2 = Round64(v2, Read64(p + 8));
+      v3 = Round64(v3, Read64(p + 16));
+      v4 = Round64(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    hash = RotateLeft64(v1, 1) + RotateLeft64(v2, 7) +
+           RotateLeft64(v3, 12) + RotateLeft64(v4, 18);
+    hash = MergeRound64(hash, v1);
+    hash = MergeRound64(hash, v2);
+    hash = MergeRound64(hash, v3);
+    hash = MergeRound64(hash, v4);
+  } else {
+    hash = kPrime64_5;
+  }
+
+  hash += static_cast<uint64>(length);
+
+  for (; p + 8 <= end; p += 8) {
+    hash ^= Round64(0, Read64(p));
+    hash = RotateLeft64(hash, 27) * kPrime64_1 + kPrime64_4;
+  }
+  if (p + 4 <= end) {
+    hash ^= static_cast<uint64>(Read32(p)) * kPrime64_1;
+    hash = RotateLeft64(hash, 23) * kPrime64_2 + kPrime64_3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash ^= static_cast<uint8>(*p) * kPrime64_5;
+    hash = RotateLeft64(hash, 11) * kPrime64_1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kPrime64_2;
+  hash ^= hash >> 29;
+  hash *= kPrime64_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
 }  // namespace base
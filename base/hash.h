@@ -26,6 +26,17 @@ inline uint32 Hash(const std::string& key) {
   return SuperFastHash(key.data(), static_cast<int>(key.size()));
 }
 
+// A fast 64-bit non-cryptographic hash (xxHash64 with a zero seed). It
+// consumes eight bytes per step, so it is several times faster than
+// SuperFastHash on long inputs, and 64 bits make collisions rare enough for
+// fingerprints and cache keys. Like Hash(), the value may be persisted: it is
+// the same on every platform and must not change.
+BASE_EXPORT uint64 Hash64(const char* data, size_t length);
+
+inline uint64 Hash64(const std::string& key) {
+  return Hash64(key.data(), key.size());
+}
+
 }  // namespace base
 
 #endif  // BASE_HASH_H_
@@ -0,0 +1,97 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the throughput of the hash functions in base across input sizes,
+// from cache keys to whole files.
+
+#include <algorithm>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/format_macros.h"
+#include "base/hash.h"
+#include "base/md5.h"
+#include "base/sha1.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace {
+
+// About 64 MB of input per measurement.
+const size_t kBytesPerMeasurement = 64 * 1024 * 1024;
+
+struct HashFunction {
+  const char* name;
+  // Returns part of the result, so the call can't be optimized away.
+  uint32 (*function)(const std::string& input);
+};
+
+uint32 RunSuperFastHash(const std::string& input) {
+  return Hash(input);
+}
+
+uint32 RunHash64(const std::string& input) {
+  return static_cast<uint32>(Hash64(input));
+}
+
+uint32 RunMD5(const std::string& input) {
+  MD5Digest digest;
+  MD5Sum(input.data(), input.size(), &digest);
+  return digest.a[0];
+}
+
+uint32 RunSHA1(const std::string& input) {
+  unsigned char hash[kSHA1Length];
+  SHA1HashBytes(reinterpret_cast<const unsigned char*>(input.data()),
+                input.size(), hash);
+  return hash[0];
+}
+
+const HashFunction kHashFunctions[] = {
+  { "super_fast_hash", &RunSuperFastHash },
+  { "hash64", &RunHash64 },
+  { "md5", &RunMD5 },
+  { "sha1", &RunSHA1 },
+};
+
+void RunHashBench(size_t size) {
+  std::string input(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    input[i] = static_cast<char>(i * 31 + 7);
+  const size_t iterations = std::max<size_t>(1, kBytesPerMeasurement / size);
+  std::string trace = StringPrintf("%" PRIuS "_bytes", size);
+
+  for (size_t f = 0; f < arraysize(kHashFunctions); ++f) {
+    uint32 result = 0;
+    TimeTicks begin = TimeTicks::HighResNow();
+    for (size_t i = 0; i < iterations; ++i)
+      result += kHashFunctions[f].function(input);
+    TimeDelta elapsed = TimeTicks::HighResNow() - begin;
+    perf_test::PrintResult(
+        kHashFunctions[f].name, "", trace,
+        size * iterations / elapsed.InSecondsF() / (1024 * 1024),
+        "MB/s", true);
+    // Keeps |result| alive.
+    EXPECT_NE(0xdeadbeef, result);
+  }
+}
+
+TEST(HashPerfTest, Small) {
+  RunHashBench(16);
+  RunHashBench(64);
+}
+
+TEST(HashPerfTest, Medium) {
+  RunHashBench(1024);
+}
+
+TEST(HashPerfTest, Large) {
+  RunHashBench(1024 * 1024);
+}
+
+}  // namespace
+}  // namespace base
@@ -0,0 +1,58 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(HashTest, String) {
+  std::string str;
+  // Empty string (should hash to 0).
+  str = "";
+  EXPECT_EQ(0u, Hash(str));
+
+  // Simple test.
+  str = "hello world";
+  EXPECT_EQ(Hash(str.data(), str.size()), Hash(str));
+
+  // Strings with embedded nulls hash differently from their prefix.
+  str.assign("hello\0world", 11);
+  EXPECT_NE(Hash(str), Hash(std::string("hello")));
+}
+
+// The values are persisted, so they must match the reference xxHash64.
+TEST(HashTest, Hash64KnownValues) {
+  EXPECT_EQ(GG_UINT64_C(0xef46db3751d8e999), Hash64(std::string()));
+  EXPECT_EQ(GG_UINT64_C(0xd24ec4f1a98c6e5b), Hash64(std::string("a")));
+  EXPECT_EQ(GG_UINT64_C(0x44bc2cf5ad770999), Hash64(std::string("abc")));
+  EXPECT_EQ(GG_UINT64_C(0x066ed728fceeb3be),
+            Hash64(std::string("message digest")));
+  EXPECT_EQ(GG_UINT64_C(0x0b242d361fda71bc),
+            Hash64(std::string("The quick brown fox jumps over the lazy dog")));
+
+  std::string bytes;
+  for (int i = 0; i < 1024; ++i)
+    bytes.push_back(static_cast<char>(i));
+  EXPECT_EQ(GG_UINT64_C(0x6f3914f18fe4df57), Hash64(bytes));
+}
+
+// Every length exercises a different mix of the 32-, 8-, 4- and 1-byte
+// steps, and unaligned input must not change the result.
+TEST(HashTest, Hash64LengthsAndAlignment) {
+  char buffer[80];
+  for (size_t i = 0; i < sizeof(buffer); ++i)
+    buffer[i] = static_cast<char>(i * 7);
+  std::string copy;
+  for (size_t length = 0; length < 64; ++length) {
+    copy.assign(buffer + 1, length);
+    EXPECT_EQ(Hash64(copy), Hash64(buffer + 1, length));
+    EXPECT_NE(Hash64(buffer + 1, length), Hash64(buffer + 1, length + 1));
+  }
+}
+
+}  // namespace base
@@ -193,6 +193,7 @@ JSONParser::JSONParser(int options)
       stack_depth_(0),
       line_number_(0),
       index_last_line_(0),
+      visitor_(NULL),
       error_code_(JSONReader::JSON_NO_ERROR),
       error_line_(0),
       error_column_(0) {
@@ -212,25 +213,7 @@ Value* JSONParser::Parse(const StringPiece& input) {
   } else {
     start_pos_ = input.data();
   }
-  pos_ = start_pos_;
-  end_pos_ = start_pos_ + input.length();
-  index_ = 0;
-  line_number_ = 1;
-  index_last_line_ = 0;
-
-  error_code_ = JSONReader::JSON_NO_ERROR;
-  error_line_ = 0;
-  error_column_ = 0;
-
-  // When the input JSON string starts with a UTF-8 Byte-Order-Mark
-  // <0xEF 0xBB 0xBF>, advance the start position to avoid the
-  // ParseNextToken function mis-treating a Unicode BOM as an invalid
-  // character and returning NULL.
-  if (CanConsume(3) && static_cast<uint8>(*pos_) == 0xEF &&
-      static_cast<uint8>(*(pos_ + 1)) == 0xBB &&
-      static_cast<uint8>(*(pos_ + 2)) == 0xBF) {
-    NextNChars(3);
-  }
+  StartParsing(start_pos_, input.length());
 
   // Parse the first and any nested tokens.
   scoped_ptr<Value> root(ParseNextToken());
@@ -238,12 +221,8 @@ Value* JSONParser::Parse(const StringPiece& input) {
     return NULL;
 
   // Make sure the input stream is at an end.
-  if (GetNextToken() != T_END_OF_INPUT) {
-    if (!CanConsume(1) || (NextChar() && GetNextToken() != T_END_OF_INPUT)) {
-      ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
-      return NULL;
-    }
-  }
+  if (!ReachedEndOfInput())
+    return NULL;
 
   // Dictionaries and lists can contain JSONStringValues, so wrap them in a
   // hidden root.
@@ -264,6 +243,16 @@ Value* JSONParser::Parse(const StringPiece& input) {
   return root.release();
 }
 
+bool JSONParser::Visit(const StringPiece& input, JSONVisitor* visitor) {
+  DCHECK(visitor);
+  // Nothing outlives the call, so strings can always point into |input|.
+  StartParsing(input.data(), input.length());
+  visitor_ = visitor;
+  bool result = VisitNextToken() && ReachedEndOfInput();
+  visitor_ = NULL;
+  return result;
+}
+
 JSONReader::JsonParseError JSONParser::error_code() const {
   return error_code_;
 }
@@ -336,6 +325,39 @@ const std::string& JSONParser::StringBuilder::AsString() {
 
 // JSONParser private //////////////////////////////////////////////////////////
 
+void JSONParser::StartParsing(const char* start, size_t length) {
+  start_pos_ = start;
+  pos_ = start_pos_;
+  end_pos_ = start_pos_ + length;
+  index_ = 0;
+  line_number_ = 1;
+  index_last_line_ = 0;
+
+  error_code_ = JSONReader::JSON_NO_ERROR;
+  error_line_ = 0;
+  error_column_ = 0;
+
+  // When the input JSON string starts with a UTF-8 Byte-Order-Mark
+  // <0xEF 0xBB 0xBF>, advance the start position to avoid the
+  // ParseNextToken function mis-treating a Unicode BOM as an invalid
+  // character and returning NULL.
+  if (CanConsume(3) && static_cast<uint8>(*pos_) == 0xEF &&
+      static_cast<uint8>(*(pos_ + 1)) == 0xBB &&
+      static_cast<uint8>(*(pos_ + 2)) == 0xBF) {
+    NextNChars(3);
+  }
+}
+
+bool JSONParser::ReachedEndOfInput() {
+  if (GetNextToken() != T_END_OF_INPUT) {
+    if (!CanConsume(1) || (NextChar() && GetNextToken() != T_END_OF_INPUT)) {
+      ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
+      return false;
+    }
+  }
+  return true;
+}
+
 inline bool JSONParser::CanConsume(int length) {
   return pos_ + length <= end_pos_;
 }
@@ -804,6 +826,24 @@ void JSONParser::DecodeUTF8(const int32& point, StringBuilder* dest) {
 }
 
 Value* JSONParser::ConsumeNumber() {
+  StringPiece num_string;
+  if (!ConsumeNumberRaw(&num_string))
+    return NULL;
+
+  int num_int;
+  if (StringToInt(num_string, &num_int))
+    return new FundamentalValue(num_int);
+
+  double num_double;
+  if (base::StringToDouble(num_string.as_string(), &num_double) &&
+      IsFinite(num_double)) {
+    return new FundamentalValue(num_double);
+  }
+
+  return NULL;
+}
+
+bool JSONParser::ConsumeNumberRaw(StringPiece* num_string) {
   const char* num_start = pos_;
   const int start_index = index_;
   int end_index = start_index;
@@ -813,7 +853,7 @@ Value* JSONParser::ConsumeNumber() {
 
   if (!ReadInt(false)) {
     ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-    return NULL;
+    return false;
   }
   end_index = index_;
 
@@ -821,12 +861,12 @@ Value* JSONParser::ConsumeNumber() {
   if (*pos_ == '.') {
     if (!CanConsume(1)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -838,7 +878,7 @@ Value* JSONParser::ConsumeNumber() {
       NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -858,25 +898,14 @@ Value* JSONParser::ConsumeNumber() {
       break;
     default:
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
   }
 
   pos_ = exit_pos;
   index_ = exit_index;
 
-  StringPiece num_string(num_start, end_index - start_index);
-
-  int num_int;
-  if (StringToInt(num_string, &num_int))
-    return new FundamentalValue(num_int);
-
-  double num_double;
-  if (base::StringToDouble(num_string.as_string(), &num_double) &&
-      IsFinite(num_double)) {
-    return new FundamentalValue(num_double);
-  }
-
-  return NULL;
+  *num_string = StringPiece(num_start, end_index - start_index);
+  return true;
 }
 
 bool JSONParser::ReadInt(bool allow_leading_zeros) {
@@ -900,45 +929,215 @@ bool JSONParser::ReadInt(bool allow_leading_zeros) {
 
 Value* JSONParser::ConsumeLiteral() {
   switch (*pos_) {
-    case 't': {
-      const char* kTrueLiteral = "true";
-      const int kTrueLen = static_cast<int>(strlen(kTrueLiteral));
-      if (!CanConsume(kTrueLen - 1) ||
-          !StringsAreEqual(pos_, kTrueLiteral, kTrueLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 't':
+      if (!ConsumeLiteralRaw("true"))
         return NULL;
-      }
-      NextNChars(kTrueLen - 1);
       return new FundamentalValue(true);
-    }
-    case 'f': {
-      const char* kFalseLiteral = "false";
-      const int kFalseLen = static_cast<int>(strlen(kFalseLiteral));
-      if (!CanConsume(kFalseLen - 1) ||
-          !StringsAreEqual(pos_, kFalseLiteral, kFalseLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 'f':
+      if (!ConsumeLiteralRaw("false"))
         return NULL;
-      }
-      NextNChars(kFalseLen - 1);
       return new FundamentalValue(false);
-    }
-    case 'n': {
-      const char* kNullLiteral = "null";
-      const int kNullLen = static_cast<int>(strlen(kNullLiteral));
-      if (!CanConsume(kNullLen - 1) ||
-          !StringsAreEqual(pos_, kNullLiteral, kNullLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 'n':
+      if (!ConsumeLiteralRaw("null"))
         return NULL;
-      }
-      NextNChars(kNullLen - 1);
       return Value::CreateNullValue();
-    }
     default:
       ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
       return NULL;
   }
 }
 
+bool JSONParser::ConsumeLiteralRaw(const char* literal) {
+  const int length = static_cast<int>(strlen(literal));
+  if (!CanConsume(length - 1) || !StringsAreEqual(pos_, literal, length)) {
+    ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    return false;
+  }
+  NextNChars(length - 1);
+  return true;
+}
+
+bool JSONParser::VisitNextToken() {
+  return VisitToken(GetNextToken());
+}
+
+bool JSONParser::VisitToken(Token token) {
+  switch (token) {
+    case T_OBJECT_BEGIN:
+      return VisitDictionary();
+    case T_ARRAY_BEGIN:
+      return VisitList();
+    case T_STRING:
+      return VisitString();
+    case T_NUMBER:
+      return VisitNumber();
+    case T_BOOL_TRUE:
+    case T_BOOL_FALSE:
+    case T_NULL:
+      return VisitLiteral();
+    default:
+      ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return false;
+  }
+}
+
+bool JSONParser::VisitDictionary() {
+  if (*pos_ != '{') {
+    ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+    return false;
+  }
+
+  StackMarker depth_check(&stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
+    return false;
+  }
+
+  if (!CheckVisitorResult(visitor_->OnDictionaryBegin()))
+    return false;
+
+  NextChar();
+  Token token = GetNextToken();
+  while (token != T_OBJECT_END) {
+    if (token != T_STRING) {
+      ReportError(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, 1);
+      return false;
+    }
+
+    // First consume the key.
+    StringBuilder key;
+    if (!ConsumeStringRaw(&key))
+      return false;
+    if (!CheckVisitorResult(visitor_->OnDictionaryKey(
+            key.CanBeStringPiece() ? key.AsStringPiece()
+                                   : StringPiece(key.AsString())))) {
+      return false;
+    }
+
+    // Read the separator.
+    NextChar();
+    token = GetNextToken();
+    if (token != T_OBJECT_PAIR_SEPARATOR) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+
+    // The next token is the value.
+    NextChar();
+    if (!VisitNextToken()) {
+      // ReportError from deeper level.
+      return false;
+    }
+
+    NextChar();
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      NextChar();
+      token = GetNextToken();
+      if (token == T_OBJECT_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_OBJECT_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+  }
+
+  return CheckVisitorResult(visitor_->OnDictionaryEnd());
+}
+
+bool JSONParser::VisitList() {
+  if (*pos_ != '[') {
+    ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+    return false;
+  }
+
+  StackMarker depth_check(&stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
+    return false;
+  }
+
+  if (!CheckVisitorResult(visitor_->OnListBegin()))
+    return false;
+
+  NextChar();
+  Token token = GetNextToken();
+  while (token != T_ARRAY_END) {
+    if (!VisitToken(token)) {
+      // ReportError from deeper level.
+      return false;
+    }
+
+    NextChar();
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      NextChar();
+      token = GetNextToken();
+      if (token == T_ARRAY_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_ARRAY_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+  }
+
+  return CheckVisitorResult(visitor_->OnListEnd());
+}
+
+bool JSONParser::VisitString() {
+  StringBuilder string;
+  if (!ConsumeStringRaw(&string))
+    return false;
+
+  return CheckVisitorResult(visitor_->OnString(
+      string.CanBeStringPiece() ? string.AsStringPiece()
+                                : StringPiece(string.AsString())));
+}
+
+bool JSONParser::VisitNumber() {
+  StringPiece num_string;
+  if (!ConsumeNumberRaw(&num_string))
+    return false;
+
+  int num_int;
+  if (StringToInt(num_string, &num_int))
+    return CheckVisitorResult(visitor_->OnInteger(num_int));
+
+  double num_double;
+  if (base::StringToDouble(num_string.as_string(), &num_double) &&
+      IsFinite(num_double)) {
+    return CheckVisitorResult(visitor_->OnDouble(num_double));
+  }
+
+  return false;
+}
+
+bool JSONParser::VisitLiteral() {
+  switch (*pos_) {
+    case 't':
+      return ConsumeLiteralRaw("true") &&
+          CheckVisitorResult(visitor_->OnBoolean(true));
+    case 'f':
+      return ConsumeLiteralRaw("false") &&
+          CheckVisitorResult(visitor_->OnBoolean(false));
+    case 'n':
+      return ConsumeLiteralRaw("null") &&
+          CheckVisitorResult(visitor_->OnNull());
+    default:
+      ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return false;
+  }
+}
+
+bool JSONParser::CheckVisitorResult(bool visitor_result) {
+  if (!visitor_result)
+    ReportError(JSONReader::JSON_PARSE_ABORTED, 1);
+  return visitor_result;
+}
 // static
 bool JSONParser::StringsAreEqual(const char* one, const char* two, size_t len) {
   return strncmp(one, two, len) == 0;
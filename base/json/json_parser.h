@@ -44,7 +44,8 @@ class JSONParserTest;
 //
 // This parser guarantees O(n) time through the input string. It also optimizes
 // base::StringValue by using StringPiece where possible when returning Value
-// objects by using "hidden roots," discussed in the implementation.
+// objects by using "hidden roots," discussed in the implementation. Visit()
+// skips building Values altogether and hands the tokens to a JSONVisitor.
 //
 // Iteration happens on the byte level, with the functions CanConsume and
 // NextChar. The conversion from byte to JSON token happens without advancing
@@ -66,6 +67,12 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // result as a Value owned by the caller.
   Value* Parse(const StringPiece& input);
 
+  // Parses the input string according to the set options and reports its
+  // contents to |visitor| instead of building a Value. Strings are passed as
+  // pieces of |input| where possible. Returns whether the whole input was
+  // valid and visited.
+  bool Visit(const StringPiece& input, JSONVisitor* visitor);
+
   // Returns the error code.
   JSONReader::JsonParseError error_code() const;
 
@@ -143,6 +150,14 @@ class BASE_EXPORT_PRIVATE JSONParser {
     std::string* string_;
   };
 
+  // Winds the parser to the start of the |length| bytes at |start|, skipping
+  // a UTF-8 Byte-Order-Mark, and clears the error information.
+  void StartParsing(const char* start, size_t length);
+
+  // Called once the root value has been consumed. Returns whether only
+  // whitespace and comments follow it, and reports an error otherwise.
+  bool ReachedEndOfInput();
+
   // Quick check that the stream has capacity to consume |length| more bytes.
   bool CanConsume(int length);
 
@@ -202,6 +217,10 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // Assuming that the parser is wound to the start of a valid JSON number,
   // this parses and converts it to either an int or double value.
   Value* ConsumeNumber();
+  // Helper for ConsumeNumber() and VisitNumber() that consumes the number and
+  // places its text in |num_string|. Returns false with error information set
+  // if it isn't valid.
+  bool ConsumeNumberRaw(StringPiece* num_string);
   // Helper that reads characters that are ints. Returns true if a number was
   // read and false on error.
   bool ReadInt(bool allow_leading_zeros);
@@ -209,6 +228,24 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // Consumes the literal values of |true|, |false|, and |null|, assuming the
   // parser is wound to the first character of any of those.
   Value* ConsumeLiteral();
+  // Helper that consumes |literal|, returning false with error information set
+  // if the input doesn't match it.
+  bool ConsumeLiteralRaw(const char* literal);
+
+  // Counterparts of the Parse and Consume functions above that report what
+  // they consume to |visitor_| instead of returning a Value. They return false
+  // if the input is invalid or the visitor stopped parsing.
+  bool VisitNextToken();
+  bool VisitToken(Token token);
+  bool VisitDictionary();
+  bool VisitList();
+  bool VisitString();
+  bool VisitNumber();
+  bool VisitLiteral();
+
+  // Reports JSON_PARSE_ABORTED unless |visitor_result| is true, and returns
+  // it.
+  bool CheckVisitorResult(bool visitor_result);
 
   // Compares two string buffers of a given length.
   static bool StringsAreEqual(const char* left, const char* right, size_t len);
@@ -248,6 +285,9 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // The last value of |index_| on the previous line.
   int index_last_line_;
 
+  // The visitor of the current Visit() call, or NULL.
+  JSONVisitor* visitor_;
+
   // Error information.
   JSONReader::JsonParseError error_code_;
   int error_line_;
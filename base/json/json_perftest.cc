@@ -0,0 +1,108 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares building a Value tree from a large JSON document with visiting the
+// same document through a JSONVisitor.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace {
+
+const int kIterations = 5;
+
+// Roughly the shape of a preferences file or an extension manifest.
+std::string GenerateJSON(int num_entries) {
+  std::string json("[");
+  for (int i = 0; i < num_entries; ++i) {
+    if (i)
+      json += ",";
+    StringAppendF(&json,
+                  "{\"name\": \"entry %d\", \"id\": %d, \"weight\": %d.5, "
+                  "\"enabled\": %s, \"tags\": [\"a\", \"b\", \"c\"], "
+                  "\"description\": \"line\\nbreak\", \"parent\": null}",
+                  i, i, i, i % 2 ? "true" : "false");
+  }
+  json += "]";
+  return json;
+}
+
+// Counts the values of a document, which is about the least work a visitor
+// can do.
+class CountingVisitor : public JSONVisitor {
+ public:
+  CountingVisitor() : count_(0) {}
+
+  virtual bool OnNull() OVERRIDE { return Count(); }
+  virtual bool OnBoolean(bool value) OVERRIDE { return Count(); }
+  virtual bool OnInteger(int value) OVERRIDE { return Count(); }
+  virtual bool OnDouble(double value) OVERRIDE { return Count(); }
+  virtual bool OnString(const StringPiece& value) OVERRIDE { return Count(); }
+  virtual bool OnDictionaryBegin() OVERRIDE { return Count(); }
+  virtual bool OnDictionaryKey(const StringPiece& key) OVERRIDE {
+    return true;
+  }
+  virtual bool OnDictionaryEnd() OVERRIDE { return true; }
+  virtual bool OnListBegin() OVERRIDE { return Count(); }
+  virtual bool OnListEnd() OVERRIDE { return true; }
+
+  int count() const { return count_; }
+
+ private:
+  bool Count() {
+    ++count_;
+    return true;
+  }
+
+  int count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingVisitor);
+};
+
+void Report(const std::string& trace, size_t size, TimeDelta elapsed) {
+  perf_test::PrintResult(
+      "json_parse", "", trace,
+      size * kIterations / elapsed.InSecondsF() / (1024 * 1024),
+      "MB/s", true);
+}
+
+void RunParseBench(int num_entries) {
+  std::string json = GenerateJSON(num_entries);
+  std::string trace = StringPrintf("%d_entries", num_entries);
+
+  TimeTicks begin = TimeTicks::HighResNow();
+  for (int i = 0; i < kIterations; ++i) {
+    scoped_ptr<Value> root(JSONReader::Read(json));
+    ASSERT_TRUE(root.get());
+  }
+  Report("tree_" + trace, json.size(), TimeTicks::HighResNow() - begin);
+
+  begin = TimeTicks::HighResNow();
+  for (int i = 0; i < kIterations; ++i) {
+    CountingVisitor visitor;
+    ASSERT_TRUE(JSONReader::Visit(json, JSON_PARSE_RFC, &visitor));
+    EXPECT_EQ(1 + 11 * num_entries, visitor.count());
+  }
+  Report("visitor_" + trace, json.size(), TimeTicks::HighResNow() - begin);
+}
+
+TEST(JSONPerfTest, ParseSmall) {
+  RunParseBench(100);
+}
+
+TEST(JSONPerfTest, ParseLarge) {
+  RunParseBench(20000);
+}
+
+}  // namespace
+}  // namespace base
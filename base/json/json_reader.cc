@@ -29,6 +29,8 @@ const char* JSONReader::kUnsupportedEncoding =
     "Unsupported encoding. JSON must be UTF-8.";
 const char* JSONReader::kUnquotedDictionaryKey =
     "Dictionary keys must be quoted.";
+const char* JSONReader::kParseAborted =
+    "Parsing was stopped by the visitor.";
 
 JSONReader::JSONReader()
     : parser_(new internal::JSONParser(JSON_PARSE_RFC)) {
@@ -72,6 +74,32 @@ Value* JSONReader::ReadAndReturnError(const StringPiece& json,
   return NULL;
 }
 
+// static
+bool JSONReader::Visit(const StringPiece& json,
+                       int options,
+                       JSONVisitor* visitor) {
+  internal::JSONParser parser(options);
+  return parser.Visit(json, visitor);
+}
+
+// static
+bool JSONReader::VisitAndReturnError(const StringPiece& json,
+                                     int options,
+                                     JSONVisitor* visitor,
+                                     int* error_code_out,
+                                     std::string* error_msg_out) {
+  internal::JSONParser parser(options);
+  if (parser.Visit(json, visitor))
+    return true;
+
+  if (error_code_out)
+    *error_code_out = parser.error_code();
+  if (error_msg_out)
+    *error_msg_out = parser.GetErrorMessage();
+
+  return false;
+}
+
 // static
 std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
   switch (error_code) {
@@ -93,6 +121,8 @@ std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
       return kUnsupportedEncoding;
     case JSON_UNQUOTED_DICTIONARY_KEY:
       return kUnquotedDictionaryKey;
+    case JSON_PARSE_ABORTED:
+      return kParseAborted;
     default:
       NOTREACHED();
       return std::string();
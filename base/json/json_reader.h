@@ -60,6 +60,33 @@ enum JSONParserOptions {
   JSON_DETACHABLE_CHILDREN = 1 << 1,
 };
 
+// Receives the contents of a JSON document from JSONReader::Visit() in
+// document order, without a Value tree being built. Strings are passed as
+// StringPieces that point into the input when the string contains no escape
+// sequences, and into a temporary buffer otherwise; either way they are only
+// guaranteed to be valid during the call. Returning false from any method
+// stops parsing.
+class BASE_EXPORT JSONVisitor {
+ public:
+  virtual ~JSONVisitor() {}
+
+  virtual bool OnNull() = 0;
+  virtual bool OnBoolean(bool value) = 0;
+  virtual bool OnInteger(int value) = 0;
+  virtual bool OnDouble(double value) = 0;
+  virtual bool OnString(const StringPiece& value) = 0;
+
+  // Called for each dictionary, then OnDictionaryKey() followed by the value
+  // for each of its entries, then OnDictionaryEnd().
+  virtual bool OnDictionaryBegin() = 0;
+  virtual bool OnDictionaryKey(const StringPiece& key) = 0;
+  virtual bool OnDictionaryEnd() = 0;
+
+  // Called for each list, with its items in between.
+  virtual bool OnListBegin() = 0;
+  virtual bool OnListEnd() = 0;
+};
+
 class BASE_EXPORT JSONReader {
  public:
   // Error codes during parsing.
@@ -73,6 +100,7 @@ class BASE_EXPORT JSONReader {
     JSON_UNEXPECTED_DATA_AFTER_ROOT,
     JSON_UNSUPPORTED_ENCODING,
     JSON_UNQUOTED_DICTIONARY_KEY,
+    JSON_PARSE_ABORTED,
     JSON_PARSE_ERROR_COUNT
   };
 
@@ -85,6 +113,7 @@ class BASE_EXPORT JSONReader {
   static const char* kUnexpectedDataAfterRoot;
   static const char* kUnsupportedEncoding;
   static const char* kUnquotedDictionaryKey;
+  static const char* kParseAborted;
 
   // Constructs a reader with the default options, JSON_PARSE_RFC.
   JSONReader();
@@ -112,6 +141,21 @@ class BASE_EXPORT JSONReader {
                                    int* error_code_out,
                                    std::string* error_msg_out);
 
+  // Parses |json| like Read(), but hands its contents to |visitor| instead of
+  // building a Value. Returns false if the input is not properly formed or
+  // the visitor stopped parsing; the visitor may have been called for a
+  // prefix of the input in that case. JSON_DETACHABLE_CHILDREN has no effect.
+  static bool Visit(const StringPiece& json, int options, JSONVisitor* visitor);
+
+  // Visits |json| like Visit(). |error_code_out| and |error_msg_out| are
+  // optional and populated like in ReadAndReturnError(). A visitor stopping
+  // the parse is reported as JSON_PARSE_ABORTED.
+  static bool VisitAndReturnError(const StringPiece& json,
+                                  int options,  // JSONParserOptions
+                                  JSONVisitor* visitor,
+                                  int* error_code_out,
+                                  std::string* error_msg_out);
+
   // Converts a JSON parse error code into a human readable message.
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
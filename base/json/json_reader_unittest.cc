@@ -9,6 +9,7 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
@@ -17,6 +18,59 @@
 
 namespace base {
 
+namespace {
+
+// Records every call as a space-separated token in |events_|, and stops the
+// parse once |calls_left_| reaches zero.
+class RecordingVisitor : public JSONVisitor {
+ public:
+  explicit RecordingVisitor(int max_calls) : calls_left_(max_calls) {}
+
+  virtual bool OnNull() OVERRIDE { return Record("null"); }
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    return Record(value ? "true" : "false");
+  }
+  virtual bool OnInteger(int value) OVERRIDE {
+    return Record("i" + IntToString(value));
+  }
+  virtual bool OnDouble(double value) OVERRIDE {
+    return Record("d" + DoubleToString(value));
+  }
+  virtual bool OnString(const StringPiece& value) OVERRIDE {
+    last_string_ = value;
+    return Record("s" + value.as_string());
+  }
+  virtual bool OnDictionaryBegin() OVERRIDE { return Record("{"); }
+  virtual bool OnDictionaryKey(const StringPiece& key) OVERRIDE {
+    return Record("k" + key.as_string());
+  }
+  virtual bool OnDictionaryEnd() OVERRIDE { return Record("}"); }
+  virtual bool OnListBegin() OVERRIDE { return Record("["); }
+  virtual bool OnListEnd() OVERRIDE { return Record("]"); }
+
+  const std::string& events() const { return events_; }
+  const StringPiece& last_string() const { return last_string_; }
+
+ private:
+  bool Record(const std::string& event) {
+    if (!calls_left_)
+      return false;
+    --calls_left_;
+    if (!events_.empty())
+      events_ += " ";
+    events_ += event;
+    return true;
+  }
+
+  int calls_left_;
+  std::string events_;
+  StringPiece last_string_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingVisitor);
+};
+
+}  // namespace
+
 TEST(JSONReaderTest, Reading) {
   // some whitespace checking
   scoped_ptr<Value> root;
@@ -653,4 +707,79 @@ TEST(JSONReaderTest, IllegalTrailingNull) {
   EXPECT_EQ(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, reader.error_code());
 }
 
+TEST(JSONReaderTest, Visit) {
+  RecordingVisitor visitor(-1);
+  EXPECT_TRUE(JSONReader::Visit(
+      "{\"a\": [1, -2.5, true, false, null], \"b\": {\"c\": \"d\"},"
+      " /* comment */ \"e\": []}",
+      JSON_PARSE_RFC, &visitor));
+  EXPECT_EQ("{ ka [ i1 d-2.5 true false null ] kb { kc sd } ke [ ] }",
+            visitor.events());
+
+  // Scalars can be the root too.
+  RecordingVisitor scalar_visitor(-1);
+  EXPECT_TRUE(JSONReader::Visit("  42  ", JSON_PARSE_RFC, &scalar_visitor));
+  EXPECT_EQ("i42", scalar_visitor.events());
+
+  // Trailing commas follow the options, as in Read().
+  RecordingVisitor comma_visitor(-1);
+  EXPECT_FALSE(JSONReader::Visit("[1,]", JSON_PARSE_RFC, &comma_visitor));
+  RecordingVisitor allowed_comma_visitor(-1);
+  EXPECT_TRUE(JSONReader::Visit("[1,]", JSON_ALLOW_TRAILING_COMMAS,
+                                &allowed_comma_visitor));
+  EXPECT_EQ("[ i1 ]", allowed_comma_visitor.events());
+}
+
+TEST(JSONReaderTest, VisitStringPieces) {
+  // Strings without escapes point into the input.
+  std::string json("[\"plain\"]");
+  RecordingVisitor visitor(-1);
+  EXPECT_TRUE(JSONReader::Visit(json, JSON_PARSE_RFC, &visitor));
+  EXPECT_EQ("plain", visitor.last_string());
+  EXPECT_EQ(json.data() + 2, visitor.last_string().data());
+
+  // Escaped strings are decoded.
+  RecordingVisitor escaped_visitor(-1);
+  EXPECT_TRUE(JSONReader::Visit("{\"k\\u0065y\": \"a\\nb\"}",
+                                JSON_PARSE_RFC, &escaped_visitor));
+  EXPECT_EQ("{ kkey sa\nb }", escaped_visitor.events());
+}
+
+TEST(JSONReaderTest, VisitErrors) {
+  const char* invalid_json[] = {
+      "{\"foo\"",
+      "[1 2]",
+      "{foo: 1}",
+      "[1] 2",
+      "tru",
+  };
+
+  for (size_t i = 0; i < arraysize(invalid_json); ++i) {
+    RecordingVisitor visitor(-1);
+    int error_code = JSONReader::JSON_NO_ERROR;
+    std::string error_message;
+    EXPECT_FALSE(JSONReader::VisitAndReturnError(
+        invalid_json[i], JSON_PARSE_RFC, &visitor, &error_code,
+        &error_message));
+
+    // Errors are the same as those of Read().
+    int read_error_code = JSONReader::JSON_NO_ERROR;
+    std::string read_error_message;
+    scoped_ptr<Value> root(JSONReader::ReadAndReturnError(
+        invalid_json[i], JSON_PARSE_RFC, &read_error_code,
+        &read_error_message));
+    EXPECT_FALSE(root.get());
+    EXPECT_EQ(read_error_code, error_code) << invalid_json[i];
+    EXPECT_EQ(read_error_message, error_message) << invalid_json[i];
+  }
+
+  // The visitor can stop the parse.
+  RecordingVisitor visitor(3);
+  int error_code = JSONReader::JSON_NO_ERROR;
+  EXPECT_FALSE(JSONReader::VisitAndReturnError(
+      "[1, 2, 3]", JSON_PARSE_RFC, &visitor, &error_code, NULL));
+  EXPECT_EQ(JSONReader::JSON_PARSE_ABORTED, error_code);
+  EXPECT_EQ("[ i1 i2", visitor.events());
+}
+
 }  // namespace base
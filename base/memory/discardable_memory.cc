@@ -77,10 +77,23 @@ DiscardableMemoryType DiscardableMemory::GetPreferredType() {
   return g_preferred_type;
 }
 
+// static
+scoped_ptr<DiscardableMemory> DiscardableMemory::CreateLockedMemoryWithType(
+    DiscardableMemoryType type, size_t size) {
+  return CreateLockedMemoryWithTypeAndCost(
+      type, size, DISCARDABLE_MEMORY_REGENERATION_COST_MEDIUM);
+}
+
 // static
 scoped_ptr<DiscardableMemory> DiscardableMemory::CreateLockedMemory(
     size_t size) {
   return CreateLockedMemoryWithType(GetPreferredType(), size);
 }
 
+// static
+scoped_ptr<DiscardableMemory> DiscardableMemory::CreateLockedMemoryWithCost(
+    size_t size, DiscardableMemoryRegenerationCost cost) {
+  return CreateLockedMemoryWithTypeAndCost(GetPreferredType(), size, cost);
+}
+
 }  // namespace base
@@ -23,6 +23,21 @@ enum DiscardableMemoryType {
   DISCARDABLE_MEMORY_TYPE_MALLOC
 };
 
+// How expensive it is to regenerate the contents of discardable memory after
+// they have been purged. Types that decide what to purge themselves (the
+// emulated type) purge the cheapest memory first and fall back to least
+// recently used order within a cost. Types backed by the OS ignore it.
+enum DiscardableMemoryRegenerationCost {
+  // Contents that are quick to rebuild, such as glyph caches.
+  DISCARDABLE_MEMORY_REGENERATION_COST_LOW,
+  // The default, for example raster tiles that can be rasterized again from
+  // recorded content.
+  DISCARDABLE_MEMORY_REGENERATION_COST_MEDIUM,
+  // Contents that take a lot of work to rebuild, such as decoded images.
+  DISCARDABLE_MEMORY_REGENERATION_COST_HIGH,
+  DISCARDABLE_MEMORY_REGENERATION_COST_COUNT
+};
+
 enum DiscardableMemoryLockStatus {
   DISCARDABLE_MEMORY_LOCK_STATUS_FAILED,
   DISCARDABLE_MEMORY_LOCK_STATUS_PURGED,
@@ -94,9 +109,21 @@ class BASE_EXPORT DiscardableMemory {
   static scoped_ptr<DiscardableMemory> CreateLockedMemoryWithType(
       DiscardableMemoryType type, size_t size);
 
+  // Create a DiscardableMemory instance with specified |type|, |size| and
+  // regeneration |cost|.
+  static scoped_ptr<DiscardableMemory> CreateLockedMemoryWithTypeAndCost(
+      DiscardableMemoryType type,
+      size_t size,
+      DiscardableMemoryRegenerationCost cost);
+
   // Create a DiscardableMemory instance with preferred type and |size|.
   static scoped_ptr<DiscardableMemory> CreateLockedMemory(size_t size);
 
+  // Create a DiscardableMemory instance with preferred type, |size| and
+  // regeneration |cost|.
+  static scoped_ptr<DiscardableMemory> CreateLockedMemoryWithCost(
+      size_t size, DiscardableMemoryRegenerationCost cost);
+
   // Locks the memory so that it will not be purged by the system. Returns
   // DISCARDABLE_MEMORY_LOCK_STATUS_SUCCESS on success. If the return value is
   // DISCARDABLE_MEMORY_LOCK_STATUS_FAILED then this object should be
@@ -134,8 +134,11 @@ void DiscardableMemory::GetSupportedTypes(
 }
 
 // static
-scoped_ptr<DiscardableMemory> DiscardableMemory::CreateLockedMemoryWithType(
-    DiscardableMemoryType type, size_t size) {
+scoped_ptr<DiscardableMemory>
+DiscardableMemory::CreateLockedMemoryWithTypeAndCost(
+    DiscardableMemoryType type,
+    size_t size,
+    DiscardableMemoryRegenerationCost cost) {
   switch (type) {
     case DISCARDABLE_MEMORY_TYPE_NONE:
     case DISCARDABLE_MEMORY_TYPE_MAC:
@@ -145,7 +148,7 @@ scoped_ptr<DiscardableMemory> DiscardableMemory::CreateLockedMemoryWithType(
     }
     case DISCARDABLE_MEMORY_TYPE_EMULATED: {
       scoped_ptr<internal::DiscardableMemoryEmulated> memory(
-          new internal::DiscardableMemoryEmulated(size));
+          new internal::DiscardableMemoryEmulated(size, cost));
       if (!memory->Initialize())
         return scoped_ptr<DiscardableMemory>();
 
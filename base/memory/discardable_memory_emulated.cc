@@ -18,9 +18,10 @@ base::LazyInstance<internal::DiscardableMemoryProvider>::Leaky g_provider =
 
 namespace internal {
 
-DiscardableMemoryEmulated::DiscardableMemoryEmulated(size_t size)
+DiscardableMemoryEmulated::DiscardableMemoryEmulated(
+    size_t size, DiscardableMemoryRegenerationCost cost)
     : is_locked_(false) {
-  g_provider.Pointer()->Register(this, size);
+  g_provider.Pointer()->Register(this, size, cost);
 }
 
 DiscardableMemoryEmulated::~DiscardableMemoryEmulated() {
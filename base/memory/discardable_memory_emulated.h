@@ -12,7 +12,8 @@ namespace internal {
 
 class DiscardableMemoryEmulated : public DiscardableMemory {
  public:
-  explicit DiscardableMemoryEmulated(size_t size);
+  DiscardableMemoryEmulated(size_t size,
+                            DiscardableMemoryRegenerationCost cost);
   virtual ~DiscardableMemoryEmulated();
 
   static void RegisterMemoryPressureListeners();
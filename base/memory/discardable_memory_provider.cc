@@ -8,6 +8,7 @@
 #include "base/containers/hash_tables.h"
 #include "base/containers/mru_cache.h"
 #include "base/debug/trace_event.h"
+#include "base/metrics/histogram.h"
 #include "base/synchronization/lock.h"
 #include "base/sys_info.h"
 
@@ -54,9 +55,13 @@ void DiscardableMemoryProvider::UnregisterMemoryPressureListener() {
 }
 
 void DiscardableMemoryProvider::SetDiscardableMemoryLimit(size_t bytes) {
-  AutoLock lock(lock_);
-  discardable_memory_limit_ = bytes;
-  EnforcePolicyWithLockAcquired();
+  PurgeStats stats;
+  {
+    AutoLock lock(lock_);
+    discardable_memory_limit_ = bytes;
+    EnforcePolicyWithLockAcquired(&stats);
+  }
+  RecordPurgeStats(stats);
 }
 
 void DiscardableMemoryProvider::SetBytesToReclaimUnderModeratePressure(
@@ -66,7 +71,9 @@ void DiscardableMemoryProvider::SetBytesToReclaimUnderModeratePressure(
 }
 
 void DiscardableMemoryProvider::Register(
-    const DiscardableMemory* discardable, size_t bytes) {
+    const DiscardableMemory* discardable,
+    size_t bytes,
+    DiscardableMemoryRegenerationCost cost) {
   AutoLock lock(lock_);
   // A registered memory listener is currently required. This DCHECK can be
   // moved or removed if we decide that it's useful to relax this condition.
@@ -74,7 +81,9 @@ void DiscardableMemoryProvider::Register(
   // register memory pressure listeners. crbug.com/333907
   // DCHECK(memory_pressure_listener_);
   DCHECK(allocations_.Peek(discardable) == allocations_.end());
-  allocations_.Put(discardable, Allocation(bytes));
+  DCHECK_GE(cost, 0);
+  DCHECK_LT(cost, DISCARDABLE_MEMORY_REGENERATION_COST_COUNT);
+  allocations_.Put(discardable, Allocation(bytes, cost));
 }
 
 void DiscardableMemoryProvider::Unregister(
@@ -96,7 +105,95 @@ void DiscardableMemoryProvider::Unregister(
 scoped_ptr<uint8, FreeDeleter> DiscardableMemoryProvider::Acquire(
     const DiscardableMemory* discardable,
     bool* purged) {
+  PurgeStats stats;
+  scoped_ptr<uint8, FreeDeleter> memory;
+  {
+    AutoLock lock(lock_);
+    memory = AcquireWithLockAcquired(discardable, purged, &stats);
+  }
+  RecordPurgeStats(stats);
+  return memory.Pass();
+}
+
+void DiscardableMemoryProvider::Release(
+    const DiscardableMemory* discardable,
+    scoped_ptr<uint8, FreeDeleter> memory) {
+  PurgeStats stats;
+  {
+    AutoLock lock(lock_);
+    // NB: |allocations_| is an MRU cache, and use of |Get| here updates that
+    // cache.
+    AllocationMap::iterator it = allocations_.Get(discardable);
+    CHECK(it != allocations_.end());
+
+    DCHECK(!it->second.memory);
+    it->second.memory = memory.release();
+
+    EnforcePolicyWithLockAcquired(&stats);
+  }
+  RecordPurgeStats(stats);
+}
+
+void DiscardableMemoryProvider::PurgeAll() {
+  PurgeStats stats;
+  {
+    AutoLock lock(lock_);
+    PurgeLRUWithLockAcquiredUntilUsageIsWithin(0, &stats);
+  }
+  RecordPurgeStats(stats);
+}
+
+bool DiscardableMemoryProvider::IsRegisteredForTest(
+    const DiscardableMemory* discardable) const {
+  AutoLock lock(lock_);
+  AllocationMap::const_iterator it = allocations_.Peek(discardable);
+  return it != allocations_.end();
+}
+
+bool DiscardableMemoryProvider::CanBePurgedForTest(
+    const DiscardableMemory* discardable) const {
+  AutoLock lock(lock_);
+  AllocationMap::const_iterator it = allocations_.Peek(discardable);
+  return it != allocations_.end() && it->second.memory;
+}
+
+size_t DiscardableMemoryProvider::GetBytesAllocatedForTest() const {
   AutoLock lock(lock_);
+  return bytes_allocated_;
+}
+
+DiscardableMemoryProvider::PurgeStats::PurgeStats() : bytes(0) {
+  for (int i = 0; i < DISCARDABLE_MEMORY_REGENERATION_COST_COUNT; ++i)
+    allocations[i] = 0;
+}
+
+// static
+void DiscardableMemoryProvider::RecordPurgeStats(const PurgeStats& stats) {
+  if (!stats.bytes)
+    return;
+
+  HistogramBase* histogram = LinearHistogram::FactoryGet(
+      "Memory.DiscardableMemory.PurgedCost",
+      1,
+      DISCARDABLE_MEMORY_REGENERATION_COST_COUNT,
+      DISCARDABLE_MEMORY_REGENERATION_COST_COUNT + 1,
+      HistogramBase::kUmaTargetedHistogramFlag);
+  for (int cost = 0; cost < DISCARDABLE_MEMORY_REGENERATION_COST_COUNT;
+       ++cost) {
+    if (stats.allocations[cost])
+      histogram->AddCount(cost, stats.allocations[cost]);
+  }
+  UMA_HISTOGRAM_MEMORY_KB("Memory.DiscardableMemory.PurgedKB",
+                          stats.bytes / 1024);
+}
+
+scoped_ptr<uint8, FreeDeleter>
+DiscardableMemoryProvider::AcquireWithLockAcquired(
+    const DiscardableMemory* discardable,
+    bool* purged,
+    PurgeStats* stats) {
+  lock_.AssertAcquired();
+
   // NB: |allocations_| is an MRU cache, and use of |Get| here updates that
   // cache.
   AllocationMap::iterator it = allocations_.Get(discardable);
@@ -118,7 +215,7 @@ scoped_ptr<uint8, FreeDeleter> DiscardableMemoryProvider::Acquire(
     if (bytes < discardable_memory_limit_)
       limit = discardable_memory_limit_ - bytes;
 
-    PurgeLRUWithLockAcquiredUntilUsageIsWithin(limit);
+    PurgeLRUWithLockAcquiredUntilUsageIsWithin(limit, stats);
   }
 
   // Check for overflow.
@@ -134,45 +231,6 @@ scoped_ptr<uint8, FreeDeleter> DiscardableMemoryProvider::Acquire(
   return memory.Pass();
 }
 
-void DiscardableMemoryProvider::Release(
-    const DiscardableMemory* discardable,
-    scoped_ptr<uint8, FreeDeleter> memory) {
-  AutoLock lock(lock_);
-  // NB: |allocations_| is an MRU cache, and use of |Get| here updates that
-  // cache.
-  AllocationMap::iterator it = allocations_.Get(discardable);
-  CHECK(it != allocations_.end());
-
-  DCHECK(!it->second.memory);
-  it->second.memory = memory.release();
-
-  EnforcePolicyWithLockAcquired();
-}
-
-void DiscardableMemoryProvider::PurgeAll() {
-  AutoLock lock(lock_);
-  PurgeLRUWithLockAcquiredUntilUsageIsWithin(0);
-}
-
-bool DiscardableMemoryProvider::IsRegisteredForTest(
-    const DiscardableMemory* discardable) const {
-  AutoLock lock(lock_);
-  AllocationMap::const_iterator it = allocations_.Peek(discardable);
-  return it != allocations_.end();
-}
-
-bool DiscardableMemoryProvider::CanBePurgedForTest(
-    const DiscardableMemory* discardable) const {
-  AutoLock lock(lock_);
-  AllocationMap::const_iterator it = allocations_.Peek(discardable);
-  return it != allocations_.end() && it->second.memory;
-}
-
-size_t DiscardableMemoryProvider::GetBytesAllocatedForTest() const {
-  AutoLock lock(lock_);
-  return bytes_allocated_;
-}
-
 void DiscardableMemoryProvider::OnMemoryPressure(
     MemoryPressureListener::MemoryPressureLevel pressure_level) {
   switch (pressure_level) {
@@ -188,20 +246,25 @@ void DiscardableMemoryProvider::OnMemoryPressure(
 }
 
 void DiscardableMemoryProvider::Purge() {
-  AutoLock lock(lock_);
+  PurgeStats stats;
+  {
+    AutoLock lock(lock_);
 
-  if (bytes_to_reclaim_under_moderate_pressure_ == 0)
-    return;
+    if (bytes_to_reclaim_under_moderate_pressure_ == 0)
+      return;
 
-  size_t limit = 0;
-  if (bytes_to_reclaim_under_moderate_pressure_ < bytes_allocated_)
-    limit = bytes_allocated_ - bytes_to_reclaim_under_moderate_pressure_;
+    size_t limit = 0;
+    if (bytes_to_reclaim_under_moderate_pressure_ < bytes_allocated_)
+      limit = bytes_allocated_ - bytes_to_reclaim_under_moderate_pressure_;
 
-  PurgeLRUWithLockAcquiredUntilUsageIsWithin(limit);
+    PurgeLRUWithLockAcquiredUntilUsageIsWithin(limit, &stats);
+  }
+  RecordPurgeStats(stats);
 }
 
 void DiscardableMemoryProvider::PurgeLRUWithLockAcquiredUntilUsageIsWithin(
-    size_t limit) {
+    size_t limit,
+    PurgeStats* stats) {
   TRACE_EVENT1(
       "base",
       "DiscardableMemoryProvider::PurgeLRUWithLockAcquiredUntilUsageIsWithin",
@@ -209,24 +272,37 @@ void DiscardableMemoryProvider::PurgeLRUWithLockAcquiredUntilUsageIsWithin(
 
   lock_.AssertAcquired();
 
-  for (AllocationMap::reverse_iterator it = allocations_.rbegin();
-       it != allocations_.rend();
-       ++it) {
-    if (bytes_allocated_ <= limit)
-      break;
-    if (!it->second.memory)
-      continue;
+  if (bytes_allocated_ <= limit)
+    return;
 
-    size_t bytes = it->second.bytes;
-    DCHECK_LE(bytes, bytes_allocated_);
-    bytes_allocated_ -= bytes;
-    free(it->second.memory);
-    it->second.memory = NULL;
+  // One pass per cost, cheapest first, each in LRU order. The number of costs
+  // is small, so this beats keeping a separate LRU list per cost.
+  for (int cost = 0;
+       cost < DISCARDABLE_MEMORY_REGENERATION_COST_COUNT &&
+           bytes_allocated_ > limit;
+       ++cost) {
+    for (AllocationMap::reverse_iterator it = allocations_.rbegin();
+         it != allocations_.rend();
+         ++it) {
+      if (bytes_allocated_ <= limit)
+        break;
+      if (!it->second.memory || it->second.cost != cost)
+        continue;
+
+      size_t bytes = it->second.bytes;
+      DCHECK_LE(bytes, bytes_allocated_);
+      bytes_allocated_ -= bytes;
+      stats->bytes += bytes;
+      ++stats->allocations[cost];
+      free(it->second.memory);
+      it->second.memory = NULL;
+    }
   }
 }
 
-void DiscardableMemoryProvider::EnforcePolicyWithLockAcquired() {
-  PurgeLRUWithLockAcquiredUntilUsageIsWithin(discardable_memory_limit_);
+void DiscardableMemoryProvider::EnforcePolicyWithLockAcquired(
+    PurgeStats* stats) {
+  PurgeLRUWithLockAcquiredUntilUsageIsWithin(discardable_memory_limit_, stats);
 }
 
 }  // namespace internal
@@ -8,13 +8,10 @@
 #include "base/base_export.h"
 #include "base/containers/hash_tables.h"
 #include "base/containers/mru_cache.h"
+#include "base/memory/discardable_memory.h"
 #include "base/memory/memory_pressure_listener.h"
 #include "base/synchronization/lock.h"
 
-namespace base {
-class DiscardableMemory;
-}  // namespace base
-
 #if defined(COMPILER_GCC)
 namespace BASE_HASH_NAMESPACE {
 template <>
@@ -35,9 +32,11 @@ namespace internal {
 // instances (in case they need to be purged), and the total amount of
 // allocated memory (in case this forces a purge).
 //
-// When notified of memory pressure, the provider either purges the LRU
+// When notified of memory pressure, the provider either purges part of the
 // memory -- if the pressure is moderate -- or all discardable memory
-// if the pressure is critical.
+// if the pressure is critical. Memory is purged in order of its
+// DiscardableMemoryRegenerationCost, cheapest first, and in LRU order within a
+// cost, so contents that are expensive to rebuild survive longest.
 //
 // NB - this class is an implementation detail. It has been exposed for testing
 // purposes. You should not need to use this class directly.
@@ -62,7 +61,9 @@ class BASE_EXPORT_PRIVATE DiscardableMemoryProvider {
   void SetBytesToReclaimUnderModeratePressure(size_t bytes);
 
   // Adds the given discardable memory to the provider's collection.
-  void Register(const DiscardableMemory* discardable, size_t bytes);
+  void Register(const DiscardableMemory* discardable,
+                size_t bytes,
+                DiscardableMemoryRegenerationCost cost);
 
   // Removes the given discardable memory from the provider's collection.
   void Unregister(const DiscardableMemory* discardable);
@@ -95,16 +96,35 @@ class BASE_EXPORT_PRIVATE DiscardableMemoryProvider {
 
  private:
   struct Allocation {
-   explicit Allocation(size_t bytes)
-       : bytes(bytes),
-         memory(NULL) {
-   }
+    Allocation(size_t bytes, DiscardableMemoryRegenerationCost cost)
+        : bytes(bytes),
+          cost(cost),
+          memory(NULL) {
+    }
 
     size_t bytes;
+    DiscardableMemoryRegenerationCost cost;
     uint8* memory;
   };
   typedef HashingMRUCache<const DiscardableMemory*, Allocation> AllocationMap;
 
+  // What a purge freed. It is filled in with |lock_| held and reported to UMA
+  // by RecordPurgeStats() once the lock has been released.
+  struct PurgeStats {
+    PurgeStats();
+
+    size_t bytes;
+    int allocations[DISCARDABLE_MEMORY_REGENERATION_COST_COUNT];
+  };
+
+  // Reports |stats| to UMA. Must be called without |lock_| held.
+  static void RecordPurgeStats(const PurgeStats& stats);
+
+  // Implements Acquire(). Caller must acquire |lock_| prior to calling this
+  // function.
+  scoped_ptr<uint8, FreeDeleter> AcquireWithLockAcquired(
+      const DiscardableMemory* discardable, bool* purged, PurgeStats* stats);
+
   // This can be called as a hint that the system is under memory pressure.
   void OnMemoryPressure(
       MemoryPressureListener::MemoryPressureLevel pressure_level);
@@ -113,13 +133,15 @@ class BASE_EXPORT_PRIVATE DiscardableMemoryProvider {
   // discardable memory.
   void Purge();
 
-  // Purges least recently used memory until usage is less or equal to |limit|.
-  // Caller must acquire |lock_| prior to calling this function.
-  void PurgeLRUWithLockAcquiredUntilUsageIsWithin(size_t limit);
+  // Purges the cheapest to regenerate, least recently used memory until usage
+  // is less or equal to |limit|, and adds what was purged to |stats|. Caller
+  // must acquire |lock_| prior to calling this function.
+  void PurgeLRUWithLockAcquiredUntilUsageIsWithin(size_t limit,
+                                                  PurgeStats* stats);
 
   // Ensures that we don't allocate beyond our memory limit.
   // Caller must acquire |lock_| prior to calling this function.
-  void EnforcePolicyWithLockAcquired();
+  void EnforcePolicyWithLockAcquired(PurgeStats* stats);
 
   // Needs to be held when accessing members.
   mutable Lock lock_;
@@ -6,8 +6,11 @@
 
 #include "base/bind.h"
 #include "base/memory/discardable_memory.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/statistics_recorder.h"
 #include "base/run_loop.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/test/statistics_delta_reader.h"
 #include "base/threading/thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -18,10 +21,12 @@ class DiscardableMemoryProviderTestBase {
   class TestDiscardableMemory : public DiscardableMemory {
    public:
     TestDiscardableMemory(
-        internal::DiscardableMemoryProvider* provider, size_t size)
+        internal::DiscardableMemoryProvider* provider,
+        size_t size,
+        DiscardableMemoryRegenerationCost cost)
         : provider_(provider),
           is_locked_(false) {
-      provider_->Register(this, size);
+      provider_->Register(this, size, cost);
     }
 
     virtual ~TestDiscardableMemory() {
@@ -64,6 +69,8 @@ class DiscardableMemoryProviderTestBase {
   DiscardableMemoryProviderTestBase()
       : provider_(new internal::DiscardableMemoryProvider) {
     provider_->RegisterMemoryPressureListener();
+    StatisticsRecorder::Initialize();
+    statistics_delta_reader_.reset(new StatisticsDeltaReader);
   }
 
  protected:
@@ -91,9 +98,23 @@ class DiscardableMemoryProviderTestBase {
     provider_->SetBytesToReclaimUnderModeratePressure(bytes);
   }
 
+  // Returns how many allocations of |cost| were purged, as reported to UMA.
+  int AllocationsPurged(DiscardableMemoryRegenerationCost cost) const {
+    scoped_ptr<HistogramSamples> samples(
+        statistics_delta_reader_->GetHistogramSamplesSinceCreation(
+            "Memory.DiscardableMemory.PurgedCost"));
+    return samples ? samples->GetCount(cost) : 0;
+  }
+
   scoped_ptr<DiscardableMemory> CreateLockedMemory(size_t size) {
+    return CreateLockedMemoryWithCost(
+        size, DISCARDABLE_MEMORY_REGENERATION_COST_MEDIUM);
+  }
+
+  scoped_ptr<DiscardableMemory> CreateLockedMemoryWithCost(
+      size_t size, DiscardableMemoryRegenerationCost cost) {
     scoped_ptr<TestDiscardableMemory> memory(
-        new TestDiscardableMemory(provider_.get(), size));
+        new TestDiscardableMemory(provider_.get(), size, cost));
     if (memory->Lock() != DISCARDABLE_MEMORY_LOCK_STATUS_PURGED)
       return scoped_ptr<DiscardableMemory>();
     return memory.PassAs<DiscardableMemory>();
@@ -102,6 +123,7 @@ class DiscardableMemoryProviderTestBase {
  private:
   MessageLoopForIO message_loop_;
   scoped_ptr<internal::DiscardableMemoryProvider> provider_;
+  scoped_ptr<StatisticsDeltaReader> statistics_delta_reader_;
 };
 
 class DiscardableMemoryProviderTest
@@ -322,6 +344,73 @@ INSTANTIATE_TEST_CASE_P(DiscardableMemoryProviderPermutationTests,
                                           PermutationTestData(2, 0, 1),
                                           PermutationTestData(2, 1, 0)));
 
+// Verify that memory that is cheap to regenerate is purged first, even when it
+// was used more recently.
+TEST_F(DiscardableMemoryProviderTest, CheapestDiscardedFirst) {
+  const scoped_ptr<DiscardableMemory> expensive(CreateLockedMemoryWithCost(
+      1024, DISCARDABLE_MEMORY_REGENERATION_COST_HIGH));
+  const scoped_ptr<DiscardableMemory> medium(CreateLockedMemoryWithCost(
+      1024, DISCARDABLE_MEMORY_REGENERATION_COST_MEDIUM));
+  const scoped_ptr<DiscardableMemory> cheap(CreateLockedMemoryWithCost(
+      1024, DISCARDABLE_MEMORY_REGENERATION_COST_LOW));
+  ASSERT_TRUE(expensive);
+  ASSERT_TRUE(medium);
+  ASSERT_TRUE(cheap);
+  // Unlock the cheap memory last, so it is the most recently used.
+  expensive->Unlock();
+  medium->Unlock();
+  cheap->Unlock();
+
+  SetBytesToReclaimUnderModeratePressure(1024);
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_MODERATE);
+  RunLoop().RunUntilIdle();
+
+  EXPECT_FALSE(CanBePurged(cheap.get()));
+  EXPECT_TRUE(CanBePurged(medium.get()));
+  EXPECT_TRUE(CanBePurged(expensive.get()));
+  EXPECT_EQ(1, AllocationsPurged(DISCARDABLE_MEMORY_REGENERATION_COST_LOW));
+
+  SetDiscardableMemoryLimit(1024);
+  EXPECT_FALSE(CanBePurged(medium.get()));
+  EXPECT_TRUE(CanBePurged(expensive.get()));
+  EXPECT_EQ(1,
+            AllocationsPurged(DISCARDABLE_MEMORY_REGENERATION_COST_MEDIUM));
+  EXPECT_EQ(0, AllocationsPurged(DISCARDABLE_MEMORY_REGENERATION_COST_HIGH));
+
+  EXPECT_EQ(DISCARDABLE_MEMORY_LOCK_STATUS_SUCCESS, expensive->Lock());
+  EXPECT_EQ(DISCARDABLE_MEMORY_LOCK_STATUS_PURGED, medium->Lock());
+  EXPECT_EQ(DISCARDABLE_MEMORY_LOCK_STATUS_PURGED, cheap->Lock());
+}
+
+// Verify that memory of the same cost is still purged in LRU order.
+TEST_F(DiscardableMemoryProviderTest, LRUWithinCost) {
+  const scoped_ptr<DiscardableMemory> cheap_old(CreateLockedMemoryWithCost(
+      1024, DISCARDABLE_MEMORY_REGENERATION_COST_LOW));
+  const scoped_ptr<DiscardableMemory> cheap_new(CreateLockedMemoryWithCost(
+      1024, DISCARDABLE_MEMORY_REGENERATION_COST_LOW));
+  const scoped_ptr<DiscardableMemory> expensive(CreateLockedMemoryWithCost(
+      1024, DISCARDABLE_MEMORY_REGENERATION_COST_HIGH));
+  ASSERT_TRUE(cheap_old);
+  ASSERT_TRUE(cheap_new);
+  ASSERT_TRUE(expensive);
+  expensive->Unlock();
+  cheap_old->Unlock();
+  cheap_new->Unlock();
+
+  SetDiscardableMemoryLimit(2048);
+  EXPECT_FALSE(CanBePurged(cheap_old.get()));
+  EXPECT_TRUE(CanBePurged(cheap_new.get()));
+  EXPECT_TRUE(CanBePurged(expensive.get()));
+
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_CRITICAL);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(0u, BytesAllocated());
+  EXPECT_EQ(2, AllocationsPurged(DISCARDABLE_MEMORY_REGENERATION_COST_LOW));
+  EXPECT_EQ(1, AllocationsPurged(DISCARDABLE_MEMORY_REGENERATION_COST_HIGH));
+}
+
 TEST_F(DiscardableMemoryProviderTest, NormalDestruction) {
   {
     size_t size = 1024;
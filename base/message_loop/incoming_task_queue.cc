@@ -8,13 +8,39 @@
 #include "base/location.h"
 #include "base/message_loop/message_loop.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/threading/thread_restrictions.h"
 
 namespace base {
 namespace internal {
 
+namespace {
+
+// Upper bound on the number of nodes kept in the free list. Keeps a burst of
+// posts from pinning memory forever.
+const int kMaxFreeNodes = 256;
+
+}  // namespace
+
+struct IncomingTaskQueue::Node : public IncomingTaskQueue::Link {
+  explicit Node(const PendingTask& pending_task) : task(pending_task) {}
+  PendingTask task;
+};
+
 IncomingTaskQueue::IncomingTaskQueue(MessageLoop* message_loop)
-    : message_loop_(message_loop),
+    : head_(reinterpret_cast<subtle::AtomicWord>(&stub_)),
+      tail_(&stub_),
+      incoming_task_count_(0),
+      reload_requested_(0),
+      free_nodes_(0),
+      free_node_count_(0),
+      message_loop_(message_loop),
+      accepting_tasks_(1),
+      active_producer_count_(0),
+      producers_done_(&producers_lock_),
       next_sequence_num_(0) {
+#if defined(OS_WIN)
+  subtle::NoBarrier_Store(&high_resolution_timer_active_, 0);
+#endif
 }
 
 bool IncomingTaskQueue::AddToIncomingQueue(
@@ -22,10 +48,22 @@ bool IncomingTaskQueue::AddToIncomingQueue(
     const Closure& task,
     TimeDelta delay,
     bool nestable) {
-  AutoLock locked(incoming_queue_lock_);
-  PendingTask pending_task(
-      from_here, task, CalculateDelayedRuntime(delay), nestable);
-  return PostPendingTask(&pending_task);
+  // Announce ourselves before looking at |accepting_tasks_| so that
+  // WillDestroyCurrentMessageLoop() either sees us and waits, or we see it and
+  // back off. Both sides use full barriers, so one of the two always happens.
+  subtle::Barrier_AtomicIncrement(&active_producer_count_, 1);
+  bool accepted = false;
+  if (subtle::Acquire_Load(&accepting_tasks_)) {
+    PendingTask pending_task(
+        from_here, task, CalculateDelayedRuntime(delay), nestable);
+    accepted = PostPendingTask(&pending_task);
+  }
+  if (subtle::Barrier_AtomicIncrement(&active_producer_count_, -1) == 0 &&
+      !subtle::NoBarrier_Load(&accepting_tasks_)) {
+    AutoLock lock(producers_lock_);
+    producers_done_.Signal();
+  }
+  return accepted;
 }
 
 bool IncomingTaskQueue::IsHighResolutionTimerEnabledForTesting() {
@@ -37,74 +75,156 @@ bool IncomingTaskQueue::IsHighResolutionTimerEnabledForTesting() {
 }
 
 bool IncomingTaskQueue::IsIdleForTesting() {
-  AutoLock lock(incoming_queue_lock_);
-  return incoming_queue_.empty();
+  return subtle::Acquire_Load(&incoming_task_count_) <= 0;
+}
+
+int IncomingTaskQueue::GetFreeNodeCountForTesting() {
+  return subtle::NoBarrier_Load(&free_node_count_);
 }
 
 void IncomingTaskQueue::ReloadWorkQueue(TaskQueue* work_queue) {
   // Make sure no tasks are lost.
   DCHECK(work_queue->empty());
 
-  // Acquire all we can from the inter-thread queue with one lock acquisition.
-  AutoLock lock(incoming_queue_lock_);
-  if (!incoming_queue_.empty())
-    incoming_queue_.Swap(work_queue);  // Constant time
+  // Take everything that has been fully linked in one pass, without blocking
+  // any producer.
+  int taken = 0;
+  int recycled = 0;
+  int max_recycled =
+      kMaxFreeNodes - subtle::NoBarrier_Load(&free_node_count_);
+  Link* recycled_first = NULL;
+  Link* recycled_last = NULL;
+  while (Node* node = Pop()) {
+    work_queue->push(node->task);
+    ++taken;
+    if (recycled >= max_recycled) {
+      delete node;
+      continue;
+    }
+    ++recycled;
+    // Drop the node's reference to the closure so that it is destroyed once
+    // the task has run, as before.
+    node->task.task.Reset();
+    subtle::NoBarrier_Store(&node->next,
+                            reinterpret_cast<subtle::AtomicWord>(
+                                recycled_first));
+    recycled_first = node;
+    if (!recycled_last)
+      recycled_last = node;
+  }
+  if (recycled_first) {
+    subtle::NoBarrier_AtomicIncrement(&free_node_count_, recycled);
+    RecycleNodes(recycled_first, recycled_last);
+  }
 
-  DCHECK(incoming_queue_.empty());
+  // Producers only wake the pump when they find the queue empty, so if posts
+  // completed while we were draining the loop has to come back for them.
+  if (subtle::Barrier_AtomicIncrement(&incoming_task_count_, -taken) <= 0)
+    return;
+  if (!IsLinkPending()) {
+    message_loop_->ScheduleWork(true);
+    return;
+  }
+  // The remaining posts are queued behind a node whose producer has claimed
+  // the head but not linked it yet. Rescheduling now would only spin until it
+  // does, so leave the wake-up to that producer instead. Either it sees
+  // |reload_requested_|, or we see its link; the full barriers on both sides
+  // rule out missing both.
+  subtle::NoBarrier_Store(&reload_requested_, 1);
+  subtle::MemoryBarrier();
+  if (!IsLinkPending() && TakeReloadRequest())
+    message_loop_->ScheduleWork(true);
 }
 
 void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
 #if defined(OS_WIN)
-  // If we left the high-resolution timer activated, deactivate it now.
-  // Doing this is not-critical, it is mainly to make sure we track
-  // the high resolution timer activations properly in our unit tests.
-  if (!high_resolution_timer_expiration_.is_null()) {
-    Time::ActivateHighResolutionTimer(false);
-    high_resolution_timer_expiration_ = TimeTicks();
+  {
+    // If we left the high-resolution timer activated, deactivate it now.
+    // Doing this is not-critical, it is mainly to make sure we track
+    // the high resolution timer activations properly in our unit tests.
+    AutoLock lock(high_resolution_timer_lock_);
+    if (!high_resolution_timer_expiration_.is_null()) {
+      Time::ActivateHighResolutionTimer(false);
+      high_resolution_timer_expiration_ = TimeTicks();
+      subtle::NoBarrier_Store(&high_resolution_timer_active_, 0);
+    }
   }
 #endif
 
-  AutoLock lock(incoming_queue_lock_);
+  // Stop accepting tasks and wait for the posts already in flight, which may
+  // still dereference |message_loop_|, to finish.
+  // The last producer to leave signals |producers_done_|, see
+  // AddToIncomingQueue().
+  subtle::NoBarrier_Store(&accepting_tasks_, 0);
+  subtle::MemoryBarrier();
+  {
+    AutoLock lock(producers_lock_);
+    while (subtle::Acquire_Load(&active_producer_count_)) {
+      // The wait is bounded by a single post and runs no other code.
+      ThreadRestrictions::ScopedAllowWait allow_wait;
+      producers_done_.Wait();
+    }
+  }
+
   message_loop_ = NULL;
 }
 
 IncomingTaskQueue::~IncomingTaskQueue() {
   // Verify that WillDestroyCurrentMessageLoop() has been called.
   DCHECK(!message_loop_);
+
+  // No producer can be linking a node anymore, so this drains everything.
+  while (Node* node = Pop())
+    delete node;
+
+  Link* link = reinterpret_cast<Link*>(subtle::Acquire_Load(&free_nodes_));
+  while (link) {
+    Node* node = static_cast<Node*>(link);
+    link = reinterpret_cast<Link*>(subtle::NoBarrier_Load(&link->next));
+    delete node;
+  }
 }
 
 TimeTicks IncomingTaskQueue::CalculateDelayedRuntime(TimeDelta delay) {
   TimeTicks delayed_run_time;
   if (delay > TimeDelta()) {
     delayed_run_time = TimeTicks::Now() + delay;
+  } else {
+    DCHECK_EQ(delay.InMilliseconds(), 0) << "delay should not be negative";
+  }
 
 #if defined(OS_WIN)
-    if (high_resolution_timer_expiration_.is_null()) {
-      // Windows timers are granular to 15.6ms.  If we only set high-res
-      // timers for those under 15.6ms, then a 18ms timer ticks at ~32ms,
-      // which as a percentage is pretty inaccurate.  So enable high
-      // res timers for any timer which is within 2x of the granularity.
-      // This is a tradeoff between accuracy and power management.
-      bool needs_high_res_timers = delay.InMilliseconds() <
-          (2 * Time::kMinLowResolutionThresholdMs);
-      if (needs_high_res_timers) {
-        if (Time::ActivateHighResolutionTimer(true)) {
-          high_resolution_timer_expiration_ = TimeTicks::Now() +
-              TimeDelta::FromMilliseconds(
-                  MessageLoop::kHighResolutionTimerModeLeaseTimeMs);
-        }
+  // Immediate posts only need the lock to expire an active lease, so that
+  // they stay lock-free the rest of the time.
+  if (delay == TimeDelta() &&
+      !subtle::NoBarrier_Load(&high_resolution_timer_active_)) {
+    return delayed_run_time;
+  }
+
+  AutoLock lock(high_resolution_timer_lock_);
+  if (delay > TimeDelta() && high_resolution_timer_expiration_.is_null()) {
+    // Windows timers are granular to 15.6ms.  If we only set high-res
+    // timers for those under 15.6ms, then a 18ms timer ticks at ~32ms,
+    // which as a percentage is pretty inaccurate.  So enable high
+    // res timers for any timer which is within 2x of the granularity.
+    // This is a tradeoff between accuracy and power management.
+    bool needs_high_res_timers = delay.InMilliseconds() <
+        (2 * Time::kMinLowResolutionThresholdMs);
+    if (needs_high_res_timers) {
+      if (Time::ActivateHighResolutionTimer(true)) {
+        high_resolution_timer_expiration_ = TimeTicks::Now() +
+            TimeDelta::FromMilliseconds(
+                MessageLoop::kHighResolutionTimerModeLeaseTimeMs);
+        subtle::NoBarrier_Store(&high_resolution_timer_active_, 1);
       }
     }
-#endif
-  } else {
-    DCHECK_EQ(delay.InMilliseconds(), 0) << "delay should not be negative";
   }
 
-#if defined(OS_WIN)
   if (!high_resolution_timer_expiration_.is_null()) {
     if (TimeTicks::Now() > high_resolution_timer_expiration_) {
       Time::ActivateHighResolutionTimer(false);
       high_resolution_timer_expiration_ = TimeTicks();
+      subtle::NoBarrier_Store(&high_resolution_timer_active_, 0);
     }
   }
 #endif
@@ -117,32 +237,131 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
   // directly, as it could starve handling of foreign threads.  Put every task
   // into this queue.
 
-  // This should only be called while the lock is taken.
-  incoming_queue_lock_.AssertAcquired();
-
-  if (!message_loop_) {
-    pending_task->task.Reset();
-    return false;
-  }
+  DCHECK(message_loop_);
 
   // Initialize the sequence number. The sequence number is used for delayed
   // tasks (to faciliate FIFO sorting when two tasks have the same
   // delayed_run_time value) and for identifying the task in about:tracing.
-  pending_task->sequence_num = next_sequence_num_++;
+  // Tasks posted from one thread still get increasing numbers in posting
+  // order.
+  pending_task->sequence_num =
+      subtle::NoBarrier_AtomicIncrement(&next_sequence_num_, 1) - 1;
 
   TRACE_EVENT_FLOW_BEGIN0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
       "MessageLoop::PostTask",
       TRACE_ID_MANGLE(message_loop_->GetTaskTraceID(*pending_task)));
 
-  bool was_empty = incoming_queue_.empty();
-  incoming_queue_.push(*pending_task);
+  Push(AllocateNode(*pending_task));
   pending_task->task.Reset();
 
-  // Wake up the pump.
-  message_loop_->ScheduleWork(was_empty);
+  // Wake up the pump if the queue was empty, or if the loop is waiting for a
+  // node to be linked. The increment is a full barrier between our link and
+  // the load of |reload_requested_|.
+  bool was_empty =
+      subtle::Barrier_AtomicIncrement(&incoming_task_count_, 1) == 1;
+  message_loop_->ScheduleWork(was_empty || TakeReloadRequest());
 
   return true;
 }
 
+void IncomingTaskQueue::Push(Link* link) {
+  subtle::NoBarrier_Store(&link->next, 0);
+  // The cleared |next| must be visible before the next producer can link to
+  // |link|.
+  subtle::MemoryBarrier();
+  // Claim the head first; the previous head is linked to us afterwards. Until
+  // that release store lands, Pop() sees the list end at the previous head.
+  Link* prev = reinterpret_cast<Link*>(subtle::NoBarrier_AtomicExchange(
+      &head_, reinterpret_cast<subtle::AtomicWord>(link)));
+  subtle::Release_Store(&prev->next, reinterpret_cast<subtle::AtomicWord>(link));
+}
+
+IncomingTaskQueue::Node* IncomingTaskQueue::Pop() {
+  Link* tail = tail_;
+  Link* next = reinterpret_cast<Link*>(subtle::Acquire_Load(&tail->next));
+  if (tail == &stub_) {
+    if (!next)
+      return NULL;
+    // Skip over the stub.
+    tail_ = next;
+    tail = next;
+    next = reinterpret_cast<Link*>(subtle::Acquire_Load(&tail->next));
+  }
+  if (next) {
+    tail_ = next;
+    return static_cast<Node*>(tail);
+  }
+  // |tail| is the last fully linked node. If it is also the head, re-insert
+  // the stub behind it so |tail| can be handed out; otherwise a producer has
+  // claimed the head but not linked it yet and |tail| has to stay put.
+  if (tail != reinterpret_cast<Link*>(subtle::Acquire_Load(&head_)))
+    return NULL;
+  Push(&stub_);
+  next = reinterpret_cast<Link*>(subtle::Acquire_Load(&tail->next));
+  if (next) {
+    tail_ = next;
+    return static_cast<Node*>(tail);
+  }
+  return NULL;
+}
+
+bool IncomingTaskQueue::IsLinkPending() const {
+  return !subtle::Acquire_Load(&tail_->next) &&
+      reinterpret_cast<Link*>(subtle::Acquire_Load(&head_)) != tail_;
+}
+
+bool IncomingTaskQueue::TakeReloadRequest() {
+  // Keep the common case to a plain load.
+  return subtle::NoBarrier_Load(&reload_requested_) &&
+      subtle::NoBarrier_AtomicExchange(&reload_requested_, 0);
+}
+
+IncomingTaskQueue::Node* IncomingTaskQueue::AllocateNode(
+    const PendingTask& pending_task) {
+  // Detach the whole free list; popping single nodes would be exposed to ABA
+  // races between concurrent producers.
+  Link* first = reinterpret_cast<Link*>(subtle::Acquire_Load(&free_nodes_));
+  while (first) {
+    subtle::AtomicWord prev = subtle::Acquire_CompareAndSwap(
+        &free_nodes_, reinterpret_cast<subtle::AtomicWord>(first), 0);
+    if (prev == reinterpret_cast<subtle::AtomicWord>(first))
+      break;
+    first = reinterpret_cast<Link*>(prev);
+  }
+  if (!first)
+    return new Node(pending_task);
+  subtle::NoBarrier_AtomicIncrement(&free_node_count_, -1);
+
+  // Keep one node and give the rest back. In the common case nobody has
+  // touched the free list since we detached it.
+  Link* rest = reinterpret_cast<Link*>(subtle::NoBarrier_Load(&first->next));
+  if (rest) {
+    if (subtle::Release_CompareAndSwap(
+            &free_nodes_, 0, reinterpret_cast<subtle::AtomicWord>(rest))) {
+      Link* last = rest;
+      while (Link* next =
+                 reinterpret_cast<Link*>(subtle::NoBarrier_Load(&last->next)))
+        last = next;
+      RecycleNodes(rest, last);
+    }
+  }
+
+  Node* node = static_cast<Node*>(first);
+  node->task = pending_task;
+  return node;
+}
+
+void IncomingTaskQueue::RecycleNodes(Link* first, Link* last) {
+  subtle::AtomicWord head = subtle::NoBarrier_Load(&free_nodes_);
+  for (;;) {
+    subtle::NoBarrier_Store(&last->next, head);
+    subtle::AtomicWord prev = subtle::Release_CompareAndSwap(
+        &free_nodes_, head, reinterpret_cast<subtle::AtomicWord>(first));
+    if (prev == head)
+      return;
+    head = prev;
+  }
+}
+
 }  // namespace internal
 }  // namespace base
@@ -5,9 +5,11 @@
 #ifndef BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 #define BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/memory/ref_counted.h"
 #include "base/pending_task.h"
+#include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
 #include "base/time/time.h"
 
@@ -21,6 +23,12 @@ namespace internal {
 // Implements a queue of tasks posted to the message loop running on the current
 // thread. This class takes care of synchronizing posting tasks from different
 // threads and together with MessageLoop ensures clean shutdown.
+//
+// The queue is an intrusive multi-producer single-consumer linked list.
+// Posting a task is lock-free: it never blocks on other posters or on the
+// loop thread, though updating the list of free nodes may retry under
+// contention. The thread running the loop takes all tasks whose posting has
+// completed in one batch.
 class BASE_EXPORT IncomingTaskQueue
     : public RefCountedThreadSafe<IncomingTaskQueue> {
  public:
@@ -45,7 +53,11 @@ class BASE_EXPORT IncomingTaskQueue
   // Returns true if the message loop is "idle". Provided for testing.
   bool IsIdleForTesting();
 
-  // Loads tasks from the |incoming_queue_| into |*work_queue|. Must be called
+  // Returns the number of nodes kept for reuse by later posts. Provided for
+  // testing.
+  int GetFreeNodeCountForTesting();
+
+  // Loads tasks from the incoming queue into |*work_queue|. Must be called
   // from the thread that is running the loop.
   void ReloadWorkQueue(TaskQueue* work_queue);
 
@@ -56,33 +68,100 @@ class BASE_EXPORT IncomingTaskQueue
   friend class RefCountedThreadSafe<IncomingTaskQueue>;
   virtual ~IncomingTaskQueue();
 
+  // Links of the incoming queue. |next| is published by producers with
+  // release semantics and read by the loop thread with acquire semantics.
+  struct Link {
+    Link() : next(0) {}
+    subtle::AtomicWord next;
+  };
+  // A Link carrying a posted PendingTask. Defined in the .cc file.
+  struct Node;
+
   // Calculates the time at which a PendingTask should run.
   TimeTicks CalculateDelayedRuntime(TimeDelta delay);
 
-  // Adds a task to |incoming_queue_|. The caller retains ownership of
+  // Adds a task to the incoming queue. The caller retains ownership of
   // |pending_task|, but this function will reset the value of
   // |pending_task->task|. This is needed to ensure that the posting call stack
-  // does not retain |pending_task->task| beyond this function call.
+  // does not retain |pending_task->task| beyond this function call. Must only
+  // be called once the loop is known to be alive, see AddToIncomingQueue().
   bool PostPendingTask(PendingTask* pending_task);
 
+  // Appends |link| to the incoming queue. Wait-free; may be called from any
+  // thread.
+  void Push(Link* link);
+
+  // Removes and returns the oldest node of the incoming queue, or NULL if the
+  // queue is empty or the oldest node's producer has not finished linking it
+  // yet. Must be called from the thread that is running the loop.
+  Node* Pop();
+
+  // Returns true if the oldest node is the last one linked but a producer has
+  // already claimed the head behind it. Must be called from the thread that is
+  // running the loop.
+  bool IsLinkPending() const;
+
+  // Clears |reload_requested_| and returns true if it was set. May be called
+  // from any thread; only one caller sees a given request.
+  bool TakeReloadRequest();
+
+  // Returns a node holding a copy of |pending_task|, reusing one from
+  // |free_nodes_| when possible. May be called from any thread.
+  Node* AllocateNode(const PendingTask& pending_task);
+
+  // Makes the nodes chained from |first| to |last| through their |next| links
+  // available to AllocateNode(). May be called from any thread.
+  void RecycleNodes(Link* first, Link* last);
+
 #if defined(OS_WIN)
+  // Protects |high_resolution_timer_expiration_|.
+  base::Lock high_resolution_timer_lock_;
   TimeTicks high_resolution_timer_expiration_;
+  // Non-zero while |high_resolution_timer_expiration_| is set. Lets immediate
+  // posts skip the lock when there is no lease to expire.
+  subtle::Atomic32 high_resolution_timer_active_;
 #endif
 
-  // The lock that protects access to |incoming_queue_|, |message_loop_| and
-  // |next_sequence_num_|.
-  base::Lock incoming_queue_lock_;
-
-  // An incoming queue of tasks that are acquired under a mutex for processing
-  // on this instance's thread. These tasks have not yet been been pushed to
-  // |message_loop_|.
-  TaskQueue incoming_queue_;
-
-  // Points to the message loop that owns |this|.
+  // Producers swap themselves in as the |head_| of the incoming queue, the
+  // loop thread consumes from |tail_|. |stub_| keeps the list non-empty so
+  // that posting never has to special-case an empty queue.
+  subtle::AtomicWord head_;
+  Link* tail_;
+  Link stub_;
+
+  // The number of tasks whose posting has completed minus the number of tasks
+  // taken by ReloadWorkQueue(). The post that raises it to one wakes the pump.
+  subtle::Atomic32 incoming_task_count_;
+
+  // Set by ReloadWorkQueue() when posts are left queued behind a node that is
+  // still being linked. The next post to complete wakes the pump for them.
+  subtle::Atomic32 reload_requested_;
+
+  // A stack of nodes already taken by ReloadWorkQueue(), kept so that posting
+  // does not have to allocate. The loop thread pushes onto it; producers only
+  // ever detach the whole stack, which keeps it free of ABA problems.
+  subtle::AtomicWord free_nodes_;
+
+  // The number of nodes in |free_nodes_|, including nodes a producer has
+  // detached and is about to give back. Only the loop thread adds to it, so it
+  // never exceeds the cap that ReloadWorkQueue() enforces.
+  subtle::Atomic32 free_node_count_;
+
+  // Points to the message loop that owns |this|. Only dereferenced by threads
+  // counted in |active_producer_count_| while |accepting_tasks_| is set, and
+  // by the loop thread.
   MessageLoop* message_loop_;
 
+  // Cleared by WillDestroyCurrentMessageLoop(), which then waits for
+  // |active_producer_count_| to drop to zero before releasing |message_loop_|.
+  // Producers only touch |producers_lock_| once |accepting_tasks_| is clear.
+  subtle::Atomic32 accepting_tasks_;
+  subtle::Atomic32 active_producer_count_;
+  base::Lock producers_lock_;
+  ConditionVariable producers_done_;
+
   // The next sequence number to use for delayed tasks.
-  int next_sequence_num_;
+  subtle::Atomic32 next_sequence_num_;
 
   DISALLOW_COPY_AND_ASSIGN(IncomingTaskQueue);
 };
@@ -0,0 +1,95 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/incoming_task_queue.h"
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/memory/ref_counted.h"
+#include "base/message_loop/message_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+class IncomingTaskQueueTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    queue_ = new IncomingTaskQueue(&loop_);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    queue_->WillDestroyCurrentMessageLoop();
+    queue_ = NULL;
+  }
+
+  void PostTasks(int count) {
+    for (int i = 0; i < count; ++i) {
+      EXPECT_TRUE(queue_->AddToIncomingQueue(
+          FROM_HERE, Bind(&DoNothing), TimeDelta(), true));
+    }
+  }
+
+  // Moves all posted tasks into a work queue and returns how many there were.
+  int Reload() {
+    TaskQueue work_queue;
+    queue_->ReloadWorkQueue(&work_queue);
+    int count = static_cast<int>(work_queue.size());
+    while (!work_queue.empty())
+      work_queue.pop();
+    return count;
+  }
+
+  MessageLoop loop_;
+  scoped_refptr<IncomingTaskQueue> queue_;
+};
+
+}  // namespace
+
+TEST_F(IncomingTaskQueueTest, ReusesNodes) {
+  PostTasks(1);
+  EXPECT_EQ(0, queue_->GetFreeNodeCountForTesting());
+  EXPECT_EQ(1, Reload());
+  EXPECT_EQ(1, queue_->GetFreeNodeCountForTesting());
+
+  PostTasks(1);
+  EXPECT_EQ(0, queue_->GetFreeNodeCountForTesting());
+  EXPECT_EQ(1, Reload());
+  EXPECT_EQ(1, queue_->GetFreeNodeCountForTesting());
+}
+
+TEST_F(IncomingTaskQueueTest, FreeListIsBounded) {
+  PostTasks(1000);
+  EXPECT_EQ(1000, Reload());
+  const int max_free_nodes = queue_->GetFreeNodeCountForTesting();
+  EXPECT_GT(max_free_nodes, 0);
+  EXPECT_LT(max_free_nodes, 1000);
+
+  // Another burst must not grow the free list past the cap, however many
+  // reloads it takes.
+  for (int i = 0; i < 4; ++i) {
+    PostTasks(1000);
+    EXPECT_EQ(1000, Reload());
+    EXPECT_EQ(max_free_nodes, queue_->GetFreeNodeCountForTesting());
+  }
+
+  // Posts that reuse nodes shrink the list until the next reload refills it.
+  PostTasks(10);
+  EXPECT_EQ(max_free_nodes - 10, queue_->GetFreeNodeCountForTesting());
+  EXPECT_EQ(10, Reload());
+  EXPECT_EQ(max_free_nodes, queue_->GetFreeNodeCountForTesting());
+}
+
+TEST_F(IncomingTaskQueueTest, RejectsTasksAfterLoopIsGone) {
+  PostTasks(3);
+  EXPECT_EQ(3, Reload());
+  queue_->WillDestroyCurrentMessageLoop();
+  EXPECT_FALSE(queue_->AddToIncomingQueue(
+      FROM_HERE, Bind(&DoNothing), TimeDelta(), true));
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,106 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how fast tasks can be posted to a single MessageLoop from several
+// threads at once. This is dominated by the cost of the incoming task queue.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace {
+
+const int kTasksPerProducer = 100000;
+
+void IncrementCounter(int* counter) {
+  ++*counter;
+}
+
+// Posts |kTasksPerProducer| tasks to |loop| once |start| is signaled.
+class Producer : public DelegateSimpleThread::Delegate {
+ public:
+  Producer(MessageLoop* loop, WaitableEvent* start, int* counter)
+      : loop_(loop),
+        start_(start),
+        counter_(counter) {
+  }
+
+  virtual void Run() OVERRIDE {
+    start_->Wait();
+    for (int i = 0; i < kTasksPerProducer; ++i)
+      loop_->PostTask(FROM_HERE, Bind(&IncrementCounter, counter_));
+  }
+
+ private:
+  MessageLoop* loop_;
+  WaitableEvent* start_;
+  int* counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(Producer);
+};
+
+void RunPostTaskBench(int num_producers) {
+  Thread consumer("MessageLoopPerfTestConsumer");
+  ASSERT_TRUE(consumer.Start());
+  MessageLoop* loop = consumer.message_loop();
+
+  // Only touched on |consumer|.
+  int counter = 0;
+
+  WaitableEvent start(true, false);
+  ScopedVector<Producer> producers;
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < num_producers; ++i) {
+    producers.push_back(new Producer(loop, &start, &counter));
+    threads.push_back(new DelegateSimpleThread(
+        producers.back(), StringPrintf("MessageLoopPerfTestProducer%d", i)));
+    threads.back()->Start();
+  }
+
+  TimeTicks begin = TimeTicks::HighResNow();
+  start.Signal();
+  for (int i = 0; i < num_producers; ++i)
+    threads[i]->Join();
+  TimeDelta post_time = TimeTicks::HighResNow() - begin;
+
+  // Stopping the thread runs every task that is still queued.
+  consumer.Stop();
+  TimeDelta total_time = TimeTicks::HighResNow() - begin;
+  EXPECT_EQ(num_producers * kTasksPerProducer, counter);
+
+  double total_tasks = static_cast<double>(num_producers * kTasksPerProducer);
+  std::string trace = StringPrintf("%d_producers", num_producers);
+  perf_test::PrintResult("message_loop_post_task", "", trace,
+                         total_tasks / post_time.InSecondsF(),
+                         "posts/s", true);
+  perf_test::PrintResult("message_loop_post_and_run_task", "", trace,
+                         total_tasks / total_time.InSecondsF(),
+                         "tasks/s", true);
+}
+
+TEST(MessageLoopPerfTest, PostTaskOneProducer) {
+  RunPostTaskBench(1);
+}
+
+TEST(MessageLoopPerfTest, PostTaskFourProducers) {
+  RunPostTaskBench(4);
+}
+
+TEST(MessageLoopPerfTest, PostTaskSixteenProducers) {
+  RunPostTaskBench(16);
+}
+
+}  // namespace
+}  // namespace base
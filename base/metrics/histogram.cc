@@ -13,16 +13,20 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "base/debug/alias.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
 #include "base/metrics/sample_vector.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread_local.h"
 #include "base/values.h"
 
 using std::string;
@@ -76,8 +80,96 @@ bool ValidateRangeChecksum(const HistogramBase& histogram,
   return casted_histogram.bucket_ranges()->checksum() == range_checksum;
 }
 
+// Number of per-thread stripes of a kThreadLocalSampleBufferFlag histogram.
+// Threads are assigned stripes round-robin, so up to this many threads record
+// without touching each other's cache lines.
+const size_t kSampleStripeCount = 8;
+
+// The stripe index of the current thread, plus one so that NULL means the
+// thread has not been assigned a stripe yet.
+LazyInstance<ThreadLocalPointer<void> >::Leaky g_sample_stripe =
+    LAZY_INSTANCE_INITIALIZER;
+subtle::Atomic32 g_sample_stripe_threads = 0;
+
+size_t GetCurrentThreadSampleStripe() {
+  ThreadLocalPointer<void>* slot = g_sample_stripe.Pointer();
+  intptr_t stripe = reinterpret_cast<intptr_t>(slot->Get());
+  if (!stripe) {
+    stripe = subtle::NoBarrier_AtomicIncrement(&g_sample_stripe_threads, 1);
+    slot->Set(reinterpret_cast<void*>(stripe));
+  }
+  return static_cast<size_t>(stripe - 1) % kSampleStripeCount;
+}
+
 }  // namespace
 
+// Each stripe is a SampleVector of its own, so that threads recording into
+// different stripes never write the same cache line. Threads beyond
+// kSampleStripeCount share a stripe, so each stripe has a lock; it is
+// uncontended unless that many threads record at once. Stripes are never
+// merged back into |samples_|; snapshots sum them instead.
+class Histogram::SampleStripes {
+ public:
+  explicit SampleStripes(const BucketRanges* ranges)
+      : counts_stride_(CountsStride(ranges->bucket_count())),
+        counts_(kSampleStripeCount * counts_stride_) {
+    for (size_t i = 0; i < kSampleStripeCount; ++i) {
+      Stripe* stripe = new Stripe;
+      stripe->samples.reset(new SampleVector(
+          &counts_[i * counts_stride_], ranges->bucket_count(), &stripe->meta,
+          ranges));
+      stripes_.push_back(stripe);
+    }
+  }
+
+  void Accumulate(Sample value, int count) {
+    Stripe* stripe = stripes_[GetCurrentThreadSampleStripe()];
+    AutoLock lock(stripe->lock);
+    stripe->samples->Accumulate(value, count);
+  }
+
+  void AddTo(SampleVector* samples) const {
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+      AutoLock lock(stripes_[i]->lock);
+      samples->Add(*stripes_[i]->samples);
+    }
+  }
+
+ private:
+  static const size_t kCacheLineSize = 64;
+  static const size_t kCountsPerCacheLine =
+      kCacheLineSize / sizeof(HistogramBase::AtomicCount);
+
+  // The counts of all stripes share one array. Each stripe's counts are
+  // followed by at least a cache line of slack, so no line holds counts of
+  // two stripes however the array is aligned.
+  static size_t CountsStride(size_t bucket_count) {
+    return (bucket_count + 2 * kCountsPerCacheLine - 1) /
+        kCountsPerCacheLine * kCountsPerCacheLine;
+  }
+
+  // The lock and the sum live in the stripe itself, which is padded for the
+  // same reason.
+  struct Stripe {
+    Stripe() {
+      meta.sum = 0;
+      meta.redundant_count = 0;
+    }
+
+    char leading_padding[kCacheLineSize];
+    Lock lock;
+    HistogramSamples::Metadata meta;
+    scoped_ptr<SampleVector> samples;
+    char trailing_padding[kCacheLineSize];
+  };
+
+  const size_t counts_stride_;
+  std::vector<HistogramBase::AtomicCount> counts_;
+  ScopedVector<Stripe> stripes_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampleStripes);
+};
+
 typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
@@ -255,6 +347,10 @@ bool Histogram::HasConstructionArguments(Sample expected_minimum,
 }
 
 void Histogram::Add(int value) {
+  AddCount(value, 1);
+}
+
+void Histogram::AddCount(int value, int count) {
   DCHECK_EQ(0, ranges(0));
   DCHECK_EQ(kSampleType_MAX, ranges(bucket_count()));
 
@@ -262,7 +358,14 @@ void Histogram::Add(int value) {
     value = kSampleType_MAX - 1;
   if (value < 0)
     value = 0;
-  samples_->Accumulate(value, 1);
+  if (count <= 0) {
+    NOTREACHED();
+    return;
+  }
+  if (flags() & kThreadLocalSampleBufferFlag)
+    GetOrCreateSampleStripes()->Accumulate(value, count);
+  else
+    samples_->Accumulate(value, count);
 }
 
 scoped_ptr<HistogramSamples> Histogram::SnapshotSamples() const {
@@ -306,12 +409,15 @@ Histogram::Histogram(const string& name,
   : HistogramBase(name),
     bucket_ranges_(ranges),
     declared_min_(minimum),
-    declared_max_(maximum) {
+    declared_max_(maximum),
+    sample_stripes_(0) {
   if (ranges)
     samples_.reset(new SampleVector(ranges));
 }
 
 Histogram::~Histogram() {
+  delete reinterpret_cast<SampleStripes*>(
+      subtle::NoBarrier_Load(&sample_stripes_));
 }
 
 bool Histogram::PrintEmptyBucket(size_t index) const {
@@ -367,9 +473,30 @@ HistogramBase* Histogram::DeserializeInfoImpl(PickleIterator* iter) {
 scoped_ptr<SampleVector> Histogram::SnapshotSampleVector() const {
   scoped_ptr<SampleVector> samples(new SampleVector(bucket_ranges()));
   samples->Add(*samples_);
+  const SampleStripes* stripes = reinterpret_cast<const SampleStripes*>(
+      subtle::Acquire_Load(&sample_stripes_));
+  if (stripes)
+    stripes->AddTo(samples.get());
   return samples.Pass();
 }
 
+Histogram::SampleStripes* Histogram::GetOrCreateSampleStripes() {
+  subtle::AtomicWord stripes = subtle::Acquire_Load(&sample_stripes_);
+  if (stripes)
+    return reinterpret_cast<SampleStripes*>(stripes);
+
+  // Racing threads each build their own stripes; the losers throw theirs away
+  // before recording into them.
+  SampleStripes* new_stripes = new SampleStripes(bucket_ranges());
+  stripes = subtle::Release_CompareAndSwap(
+      &sample_stripes_, 0, reinterpret_cast<subtle::AtomicWord>(new_stripes));
+  if (stripes) {
+    delete new_stripes;
+    return reinterpret_cast<SampleStripes*>(stripes);
+  }
+  return new_stripes;
+}
+
 void Histogram::WriteAsciiImpl(bool graph_it,
                                const string& newline,
                                string* output) const {
@@ -459,6 +459,7 @@ class BASE_EXPORT Histogram : public HistogramBase {
       Sample expected_maximum,
       size_t expected_bucket_count) const OVERRIDE;
   virtual void Add(Sample value) OVERRIDE;
+  virtual void AddCount(Sample value, int count) OVERRIDE;
   virtual scoped_ptr<HistogramSamples> SnapshotSamples() const OVERRIDE;
   virtual void AddSamples(const HistogramSamples& samples) OVERRIDE;
   virtual bool AddSamplesFromPickle(PickleIterator* iter) OVERRIDE;
@@ -498,12 +499,20 @@ class BASE_EXPORT Histogram : public HistogramBase {
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, NameMatchTest);
 
   friend class StatisticsRecorder;  // To allow it to delete duplicates.
+  friend class SharedHistogramAllocator;  // To move |samples_|.
   friend class StatisticsRecorderTest;
 
   friend BASE_EXPORT_PRIVATE HistogramBase* DeserializeHistogramInfo(
       PickleIterator* iter);
   static HistogramBase* DeserializeInfoImpl(PickleIterator* iter);
 
+  // Per-thread copies of the buckets used by kThreadLocalSampleBufferFlag
+  // histograms. Defined in histogram.cc.
+  class SampleStripes;
+
+  // Returns |sample_stripes_|, creating it on first use.
+  SampleStripes* GetOrCreateSampleStripes();
+
   // Implementation of SnapshotSamples function.
   scoped_ptr<SampleVector> SnapshotSampleVector() const;
 
@@ -545,6 +554,10 @@ class BASE_EXPORT Histogram : public HistogramBase {
   // sample.
   scoped_ptr<SampleVector> samples_;
 
+  // A SampleStripes*, NULL until the first Add() with
+  // kThreadLocalSampleBufferFlag set. Snapshots sum it with |samples_|.
+  subtle::AtomicWord sample_stripes_;
+
   DISALLOW_COPY_AND_ASSIGN(Histogram);
 };
 
@@ -73,6 +73,18 @@ class BASE_EXPORT HistogramBase {
     // the source histogram!).
     kIPCSerializationSourceFlag = 0x10,
 
+    // Only for Histogram and its sub classes: record samples into per-thread
+    // stripes that are summed when the histogram is snapshotted, instead of
+    // into one SampleVector whose cache lines every recording thread writes.
+    // Meant for hot histograms recorded from many threads; costs a copy of
+    // the buckets per stripe.
+    kThreadLocalSampleBufferFlag = 0x20,
+
+    // Indicates that the samples of the histogram live in a
+    // SharedHistogramAllocator segment that another process reads directly,
+    // so they must not also be sent to it over IPC.
+    kSharedMemorySamplesFlag = 0x40,
+
     // Only for Histogram and its sub classes: fancy bucket-naming support.
     kHexRangePrintingFlag = 0x8000,
   };
@@ -114,6 +126,9 @@ class BASE_EXPORT HistogramBase {
 
   virtual void Add(Sample value) = 0;
 
+  // Like Add(), but records |value| |count| times. |count| must be positive.
+  virtual void AddCount(Sample value, int count) = 0;
+
   // 2 convenient functions that call Add(Sample).
   void AddTime(const TimeDelta& time);
   void AddBoolean(bool value);
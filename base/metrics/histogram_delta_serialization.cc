@@ -86,6 +86,10 @@ void HistogramDeltaSerialization::RecordDelta(
     const HistogramSamples& snapshot) {
   DCHECK_NE(0, snapshot.TotalCount());
 
+  // The receiving process reads these directly from shared memory.
+  if (histogram.flags() & HistogramBase::kSharedMemorySamplesFlag)
+    return;
+
   Pickle pickle;
   histogram.SerializeInfo(&pickle);
   snapshot.Serialize(&pickle);
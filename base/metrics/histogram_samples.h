@@ -19,7 +19,25 @@ class SampleCountIterator;
 // HistogramSamples is a container storing all samples of a histogram.
 class BASE_EXPORT HistogramSamples {
  public:
+  // The sum and redundant count of the samples. Kept apart from the samples
+  // object so that it can live in memory shared with another process.
+  struct Metadata {
+    int64 sum;
+
+    // |redundant_count| helps identify memory corruption. It redundantly
+    // stores the total number of samples accumulated in the histogram. We can
+    // compare this count to the sum of the counts (TotalCount() function), and
+    // detect problems. Note, depending on the implementation of different
+    // histogram types, there might be races during histogram accumulation and
+    // snapshotting that we choose to accept. In this case, the tallies might
+    // mismatch even when no memory corruption has happened.
+    HistogramBase::AtomicCount redundant_count;
+  };
+
   HistogramSamples();
+  // Keeps the sum and redundant count in |meta|, which must outlive this
+  // object.
+  explicit HistogramSamples(Metadata* meta);
   virtual ~HistogramSamples();
 
   virtual void Accumulate(HistogramBase::Sample value,
@@ -38,9 +56,9 @@ class BASE_EXPORT HistogramSamples {
   virtual bool Serialize(Pickle* pickle) const;
 
   // Accessor fuctions.
-  int64 sum() const { return sum_; }
+  int64 sum() const { return meta_->sum; }
   HistogramBase::Count redundant_count() const {
-    return subtle::NoBarrier_Load(&redundant_count_);
+    return subtle::NoBarrier_Load(&meta_->redundant_count);
   }
 
  protected:
@@ -52,16 +70,11 @@ class BASE_EXPORT HistogramSamples {
   void IncreaseRedundantCount(HistogramBase::Count diff);
 
  private:
-  int64 sum_;
-
-  // |redundant_count_| helps identify memory corruption. It redundantly stores
-  // the total number of samples accumulated in the histogram. We can compare
-  // this count to the sum of the counts (TotalCount() function), and detect
-  // problems. Note, depending on the implementation of different histogram
-  // types, there might be races during histogram accumulation and snapshotting
-  // that we choose to accept. In this case, the tallies might mismatch even
-  // when no memory corruption has happened.
-  HistogramBase::AtomicCount redundant_count_;
+  // Used unless the constructor was given external Metadata.
+  Metadata local_meta_;
+  Metadata* meta_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramSamples);
 };
 
 class BASE_EXPORT SampleCountIterator {
@@ -15,6 +15,7 @@
 #include "base/metrics/sample_vector.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
+#include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -306,6 +307,28 @@ TEST_F(HistogramTest, BucketPlacementTest) {
     EXPECT_EQ(i + 1, samples->GetCountAtIndex(i));
 }
 
+// Check that AddCount() records the sample as many times as asked, with or
+// without the thread local buffers.
+TEST_F(HistogramTest, AddCountTest) {
+  HistogramBase* histograms[] = {
+    LinearHistogram::FactoryGet("AddCount", 1, 10, 11,
+                                HistogramBase::kNoFlags),
+    LinearHistogram::FactoryGet("AddCountThreadLocal", 1, 10, 11,
+                                HistogramBase::kThreadLocalSampleBufferFlag),
+  };
+  for (size_t i = 0; i < arraysize(histograms); ++i) {
+    histograms[i]->AddCount(3, 5);
+    histograms[i]->AddCount(20, 2);
+    histograms[i]->Add(3);
+
+    scoped_ptr<HistogramSamples> samples = histograms[i]->SnapshotSamples();
+    EXPECT_EQ(8, samples->TotalCount());
+    EXPECT_EQ(6, samples->GetCount(3));
+    EXPECT_EQ(2, samples->GetCount(10));
+    EXPECT_EQ(58, samples->sum());
+  }
+}
+
 TEST_F(HistogramTest, CorruptSampleCounts) {
   Histogram* histogram = static_cast<Histogram*>(
       Histogram::FactoryGet("Histogram", 1, 64, 8, HistogramBase::kNoFlags));
@@ -443,6 +466,59 @@ TEST_F(HistogramTest, CustomHistogramSerializeInfo) {
   EXPECT_FALSE(iter.SkipBytes(1));
 }
 
+namespace {
+
+class AddSamplesDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  AddSamplesDelegate(HistogramBase* histogram, int samples)
+      : histogram_(histogram), samples_(samples) {}
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < samples_; ++i)
+      histogram_->Add(i % 100);
+  }
+
+ private:
+  HistogramBase* histogram_;
+  int samples_;
+};
+
+}  // namespace
+
+TEST_F(HistogramTest, ThreadLocalSampleBuffer) {
+  HistogramBase* histogram = LinearHistogram::FactoryGet(
+      "ThreadLocal", 1, 100, 101,
+      HistogramBase::kThreadLocalSampleBufferFlag);
+  histogram->Add(5);
+  histogram->Add(5);
+  histogram->Add(200);
+
+  scoped_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(3, samples->TotalCount());
+  EXPECT_EQ(3, samples->redundant_count());
+  EXPECT_EQ(2, samples->GetCount(5));
+  EXPECT_EQ(1, samples->GetCount(100));
+  EXPECT_EQ(210, samples->sum());
+
+  // Samples from more threads than there are stripes all end up in the
+  // snapshot, along with samples merged in from elsewhere.
+  const int kThreads = 12;
+  const int kSamplesPerThread = 1000;
+  AddSamplesDelegate delegate(histogram, kSamplesPerThread);
+  DelegateSimpleThreadPool pool("ThreadLocalSampleBuffer", kThreads);
+  pool.AddWork(&delegate, kThreads);
+  pool.Start();
+  pool.JoinAll();
+  histogram->AddSamples(*samples);
+
+  samples = histogram->SnapshotSamples();
+  EXPECT_EQ(6 + kThreads * kSamplesPerThread, samples->TotalCount());
+  EXPECT_EQ(6 + kThreads * kSamplesPerThread, samples->redundant_count());
+  EXPECT_EQ(4 + kThreads * kSamplesPerThread / 100, samples->GetCount(5));
+  EXPECT_EQ(HistogramBase::NO_INCONSISTENCIES,
+            histogram->FindCorruption(*samples));
+}
+
 #if GTEST_HAS_DEATH_TEST
 // For Histogram, LinearHistogram and CustomHistogram, the minimum for a
 // declared range is 1, while the maximum is (HistogramBase::kSampleType_MAX -
@@ -6,6 +6,7 @@
 
 #include "base/logging.h"
 #include "base/metrics/bucket_ranges.h"
+#include "base/stl_util.h"
 
 using std::vector;
 
@@ -15,11 +16,25 @@ typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
 SampleVector::SampleVector(const BucketRanges* bucket_ranges)
-    : counts_(bucket_ranges->bucket_count()),
+    : local_counts_(bucket_ranges->bucket_count()),
+      counts_(vector_as_array(&local_counts_)),
+      counts_size_(local_counts_.size()),
       bucket_ranges_(bucket_ranges) {
   CHECK_GE(bucket_ranges_->bucket_count(), 1u);
 }
 
+SampleVector::SampleVector(HistogramBase::AtomicCount* counts,
+                           size_t counts_size,
+                           Metadata* meta,
+                           const BucketRanges* bucket_ranges)
+    : HistogramSamples(meta),
+      counts_(counts),
+      counts_size_(counts_size),
+      bucket_ranges_(bucket_ranges) {
+  CHECK_GE(bucket_ranges_->bucket_count(), 1u);
+  CHECK_EQ(bucket_ranges_->bucket_count(), counts_size_);
+}
+
 SampleVector::~SampleVector() {}
 
 void SampleVector::Accumulate(Sample value, Count count) {
@@ -37,20 +52,20 @@ Count SampleVector::GetCount(Sample value) const {
 
 Count SampleVector::TotalCount() const {
   Count count = 0;
-  for (size_t i = 0; i < counts_.size(); i++) {
+  for (size_t i = 0; i < counts_size_; i++) {
     count += subtle::NoBarrier_Load(&counts_[i]);
   }
   return count;
 }
 
 Count SampleVector::GetCountAtIndex(size_t bucket_index) const {
-  DCHECK(bucket_index < counts_.size());
+  DCHECK(bucket_index < counts_size_);
   return subtle::NoBarrier_Load(&counts_[bucket_index]);
 }
 
 scoped_ptr<SampleCountIterator> SampleVector::Iterator() const {
   return scoped_ptr<SampleCountIterator>(
-      new SampleVectorIterator(&counts_, bucket_ranges_));
+      new SampleVectorIterator(counts_, counts_size_, bucket_ranges_));
 }
 
 bool SampleVector::AddSubtractImpl(SampleCountIterator* iter,
@@ -61,7 +76,7 @@ bool SampleVector::AddSubtractImpl(SampleCountIterator* iter,
 
   // Go through the iterator and add the counts into correct bucket.
   size_t index = 0;
-  while (index < counts_.size() && !iter->Done()) {
+  while (index < counts_size_ && !iter->Done()) {
     iter->Get(&min, &max, &count);
     if (min == bucket_ranges_->range(index) &&
         max == bucket_ranges_->range(index + 1)) {
@@ -113,17 +128,29 @@ size_t SampleVector::GetBucketIndex(Sample value) const {
 
 SampleVectorIterator::SampleVectorIterator(const vector<Count>* counts,
                                            const BucketRanges* bucket_ranges)
+    : counts_(vector_as_array(counts)),
+      counts_size_(counts->size()),
+      bucket_ranges_(bucket_ranges),
+      index_(0) {
+  CHECK_GE(bucket_ranges_->bucket_count(), counts_size_);
+  SkipEmptyBuckets();
+}
+
+SampleVectorIterator::SampleVectorIterator(const Count* counts,
+                                           size_t counts_size,
+                                           const BucketRanges* bucket_ranges)
     : counts_(counts),
+      counts_size_(counts_size),
       bucket_ranges_(bucket_ranges),
       index_(0) {
-  CHECK_GE(bucket_ranges_->bucket_count(), counts_->size());
+  CHECK_GE(bucket_ranges_->bucket_count(), counts_size_);
   SkipEmptyBuckets();
 }
 
 SampleVectorIterator::~SampleVectorIterator() {}
 
 bool SampleVectorIterator::Done() const {
-  return index_ >= counts_->size();
+  return index_ >= counts_size_;
 }
 
 void SampleVectorIterator::Next() {
@@ -141,7 +168,7 @@ void SampleVectorIterator::Get(HistogramBase::Sample* min,
   if (max != NULL)
     *max = bucket_ranges_->range(index_ + 1);
   if (count != NULL)
-    *count = subtle::NoBarrier_Load(&(*counts_)[index_]);
+    *count = subtle::NoBarrier_Load(&counts_[index_]);
 }
 
 bool SampleVectorIterator::GetBucketIndex(size_t* index) const {
@@ -155,8 +182,8 @@ void SampleVectorIterator::SkipEmptyBuckets() {
   if (Done())
     return;
 
-  while (index_ < counts_->size()) {
-    if (subtle::NoBarrier_Load(&(*counts_)[index_]) != 0)
+  while (index_ < counts_size_) {
+    if (subtle::NoBarrier_Load(&counts_[index_]) != 0)
       return;
     index_++;
   }
@@ -23,6 +23,13 @@ class BucketRanges;
 class BASE_EXPORT_PRIVATE SampleVector : public HistogramSamples {
  public:
   explicit SampleVector(const BucketRanges* bucket_ranges);
+  // Keeps the |counts_size| bucket counts in |counts| and the sum and
+  // redundant count in |meta|, for samples that live in shared memory. Both
+  // must outlive this object. |counts_size| must match |bucket_ranges|.
+  SampleVector(HistogramBase::AtomicCount* counts,
+               size_t counts_size,
+               Metadata* meta,
+               const BucketRanges* bucket_ranges);
   virtual ~SampleVector();
 
   // HistogramSamples implementation:
@@ -46,7 +53,10 @@ class BASE_EXPORT_PRIVATE SampleVector : public HistogramSamples {
  private:
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, CorruptSampleCounts);
 
-  std::vector<HistogramBase::AtomicCount> counts_;
+  // Storage for |counts_| unless the constructor was given external counts.
+  std::vector<HistogramBase::AtomicCount> local_counts_;
+  HistogramBase::AtomicCount* counts_;
+  size_t counts_size_;
 
   // Shares the same BucketRanges with Histogram object.
   const BucketRanges* const bucket_ranges_;
@@ -58,6 +68,9 @@ class BASE_EXPORT_PRIVATE SampleVectorIterator : public SampleCountIterator {
  public:
   SampleVectorIterator(const std::vector<HistogramBase::AtomicCount>* counts,
                        const BucketRanges* bucket_ranges);
+  SampleVectorIterator(const HistogramBase::AtomicCount* counts,
+                       size_t counts_size,
+                       const BucketRanges* bucket_ranges);
   virtual ~SampleVectorIterator();
 
   // SampleCountIterator implementation:
@@ -73,7 +86,8 @@ class BASE_EXPORT_PRIVATE SampleVectorIterator : public SampleCountIterator {
  private:
   void SkipEmptyBuckets();
 
-  const std::vector<HistogramBase::AtomicCount>* counts_;
+  const HistogramBase::AtomicCount* counts_;
+  size_t counts_size_;
   const BucketRanges* bucket_ranges_;
 
   size_t index_;
@@ -0,0 +1,273 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_allocator.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "base/memory/shared_memory.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/sample_vector.h"
+#include "base/pickle.h"
+
+namespace base {
+
+namespace {
+
+const uint32 kSegmentMagic = 0x48495354;  // "HIST"
+const uint32 kSegmentVersion = 1;
+
+// Records start at multiples of this, so that the 64-bit sum is aligned.
+const size_t kRecordAlignment = 8;
+
+// Records are zero until their allocator fills them in and publishes them.
+const subtle::Atomic32 kRecordReady = 1;
+
+struct SegmentHeader {
+  uint32 magic;
+  uint32 version;
+  uint32 size;
+
+  // Bytes allocated so far, including this header. Only ever grows.
+  subtle::Atomic32 used;
+};
+
+struct RecordHeader {
+  // kRecordReady once the rest of the record may be read.
+  subtle::Atomic32 state;
+
+  // Total size of the record, a multiple of kRecordAlignment.
+  uint32 size;
+
+  // Size of the pickled HistogramBase::SerializeInfo() output, which follows
+  // this header. The bucket counts follow it, aligned.
+  uint32 info_size;
+  uint32 bucket_count;
+
+  HistogramSamples::Metadata meta;
+};
+
+size_t AlignRecord(size_t size) {
+  return (size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+size_t GetCountsOffset(size_t info_size) {
+  return AlignRecord(sizeof(RecordHeader) + info_size);
+}
+
+}  // namespace
+
+struct SharedHistogramAllocator::ImportedHistogram {
+  // The histogram of this process the record's samples are added to.
+  HistogramBase* histogram;
+
+  // The samples as recorded into the segment.
+  scoped_ptr<SampleVector> shared_samples;
+
+  // What was added to |histogram| so far.
+  scoped_ptr<SampleVector> imported_samples;
+};
+
+SharedHistogramAllocator::SharedHistogramAllocator(
+    scoped_ptr<SharedMemory> shared_memory)
+    : shared_memory_(shared_memory.Pass()),
+      memory_(static_cast<char*>(shared_memory_->memory())),
+      size_(shared_memory_->mapped_size()),
+      import_offset_(AlignRecord(sizeof(SegmentHeader))) {
+}
+
+SharedHistogramAllocator::~SharedHistogramAllocator() {
+}
+
+// static
+scoped_ptr<SharedHistogramAllocator> SharedHistogramAllocator::Create(
+    size_t size) {
+  DCHECK_LE(size, static_cast<size_t>(kint32max));
+  scoped_ptr<SharedMemory> shared_memory(new SharedMemory);
+  if (size < AlignRecord(sizeof(SegmentHeader)) ||
+      !shared_memory->CreateAndMapAnonymous(size)) {
+    return scoped_ptr<SharedHistogramAllocator>();
+  }
+
+  SegmentHeader* header =
+      reinterpret_cast<SegmentHeader*>(shared_memory->memory());
+  header->magic = kSegmentMagic;
+  header->version = kSegmentVersion;
+  header->size = static_cast<uint32>(size);
+  subtle::Release_Store(
+      &header->used,
+      static_cast<subtle::Atomic32>(AlignRecord(sizeof(SegmentHeader))));
+  return make_scoped_ptr(new SharedHistogramAllocator(shared_memory.Pass()));
+}
+
+// static
+scoped_ptr<SharedHistogramAllocator>
+SharedHistogramAllocator::CreateFromSharedMemory(
+    scoped_ptr<SharedMemory> shared_memory) {
+  if (!shared_memory->memory() ||
+      shared_memory->mapped_size() < AlignRecord(sizeof(SegmentHeader))) {
+    return scoped_ptr<SharedHistogramAllocator>();
+  }
+  const SegmentHeader* header =
+      reinterpret_cast<const SegmentHeader*>(shared_memory->memory());
+  if (header->magic != kSegmentMagic || header->version != kSegmentVersion)
+    return scoped_ptr<SharedHistogramAllocator>();
+  return make_scoped_ptr(new SharedHistogramAllocator(shared_memory.Pass()));
+}
+
+bool SharedHistogramAllocator::AllocateSamples(HistogramBase* histogram) {
+  if (histogram->GetHistogramType() == SPARSE_HISTOGRAM)
+    return false;
+  Histogram* bucketed = static_cast<Histogram*>(histogram);
+  DCHECK_EQ(0, bucketed->samples_->redundant_count());
+
+  // The reading process finds or creates its own histogram from the info the
+  // same way it does for pickled deltas, which expect the IPC flag. Samples in
+  // the segment cannot be striped per thread.
+  int32 old_flags = histogram->flags();
+  histogram->SetFlags(HistogramBase::kIPCSerializationSourceFlag);
+  histogram->ClearFlags(HistogramBase::kThreadLocalSampleBufferFlag);
+  Pickle info;
+  histogram->SerializeInfo(&info);
+
+  size_t bucket_count = bucketed->bucket_ranges()->bucket_count();
+  size_t counts_offset = GetCountsOffset(info.size());
+  size_t record_size = AlignRecord(
+      counts_offset + bucket_count * sizeof(HistogramBase::AtomicCount));
+
+  // Reserve the record. Readers skip it until it is marked ready.
+  SegmentHeader* header = reinterpret_cast<SegmentHeader*>(memory_);
+  size_t segment_size = std::min(size_, static_cast<size_t>(header->size));
+  size_t offset;
+  while (true) {
+    subtle::Atomic32 used = subtle::Acquire_Load(&header->used);
+    offset = static_cast<size_t>(used);
+    if (offset > segment_size || segment_size - offset < record_size) {
+      histogram->ClearFlags(~old_flags);
+      histogram->SetFlags(old_flags);
+      return false;
+    }
+    subtle::Atomic32 new_used = static_cast<subtle::Atomic32>(offset +
+                                                              record_size);
+    if (subtle::NoBarrier_CompareAndSwap(&header->used, used, new_used) ==
+        used) {
+      break;
+    }
+  }
+
+  char* record_memory = memory_ + offset;
+  RecordHeader* record = reinterpret_cast<RecordHeader*>(record_memory);
+  record->size = static_cast<uint32>(record_size);
+  record->info_size = static_cast<uint32>(info.size());
+  record->bucket_count = static_cast<uint32>(bucket_count);
+  record->meta.sum = 0;
+  record->meta.redundant_count = 0;
+  memcpy(record_memory + sizeof(RecordHeader), info.data(), info.size());
+  HistogramBase::AtomicCount* counts =
+      reinterpret_cast<HistogramBase::AtomicCount*>(record_memory +
+                                                    counts_offset);
+  memset(counts, 0, bucket_count * sizeof(HistogramBase::AtomicCount));
+
+  bucketed->samples_.reset(new SampleVector(counts, bucket_count,
+                                            &record->meta,
+                                            bucketed->bucket_ranges()));
+  histogram->SetFlags(HistogramBase::kSharedMemorySamplesFlag);
+  subtle::Release_Store(&record->state, kRecordReady);
+  return true;
+}
+
+void SharedHistogramAllocator::ImportDeltas() {
+  AutoLock auto_lock(import_lock_);
+
+  size_t used = GetUsedSize();
+  while (import_offset_ < used) {
+    size_t record_size = ImportRecord(import_offset_);
+    if (!record_size)
+      break;
+    import_offset_ += record_size;
+  }
+
+  for (size_t i = 0; i < imported_.size(); ++i) {
+    ImportedHistogram* imported = imported_[i];
+    const BucketRanges* ranges =
+        static_cast<Histogram*>(imported->histogram)->bucket_ranges();
+    SampleVector delta(ranges);
+    delta.Add(*imported->shared_samples);
+    delta.Subtract(*imported->imported_samples);
+    if (!delta.redundant_count())
+      continue;
+    imported->imported_samples->Add(delta);
+    imported->histogram->AddSamples(delta);
+  }
+}
+
+size_t SharedHistogramAllocator::GetUsedSize() const {
+  const SegmentHeader* header = reinterpret_cast<const SegmentHeader*>(memory_);
+  subtle::Atomic32 used = subtle::Acquire_Load(&header->used);
+  if (used < 0)
+    return 0;
+  return std::min(size_, static_cast<size_t>(used));
+}
+
+size_t SharedHistogramAllocator::ImportRecord(size_t offset) {
+  size_t available = GetUsedSize() - offset;
+  if (available < sizeof(RecordHeader))
+    return 0;
+  char* record_memory = memory_ + offset;
+  RecordHeader* record = reinterpret_cast<RecordHeader*>(record_memory);
+  if (subtle::Acquire_Load(&record->state) != kRecordReady)
+    return 0;
+
+  // Read every field once; the other process may still be changing them.
+  size_t record_size = record->size;
+  size_t info_size = record->info_size;
+  size_t bucket_count = record->bucket_count;
+  if (record_size != AlignRecord(record_size) || record_size > available ||
+      info_size > record_size || bucket_count > Histogram::kBucketCount_MAX) {
+    DLOG(ERROR) << "Corrupt histogram record at offset " << offset;
+    return 0;
+  }
+  size_t counts_offset = GetCountsOffset(info_size);
+  if (counts_offset > record_size ||
+      (record_size - counts_offset) / sizeof(HistogramBase::AtomicCount) <
+          bucket_count) {
+    DLOG(ERROR) << "Corrupt histogram record at offset " << offset;
+    return 0;
+  }
+
+  // From here on the record can be skipped if it does not make sense.
+  std::string info(record_memory + sizeof(RecordHeader), info_size);
+  Pickle pickle(info.data(), static_cast<int>(info.size()));
+  PickleIterator iter(pickle);
+  HistogramBase* histogram = DeserializeHistogramInfo(&iter);
+  if (!histogram || histogram->GetHistogramType() == SPARSE_HISTOGRAM)
+    return record_size;
+  if (histogram->flags() & HistogramBase::kIPCSerializationSourceFlag) {
+    DVLOG(1) << "Single process mode, histogram observed and not copied: "
+             << histogram->histogram_name();
+    return record_size;
+  }
+  const BucketRanges* ranges =
+      static_cast<Histogram*>(histogram)->bucket_ranges();
+  if (ranges->bucket_count() != bucket_count)
+    return record_size;
+
+  ImportedHistogram* imported = new ImportedHistogram;
+  imported->histogram = histogram;
+  imported->shared_samples.reset(new SampleVector(
+      reinterpret_cast<HistogramBase::AtomicCount*>(record_memory +
+                                                    counts_offset),
+      bucket_count, &record->meta, ranges));
+  imported->imported_samples.reset(new SampleVector(ranges));
+  imported_.push_back(imported);
+  return record_size;
+}
+
+}  // namespace base
@@ -0,0 +1,93 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SharedHistogramAllocator lays out histogram samples in a shared memory
+// segment, so that a child process records straight into memory that the
+// browser maps and reads whenever it likes. Reading needs no IPC, and samples
+// recorded up to a crash of the child are still in the segment afterwards.
+//
+// The browser creates the segment with Create() and shares it with the child,
+// which wraps it with CreateFromSharedMemory() and hands it to
+// StatisticsRecorder::SetSharedHistogramAllocator(). From then on, the child's
+// newly registered histograms are allocated in the segment until it is full.
+// The browser periodically calls ImportDeltas() to add what was recorded since
+// the previous call to its own histograms of the same name.
+//
+// The segment is an append-only sequence of records, one per histogram, each
+// holding the serialized construction arguments, the sum and redundant count,
+// and the bucket counts. The segment is writable by the child, so the browser
+// validates everything it reads, as it does for pickled histograms.
+
+#ifndef BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
+#define BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+class HistogramBase;
+class SharedMemory;
+
+class BASE_EXPORT SharedHistogramAllocator {
+ public:
+  ~SharedHistogramAllocator();
+
+  // Creates and formats an anonymous segment of |size| bytes. Returns NULL if
+  // the memory could not be created.
+  static scoped_ptr<SharedHistogramAllocator> Create(size_t size);
+
+  // Wraps |shared_memory|, which must be mapped and formatted by Create() in
+  // another process. Returns NULL if it does not hold a valid segment.
+  static scoped_ptr<SharedHistogramAllocator> CreateFromSharedMemory(
+      scoped_ptr<SharedMemory> shared_memory);
+
+  SharedMemory* shared_memory() { return shared_memory_.get(); }
+
+  // Moves the samples of |histogram|, which must not have recorded anything
+  // yet, into the segment and marks it with kSharedMemorySamplesFlag. Returns
+  // false, leaving |histogram| untouched, for sparse histograms or when the
+  // segment is full.
+  bool AllocateSamples(HistogramBase* histogram);
+
+  // Adds the samples recorded into the segment since the previous call to the
+  // histograms of the same name in this process, creating them as needed.
+  // Silently skips records that fail validation.
+  void ImportDeltas();
+
+ private:
+  struct ImportedHistogram;
+
+  explicit SharedHistogramAllocator(scoped_ptr<SharedMemory> shared_memory);
+
+  // Bytes of the segment in use, as published by the allocating process and
+  // clamped to what is mapped here.
+  size_t GetUsedSize() const;
+
+  // Validates the record at |offset| and returns its size; 0 if the record is
+  // not complete yet or is broken, in which case importing stops there.
+  // Appends an entry to |imported_| for records that can be imported.
+  size_t ImportRecord(size_t offset);
+
+  scoped_ptr<SharedMemory> shared_memory_;
+  char* memory_;
+  size_t size_;
+
+  // Guards the import state below. Allocation is lock-free.
+  Lock import_lock_;
+
+  // Offset of the first record that has not been looked at yet.
+  size_t import_offset_;
+
+  ScopedVector<ImportedHistogram> imported_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedHistogramAllocator);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
@@ -0,0 +1,200 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_allocator.h"
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/shared_memory.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_delta_serialization.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/sparse_histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/process/process_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+const size_t kSegmentSize = 64 * 1024;
+
+class SharedHistogramAllocatorTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    statistics_recorder_ = new StatisticsRecorder();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    delete statistics_recorder_;
+    statistics_recorder_ = NULL;
+  }
+
+  // Emulates switching from the child process to the browser: histograms
+  // created so far stay alive but are no longer registered.
+  void ResetStatisticsRecorder() {
+    delete statistics_recorder_;
+    statistics_recorder_ = new StatisticsRecorder();
+  }
+
+  // Maps the segment of |allocator| a second time, the way a child does.
+  scoped_ptr<SharedHistogramAllocator> MapInChild(
+      SharedHistogramAllocator* allocator) {
+    SharedMemoryHandle handle;
+    if (!allocator->shared_memory()->ShareToProcess(GetCurrentProcessHandle(),
+                                                    &handle)) {
+      return scoped_ptr<SharedHistogramAllocator>();
+    }
+    scoped_ptr<SharedMemory> memory(new SharedMemory(handle, false));
+    if (!memory->Map(allocator->shared_memory()->mapped_size()))
+      return scoped_ptr<SharedHistogramAllocator>();
+    return SharedHistogramAllocator::CreateFromSharedMemory(memory.Pass());
+  }
+
+  StatisticsRecorder* statistics_recorder_;
+};
+
+TEST_F(SharedHistogramAllocatorTest, ImportDeltas) {
+  scoped_ptr<SharedHistogramAllocator> browser =
+      SharedHistogramAllocator::Create(kSegmentSize);
+  ASSERT_TRUE(browser);
+  scoped_ptr<SharedHistogramAllocator> child = MapInChild(browser.get());
+  ASSERT_TRUE(child);
+
+  HistogramBase* child_histogram = LinearHistogram::FactoryGet(
+      "Shared", 1, 100, 101, HistogramBase::kUmaTargetedHistogramFlag);
+  ASSERT_TRUE(child->AllocateSamples(child_histogram));
+  EXPECT_TRUE(child_histogram->flags() &
+              HistogramBase::kSharedMemorySamplesFlag);
+  child_histogram->Add(5);
+  child_histogram->Add(5);
+  child_histogram->Add(50);
+
+  scoped_ptr<HistogramSamples> child_samples =
+      child_histogram->SnapshotSamples();
+  EXPECT_EQ(3, child_samples->TotalCount());
+  EXPECT_EQ(60, child_samples->sum());
+
+  ResetStatisticsRecorder();
+  browser->ImportDeltas();
+  HistogramBase* browser_histogram =
+      StatisticsRecorder::FindHistogram("Shared");
+  ASSERT_TRUE(browser_histogram);
+  EXPECT_NE(child_histogram, browser_histogram);
+  EXPECT_EQ(LINEAR_HISTOGRAM, browser_histogram->GetHistogramType());
+  EXPECT_TRUE(browser_histogram->HasConstructionArguments(1, 100, 101));
+  EXPECT_EQ(HistogramBase::kUmaTargetedHistogramFlag,
+            browser_histogram->flags());
+
+  scoped_ptr<HistogramSamples> samples = browser_histogram->SnapshotSamples();
+  EXPECT_EQ(3, samples->TotalCount());
+  EXPECT_EQ(3, samples->redundant_count());
+  EXPECT_EQ(2, samples->GetCount(5));
+  EXPECT_EQ(1, samples->GetCount(50));
+  EXPECT_EQ(60, samples->sum());
+
+  // Only what was recorded since the previous import is added.
+  browser->ImportDeltas();
+  child_histogram->Add(7);
+  browser->ImportDeltas();
+  samples = browser_histogram->SnapshotSamples();
+  EXPECT_EQ(4, samples->TotalCount());
+  EXPECT_EQ(1, samples->GetCount(7));
+  EXPECT_EQ(67, samples->sum());
+}
+
+TEST_F(SharedHistogramAllocatorTest, SamplesSurviveChild) {
+  scoped_ptr<SharedHistogramAllocator> browser =
+      SharedHistogramAllocator::Create(kSegmentSize);
+  ASSERT_TRUE(browser);
+  scoped_ptr<SharedHistogramAllocator> child = MapInChild(browser.get());
+  ASSERT_TRUE(child);
+
+  HistogramBase* child_histogram = BooleanHistogram::FactoryGet(
+      "SharedBoolean", HistogramBase::kNoFlags);
+  ASSERT_TRUE(child->AllocateSamples(child_histogram));
+  child_histogram->AddBoolean(true);
+
+  // The child goes away before the browser looked at the segment.
+  child.reset();
+  ResetStatisticsRecorder();
+  browser->ImportDeltas();
+
+  HistogramBase* browser_histogram =
+      StatisticsRecorder::FindHistogram("SharedBoolean");
+  ASSERT_TRUE(browser_histogram);
+  EXPECT_EQ(BOOLEAN_HISTOGRAM, browser_histogram->GetHistogramType());
+  EXPECT_EQ(1, browser_histogram->SnapshotSamples()->GetCount(1));
+}
+
+TEST_F(SharedHistogramAllocatorTest, StatisticsRecorderAllocates) {
+  scoped_ptr<SharedHistogramAllocator> browser =
+      SharedHistogramAllocator::Create(kSegmentSize);
+  ASSERT_TRUE(browser);
+  HistogramBase* local = Histogram::FactoryGet(
+      "Local", 1, 1000, 10, HistogramBase::kNoFlags);
+  StatisticsRecorder::SetSharedHistogramAllocator(MapInChild(browser.get()));
+
+  HistogramBase* shared = Histogram::FactoryGet(
+      "Shared", 1, 1000, 10, HistogramBase::kNoFlags);
+  HistogramBase* sparse = SparseHistogram::FactoryGet(
+      "Sparse", HistogramBase::kNoFlags);
+  EXPECT_FALSE(local->flags() & HistogramBase::kSharedMemorySamplesFlag);
+  EXPECT_TRUE(shared->flags() & HistogramBase::kSharedMemorySamplesFlag);
+  EXPECT_FALSE(sparse->flags() & HistogramBase::kSharedMemorySamplesFlag);
+
+  // Samples in the segment are not also sent over IPC.
+  HistogramDeltaSerialization serializer("SharedHistogramAllocatorTest");
+  std::vector<std::string> deltas;
+  local->Add(1);
+  shared->Add(1);
+  serializer.PrepareAndSerializeDeltas(&deltas);
+  EXPECT_EQ(1u, deltas.size());
+
+  // In single process mode the browser sees its own histogram and leaves it
+  // alone.
+  browser->ImportDeltas();
+  EXPECT_EQ(1, shared->SnapshotSamples()->TotalCount());
+}
+
+TEST_F(SharedHistogramAllocatorTest, SegmentFull) {
+  scoped_ptr<SharedHistogramAllocator> allocator =
+      SharedHistogramAllocator::Create(256);
+  ASSERT_TRUE(allocator);
+
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TooBig", 1, 1000, 50, HistogramBase::kNoFlags);
+  EXPECT_FALSE(allocator->AllocateSamples(histogram));
+  EXPECT_EQ(HistogramBase::kNoFlags, histogram->flags());
+  histogram->Add(10);
+  EXPECT_EQ(1, histogram->SnapshotSamples()->TotalCount());
+}
+
+TEST_F(SharedHistogramAllocatorTest, RejectsBadSegments) {
+  scoped_ptr<SharedMemory> memory(new SharedMemory);
+  ASSERT_TRUE(memory->CreateAndMapAnonymous(kSegmentSize));
+  EXPECT_FALSE(SharedHistogramAllocator::CreateFromSharedMemory(memory.Pass()));
+
+  scoped_ptr<SharedHistogramAllocator> browser =
+      SharedHistogramAllocator::Create(kSegmentSize);
+  ASSERT_TRUE(browser);
+  scoped_ptr<SharedHistogramAllocator> child = MapInChild(browser.get());
+  ASSERT_TRUE(child);
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "Corrupt", 1, 1000, 10, HistogramBase::kNoFlags);
+  ASSERT_TRUE(child->AllocateSamples(histogram));
+  histogram->Add(3);
+
+  // Overwrite the record's size, which comes right after its state.
+  uint32* record = reinterpret_cast<uint32*>(
+      static_cast<char*>(browser->shared_memory()->memory()) + 16);
+  record[1] = kSegmentSize * 2;
+
+  ResetStatisticsRecorder();
+  browser->ImportDeltas();
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("Corrupt"));
+}
+
+}  // namespace base
@@ -4,6 +4,7 @@
 
 #include "base/metrics/sparse_histogram.h"
 
+#include "base/logging.h"
 #include "base/metrics/sample_map.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
@@ -48,8 +49,16 @@ bool SparseHistogram::HasConstructionArguments(
 }
 
 void SparseHistogram::Add(Sample value) {
+  AddCount(value, 1);
+}
+
+void SparseHistogram::AddCount(Sample value, int count) {
+  if (count <= 0) {
+    NOTREACHED();
+    return;
+  }
   base::AutoLock auto_lock(lock_);
-  samples_.Accumulate(value, 1);
+  samples_.Accumulate(value, count);
 }
 
 scoped_ptr<HistogramSamples> SparseHistogram::SnapshotSamples() const {
@@ -69,6 +69,7 @@ class BASE_EXPORT_PRIVATE SparseHistogram : public HistogramBase {
       Sample expected_maximum,
       size_t expected_bucket_count) const OVERRIDE;
   virtual void Add(Sample value) OVERRIDE;
+  virtual void AddCount(Sample value, int count) OVERRIDE;
   virtual void AddSamples(const HistogramSamples& samples) OVERRIDE;
   virtual bool AddSamplesFromPickle(PickleIterator* iter) OVERRIDE;
   virtual scoped_ptr<HistogramSamples> SnapshotSamples() const OVERRIDE;
@@ -63,6 +63,19 @@ TEST_F(SparseHistogramTest, BasicTest) {
   EXPECT_EQ(1, snapshot2->GetCount(101));
 }
 
+TEST_F(SparseHistogramTest, AddCountTest) {
+  scoped_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
+  histogram->AddCount(100, 4);
+  histogram->AddCount(101, 1);
+  histogram->Add(100);
+
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(6, snapshot->TotalCount());
+  EXPECT_EQ(5, snapshot->GetCount(100));
+  EXPECT_EQ(1, snapshot->GetCount(101));
+  EXPECT_EQ(601, snapshot->sum());
+}
+
 TEST_F(SparseHistogramTest, MacroBasicTest) {
   HISTOGRAM_SPARSE_SLOWLY("Sparse", 100);
   HISTOGRAM_SPARSE_SLOWLY("Sparse", 200);
@@ -10,6 +10,7 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
+#include "base/metrics/shared_histogram_allocator.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
 #include "base/values.h"
@@ -63,6 +64,10 @@ HistogramBase* StatisticsRecorder::RegisterOrDeleteDuplicate(
       const string& name = histogram->histogram_name();
       HistogramMap::iterator it = histograms_->find(name);
       if (histograms_->end() == it) {
+        // Move the samples before the histogram is published, while nothing
+        // can have recorded into it.
+        if (shared_allocator_)
+          shared_allocator_->AllocateSamples(histogram);
         (*histograms_)[name] = histogram;
         ANNOTATE_LEAKING_OBJECT_PTR(histogram);  // see crbug.com/79322
         histogram_to_return = histogram;
@@ -128,6 +133,20 @@ const BucketRanges* StatisticsRecorder::RegisterOrDeleteDuplicateRanges(
   return ranges;
 }
 
+// static
+void StatisticsRecorder::SetSharedHistogramAllocator(
+    scoped_ptr<SharedHistogramAllocator> allocator) {
+  if (lock_ == NULL)
+    return;
+  base::AutoLock auto_lock(*lock_);
+  if (histograms_ == NULL)
+    return;
+  // Histograms allocated in a previous segment would be left pointing into
+  // freed memory.
+  DCHECK(!shared_allocator_);
+  shared_allocator_ = allocator.release();
+}
+
 // static
 void StatisticsRecorder::WriteHTMLGraph(const std::string& query,
                                         std::string* output) {
@@ -301,14 +320,17 @@ StatisticsRecorder::~StatisticsRecorder() {
   // Clean up.
   scoped_ptr<HistogramMap> histograms_deleter;
   scoped_ptr<RangesMap> ranges_deleter;
+  scoped_ptr<SharedHistogramAllocator> shared_allocator_deleter;
   // We don't delete lock_ on purpose to avoid having to properly protect
   // against it going away after we checked for NULL in the static methods.
   {
     base::AutoLock auto_lock(*lock_);
     histograms_deleter.reset(histograms_);
     ranges_deleter.reset(ranges_);
+    shared_allocator_deleter.reset(shared_allocator_);
     histograms_ = NULL;
     ranges_ = NULL;
+    shared_allocator_ = NULL;
   }
   // We are going to leak the histograms and the ranges.
 }
@@ -319,6 +341,8 @@ StatisticsRecorder::HistogramMap* StatisticsRecorder::histograms_ = NULL;
 // static
 StatisticsRecorder::RangesMap* StatisticsRecorder::ranges_ = NULL;
 // static
+SharedHistogramAllocator* StatisticsRecorder::shared_allocator_ = NULL;
+// static
 base::Lock* StatisticsRecorder::lock_ = NULL;
 
 }  // namespace base
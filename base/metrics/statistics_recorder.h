@@ -19,12 +19,14 @@
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
 #include "base/lazy_instance.h"
+#include "base/memory/scoped_ptr.h"
 
 namespace base {
 
 class BucketRanges;
 class HistogramBase;
 class Lock;
+class SharedHistogramAllocator;
 
 class BASE_EXPORT StatisticsRecorder {
  public:
@@ -49,6 +51,13 @@ class BASE_EXPORT StatisticsRecorder {
   static const BucketRanges* RegisterOrDeleteDuplicateRanges(
       const BucketRanges* ranges);
 
+  // Makes histograms registered from now on keep their samples in
+  // |allocator|'s segment while it has room, so that the process which
+  // created the segment can read them directly. Histograms registered
+  // earlier are unaffected.
+  static void SetSharedHistogramAllocator(
+      scoped_ptr<SharedHistogramAllocator> allocator);
+
   // Methods for appending histogram data to a string.  Only histograms which
   // have |query| as a substring are written to |output| (an empty string will
   // process all registered histograms).
@@ -88,6 +97,7 @@ class BASE_EXPORT StatisticsRecorder {
   friend class HistogramBaseTest;
   friend class HistogramSnapshotManagerTest;
   friend class HistogramTest;
+  friend class SharedHistogramAllocatorTest;
   friend class SparseHistogramTest;
   friend class StatisticsDeltaReaderTest;
   friend class StatisticsRecorderTest;
@@ -105,7 +115,10 @@ class BASE_EXPORT StatisticsRecorder {
   static HistogramMap* histograms_;
   static RangesMap* ranges_;
 
-  // Lock protects access to above maps.
+  // Segment that newly registered histograms are allocated in, or NULL.
+  static SharedHistogramAllocator* shared_allocator_;
+
+  // Lock protects access to above maps and |shared_allocator_|.
   static base::Lock* lock_;
 
   DISALLOW_COPY_AND_ASSIGN(StatisticsRecorder);
@@ -13,6 +13,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
 #include "base/strings/string16.h"
+#include "base/strings/string_piece.h"
 
 class Pickle;
 
@@ -38,6 +39,13 @@ class BASE_EXPORT PickleIterator {
   bool ReadString(std::string* result) WARN_UNUSED_RESULT;
   bool ReadWString(std::wstring* result) WARN_UNUSED_RESULT;
   bool ReadString16(base::string16* result) WARN_UNUSED_RESULT;
+
+  // These read a string written by WriteString() or WriteString16() without
+  // copying it. The result points into the Pickle's buffer, so it is only
+  // valid for the lifetime of the Pickle (or until its data is mutated).
+  bool ReadStringPiece(base::StringPiece* result) WARN_UNUSED_RESULT;
+  bool ReadStringPiece16(base::StringPiece16* result) WARN_UNUSED_RESULT;
+
   bool ReadData(const char** data, int* length) WARN_UNUSED_RESULT;
   bool ReadBytes(const char** data, int length) WARN_UNUSED_RESULT;
 
@@ -8,6 +8,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/strings/string16.h"
+#include "base/strings/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 // Remove when this file is in the base namespace.
@@ -362,3 +363,26 @@ TEST(PickleTest, ReadBytes) {
   memcpy(&outdata, outdata_char, sizeof(outdata));
   EXPECT_EQ(data, outdata);
 }
+
+TEST(PickleTest, ReadStringPiece) {
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteString(teststr));
+  EXPECT_TRUE(pickle.WriteString16(base::ASCIIToUTF16(teststr)));
+  EXPECT_TRUE(pickle.WriteString(std::string()));
+
+  PickleIterator iter(pickle);
+  base::StringPiece outstr;
+  EXPECT_TRUE(iter.ReadStringPiece(&outstr));
+  EXPECT_EQ(teststr, outstr.as_string());
+  // The result points into the pickle rather than at a copy.
+  EXPECT_GT(outstr.data(), pickle.payload());
+  EXPECT_LT(outstr.data(), pickle.end_of_payload());
+
+  base::StringPiece16 outstr16;
+  EXPECT_TRUE(iter.ReadStringPiece16(&outstr16));
+  EXPECT_EQ(base::ASCIIToUTF16(teststr), outstr16.as_string());
+
+  EXPECT_TRUE(iter.ReadStringPiece(&outstr));
+  EXPECT_TRUE(outstr.empty());
+  EXPECT_FALSE(iter.ReadStringPiece(&outstr));
+}
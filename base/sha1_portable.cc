@@ -6,6 +6,8 @@
 
 #include <string.h>
 
+#include <algorithm>
+
 #include "base/basictypes.h"
 
 namespace base {
@@ -49,6 +51,7 @@ class SecureHashAlgorithm {
  private:
   void Pad();
   void Process();
+  inline void Round(uint32 f, uint32 k, uint32 w);
 
   uint32 A, B, C, D, E;
 
@@ -63,34 +66,10 @@ class SecureHashAlgorithm {
   uint32 l;
 };
 
-static inline uint32 f(uint32 t, uint32 B, uint32 C, uint32 D) {
-  if (t < 20) {
-    return (B & C) | ((~B) & D);
-  } else if (t < 40) {
-    return B ^ C ^ D;
-  } else if (t < 60) {
-    return (B & C) | (B & D) | (C & D);
-  } else {
-    return B ^ C ^ D;
-  }
-}
-
 static inline uint32 S(uint32 n, uint32 X) {
   return (X << n) | (X >> (32-n));
 }
 
-static inline uint32 K(uint32 t) {
-  if (t < 20) {
-    return 0x5a827999;
-  } else if (t < 40) {
-    return 0x6ed9eba1;
-  } else if (t < 60) {
-    return 0x8f1bbcdc;
-  } else {
-    return 0xca62c1d6;
-  }
-}
-
 static inline void swapends(uint32* t) {
   *t = ((*t & 0xff000000) >> 24) |
        ((*t & 0xff0000) >> 8) |
@@ -125,11 +104,16 @@ void SecureHashAlgorithm::Final() {
 
 void SecureHashAlgorithm::Update(const void* data, size_t nbytes) {
   const uint8* d = reinterpret_cast<const uint8*>(data);
-  while (nbytes--) {
-    M[cursor++] = *d++;
+  l += static_cast<uint32>(nbytes * 8);
+  // Fill the block a chunk at a time rather than byte by byte.
+  while (nbytes) {
+    size_t chunk = std::min(nbytes, static_cast<size_t>(64 - cursor));
+    memcpy(M + cursor, d, chunk);
+    cursor += static_cast<uint32>(chunk);
+    d += chunk;
+    nbytes -= chunk;
     if (cursor >= 64)
       Process();
-    l += 8;
   }
 }
 
@@ -153,6 +137,15 @@ void SecureHashAlgorithm::Pad() {
   M[64-1] = (l & 0xff);
 }
 
+inline void SecureHashAlgorithm::Round(uint32 f, uint32 k, uint32 w) {
+  uint32 TEMP = S(5, A) + f + E + w + k;
+  E = D;
+  D = C;
+  C = S(30, B);
+  B = A;
+  A = TEMP;
+}
+
 void SecureHashAlgorithm::Process() {
   uint32 t;
 
@@ -177,14 +170,17 @@ void SecureHashAlgorithm::Process() {
   E = H[4];
 
   // d.
-  for (t = 0; t < 80; ++t) {
-    uint32 TEMP = S(5, A) + f(t, B, C, D) + E + W[t] + K(t);
-    E = D;
-    D = C;
-    C = S(30, B);
-    B = A;
-    A = TEMP;
-  }
+  //
+  // The 80 rounds are split where the round function and constant change, so
+  // the inner loops have no branches.
+  for (t = 0; t < 20; ++t)
+    Round((B & C) | ((~B) & D), 0x5a827999, W[t]);
+  for (; t < 40; ++t)
+    Round(B ^ C ^ D, 0x6ed9eba1, W[t]);
+  for (; t < 60; ++t)
+    Round((B & C) | (B & D) | (C & D), 0x8f1bbcdc, W[t]);
+  for (; t < 80; ++t)
+    Round(B ^ C ^ D, 0xca62c1d6, W[t]);
 
   // e.
   H[0] += A;
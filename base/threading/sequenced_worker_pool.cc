@@ -4,6 +4,7 @@
 
 #include "base/threading/sequenced_worker_pool.h"
 
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
@@ -11,6 +12,7 @@
 #include <vector>
 
 #include "base/atomic_sequence_num.h"
+#include "base/atomicops.h"
 #include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/critical_closure.h"
@@ -18,6 +20,7 @@
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/stl_util.h"
 #include "base/strings/stringprintf.h"
@@ -84,6 +87,28 @@ struct SequencedTaskLessThan {
   }
 };
 
+// WorkQueue -----------------------------------------------------------------
+// A deque of tasks served by one worker thread in WORK_STEALING mode. All
+// tasks sharing a sequence token live in the same WorkQueue, which lets the
+// queue track the sequences it has running without the pool-wide lock.
+struct WorkQueue {
+  WorkQueue() {}
+  ~WorkQueue() {}
+
+  // Protects the members below. When both are needed, the pool-wide lock must
+  // be acquired before this one.
+  Lock lock;
+
+  // Tasks that have not been taken by a worker yet, in posting order.
+  std::deque<SequencedTask> tasks;
+
+  // Sequence tokens of tasks taken from |tasks| that are still running.
+  std::set<int> running_sequences;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(WorkQueue);
+};
+
 // SequencedWorkerPoolTaskRunner ---------------------------------------------
 // A TaskRunner which posts tasks to a SequencedWorkerPool with a
 // fixed ShutdownBehavior.
@@ -252,8 +277,13 @@ class SequencedWorkerPool::Worker : public SimpleThread {
     return running_shutdown_behavior_;
   }
 
+  int thread_number() const {
+    return thread_number_;
+  }
+
  private:
   scoped_refptr<SequencedWorkerPool> worker_pool_;
+  const int thread_number_;
   SequenceToken running_sequence_;
   WorkerShutdown running_shutdown_behavior_;
 
@@ -268,6 +298,7 @@ class SequencedWorkerPool::Inner {
   // by it).
   Inner(SequencedWorkerPool* worker_pool, size_t max_threads,
         const std::string& thread_name_prefix,
+        SchedulingMode scheduling_mode,
         TestingObserver* observer);
 
   ~Inner();
@@ -389,6 +420,59 @@ class SequencedWorkerPool::Inner {
   // called inside the lock.
   bool CanShutdown() const;
 
+  // WORK_STEALING mode -------------------------------------------------------
+  //
+  // Unless their name says otherwise, these are called outside |lock_|.
+
+  // Counterpart of the locked part of PostTask() for non-delayed tasks.
+  // Returns false if the task may not be posted because of shutdown.
+  bool PostTaskToWorkQueues(SequencedTask* sequenced);
+
+  // Appends |task| to the work queue selected by its sequence token.
+  void PushToWorkQueue(const SequencedTask& task);
+
+  // Returns the queue holding all tasks of |sequence_token_id|.
+  WorkQueue* WorkQueueForSequence(int sequence_token_id) const;
+
+  // Scans the work queues, starting at |home_queue|, for the oldest task
+  // whose sequence is not running. Returns true and fills in |task| if one
+  // was found. Non-BLOCK_SHUTDOWN tasks found after shutdown has started are
+  // moved to |deleted_tasks| instead; the caller must pass those to
+  // DidDeleteWorkQueueTasks().
+  bool TakeTaskFromWorkQueues(size_t home_queue,
+                              SequencedTask* task,
+                              std::vector<Closure>* deleted_tasks);
+
+  // Destroys |deleted_tasks| and updates the accounting for them.
+  void DidDeleteWorkQueueTasks(std::vector<Closure>* deleted_tasks);
+
+  // Called by Shutdown(), deletes the queued tasks that will not run because
+  // shutdown has started, like GetWork() does in GLOBAL_QUEUE mode. Tasks
+  // waiting behind a running task of their sequence are left for the worker
+  // running that sequence to delete.
+  void DeleteWorkQueueTasksOnShutdown();
+
+  // Runs |task| on |this_worker| and releases its sequence afterwards.
+  void RunWorkQueueTask(Worker* this_worker, SequencedTask* task);
+
+  // Called from within the lock, returns true if any work queue holds a task
+  // that can be taken right now.
+  bool LockedHasRunnableWorkQueueTask() const;
+
+  // Called from within the lock, moves the delayed tasks that are due from
+  // |pending_tasks_| to the work queues. After shutdown the delayed tasks
+  // are moved to |delete_these_outside_lock| instead.
+  void LockedScheduleDueDelayedTasks(
+      std::vector<Closure>* delete_these_outside_lock);
+
+  // Decrement the corresponding counters and wake up Shutdown() and
+  // CleanupForTesting() when they drop to zero.
+  void DidFinishBlockingShutdownTasks(int count);
+  void DidFinishOutstandingTasks(int count);
+
+  void WorkStealingThreadLoop(Worker* this_worker);
+  void WorkStealingCleanupForTesting();
+
   SequencedWorkerPool* const worker_pool_;
 
   // The last sequence number used. Managed by GetSequenceToken, since this
@@ -454,7 +538,8 @@ class SequencedWorkerPool::Inner {
   std::set<int> current_sequences_;
 
   // An ID for each posted task to distinguish the task from others in traces.
-  int trace_id_;
+  // Atomic so WORK_STEALING mode can assign IDs without holding the lock.
+  subtle::Atomic32 trace_id_;
 
   // Set when Shutdown is called and no further tasks should be
   // allowed, though we may still be running existing tasks.
@@ -471,6 +556,41 @@ class SequencedWorkerPool::Inner {
 
   TestingObserver* const testing_observer_;
 
+  const SchedulingMode scheduling_mode_;
+
+  // WORK_STEALING mode state. |lock_| is not needed to access any of it.
+  // |pending_tasks_| then only holds delayed tasks that are not due yet.
+
+  // One queue per potential worker thread, created up front.
+  ScopedVector<WorkQueue> work_queues_;
+
+  // Used to spread unsequenced tasks over |work_queues_|.
+  subtle::Atomic32 next_work_queue_;
+
+  // Mirrors |shutdown_called_| so posting and running tasks can check it
+  // without the lock.
+  subtle::Atomic32 shutdown_flag_;
+
+  // Mirror |threads_.size()| and |pending_tasks_.size()|.
+  subtle::Atomic32 started_thread_count_;
+  subtle::Atomic32 delayed_task_count_;
+
+  // Number of workers waiting on |has_work_cv_|.
+  subtle::Atomic32 idle_thread_count_;
+
+  // Number of tasks in |work_queues_|, and that number plus the number of
+  // tasks taken from there that have not finished running yet.
+  subtle::Atomic32 queued_task_count_;
+  subtle::Atomic32 outstanding_task_count_;
+
+  // Counterparts of |blocking_shutdown_pending_task_count_| and
+  // |blocking_shutdown_thread_count_| for tasks in |work_queues_|.
+  subtle::Atomic32 blocking_shutdown_queued_count_;
+  subtle::Atomic32 blocking_shutdown_running_count_;
+
+  // Number of threads waiting in WorkStealingCleanupForTesting().
+  subtle::Atomic32 flush_waiter_count_;
+
   DISALLOW_COPY_AND_ASSIGN(Inner);
 };
 
@@ -483,6 +603,7 @@ SequencedWorkerPool::Worker::Worker(
     : SimpleThread(
           prefix + StringPrintf("Worker%d", thread_number).c_str()),
       worker_pool_(worker_pool),
+      thread_number_(thread_number),
       running_shutdown_behavior_(CONTINUE_ON_SHUTDOWN) {
   Start();
 }
@@ -511,6 +632,7 @@ SequencedWorkerPool::Inner::Inner(
     SequencedWorkerPool* worker_pool,
     size_t max_threads,
     const std::string& thread_name_prefix,
+    SchedulingMode scheduling_mode,
     TestingObserver* observer)
     : worker_pool_(worker_pool),
       lock_(),
@@ -529,7 +651,24 @@ SequencedWorkerPool::Inner::Inner(
       cleanup_state_(CLEANUP_DONE),
       cleanup_idlers_(0),
       cleanup_cv_(&lock_),
-      testing_observer_(observer) {}
+      testing_observer_(observer),
+      scheduling_mode_(scheduling_mode),
+      next_work_queue_(0),
+      shutdown_flag_(0),
+      started_thread_count_(0),
+      delayed_task_count_(0),
+      idle_thread_count_(0),
+      queued_task_count_(0),
+      outstanding_task_count_(0),
+      blocking_shutdown_queued_count_(0),
+      blocking_shutdown_running_count_(0),
+      flush_waiter_count_(0) {
+  if (scheduling_mode_ == WORK_STEALING) {
+    DCHECK_GT(max_threads_, 0u);
+    for (size_t i = 0; i < max_threads_; ++i)
+      work_queues_.push_back(new WorkQueue);
+  }
+}
 
 SequencedWorkerPool::Inner::~Inner() {
   // You must call Shutdown() before destroying the pool.
@@ -575,6 +714,14 @@ bool SequencedWorkerPool::Inner::PostTask(
       base::MakeCriticalClosure(task) : task;
   sequenced.time_to_run = TimeTicks::Now() + delay;
 
+  if (scheduling_mode_ == WORK_STEALING && delay == TimeDelta()) {
+    if (optional_token_name) {
+      AutoLock lock(lock_);
+      sequenced.sequence_token_id = LockedGetNamedTokenID(*optional_token_name);
+    }
+    return PostTaskToWorkQueues(&sequenced);
+  }
+
   int create_thread_id = 0;
   {
     AutoLock lock(lock_);
@@ -591,7 +738,7 @@ bool SequencedWorkerPool::Inner::PostTask(
     }
 
     // The trace_id is used for identifying the task in about:tracing.
-    sequenced.trace_id = trace_id_++;
+    sequenced.trace_id = subtle::NoBarrier_AtomicIncrement(&trace_id_, 1) - 1;
 
     TRACE_EVENT_FLOW_BEGIN0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
         "SequencedWorkerPool::PostTask",
@@ -606,6 +753,10 @@ bool SequencedWorkerPool::Inner::PostTask(
     pending_tasks_.insert(sequenced);
     if (shutdown_behavior == BLOCK_SHUTDOWN)
       blocking_shutdown_pending_task_count_++;
+    if (scheduling_mode_ == WORK_STEALING) {
+      subtle::Release_Store(&delayed_task_count_,
+                            static_cast<subtle::Atomic32>(pending_tasks_.size()));
+    }
 
     create_thread_id = PrepareToStartAdditionalThreadIfHelpful();
   }
@@ -636,6 +787,10 @@ bool SequencedWorkerPool::Inner::IsRunningSequenceOnCurrentThread(
 
 // See https://code.google.com/p/chromium/issues/detail?id=168415
 void SequencedWorkerPool::Inner::CleanupForTesting() {
+  if (scheduling_mode_ == WORK_STEALING) {
+    WorkStealingCleanupForTesting();
+    return;
+  }
   DCHECK(!RunsTasksOnCurrentThread());
   base::ThreadRestrictions::ScopedAllowWait allow_wait;
   AutoLock lock(lock_);
@@ -658,6 +813,7 @@ void SequencedWorkerPool::Inner::SignalHasWorkForTesting() {
 void SequencedWorkerPool::Inner::Shutdown(
     int max_new_blocking_tasks_after_shutdown) {
   DCHECK_GE(max_new_blocking_tasks_after_shutdown, 0);
+  bool can_shutdown;
   {
     AutoLock lock(lock_);
     // Cleanup and Shutdown should not be called concurrently.
@@ -667,15 +823,26 @@ void SequencedWorkerPool::Inner::Shutdown(
     shutdown_called_ = true;
     max_blocking_tasks_after_shutdown_ = max_new_blocking_tasks_after_shutdown;
 
+    // Tasks posted or taken in WORK_STEALING mode are counted before the flag
+    // is checked, so the barrier guarantees that CanShutdown() below either
+    // sees them or they see the flag.
+    subtle::NoBarrier_Store(&shutdown_flag_, 1);
+    subtle::MemoryBarrier();
+
     // Tickle the threads. This will wake up a waiting one so it will know that
     // it can exit, which in turn will wake up any other waiting ones.
     SignalHasWork();
 
-    // There are no pending or running tasks blocking shutdown, we're done.
-    if (CanShutdown())
-      return;
+    can_shutdown = CanShutdown();
   }
 
+  if (scheduling_mode_ == WORK_STEALING)
+    DeleteWorkQueueTasksOnShutdown();
+
+  // There are no pending or running tasks blocking shutdown, we're done.
+  if (can_shutdown)
+    return;
+
   // If we're here, then something is blocking shutdown.  So wait for
   // CanShutdown() to go to true.
 
@@ -704,6 +871,11 @@ bool SequencedWorkerPool::Inner::IsShutdownInProgress() {
 }
 
 void SequencedWorkerPool::Inner::ThreadLoop(Worker* this_worker) {
+  if (scheduling_mode_ == WORK_STEALING) {
+    WorkStealingThreadLoop(this_worker);
+    return;
+  }
+
   {
     AutoLock lock(lock_);
     DCHECK(thread_being_created_);
@@ -1080,6 +1252,18 @@ int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
       cleanup_state_ == CLEANUP_DONE &&
       threads_.size() < max_threads_ &&
       waiting_thread_count_ == 0) {
+    if (scheduling_mode_ == WORK_STEALING) {
+      // Runnability is only known to the work queues, so any queued task is
+      // reason enough as long as none of the started workers is idle.
+      if (subtle::Acquire_Load(&idle_thread_count_) == 0 &&
+          (subtle::Acquire_Load(&queued_task_count_) > 0 ||
+           !pending_tasks_.empty())) {
+        thread_being_created_ = true;
+        return static_cast<int>(threads_.size() + 1);
+      }
+      return 0;
+    }
+
     // We could use an additional thread if there's work to be done.
     for (PendingTaskSet::const_iterator i = pending_tasks_.begin();
          i != pending_tasks_.end(); ++i) {
@@ -1115,7 +1299,380 @@ bool SequencedWorkerPool::Inner::CanShutdown() const {
   // See PrepareToStartAdditionalThreadIfHelpful for how thread creation works.
   return !thread_being_created_ &&
          blocking_shutdown_thread_count_ == 0 &&
-         blocking_shutdown_pending_task_count_ == 0;
+         blocking_shutdown_pending_task_count_ == 0 &&
+         subtle::Acquire_Load(&blocking_shutdown_running_count_) == 0 &&
+         subtle::Acquire_Load(&blocking_shutdown_queued_count_) == 0;
+}
+
+bool SequencedWorkerPool::Inner::PostTaskToWorkQueues(
+    SequencedTask* sequenced) {
+  DCHECK_EQ(WORK_STEALING, scheduling_mode_);
+  const WorkerShutdown shutdown_behavior = sequenced->shutdown_behavior;
+
+  // Count the task before looking at the shutdown flag; see Shutdown().
+  if (shutdown_behavior == BLOCK_SHUTDOWN)
+    subtle::Barrier_AtomicIncrement(&blocking_shutdown_queued_count_, 1);
+  if (subtle::Acquire_Load(&shutdown_flag_)) {
+    AutoLock lock(lock_);
+    if (shutdown_behavior != BLOCK_SHUTDOWN)
+      return false;
+    if (LockedCurrentThreadShutdownBehavior() == CONTINUE_ON_SHUTDOWN ||
+        max_blocking_tasks_after_shutdown_ <= 0) {
+      DLOG_IF(WARNING, max_blocking_tasks_after_shutdown_ <= 0)
+          << "BLOCK_SHUTDOWN task disallowed";
+      subtle::Barrier_AtomicIncrement(&blocking_shutdown_queued_count_, -1);
+      // Shutdown() and idle workers may have seen the task we just undid.
+      can_shutdown_cv_.Signal();
+      SignalHasWork();
+      return false;
+    }
+    max_blocking_tasks_after_shutdown_ -= 1;
+  }
+
+  // The trace_id is used for identifying the task in about:tracing.
+  sequenced->trace_id = subtle::NoBarrier_AtomicIncrement(&trace_id_, 1) - 1;
+
+  TRACE_EVENT_FLOW_BEGIN0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
+      "SequencedWorkerPool::PostTask",
+      TRACE_ID_MANGLE(GetTaskTraceID(*sequenced, static_cast<void*>(this))));
+
+  PushToWorkQueue(*sequenced);
+
+  // Idle workers re-scan the queues under |lock_| after announcing themselves
+  // in |idle_thread_count_|, so taking the lock to signal cannot miss one.
+  // While every started worker is busy, see whether another thread helps.
+  int create_thread_id = 0;
+  if (subtle::Acquire_Load(&idle_thread_count_) > 0) {
+    AutoLock lock(lock_);
+    SignalHasWork();
+  } else if (subtle::Acquire_Load(&started_thread_count_) <
+             static_cast<subtle::Atomic32>(max_threads_)) {
+    AutoLock lock(lock_);
+    create_thread_id = PrepareToStartAdditionalThreadIfHelpful();
+  }
+  if (create_thread_id)
+    FinishStartingAdditionalThread(create_thread_id);
+
+  return true;
+}
+
+void SequencedWorkerPool::Inner::PushToWorkQueue(const SequencedTask& task) {
+  WorkQueue* queue;
+  if (task.sequence_token_id) {
+    queue = WorkQueueForSequence(task.sequence_token_id);
+  } else {
+    uint32 index = static_cast<uint32>(
+        subtle::NoBarrier_AtomicIncrement(&next_work_queue_, 1));
+    queue = work_queues_[index % work_queues_.size()];
+  }
+
+  subtle::Barrier_AtomicIncrement(&outstanding_task_count_, 1);
+  subtle::NoBarrier_AtomicIncrement(&queued_task_count_, 1);
+  AutoLock lock(queue->lock);
+  queue->tasks.push_back(task);
+}
+
+WorkQueue* SequencedWorkerPool::Inner::WorkQueueForSequence(
+    int sequence_token_id) const {
+  DCHECK_GT(sequence_token_id, 0);
+  return work_queues_[static_cast<size_t>(sequence_token_id) %
+                      work_queues_.size()];
+}
+
+bool SequencedWorkerPool::Inner::TakeTaskFromWorkQueues(
+    size_t home_queue,
+    SequencedTask* task,
+    std::vector<Closure>* deleted_tasks) {
+  const size_t queue_count = work_queues_.size();
+  for (size_t n = 0; n < queue_count; ++n) {
+    WorkQueue* queue = work_queues_[(home_queue + n) % queue_count];
+    AutoLock lock(queue->lock);
+    std::deque<SequencedTask>::iterator i = queue->tasks.begin();
+    while (i != queue->tasks.end()) {
+      // Like GetWork(), skip tasks whose sequence is already running. Since
+      // the whole sequence lives in this queue, the first task we find for a
+      // sequence is always the next one to run.
+      if (i->sequence_token_id &&
+          ContainsKey(queue->running_sequences, i->sequence_token_id)) {
+        ++i;
+        continue;
+      }
+
+      // Tasks that keep shutdown waiting while they run are counted before
+      // the shutdown flag is checked, for the same reason as when posting.
+      const bool blocks_shutdown =
+          i->shutdown_behavior != CONTINUE_ON_SHUTDOWN;
+      if (blocks_shutdown)
+        subtle::Barrier_AtomicIncrement(&blocking_shutdown_running_count_, 1);
+      if (i->shutdown_behavior != BLOCK_SHUTDOWN &&
+          subtle::Acquire_Load(&shutdown_flag_)) {
+        // See GetWork() for why these must be deleted outside the lock.
+        if (blocks_shutdown) {
+          subtle::Barrier_AtomicIncrement(&blocking_shutdown_running_count_,
+                                          -1);
+        }
+        deleted_tasks->push_back(i->task);
+        i = queue->tasks.erase(i);
+        subtle::NoBarrier_AtomicIncrement(&queued_task_count_, -1);
+        continue;
+      }
+
+      *task = *i;
+      queue->tasks.erase(i);
+      if (task->sequence_token_id)
+        queue->running_sequences.insert(task->sequence_token_id);
+      subtle::NoBarrier_AtomicIncrement(&queued_task_count_, -1);
+      if (task->shutdown_behavior == BLOCK_SHUTDOWN)
+        subtle::Barrier_AtomicIncrement(&blocking_shutdown_queued_count_, -1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void SequencedWorkerPool::Inner::DidDeleteWorkQueueTasks(
+    std::vector<Closure>* deleted_tasks) {
+  if (deleted_tasks->empty())
+    return;
+  int count = static_cast<int>(deleted_tasks->size());
+  deleted_tasks->clear();
+
+  // Tasks are only deleted during shutdown, so there is no need to avoid the
+  // lock here. Shutdown() may be waiting on a running count we undid.
+  {
+    AutoLock lock(lock_);
+    can_shutdown_cv_.Signal();
+  }
+  DidFinishOutstandingTasks(count);
+}
+
+void SequencedWorkerPool::Inner::DeleteWorkQueueTasksOnShutdown() {
+  DCHECK(subtle::Acquire_Load(&shutdown_flag_));
+  std::vector<Closure> deleted_tasks;
+  for (size_t n = 0; n < work_queues_.size(); ++n) {
+    WorkQueue* queue = work_queues_[n];
+    AutoLock lock(queue->lock);
+    std::deque<SequencedTask>::iterator i = queue->tasks.begin();
+    while (i != queue->tasks.end()) {
+      if (i->shutdown_behavior == BLOCK_SHUTDOWN ||
+          (i->sequence_token_id &&
+           ContainsKey(queue->running_sequences, i->sequence_token_id))) {
+        ++i;
+        continue;
+      }
+      deleted_tasks.push_back(i->task);
+      i = queue->tasks.erase(i);
+      subtle::NoBarrier_AtomicIncrement(&queued_task_count_, -1);
+    }
+  }
+
+  // Delayed tasks are always SKIP_ON_SHUTDOWN.
+  PendingTaskSet delayed_tasks;
+  {
+    AutoLock lock(lock_);
+    delayed_tasks.swap(pending_tasks_);
+    subtle::Release_Store(&delayed_task_count_, 0);
+  }
+  delayed_tasks.clear();
+
+  DidDeleteWorkQueueTasks(&deleted_tasks);
+}
+
+void SequencedWorkerPool::Inner::RunWorkQueueTask(Worker* this_worker,
+                                                  SequencedTask* task) {
+  TRACE_EVENT_FLOW_END0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
+      "SequencedWorkerPool::PostTask",
+      TRACE_ID_MANGLE(GetTaskTraceID(*task, static_cast<void*>(this))));
+  TRACE_EVENT2("toplevel", "SequencedWorkerPool::ThreadLoop",
+               "src_file", task->posted_from.file_name(),
+               "src_func", task->posted_from.function_name());
+
+  // As in WillRunWorkerTask(), check whether another thread would help before
+  // running the task, which may take arbitrarily long.
+  if (subtle::Acquire_Load(&started_thread_count_) <
+          static_cast<subtle::Atomic32>(max_threads_) &&
+      subtle::Acquire_Load(&queued_task_count_) > 0) {
+    int new_thread_id;
+    {
+      AutoLock lock(lock_);
+      new_thread_id = PrepareToStartAdditionalThreadIfHelpful();
+    }
+    if (new_thread_id)
+      FinishStartingAdditionalThread(new_thread_id);
+  }
+
+  this_worker->set_running_task_info(
+      SequenceToken(task->sequence_token_id), task->shutdown_behavior);
+
+  tracked_objects::TrackedTime start_time =
+      tracked_objects::ThreadData::NowForStartOfRun(task->birth_tally);
+
+  task->task.Run();
+
+  tracked_objects::ThreadData::TallyRunOnNamedThreadIfTracking(*task,
+      start_time, tracked_objects::ThreadData::NowForEndOfRun());
+
+  // Destroy the closure before the sequence is released, see ThreadLoop().
+  task->task = Closure();
+
+  this_worker->set_running_task_info(SequenceToken(), CONTINUE_ON_SHUTDOWN);
+
+  if (task->sequence_token_id) {
+    WorkQueue* queue = WorkQueueForSequence(task->sequence_token_id);
+    AutoLock lock(queue->lock);
+    queue->running_sequences.erase(task->sequence_token_id);
+  }
+  if (task->shutdown_behavior != CONTINUE_ON_SHUTDOWN)
+    DidFinishBlockingShutdownTasks(1);
+  DidFinishOutstandingTasks(1);
+}
+
+bool SequencedWorkerPool::Inner::LockedHasRunnableWorkQueueTask() const {
+  lock_.AssertAcquired();
+  for (size_t n = 0; n < work_queues_.size(); ++n) {
+    WorkQueue* queue = work_queues_[n];
+    AutoLock lock(queue->lock);
+    for (std::deque<SequencedTask>::const_iterator i = queue->tasks.begin();
+         i != queue->tasks.end(); ++i) {
+      if (!i->sequence_token_id ||
+          !ContainsKey(queue->running_sequences, i->sequence_token_id)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void SequencedWorkerPool::Inner::LockedScheduleDueDelayedTasks(
+    std::vector<Closure>* delete_these_outside_lock) {
+  lock_.AssertAcquired();
+  bool scheduled_task = false;
+  const TimeTicks current_time = TimeTicks::Now();
+  while (!pending_tasks_.empty()) {
+    PendingTaskSet::iterator first = pending_tasks_.begin();
+    if (shutdown_called_) {
+      // Delayed tasks are always SKIP_ON_SHUTDOWN.
+      delete_these_outside_lock->push_back(first->task);
+    } else if (first->time_to_run <= current_time) {
+      PushToWorkQueue(*first);
+      scheduled_task = true;
+    } else {
+      break;
+    }
+    pending_tasks_.erase(first);
+  }
+  subtle::Release_Store(&delayed_task_count_,
+                        static_cast<subtle::Atomic32>(pending_tasks_.size()));
+
+  // The calling worker takes one of the tasks; let an idle one take the rest.
+  if (scheduled_task)
+    SignalHasWork();
+}
+
+void SequencedWorkerPool::Inner::DidFinishBlockingShutdownTasks(int count) {
+  if (subtle::Barrier_AtomicIncrement(&blocking_shutdown_running_count_,
+                                      -count) == 0 &&
+      subtle::Acquire_Load(&shutdown_flag_)) {
+    AutoLock lock(lock_);
+    can_shutdown_cv_.Signal();
+  }
+}
+
+void SequencedWorkerPool::Inner::DidFinishOutstandingTasks(int count) {
+  if (subtle::Barrier_AtomicIncrement(&outstanding_task_count_, -count) == 0 &&
+      subtle::Acquire_Load(&flush_waiter_count_)) {
+    AutoLock lock(lock_);
+    cleanup_cv_.Broadcast();
+  }
+}
+
+void SequencedWorkerPool::Inner::WorkStealingThreadLoop(Worker* this_worker) {
+  {
+    AutoLock lock(lock_);
+    DCHECK(thread_being_created_);
+    thread_being_created_ = false;
+    std::pair<ThreadMap::iterator, bool> result =
+        threads_.insert(
+            std::make_pair(this_worker->tid(), make_linked_ptr(this_worker)));
+    DCHECK(result.second);
+    subtle::Release_Store(&started_thread_count_,
+                          static_cast<subtle::Atomic32>(threads_.size()));
+  }
+
+  const size_t home_queue =
+      static_cast<size_t>(this_worker->thread_number() - 1) %
+      work_queues_.size();
+
+  while (true) {
+#if defined(OS_MACOSX)
+    base::mac::ScopedNSAutoreleasePool autorelease_pool;
+#endif
+
+    std::vector<Closure> delete_these_outside_lock;
+    if (subtle::Acquire_Load(&delayed_task_count_) > 0) {
+      AutoLock lock(lock_);
+      LockedScheduleDueDelayedTasks(&delete_these_outside_lock);
+    }
+    delete_these_outside_lock.clear();
+
+    SequencedTask task;
+    bool found =
+        TakeTaskFromWorkQueues(home_queue, &task, &delete_these_outside_lock);
+    DidDeleteWorkQueueTasks(&delete_these_outside_lock);
+    if (found) {
+      RunWorkQueueTask(this_worker, &task);
+      continue;
+    }
+
+    AutoLock lock(lock_);
+    // See ThreadLoop() for why it is safe to exit once no BLOCK_SHUTDOWN
+    // tasks are left.
+    if (shutdown_called_ &&
+        subtle::Acquire_Load(&blocking_shutdown_queued_count_) == 0)
+      break;
+
+    // Announce ourselves before the final check; see PostTaskToWorkQueues().
+    subtle::Barrier_AtomicIncrement(&idle_thread_count_, 1);
+    if (!LockedHasRunnableWorkQueueTask()) {
+      if (pending_tasks_.empty() || shutdown_called_) {
+        has_work_cv_.Wait();
+      } else {
+        TimeDelta wait_time =
+            pending_tasks_.begin()->time_to_run - TimeTicks::Now();
+        if (wait_time > TimeDelta())
+          has_work_cv_.TimedWait(wait_time);
+      }
+    }
+    subtle::Barrier_AtomicIncrement(&idle_thread_count_, -1);
+  }  // Release lock_.
+
+  // Wake up the next worker so it exits as well, see ThreadLoop().
+  SignalHasWork();
+
+  // Possibly unblock shutdown.
+  can_shutdown_cv_.Signal();
+}
+
+void SequencedWorkerPool::Inner::WorkStealingCleanupForTesting() {
+  DCHECK(!RunsTasksOnCurrentThread());
+  base::ThreadRestrictions::ScopedAllowWait allow_wait;
+  AutoLock lock(lock_);
+  if (shutdown_called_)
+    return;
+
+  // Delayed tasks are deleted rather than run, as in GLOBAL_QUEUE mode.
+  PendingTaskSet delayed_tasks;
+  delayed_tasks.swap(pending_tasks_);
+  subtle::Release_Store(&delayed_task_count_, 0);
+  {
+    AutoUnlock unlock(lock_);
+    delayed_tasks.clear();
+  }
+
+  subtle::Barrier_AtomicIncrement(&flush_waiter_count_, 1);
+  while (subtle::Acquire_Load(&outstanding_task_count_) != 0)
+    cleanup_cv_.Wait();
+  subtle::Barrier_AtomicIncrement(&flush_waiter_count_, -1);
 }
 
 base::StaticAtomicSequenceNumber
@@ -1140,15 +1697,27 @@ SequencedWorkerPool::SequencedWorkerPool(
     size_t max_threads,
     const std::string& thread_name_prefix)
     : constructor_message_loop_(MessageLoopProxy::current()),
-      inner_(new Inner(this, max_threads, thread_name_prefix, NULL)) {
+      inner_(new Inner(this, max_threads, thread_name_prefix, GLOBAL_QUEUE,
+                       NULL)) {
+}
+
+SequencedWorkerPool::SequencedWorkerPool(
+    size_t max_threads,
+    const std::string& thread_name_prefix,
+    TestingObserver* observer)
+    : constructor_message_loop_(MessageLoopProxy::current()),
+      inner_(new Inner(this, max_threads, thread_name_prefix, GLOBAL_QUEUE,
+                       observer)) {
 }
 
 SequencedWorkerPool::SequencedWorkerPool(
     size_t max_threads,
     const std::string& thread_name_prefix,
+    SchedulingMode scheduling_mode,
     TestingObserver* observer)
     : constructor_message_loop_(MessageLoopProxy::current()),
-      inner_(new Inner(this, max_threads, thread_name_prefix, observer)) {
+      inner_(new Inner(this, max_threads, thread_name_prefix, scheduling_mode,
+                       observer)) {
 }
 
 SequencedWorkerPool::~SequencedWorkerPool() {}
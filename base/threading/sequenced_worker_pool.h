@@ -118,6 +118,27 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
     BLOCK_SHUTDOWN,
   };
 
+  // Defines how posted tasks are queued and handed out to worker threads.
+  enum SchedulingMode {
+    // All tasks are kept in a single time-ordered queue guarded by one lock.
+    // This is the default.
+    GLOBAL_QUEUE,
+
+    // Each potential worker thread owns a deque guarded by its own lock.
+    // Tasks with a sequence token always go to the deque selected by that
+    // token, so the sequencing guarantees above still hold; unsequenced tasks
+    // are spread round-robin over all deques. A worker runs the oldest
+    // runnable task of its own deque and steals from the other deques when
+    // its own has nothing to run. The pool-wide lock is only taken to create
+    // threads, to wake idle workers, for delayed and named-token tasks and
+    // during shutdown, which keeps it off the common post/run path.
+    //
+    // Delayed tasks are moved to their deque once they become due, after any
+    // task already queued there. Shutdown behaviors are honored exactly as in
+    // GLOBAL_QUEUE mode.
+    WORK_STEALING,
+  };
+
   // Opaque identifier that defines sequencing of tasks posted to the worker
   // pool.
   class SequenceToken {
@@ -171,6 +192,13 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
                       const std::string& thread_name_prefix,
                       TestingObserver* observer);
 
+  // Like above, but also selects the |scheduling_mode|. |observer| may be
+  // NULL and is not owned.
+  SequencedWorkerPool(size_t max_threads,
+                      const std::string& thread_name_prefix,
+                      SchedulingMode scheduling_mode,
+                      TestingObserver* observer);
+
   // Returns a unique token that can be used to sequence tasks posted to
   // PostSequencedWorkerTask(). Valid tokens are always nonzero.
   SequenceToken GetSequenceToken();
@@ -0,0 +1,96 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the task throughput of the SequencedWorkerPool scheduling modes
+// when many tasks are posted from several worker threads at once, so that
+// contention on the pool's queues dominates.
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/format_macros.h"
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/sequenced_worker_pool_owner.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace {
+
+const size_t kNumPosters = 16;
+const size_t kNumTasksPerPoster = 20000;
+const size_t kNumSequences = 8;
+
+void CountTask(subtle::Atomic32* counter) {
+  subtle::NoBarrier_AtomicIncrement(counter, 1);
+}
+
+// Posts |num_tasks| tasks that bump |counter|, alternating between
+// unsequenced tasks and the sequences in |tokens|.
+void PostCountTasks(
+    SequencedWorkerPool* pool,
+    const std::vector<SequencedWorkerPool::SequenceToken>& tokens,
+    size_t num_tasks,
+    subtle::Atomic32* counter) {
+  for (size_t i = 0; i < num_tasks; ++i) {
+    Closure task = Bind(&CountTask, counter);
+    if (i % 2)
+      pool->PostSequencedWorkerTask(tokens[i % tokens.size()], FROM_HERE, task);
+    else
+      pool->PostWorkerTask(FROM_HERE, task);
+  }
+}
+
+void RunThroughputTest(SequencedWorkerPool::SchedulingMode mode,
+                       const char* trace) {
+  const size_t kThreadCounts[] = { 4, 16, 32 };
+
+  MessageLoop message_loop;
+  for (size_t t = 0; t < arraysize(kThreadCounts); ++t) {
+    SequencedWorkerPoolOwner pool_owner(kThreadCounts[t], "perf", mode);
+    SequencedWorkerPool* pool = pool_owner.pool().get();
+    std::vector<SequencedWorkerPool::SequenceToken> tokens;
+    for (size_t i = 0; i < kNumSequences; ++i)
+      tokens.push_back(pool->GetSequenceToken());
+
+    subtle::Atomic32 counter = 0;
+    const TimeTicks start = TimeTicks::HighResNow();
+    for (size_t i = 0; i < kNumPosters; ++i) {
+      pool->PostWorkerTask(
+          FROM_HERE,
+          Bind(&PostCountTasks, Unretained(pool), tokens, kNumTasksPerPoster,
+               &counter));
+    }
+    pool->FlushForTesting();
+    const TimeDelta elapsed = TimeTicks::HighResNow() - start;
+    pool->Shutdown();
+
+    EXPECT_EQ(static_cast<subtle::Atomic32>(kNumPosters * kNumTasksPerPoster),
+              subtle::NoBarrier_Load(&counter));
+    perf_test::PrintResult(
+        "task_throughput",
+        StringPrintf("_%" PRIuS "_threads", kThreadCounts[t]),
+        trace,
+        kNumPosters * kNumTasksPerPoster / elapsed.InSecondsF(),
+        "tasks/s",
+        true);
+  }
+}
+
+TEST(SequencedWorkerPoolPerfTest, GlobalQueueTaskThroughput) {
+  RunThroughputTest(SequencedWorkerPool::GLOBAL_QUEUE, "global_queue");
+}
+
+TEST(SequencedWorkerPoolPerfTest, WorkStealingTaskThroughput) {
+  RunThroughputTest(SequencedWorkerPool::WORK_STEALING, "work_stealing");
+}
+
+}  // namespace
+}  // namespace base
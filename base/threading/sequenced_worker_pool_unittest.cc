@@ -176,7 +176,8 @@ class TestTracker : public base::RefCountedThreadSafe<TestTracker> {
   size_t started_events_;
 };
 
-class SequencedWorkerPoolTest : public testing::Test {
+class SequencedWorkerPoolTest
+    : public testing::TestWithParam<SequencedWorkerPool::SchedulingMode> {
  public:
   SequencedWorkerPoolTest()
       : tracker_(new TestTracker) {
@@ -199,7 +200,8 @@ class SequencedWorkerPoolTest : public testing::Test {
   // Destroys the SequencedWorkerPool instance, blocking until it is fully shut
   // down, and creates a new instance.
   void ResetPool() {
-    pool_owner_.reset(new SequencedWorkerPoolOwner(kNumWorkerThreads, "test"));
+    pool_owner_.reset(
+        new SequencedWorkerPoolOwner(kNumWorkerThreads, "test", GetParam()));
   }
 
   void SetWillWaitForShutdownCallback(const Closure& callback) {
@@ -285,7 +287,7 @@ void HoldPoolReference(const scoped_refptr<base::SequencedWorkerPool>& pool,
 }
 
 // Tests that delayed tasks are deleted upon shutdown of the pool.
-TEST_F(SequencedWorkerPoolTest, DelayedTaskDuringShutdown) {
+TEST_P(SequencedWorkerPoolTest, DelayedTaskDuringShutdown) {
   // Post something to verify the pool is started up.
   EXPECT_TRUE(pool()->PostTask(
       FROM_HERE, base::Bind(&TestTracker::FastTask, tracker(), 1)));
@@ -320,7 +322,7 @@ TEST_F(SequencedWorkerPoolTest, DelayedTaskDuringShutdown) {
 }
 
 // Tests that same-named tokens have the same ID.
-TEST_F(SequencedWorkerPoolTest, NamedTokens) {
+TEST_P(SequencedWorkerPoolTest, NamedTokens) {
   const std::string name1("hello");
   SequencedWorkerPool::SequenceToken token1 =
       pool()->GetNamedSequenceToken(name1);
@@ -348,7 +350,7 @@ TEST_F(SequencedWorkerPoolTest, NamedTokens) {
 
 // Tests that posting a bunch of tasks (many more than the number of worker
 // threads) runs them all.
-TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
+TEST_P(SequencedWorkerPoolTest, LotsOfTasks) {
   pool()->PostWorkerTask(FROM_HERE,
                          base::Bind(&TestTracker::SlowTask, tracker(), 0));
 
@@ -366,9 +368,9 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
 // worker threads) to two pools simultaneously runs them all twice.
 // This test is meant to shake out any concurrency issues between
 // pools (like histograms).
-TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
-  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1");
-  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2");
+TEST_P(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
+  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1", GetParam());
+  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2", GetParam());
 
   base::Closure slow_task = base::Bind(&TestTracker::SlowTask, tracker(), 0);
   pool1.pool()->PostWorkerTask(FROM_HERE, slow_task);
@@ -392,7 +394,7 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
 
 // Test that tasks with the same sequence token are executed in order but don't
 // affect other tasks.
-TEST_F(SequencedWorkerPoolTest, Sequence) {
+TEST_P(SequencedWorkerPoolTest, Sequence) {
   // Fill all the worker threads except one.
   const size_t kNumBackgroundTasks = kNumWorkerThreads - 1;
   ThreadBlocker background_blocker;
@@ -453,7 +455,7 @@ TEST_F(SequencedWorkerPoolTest, Sequence) {
 
 // Tests that any tasks posted after Shutdown are ignored.
 // Disabled for flakiness.  See http://crbug.com/166451.
-TEST_F(SequencedWorkerPoolTest, DISABLED_IgnoresAfterShutdown) {
+TEST_P(SequencedWorkerPoolTest, DISABLED_IgnoresAfterShutdown) {
   // Start tasks to take all the threads and block them.
   EnsureAllWorkersCreated();
   ThreadBlocker blocker;
@@ -502,7 +504,7 @@ TEST_F(SequencedWorkerPoolTest, DISABLED_IgnoresAfterShutdown) {
   ASSERT_EQ(old_has_work_call_count, has_work_call_count());
 }
 
-TEST_F(SequencedWorkerPoolTest, AllowsAfterShutdown) {
+TEST_P(SequencedWorkerPoolTest, AllowsAfterShutdown) {
   // Test that <n> new blocking tasks are allowed provided they're posted
   // by a running tasks.
   EnsureAllWorkersCreated();
@@ -549,7 +551,7 @@ TEST_F(SequencedWorkerPoolTest, AllowsAfterShutdown) {
 
 // Tests that unrun tasks are discarded properly according to their shutdown
 // mode.
-TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, DiscardOnShutdown) {
   // Start tasks to take all the threads and block them.
   EnsureAllWorkersCreated();
   ThreadBlocker blocker;
@@ -595,7 +597,7 @@ TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
 }
 
 // Tests that CONTINUE_ON_SHUTDOWN tasks don't block shutdown.
-TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, ContinueOnShutdown) {
   scoped_refptr<TaskRunner> runner(pool()->GetTaskRunnerWithShutdownBehavior(
       SequencedWorkerPool::CONTINUE_ON_SHUTDOWN));
   scoped_refptr<SequencedTaskRunner> sequenced_runner(
@@ -641,9 +643,43 @@ TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
   EXPECT_EQ(3u, result.size());
 }
 
+// Tests that in WORK_STEALING mode, non-blocking tasks that can no longer run
+// are deleted when Shutdown() is called, even while every worker is busy.
+// GLOBAL_QUEUE mode deletes them as workers become free instead.
+TEST_P(SequencedWorkerPoolTest, DeletesQueuedTasksOnShutdown) {
+  if (GetParam() != SequencedWorkerPool::WORK_STEALING)
+    return;
+
+  EnsureAllWorkersCreated();
+  ThreadBlocker blocker;
+  for (size_t i = 0; i < kNumWorkerThreads; i++) {
+    pool()->PostWorkerTaskWithShutdownBehavior(
+        FROM_HERE,
+        base::Bind(&TestTracker::BlockTask, tracker(), i, &blocker),
+        SequencedWorkerPool::CONTINUE_ON_SHUTDOWN);
+  }
+  tracker()->WaitUntilTasksBlocked(kNumWorkerThreads);
+
+  scoped_refptr<base::RefCountedData<bool> > deleted_flag(
+      new base::RefCountedData<bool>(false));
+  pool()->PostWorkerTaskWithShutdownBehavior(
+      FROM_HERE,
+      base::Bind(&HoldPoolReference,
+                 pool(),
+                 make_scoped_refptr(new DeletionHelper(deleted_flag))),
+      SequencedWorkerPool::SKIP_ON_SHUTDOWN);
+
+  pool()->Shutdown();
+  EXPECT_TRUE(deleted_flag->data);
+
+  blocker.Unblock(kNumWorkerThreads);
+  EXPECT_EQ(kNumWorkerThreads,
+            tracker()->WaitUntilTasksComplete(kNumWorkerThreads).size());
+}
+
 // Tests that SKIP_ON_SHUTDOWN tasks that have been started block Shutdown
 // until they stop, but tasks not yet started do not.
-TEST_F(SequencedWorkerPoolTest, SkipOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, SkipOnShutdown) {
   // Start tasks to take all the threads and block them.
   EnsureAllWorkersCreated();
   ThreadBlocker blocker;
@@ -696,7 +732,7 @@ TEST_F(SequencedWorkerPoolTest, SkipOnShutdown) {
 // Ensure all worker threads are created, and then trigger a spurious
 // work signal. This shouldn't cause any other work signals to be
 // triggered. This is a regression test for http://crbug.com/117469.
-TEST_F(SequencedWorkerPoolTest, SpuriousWorkSignal) {
+TEST_P(SequencedWorkerPoolTest, SpuriousWorkSignal) {
   EnsureAllWorkersCreated();
   int old_has_work_call_count = has_work_call_count();
   pool()->SignalHasWorkForTesting();
@@ -721,7 +757,7 @@ void IsRunningOnCurrentThreadTask(
 }
 
 // Verify correctness of the IsRunningSequenceOnCurrentThread method.
-TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
+TEST_P(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   SequencedWorkerPool::SequenceToken token1 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken token2 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken unsequenced_token;
@@ -756,7 +792,7 @@ TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
 }
 
 // Verify that FlushForTesting works as intended.
-TEST_F(SequencedWorkerPoolTest, FlushForTesting) {
+TEST_P(SequencedWorkerPoolTest, FlushForTesting) {
   // Should be fine to call on a new instance.
   pool()->FlushForTesting();
 
@@ -796,6 +832,11 @@ TEST_F(SequencedWorkerPoolTest, FlushForTesting) {
   pool()->FlushForTesting();
 }
 
+INSTANTIATE_TEST_CASE_P(
+    SchedulingModes, SequencedWorkerPoolTest,
+    testing::Values(SequencedWorkerPool::GLOBAL_QUEUE,
+                    SequencedWorkerPool::WORK_STEALING));
+
 TEST(SequencedWorkerPoolRefPtrTest, ShutsDownCleanWithContinueOnShutdown) {
   MessageLoop loop;
   scoped_refptr<SequencedWorkerPool> pool(new SequencedWorkerPool(3, "Pool"));
@@ -878,6 +919,7 @@ INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPoolTaskRunner, TaskRunnerTest,
     SequencedWorkerPoolTaskRunnerWithShutdownBehaviorTestDelegate);
 
+template <SequencedWorkerPool::SchedulingMode kSchedulingMode>
 class SequencedWorkerPoolSequencedTaskRunnerTestDelegate {
  public:
   SequencedWorkerPoolSequencedTaskRunnerTestDelegate() {}
@@ -887,7 +929,7 @@ class SequencedWorkerPoolSequencedTaskRunnerTestDelegate {
 
   void StartTaskRunner() {
     pool_owner_.reset(new SequencedWorkerPoolOwner(
-        10, "SequencedWorkerPoolSequencedTaskRunnerTest"));
+        10, "SequencedWorkerPoolSequencedTaskRunnerTest", kSchedulingMode));
     task_runner_ = pool_owner_->pool()->GetSequencedTaskRunner(
         pool_owner_->pool()->GetSequenceToken());
   }
@@ -911,13 +953,28 @@ class SequencedWorkerPoolSequencedTaskRunnerTestDelegate {
   scoped_refptr<SequencedTaskRunner> task_runner_;
 };
 
+typedef SequencedWorkerPoolSequencedTaskRunnerTestDelegate<
+    SequencedWorkerPool::GLOBAL_QUEUE>
+    SequencedWorkerPoolGlobalQueueSequencedTaskRunnerTestDelegate;
+typedef SequencedWorkerPoolSequencedTaskRunnerTestDelegate<
+    SequencedWorkerPool::WORK_STEALING>
+    SequencedWorkerPoolWorkStealingSequencedTaskRunnerTestDelegate;
+
 INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPoolSequencedTaskRunner, TaskRunnerTest,
-    SequencedWorkerPoolSequencedTaskRunnerTestDelegate);
+    SequencedWorkerPoolGlobalQueueSequencedTaskRunnerTestDelegate);
 
 INSTANTIATE_TYPED_TEST_CASE_P(
     SequencedWorkerPoolSequencedTaskRunner, SequencedTaskRunnerTest,
-    SequencedWorkerPoolSequencedTaskRunnerTestDelegate);
+    SequencedWorkerPoolGlobalQueueSequencedTaskRunnerTestDelegate);
+
+INSTANTIATE_TYPED_TEST_CASE_P(
+    SequencedWorkerPoolWorkStealingSequencedTaskRunner, TaskRunnerTest,
+    SequencedWorkerPoolWorkStealingSequencedTaskRunnerTestDelegate);
+
+INSTANTIATE_TYPED_TEST_CASE_P(
+    SequencedWorkerPoolWorkStealingSequencedTaskRunner, SequencedTaskRunnerTest,
+    SequencedWorkerPoolWorkStealingSequencedTaskRunnerTestDelegate);
 
 }  // namespace
 
@@ -79,6 +79,10 @@ namespace android {
 class JavaHandlerThread;
 }
 
+namespace internal {
+class IncomingTaskQueue;
+}
+
 class SequencedWorkerPool;
 class SimpleThread;
 class Thread;
@@ -188,6 +192,7 @@ class BASE_EXPORT ThreadRestrictions {
   friend class cc::CompletionEvent;
   friend class remoting::AutoThread;
   friend class MessagePumpDefault;
+  friend class internal::IncomingTaskQueue;
   friend class SequencedWorkerPool;
   friend class SimpleThread;
   friend class Thread;
@@ -7,8 +7,11 @@
 #include <limits.h>
 #include <stdlib.h>
 
+#include <algorithm>
+
 #include "base/atomicops.h"
 #include "base/base_switches.h"
+#include "base/bits.h"
 #include "base/command_line.h"
 #include "base/compiler_specific.h"
 #include "base/debug/leak_annotations.h"
@@ -80,11 +83,49 @@ inline bool IsProfilerTimingEnabled() {
   return current_timing_enabled == ENABLED_TIMING;
 }
 
+// Returns the minimum duration of the histogram bucket in which the
+// |percentile|th percentile of the durations counted in |buckets| falls.
+int32 BucketsToPercentile(const std::vector<int32>& buckets, int percentile) {
+  DCHECK_GE(percentile, 0);
+  DCHECK_LE(percentile, 100);
+  int64 total = 0;
+  for (size_t i = 0; i < buckets.size(); ++i)
+    total += buckets[i];
+  if (!total)
+    return 0;
+
+  // The rank, counting from 1, of the sample at the requested percentile.
+  int64 rank = std::max<int64>(1, (total * percentile + 99) / 100);
+  int64 seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank)
+      return DeathData::BucketToMinDuration(static_cast<int>(i));
+  }
+  NOTREACHED();
+  return 0;
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
 // DeathData tallies durations when a death takes place.
 
+// static
+int DeathData::DurationToBucket(int32 duration) {
+  if (duration <= 0)
+    return 0;
+  int bucket = 1 + base::bits::Log2Floor(static_cast<uint32>(duration));
+  return std::min(bucket, kDurationBucketCount - 1);
+}
+
+// static
+int32 DeathData::BucketToMinDuration(int bucket) {
+  DCHECK_GE(bucket, 0);
+  DCHECK_LT(bucket, kDurationBucketCount);
+  return bucket ? 1 << (bucket - 1) : 0;
+}
+
 DeathData::DeathData() {
   Clear();
 }
@@ -118,6 +159,9 @@ void DeathData::RecordDeath(const int32 queue_duration,
   if (run_duration_max_ < run_duration)
     run_duration_max_ = run_duration;
 
+  ++queue_duration_buckets_[DurationToBucket(queue_duration)];
+  ++run_duration_buckets_[DurationToBucket(run_duration)];
+
   // Take a uniformly distributed sample over all durations ever supplied.
   // The probability that we (instead) use this new sample is 1/count_.  This
   // results in a completely uniform selection of the sample (at least when we
@@ -153,6 +197,18 @@ int32 DeathData::queue_duration_sample() const {
   return queue_duration_sample_;
 }
 
+int32 DeathData::run_duration_bucket(int bucket) const {
+  DCHECK_GE(bucket, 0);
+  DCHECK_LT(bucket, kDurationBucketCount);
+  return run_duration_buckets_[bucket];
+}
+
+int32 DeathData::queue_duration_bucket(int bucket) const {
+  DCHECK_GE(bucket, 0);
+  DCHECK_LT(bucket, kDurationBucketCount);
+  return queue_duration_buckets_[bucket];
+}
+
 void DeathData::ResetMax() {
   run_duration_max_ = 0;
   queue_duration_max_ = 0;
@@ -166,6 +222,10 @@ void DeathData::Clear() {
   queue_duration_sum_ = 0;
   queue_duration_max_ = 0;
   queue_duration_sample_ = 0;
+  std::fill(run_duration_buckets_,
+            run_duration_buckets_ + kDurationBucketCount, 0);
+  std::fill(queue_duration_buckets_,
+            queue_duration_buckets_ + kDurationBucketCount, 0);
 }
 
 //------------------------------------------------------------------------------
@@ -187,12 +247,26 @@ DeathDataSnapshot::DeathDataSnapshot(
       run_duration_sample(death_data.run_duration_sample()),
       queue_duration_sum(death_data.queue_duration_sum()),
       queue_duration_max(death_data.queue_duration_max()),
-      queue_duration_sample(death_data.queue_duration_sample()) {
+      queue_duration_sample(death_data.queue_duration_sample()),
+      run_duration_buckets(DeathData::kDurationBucketCount),
+      queue_duration_buckets(DeathData::kDurationBucketCount) {
+  for (int i = 0; i < DeathData::kDurationBucketCount; ++i) {
+    run_duration_buckets[i] = death_data.run_duration_bucket(i);
+    queue_duration_buckets[i] = death_data.queue_duration_bucket(i);
+  }
 }
 
 DeathDataSnapshot::~DeathDataSnapshot() {
 }
 
+int32 DeathDataSnapshot::RunDurationPercentile(int percentile) const {
+  return BucketsToPercentile(run_duration_buckets, percentile);
+}
+
+int32 DeathDataSnapshot::QueueDurationPercentile(int percentile) const {
+  return BucketsToPercentile(queue_duration_buckets, percentile);
+}
+
 //------------------------------------------------------------------------------
 BirthOnThread::BirthOnThread(const Location& location,
                              const ThreadData& current)
@@ -261,6 +261,17 @@ class BASE_EXPORT Births: public BirthOnThread {
 
 class BASE_EXPORT DeathData {
  public:
+  // Number of buckets in the queueing delay and run duration histograms.
+  // Bucket 0 counts durations of 0ms, bucket i > 0 counts durations in
+  // [2^(i-1), 2^i) ms, and the last bucket also counts everything longer.
+  static const int kDurationBucketCount = 16;
+
+  // Returns the histogram bucket that a |duration| in ms is counted in.
+  static int DurationToBucket(int32 duration);
+
+  // Returns the smallest duration, in ms, that is counted in |bucket|.
+  static int32 BucketToMinDuration(int bucket);
+
   // Default initializer.
   DeathData();
 
@@ -283,6 +294,8 @@ class BASE_EXPORT DeathData {
   int32 queue_duration_sum() const;
   int32 queue_duration_max() const;
   int32 queue_duration_sample() const;
+  int32 run_duration_bucket(int bucket) const;
+  int32 queue_duration_bucket(int bucket) const;
 
   // Reset the max values to zero.
   void ResetMax();
@@ -306,6 +319,10 @@ class BASE_EXPORT DeathData {
   // and rarely updated.
   int32 run_duration_sample_;
   int32 queue_duration_sample_;
+  // Histograms of all durations seen, used to find tail latencies that
+  // averages and maxima hide. See kDurationBucketCount for the layout.
+  int32 run_duration_buckets_[kDurationBucketCount];
+  int32 queue_duration_buckets_[kDurationBucketCount];
 };
 
 //------------------------------------------------------------------------------
@@ -316,6 +333,12 @@ struct BASE_EXPORT DeathDataSnapshot {
   explicit DeathDataSnapshot(const DeathData& death_data);
   ~DeathDataSnapshot();
 
+  // Return a lower bound, in ms, of the |percentile|th percentile of the run
+  // duration or queueing delay, computed from the histogram buckets.
+  // |percentile| is in [0, 100]. Returns 0 when no deaths were recorded.
+  int32 RunDurationPercentile(int percentile) const;
+  int32 QueueDurationPercentile(int percentile) const;
+
   int count;
   int32 run_duration_sum;
   int32 run_duration_max;
@@ -323,6 +346,9 @@ struct BASE_EXPORT DeathDataSnapshot {
   int32 queue_duration_sum;
   int32 queue_duration_max;
   int32 queue_duration_sample;
+  // DeathData::kDurationBucketCount entries each, or empty.
+  std::vector<int32> run_duration_buckets;
+  std::vector<int32> queue_duration_buckets;
 };
 
 //------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #include "base/tracked_objects.h"
 
+#include <limits.h>
 #include <stddef.h>
 
 #include "base/memory/scoped_ptr.h"
@@ -267,6 +268,55 @@ TEST_F(TrackedObjectsTest, DeathDataTest) {
   EXPECT_EQ(2 * queue_ms, snapshot.queue_duration_sum);
   EXPECT_EQ(queue_ms, snapshot.queue_duration_max);
   EXPECT_EQ(queue_ms, snapshot.queue_duration_sample);
+
+  ASSERT_EQ(static_cast<size_t>(DeathData::kDurationBucketCount),
+            snapshot.run_duration_buckets.size());
+  ASSERT_EQ(static_cast<size_t>(DeathData::kDurationBucketCount),
+            snapshot.queue_duration_buckets.size());
+  for (int i = 0; i < DeathData::kDurationBucketCount; ++i) {
+    EXPECT_EQ(i == DeathData::DurationToBucket(run_ms) ? 2 : 0,
+              snapshot.run_duration_buckets[i]);
+    EXPECT_EQ(i == DeathData::DurationToBucket(queue_ms) ? 2 : 0,
+              snapshot.queue_duration_buckets[i]);
+  }
+}
+
+TEST_F(TrackedObjectsTest, DeathDataBuckets) {
+  EXPECT_EQ(0, DeathData::DurationToBucket(-1));
+  EXPECT_EQ(0, DeathData::DurationToBucket(0));
+  EXPECT_EQ(1, DeathData::DurationToBucket(1));
+  EXPECT_EQ(2, DeathData::DurationToBucket(2));
+  EXPECT_EQ(2, DeathData::DurationToBucket(3));
+  EXPECT_EQ(3, DeathData::DurationToBucket(4));
+  EXPECT_EQ(DeathData::kDurationBucketCount - 1,
+            DeathData::DurationToBucket(INT_MAX));
+
+  for (int i = 0; i < DeathData::kDurationBucketCount; ++i) {
+    EXPECT_EQ(i, DeathData::DurationToBucket(
+        DeathData::BucketToMinDuration(i)));
+  }
+}
+
+TEST_F(TrackedObjectsTest, DeathDataPercentiles) {
+  DeathData data;
+  EXPECT_EQ(0, DeathDataSnapshot(data).QueueDurationPercentile(50));
+
+  // 90 fast tasks and 10 slow ones; the slow tail must show up at the 95th
+  // percentile even though the average barely moves.
+  const int kUnrandomInt = 0;
+  for (int i = 0; i < 90; ++i)
+    data.RecordDeath(1, 0, kUnrandomInt);
+  for (int i = 0; i < 10; ++i)
+    data.RecordDeath(300, 40, kUnrandomInt);
+
+  DeathDataSnapshot snapshot(data);
+  EXPECT_EQ(1, snapshot.QueueDurationPercentile(0));
+  EXPECT_EQ(1, snapshot.QueueDurationPercentile(50));
+  EXPECT_EQ(1, snapshot.QueueDurationPercentile(90));
+  EXPECT_EQ(256, snapshot.QueueDurationPercentile(95));
+  EXPECT_EQ(256, snapshot.QueueDurationPercentile(100));
+  EXPECT_EQ(0, snapshot.RunDurationPercentile(90));
+  EXPECT_EQ(32, snapshot.RunDurationPercentile(99));
 }
 
 TEST_F(TrackedObjectsTest, DeactivatedBirthOnlyToSnapshotWorkerThread) {
@@ -444,6 +444,13 @@ void DictionaryValue::SetString(const std::string& path,
 
 void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
                                               Value* in_value) {
+  // Keys added in increasing order, as when reading JSON written by
+  // JSONWriter, go at the end without searching the tree.
+  if (!dictionary_.empty() && dictionary_.rbegin()->first < key) {
+    dictionary_.insert(dictionary_.end(), std::make_pair(key, in_value));
+    return;
+  }
+
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
   std::pair<ValueMap::iterator, bool> ins_res =
@@ -825,10 +832,14 @@ DictionaryValue::Iterator::~Iterator() {}
 DictionaryValue* DictionaryValue::DeepCopy() const {
   DictionaryValue* result = new DictionaryValue;
 
+  // The entries come out in key order, so each one goes at the end of the
+  // copy without searching the tree.
   for (ValueMap::const_iterator current_entry(dictionary_.begin());
        current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
+    result->dictionary_.insert(
+        result->dictionary_.end(),
+        std::make_pair(current_entry->first,
+                       current_entry->second->DeepCopy()));
   }
 
   return result;
@@ -1120,6 +1131,7 @@ bool ListValue::GetAsList(const ListValue** out_value) const {
 ListValue* ListValue::DeepCopy() const {
   ListValue* result = new ListValue;
 
+  result->list_.reserve(list_.size());
   for (ValueVector::const_iterator i(list_.begin()); i != list_.end(); ++i)
     result->Append((*i)->DeepCopy());
 
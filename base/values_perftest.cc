@@ -0,0 +1,93 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures building, searching and copying a DictionaryValue the size of a
+// large preferences or policy tree.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+namespace {
+
+const int kLookupRounds = 10;
+
+std::vector<std::string> MakeKeys(int num_keys) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < num_keys; ++i)
+    keys.push_back(StringPrintf("profile.content_settings.%d", i * 7919));
+  return keys;
+}
+
+void RunDictionaryBench(int num_keys) {
+  std::vector<std::string> keys = MakeKeys(num_keys);
+  std::string trace = StringPrintf("%d_keys", num_keys);
+
+  // Keys in key order, the way JSONWriter writes them.
+  std::vector<std::string> sorted_keys(keys);
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+  TimeTicks begin = TimeTicks::HighResNow();
+  {
+    DictionaryValue dict;
+    for (int i = 0; i < num_keys; ++i)
+      dict.SetIntegerWithoutPathExpansion(sorted_keys[i], i);
+  }
+  perf_test::PrintResult(
+      "dictionary_value_insert_sorted", "", trace,
+      (TimeTicks::HighResNow() - begin).InMicroseconds() * 1000.0 / num_keys,
+      "ns/insert", true);
+
+  DictionaryValue dict;
+  begin = TimeTicks::HighResNow();
+  for (int i = 0; i < num_keys; ++i)
+    dict.SetIntegerWithoutPathExpansion(keys[i], i);
+  perf_test::PrintResult(
+      "dictionary_value_insert_unsorted", "", trace,
+      (TimeTicks::HighResNow() - begin).InMicroseconds() * 1000.0 / num_keys,
+      "ns/insert", true);
+
+  int sum = 0;
+  begin = TimeTicks::HighResNow();
+  for (int round = 0; round < kLookupRounds; ++round) {
+    for (int i = 0; i < num_keys; ++i) {
+      int value = 0;
+      dict.GetIntegerWithoutPathExpansion(keys[i], &value);
+      sum += value;
+    }
+  }
+  perf_test::PrintResult(
+      "dictionary_value_lookup", "", trace,
+      (TimeTicks::HighResNow() - begin).InMicroseconds() * 1000.0 /
+          (num_keys * kLookupRounds),
+      "ns/lookup", true);
+  EXPECT_EQ(kLookupRounds * (num_keys * (num_keys - 1) / 2), sum);
+
+  begin = TimeTicks::HighResNow();
+  scoped_ptr<DictionaryValue> copy(dict.DeepCopy());
+  perf_test::PrintResult(
+      "dictionary_value_deep_copy", "", trace,
+      (TimeTicks::HighResNow() - begin).InMicroseconds() * 1000.0 / num_keys,
+      "ns/entry", true);
+  EXPECT_EQ(dict.size(), copy->size());
+}
+
+TEST(ValuesPerfTest, SmallDictionary) {
+  RunDictionaryBench(100);
+}
+
+TEST(ValuesPerfTest, LargeDictionary) {
+  RunDictionaryBench(20000);
+}
+
+}  // namespace
+}  // namespace base
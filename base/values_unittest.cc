@@ -6,6 +6,7 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string16.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -809,4 +810,71 @@ TEST(ValuesTest, DictionaryIterator) {
   EXPECT_TRUE(seen2);
 }
 
+// Keys are kept sorted no matter the order they are added in.
+TEST(ValuesTest, DictionaryKeyOrder) {
+  DictionaryValue dict;
+  const char* keys[] = { "m", "c", "x", "a", "q", "c", "b" };
+  for (size_t i = 0; i < arraysize(keys); ++i)
+    dict.SetIntegerWithoutPathExpansion(keys[i], static_cast<int>(i));
+  EXPECT_EQ(6U, dict.size());
+
+  // The second "c" replaced the first one.
+  int value = 0;
+  EXPECT_TRUE(dict.GetInteger("c", &value));
+  EXPECT_EQ(5, value);
+
+  EXPECT_TRUE(dict.RemoveWithoutPathExpansion("m", NULL));
+  EXPECT_FALSE(dict.RemoveWithoutPathExpansion("m", NULL));
+  EXPECT_FALSE(dict.HasKey("m"));
+  EXPECT_FALSE(dict.HasKey("z"));
+
+  std::string order;
+  for (DictionaryValue::Iterator it(dict); !it.IsAtEnd(); it.Advance())
+    order += it.key();
+  EXPECT_EQ("abcqx", order);
+
+  scoped_ptr<DictionaryValue> copy(dict.DeepCopy());
+  EXPECT_TRUE(copy->Equals(&dict));
+  EXPECT_TRUE(copy->GetInteger("b", &value));
+  EXPECT_EQ(6, value);
+}
+
+// Many keys added out of order and then partly removed: iteration still sees
+// the remaining keys in sorted order, and lookups find exactly those keys.
+TEST(ValuesTest, DictionaryManyKeys) {
+  const int kNumKeys = 1000;
+  DictionaryValue dict;
+  for (int i = 0; i < kNumKeys; ++i) {
+    int key = (i * 7919) % kNumKeys;
+    dict.SetIntegerWithoutPathExpansion(StringPrintf("%04d", key), key);
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumKeys), dict.size());
+
+  // Remove every third key.
+  for (int key = 0; key < kNumKeys; key += 3)
+    EXPECT_TRUE(dict.RemoveWithoutPathExpansion(StringPrintf("%04d", key),
+                                                NULL));
+
+  int expected_key = 1;
+  for (DictionaryValue::Iterator it(dict); !it.IsAtEnd(); it.Advance()) {
+    ASSERT_LT(expected_key, kNumKeys);
+    EXPECT_EQ(StringPrintf("%04d", expected_key), it.key());
+    int value = -1;
+    EXPECT_TRUE(it.value().GetAsInteger(&value));
+    EXPECT_EQ(expected_key, value);
+    ++expected_key;
+    if (expected_key % 3 == 0)
+      ++expected_key;
+  }
+  EXPECT_GE(expected_key, kNumKeys);
+
+  for (int key = 0; key < kNumKeys; ++key) {
+    EXPECT_EQ(key % 3 != 0, dict.HasKey(StringPrintf("%04d", key)));
+  }
+
+  scoped_ptr<DictionaryValue> copy(dict.DeepCopy());
+  EXPECT_TRUE(copy->Equals(&dict));
+  EXPECT_TRUE(dict.Equals(copy.get()));
+}
+
 }  // namespace base
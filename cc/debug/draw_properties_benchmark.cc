@@ -0,0 +1,39 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/debug/draw_properties_benchmark.h"
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/values.h"
+#include "cc/debug/draw_properties_benchmark_impl.h"
+
+namespace cc {
+
+DrawPropertiesBenchmark::DrawPropertiesBenchmark(
+    scoped_ptr<base::Value> value,
+    const MicroBenchmark::DoneCallback& callback)
+    : MicroBenchmark(callback),
+      settings_(value.Pass()),
+      weak_ptr_factory_(this) {}
+
+DrawPropertiesBenchmark::~DrawPropertiesBenchmark() {
+  weak_ptr_factory_.InvalidateWeakPtrs();
+}
+
+void DrawPropertiesBenchmark::RecordImplResults(
+    scoped_ptr<base::Value> results) {
+  NotifyDone(results.Pass());
+}
+
+scoped_ptr<MicroBenchmarkImpl> DrawPropertiesBenchmark::CreateBenchmarkImpl(
+    scoped_refptr<base::MessageLoopProxy> origin_loop) {
+  return scoped_ptr<MicroBenchmarkImpl>(new DrawPropertiesBenchmarkImpl(
+      origin_loop,
+      settings_.get(),
+      base::Bind(&DrawPropertiesBenchmark::RecordImplResults,
+                 weak_ptr_factory_.GetWeakPtr())));
+}
+
+}  // namespace cc
@@ -0,0 +1,35 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_DEBUG_DRAW_PROPERTIES_BENCHMARK_H_
+#define CC_DEBUG_DRAW_PROPERTIES_BENCHMARK_H_
+
+#include "base/memory/weak_ptr.h"
+#include "cc/debug/micro_benchmark.h"
+
+namespace cc {
+
+// Times LayerTreeImpl::UpdateDrawProperties on the committed impl tree of a
+// live page. All of the work happens in DrawPropertiesBenchmarkImpl; this
+// class only forwards the settings and reports the results.
+class CC_EXPORT DrawPropertiesBenchmark : public MicroBenchmark {
+ public:
+  DrawPropertiesBenchmark(scoped_ptr<base::Value> value,
+                          const MicroBenchmark::DoneCallback& callback);
+  virtual ~DrawPropertiesBenchmark();
+
+ protected:
+  virtual scoped_ptr<MicroBenchmarkImpl> CreateBenchmarkImpl(
+      scoped_refptr<base::MessageLoopProxy> origin_loop) OVERRIDE;
+
+ private:
+  void RecordImplResults(scoped_ptr<base::Value> results);
+
+  scoped_ptr<base::Value> settings_;
+  base::WeakPtrFactory<DrawPropertiesBenchmark> weak_ptr_factory_;
+};
+
+}  // namespace cc
+
+#endif  // CC_DEBUG_DRAW_PROPERTIES_BENCHMARK_H_
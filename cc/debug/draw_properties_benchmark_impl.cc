@@ -0,0 +1,84 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/debug/draw_properties_benchmark_impl.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/basictypes.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "cc/trees/layer_tree_host_impl.h"
+#include "cc/trees/layer_tree_impl.h"
+
+namespace cc {
+
+namespace {
+
+const int kDefaultRepeatCount = 100;
+
+base::TimeTicks Now() {
+  return base::TimeTicks::IsThreadNowSupported()
+             ? base::TimeTicks::ThreadNow()
+             : base::TimeTicks::HighResNow();
+}
+
+}  // namespace
+
+DrawPropertiesBenchmarkImpl::DrawPropertiesBenchmarkImpl(
+    scoped_refptr<base::MessageLoopProxy> origin_loop,
+    base::Value* value,
+    const MicroBenchmarkImpl::DoneCallback& callback)
+    : MicroBenchmarkImpl(callback, origin_loop),
+      repeat_count_(kDefaultRepeatCount) {
+  base::DictionaryValue* settings = NULL;
+  if (value)
+    value->GetAsDictionary(&settings);
+  if (!settings)
+    return;
+
+  if (settings->HasKey("repeat_count"))
+    settings->GetInteger("repeat_count", &repeat_count_);
+  repeat_count_ = std::max(repeat_count_, 1);
+}
+
+DrawPropertiesBenchmarkImpl::~DrawPropertiesBenchmarkImpl() {}
+
+void DrawPropertiesBenchmarkImpl::DidCompleteCommit(LayerTreeHostImpl* host) {
+  // With impl-side painting the commit lands in the pending tree, which is
+  // the tree the next frame's draw properties will come from.
+  LayerTreeImpl* tree =
+      host->pending_tree() ? host->pending_tree() : host->active_tree();
+
+  base::TimeDelta min_time =
+      base::TimeDelta::FromInternalValue(std::numeric_limits<int64>::max());
+  base::TimeDelta max_time;
+  base::TimeDelta total_time;
+  for (int i = 0; i < repeat_count_; ++i) {
+    tree->set_needs_update_draw_properties();
+    base::TimeTicks start = Now();
+    tree->UpdateDrawProperties();
+    base::TimeDelta duration = Now() - start;
+    min_time = std::min(min_time, duration);
+    max_time = std::max(max_time, duration);
+    total_time += duration;
+  }
+
+  scoped_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->SetInteger("repeat_count", repeat_count_);
+  result->SetBoolean("pending_tree", !tree->IsActiveTree());
+  result->SetInteger("render_surfaces",
+                     static_cast<int>(tree->RenderSurfaceLayerList().size()));
+  result->SetDouble("update_draw_properties_min_ms",
+                    min_time.InMillisecondsF());
+  result->SetDouble("update_draw_properties_mean_ms",
+                    total_time.InMillisecondsF() / repeat_count_);
+  result->SetDouble("update_draw_properties_max_ms",
+                    max_time.InMillisecondsF());
+
+  NotifyDone(result.PassAs<base::Value>());
+}
+
+}  // namespace cc
@@ -0,0 +1,31 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_DEBUG_DRAW_PROPERTIES_BENCHMARK_IMPL_H_
+#define CC_DEBUG_DRAW_PROPERTIES_BENCHMARK_IMPL_H_
+
+#include "cc/debug/micro_benchmark_impl.h"
+
+namespace cc {
+
+class LayerTreeHostImpl;
+
+class DrawPropertiesBenchmarkImpl : public MicroBenchmarkImpl {
+ public:
+  DrawPropertiesBenchmarkImpl(
+      scoped_refptr<base::MessageLoopProxy> origin_loop,
+      base::Value* value,
+      const MicroBenchmarkImpl::DoneCallback& callback);
+  virtual ~DrawPropertiesBenchmarkImpl();
+
+  // Implements MicroBenchmarkImpl interface.
+  virtual void DidCompleteCommit(LayerTreeHostImpl* host) OVERRIDE;
+
+ private:
+  int repeat_count_;
+};
+
+}  // namespace cc
+
+#endif  // CC_DEBUG_DRAW_PROPERTIES_BENCHMARK_IMPL_H_
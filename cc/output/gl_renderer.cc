@@ -4,6 +4,8 @@
 
 #include "cc/output/gl_renderer.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <limits>
 #include <set>
@@ -2462,6 +2464,11 @@ void GLRenderer::FinishedReadback(
       for (size_t dest_y = 0; dest_y < total_bytes; dest_y += row_bytes) {
         // Flip Y axis.
         size_t src_y = total_bytes - dest_y - row_bytes;
+#if SK_R32_SHIFT == 0 && SK_G32_SHIFT == 8 && SK_B32_SHIFT == 16 && \
+    SK_A32_SHIFT == 24 && defined(ARCH_CPU_LITTLE_ENDIAN)
+        // Skia already uses the OpenGL byte order, copy whole rows.
+        memcpy(dest_pixels + dest_y, src_pixels + src_y, row_bytes);
+#else
         // Swizzle OpenGL -> Skia byte order.
         for (size_t x = 0; x < row_bytes; x += 4) {
           dest_pixels[dest_y + x + SK_R32_SHIFT / 8] =
@@ -2473,6 +2480,7 @@ void GLRenderer::FinishedReadback(
           dest_pixels[dest_y + x + SK_A32_SHIFT / 8] =
               src_pixels[src_y + x + 3];
         }
+#endif
       }
 
       GLC(gl_,
@@ -52,6 +52,8 @@ ManagedTileState::ManagedTileState()
       priority_bin(TilePriority::EVENTUALLY),
       distance_to_visible(std::numeric_limits<float>::infinity()),
       visible_and_ready_to_draw(false),
+      gpu_memmgr_stats_bin(NEVER_BIN),
+      needs_rebinning(false),
       scheduled_priority(0) {}
 
 ManagedTileState::TileVersion::TileVersion()
@@ -115,6 +115,13 @@ class CC_EXPORT ManagedTileState {
   float distance_to_visible;
   bool visible_and_ready_to_draw;
 
+  // The bin the tile was counted in by the memory stats, or NEVER_BIN if it
+  // wasn't counted.
+  ManagedTileBin gpu_memmgr_stats_bin;
+
+  // Set when something the bin depends on changed since it was assigned.
+  bool needs_rebinning;
+
   // Priority for this state from the last time we assigned memory.
   unsigned scheduled_priority;
 };
@@ -165,6 +165,10 @@ bool PicturePile::Update(
       -kPixelDistanceToRecord,
       -kPixelDistanceToRecord);
 
+  // Analyses of the invalidated content are stale, the others carry over to
+  // the next commit.
+  InvalidateAnalysis(invalidation);
+
   bool invalidated = false;
   for (Region::Iterator i(invalidation); i.has_rect(); i.next()) {
     gfx::Rect invalidation = i.rect();
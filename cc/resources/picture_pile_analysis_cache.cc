@@ -0,0 +1,77 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/picture_pile_analysis_cache.h"
+
+#include "cc/base/region.h"
+
+namespace {
+
+// Bounds the memory used by the cache of a pile with a lot of content.  Once
+// the cache is full, new results are dropped until the next invalidation.
+const size_t kMaxCachedAnalyses = 4096;
+
+}  // namespace
+
+namespace cc {
+
+bool PicturePileAnalysisCache::RectLessThan::operator()(
+    const gfx::Rect& a, const gfx::Rect& b) const {
+  if (a.x() != b.x())
+    return a.x() < b.x();
+  if (a.y() != b.y())
+    return a.y() < b.y();
+  if (a.width() != b.width())
+    return a.width() < b.width();
+  return a.height() < b.height();
+}
+
+PicturePileAnalysisCache::PicturePileAnalysisCache() {
+}
+
+PicturePileAnalysisCache::~PicturePileAnalysisCache() {
+}
+
+scoped_refptr<PicturePileAnalysisCache> PicturePileAnalysisCache::CloneWithout(
+    const Region& invalidation) const {
+  scoped_refptr<PicturePileAnalysisCache> clone = new PicturePileAnalysisCache;
+
+  base::AutoLock lock(lock_);
+  for (AnalysisMap::const_iterator it = analysis_map_.begin();
+       it != analysis_map_.end();
+       ++it) {
+    if (!invalidation.Intersects(it->first))
+      clone->analysis_map_.insert(clone->analysis_map_.end(), *it);
+  }
+  return clone;
+}
+
+bool PicturePileAnalysisCache::GetAnalysis(
+    const gfx::Rect& layer_rect,
+    PicturePileImpl::Analysis* analysis) const {
+  base::AutoLock lock(lock_);
+  AnalysisMap::const_iterator it = analysis_map_.find(layer_rect);
+  if (it == analysis_map_.end())
+    return false;
+
+  *analysis = it->second;
+  return true;
+}
+
+void PicturePileAnalysisCache::SetAnalysis(
+    const gfx::Rect& layer_rect,
+    const PicturePileImpl::Analysis& analysis) {
+  base::AutoLock lock(lock_);
+  if (analysis_map_.size() >= kMaxCachedAnalyses)
+    return;
+
+  analysis_map_[layer_rect] = analysis;
+}
+
+size_t PicturePileAnalysisCache::GetSizeForTesting() const {
+  base::AutoLock lock(lock_);
+  return analysis_map_.size();
+}
+
+}  // namespace cc
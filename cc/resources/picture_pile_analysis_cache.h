@@ -0,0 +1,65 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_RESOURCES_PICTURE_PILE_ANALYSIS_CACHE_H_
+#define CC_RESOURCES_PICTURE_PILE_ANALYSIS_CACHE_H_
+
+#include <map>
+
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "cc/base/cc_export.h"
+#include "cc/resources/picture_pile_impl.h"
+#include "ui/gfx/rect.h"
+
+namespace cc {
+class Region;
+
+// Keeps the results of analyzing layer rects of a picture pile, so that tiles
+// covering content which wasn't invalidated since it was last analyzed don't
+// have to be analyzed again.  A cache is shared by a PicturePile, the
+// PicturePileImpls created from it and their clones for drawing, and may be
+// used on any thread.
+//
+// A cache is never invalidated in place, since PicturePileImpls of previous
+// commits may still add the results of their pictures to it.  Instead, the
+// pile replaces it with a clone which doesn't have the invalidated results.
+class CC_EXPORT PicturePileAnalysisCache
+    : public base::RefCountedThreadSafe<PicturePileAnalysisCache> {
+ public:
+  PicturePileAnalysisCache();
+
+  // Returns a new cache with the results of this one, except for those of
+  // layer rects intersecting |invalidation|.
+  scoped_refptr<PicturePileAnalysisCache> CloneWithout(
+      const Region& invalidation) const;
+
+  // Returns true and sets |analysis| if |layer_rect| was analyzed.
+  bool GetAnalysis(const gfx::Rect& layer_rect,
+                   PicturePileImpl::Analysis* analysis) const;
+  void SetAnalysis(const gfx::Rect& layer_rect,
+                   const PicturePileImpl::Analysis& analysis);
+
+  size_t GetSizeForTesting() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<PicturePileAnalysisCache>;
+
+  struct RectLessThan {
+    bool operator()(const gfx::Rect& a, const gfx::Rect& b) const;
+  };
+  typedef std::map<gfx::Rect, PicturePileImpl::Analysis, RectLessThan>
+      AnalysisMap;
+
+  ~PicturePileAnalysisCache();
+
+  mutable base::Lock lock_;
+  AnalysisMap analysis_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(PicturePileAnalysisCache);
+};
+
+}  // namespace cc
+
+#endif  // CC_RESOURCES_PICTURE_PILE_ANALYSIS_CACHE_H_
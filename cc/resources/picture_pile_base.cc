@@ -12,6 +12,7 @@
 #include "base/values.h"
 #include "cc/base/math_util.h"
 #include "cc/debug/traced_value.h"
+#include "cc/resources/picture_pile_analysis_cache.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "ui/gfx/rect_conversions.h"
 
@@ -44,7 +45,8 @@ PicturePileBase::PicturePileBase()
       slow_down_raster_scale_factor_for_debug_(0),
       contents_opaque_(false),
       show_debug_picture_borders_(false),
-      clear_canvas_with_debug_color_(kDefaultClearCanvasSetting) {
+      clear_canvas_with_debug_color_(kDefaultClearCanvasSetting),
+      analysis_cache_(new PicturePileAnalysisCache) {
   tiling_.SetMaxTextureSize(gfx::Size(kBasePictureSize, kBasePictureSize));
   tile_grid_info_.fTileInterval.setEmpty();
   tile_grid_info_.fMargin.setEmpty();
@@ -62,7 +64,8 @@ PicturePileBase::PicturePileBase(const PicturePileBase* other)
           other->slow_down_raster_scale_factor_for_debug_),
       contents_opaque_(other->contents_opaque_),
       show_debug_picture_borders_(other->show_debug_picture_borders_),
-      clear_canvas_with_debug_color_(other->clear_canvas_with_debug_color_) {
+      clear_canvas_with_debug_color_(other->clear_canvas_with_debug_color_),
+      analysis_cache_(other->analysis_cache_) {
 }
 
 PicturePileBase::PicturePileBase(
@@ -76,7 +79,8 @@ PicturePileBase::PicturePileBase(
           other->slow_down_raster_scale_factor_for_debug_),
       contents_opaque_(other->contents_opaque_),
       show_debug_picture_borders_(other->show_debug_picture_borders_),
-      clear_canvas_with_debug_color_(other->clear_canvas_with_debug_color_) {
+      clear_canvas_with_debug_color_(other->clear_canvas_with_debug_color_),
+      analysis_cache_(other->analysis_cache_) {
   for (PictureMap::const_iterator it = other->picture_map_.begin();
        it != other->picture_map_.end();
        ++it) {
@@ -111,6 +115,9 @@ void PicturePileBase::Resize(const gfx::Size& new_size) {
 
   for (size_t i = 0; i < to_erase.size(); ++i)
     picture_map_.erase(to_erase[i]);
+
+  // Analyses of rects along the old edges were clipped to the old size.
+  analysis_cache_ = new PicturePileAnalysisCache;
 }
 
 void PicturePileBase::SetMinContentsScale(float min_contents_scale) {
@@ -164,6 +171,13 @@ void PicturePileBase::SetBufferPixels(int new_buffer_pixels) {
 
 void PicturePileBase::Clear() {
   picture_map_.clear();
+  analysis_cache_ = new PicturePileAnalysisCache;
+}
+
+void PicturePileBase::InvalidateAnalysis(const Region& invalidation) {
+  if (invalidation.IsEmpty())
+    return;
+  analysis_cache_ = analysis_cache_->CloneWithout(invalidation);
 }
 
 void PicturePileBase::UpdateRecordedRegion() {
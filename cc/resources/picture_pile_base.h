@@ -22,6 +22,7 @@ class Value;
 }
 
 namespace cc {
+class PicturePileAnalysisCache;
 
 class CC_EXPORT PicturePileBase : public base::RefCounted<PicturePileBase> {
  public:
@@ -91,6 +92,9 @@ class CC_EXPORT PicturePileBase : public base::RefCounted<PicturePileBase> {
   int buffer_pixels() const { return tiling_.border_texels(); }
   void Clear();
 
+  // Drops the cached analyses of layer rects intersecting |invalidation|.
+  void InvalidateAnalysis(const Region& invalidation);
+
   gfx::Rect PaddedRect(const PictureMapKey& key);
   gfx::Rect PadRect(const gfx::Rect& rect);
 
@@ -106,6 +110,8 @@ class CC_EXPORT PicturePileBase : public base::RefCounted<PicturePileBase> {
   bool contents_opaque_;
   bool show_debug_picture_borders_;
   bool clear_canvas_with_debug_color_;
+  // Shared with the piles created from this one, see PicturePileImpl.
+  scoped_refptr<PicturePileAnalysisCache> analysis_cache_;
 
  private:
   void SetBufferPixels(int buffer_pixels);
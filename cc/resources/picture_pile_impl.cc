@@ -8,6 +8,7 @@
 #include "base/debug/trace_event.h"
 #include "cc/base/region.h"
 #include "cc/debug/debug_colors.h"
+#include "cc/resources/picture_pile_analysis_cache.h"
 #include "cc/resources/picture_pile_impl.h"
 #include "cc/resources/raster_worker_pool.h"
 #include "skia/ext/analysis_canvas.h"
@@ -330,6 +331,11 @@ void PicturePileImpl::AnalyzeInRect(
 
   layer_rect.Intersect(gfx::Rect(tiling_.total_size()));
 
+  // The analysis only depends on the pictures covering |layer_rect|, which
+  // haven't changed if the rect wasn't invalidated since it was analyzed.
+  if (analysis_cache_->GetAnalysis(layer_rect, analysis))
+    return;
+
   SkBitmap empty_bitmap;
   empty_bitmap.setConfig(SkBitmap::kNo_Config,
                          layer_rect.width(),
@@ -341,11 +347,17 @@ void PicturePileImpl::AnalyzeInRect(
 
   analysis->is_solid_color = canvas.GetColorIfSolid(&analysis->solid_color);
   analysis->has_text = canvas.HasText();
+  analysis->draw_op_count = canvas.GetDrawOpCount();
+  analysis->has_image_filters = canvas.HasImageFilters();
+
+  analysis_cache_->SetAnalysis(layer_rect, *analysis);
 }
 
 PicturePileImpl::Analysis::Analysis()
     : is_solid_color(false),
-      has_text(false) {
+      has_text(false),
+      draw_op_count(0),
+      has_image_filters(false) {
 }
 
 PicturePileImpl::Analysis::~Analysis() {
@@ -69,6 +69,10 @@ class CC_EXPORT PicturePileImpl : public PicturePileBase {
     bool is_solid_color;
     bool has_text;
     SkColor solid_color;
+    // Estimates the cost of rasterizing the rect, see
+    // skia::AnalysisCanvas::GetDrawOpCount().
+    int draw_op_count;
+    bool has_image_filters;
   };
 
   void AnalyzeInRect(const gfx::Rect& content_rect,
@@ -6,6 +6,8 @@
 #include <utility>
 
 #include "cc/resources/picture_pile.h"
+#include "cc/resources/picture_pile_analysis_cache.h"
+#include "cc/resources/picture_pile_impl.h"
 #include "cc/test/fake_content_layer_client.h"
 #include "cc/test/fake_rendering_stats_instrumentation.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -20,6 +22,7 @@ class TestPicturePile : public PicturePile {
   using PicturePile::buffer_pixels;
 
   PictureMap& picture_map() { return picture_map_; }
+  PicturePileAnalysisCache* analysis_cache() { return analysis_cache_.get(); }
 
   typedef PicturePile::PictureInfo PictureInfo;
   typedef PicturePile::PictureMapKey PictureMapKey;
@@ -299,5 +302,65 @@ TEST(PicturePileTest, StopRecordingOffscreenInvalidations) {
   }
 }
 
+TEST(PicturePileTest, AnalysisCarriesOverCommits) {
+  FakeContentLayerClient client;
+  FakeRenderingStatsInstrumentation stats_instrumentation;
+  scoped_refptr<TestPicturePile> pile = new TestPicturePile;
+  SkColor background_color = SK_ColorBLUE;
+
+  gfx::Size layer_size = pile->tiling().max_texture_size();
+  pile->Resize(layer_size);
+  pile->SetTileGridSize(gfx::Size(1000, 1000));
+  pile->SetMinContentsScale(1.f);
+
+  pile->Update(&client,
+               background_color,
+               false,
+               gfx::Rect(layer_size),
+               gfx::Rect(layer_size),
+               1,
+               &stats_instrumentation);
+
+  scoped_refptr<PicturePileImpl> pile_impl =
+      PicturePileImpl::CreateFromOther(pile.get());
+  PicturePileImpl::Analysis analysis;
+  pile_impl->AnalyzeInRect(gfx::Rect(0, 0, 100, 100), 1.f, &analysis);
+  pile_impl->AnalyzeInRect(gfx::Rect(200, 200, 100, 100), 1.f, &analysis);
+  // Analyzing at a scale ends up with the same layer rect.
+  pile_impl->AnalyzeInRect(gfx::Rect(0, 0, 200, 200), 2.f, &analysis);
+  EXPECT_EQ(2u, pile->analysis_cache()->GetSizeForTesting());
+
+  // A commit without invalidation keeps all the analyses.
+  pile->Update(&client,
+               background_color,
+               false,
+               Region(),
+               gfx::Rect(layer_size),
+               2,
+               &stats_instrumentation);
+  EXPECT_EQ(2u, pile->analysis_cache()->GetSizeForTesting());
+
+  // Invalidation only drops the analyses of the invalidated content, and
+  // doesn't affect the piles of previous commits.
+  PicturePileAnalysisCache* previous_cache = pile->analysis_cache();
+  pile->Update(&client,
+               background_color,
+               false,
+               gfx::Rect(50, 50, 10, 10),
+               gfx::Rect(layer_size),
+               3,
+               &stats_instrumentation);
+  EXPECT_EQ(1u, pile->analysis_cache()->GetSizeForTesting());
+  EXPECT_EQ(2u, previous_cache->GetSizeForTesting());
+
+  pile_impl = PicturePileImpl::CreateFromOther(pile.get());
+  pile_impl->AnalyzeInRect(gfx::Rect(0, 0, 100, 100), 1.f, &analysis);
+  EXPECT_EQ(2u, pile->analysis_cache()->GetSizeForTesting());
+
+  // Resizing drops all the analyses.
+  pile->Resize(gfx::Size(layer_size.width() / 2, layer_size.height()));
+  EXPECT_EQ(0u, pile->analysis_cache()->GetSizeForTesting());
+}
+
 }  // namespace
 }  // namespace cc
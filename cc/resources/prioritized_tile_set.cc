@@ -42,7 +42,8 @@ namespace {
 
 typedef std::vector<Tile*> TileVector;
 
-void SortBinTiles(ManagedTileBin bin, TileVector* tiles) {
+// Sorts |tiles|, of which the first |sorted_count| are already sorted.
+void SortBinTiles(ManagedTileBin bin, size_t sorted_count, TileVector* tiles) {
   switch (bin) {
     case NOW_AND_READY_TO_DRAW_BIN:
     case NEVER_BIN:
@@ -52,9 +53,12 @@ void SortBinTiles(ManagedTileBin bin, TileVector* tiles) {
     case EVENTUALLY_AND_ACTIVE_BIN:
     case EVENTUALLY_BIN:
     case AT_LAST_AND_ACTIVE_BIN:
-    case AT_LAST_BIN:
-      std::sort(tiles->begin(), tiles->end(), BinComparator());
+    case AT_LAST_BIN: {
+      TileVector::iterator middle = tiles->begin() + sorted_count;
+      std::sort(middle, tiles->end(), BinComparator());
+      std::inplace_merge(tiles->begin(), middle, tiles->end(), BinComparator());
       break;
+    }
     default:
       NOTREACHED();
   }
@@ -64,27 +68,43 @@ void SortBinTiles(ManagedTileBin bin, TileVector* tiles) {
 
 PrioritizedTileSet::PrioritizedTileSet() {
   for (int bin = 0; bin < NUM_BINS; ++bin)
-    bin_sorted_[bin] = true;
+    sorted_tile_count_[bin] = 0;
 }
 
 PrioritizedTileSet::~PrioritizedTileSet() {}
 
 void PrioritizedTileSet::InsertTile(Tile* tile, ManagedTileBin bin) {
   tiles_[bin].push_back(tile);
-  bin_sorted_[bin] = false;
 }
 
 void PrioritizedTileSet::Clear() {
   for (int bin = 0; bin < NUM_BINS; ++bin) {
     tiles_[bin].clear();
-    bin_sorted_[bin] = true;
+    sorted_tile_count_[bin] = 0;
+  }
+}
+
+void PrioritizedTileSet::RemoveTilesNeedingRebinning() {
+  for (int bin = 0; bin < NUM_BINS; ++bin) {
+    TileVector& tiles = tiles_[bin];
+    size_t tile_count = 0;
+    size_t sorted_tile_count = 0;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+      if (tiles[i]->managed_state().needs_rebinning)
+        continue;
+      if (i < sorted_tile_count_[bin])
+        ++sorted_tile_count;
+      tiles[tile_count++] = tiles[i];
+    }
+    tiles.resize(tile_count);
+    sorted_tile_count_[bin] = sorted_tile_count;
   }
 }
 
 void PrioritizedTileSet::SortBinIfNeeded(ManagedTileBin bin) {
-  if (!bin_sorted_[bin]) {
-    SortBinTiles(bin, &tiles_[bin]);
-    bin_sorted_[bin] = true;
+  if (sorted_tile_count_[bin] != tiles_[bin].size()) {
+    SortBinTiles(bin, sorted_tile_count_[bin], &tiles_[bin]);
+    sorted_tile_count_[bin] = tiles_[bin].size();
   }
 }
 
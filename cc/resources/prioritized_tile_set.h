@@ -21,6 +21,11 @@ class CC_EXPORT PrioritizedTileSet {
   void InsertTile(Tile* tile, ManagedTileBin bin);
   void Clear();
 
+  // Removes the tiles whose ManagedTileState::needs_rebinning is set. The
+  // remaining tiles keep their order, so re-inserting a few tiles only costs
+  // sorting those and merging them in.
+  void RemoveTilesNeedingRebinning();
+
   class CC_EXPORT Iterator {
    public:
     Iterator(PrioritizedTileSet* set, bool use_priority_ordering);
@@ -51,7 +56,8 @@ class CC_EXPORT PrioritizedTileSet {
   void SortBinIfNeeded(ManagedTileBin bin);
 
   std::vector<Tile*> tiles_[NUM_BINS];
-  bool bin_sorted_[NUM_BINS];
+  // The number of tiles at the front of each bin which are already sorted.
+  size_t sorted_tile_count_[NUM_BINS];
 };
 
 }  // namespace cc
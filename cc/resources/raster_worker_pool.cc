@@ -44,6 +44,13 @@ class IdentityAllocator : public SkBitmap::Allocator {
 // a tile is of solid color.
 const bool kUseColorEstimator = true;
 
+// Tiles whose analysis counted at least this many draw calls are rasterized
+// in horizontal parts, in parallel on the raster threads.
+const int kMinDrawOpCountForRasterInParts = 1000;
+
+// Parts of a tile rasterized in parallel are at least this high.
+const int kMinRasterPartHeight = 64;
+
 // Synthetic delay for raster tasks that are required for activation. Global to
 // avoid static initializer on critical path.
 struct RasterRequiredForActivationSyntheticDelayInitializer {
@@ -67,6 +74,47 @@ class DisableLCDTextFilter : public SkDrawFilter {
   }
 };
 
+// Rasterizes |content_rect| of a tile into |bitmap|, which shares its
+// pixels with the part of the tile's bitmap that covers |content_rect|.
+class RasterPartTaskImpl : public internal::Task {
+ public:
+  RasterPartTaskImpl(PicturePileImpl* picture_pile,
+                     const SkBitmap& bitmap,
+                     const gfx::Rect& content_rect,
+                     float contents_scale,
+                     SkDrawFilter* draw_filter,
+                     RenderingStatsInstrumentation* rendering_stats)
+      : picture_pile_(picture_pile),
+        bitmap_(bitmap),
+        content_rect_(content_rect),
+        contents_scale_(contents_scale),
+        draw_filter_(skia::SharePtr(draw_filter)),
+        rendering_stats_(rendering_stats) {}
+
+  // Overridden from internal::Task:
+  virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
+    TRACE_EVENT0("cc", "RasterPartTaskImpl::RunOnWorkerThread");
+
+    SkCanvas canvas(bitmap_);
+    canvas.setDrawFilter(draw_filter_.get());
+    picture_pile_->GetCloneForDrawingOnThread(thread_index)->RasterToBitmap(
+        &canvas, content_rect_, contents_scale_, rendering_stats_);
+  }
+
+ protected:
+  virtual ~RasterPartTaskImpl() {}
+
+ private:
+  scoped_refptr<PicturePileImpl> picture_pile_;
+  SkBitmap bitmap_;
+  gfx::Rect content_rect_;
+  float contents_scale_;
+  skia::RefPtr<SkDrawFilter> draw_filter_;
+  RenderingStatsInstrumentation* rendering_stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(RasterPartTaskImpl);
+};
+
 class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
  public:
   RasterWorkerPoolTaskImpl(
@@ -95,7 +143,8 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
         rendering_stats_(rendering_stats),
         reply_(reply),
         context_provider_(context_provider),
-        canvas_(NULL) {}
+        canvas_(NULL),
+        task_graph_runner_(NULL) {}
 
   // Overridden from internal::Task:
   virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
@@ -105,7 +154,9 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
     Analyze(picture_pile_->GetCloneForDrawingOnThread(thread_index));
     if (!canvas_ || analysis_.is_solid_color)
       return;
-    Raster(picture_pile_->GetCloneForDrawingOnThread(thread_index));
+    Raster(picture_pile_->GetCloneForDrawingOnThread(thread_index),
+           thread_index,
+           GetRasterPartCount());
   }
 
   // Overridden from internal::WorkerPoolTask:
@@ -113,6 +164,7 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
       OVERRIDE {
     DCHECK(!canvas_);
     canvas_ = client->AcquireCanvasForRaster(this);
+    task_graph_runner_ = client->GetTaskGraphRunnerForRaster();
   }
   virtual void RunOnOriginThread() OVERRIDE {
     TRACE_EVENT0("cc", "RasterWorkerPoolTaskImpl::RunOnOriginThread");
@@ -129,7 +181,7 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
         base::StringPrintf(
             "Raster-%d-%d-%p", source_frame_number_, layer_id_, tile_id_)
             .c_str());
-    Raster(picture_pile_);
+    Raster(picture_pile_, 0u, 1u);
     context_provider_->ContextGL()->PopGroupMarkerEXT();
   }
   virtual void CompleteOnOriginThread(internal::WorkerPoolTaskClient* client)
@@ -174,7 +226,21 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
     analysis_.is_solid_color &= kUseColorEstimator;
   }
 
-  void Raster(PicturePileImpl* picture_pile) {
+  // Returns the number of parts to rasterize the tile in, based on the cost
+  // estimated by Analyze().
+  size_t GetRasterPartCount() const {
+    if (!task_graph_runner_ || analysis_.has_image_filters ||
+        analysis_.draw_op_count < kMinDrawOpCountForRasterInParts)
+      return 1u;
+
+    int part_count = std::min(RasterWorkerPool::GetNumRasterThreads(),
+                              content_rect_.height() / kMinRasterPartHeight);
+    return std::max(part_count, 1);
+  }
+
+  void Raster(PicturePileImpl* picture_pile,
+              unsigned thread_index,
+              size_t part_count) {
     TRACE_EVENT2(
         "cc",
         "RasterWorkerPoolTaskImpl::Raster",
@@ -212,8 +278,11 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
     RenderingStatsInstrumentation* stats =
         tile_resolution_ == HIGH_RESOLUTION ? rendering_stats_ : NULL;
     DCHECK(picture_pile);
-    picture_pile->RasterToBitmap(
-        canvas_, content_rect_, contents_scale_, stats);
+    if (part_count == 1u ||
+        !RasterInParts(part_count, thread_index, draw_filter.get(), stats)) {
+      picture_pile->RasterToBitmap(
+          canvas_, content_rect_, contents_scale_, stats);
+    }
 
     if (rendering_stats_->record_rendering_stats()) {
       base::TimeDelta current_rasterize_time =
@@ -227,6 +296,59 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
     }
   }
 
+  // Splits the tile into |part_count| horizontal parts, and rasterizes them
+  // directly into the pixels of |canvas_| on all raster threads, including
+  // this one. Returns false if the pixels of |canvas_| can't be shared.
+  bool RasterInParts(size_t part_count,
+                     unsigned thread_index,
+                     SkDrawFilter* draw_filter,
+                     RenderingStatsInstrumentation* stats) {
+    TRACE_EVENT1(
+        "cc", "RasterWorkerPoolTaskImpl::RasterInParts", "parts", part_count);
+
+    const SkBitmap& bitmap = canvas_->getDevice()->accessBitmap(false);
+    if (!bitmap.getPixels())
+      return false;
+
+    int parts = static_cast<int>(part_count);
+    int part_height = (content_rect_.height() + parts - 1) / parts;
+    internal::Task::Vector part_tasks;
+    internal::TaskGraph graph;
+    for (int y = 0; y < content_rect_.height(); y += part_height) {
+      gfx::Rect part_rect(content_rect_.x(),
+                          content_rect_.y() + y,
+                          content_rect_.width(),
+                          std::min(part_height, content_rect_.height() - y));
+      SkBitmap part_bitmap;
+      if (!bitmap.extractSubset(&part_bitmap,
+                                SkIRect::MakeXYWH(0,
+                                                  y,
+                                                  part_rect.width(),
+                                                  part_rect.height())))
+        return false;
+
+      scoped_refptr<internal::Task> part(
+          new RasterPartTaskImpl(picture_pile_.get(),
+                                 part_bitmap,
+                                 part_rect,
+                                 contents_scale_,
+                                 draw_filter,
+                                 stats));
+      // The tile is already being rasterized, so its parts go first.
+      graph.nodes.push_back(internal::TaskGraph::Node(part.get(), 0u, 0u));
+      part_tasks.push_back(part);
+    }
+
+    internal::NamespaceToken token = task_graph_runner_->GetNamespaceToken();
+    task_graph_runner_->SetTaskGraph(token, &graph);
+    task_graph_runner_->RunAndWaitForTasksToFinishRunning(token, thread_index);
+
+    internal::Task::Vector completed_tasks;
+    task_graph_runner_->CollectCompletedTasks(token, &completed_tasks);
+    DCHECK_EQ(part_tasks.size(), completed_tasks.size());
+    return true;
+  }
+
   PicturePileImpl::Analysis analysis_;
   scoped_refptr<PicturePileImpl> picture_pile_;
   gfx::Rect content_rect_;
@@ -240,6 +362,7 @@ class RasterWorkerPoolTaskImpl : public internal::RasterWorkerPoolTask {
   const base::Callback<void(const PicturePileImpl::Analysis&, bool)> reply_;
   ContextProvider* context_provider_;
   SkCanvas* canvas_;
+  internal::TaskGraphRunner* task_graph_runner_;
 
   DISALLOW_COPY_AND_ASSIGN(RasterWorkerPoolTaskImpl);
 };
@@ -513,6 +636,10 @@ internal::TaskGraphRunner* RasterWorkerPool::GetTaskGraphRunner() {
   return g_task_graph_runner.Pointer();
 }
 
+internal::TaskGraphRunner* RasterWorkerPool::GetTaskGraphRunnerForRaster() {
+  return task_graph_runner_;
+}
+
 // static
 scoped_refptr<internal::RasterWorkerPoolTask>
 RasterWorkerPool::CreateRasterTask(
@@ -34,6 +34,9 @@ class CC_EXPORT WorkerPoolTaskClient {
   virtual void OnRasterCompleted(RasterWorkerPoolTask* task,
                                  const PicturePileImpl::Analysis& analysis) = 0;
   virtual void OnImageDecodeCompleted(WorkerPoolTask* task) = 0;
+  // Returns the runner that runs raster tasks on worker threads, or NULL if
+  // they run on the origin thread.
+  virtual TaskGraphRunner* GetTaskGraphRunnerForRaster() = 0;
 
  protected:
   virtual ~WorkerPoolTaskClient() {}
@@ -188,6 +191,9 @@ class CC_EXPORT RasterWorkerPool : public internal::WorkerPoolTaskClient {
   // Returns the format that needs to be used for raster task resources.
   virtual ResourceFormat GetResourceFormat() const = 0;
 
+  // Overridden from internal::WorkerPoolTaskClient:
+  virtual internal::TaskGraphRunner* GetTaskGraphRunnerForRaster() OVERRIDE;
+
  protected:
   typedef std::vector<scoped_refptr<internal::WorkerPoolTask> > TaskVector;
   typedef std::deque<scoped_refptr<internal::WorkerPoolTask> > TaskDeque;
@@ -4,6 +4,7 @@
 
 #include "cc/resources/resource_pool.h"
 
+#include "base/debug/trace_event.h"
 #include "cc/resources/resource_provider.h"
 #include "cc/resources/scoped_resource.h"
 
@@ -20,7 +21,10 @@ ResourcePool::ResourcePool(ResourceProvider* resource_provider,
       max_resource_count_(0),
       memory_usage_bytes_(0),
       unused_memory_usage_bytes_(0),
-      resource_count_(0) {}
+      resource_count_(0),
+      hit_count_(0),
+      miss_count_(0),
+      eviction_count_(0) {}
 
 ResourcePool::~ResourcePool() {
   while (!busy_resources_.empty()) {
@@ -48,9 +52,23 @@ scoped_ptr<ScopedResource> ResourcePool::AcquireResource(
 
     unused_resources_.erase(it);
     unused_memory_usage_bytes_ -= resource->bytes();
+    ++hit_count_;
+    TraceCounters();
     return make_scoped_ptr(resource);
   }
 
+  // No unused resource of the right size. Make room for the new one by
+  // evicting the least recently used unused resources first, so that idle
+  // resources of sizes no longer in use don't push the pool over its
+  // memory budget while the new one is allocated.
+  size_t bytes = Resource::MemorySizeBytes(size, format_);
+  while (!unused_resources_.empty() &&
+         memory_usage_bytes_ + bytes > max_memory_usage_bytes_)
+    EvictLeastRecentlyUsedResource();
+
+  ++miss_count_;
+  TraceCounters();
+
   // Create new resource.
   scoped_ptr<ScopedResource> resource =
       ScopedResource::Create(resource_provider_);
@@ -92,15 +110,33 @@ void ResourcePool::ReduceResourceUsage() {
     // can't be locked for write might also not be truly free-able.
     // We can free the resource here but it doesn't mean that the
     // memory is necessarily returned to the OS.
-    ScopedResource* resource = unused_resources_.front();
-    unused_resources_.pop_front();
-    memory_usage_bytes_ -= resource->bytes();
-    unused_memory_usage_bytes_ -= resource->bytes();
-    --resource_count_;
-    delete resource;
+    EvictLeastRecentlyUsedResource();
   }
 }
 
+void ResourcePool::EvictLeastRecentlyUsedResource() {
+  DCHECK(!unused_resources_.empty());
+  ScopedResource* resource = unused_resources_.front();
+  unused_resources_.pop_front();
+  memory_usage_bytes_ -= resource->bytes();
+  unused_memory_usage_bytes_ -= resource->bytes();
+  --resource_count_;
+  ++eviction_count_;
+  delete resource;
+  TraceCounters();
+}
+
+void ResourcePool::TraceCounters() const {
+  TRACE_COUNTER_ID2("cc",
+                    "ResourcePoolReuse",
+                    this,
+                    "hits",
+                    hit_count_,
+                    "misses",
+                    miss_count_);
+  TRACE_COUNTER_ID1("cc", "ResourcePoolEvictions", this, eviction_count_);
+}
+
 bool ResourcePool::ResourceUsageTooHigh() {
   if (resource_count_ > max_resource_count_)
     return true;
@@ -44,6 +44,13 @@ class CC_EXPORT ResourcePool {
     return resource_count_ - unused_resources_.size();
   }
 
+  // Number of acquisitions that reused an unused resource, that had to
+  // allocate a new one, and of unused resources deleted to stay within the
+  // limits, since the pool was created.
+  size_t hit_count() const { return hit_count_; }
+  size_t miss_count() const { return miss_count_; }
+  size_t eviction_count() const { return eviction_count_; }
+
  protected:
   ResourcePool(ResourceProvider* resource_provider,
                GLenum target,
@@ -53,6 +60,8 @@ class CC_EXPORT ResourcePool {
 
  private:
   void DidFinishUsingResource(ScopedResource* resource);
+  void EvictLeastRecentlyUsedResource();
+  void TraceCounters() const;
 
   ResourceProvider* resource_provider_;
   const GLenum target_;
@@ -63,7 +72,11 @@ class CC_EXPORT ResourcePool {
   size_t memory_usage_bytes_;
   size_t unused_memory_usage_bytes_;
   size_t resource_count_;
+  size_t hit_count_;
+  size_t miss_count_;
+  size_t eviction_count_;
 
+  // Ordered from least to most recently used.
   typedef std::list<ScopedResource*> ResourceList;
   ResourceList unused_resources_;
   ResourceList busy_resources_;
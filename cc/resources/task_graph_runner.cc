@@ -14,52 +14,77 @@ namespace cc {
 namespace internal {
 namespace {
 
-// Helper class for iterating over all dependents of a task.
+bool CompareNodeTask(const TaskGraph::Node& a, const TaskGraph::Node& b) {
+  return a.task < b.task;
+}
+
+bool CompareEdgeTask(const TaskGraph::Edge& a, const TaskGraph::Edge& b) {
+  return a.task < b.task;
+}
+
+// Returns the node of |task| in |graph|, whose nodes must be sorted by task,
+// or NULL if |task| is not part of |graph|.
+TaskGraph::Node* FindNode(TaskGraph* graph, const Task* task) {
+  TaskGraph::Node::Vector::iterator it =
+      std::lower_bound(graph->nodes.begin(),
+                       graph->nodes.end(),
+                       TaskGraph::Node(const_cast<Task*>(task), 0u, 0u),
+                       CompareNodeTask);
+  if (it == graph->nodes.end() || it->task != task)
+    return NULL;
+  return &(*it);
+}
+
+// Helper class for iterating over all dependents of a task. The nodes and
+// edges of |graph| must be sorted by task.
 class DependentIterator {
  public:
   DependentIterator(TaskGraph* graph, const Task* task)
-      : graph_(graph), task_(task), current_index_(-1), current_node_(NULL) {
-    ++(*this);
+      : graph_(graph),
+        task_(task),
+        current_index_(static_cast<size_t>(
+            std::lower_bound(graph->edges.begin(),
+                             graph->edges.end(),
+                             TaskGraph::Edge(task, NULL),
+                             CompareEdgeTask) -
+            graph->edges.begin())),
+        current_node_(NULL) {
+    FindCurrentNode();
   }
 
   TaskGraph::Node& operator->() const {
-    DCHECK_LT(current_index_, graph_->edges.size());
-    DCHECK_EQ(graph_->edges[current_index_].task, task_);
+    DCHECK(*this);
     DCHECK(current_node_);
     return *current_node_;
   }
 
   TaskGraph::Node& operator*() const {
-    DCHECK_LT(current_index_, graph_->edges.size());
-    DCHECK_EQ(graph_->edges[current_index_].task, task_);
+    DCHECK(*this);
     DCHECK(current_node_);
     return *current_node_;
   }
 
-  // Note: Performance can be improved by keeping edges sorted.
   DependentIterator& operator++() {
-    // Find next dependency edge for |task_|.
-    do {
-      ++current_index_;
-      if (current_index_ == graph_->edges.size())
-        return *this;
-    } while (graph_->edges[current_index_].task != task_);
-
-    // Now find the node for the dependent of this edge.
-    TaskGraph::Node::Vector::iterator it =
-        std::find_if(graph_->nodes.begin(),
-                     graph_->nodes.end(),
-                     TaskGraph::Node::TaskComparator(
-                         graph_->edges[current_index_].dependent));
-    DCHECK(it != graph_->nodes.end());
-    current_node_ = &(*it);
-
+    ++current_index_;
+    FindCurrentNode();
     return *this;
   }
 
-  operator bool() const { return current_index_ < graph_->edges.size(); }
+  operator bool() const {
+    return current_index_ < graph_->edges.size() &&
+           graph_->edges[current_index_].task == task_;
+  }
 
  private:
+  // Finds the node for the dependent of the current edge.
+  void FindCurrentNode() {
+    if (!*this)
+      return;
+    current_node_ =
+        FindNode(graph_, graph_->edges[current_index_].dependent);
+    DCHECK(current_node_);
+  }
+
   TaskGraph* graph_;
   const Task* task_;
   size_t current_index_;
@@ -136,6 +161,7 @@ TaskGraphRunner::TaskGraphRunner(size_t num_threads,
       next_thread_index_(0u),
       // |num_threads| can be 0 for test.
       running_tasks_(std::max(num_threads, static_cast<size_t>(1)), NULL),
+      nested_running_tasks_(running_tasks_.size(), NULL),
       shutdown_(false) {
   base::AutoLock lock(lock_);
 
@@ -209,6 +235,46 @@ void TaskGraphRunner::WaitForTasksToFinishRunning(NamespaceToken token) {
   }
 }
 
+void TaskGraphRunner::RunAndWaitForTasksToFinishRunning(NamespaceToken token,
+                                                        unsigned thread_index) {
+  TRACE_EVENT0("cc", "TaskGraphRunner::RunAndWaitForTasksToFinishRunning");
+
+  DCHECK(token.IsValid());
+
+  {
+    base::AutoLock lock(lock_);
+
+    TaskNamespaceMap::iterator it = namespaces_.find(token.id_);
+    if (it == namespaces_.end())
+      return;
+
+    TaskNamespace* task_namespace = &it->second;
+
+    while (!HasFinishedRunningTasksInNamespace(task_namespace)) {
+      // Wait for the tasks running on other threads.
+      if (task_namespace->ready_to_run_tasks.empty()) {
+        has_namespaces_with_finished_running_tasks_cv_.Wait();
+        continue;
+      }
+
+      TaskNamespace::Vector::iterator ready_it =
+          std::find(ready_to_run_namespaces_.begin(),
+                    ready_to_run_namespaces_.end(),
+                    task_namespace);
+      DCHECK(ready_it != ready_to_run_namespaces_.end());
+      ready_to_run_namespaces_.erase(ready_it);
+      std::make_heap(ready_to_run_namespaces_.begin(),
+                     ready_to_run_namespaces_.end(),
+                     CompareTaskNamespacePriority);
+
+      DCHECK_LT(static_cast<size_t>(thread_index),
+                nested_running_tasks_.size());
+      RunTaskInNamespaceWithLockAcquired(
+          task_namespace, thread_index, &nested_running_tasks_[thread_index]);
+    }
+  }
+}
+
 void TaskGraphRunner::SetTaskGraph(NamespaceToken token, TaskGraph* graph) {
   TRACE_EVENT2("cc",
                "TaskGraphRunner::SetTaskGraph",
@@ -230,6 +296,11 @@ void TaskGraphRunner::SetTaskGraph(NamespaceToken token, TaskGraph* graph) {
 
     TaskNamespace& task_namespace = namespaces_[token.id_];
 
+    // Sort the new graph, so that nodes and dependents can be looked up
+    // without searching all of it.
+    std::sort(graph->nodes.begin(), graph->nodes.end(), CompareNodeTask);
+    std::sort(graph->edges.begin(), graph->edges.end(), CompareEdgeTask);
+
     // First adjust number of dependencies to reflect completed tasks.
     for (Task::Vector::iterator it = task_namespace.completed_tasks.begin();
          it != task_namespace.completed_tasks.end();
@@ -241,25 +312,13 @@ void TaskGraphRunner::SetTaskGraph(NamespaceToken token, TaskGraph* graph) {
       }
     }
 
-    // Build new "ready to run" queue and remove nodes from old graph.
+    // Build new "ready to run" queue.
     task_namespace.ready_to_run_tasks.clear();
     for (TaskGraph::Node::Vector::iterator it = graph->nodes.begin();
          it != graph->nodes.end();
          ++it) {
       TaskGraph::Node& node = *it;
 
-      // Remove any old nodes that are associated with this task. The result is
-      // that the old graph is left all nodes not present in this graph, which
-      // we use below to determine what tasks need to be canceled.
-      TaskGraph::Node::Vector::iterator old_it =
-          std::find_if(task_namespace.graph.nodes.begin(),
-                       task_namespace.graph.nodes.end(),
-                       TaskGraph::Node::TaskComparator(node.task));
-      if (old_it != task_namespace.graph.nodes.end()) {
-        std::swap(*old_it, task_namespace.graph.nodes.back());
-        task_namespace.graph.nodes.pop_back();
-      }
-
       // Task is not ready to run if dependencies are not yet satisfied.
       if (node.dependencies)
         continue;
@@ -269,8 +328,7 @@ void TaskGraphRunner::SetTaskGraph(NamespaceToken token, TaskGraph* graph) {
         continue;
 
       // Skip if already running.
-      if (std::find(running_tasks_.begin(), running_tasks_.end(), node.task) !=
-          running_tasks_.end())
+      if (IsRunning(node.task))
         continue;
 
       task_namespace.ready_to_run_tasks.push_back(
@@ -286,19 +344,29 @@ void TaskGraphRunner::SetTaskGraph(NamespaceToken token, TaskGraph* graph) {
     // Swap task graph.
     task_namespace.graph.Swap(graph);
 
-    // Determine what tasks in old graph need to be canceled.
+    // Determine what tasks in old graph need to be canceled. As both graphs
+    // are sorted, the tasks left out of the new graph are found in one pass.
+    TaskGraph::Node::Vector::const_iterator new_it =
+        task_namespace.graph.nodes.begin();
     for (TaskGraph::Node::Vector::iterator it = graph->nodes.begin();
          it != graph->nodes.end();
          ++it) {
       TaskGraph::Node& node = *it;
 
+      // Skip if still part of the new graph.
+      while (new_it != task_namespace.graph.nodes.end() &&
+             new_it->task < node.task)
+        ++new_it;
+      if (new_it != task_namespace.graph.nodes.end() &&
+          new_it->task == node.task)
+        continue;
+
       // Skip if already finished running task.
       if (node.task->HasFinishedRunning())
         continue;
 
       // Skip if already running.
-      if (std::find(running_tasks_.begin(), running_tasks_.end(), node.task) !=
-          running_tasks_.end())
+      if (IsRunning(node.task))
         continue;
 
       DCHECK(std::find(task_namespace.completed_tasks.begin(),
@@ -403,6 +471,17 @@ void TaskGraphRunner::RunTaskWithLockAcquired(int thread_index) {
                 CompareTaskNamespacePriority);
   TaskNamespace* task_namespace = ready_to_run_namespaces_.back();
   ready_to_run_namespaces_.pop_back();
+
+  DCHECK_LT(static_cast<size_t>(thread_index), running_tasks_.size());
+  RunTaskInNamespaceWithLockAcquired(
+      task_namespace, thread_index, &running_tasks_[thread_index]);
+}
+
+void TaskGraphRunner::RunTaskInNamespaceWithLockAcquired(
+    TaskNamespace* task_namespace,
+    int thread_index,
+    const Task** running_task) {
+  lock_.AssertAcquired();
   DCHECK(!task_namespace->ready_to_run_tasks.empty());
 
   // Take top priority task from |ready_to_run_tasks|.
@@ -422,9 +501,8 @@ void TaskGraphRunner::RunTaskWithLockAcquired(int thread_index) {
   }
 
   // Add task to |running_tasks_|.
-  DCHECK_LT(static_cast<size_t>(thread_index), running_tasks_.size());
-  DCHECK(!running_tasks_[thread_index]);
-  running_tasks_[thread_index] = task.get();
+  DCHECK(!*running_task);
+  *running_task = task.get();
 
   // Increment running task count for task namespace.
   task_namespace->num_running_tasks++;
@@ -449,7 +527,7 @@ void TaskGraphRunner::RunTaskWithLockAcquired(int thread_index) {
   task_namespace->num_running_tasks--;
 
   // Remove task from |running_tasks_|.
-  running_tasks_[thread_index] = NULL;
+  *running_task = NULL;
 
   // Now iterate over all dependents to decrement dependencies and check if they
   // are ready to run.
@@ -491,8 +569,19 @@ void TaskGraphRunner::RunTaskWithLockAcquired(int thread_index) {
   task_namespace->completed_tasks.push_back(task);
 
   // If namespace has finished running all tasks, wake up origin thread.
+  // Worker threads in RunAndWaitForTasksToFinishRunning() wait too, and
+  // don't pass the signal on, so wake up all of them.
   if (HasFinishedRunningTasksInNamespace(task_namespace))
-    has_namespaces_with_finished_running_tasks_cv_.Signal();
+    has_namespaces_with_finished_running_tasks_cv_.Broadcast();
+}
+
+bool TaskGraphRunner::IsRunning(const Task* task) const {
+  lock_.AssertAcquired();
+  return std::find(running_tasks_.begin(), running_tasks_.end(), task) !=
+             running_tasks_.end() ||
+         std::find(nested_running_tasks_.begin(),
+                   nested_running_tasks_.end(),
+                   task) != nested_running_tasks_.end();
 }
 
 }  // namespace internal
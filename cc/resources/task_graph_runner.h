@@ -122,6 +122,14 @@ class CC_EXPORT TaskGraphRunner : public base::DelegateSimpleThread::Delegate {
   // Wait for all scheduled tasks to finish running.
   void WaitForTasksToFinishRunning(NamespaceToken token);
 
+  // Like WaitForTasksToFinishRunning(), but called by a task running on
+  // worker thread |thread_index|, which runs the tasks of |token| itself
+  // while other worker threads may pick them up too. This lets a task split
+  // its work into tasks that run in parallel and wait for them without
+  // stalling the thread. Tasks run this way must not do so themselves.
+  void RunAndWaitForTasksToFinishRunning(NamespaceToken token,
+                                         unsigned thread_index);
+
   // Collect all completed tasks in |completed_tasks|.
   void CollectCompletedTasks(NamespaceToken token,
                              Task::Vector* completed_tasks);
@@ -147,7 +155,8 @@ class CC_EXPORT TaskGraphRunner : public base::DelegateSimpleThread::Delegate {
     TaskNamespace();
     ~TaskNamespace();
 
-    // Current task graph.
+    // Current task graph. Its nodes and edges are kept sorted by task, so
+    // that nodes and the dependents of a task can be found by binary search.
     TaskGraph graph;
 
     // Ordered set of tasks that are ready to run.
@@ -193,6 +202,15 @@ class CC_EXPORT TaskGraphRunner : public base::DelegateSimpleThread::Delegate {
   // function and make sure at least one task is ready to run.
   void RunTaskWithLockAcquired(int thread_index);
 
+  // Run next task of |task_namespace|, which has been taken out of
+  // |ready_to_run_namespaces_| and has at least one task ready to run.
+  // |running_task| is the slot that holds the task while it runs.
+  void RunTaskInNamespaceWithLockAcquired(TaskNamespace* task_namespace,
+                                          int thread_index,
+                                          const Task** running_task);
+
+  bool IsRunning(const Task* task) const;
+
   // This lock protects all members of this class. Do not read or modify
   // anything without holding this lock. Do not block while holding this
   // lock.
@@ -223,6 +241,9 @@ class CC_EXPORT TaskGraphRunner : public base::DelegateSimpleThread::Delegate {
   // This set contains all currently running tasks.
   typedef std::vector<const Task*> TaskVector;
   TaskVector running_tasks_;
+  // Tasks run by RunAndWaitForTasksToFinishRunning(), while the task that
+  // called it stays in |running_tasks_|.
+  TaskVector nested_running_tasks_;
 
   // Set during shutdown. Tells workers to exit when no more tasks
   // are pending.
@@ -203,6 +203,11 @@ class TaskGraphRunnerPerfTest : public testing::Test {
       timer_.NextLap();
     } while (!timer_.HasTimeLimitExpired());
 
+    // The last graph refers to tasks which are about to be deleted.
+    internal::TaskGraph empty;
+    task_graph_runner_->SetTaskGraph(namespace_token_, &empty);
+    CollectCompletedTasks(&completed_tasks);
+
     perf_test::PrintResult("execute_tasks",
                            TestModifierString(),
                            test_name,
@@ -300,6 +305,7 @@ TEST_F(TaskGraphRunnerPerfTest, ScheduleTasks) {
   RunScheduleTasksTest("2_32_0", 2, 32, 0);
   RunScheduleTasksTest("2_1_1", 2, 1, 1);
   RunScheduleTasksTest("2_32_1", 2, 32, 1);
+  RunScheduleTasksTest("2_1024_1", 2, 1024, 1);
 }
 
 TEST_F(TaskGraphRunnerPerfTest, ScheduleAlternateTasks) {
@@ -309,6 +315,7 @@ TEST_F(TaskGraphRunnerPerfTest, ScheduleAlternateTasks) {
   RunScheduleAlternateTasksTest("2_32_0", 2, 32, 0);
   RunScheduleAlternateTasksTest("2_1_1", 2, 1, 1);
   RunScheduleAlternateTasksTest("2_32_1", 2, 32, 1);
+  RunScheduleAlternateTasksTest("2_1024_1", 2, 1024, 1);
 }
 
 TEST_F(TaskGraphRunnerPerfTest, ScheduleAndExecuteTasks) {
@@ -318,6 +325,7 @@ TEST_F(TaskGraphRunnerPerfTest, ScheduleAndExecuteTasks) {
   RunScheduleAndExecuteTasksTest("2_32_0", 2, 32, 0);
   RunScheduleAndExecuteTasksTest("2_1_1", 2, 1, 1);
   RunScheduleAndExecuteTasksTest("2_32_1", 2, 32, 1);
+  RunScheduleAndExecuteTasksTest("2_1024_1", 2, 1024, 1);
 }
 
 }  // namespace
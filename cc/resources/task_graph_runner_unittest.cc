@@ -149,6 +149,55 @@ class TaskGraphRunnerTestBase {
     DISALLOW_COPY_AND_ASSIGN(FakeDependentTaskImpl);
   };
 
+  // Runs |part_count| tasks with id |part_id| in parallel before itself.
+  class FakeSplitTaskImpl : public FakeTaskImpl {
+   public:
+    FakeSplitTaskImpl(TaskGraphRunnerTestBase* test,
+                      int namespace_index,
+                      int id,
+                      int part_id,
+                      size_t part_count)
+        : FakeTaskImpl(test, namespace_index, id),
+          test_(test),
+          namespace_index_(namespace_index),
+          part_id_(part_id),
+          part_count_(part_count) {}
+
+    // Overridden from FakeTaskImpl:
+    virtual void RunOnWorkerThread(unsigned thread_index) OVERRIDE {
+      internal::TaskGraphRunner* task_graph_runner =
+          test_->task_graph_runner_.get();
+      internal::NamespaceToken token = task_graph_runner->GetNamespaceToken();
+
+      internal::Task::Vector parts;
+      internal::TaskGraph graph;
+      for (size_t i = 0; i < part_count_; ++i) {
+        scoped_refptr<FakeTaskImpl> part(
+            new FakeTaskImpl(test_, namespace_index_, part_id_));
+        graph.nodes.push_back(internal::TaskGraph::Node(part.get(), 0u, 0u));
+        parts.push_back(part);
+      }
+      task_graph_runner->SetTaskGraph(token, &graph);
+      task_graph_runner->RunAndWaitForTasksToFinishRunning(token, thread_index);
+
+      internal::Task::Vector completed_tasks;
+      task_graph_runner->CollectCompletedTasks(token, &completed_tasks);
+      EXPECT_EQ(part_count_, completed_tasks.size());
+
+      FakeTaskImpl::RunOnWorkerThread(thread_index);
+    }
+
+   private:
+    virtual ~FakeSplitTaskImpl() {}
+
+    TaskGraphRunnerTestBase* test_;
+    int namespace_index_;
+    int part_id_;
+    size_t part_count_;
+
+    DISALLOW_COPY_AND_ASSIGN(FakeSplitTaskImpl);
+  };
+
   scoped_ptr<internal::TaskGraphRunner> task_graph_runner_;
   internal::NamespaceToken namespace_token_[kNamespaceCount];
   internal::Task::Vector tasks_[kNamespaceCount];
@@ -252,6 +301,31 @@ TEST_P(TaskGraphRunnerTest, Dependencies) {
   }
 }
 
+TEST_P(TaskGraphRunnerTest, SplitTasks) {
+  const size_t kPartCount = 4;
+  for (int i = 0; i < kNamespaceCount; ++i) {
+    scoped_refptr<FakeSplitTaskImpl> task(
+        new FakeSplitTaskImpl(this, i, 0u, 1u, kPartCount));
+    internal::TaskGraph graph;
+    graph.nodes.push_back(internal::TaskGraph::Node(task.get(), 0u, 0u));
+    task_graph_runner_->SetTaskGraph(namespace_token_[i], &graph);
+    tasks_[i].push_back(task);
+  }
+
+  for (int i = 0; i < kNamespaceCount; ++i) {
+    RunAllTasks(i);
+
+    // The parts ran before the task that split, and only the task that split
+    // is completed on the origin thread.
+    ASSERT_EQ(kPartCount + 1, run_task_ids(i).size());
+    for (size_t j = 0; j < kPartCount; ++j)
+      EXPECT_EQ(1u, run_task_ids(i)[j]);
+    EXPECT_EQ(0u, run_task_ids(i)[kPartCount]);
+    ASSERT_EQ(1u, on_task_completed_ids(i).size());
+    EXPECT_EQ(0u, on_task_completed_ids(i)[0]);
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(TaskGraphRunnerTests,
                         TaskGraphRunnerTest,
                         ::testing::Range(1, 5));
@@ -292,5 +366,56 @@ TEST_F(TaskGraphRunnerSingleThreadTest, Priority) {
   }
 }
 
+class TaskGraphRunnerNoThreadTest : public TaskGraphRunnerTestBase,
+                                    public testing::Test {
+ public:
+  // Overridden from testing::Test:
+  virtual void SetUp() OVERRIDE {
+    task_graph_runner_ =
+        make_scoped_ptr(new internal::TaskGraphRunner(0, "Test"));
+    for (int i = 0; i < kNamespaceCount; ++i)
+      namespace_token_[i] = task_graph_runner_->GetNamespaceToken();
+  }
+  virtual void TearDown() OVERRIDE { task_graph_runner_.reset(); }
+};
+
+TEST_F(TaskGraphRunnerNoThreadTest, Reschedule) {
+  const unsigned kNumTasks = 8;
+  scoped_refptr<FakeTaskImpl> tasks[kNumTasks];
+  internal::TaskGraph graph;
+  for (unsigned i = 0; i < kNumTasks; ++i) {
+    tasks[i] = new FakeTaskImpl(this, 0, i);
+    graph.nodes.push_back(internal::TaskGraph::Node(tasks[i].get(), i, 0u));
+  }
+  task_graph_runner_->SetTaskGraph(namespace_token_[0], &graph);
+
+  // Run the first task, then keep only the odd ones, in reverse order.
+  ASSERT_TRUE(task_graph_runner_->RunTaskForTesting());
+  graph.Reset();
+  for (unsigned i = kNumTasks; i > 0; --i) {
+    if (i % 2)
+      continue;
+    graph.nodes.push_back(
+        internal::TaskGraph::Node(tasks[i - 1].get(), i - 1, 0u));
+  }
+  task_graph_runner_->SetTaskGraph(namespace_token_[0], &graph);
+  while (task_graph_runner_->RunTaskForTesting())
+    continue;
+
+  // The even tasks, except the one which already ran, were canceled.
+  ASSERT_EQ(5u, run_task_ids(0).size());
+  EXPECT_EQ(0u, run_task_ids(0)[0]);
+  for (unsigned i = 1; i < 5; ++i)
+    EXPECT_EQ(i * 2 - 1, run_task_ids(0)[i]);
+  for (unsigned i = 2; i < kNumTasks; i += 2)
+    EXPECT_FALSE(tasks[i]->HasFinishedRunning());
+
+  // All tasks are completed, whether they ran or not.
+  internal::Task::Vector completed_tasks;
+  task_graph_runner_->CollectCompletedTasks(namespace_token_[0],
+                                            &completed_tasks);
+  EXPECT_EQ(kNumTasks, completed_tasks.size());
+}
+
 }  // namespace
 }  // namespace cc
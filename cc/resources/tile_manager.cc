@@ -227,12 +227,23 @@ TileManager::~TileManager() {
 }
 
 void TileManager::Release(Tile* tile) {
-  prioritized_tiles_dirty_ = true;
+  // Makes the next update drop the tile from |prioritized_tiles_| before it
+  // is deleted.
+  tile->managed_state().needs_rebinning = true;
   released_tiles_.push_back(tile);
 }
 
 void TileManager::DidChangeTilePriority(Tile* tile) {
-  prioritized_tiles_dirty_ = true;
+  MarkTileForRebinning(tile);
+}
+
+void TileManager::MarkTileForRebinning(Tile* tile) {
+  ManagedTileState& mts = tile->managed_state();
+  if (mts.needs_rebinning)
+    return;
+
+  mts.needs_rebinning = true;
+  tiles_that_need_rebinning_.push_back(tile->id());
 }
 
 bool TileManager::ShouldForceTasksRequiredForActivationToComplete() const {
@@ -246,6 +257,7 @@ void TileManager::CleanUpReleasedTiles() {
     Tile* tile = *it;
 
     FreeResourcesForTile(tile);
+    RemoveTileFromMemoryStats(tile);
 
     DCHECK(tiles_.find(tile->id()) != tiles_.end());
     tiles_.erase(tile->id());
@@ -265,13 +277,42 @@ void TileManager::CleanUpReleasedTiles() {
 }
 
 void TileManager::UpdatePrioritizedTileSetIfNeeded() {
-  if (!prioritized_tiles_dirty_)
+  if (!prioritized_tiles_dirty_ && tiles_that_need_rebinning_.empty() &&
+      released_tiles_.empty())
     return;
 
+  // Unless everything is re-binned, only the tiles whose bin inputs changed
+  // are taken out of the set and inserted again. This has to happen before
+  // released tiles are deleted.
+  if (!prioritized_tiles_dirty_)
+    prioritized_tiles_.RemoveTilesNeedingRebinning();
+
   CleanUpReleasedTiles();
 
-  prioritized_tiles_.Clear();
-  GetTilesWithAssignedBins(&prioritized_tiles_);
+  std::vector<Tile::Id> tile_ids;
+  tile_ids.swap(tiles_that_need_rebinning_);
+
+  if (prioritized_tiles_dirty_) {
+    prioritized_tiles_.Clear();
+    GetTilesWithAssignedBins(&prioritized_tiles_);
+  }
+
+  for (std::vector<Tile::Id>::iterator it = tile_ids.begin();
+       it != tile_ids.end();
+       ++it) {
+    // Released tiles are gone by now.
+    TileMap::iterator tile_it = tiles_.find(*it);
+    if (tile_it == tiles_.end())
+      continue;
+
+    Tile* tile = tile_it->second;
+    if (!prioritized_tiles_dirty_) {
+      RemoveTileFromMemoryStats(tile);
+      AssignBinToTile(tile, &prioritized_tiles_);
+    }
+    tile->managed_state().needs_rebinning = false;
+  }
+
   prioritized_tiles_dirty_ = false;
 }
 
@@ -316,8 +357,10 @@ void TileManager::DidFinishRunningTasks() {
       // If we can't raster on demand, give up early (and don't activate).
       if (!allow_rasterize_on_demand)
         return;
-      if (use_rasterize_on_demand_)
+      if (use_rasterize_on_demand_) {
         tile_version.set_rasterize_on_demand();
+        MarkTileForRebinning(tile);
+      }
     }
   }
 
@@ -343,122 +386,142 @@ void TileManager::GetTilesWithAssignedBins(PrioritizedTileSet* tiles) {
   memory_required_bytes_ = 0;
   memory_nice_to_have_bytes_ = 0;
 
-  const TileMemoryLimitPolicy memory_policy = global_state_.memory_limit_policy;
-  const TreePriority tree_priority = global_state_.tree_priority;
-
   // For each tree, bin into different categories of tiles.
   for (TileMap::const_iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
     Tile* tile = it->second;
-    ManagedTileState& mts = tile->managed_state();
+    tile->managed_state().gpu_memmgr_stats_bin = NEVER_BIN;
+    AssignBinToTile(tile, tiles);
+  }
+}
 
-    const ManagedTileState::TileVersion& tile_version =
-        tile->GetTileVersionForDrawing();
-    bool tile_is_ready_to_draw = tile_version.IsReadyToDraw();
-    bool tile_is_active = tile_is_ready_to_draw ||
-                          mts.tile_versions[mts.raster_mode].raster_task_;
-
-    // Get the active priority and bin.
-    TilePriority active_priority = tile->priority(ACTIVE_TREE);
-    ManagedTileBin active_bin = BinFromTilePriority(active_priority);
-
-    // Get the pending priority and bin.
-    TilePriority pending_priority = tile->priority(PENDING_TREE);
-    ManagedTileBin pending_bin = BinFromTilePriority(pending_priority);
-
-    bool pending_is_low_res = pending_priority.resolution == LOW_RESOLUTION;
-    bool pending_is_non_ideal =
-        pending_priority.resolution == NON_IDEAL_RESOLUTION;
-    bool active_is_non_ideal =
-        active_priority.resolution == NON_IDEAL_RESOLUTION;
-
-    // Adjust pending bin state for low res tiles. This prevents
-    // pending tree low-res tiles from being initialized before
-    // high-res tiles.
-    if (pending_is_low_res)
-      pending_bin = std::max(pending_bin, EVENTUALLY_BIN);
-
-    // Adjust bin state based on if ready to draw.
-    active_bin = kBinReadyToDrawMap[tile_is_ready_to_draw][active_bin];
-    pending_bin = kBinReadyToDrawMap[tile_is_ready_to_draw][pending_bin];
-
-    // Adjust bin state based on if active.
-    active_bin = kBinIsActiveMap[tile_is_active][active_bin];
-    pending_bin = kBinIsActiveMap[tile_is_active][pending_bin];
-
-    // We never want to paint new non-ideal tiles, as we always have
-    // a high-res tile covering that content (paint that instead).
-    if (!tile_is_ready_to_draw && active_is_non_ideal)
-      active_bin = NEVER_BIN;
-    if (!tile_is_ready_to_draw && pending_is_non_ideal)
-      pending_bin = NEVER_BIN;
-
-    // Compute combined bin.
-    ManagedTileBin combined_bin = std::min(active_bin, pending_bin);
-
-    if (!tile_is_ready_to_draw || tile_version.requires_resource()) {
-      // The bin that the tile would have if the GPU memory manager had
-      // a maximally permissive policy, send to the GPU memory manager
-      // to determine policy.
-      ManagedTileBin gpu_memmgr_stats_bin = combined_bin;
-      if ((gpu_memmgr_stats_bin == NOW_BIN) ||
-          (gpu_memmgr_stats_bin == NOW_AND_READY_TO_DRAW_BIN))
-        memory_required_bytes_ += BytesConsumedIfAllocated(tile);
-      if (gpu_memmgr_stats_bin != NEVER_BIN)
-        memory_nice_to_have_bytes_ += BytesConsumedIfAllocated(tile);
-    }
+void TileManager::AssignBinToTile(Tile* tile, PrioritizedTileSet* tiles) {
+  const TileMemoryLimitPolicy memory_policy = global_state_.memory_limit_policy;
+  const TreePriority tree_priority = global_state_.tree_priority;
 
-    ManagedTileBin tree_bin[NUM_TREES];
-    tree_bin[ACTIVE_TREE] = kBinPolicyMap[memory_policy][active_bin];
-    tree_bin[PENDING_TREE] = kBinPolicyMap[memory_policy][pending_bin];
-
-    TilePriority tile_priority;
-    switch (tree_priority) {
-      case SAME_PRIORITY_FOR_BOTH_TREES:
-        mts.bin = kBinPolicyMap[memory_policy][combined_bin];
-        tile_priority = tile->combined_priority();
-        break;
-      case SMOOTHNESS_TAKES_PRIORITY:
-        mts.bin = tree_bin[ACTIVE_TREE];
-        tile_priority = active_priority;
-        break;
-      case NEW_CONTENT_TAKES_PRIORITY:
-        mts.bin = tree_bin[PENDING_TREE];
-        tile_priority = pending_priority;
-        break;
-    }
+  ManagedTileState& mts = tile->managed_state();
 
-    // Bump up the priority if we determined it's NEVER_BIN on one tree,
-    // but is still required on the other tree.
-    bool is_in_never_bin_on_both_trees = tree_bin[ACTIVE_TREE] == NEVER_BIN &&
-                                         tree_bin[PENDING_TREE] == NEVER_BIN;
+  const ManagedTileState::TileVersion& tile_version =
+      tile->GetTileVersionForDrawing();
+  bool tile_is_ready_to_draw = tile_version.IsReadyToDraw();
+  bool tile_is_active = tile_is_ready_to_draw ||
+                        mts.tile_versions[mts.raster_mode].raster_task_;
+
+  // Get the active priority and bin.
+  TilePriority active_priority = tile->priority(ACTIVE_TREE);
+  ManagedTileBin active_bin = BinFromTilePriority(active_priority);
+
+  // Get the pending priority and bin.
+  TilePriority pending_priority = tile->priority(PENDING_TREE);
+  ManagedTileBin pending_bin = BinFromTilePriority(pending_priority);
+
+  bool pending_is_low_res = pending_priority.resolution == LOW_RESOLUTION;
+  bool pending_is_non_ideal =
+      pending_priority.resolution == NON_IDEAL_RESOLUTION;
+  bool active_is_non_ideal =
+      active_priority.resolution == NON_IDEAL_RESOLUTION;
+
+  // Adjust pending bin state for low res tiles. This prevents
+  // pending tree low-res tiles from being initialized before
+  // high-res tiles.
+  if (pending_is_low_res)
+    pending_bin = std::max(pending_bin, EVENTUALLY_BIN);
+
+  // Adjust bin state based on if ready to draw.
+  active_bin = kBinReadyToDrawMap[tile_is_ready_to_draw][active_bin];
+  pending_bin = kBinReadyToDrawMap[tile_is_ready_to_draw][pending_bin];
+
+  // Adjust bin state based on if active.
+  active_bin = kBinIsActiveMap[tile_is_active][active_bin];
+  pending_bin = kBinIsActiveMap[tile_is_active][pending_bin];
+
+  // We never want to paint new non-ideal tiles, as we always have
+  // a high-res tile covering that content (paint that instead).
+  if (!tile_is_ready_to_draw && active_is_non_ideal)
+    active_bin = NEVER_BIN;
+  if (!tile_is_ready_to_draw && pending_is_non_ideal)
+    pending_bin = NEVER_BIN;
+
+  // Compute combined bin.
+  ManagedTileBin combined_bin = std::min(active_bin, pending_bin);
+
+  // The bin that the tile would have if the GPU memory manager had
+  // a maximally permissive policy, send to the GPU memory manager
+  // to determine policy.
+  DCHECK_EQ(NEVER_BIN, mts.gpu_memmgr_stats_bin);
+  if (!tile_is_ready_to_draw || tile_version.requires_resource()) {
+    mts.gpu_memmgr_stats_bin = combined_bin;
+    if ((mts.gpu_memmgr_stats_bin == NOW_BIN) ||
+        (mts.gpu_memmgr_stats_bin == NOW_AND_READY_TO_DRAW_BIN))
+      memory_required_bytes_ += BytesConsumedIfAllocated(tile);
+    if (mts.gpu_memmgr_stats_bin != NEVER_BIN)
+      memory_nice_to_have_bytes_ += BytesConsumedIfAllocated(tile);
+  }
 
-    if (mts.bin == NEVER_BIN && !is_in_never_bin_on_both_trees)
-      mts.bin = tile_is_active ? AT_LAST_AND_ACTIVE_BIN : AT_LAST_BIN;
+  ManagedTileBin tree_bin[NUM_TREES];
+  tree_bin[ACTIVE_TREE] = kBinPolicyMap[memory_policy][active_bin];
+  tree_bin[PENDING_TREE] = kBinPolicyMap[memory_policy][pending_bin];
 
-    mts.resolution = tile_priority.resolution;
-    mts.priority_bin = tile_priority.priority_bin;
-    mts.distance_to_visible = tile_priority.distance_to_visible;
-    mts.required_for_activation = tile_priority.required_for_activation;
+  TilePriority tile_priority;
+  switch (tree_priority) {
+    case SAME_PRIORITY_FOR_BOTH_TREES:
+      mts.bin = kBinPolicyMap[memory_policy][combined_bin];
+      tile_priority = tile->combined_priority();
+      break;
+    case SMOOTHNESS_TAKES_PRIORITY:
+      mts.bin = tree_bin[ACTIVE_TREE];
+      tile_priority = active_priority;
+      break;
+    case NEW_CONTENT_TAKES_PRIORITY:
+      mts.bin = tree_bin[PENDING_TREE];
+      tile_priority = pending_priority;
+      break;
+  }
 
-    mts.visible_and_ready_to_draw =
-        tree_bin[ACTIVE_TREE] == NOW_AND_READY_TO_DRAW_BIN;
+  // Bump up the priority if we determined it's NEVER_BIN on one tree,
+  // but is still required on the other tree.
+  bool is_in_never_bin_on_both_trees = tree_bin[ACTIVE_TREE] == NEVER_BIN &&
+                                       tree_bin[PENDING_TREE] == NEVER_BIN;
 
-    if (mts.bin == NEVER_BIN) {
-      FreeResourcesForTile(tile);
-      continue;
-    }
+  if (mts.bin == NEVER_BIN && !is_in_never_bin_on_both_trees)
+    mts.bin = tile_is_active ? AT_LAST_AND_ACTIVE_BIN : AT_LAST_BIN;
+
+  mts.resolution = tile_priority.resolution;
+  mts.priority_bin = tile_priority.priority_bin;
+  mts.distance_to_visible = tile_priority.distance_to_visible;
+  mts.required_for_activation = tile_priority.required_for_activation;
 
-    // Note that if the tile is visible_and_ready_to_draw, then we always want
-    // the priority to be NOW_AND_READY_TO_DRAW_BIN, even if HIGH_PRIORITY_BIN
-    // is something different. The reason for this is that if we're prioritizing
-    // the pending tree, we still want visible tiles to take the highest
-    // priority.
-    ManagedTileBin priority_bin =
-        mts.visible_and_ready_to_draw ? NOW_AND_READY_TO_DRAW_BIN : mts.bin;
+  mts.visible_and_ready_to_draw =
+      tree_bin[ACTIVE_TREE] == NOW_AND_READY_TO_DRAW_BIN;
 
-    // Insert the tile into a priority set.
-    tiles->InsertTile(tile, priority_bin);
+  if (mts.bin == NEVER_BIN) {
+    FreeResourcesForTile(tile);
+    return;
   }
+
+  // Note that if the tile is visible_and_ready_to_draw, then we always want
+  // the priority to be NOW_AND_READY_TO_DRAW_BIN, even if HIGH_PRIORITY_BIN
+  // is something different. The reason for this is that if we're prioritizing
+  // the pending tree, we still want visible tiles to take the highest
+  // priority.
+  ManagedTileBin priority_bin =
+      mts.visible_and_ready_to_draw ? NOW_AND_READY_TO_DRAW_BIN : mts.bin;
+
+  // Insert the tile into a priority set.
+  tiles->InsertTile(tile, priority_bin);
+}
+
+void TileManager::RemoveTileFromMemoryStats(Tile* tile) {
+  ManagedTileState& mts = tile->managed_state();
+  if ((mts.gpu_memmgr_stats_bin == NOW_BIN) ||
+      (mts.gpu_memmgr_stats_bin == NOW_AND_READY_TO_DRAW_BIN)) {
+    DCHECK_GE(memory_required_bytes_, BytesConsumedIfAllocated(tile));
+    memory_required_bytes_ -= BytesConsumedIfAllocated(tile);
+  }
+  if (mts.gpu_memmgr_stats_bin != NEVER_BIN) {
+    DCHECK_GE(memory_nice_to_have_bytes_, BytesConsumedIfAllocated(tile));
+    memory_nice_to_have_bytes_ -= BytesConsumedIfAllocated(tile);
+  }
+  mts.gpu_memmgr_stats_bin = NEVER_BIN;
 }
 
 void TileManager::ManageTiles(const GlobalStateThatImpactsTilePriority& state) {
@@ -647,7 +710,11 @@ void TileManager::AssignGpuMemoryToTiles(
 
     mts.scheduled_priority = schedule_priority++;
 
-    mts.raster_mode = DetermineRasterMode(tile);
+    RasterMode raster_mode = DetermineRasterMode(tile);
+    if (raster_mode != mts.raster_mode) {
+      mts.raster_mode = raster_mode;
+      MarkTileForRebinning(tile);
+    }
 
     ManagedTileState::TileVersion& tile_version =
         mts.tile_versions[mts.raster_mode];
@@ -698,8 +765,10 @@ void TileManager::AssignGpuMemoryToTiles(
       // This tile was already on screen and now its resources have been
       // released. In order to prevent checkerboarding, set this tile as
       // rasterize on demand immediately.
-      if (mts.visible_and_ready_to_draw && use_rasterize_on_demand_)
+      if (mts.visible_and_ready_to_draw && use_rasterize_on_demand_) {
         tile_version.set_rasterize_on_demand();
+        MarkTileForRebinning(tile);
+      }
 
       oomed_soft = true;
       if (tile_uses_hard_limit) {
@@ -767,6 +836,8 @@ void TileManager::FreeResourceForTile(Tile* tile, RasterMode mode) {
 
     bytes_releasable_ -= BytesConsumedIfAllocated(tile);
     --resources_releasable_;
+
+    MarkTileForRebinning(tile);
   }
 }
 
@@ -818,8 +889,10 @@ void TileManager::ScheduleTasks(
     DCHECK(tile_version.requires_resource());
     DCHECK(!tile_version.resource_);
 
-    if (!tile_version.raster_task_)
+    if (!tile_version.raster_task_) {
       tile_version.raster_task_ = CreateRasterTask(tile);
+      MarkTileForRebinning(tile);
+    }
 
     size_t pool_type = tile->use_gpu_rasterization()
                            ? RASTER_WORKER_POOL_TYPE_DIRECT
@@ -947,6 +1020,7 @@ void TileManager::OnRasterTaskCompleted(
   ManagedTileState::TileVersion& tile_version = mts.tile_versions[raster_mode];
   DCHECK(tile_version.raster_task_);
   tile_version.raster_task_ = NULL;
+  MarkTileForRebinning(tile);
 
   if (was_canceled) {
     ++update_visible_tiles_stats_.canceled_count;
@@ -994,7 +1068,7 @@ scoped_refptr<Tile> TileManager::CreateTile(PicturePileImpl* picture_pile,
 
   tiles_[tile->id()] = tile;
   used_layer_counts_[tile->layer_id()]++;
-  prioritized_tiles_dirty_ = true;
+  MarkTileForRebinning(tile.get());
   return tile;
 }
 
@@ -99,6 +99,8 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
 
       bytes_releasable_ += BytesConsumedIfAllocated(tiles[i]);
       ++resources_releasable_;
+
+      MarkTileForRebinning(tiles[i]);
     }
   }
 
@@ -150,6 +152,7 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
   void AssignGpuMemoryToTiles(PrioritizedTileSet* tiles,
                               TileVector* tiles_that_need_to_be_rasterized);
   void GetTilesWithAssignedBins(PrioritizedTileSet* tiles);
+  void AssignBinToTile(Tile* tile, PrioritizedTileSet* tiles);
 
  private:
   enum RasterWorkerPoolType {
@@ -182,6 +185,9 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
   scoped_refptr<internal::RasterWorkerPoolTask> CreateRasterTask(Tile* tile);
   scoped_ptr<base::Value> GetMemoryRequirementsAsValue() const;
   void UpdatePrioritizedTileSetIfNeeded();
+  // Makes the next update re-bin |tile|, instead of all tiles.
+  void MarkTileForRebinning(Tile* tile);
+  void RemoveTileFromMemoryStats(Tile* tile);
 
   TileManagerClient* client_;
   ContextProvider* context_provider_;
@@ -195,7 +201,9 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
   TileMap tiles_;
 
   PrioritizedTileSet prioritized_tiles_;
+  // Set when every tile has to be re-binned.
   bool prioritized_tiles_dirty_;
+  std::vector<Tile::Id> tiles_that_need_rebinning_;
 
   bool all_tiles_that_need_to_be_rasterized_have_memory_;
   bool all_tiles_required_for_activation_have_memory_;
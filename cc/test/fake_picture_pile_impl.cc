@@ -79,6 +79,7 @@ void FakePicturePileImpl::AddRecordingAt(int x, int y) {
       Picture::Create(bounds, &client_, tile_grid_info_, true, 0));
   picture_map_[std::pair<int, int>(x, y)].SetPicture(picture);
   EXPECT_TRUE(HasRecordingAt(x, y));
+  InvalidateAnalysis(bounds);
 
   UpdateRecordedRegion();
 }
@@ -93,6 +94,7 @@ void FakePicturePileImpl::RemoveRecordingAt(int x, int y) {
     return;
   picture_map_.erase(std::pair<int, int>(x, y));
   EXPECT_FALSE(HasRecordingAt(x, y));
+  InvalidateAnalysis(PaddedRect(std::pair<int, int>(x, y)));
 
   UpdateRecordedRegion();
 }
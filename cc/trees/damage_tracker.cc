@@ -135,12 +135,15 @@ void DamageTracker::UpdateDamageTrackingState(
   if (target_surface_property_changed_only_from_descendant) {
     damage_rect_for_this_update = target_surface_content_rect;
   } else {
-    // TODO(shawnsingh): can we clamp this damage to the surface's content rect?
-    // (affects performance, but not correctness)
     damage_rect_for_this_update = damage_from_active_layers;
     damage_rect_for_this_update.Union(damage_from_surface_mask);
     damage_rect_for_this_update.Union(damage_from_leftover_rects);
 
+    // Pixels outside the surface's content rect are never drawn, so damage
+    // there would only grow the damage of the ancestor surfaces and the
+    // partial swap rect, e.g. when a layer moves within a clipped scroller.
+    damage_rect_for_this_update.Intersect(target_surface_content_rect);
+
     if (filters.HasReferenceFilter()) {
       // TODO(senorblanco):  Once SkImageFilter reports its outsets, use
       // those here to limit damage.
@@ -399,6 +399,25 @@ TEST_F(DamageTrackerTest, VerifyDamageForPerspectiveClippedLayer) {
   EXPECT_TRUE(root_damage_rect.Contains(damage_we_care_about));
 }
 
+TEST_F(DamageTrackerTest, VerifyDamageIsClampedToSurface) {
+  scoped_ptr<LayerImpl> root = CreateAndSetUpTestTreeWithOneSurface();
+  LayerImpl* child = root->children()[0];
+
+  // Move the child so that it hangs over the edge of the root surface.
+  ClearDamageForAllSurfaces(root.get());
+  child->SetPosition(gfx::PointF(450.f, 450.f));
+  child->SetBounds(gfx::Size(100, 100));
+  child->SetContentBounds(gfx::Size(100, 100));
+  EmulateDrawingOneFrame(root.get());
+
+  // The damage covers the old child rect and the part of the new one inside
+  // the surface, but none of the pixels outside the surface.
+  gfx::RectF root_damage_rect =
+      root->render_surface()->damage_tracker()->current_damage_rect();
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(100.f, 100.f, 400.f, 400.f),
+                       root_damage_rect);
+}
+
 TEST_F(DamageTrackerTest, VerifyDamageForBlurredSurface) {
   scoped_ptr<LayerImpl> root = CreateAndSetUpTestTreeWithTwoSurfaces();
   LayerImpl* surface = root->children()[0];
@@ -17,6 +17,64 @@
 
 namespace cc {
 
+namespace {
+
+// Occlusion regions of complex pages can fragment into hundreds of rects,
+// which makes every query against them slow.  Beyond this many rects, new
+// occlusion is only kept if it covers more area than the region itself.
+const int kMaxOcclusionRegionComplexity = 64;
+
+int64 RegionArea(const Region& region) {
+  int64 area = 0;
+  for (Region::Iterator rects(region); rects.has_rect(); rects.next())
+    area += static_cast<int64>(rects.rect().width()) * rects.rect().height();
+  return area;
+}
+
+// Adds |rect| to |occlusion|.  Dropping occlusion is always safe, so when the
+// union would be too complex, only the larger of |occlusion| and |rect| is
+// kept.
+void AddOcclusion(Region* occlusion, const gfx::Rect& rect) {
+  if (occlusion->Contains(rect))
+    return;
+
+  Region united = *occlusion;
+  united.Union(rect);
+  if (united.GetRegionComplexity() <= kMaxOcclusionRegionComplexity) {
+    occlusion->Swap(&united);
+    return;
+  }
+
+  int64 rect_area = static_cast<int64>(rect.width()) * rect.height();
+  if (rect_area > RegionArea(*occlusion))
+    *occlusion = rect;
+}
+
+// Returns the bounds of |rect| minus |occlusion| and |other_occlusion|.  The
+// occlusion is usually a single rect, and then rect arithmetic gives the same
+// result without building any Region.
+gfx::Rect UnoccludedBounds(const gfx::Rect& rect,
+                           const Region& occlusion,
+                           const Region& other_occlusion) {
+  if (other_occlusion.IsEmpty() && occlusion.GetRegionComplexity() <= 1) {
+    gfx::Rect unoccluded = rect;
+    unoccluded.Subtract(occlusion.bounds());
+    return unoccluded;
+  }
+  if (occlusion.IsEmpty() && other_occlusion.GetRegionComplexity() <= 1) {
+    gfx::Rect unoccluded = rect;
+    unoccluded.Subtract(other_occlusion.bounds());
+    return unoccluded;
+  }
+
+  Region unoccluded = rect;
+  unoccluded.Subtract(occlusion);
+  unoccluded.Subtract(other_occlusion);
+  return unoccluded.bounds();
+}
+
+}  // namespace
+
 template <typename LayerType, typename RenderSurfaceType>
 OcclusionTrackerBase<LayerType, RenderSurfaceType>::OcclusionTrackerBase(
     const gfx::Rect& screen_space_clip_rect, bool record_metrics_for_frame)
@@ -83,8 +141,6 @@ static Region TransformSurfaceOpaqueRegion(
   if (!transform.Preserves2dAxisAlignment())
     return Region();
 
-  // TODO(danakj): If the Region is too complex, degrade gracefully here by
-  // skipping rects in it.
   Region transformed_region;
   for (Region::Iterator rects(region); rects.has_rect(); rects.next()) {
     bool clipped;
@@ -95,7 +151,7 @@ static Region TransformSurfaceOpaqueRegion(
     DCHECK(!clipped);  // We only map if the transform preserves axis alignment.
     if (have_clip_rect)
       transformed_rect.Intersect(clip_rect_in_new_target);
-    transformed_region.Union(transformed_rect);
+    AddOcclusion(&transformed_region, transformed_rect);
   }
   return transformed_region;
 }
@@ -450,7 +506,8 @@ void OcclusionTrackerBase<LayerType, RenderSurfaceType>::
     if (transformed_rect.width() < minimum_tracking_size_.width() &&
         transformed_rect.height() < minimum_tracking_size_.height())
       continue;
-    stack_.back().occlusion_from_inside_target.Union(transformed_rect);
+    AddOcclusion(&stack_.back().occlusion_from_inside_target,
+                 transformed_rect);
 
     if (!occluding_screen_space_rects_)
       continue;
@@ -529,18 +586,11 @@ bool OcclusionTrackerBase<LayerType, RenderSurfaceType>::Occluded(
 
   // Take the ToEnclosingRect at each step, as we want to contain any unoccluded
   // partial pixels in the resulting Rect.
-  Region unoccluded_region_in_target_surface =
-      MathUtil::MapEnclosingClippedRect(draw_transform, content_rect);
-  unoccluded_region_in_target_surface.Subtract(
-      stack_.back().occlusion_from_inside_target);
-  gfx::RectF unoccluded_rect_in_target_surface_without_outside_occlusion =
-      unoccluded_region_in_target_surface.bounds();
-  unoccluded_region_in_target_surface.Subtract(
+  gfx::Rect unoccluded_rect_in_target_surface = UnoccludedBounds(
+      MathUtil::MapEnclosingClippedRect(draw_transform, content_rect),
+      stack_.back().occlusion_from_inside_target,
       stack_.back().occlusion_from_outside_target);
 
-  gfx::RectF unoccluded_rect_in_target_surface =
-      unoccluded_region_in_target_surface.bounds();
-
   return unoccluded_rect_in_target_surface.IsEmpty();
 }
 
@@ -578,15 +628,10 @@ gfx::Rect OcclusionTrackerBase<LayerType, RenderSurfaceType>::
 
   // Take the ToEnclosingRect at each step, as we want to contain any unoccluded
   // partial pixels in the resulting Rect.
-  Region unoccluded_region_in_target_surface =
-      MathUtil::MapEnclosingClippedRect(draw_transform, content_rect);
-  unoccluded_region_in_target_surface.Subtract(
-      stack_.back().occlusion_from_inside_target);
-  unoccluded_region_in_target_surface.Subtract(
+  gfx::Rect unoccluded_rect_in_target_surface = UnoccludedBounds(
+      MathUtil::MapEnclosingClippedRect(draw_transform, content_rect),
+      stack_.back().occlusion_from_inside_target,
       stack_.back().occlusion_from_outside_target);
-
-  gfx::Rect unoccluded_rect_in_target_surface =
-      unoccluded_region_in_target_surface.bounds();
   gfx::Rect unoccluded_rect = MathUtil::ProjectEnclosingClippedRect(
       inverse_draw_transform, unoccluded_rect_in_target_surface);
   unoccluded_rect.Intersect(content_rect);
@@ -635,29 +680,30 @@ gfx::Rect OcclusionTrackerBase<LayerType, RenderSurfaceType>::
 
   // Take the ToEnclosingRect at each step, as we want to contain any unoccluded
   // partial pixels in the resulting Rect.
-  Region unoccluded_region_in_target_surface =
+  gfx::Rect unoccluded_rect_in_target_surface =
       MathUtil::MapEnclosingClippedRect(draw_transform, content_rect);
   // Layers can't clip across surfaces, so count this as internal occlusion.
   if (surface->is_clipped())
-    unoccluded_region_in_target_surface.Intersect(surface->clip_rect());
-  if (has_occlusion) {
-    const StackObject& second_last = stack_[stack_.size() - 2];
-    unoccluded_region_in_target_surface.Subtract(
-        second_last.occlusion_from_inside_target);
-    unoccluded_region_in_target_surface.Subtract(
-        second_last.occlusion_from_outside_target);
-  }
+    unoccluded_rect_in_target_surface.Intersect(surface->clip_rect());
 
-  // Treat other clipping as occlusion from outside the target surface.
-  unoccluded_region_in_target_surface.Intersect(
+  // Treat other clipping as occlusion from outside the target surface.  It is
+  // applied before subtracting the occlusion, which gives the same result
+  // while keeping the subtraction to a rect.
+  unoccluded_rect_in_target_surface.Intersect(
       contributing_surface_render_target->render_surface()->content_rect());
-  unoccluded_region_in_target_surface.Intersect(
+  unoccluded_rect_in_target_surface.Intersect(
       ScreenSpaceClipRectInTargetSurface(
           contributing_surface_render_target->render_surface(),
           screen_space_clip_rect_));
 
-  gfx::Rect unoccluded_rect_in_target_surface =
-      unoccluded_region_in_target_surface.bounds();
+  if (has_occlusion) {
+    const StackObject& second_last = stack_[stack_.size() - 2];
+    unoccluded_rect_in_target_surface =
+        UnoccludedBounds(unoccluded_rect_in_target_surface,
+                         second_last.occlusion_from_inside_target,
+                         second_last.occlusion_from_outside_target);
+  }
+
   gfx::Rect unoccluded_rect = MathUtil::ProjectEnclosingClippedRect(
       inverse_draw_transform, unoccluded_rect_in_target_surface);
   unoccluded_rect.Intersect(content_rect);
@@ -209,5 +209,84 @@ TEST_F(OcclusionTrackerPerfTest, UnoccludedContentRect_10OpaqueLayers) {
   PrintResults();
 }
 
+TEST_F(OcclusionTrackerPerfTest, UnoccludedContentRect_FragmentedOcclusion) {
+  static const int kLayerSize = 24;
+  static const int kLayerSpacing = 32;
+  SetTestName("unoccluded_content_rect_fragmented_occlusion");
+
+  gfx::Rect viewport_rect(768, 1038);
+  OcclusionTrackerBase<LayerImpl, LayerImpl::RenderSurfaceType> tracker(
+      viewport_rect, false);
+
+  CreateHost();
+  host_impl_->SetViewportSize(viewport_rect.size());
+
+  // A grid of small opaque layers with gaps between them, so that their
+  // occlusion fragments into many rects.
+  int num_opaque_layers = 0;
+  for (int x = 0; x < viewport_rect.width(); x += kLayerSpacing) {
+    for (int y = 0; y < viewport_rect.height(); y += kLayerSpacing) {
+      scoped_ptr<SolidColorLayerImpl> opaque_layer =
+          SolidColorLayerImpl::Create(active_tree(), 2 + num_opaque_layers);
+      opaque_layer->SetBackgroundColor(SK_ColorRED);
+      opaque_layer->SetContentsOpaque(true);
+      opaque_layer->SetDrawsContent(true);
+      opaque_layer->SetBounds(gfx::Size(kLayerSize, kLayerSize));
+      opaque_layer->SetContentBounds(gfx::Size(kLayerSize, kLayerSize));
+      opaque_layer->SetPosition(gfx::Point(x, y));
+      active_tree()->root_layer()->AddChild(opaque_layer.PassAs<LayerImpl>());
+      ++num_opaque_layers;
+    }
+  }
+
+  active_tree()->UpdateDrawProperties();
+  const LayerImplList& rsll = active_tree()->RenderSurfaceLayerList();
+  ASSERT_EQ(1u, rsll.size());
+  EXPECT_EQ(static_cast<size_t>(num_opaque_layers),
+            rsll[0]->render_surface()->layer_list().size());
+
+  LayerIterator<LayerImpl> begin = LayerIterator<LayerImpl>::Begin(&rsll);
+  LayerIterator<LayerImpl> end = LayerIterator<LayerImpl>::End(&rsll);
+
+  // The opaque_layers add occlusion.
+  for (int i = 0; i < num_opaque_layers - 1; ++i) {
+    LayerIteratorPosition<LayerImpl> pos = begin;
+    tracker.EnterLayer(pos);
+    tracker.LeaveLayer(pos);
+    ++begin;
+  }
+  LayerIteratorPosition<LayerImpl> pos = begin;
+  tracker.EnterLayer(pos);
+  tracker.LeaveLayer(pos);
+
+  gfx::Transform transform_to_target;
+  transform_to_target.Translate(0, 96);
+  bool impl_draw_transform_is_unknown = false;
+
+  do {
+    for (int x = 0; x < viewport_rect.width(); x += 256) {
+      for (int y = 0; y < viewport_rect.height(); y += 256) {
+        gfx::Rect query_content_rect(x, y, 256, 256);
+        gfx::Rect unoccluded =
+            tracker.UnoccludedContentRect(pos.target_render_surface_layer,
+                                          query_content_rect,
+                                          transform_to_target,
+                                          impl_draw_transform_is_unknown);
+      }
+    }
+
+    timer_.NextLap();
+  } while (!timer_.HasTimeLimitExpired());
+
+  ++begin;
+  LayerIteratorPosition<LayerImpl> next = begin;
+  EXPECT_EQ(active_tree()->root_layer(), next.current_layer);
+
+  ++begin;
+  EXPECT_EQ(end, begin);
+
+  PrintResults();
+}
+
 }  // namespace
 }  // namespace cc
@@ -1890,6 +1890,61 @@ class OcclusionTrackerTestOpaqueContentsRegionNonEmpty
 
 MAIN_AND_IMPL_THREAD_TEST(OcclusionTrackerTestOpaqueContentsRegionNonEmpty);
 
+template <class Types>
+class OcclusionTrackerTestFragmentedOcclusionIsSimplified
+    : public OcclusionTrackerTest<Types> {
+ protected:
+  explicit OcclusionTrackerTestFragmentedOcclusionIsSimplified(
+      bool opaque_layers)
+      : OcclusionTrackerTest<Types>(opaque_layers) {}
+  void RunMyTest() {
+    typename Types::ContentLayerType* parent = this->CreateRoot(
+        this->identity_matrix, gfx::PointF(), gfx::Size(400, 400));
+    // A large layer behind the others.
+    typename Types::ContentLayerType* background =
+        this->CreateDrawingLayer(parent,
+                                 this->identity_matrix,
+                                 gfx::PointF(),
+                                 gfx::Size(300, 300),
+                                 true);
+    // A grid of small layers with gaps between them, whose occlusion would
+    // be a region of 400 rects.
+    std::vector<typename Types::ContentLayerType*> layers;
+    for (int y = 0; y < 20; ++y) {
+      for (int x = 0; x < 20; ++x) {
+        layers.push_back(this->CreateDrawingLayer(parent,
+                                                  this->identity_matrix,
+                                                  gfx::PointF(20.f * x,
+                                                              20.f * y),
+                                                  gfx::Size(10, 10),
+                                                  true));
+      }
+    }
+    this->CalcDrawEtc(parent);
+
+    TestOcclusionTrackerWithClip<typename Types::LayerType,
+                                 typename Types::RenderSurfaceType> occlusion(
+        gfx::Rect(0, 0, 1000, 1000));
+    for (size_t i = layers.size(); i > 0; --i)
+      this->VisitLayer(layers[i - 1], &occlusion);
+
+    // The region is kept simple by dropping some of the occlusion, which
+    // can only leave more content to draw.
+    EXPECT_LE(occlusion.occlusion_from_inside_target().GetRegionComplexity(),
+              64);
+    EXPECT_FALSE(occlusion.occlusion_from_inside_target().IsEmpty());
+    EXPECT_FALSE(occlusion.OccludedLayer(background, gfx::Rect(10, 10, 10, 10)));
+
+    // Occlusion covering more than the fragmented region replaces it.
+    this->VisitLayer(background, &occlusion);
+    this->EnterLayer(parent, &occlusion);
+    EXPECT_TRUE(occlusion.OccludedLayer(parent, gfx::Rect(0, 0, 300, 300)));
+    EXPECT_FALSE(occlusion.OccludedLayer(parent, gfx::Rect(310, 0, 10, 10)));
+  }
+};
+
+MAIN_AND_IMPL_THREAD_TEST(OcclusionTrackerTestFragmentedOcclusionIsSimplified);
+
 template <class Types>
 class OcclusionTrackerTest3dTransform : public OcclusionTrackerTest<Types> {
  protected:
@@ -884,8 +884,10 @@ void BrowsingDataRemover::DoClearCache(int rv) {
                 base::Bind(&BrowsingDataRemover::DoClearCache,
                            base::Unretained(this)));
           } else {
-            rv = cache_->DoomEntriesBetween(
+            // Clearing in batches lets the cache serve requests meanwhile.
+            rv = cache_->DoomEntriesBetweenWithProgress(
                 delete_begin_, delete_end_,
+                disk_cache::Backend::ProgressCallback(),
                 base::Bind(&BrowsingDataRemover::DoClearCache,
                            base::Unretained(this)));
           }
@@ -208,14 +208,14 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     HistoryIDVector history_ids;
     std::copy(history_id_set.begin(), history_id_set.end(),
               std::back_inserter(history_ids));
-    // Trim down the set by sorting by typed-count, visit-count, and last
-    // visit.
+    // Trim down the set by typed-count, visit-count, and last visit. The
+    // survivors go back into a set, so their relative order doesn't matter.
     HistoryItemFactorGreater
         item_factor_functor(history_info_map_);
-    std::partial_sort(history_ids.begin(),
-                      history_ids.begin() + kItemsToScoreLimit,
-                      history_ids.end(),
-                      item_factor_functor);
+    std::nth_element(history_ids.begin(),
+                     history_ids.begin() + kItemsToScoreLimit,
+                     history_ids.end(),
+                     item_factor_functor);
     history_id_set.clear();
     std::copy(history_ids.begin(), history_ids.begin() + kItemsToScoreLimit,
               std::inserter(history_id_set, history_id_set.end()));
@@ -245,9 +245,16 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     // but this is such a rare edge case that it's not worth the time.
     return scored_items;
   }
-  scored_items = std::for_each(history_id_set.begin(), history_id_set.end(),
-      AddHistoryMatch(*this, languages, bookmark_service, lower_raw_string,
-                      lower_raw_terms, base::Time::Now())).ScoredMatches();
+  // Score the candidates with a single functor, rather than through
+  // std::for_each(), which returns the functor (and all of the matches it
+  // collected) by value.
+  AddHistoryMatch add_history_match(*this, languages, bookmark_service,
+                                    lower_raw_string, lower_raw_terms,
+                                    base::Time::Now());
+  for (HistoryIDSet::const_iterator iter = history_id_set.begin();
+       iter != history_id_set.end(); ++iter)
+    add_history_match(*iter);
+  add_history_match.TakeScoredMatches(&scored_items);
 
   // Select and sort only the top kMaxMatches results.
   if (scored_items.size() > AutocompleteProvider::kMaxMatches) {
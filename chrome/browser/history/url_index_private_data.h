@@ -205,7 +205,10 @@ class URLIndexPrivateData
 
     void operator()(const HistoryID history_id);
 
-    ScoredHistoryMatches ScoredMatches() const { return scored_matches_; }
+    // Moves the matches collected so far into |matches|.
+    void TakeScoredMatches(ScoredHistoryMatches* matches) {
+      matches->swap(scored_matches_);
+    }
 
    private:
     const URLIndexPrivateData& private_data_;
@@ -57,6 +57,7 @@
 #include "net/cert/ct_known_logs.h"
 #include "net/cert/ct_verifier.h"
 #include "net/cert/multi_threaded_cert_verifier.h"
+#include "net/cert/shared_cert_verifier_cache.h"
 #include "net/cookies/cookie_store.h"
 #include "net/dns/host_cache.h"
 #include "net/dns/host_resolver.h"
@@ -187,6 +188,19 @@ scoped_ptr<net::HostResolver> CreateGlobalHostResolver(net::NetLog* net_log) {
     }
   }
 
+  // Use the stale cache entry age from the command-line, if any.
+  if (command_line.HasSwitch(switches::kHostResolverMaxStaleAge)) {
+    std::string s =
+        command_line.GetSwitchValueASCII(switches::kHostResolverMaxStaleAge);
+    // Parse the switch (it should be a non-negative number of seconds).
+    int n;
+    if (base::StringToInt(s, &n) && n >= 0) {
+      options.max_stale_age = base::TimeDelta::FromSeconds(n);
+    } else {
+      LOG(ERROR) << "Invalid switch for host resolver max stale age: " << s;
+    }
+  }
+
   scoped_ptr<net::HostResolver> global_host_resolver(
       net::HostResolver::CreateSystemResolver(options, net_log));
 
@@ -573,8 +587,13 @@ void IOThread::InitAsync() {
   } else  // NOLINT Fallthrough to normal verifier if multiprofiles not allowed.
 #endif
   {
-    globals_->cert_verifier.reset(new net::MultiThreadedCertVerifier(
-        net::CertVerifyProc::CreateDefault()));
+    net::MultiThreadedCertVerifier* cert_verifier =
+        new net::MultiThreadedCertVerifier(
+            net::CertVerifyProc::CreateDefault());
+    // Everything using the default roots shares its results.
+    cert_verifier->SetSharedCache(
+        net::SharedCertVerifierCache::GetInstance());
+    globals_->cert_verifier.reset(cert_verifier);
   }
   globals_->transport_security_state.reset(new net::TransportSecurityState());
 #if !defined(USE_OPENSSL)
@@ -1084,6 +1103,16 @@ void IOThread::InitSystemRequestContextOnIOThread() {
 
   sdch_manager_->set_sdch_fetcher(
       new SdchDictionaryFetcher(system_url_request_context_getter_.get()));
+  if (command_line.HasSwitch(switches::kSdchPrefetchDictionaries)) {
+    std::vector<std::string> urls;
+    base::SplitString(
+        command_line.GetSwitchValueASCII(switches::kSdchPrefetchDictionaries),
+        ',', &urls);
+    std::vector<GURL> dictionary_urls;
+    for (size_t i = 0; i < urls.size(); ++i)
+      dictionary_urls.push_back(GURL(urls[i]));
+    sdch_manager_->PrefetchDictionaries(dictionary_urls);
+  }
 }
 
 void IOThread::UpdateDnsClientEnabled() {
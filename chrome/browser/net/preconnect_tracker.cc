@@ -0,0 +1,174 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/preconnect_tracker.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/values.h"
+#include "net/base/net_log.h"
+
+namespace chrome_browser_net {
+
+namespace {
+
+const char* OutcomeToString(PreconnectTracker::Outcome outcome) {
+  switch (outcome) {
+    case PreconnectTracker::PRECONNECT_USED:
+      return "used";
+    case PreconnectTracker::PRECONNECT_UNUSED:
+      return "unused";
+    case PreconnectTracker::PRECONNECT_MISSED:
+      return "missed";
+    case PreconnectTracker::PRECONNECT_OUTCOME_MAX:
+      break;
+  }
+  NOTREACHED();
+  return "";
+}
+
+base::Value* NetLogPreconnectOutcomeCallback(
+    const GURL* url,
+    UrlInfo::ResolutionMotivation motivation,
+    int count,
+    PreconnectTracker::Outcome outcome,
+    net::NetLog::LogLevel /* log_level */) {
+  base::DictionaryValue* dict = new base::DictionaryValue();
+  dict->SetString("url", url->possibly_invalid_spec());
+  dict->SetString("outcome", OutcomeToString(outcome));
+  if (outcome != PreconnectTracker::PRECONNECT_MISSED) {
+    dict->SetInteger("motivation", motivation);
+    dict->SetInteger("count", count);
+  }
+  return dict;
+}
+
+}  // namespace
+
+PreconnectTracker::Preconnect::Preconnect(
+    const GURL& url,
+    const GURL& first_party_for_cookies,
+    UrlInfo::ResolutionMotivation motivation,
+    int count)
+    : url(url),
+      first_party_for_cookies(first_party_for_cookies),
+      motivation(motivation),
+      count(count) {
+}
+
+PreconnectTracker::Preconnect::~Preconnect() {}
+
+PreconnectTracker::Entry::Entry(base::TimeTicks timestamp,
+                                const GURL& first_party_for_cookies,
+                                UrlInfo::ResolutionMotivation motivation,
+                                int count)
+    : timestamp(timestamp),
+      first_party_for_cookies(first_party_for_cookies),
+      motivation(motivation),
+      count(count),
+      was_used(count == 0) {
+}
+
+PreconnectTracker::PreconnectTracker(const base::TimeDelta& max_unused_lifetime,
+                                     net::NetLog* net_log)
+    : entries_(Entries::NO_AUTO_EVICT),
+      max_unused_lifetime_(max_unused_lifetime),
+      net_log_(net_log) {
+  for (int i = 0; i < PRECONNECT_OUTCOME_MAX; ++i)
+    outcome_counts_[i] = 0;
+}
+
+PreconnectTracker::~PreconnectTracker() {}
+
+void PreconnectTracker::ObservePreconnect(
+    const GURL& url,
+    const GURL& first_party_for_cookies,
+    UrlInfo::ResolutionMotivation motivation,
+    int count,
+    base::TimeTicks now) {
+  DCHECK_GT(count, 0);
+  EvictStaleEntries(now);
+
+  // A host which was just fetched from has live sockets of its own, so there
+  // is nothing to learn from preconnecting it again.
+  Entries::iterator it = entries_.Peek(url);
+  if (it != entries_.end()) {
+    if (it->second.count == 0)
+      return;
+    // Otherwise a repeated preconnect replaces the earlier one, as the socket
+    // pool tops up the same idle sockets rather than opening |count| more.
+    // The earlier one is reported now, so that it isn't lost.
+    if (!it->second.was_used)
+      RecordOutcome(url, it->second, PRECONNECT_UNUSED);
+  }
+  entries_.Put(url, Entry(now, first_party_for_cookies, motivation, count));
+}
+
+void PreconnectTracker::ObserveRequest(const GURL& url,
+                                       bool is_subresource,
+                                       base::TimeTicks now) {
+  EvictStaleEntries(now);
+
+  Entries::iterator it = entries_.Peek(url);
+  if (it != entries_.end()) {
+    if (!it->second.was_used) {
+      it->second.was_used = true;
+      RecordOutcome(url, it->second, PRECONNECT_USED);
+    }
+    return;
+  }
+
+  if (!is_subresource)
+    return;
+  Entry missed(now, GURL(), UrlInfo::NO_PREFETCH_MOTIVATION, 0);
+  RecordOutcome(url, missed, PRECONNECT_MISSED);
+  entries_.Put(url, missed);
+}
+
+void PreconnectTracker::GetUnusedPreconnects(
+    base::TimeTicks now,
+    PreconnectList* preconnects) const {
+  for (Entries::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    if (now - it->second.timestamp >= max_unused_lifetime_)
+      break;
+    if (it->second.was_used)
+      continue;
+    preconnects->push_back(Preconnect(it->first,
+                                      it->second.first_party_for_cookies,
+                                      it->second.motivation,
+                                      it->second.count));
+  }
+}
+
+void PreconnectTracker::EvictStaleEntries(base::TimeTicks now) {
+  Entries::reverse_iterator eldest = entries_.rbegin();
+  while (eldest != entries_.rend()) {
+    if (now - eldest->second.timestamp < max_unused_lifetime_)
+      break;
+    if (!eldest->second.was_used)
+      RecordOutcome(eldest->first, eldest->second, PRECONNECT_UNUSED);
+    eldest = entries_.Erase(eldest);
+  }
+}
+
+void PreconnectTracker::RecordOutcome(const GURL& url,
+                                      const Entry& entry,
+                                      Outcome outcome) {
+  ++outcome_counts_[outcome];
+  UMA_HISTOGRAM_ENUMERATION("Net.PreconnectOutcome", outcome,
+                            PRECONNECT_OUTCOME_MAX);
+  if (outcome == PRECONNECT_UNUSED) {
+    UMA_HISTOGRAM_COUNTS_100("Net.PreconnectUnusedSocketCount", entry.count);
+  }
+  if (net_log_) {
+    net_log_->AddGlobalEntry(
+        net::NetLog::TYPE_PREDICTOR_PRECONNECT_OUTCOME,
+        base::Bind(&NetLogPreconnectOutcomeCallback, &url, entry.motivation,
+                   entry.count, outcome));
+  }
+}
+
+}  // namespace chrome_browser_net
@@ -0,0 +1,124 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// PreconnectTracker remembers the preconnects the Predictor made during the
+// last few seconds, so that it can tell whether each one was put to use
+// (a hit), went stale unused (over-preconnecting), or whether a host had to be
+// connected to without a preconnect (a miss, or cold start).  Outcomes are
+// reported to UMA and to the NetLog.  The remembered preconnects can also be
+// replayed, e.g. to re-warm connections after a network change closed them.
+
+#ifndef CHROME_BROWSER_NET_PRECONNECT_TRACKER_H_
+#define CHROME_BROWSER_NET_PRECONNECT_TRACKER_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "base/time/time.h"
+#include "chrome/browser/net/url_info.h"
+#include "url/gurl.h"
+
+namespace net {
+class NetLog;
+}
+
+namespace chrome_browser_net {
+
+class PreconnectTracker {
+ public:
+  enum Outcome {
+    // The host was fetched from before the preconnected sockets went stale.
+    PRECONNECT_USED,
+    // The preconnected sockets went stale without a fetch from the host.
+    PRECONNECT_UNUSED,
+    // A subresource host was fetched from without having been preconnected.
+    PRECONNECT_MISSED,
+    PRECONNECT_OUTCOME_MAX
+  };
+
+  // A preconnect which has not been used yet.
+  struct Preconnect {
+    Preconnect(const GURL& url,
+               const GURL& first_party_for_cookies,
+               UrlInfo::ResolutionMotivation motivation,
+               int count);
+    ~Preconnect();
+
+    GURL url;
+    GURL first_party_for_cookies;
+    UrlInfo::ResolutionMotivation motivation;
+    int count;
+  };
+  typedef std::vector<Preconnect> PreconnectList;
+
+  // Preconnects are forgotten once they are older than |max_unused_lifetime|,
+  // as servers will have closed the idle sockets by then.  |net_log| may be
+  // NULL.
+  PreconnectTracker(const base::TimeDelta& max_unused_lifetime,
+                    net::NetLog* net_log);
+  ~PreconnectTracker();
+
+  // Records that |count| sockets were preconnected to |url| at |now|.  This
+  // replaces an earlier preconnect to |url|, which is reported as unused if
+  // nothing was fetched from it.
+  void ObservePreconnect(const GURL& url,
+                         const GURL& first_party_for_cookies,
+                         UrlInfo::ResolutionMotivation motivation,
+                         int count,
+                         base::TimeTicks now);
+
+  // Records a request to |url| at |now|.  Only subresource requests count as
+  // misses, as main frame navigations are not predicted from referrers.
+  void ObserveRequest(const GURL& url, bool is_subresource,
+                      base::TimeTicks now);
+
+  // Appends to |preconnects| those preconnects which are neither used nor
+  // stale at |now|.
+  void GetUnusedPreconnects(base::TimeTicks now,
+                            PreconnectList* preconnects) const;
+
+  // Forgets all preconnects and requests without reporting them.
+  void Clear() { entries_.Clear(); }
+
+  // Used for testing.
+  int outcome_count(Outcome outcome) const { return outcome_counts_[outcome]; }
+
+ private:
+  struct Entry {
+    Entry(base::TimeTicks timestamp,
+          const GURL& first_party_for_cookies,
+          UrlInfo::ResolutionMotivation motivation,
+          int count);
+
+    base::TimeTicks timestamp;
+    GURL first_party_for_cookies;
+    UrlInfo::ResolutionMotivation motivation;
+    // The number of sockets preconnected, or zero for a host which was fetched
+    // from without a preconnect.
+    int count;
+    bool was_used;
+  };
+  typedef base::MRUCache<GURL, Entry> Entries;
+
+  // Drops the entries which are stale at |now|, reporting unused preconnects.
+  void EvictStaleEntries(base::TimeTicks now);
+
+  void RecordOutcome(const GURL& url, const Entry& entry, Outcome outcome);
+
+  // Most recently preconnected or requested first.
+  Entries entries_;
+
+  const base::TimeDelta max_unused_lifetime_;
+
+  net::NetLog* net_log_;
+
+  int outcome_counts_[PRECONNECT_OUTCOME_MAX];
+
+  DISALLOW_COPY_AND_ASSIGN(PreconnectTracker);
+};
+
+}  // namespace chrome_browser_net
+
+#endif  // CHROME_BROWSER_NET_PRECONNECT_TRACKER_H_
@@ -0,0 +1,133 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/preconnect_tracker.h"
+
+#include "net/base/capturing_net_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_browser_net {
+
+namespace {
+
+const int kLifetimeSeconds = 10;
+
+class PreconnectTrackerTest : public testing::Test {
+ protected:
+  PreconnectTrackerTest()
+      : tracker_(base::TimeDelta::FromSeconds(kLifetimeSeconds), &net_log_),
+        now_(base::TimeTicks::Now()),
+        url_("http://a.com/"),
+        other_url_("http://b.com/"),
+        first_party_("http://first.com/") {
+  }
+
+  void Preconnect(const GURL& url, int count) {
+    tracker_.ObservePreconnect(url, first_party_,
+                               UrlInfo::LEARNED_REFERAL_MOTIVATED, count, now_);
+  }
+
+  void AdvanceSeconds(int seconds) {
+    now_ += base::TimeDelta::FromSeconds(seconds);
+  }
+
+  net::CapturingNetLog net_log_;
+  PreconnectTracker tracker_;
+  base::TimeTicks now_;
+  const GURL url_;
+  const GURL other_url_;
+  const GURL first_party_;
+};
+
+TEST_F(PreconnectTrackerTest, UsedPreconnect) {
+  Preconnect(url_, 2);
+  AdvanceSeconds(1);
+  tracker_.ObserveRequest(url_, true, now_);
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_USED));
+
+  // Once used, later requests and going stale aren't counted again.
+  tracker_.ObserveRequest(url_, true, now_);
+  AdvanceSeconds(kLifetimeSeconds);
+  tracker_.ObserveRequest(other_url_, false, now_);
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_USED));
+  EXPECT_EQ(0, tracker_.outcome_count(PreconnectTracker::PRECONNECT_UNUSED));
+
+  net::CapturingNetLog::CapturedEntryList entries;
+  net_log_.GetEntries(&entries);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(net::NetLog::TYPE_PREDICTOR_PRECONNECT_OUTCOME, entries[0].type);
+  std::string outcome;
+  EXPECT_TRUE(entries[0].GetStringValue("outcome", &outcome));
+  EXPECT_EQ("used", outcome);
+  int count = 0;
+  EXPECT_TRUE(entries[0].GetIntegerValue("count", &count));
+  EXPECT_EQ(2, count);
+}
+
+TEST_F(PreconnectTrackerTest, StalePreconnectIsUnused) {
+  Preconnect(url_, 1);
+  AdvanceSeconds(kLifetimeSeconds);
+  tracker_.ObserveRequest(url_, true, now_);
+  EXPECT_EQ(0, tracker_.outcome_count(PreconnectTracker::PRECONNECT_USED));
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_UNUSED));
+  // The sockets were gone, so the request went out cold.
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_MISSED));
+}
+
+TEST_F(PreconnectTrackerTest, MissedSubresource) {
+  tracker_.ObserveRequest(url_, true, now_);
+  tracker_.ObserveRequest(url_, true, now_);
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_MISSED));
+
+  // Main frames aren't predicted from referrers, so they can't be missed.
+  tracker_.ObserveRequest(other_url_, false, now_);
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_MISSED));
+
+  // Preconnecting a host which is already connected is ignored.
+  Preconnect(url_, 1);
+  PreconnectTracker::PreconnectList unused;
+  tracker_.GetUnusedPreconnects(now_, &unused);
+  EXPECT_TRUE(unused.empty());
+}
+
+TEST_F(PreconnectTrackerTest, RepeatedPreconnectReplacesEarlierOne) {
+  Preconnect(url_, 1);
+  AdvanceSeconds(kLifetimeSeconds - 1);
+  Preconnect(url_, 3);
+  AdvanceSeconds(kLifetimeSeconds - 1);
+  // The replaced preconnect went unused; the one replacing it was used.
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_UNUSED));
+  tracker_.ObserveRequest(url_, true, now_);
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_USED));
+  EXPECT_EQ(1, tracker_.outcome_count(PreconnectTracker::PRECONNECT_UNUSED));
+}
+
+TEST_F(PreconnectTrackerTest, GetUnusedPreconnects) {
+  Preconnect(url_, 2);
+  AdvanceSeconds(kLifetimeSeconds / 2);
+  Preconnect(other_url_, 1);
+  Preconnect(GURL("http://c.com/"), 1);
+  tracker_.ObserveRequest(GURL("http://c.com/"), true, now_);
+
+  PreconnectTracker::PreconnectList unused;
+  tracker_.GetUnusedPreconnects(now_, &unused);
+  ASSERT_EQ(2u, unused.size());
+  EXPECT_EQ(other_url_, unused[0].url);
+  EXPECT_EQ(1, unused[0].count);
+  EXPECT_EQ(url_, unused[1].url);
+  EXPECT_EQ(2, unused[1].count);
+  EXPECT_EQ(first_party_, unused[1].first_party_for_cookies);
+  EXPECT_EQ(UrlInfo::LEARNED_REFERAL_MOTIVATED, unused[1].motivation);
+
+  // Stale preconnects aren't returned.
+  AdvanceSeconds(kLifetimeSeconds / 2);
+  unused.clear();
+  tracker_.GetUnusedPreconnects(now_, &unused);
+  ASSERT_EQ(1u, unused.size());
+  EXPECT_EQ(other_url_, unused[0].url);
+}
+
+}  // namespace
+
+}  // namespace chrome_browser_net
@@ -25,7 +25,9 @@
 #include "base/time/time.h"
 #include "base/values.h"
 #include "chrome/browser/io_thread.h"
+#include "chrome/browser/net/chrome_net_log.h"
 #include "chrome/browser/net/preconnect.h"
+#include "chrome/browser/net/preconnect_tracker.h"
 #include "chrome/browser/net/spdyproxy/data_reduction_proxy_settings.h"
 #include "chrome/browser/net/spdyproxy/proxy_advisor.h"
 #include "chrome/browser/prefs/session_startup_pref.h"
@@ -516,6 +518,8 @@ void Predictor::Shutdown() {
   DCHECK(!shutdown_);
   shutdown_ = true;
 
+  net::NetworkChangeNotifier::RemoveIPAddressObserver(this);
+
   STLDeleteElements(&pending_lookups_);
 }
 
@@ -523,6 +527,8 @@ void Predictor::DiscardAllResults() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   // Delete anything listed so far in this session that shows in about:dns.
   referrers_.clear();
+  if (preconnect_tracker_)
+    preconnect_tracker_->Clear();
 
 
   // Try to delete anything in our work queue.
@@ -808,6 +814,9 @@ void Predictor::FinalizeInitializationOnIOThread(
   initial_observer_.reset(new InitialObserver());
   host_resolver_ = io_thread->globals()->host_resolver.get();
   preconnect_usage_.reset(new PreconnectUsage());
+  preconnect_tracker_.reset(new PreconnectTracker(
+      TimeDelta::FromSeconds(kMaxUnusedSocketLifetimeSecondsWithoutAGet),
+      io_thread->net_log()));
 
   // base::WeakPtrFactory instances need to be created and destroyed
   // on the same thread. The predictor lives on the IO thread and will die
@@ -816,6 +825,8 @@ void Predictor::FinalizeInitializationOnIOThread(
   // TODO(groby): Check if WeakPtrFactory has the same constraint.
   weak_factory_.reset(new base::WeakPtrFactory<Predictor>(this));
 
+  net::NetworkChangeNotifier::AddIPAddressObserver(this);
+
   // Prefetch these hostnames on startup.
   DnsPrefetchMotivatedList(startup_urls, UrlInfo::STARTUP_LIST_MOTIVATED);
   DeserializeReferrersThenDelete(referral_list);
@@ -991,6 +1002,12 @@ void Predictor::PreconnectUrlOnIOThread(
   if (motivation == UrlInfo::MOUSE_OVER_MOTIVATED)
     RecordPreconnectTrigger(url);
 
+  if (preconnect_tracker_) {
+    preconnect_tracker_->ObservePreconnect(url, first_party_for_cookies,
+                                           motivation, count,
+                                           base::TimeTicks::Now());
+  }
+
   AdviseProxy(url, motivation, true /* is_preconnect */);
 
   PreconnectOnIOThread(url,
@@ -1013,6 +1030,12 @@ void Predictor::RecordPreconnectNavigationStat(
 
   if (preconnect_usage_)
     preconnect_usage_->ObserveNavigationChain(url_chain, is_subresource);
+
+  if (preconnect_tracker_ && !url_chain.empty()) {
+    preconnect_tracker_->ObserveRequest(CanonicalizeUrl(url_chain.back()),
+                                        is_subresource,
+                                        base::TimeTicks::Now());
+  }
 }
 
 void Predictor::RecordLinkNavigation(const GURL& url) {
@@ -1021,6 +1044,19 @@ void Predictor::RecordLinkNavigation(const GURL& url) {
     preconnect_usage_->ObserveLinkNavigation(url);
 }
 
+void Predictor::OnIPAddressChanged() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (shutdown_ || !preconnect_enabled_ ||
+      net::NetworkChangeNotifier::IsOffline()) {
+    return;
+  }
+  // Observers are all notified from the same task, so the socket pools will
+  // have closed their sockets by the time this runs.
+  base::MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&Predictor::RewarmPreconnects, weak_factory_->GetWeakPtr()));
+}
+
 void Predictor::PredictFrameSubresources(const GURL& url,
                                          const GURL& first_party_for_cookies) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI) ||
@@ -1061,6 +1097,25 @@ void Predictor::AdviseProxy(const GURL& url,
   }
 }
 
+void Predictor::RewarmPreconnects() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (shutdown_ || !predictor_enabled_ || !preconnect_tracker_)
+    return;
+  PreconnectTracker::PreconnectList preconnects;
+  preconnect_tracker_->GetUnusedPreconnects(base::TimeTicks::Now(),
+                                            &preconnects);
+  UMA_HISTOGRAM_COUNTS_100("Net.PreconnectRewarmedAfterIPChange",
+                           preconnects.size());
+  // The preconnects are replayed without going through the tracker again, so
+  // that re-warming doesn't extend how long they are waited on to be used.
+  for (PreconnectTracker::PreconnectList::const_iterator it =
+           preconnects.begin();
+       it != preconnects.end(); ++it) {
+    PreconnectOnIOThread(it->url, it->first_party_for_cookies, it->motivation,
+                         it->count, url_request_context_getter_.get());
+  }
+}
+
 enum SubresourceValue {
   PRECONNECTION,
   PRERESOLUTION,
@@ -34,6 +34,7 @@
 #include "chrome/browser/net/url_info.h"
 #include "chrome/common/net/predictor_common.h"
 #include "net/base/host_port_pair.h"
+#include "net/base/network_change_notifier.h"
 
 class IOThread;
 class PrefService;
@@ -59,13 +60,15 @@ typedef chrome_common_net::UrlList UrlList;
 typedef chrome_common_net::NameList NameList;
 typedef std::map<GURL, UrlInfo> Results;
 
+class PreconnectTracker;
+
 // Predictor is constructed during Profile construction (on the UI thread),
 // but it is destroyed on the IO thread when ProfileIOData goes away. All of
 // its core state and functionality happens on the IO thread. The only UI
 // methods are initialization / shutdown related (including preconnect
 // initialization), or convenience methods that internally forward calls to
 // the IO thread.
-class Predictor {
+class Predictor : public net::NetworkChangeNotifier::IPAddressObserver {
  public:
   // A version number for prefs that are saved. This should be incremented when
   // we change the format so that we discard old data.
@@ -246,6 +249,11 @@ class Predictor {
 
   void RecordLinkNavigation(const GURL& url);
 
+  // net::NetworkChangeNotifier::IPAddressObserver implementation.
+  // A change of network flushes the socket pools, so preconnects which
+  // haven't been used yet are made again on the new network.
+  virtual void OnIPAddressChanged() OVERRIDE;
+
   // ------------- End IO thread methods.
 
   // The following methods may be called on either the IO or UI threads.
@@ -481,6 +489,11 @@ class Predictor {
                              UrlInfo::ResolutionMotivation motivation,
                              bool is_preconnect);
 
+  // Preconnects again to the hosts which were preconnected to before the
+  // network changed, but not used yet.  Posted by OnIPAddressChanged() so
+  // that it runs after the socket pools have been flushed.
+  void RewarmPreconnects();
+
   // ------------- End IO thread methods.
 
   scoped_ptr<InitialObserver> initial_observer_;
@@ -540,6 +553,10 @@ class Predictor {
   class PreconnectUsage;
   scoped_ptr<PreconnectUsage> preconnect_usage_;
 
+  // Tracks whether the preconnects made by the predictor are used, to report
+  // hit and miss rates and to know what to preconnect after network changes.
+  scoped_ptr<PreconnectTracker> preconnect_tracker_;
+
   // For each URL that we might navigate to (that we've "learned about")
   // we have a Referrer list. Each Referrer list has all hostnames we might
   // need to pre-resolve or pre-connect to when there is a navigation to the
@@ -13,6 +13,7 @@
 #include "base/bind_helpers.h"
 #include "base/callback.h"
 #include "base/command_line.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/metrics/histogram.h"
@@ -81,7 +82,8 @@ static const int kInitialDelayTimerMS = 100;
 // tabs. New tabs are loaded after the current tab finishes loading, or a delay
 // is reached (initially kInitialDelayTimerMS). If the delay is reached before
 // a tab finishes loading a new tab is loaded and the time of the delay
-// doubled.
+// doubled. If the system reports memory pressure, the tabs that have not
+// started loading yet are left unloaded; they get loaded when selected.
 //
 // TabLoader keeps a reference to itself when it's loading. When it has finished
 // loading, it drops the reference. If another profile is restored while the
@@ -144,6 +146,11 @@ class TabLoader : public content::NotificationObserver,
   // |LoadNextTab| to load the next tab
   void ForceLoadTimerFired();
 
+  // Invoked from |memory_pressure_listener_|. Drops the tabs that have not
+  // started loading, so that they are only loaded once selected.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
   // Returns the RenderWidgetHost associated with a tab if there is one,
   // NULL otherwise.
   static RenderWidgetHost* GetRenderWidgetHost(NavigationController* tab);
@@ -184,6 +191,9 @@ class TabLoader : public content::NotificationObserver,
 
   base::OneShotTimer<TabLoader> force_load_timer_;
 
+  // Listens for memory pressure while tabs are being restored.
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
   // The time the restore process started.
   base::TimeTicks restore_started_;
 
@@ -255,6 +265,8 @@ TabLoader::TabLoader(base::TimeTicks restore_started)
       tab_count_(0),
       restore_started_(restore_started),
       max_parallel_tab_loads_(0) {
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&TabLoader::OnMemoryPressure, base::Unretained(this))));
 }
 
 TabLoader::~TabLoader() {
@@ -429,6 +441,27 @@ void TabLoader::ForceLoadTimerFired() {
   LoadNextTab();
 }
 
+void TabLoader::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  if (tabs_to_load_.empty())
+    return;
+
+  // The tabs stay in their tab strips with |needs_reload| set, so
+  // NavigationController loads them when they become active.
+  UMA_HISTOGRAM_COUNTS_100("SessionRestore.TabsDeferredByMemoryPressure",
+                           tabs_to_load_.size());
+  force_load_timer_.Stop();
+  while (!tabs_to_load_.empty())
+    RemoveTab(tabs_to_load_.front());
+
+  // Sends NOTIFICATION_SESSION_RESTORE_DONE now that the queue is empty.
+  LoadNextTab();
+
+  if ((got_first_paint_ || render_widget_hosts_to_paint_.empty()) &&
+      tabs_loading_.empty())
+    this_retainer_ = NULL;
+}
+
 RenderWidgetHost* TabLoader::GetRenderWidgetHost(NavigationController* tab) {
   WebContents* web_contents = tab->GetWebContents();
   if (web_contents) {
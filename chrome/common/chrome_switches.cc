@@ -940,6 +940,10 @@ const char kHomePage[]                      = "homepage";
 // proxy connection, and the endpoint host in a SOCKS proxy connection).
 const char kHostRules[]                     = "host-rules";
 
+// How many seconds after expiring a cached host resolution may still be used
+// while it is refreshed in the background. Not set or zero disables this.
+const char kHostResolverMaxStaleAge[]       = "host-resolver-max-stale-age";
+
 // The maximum number of concurrent host resolve requests (i.e. DNS) to allow
 // (not counting backup attempts which would also consume threads).
 // --host-resolver-retry-attempts must be set to zero for this to be exact.
@@ -1308,6 +1312,10 @@ const char kSbDisableSideEffectFreeWhitelist[] =
 // URL to send safebrowsing download feedback reports to.
 const char kSbDownloadFeedbackURL[] = "safebrowsing-download-feedback-url";
 
+// Comma-separated list of SDCH dictionary URLs to fetch at startup, so that
+// the first responses from those servers can already be SDCH encoded.
+const char kSdchPrefetchDictionaries[]      = "sdch-prefetch-dictionaries";
+
 // Causes the process to run as a service process.
 const char kServiceProcess[]                = "service";
 
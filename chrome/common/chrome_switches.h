@@ -260,6 +260,7 @@ extern const char kHistoryEnableGroupByDomain[];
 extern const char kHistoryWebHistoryUrl[];
 extern const char kHomePage[];
 extern const char kHostRules[];
+extern const char kHostResolverMaxStaleAge[];
 extern const char kHostResolverParallelism[];
 extern const char kHostResolverRetryAttempts[];
 extern const char kIgnoreUrlFetcherCertRequests[];
@@ -351,6 +352,7 @@ extern const char kSbDisableDownloadProtection[];
 extern const char kSbDisableExtensionBlacklist[];
 extern const char kSbDisableSideEffectFreeWhitelist[];
 extern const char kSbDownloadFeedbackURL[];
+extern const char kSdchPrefetchDictionaries[];
 extern const char kServiceProcess[];
 extern const char kSilentDebuggerExtensionAPI[];
 extern const char kSilentLaunch[];
@@ -49,19 +49,22 @@ AutofillRegexes::~AutofillRegexes() {
 }
 
 icu::RegexMatcher* AutofillRegexes::GetMatcher(const base::string16& pattern) {
-  if (!matchers_.count(pattern)) {
-    const icu::UnicodeString icu_pattern(pattern.data(), pattern.length());
+  // The patterns are long, so compare against them only once per lookup.
+  std::map<base::string16, icu::RegexMatcher*>::iterator it =
+      matchers_.lower_bound(pattern);
+  if (it != matchers_.end() && it->first == pattern)
+    return it->second;
 
-    UErrorCode status = U_ZERO_ERROR;
-    icu::RegexMatcher* matcher = new icu::RegexMatcher(icu_pattern,
-                                                       UREGEX_CASE_INSENSITIVE,
-                                                       status);
-    DCHECK(U_SUCCESS(status));
+  const icu::UnicodeString icu_pattern(pattern.data(), pattern.length());
 
-    matchers_.insert(std::make_pair(pattern, matcher));
-  }
+  UErrorCode status = U_ZERO_ERROR;
+  icu::RegexMatcher* matcher = new icu::RegexMatcher(icu_pattern,
+                                                     UREGEX_CASE_INSENSITIVE,
+                                                     status);
+  DCHECK(U_SUCCESS(status));
 
-  return matchers_[pattern];
+  matchers_.insert(it, std::make_pair(pattern, matcher));
+  return matcher;
 }
 
 }  // namespace
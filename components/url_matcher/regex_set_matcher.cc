@@ -31,6 +31,8 @@ void RegexSetMatcher::AddPatterns(
 }
 
 void RegexSetMatcher::ClearPatterns() {
+  if (regexes_.empty())
+    return;
   regexes_.clear();
   RebuildMatcher();
 }
@@ -47,8 +49,8 @@ bool RegexSetMatcher::Match(const std::string& text,
 
   // FilteredRE2 expects lowercase for prefiltering, but we still
   // match case-sensitively.
-  std::vector<RE2ID> atoms(FindSubstringMatches(
-      StringToLowerASCII(text)));
+  std::vector<RE2ID> atoms;
+  FindSubstringMatches(StringToLowerASCII(text), &atoms);
 
   std::vector<RE2ID> re2_ids;
   filtered_re2_->AllMatches(text, atoms, &re2_ids);
@@ -64,11 +66,12 @@ bool RegexSetMatcher::IsEmpty() const {
   return regexes_.empty();
 }
 
-std::vector<RegexSetMatcher::RE2ID> RegexSetMatcher::FindSubstringMatches(
-    const std::string& text) const {
+void RegexSetMatcher::FindSubstringMatches(const std::string& text,
+                                           std::vector<RE2ID>* atoms) const {
   std::set<int> atoms_set;
-  substring_matcher_->Match(text, &atoms_set);
-  return std::vector<RE2ID>(atoms_set.begin(), atoms_set.end());
+  if (!substring_matcher_->Match(text, &atoms_set))
+    return;
+  atoms->assign(atoms_set.begin(), atoms_set.end());
 }
 
 void RegexSetMatcher::RebuildMatcher() {
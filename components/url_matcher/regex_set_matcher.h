@@ -52,8 +52,9 @@ class URL_MATCHER_EXPORT RegexSetMatcher {
   typedef std::vector<StringPattern::ID> RE2IDMap;
 
   // Use Aho-Corasick SubstringSetMatcher to find which literal patterns
-  // match the |text|.
-  std::vector<RE2ID> FindSubstringMatches(const std::string& text) const;
+  // match the |text|, and stores their RE2IDs in |atoms|.
+  void FindSubstringMatches(const std::string& text,
+                            std::vector<RE2ID>* atoms) const;
 
   // Rebuild FilteredRE2 from scratch. Needs to be called whenever
   // our set of regexes changes.
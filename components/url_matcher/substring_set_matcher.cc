@@ -14,6 +14,11 @@ namespace url_matcher {
 
 namespace {
 
+// Orders edges of an AhoCorasickNode by their label.
+bool CompareEdgeLabel(const std::pair<char, uint32>& edge, char label) {
+  return edge.first < label;
+}
+
 // Compare StringPattern instances based on their string patterns.
 bool ComparePatterns(const StringPattern* a, const StringPattern* b) {
   return a->pattern() < b->pattern();
@@ -252,12 +257,18 @@ SubstringSetMatcher::AhoCorasickNode::operator=(
 }
 
 uint32 SubstringSetMatcher::AhoCorasickNode::GetEdge(char c) const {
-  Edges::const_iterator i = edges_.find(c);
-  return i == edges_.end() ? kNoSuchEdge : i->second;
+  Edges::const_iterator i =
+      std::lower_bound(edges_.begin(), edges_.end(), c, CompareEdgeLabel);
+  return (i == edges_.end() || i->first != c) ? kNoSuchEdge : i->second;
 }
 
 void SubstringSetMatcher::AhoCorasickNode::SetEdge(char c, uint32 node) {
-  edges_[c] = node;
+  Edges::iterator i =
+      std::lower_bound(edges_.begin(), edges_.end(), c, CompareEdgeLabel);
+  if (i != edges_.end() && i->first == c)
+    i->second = node;
+  else
+    edges_.insert(i, std::make_pair(c, node));
 }
 
 void SubstringSetMatcher::AhoCorasickNode::AddMatch(StringPattern::ID id) {
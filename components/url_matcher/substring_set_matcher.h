@@ -9,6 +9,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -81,8 +82,10 @@ class URL_MATCHER_EXPORT SubstringSetMatcher {
   // It will make sense. Eventually.
   class AhoCorasickNode {
    public:
-    // Key: label of the edge, value: node index in |tree_| of parent class.
-    typedef std::map<char, uint32> Edges;
+    // Pairs of (label of the edge, node index in |tree_| of parent class),
+    // sorted by label. Most nodes have one or two children, so a sorted
+    // vector is far more compact and cache friendly than a std::map.
+    typedef std::vector<std::pair<char, uint32> > Edges;
     typedef std::set<StringPattern::ID> Matches;
 
     static const uint32 kNoSuchEdge;  // Represents an invalid node index.
@@ -4,11 +4,13 @@
 
 #include "content/browser/browser_main_loop.h"
 
+#include "base/allocator/allocator_extension.h"
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
 #include "base/file_util.h"
 #include "base/logging.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/message_loop/message_loop.h"
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram.h"
@@ -257,6 +259,13 @@ static void SetUpGLibLogHandler() {
 }
 #endif
 
+// Returns the allocator's cached free memory to the system, like the renderer
+// does in RenderThreadImpl::OnMemoryPressure.
+void OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  base::allocator::ReleaseFreeMemory();
+}
+
 }  // namespace
 
 // The currently-running BrowserMainLoop.  There can be one or zero.
@@ -455,6 +464,8 @@ void BrowserMainLoop::MainMessageLoopStart() {
     TRACE_EVENT0("startup", "BrowserMainLoop::Subsystem:HighResTimerManager")
     hi_res_timer_manager_.reset(new base::HighResolutionTimerManager);
   }
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&OnMemoryPressure)));
   {
     TRACE_EVENT0("startup", "BrowserMainLoop::Subsystem:NetworkChangeNotifier")
     network_change_notifier_.reset(net::NetworkChangeNotifier::Create());
@@ -134,6 +134,15 @@ bool DOMStorageArea::SetItem(const base::string16& key,
   if (is_shutdown_)
     return false;
   InitialImportIfNeeded();
+
+  // Writing back the current value changes nothing, so don't unshare the map
+  // or queue a commit for it.
+  base::NullableString16 current_value = map_->GetItem(key);
+  if (!current_value.is_null() && current_value.string() == value) {
+    *old_value = current_value;
+    return true;
+  }
+
   if (!map_->HasOneRef())
     map_ = map_->DeepCopy();
   bool success = map_->SetItem(key, value, old_value);
@@ -149,6 +158,8 @@ bool DOMStorageArea::RemoveItem(const base::string16& key,
   if (is_shutdown_)
     return false;
   InitialImportIfNeeded();
+  if (map_->GetItem(key).is_null())
+    return false;
   if (!map_->HasOneRef())
     map_ = map_->DeepCopy();
   bool success = map_->RemoveItem(key, old_value);
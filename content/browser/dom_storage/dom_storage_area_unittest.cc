@@ -106,6 +106,13 @@ TEST_F(DOMStorageAreaTest, DOMStorageAreaBasics) {
   EXPECT_NE(copy->map_.get(), area->map_.get());
   copy = area->ShallowCopy(2, std::string());
   EXPECT_EQ(copy->map_.get(), area->map_.get());
+
+  // Writes that don't change anything keep sharing the map.
+  EXPECT_TRUE(area->SetItem(kKey, kValue, &old_nullable_value));
+  EXPECT_EQ(kValue, old_nullable_value.string());
+  EXPECT_FALSE(area->RemoveItem(ASCIIToUTF16("missing"), &old_value));
+  EXPECT_EQ(copy->map_.get(), area->map_.get());
+
   EXPECT_NE(0u, area->Length());
   EXPECT_TRUE(area->Clear());
   EXPECT_EQ(0u, area->Length());
@@ -5,17 +5,51 @@
 #include "content/browser/histogram_message_filter.h"
 
 #include "base/command_line.h"
+#include "base/memory/shared_memory.h"
 #include "base/metrics/histogram.h"
+#include "base/metrics/shared_histogram_allocator.h"
 #include "base/metrics/statistics_recorder.h"
 #include "content/browser/histogram_controller.h"
 #include "content/browser/tcmalloc_internals_request_job.h"
 #include "content/common/child_process_messages.h"
+#include "content/public/browser/render_process_host.h"
 #include "content/public/common/content_switches.h"
 
 namespace content {
 
+namespace {
+
+// Room for the few hundred histograms a renderer typically records into.
+const size_t kHistogramMemorySize = 512 * 1024;
+
+}  // namespace
+
 HistogramMessageFilter::HistogramMessageFilter() {}
 
+void HistogramMessageFilter::OnChannelConnected(int32 peer_pid) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  // In single process mode the child shares the browser's histograms.
+  if (RenderProcessHost::run_renderer_in_process())
+    return;
+
+  scoped_ptr<base::SharedHistogramAllocator> allocator =
+      base::SharedHistogramAllocator::Create(kHistogramMemorySize);
+  base::SharedMemoryHandle handle;
+  if (!allocator ||
+      !allocator->shared_memory()->ShareToProcess(PeerHandle(), &handle)) {
+    return;
+  }
+  if (Send(new ChildProcessMsg_SetHistogramMemory(
+          handle, static_cast<uint32>(kHistogramMemorySize)))) {
+    histogram_allocator_ = allocator.Pass();
+  }
+}
+
+void HistogramMessageFilter::OnChannelClosing() {
+  // The child is gone, possibly crashed; collect what it left behind.
+  ImportSharedHistograms();
+}
+
 bool HistogramMessageFilter::OnMessageReceived(const IPC::Message& message,
                                               bool* message_was_ok) {
   bool handled = true;
@@ -34,6 +68,7 @@ HistogramMessageFilter::~HistogramMessageFilter() {}
 void HistogramMessageFilter::OnChildHistogramData(
     int sequence_number,
     const std::vector<std::string>& pickled_histograms) {
+  ImportSharedHistograms();
   HistogramController::GetInstance()->OnHistogramDataCollected(
       sequence_number, pickled_histograms);
 }
@@ -61,4 +96,9 @@ void HistogramMessageFilter::OnGetBrowserHistogram(
   }
 }
 
+void HistogramMessageFilter::ImportSharedHistograms() {
+  if (histogram_allocator_)
+    histogram_allocator_->ImportDeltas();
+}
+
 }  // namespace content
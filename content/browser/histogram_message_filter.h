@@ -8,9 +8,14 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "content/public/browser/browser_message_filter.h"
 #include "content/public/common/process_type.h"
 
+namespace base {
+class SharedHistogramAllocator;
+}
+
 namespace content {
 
 // This class sends and receives histogram messages in the browser process.
@@ -19,6 +24,8 @@ class HistogramMessageFilter : public BrowserMessageFilter {
   HistogramMessageFilter();
 
   // BrowserMessageFilter implementation.
+  virtual void OnChannelConnected(int32 peer_pid) OVERRIDE;
+  virtual void OnChannelClosing() OVERRIDE;
   virtual bool OnMessageReceived(const IPC::Message& message,
                                  bool* message_was_ok) OVERRIDE;
 
@@ -31,6 +38,15 @@ class HistogramMessageFilter : public BrowserMessageFilter {
   void OnGetBrowserHistogram(const std::string& name,
                              std::string* histogram_json);
 
+  // Adds what the child recorded into |histogram_allocator_| since the
+  // previous call to the browser's histograms.
+  void ImportSharedHistograms();
+
+  // The segment the child allocates its histograms in. Outlives the child, so
+  // that samples recorded up to a crash are still imported. Only accessed on
+  // the IO thread.
+  scoped_ptr<base::SharedHistogramAllocator> histogram_allocator_;
+
   DISALLOW_COPY_AND_ASSIGN(HistogramMessageFilter);
 };
 
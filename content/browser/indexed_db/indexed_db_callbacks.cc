@@ -231,9 +231,9 @@ void IndexedDBCallbacks::OnSuccess(const IndexedDBKey& key,
 void IndexedDBCallbacks::OnSuccessWithPrefetch(
     const std::vector<IndexedDBKey>& keys,
     const std::vector<IndexedDBKey>& primary_keys,
-    const std::vector<std::string>& values) {
+    std::vector<std::string>* values) {
   DCHECK_EQ(keys.size(), primary_keys.size());
-  DCHECK_EQ(keys.size(), values.size());
+  DCHECK_EQ(keys.size(), values->size());
 
   DCHECK(dispatcher_host_.get());
 
@@ -243,21 +243,13 @@ void IndexedDBCallbacks::OnSuccessWithPrefetch(
   DCHECK_EQ(kNoDatabaseCallbacks, ipc_database_callbacks_id_);
   DCHECK_EQ(blink::WebIDBDataLossNone, data_loss_);
 
-  std::vector<IndexedDBKey> msgKeys;
-  std::vector<IndexedDBKey> msgPrimaryKeys;
-
-  for (size_t i = 0; i < keys.size(); ++i) {
-    msgKeys.push_back(keys[i]);
-    msgPrimaryKeys.push_back(primary_keys[i]);
-  }
-
   IndexedDBMsg_CallbacksSuccessCursorPrefetch_Params params;
   params.ipc_thread_id = ipc_thread_id_;
   params.ipc_callbacks_id = ipc_callbacks_id_;
   params.ipc_cursor_id = ipc_cursor_id_;
-  params.keys = msgKeys;
-  params.primary_keys = msgPrimaryKeys;
-  params.values = values;
+  params.keys = keys;
+  params.primary_keys = primary_keys;
+  params.values.swap(*values);
   dispatcher_host_->Send(
       new IndexedDBMsg_CallbacksSuccessCursorPrefetch(params));
   dispatcher_host_ = NULL;
@@ -81,7 +81,7 @@ class CONTENT_EXPORT IndexedDBCallbacks
   virtual void OnSuccessWithPrefetch(
       const std::vector<IndexedDBKey>& keys,
       const std::vector<IndexedDBKey>& primary_keys,
-      const std::vector<std::string>& values);
+      std::vector<std::string>* values);
 
   // IndexedDBDatabase::Get (with key injection)
   virtual void OnSuccess(std::string* data,
@@ -105,6 +105,7 @@ static leveldb::Status OpenDB(leveldb::Comparator* comparator,
   // https://code.google.com/p/chromium/issues/detail?id=227313#c11
   options.max_open_files = 80;
   options.env = env;
+  options.block_cache = leveldb::IDBBlockCache();
 
   // ChromiumEnv assumes UTF8, converts back to FilePath before using.
   return leveldb::DB::Open(options, path.AsUTF8Unsafe(), db);
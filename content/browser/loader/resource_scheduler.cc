@@ -23,6 +23,20 @@ namespace content {
 static const size_t kMaxNumDelayableRequestsPerClient = 10;
 static const size_t kMaxNumDelayableRequestsPerHost = 6;
 
+// Returns true if requests to |server| share a multiplexed connection, either
+// because the server speaks SPDY or because it advertised a working QUIC
+// alternate protocol. Such requests don't compete for per-host sockets, so
+// they aren't throttled.
+static bool IsMultiplexedServer(
+    const net::HttpServerProperties& http_server_properties,
+    const net::HostPortPair& server) {
+  if (http_server_properties.SupportsSpdy(server))
+    return true;
+  return http_server_properties.HasAlternateProtocol(server) &&
+         http_server_properties.GetAlternateProtocol(server).protocol ==
+             net::QUIC;
+}
+
 // A thin wrapper around net::PriorityQueue that deals with
 // ScheduledResourceRequests instead of PriorityQueue::Pointers.
 class ResourceScheduler::RequestQueue {
@@ -429,7 +443,7 @@ void ResourceScheduler::GetNumDelayableRequestsInFlight(
       const net::HttpServerProperties& http_server_properties =
           *(*it)->url_request()->context()->http_server_properties();
 
-      if (!http_server_properties.SupportsSpdy(host_port_pair)) {
+      if (!IsMultiplexedServer(http_server_properties, host_port_pair)) {
         ++total_delayable_count;
       }
     }
@@ -446,7 +460,8 @@ void ResourceScheduler::GetNumDelayableRequestsInFlight(
 //
 //   * Higher priority requests (>= net::LOW).
 //   * Synchronous requests.
-//   * Requests to SPDY-capable origin servers.
+//   * Requests to SPDY-capable origin servers, or to servers with a QUIC
+//     alternate protocol.
 //   * Non-HTTP[S] requests.
 //
 // 2. The remainder are delayable requests, which follow these rules:
@@ -484,9 +499,8 @@ ResourceScheduler::ShouldStartReqResult ResourceScheduler::ShouldStartRequest(
       net::HostPortPair::FromURL(url_request.url());
 
   // TODO(willchan): We should really improve this algorithm as described in
-  // crbug.com/164101. Also, theoretically we should not count a SPDY request
-  // against the delayable requests limit.
-  if (http_server_properties.SupportsSpdy(host_port_pair)) {
+  // crbug.com/164101.
+  if (IsMultiplexedServer(http_server_properties, host_port_pair)) {
     return START_REQUEST;
   }
 
@@ -254,6 +254,36 @@ TEST_F(ResourceSchedulerTest, OneLowLoadsUntilBodyInsertedExceptSpdy) {
   EXPECT_TRUE(low2->started());
 }
 
+TEST_F(ResourceSchedulerTest, OneLowLoadsUntilBodyInsertedExceptQuic) {
+  http_server_properties_.SetAlternateProtocol(
+      net::HostPortPair("quichost", 80), 443, net::QUIC);
+  scoped_ptr<TestRequest> high(NewRequest("http://host/high", net::HIGHEST));
+  scoped_ptr<TestRequest> low_quic(
+      NewRequest("http://quichost/low", net::LOWEST));
+  scoped_ptr<TestRequest> low(NewRequest("http://host/low", net::LOWEST));
+  scoped_ptr<TestRequest> low2(NewRequest("http://host/low", net::LOWEST));
+  EXPECT_TRUE(high->started());
+  EXPECT_TRUE(low_quic->started());
+  EXPECT_TRUE(low->started());
+  EXPECT_FALSE(low2->started());
+  scheduler_.OnWillInsertBody(kChildId, kRouteId);
+  EXPECT_TRUE(low2->started());
+}
+
+TEST_F(ResourceSchedulerTest, BrokenQuicIsThrottled) {
+  net::HostPortPair quic_host("quichost", 80);
+  http_server_properties_.SetAlternateProtocol(quic_host, 443, net::QUIC);
+  http_server_properties_.SetBrokenAlternateProtocol(quic_host);
+  scoped_ptr<TestRequest> high(NewRequest("http://host/high", net::HIGHEST));
+  scoped_ptr<TestRequest> low(NewRequest("http://host/low", net::LOWEST));
+  scoped_ptr<TestRequest> low_quic(
+      NewRequest("http://quichost/low", net::LOWEST));
+  EXPECT_TRUE(low->started());
+  EXPECT_FALSE(low_quic->started());
+  scheduler_.OnWillInsertBody(kChildId, kRouteId);
+  EXPECT_TRUE(low_quic->started());
+}
+
 TEST_F(ResourceSchedulerTest, NavigationResetsState) {
   scheduler_.OnWillInsertBody(kChildId, kRouteId);
   scheduler_.OnNavigate(kChildId, kRouteId);
@@ -357,6 +387,42 @@ TEST_F(ResourceSchedulerTest, LimitedNumberOfDelayableRequestsInFlight) {
   EXPECT_FALSE(last_differenthost->started());
 }
 
+TEST_F(ResourceSchedulerTest, MultiplexedRequestsIgnoreDelayableLimits) {
+  http_server_properties_.SetSupportsSpdy(
+      net::HostPortPair("spdyhost", 443), true);
+  http_server_properties_.SetAlternateProtocol(
+      net::HostPortPair("quichost", 80), 443, net::QUIC);
+  scheduler_.OnWillInsertBody(kChildId, kRouteId);
+
+  // Simulate an image heavy page: fill up the per-client limit with requests
+  // to HTTP/1.1 hosts.
+  const int kMaxNumDelayableRequestsPerClient = 10;  // Should match the .cc.
+  ScopedVector<TestRequest> lows;
+  for (int i = 0; i < kMaxNumDelayableRequestsPerClient; ++i) {
+    string url = "http://host" + base::IntToString(i % 2) + "/low" +
+                 base::IntToString(i);
+    lows.push_back(NewRequest(url.c_str(), net::LOWEST));
+    EXPECT_TRUE(lows[i]->started());
+  }
+  scoped_ptr<TestRequest> throttled(NewRequest("http://host/low", net::LOWEST));
+  EXPECT_FALSE(throttled->started());
+
+  // Requests to multiplexed hosts still start, and don't take up a slot.
+  ScopedVector<TestRequest> multiplexed;
+  for (int i = 0; i < kMaxNumDelayableRequestsPerClient; ++i) {
+    string spdy_url = "https://spdyhost/low" + base::IntToString(i);
+    string quic_url = "http://quichost/low" + base::IntToString(i);
+    multiplexed.push_back(NewRequest(spdy_url.c_str(), net::LOWEST));
+    EXPECT_TRUE(multiplexed.back()->started());
+    multiplexed.push_back(NewRequest(quic_url.c_str(), net::LOWEST));
+    EXPECT_TRUE(multiplexed.back()->started());
+  }
+  EXPECT_FALSE(throttled->started());
+
+  lows.erase(lows.begin());
+  EXPECT_TRUE(throttled->started());
+}
+
 TEST_F(ResourceSchedulerTest, RaisePriorityAndStart) {
   // Dummies to enforce scheduling.
   scoped_ptr<TestRequest> high(NewRequest("http://host/high", net::HIGHEST));
@@ -8,6 +8,7 @@
 #include <map>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
@@ -21,6 +22,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
 #include "base/sequenced_task_runner.h"
+#include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
@@ -67,7 +69,9 @@ namespace content {
 // Subsequent to loading, mutations may be queued by any thread using
 // AddCookie, UpdateCookieAccessTime, and DeleteCookie. These are flushed to
 // disk on the BG runner every 30 seconds, 512 operations, or call to Flush(),
-// whichever occurs first.
+// whichever occurs first. Each commit is a single transaction: the batch is
+// first reduced to at most one change per cookie, then deletions and access
+// time updates are written several rows per statement.
 class SQLitePersistentCookieStore::Backend
     : public base::RefCountedThreadSafe<SQLitePersistentCookieStore::Backend> {
  public:
@@ -370,6 +374,50 @@ class IncrementTimeDelta {
   DISALLOW_COPY_AND_ASSIGN(IncrementTimeDelta);
 };
 
+// Number of rows covered by each multi-row statement in Backend::Commit().
+const size_t kRowsPerStatement = 32;
+
+// Returns |prefix| followed by an IN list of |count| placeholders.
+std::string WithInList(const char* prefix, size_t count) {
+  std::string sql(prefix);
+  sql.append(" IN (");
+  for (size_t i = 0; i < count; ++i)
+    sql.append(i ? ",?" : "?");
+  sql.append(")");
+  return sql;
+}
+
+// Runs statements whose last parameters are cookie creation times over
+// |creation_times|: |many| for each whole group of kRowsPerStatement, and
+// |one| for the remainder. If |last_access| is non-NULL it is bound as the
+// first parameter of every statement. Returns false on the first failure.
+bool RunForCreationTimes(sql::Statement* many,
+                         sql::Statement* one,
+                         const int64* last_access,
+                         const std::vector<int64>& creation_times) {
+  const int first = last_access ? 1 : 0;
+  size_t i = 0;
+  for (; i + kRowsPerStatement <= creation_times.size();
+       i += kRowsPerStatement) {
+    many->Reset(true);
+    if (last_access)
+      many->BindInt64(0, *last_access);
+    for (size_t j = 0; j < kRowsPerStatement; ++j)
+      many->BindInt64(first + j, creation_times[i + j]);
+    if (!many->Run())
+      return false;
+  }
+  for (; i < creation_times.size(); ++i) {
+    one->Reset(true);
+    if (last_access)
+      one->BindInt64(0, *last_access);
+    one->BindInt64(first, creation_times[i]);
+    if (!one->Run())
+      return false;
+  }
+  return true;
+}
+
 // Initializes the cookies table, returning true on success.
 bool InitTable(sql::Connection* db) {
   if (!db->DoesTableExist("cookies")) {
@@ -961,6 +1009,7 @@ void SQLitePersistentCookieStore::Backend::Commit() {
     pending_.swap(ops);
     num_pending_ = 0;
   }
+  STLElementDeleter<PendingOperationsList> ops_deleter(&ops);
 
   // Maybe an old timer fired or we are already Close()'ed.
   if (!db_.get() || ops.empty())
@@ -979,68 +1028,56 @@ void SQLitePersistentCookieStore::Backend::Commit() {
   if (!update_access_smt.is_valid())
     return;
 
+  sql::Statement update_access_many_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+      WithInList("UPDATE cookies SET last_access_utc=? WHERE creation_utc",
+                 kRowsPerStatement).c_str()));
+  if (!update_access_many_smt.is_valid())
+    return;
+
   sql::Statement del_smt(db_->GetCachedStatement(SQL_FROM_HERE,
                          "DELETE FROM cookies WHERE creation_utc=?"));
   if (!del_smt.is_valid())
     return;
 
+  sql::Statement del_many_smt(db_->GetCachedStatement(SQL_FROM_HERE,
+      WithInList("DELETE FROM cookies WHERE creation_utc",
+                 kRowsPerStatement).c_str()));
+  if (!del_many_smt.is_valid())
+    return;
+
   sql::Transaction transaction(db_.get());
   if (!transaction.Begin())
     return;
 
-  for (PendingOperationsList::iterator it = ops.begin();
+  // Reduce the batch to at most one change per cookie, keyed by creation
+  // time. A cookie added and deleted again within the batch never reaches the
+  // DB, and access time updates of a cookie added in the batch are folded into
+  // its insertion.
+  std::map<int64, const PendingOperation*> adds;
+  std::set<int64> deletes;
+  std::map<int64, int64> access_times;
+  for (PendingOperationsList::const_iterator it = ops.begin();
        it != ops.end(); ++it) {
-    // Free the cookies as we commit them to the database.
-    scoped_ptr<PendingOperation> po(*it);
+    const PendingOperation* po = *it;
+    const int64 creation = po->cc().CreationDate().ToInternalValue();
     switch (po->op()) {
       case PendingOperation::COOKIE_ADD:
         cookies_per_origin_[
             CookieOrigin(po->cc().Domain(), po->cc().IsSecure())]++;
-        add_smt.Reset(true);
-        add_smt.BindInt64(0, po->cc().CreationDate().ToInternalValue());
-        add_smt.BindString(1, po->cc().Domain());
-        add_smt.BindString(2, po->cc().Name());
-        if (crypto_) {
-          std::string encrypted_value;
-          add_smt.BindCString(3, "");  // value
-          crypto_->EncryptString(po->cc().Value(), &encrypted_value);
-          // BindBlob() immediately makes an internal copy of the data.
-          add_smt.BindBlob(4, encrypted_value.data(),
-                           static_cast<int>(encrypted_value.length()));
-        } else {
-          add_smt.BindString(3, po->cc().Value());
-          add_smt.BindBlob(4, "", 0);  // encrypted_value
-        }
-        add_smt.BindString(5, po->cc().Path());
-        add_smt.BindInt64(6, po->cc().ExpiryDate().ToInternalValue());
-        add_smt.BindInt(7, po->cc().IsSecure());
-        add_smt.BindInt(8, po->cc().IsHttpOnly());
-        add_smt.BindInt64(9, po->cc().LastAccessDate().ToInternalValue());
-        add_smt.BindInt(10, po->cc().IsPersistent());
-        add_smt.BindInt(11, po->cc().IsPersistent());
-        add_smt.BindInt(
-            12, CookiePriorityToDBCookiePriority(po->cc().Priority()));
-        if (!add_smt.Run())
-          NOTREACHED() << "Could not add a cookie to the DB.";
+        adds[creation] = po;
+        access_times.erase(creation);
         break;
 
       case PendingOperation::COOKIE_UPDATEACCESS:
-        update_access_smt.Reset(true);
-        update_access_smt.BindInt64(0,
-            po->cc().LastAccessDate().ToInternalValue());
-        update_access_smt.BindInt64(1,
-            po->cc().CreationDate().ToInternalValue());
-        if (!update_access_smt.Run())
-          NOTREACHED() << "Could not update cookie last access time in the DB.";
+        access_times[creation] = po->cc().LastAccessDate().ToInternalValue();
         break;
 
       case PendingOperation::COOKIE_DELETE:
         cookies_per_origin_[
             CookieOrigin(po->cc().Domain(), po->cc().IsSecure())]--;
-        del_smt.Reset(true);
-        del_smt.BindInt64(0, po->cc().CreationDate().ToInternalValue());
-        if (!del_smt.Run())
-          NOTREACHED() << "Could not delete a cookie from the DB.";
+        if (!adds.erase(creation))
+          deletes.insert(creation);
+        access_times.erase(creation);
         break;
 
       default:
@@ -1048,6 +1085,75 @@ void SQLitePersistentCookieStore::Backend::Commit() {
         break;
     }
   }
+
+  // Deletions go first, so a row deleted and added again in the same batch
+  // does not trip over the primary key.
+  if (!RunForCreationTimes(&del_many_smt, &del_smt, NULL,
+                           std::vector<int64>(deletes.begin(),
+                                              deletes.end()))) {
+    NOTREACHED() << "Could not delete a cookie from the DB.";
+  }
+
+  // Insertions are written in the order they were queued.
+  for (PendingOperationsList::const_iterator it = ops.begin();
+       it != ops.end(); ++it) {
+    const PendingOperation* po = *it;
+    const int64 creation = po->cc().CreationDate().ToInternalValue();
+    std::map<int64, const PendingOperation*>::const_iterator add =
+        adds.find(creation);
+    if (add == adds.end() || add->second != po)
+      continue;
+    int64 last_access = po->cc().LastAccessDate().ToInternalValue();
+    std::map<int64, int64>::iterator access = access_times.find(creation);
+    if (access != access_times.end()) {
+      last_access = access->second;
+      access_times.erase(access);
+    }
+
+    add_smt.Reset(true);
+    add_smt.BindInt64(0, creation);
+    add_smt.BindString(1, po->cc().Domain());
+    add_smt.BindString(2, po->cc().Name());
+    if (crypto_) {
+      std::string encrypted_value;
+      add_smt.BindCString(3, "");  // value
+      crypto_->EncryptString(po->cc().Value(), &encrypted_value);
+      // BindBlob() immediately makes an internal copy of the data.
+      add_smt.BindBlob(4, encrypted_value.data(),
+                       static_cast<int>(encrypted_value.length()));
+    } else {
+      add_smt.BindString(3, po->cc().Value());
+      add_smt.BindBlob(4, "", 0);  // encrypted_value
+    }
+    add_smt.BindString(5, po->cc().Path());
+    add_smt.BindInt64(6, po->cc().ExpiryDate().ToInternalValue());
+    add_smt.BindInt(7, po->cc().IsSecure());
+    add_smt.BindInt(8, po->cc().IsHttpOnly());
+    add_smt.BindInt64(9, last_access);
+    add_smt.BindInt(10, po->cc().IsPersistent());
+    add_smt.BindInt(11, po->cc().IsPersistent());
+    add_smt.BindInt(
+        12, CookiePriorityToDBCookiePriority(po->cc().Priority()));
+    if (!add_smt.Run())
+      NOTREACHED() << "Could not add a cookie to the DB.";
+  }
+
+  // The cookies of one request share their new access time, so updates are
+  // grouped by it.
+  std::map<int64, std::vector<int64> > creations_by_access_time;
+  for (std::map<int64, int64>::const_iterator it = access_times.begin();
+       it != access_times.end(); ++it) {
+    creations_by_access_time[it->second].push_back(it->first);
+  }
+  for (std::map<int64, std::vector<int64> >::const_iterator it =
+           creations_by_access_time.begin();
+       it != creations_by_access_time.end(); ++it) {
+    if (!RunForCreationTimes(&update_access_many_smt, &update_access_smt,
+                             &it->first, it->second)) {
+      NOTREACHED() << "Could not update cookie last access time in the DB.";
+    }
+  }
+
   bool succeeded = transaction.Commit();
   UMA_HISTOGRAM_ENUMERATION("Cookie.BackingStoreUpdateResults",
                             succeeded ? 0 : 1, 2);
@@ -15,6 +15,8 @@
 #include "base/message_loop/message_loop.h"
 #include "base/sequenced_task_runner.h"
 #include "base/stl_util.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/test/sequenced_worker_pool_owner.h"
 #include "base/threading/sequenced_worker_pool.h"
@@ -358,6 +360,63 @@ TEST_F(SQLitePersistentCookieStoreTest, TestFlush) {
   ASSERT_GT(info.size, base_size);
 }
 
+// Test that a batch mixing every kind of operation, on more cookies than fit
+// in one multi-row statement, is committed as if it had run in order.
+TEST_F(SQLitePersistentCookieStoreTest, TestBatchedCommit) {
+  InitializeStore(false, false);
+  const base::Time t = base::Time::Now();
+  const int kNumCookies = 100;
+  for (int i = 0; i < kNumCookies; ++i) {
+    AddCookie(base::StringPrintf("kept%d", i), "value", "foo.bar", "/",
+              t + base::TimeDelta::FromMicroseconds(i));
+    AddCookie(base::StringPrintf("gone%d", i), "value", "foo.bar", "/",
+              t + base::TimeDelta::FromMicroseconds(kNumCookies + i));
+  }
+  Flush();
+
+  CanonicalCookieVector cookies;
+  DestroyStore();
+  CreateAndLoad(false, false, &cookies);
+  ASSERT_EQ(2U * kNumCookies, cookies.size());
+
+  // Delete the "gone" cookies, bump the access time of the "kept" ones, and
+  // add two more, one of which is deleted again before the commit.
+  const base::Time access_time = t + base::TimeDelta::FromDays(1);
+  for (CanonicalCookieVector::iterator it = cookies.begin();
+       it != cookies.end(); ++it) {
+    if (StartsWithASCII((*it)->Name(), "gone", true)) {
+      store_->DeleteCookie(**it);
+    } else {
+      (*it)->SetLastAccessDate(access_time);
+      store_->UpdateCookieAccessTime(**it);
+    }
+  }
+  const base::Time added_time = t + base::TimeDelta::FromMicroseconds(
+      2 * kNumCookies);
+  AddCookie("added", "value", "foo.bar", "/", added_time);
+  net::CanonicalCookie transient(
+      GURL(), "transient", "value", "foo.bar", "/",
+      added_time + base::TimeDelta::FromMicroseconds(1), access_time,
+      added_time, false, false, net::COOKIE_PRIORITY_DEFAULT);
+  store_->AddCookie(transient);
+  store_->DeleteCookie(transient);
+  STLDeleteElements(&cookies);
+  DestroyStore();
+
+  CreateAndLoad(false, false, &cookies);
+  ASSERT_EQ(kNumCookies + 1U, cookies.size());
+  for (CanonicalCookieVector::iterator it = cookies.begin();
+       it != cookies.end(); ++it) {
+    if ((*it)->Name() == "added") {
+      EXPECT_EQ(added_time, (*it)->LastAccessDate());
+    } else {
+      EXPECT_TRUE(StartsWithASCII((*it)->Name(), "kept", true));
+      EXPECT_EQ(access_time, (*it)->LastAccessDate());
+    }
+  }
+  STLDeleteElements(&cookies);
+}
+
 // Test loading old session cookies from the disk.
 TEST_F(SQLitePersistentCookieStoreTest, TestLoadOldSessionCookies) {
   InitializeStore(false, true);
@@ -2405,6 +2405,27 @@ void RenderWidgetHostImpl::FrameSwapped(const ui::LatencyInfo& latency_info) {
     return;
   }
 
+  // Break the time between sending the event and the swap into the hop to
+  // the renderer's compositor thread and the rest of the pipeline.
+  ui::LatencyInfo::LatencyComponent renderer_impl_component;
+  if (latency_info.FindLatency(ui::INPUT_EVENT_LATENCY_RENDERER_IMPL_COMPONENT,
+                               0, &renderer_impl_component)) {
+    UMA_HISTOGRAM_CUSTOM_COUNTS(
+        "Event.Latency.RWHToRendererImpl",
+        (renderer_impl_component.event_time -
+            rwh_component.event_time).InMicroseconds(),
+        1,
+        1000000,
+        100);
+    UMA_HISTOGRAM_CUSTOM_COUNTS(
+        "Event.Latency.RendererImplToSwap",
+        (swap_component.event_time -
+            renderer_impl_component.event_time).InMicroseconds(),
+        1,
+        1000000,
+        100);
+  }
+
   ui::LatencyInfo::LatencyComponent original_component;
   if (latency_info.FindLatency(
           ui::INPUT_EVENT_LATENCY_SCROLL_UPDATE_ORIGINAL_COMPONENT,
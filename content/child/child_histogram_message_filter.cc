@@ -9,6 +9,8 @@
 #include "base/bind.h"
 #include "base/message_loop/message_loop.h"
 #include "base/metrics/histogram_delta_serialization.h"
+#include "base/metrics/shared_histogram_allocator.h"
+#include "base/metrics/statistics_recorder.h"
 #include "content/child/child_process.h"
 #include "content/child/child_thread.h"
 #include "content/common/child_process_messages.h"
@@ -36,6 +38,8 @@ bool ChildHistogramMessageFilter::OnMessageReceived(
   IPC_BEGIN_MESSAGE_MAP(ChildHistogramMessageFilter, message)
     IPC_MESSAGE_HANDLER(ChildProcessMsg_GetChildHistogramData,
                         OnGetChildHistogramData)
+    IPC_MESSAGE_HANDLER(ChildProcessMsg_SetHistogramMemory,
+                        OnSetHistogramMemory)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
   return handled;
@@ -51,6 +55,20 @@ void ChildHistogramMessageFilter::OnGetChildHistogramData(int sequence_number) {
   UploadAllHistograms(sequence_number);
 }
 
+void ChildHistogramMessageFilter::OnSetHistogramMemory(
+    base::SharedMemoryHandle histogram_memory,
+    uint32 histogram_memory_size) {
+  scoped_ptr<base::SharedMemory> shared_memory(
+      new base::SharedMemory(histogram_memory, false));
+  if (!shared_memory->Map(histogram_memory_size))
+    return;
+  scoped_ptr<base::SharedHistogramAllocator> allocator =
+      base::SharedHistogramAllocator::CreateFromSharedMemory(
+          shared_memory.Pass());
+  if (allocator)
+    base::StatisticsRecorder::SetSharedHistogramAllocator(allocator.Pass());
+}
+
 void ChildHistogramMessageFilter::UploadAllHistograms(int sequence_number) {
   if (!histogram_delta_serialization_) {
     histogram_delta_serialization_.reset(
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/shared_memory.h"
 #include "ipc/ipc_channel_proxy.h"
 
 namespace base {
@@ -36,6 +37,8 @@ class ChildHistogramMessageFilter : public IPC::ChannelProxy::MessageFilter {
 
   // Message handlers.
   virtual void OnGetChildHistogramData(int sequence_number);
+  void OnSetHistogramMemory(base::SharedMemoryHandle histogram_memory,
+                            uint32 histogram_memory_size);
 
   // Extract snapshot data and then send it off the the Browser process.
   // Send only a delta to what we have already sent.
@@ -4,6 +4,8 @@
 
 #include "content/common/cc_messages.h"
 
+#include <algorithm>
+
 #include "base/command_line.h"
 #include "cc/output/compositor_frame.h"
 #include "cc/output/filter_operations.h"
@@ -417,11 +419,26 @@ bool ParamTraits<cc::RenderPass>::Read(
       !ReadParam(m, iter, &quad_list_size))
     return false;
 
+  // Every quad takes at least its material, its three rects, its blending
+  // flag and its shared quad state index. Checking the quad count against the
+  // bytes left in the message up front rejects a bogus count before anything
+  // is allocated for it.
+  const size_t kMinQuadSizeInBytes = 3 * sizeof(int) + 3 * 4 * sizeof(int);
+  if (quad_list_size > static_cast<size_t>(kint32max) / kMinQuadSizeInBytes)
+    return false;
+  PickleIterator bounds_iter = *iter;
+  if (quad_list_size && !bounds_iter.SkipBytes(static_cast<int>(
+                            quad_list_size * kMinQuadSizeInBytes)))
+    return false;
+
   p->SetAll(id,
             output_rect,
             damage_rect,
             transform_to_root_target,
             has_transparent_background);
+  p->quad_list.reserve(quad_list_size);
+  p->shared_quad_state_list.reserve(
+      std::min(shared_quad_state_list_size, quad_list_size));
 
   size_t last_shared_quad_state_index = kuint32max;
   for (size_t i = 0; i < quad_list_size; ++i) {
@@ -635,6 +635,23 @@ TEST_F(CCMessagesTest, UnusedSharedQuadStates) {
             pass_out->shared_quad_state_list[1]->content_bounds.ToString());
 }
 
+TEST_F(CCMessagesTest, QuadCountLargerThanMessage) {
+  IPC::Message msg(1, 2, IPC::Message::PRIORITY_NORMAL);
+  IPC::WriteParam(&msg, RenderPass::Id(1, 1));
+  IPC::WriteParam(&msg, gfx::Rect(100, 100));
+  IPC::WriteParam(&msg, gfx::RectF());
+  IPC::WriteParam(&msg, gfx::Transform());
+  IPC::WriteParam(&msg, false);
+  // One shared quad state and a million quads, but no quads follow.
+  IPC::WriteParam(&msg, static_cast<size_t>(1));
+  IPC::WriteParam(&msg, static_cast<size_t>(1000000));
+
+  scoped_ptr<RenderPass> pass_out = RenderPass::Create();
+  PickleIterator iter(msg);
+  EXPECT_FALSE(IPC::ParamTraits<RenderPass>::Read(&msg, &iter, pass_out.get()));
+  EXPECT_EQ(0u, pass_out->quad_list.size());
+}
+
 TEST_F(CCMessagesTest, Resources) {
   IPC::Message msg(1, 2, IPC::Message::PRIORITY_NORMAL);
   gfx::Size arbitrary_size(757, 1281);
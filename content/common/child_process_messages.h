@@ -37,6 +37,8 @@ IPC_STRUCT_TRAITS_BEGIN(tracked_objects::DeathDataSnapshot)
   IPC_STRUCT_TRAITS_MEMBER(queue_duration_sum)
   IPC_STRUCT_TRAITS_MEMBER(queue_duration_max)
   IPC_STRUCT_TRAITS_MEMBER(queue_duration_sample)
+  IPC_STRUCT_TRAITS_MEMBER(run_duration_buckets)
+  IPC_STRUCT_TRAITS_MEMBER(queue_duration_buckets)
 IPC_STRUCT_TRAITS_END()
 
 IPC_STRUCT_TRAITS_BEGIN(tracked_objects::TaskSnapshot)
@@ -97,6 +99,13 @@ IPC_MESSAGE_CONTROL1(ChildProcessMsg_GetChildProfilerData,
 IPC_MESSAGE_CONTROL1(ChildProcessMsg_GetChildHistogramData,
                      int /* sequence_number */)
 
+// Sent once to a child process with a shared memory segment to allocate its
+// histograms in. The browser reads them directly from the segment instead of
+// having them sent back with ChildProcessHostMsg_ChildHistogramData.
+IPC_MESSAGE_CONTROL2(ChildProcessMsg_SetHistogramMemory,
+                     base::SharedMemoryHandle /* histogram_memory */,
+                     uint32 /* histogram_memory_size */)
+
 // Sent to child processes to dump their handle table.
 IPC_MESSAGE_CONTROL0(ChildProcessMsg_DumpHandles)
 
@@ -100,6 +100,11 @@ const int64 kHandleMoreWorkPeriodBusyMs = 1;
 // Prevents idle work from being starved.
 const int64 kMaxTimeSinceIdleMs = 10;
 
+// How long an offscreen context, e.g. WebGL, may process commands before
+// giving other command buffers a chance to run, so that a context flooding
+// the GPU process doesn't make onscreen compositors miss frames.
+const int64 kOffscreenTimeSliceMs = 4;
+
 }  // namespace
 
 GpuCommandBufferStub::GpuCommandBufferStub(
@@ -413,6 +418,10 @@ void GpuCommandBufferStub::OnInitialize(
                                          decoder_.get()));
   if (preemption_flag_.get())
     scheduler_->SetPreemptByFlag(preemption_flag_);
+  if (handle_.is_null()) {
+    scheduler_->SetTimeSlice(
+        base::TimeDelta::FromMilliseconds(kOffscreenTimeSliceMs));
+  }
 
   decoder_->set_engine(scheduler_.get());
 
@@ -95,6 +95,8 @@ InputHandlerProxy::HandleInputEventWithLatencyInfo(
   DCHECK(input_handler_);
 
   SendScrollLatencyUma(event, *latency_info);
+  latency_info->AddLatencyNumber(
+      ui::INPUT_EVENT_LATENCY_RENDERER_IMPL_COMPONENT, 0, 0);
 
   scoped_ptr<cc::SwapPromiseMonitor> latency_info_swap_promise_monitor =
       input_handler_->CreateLatencyInfoSwapPromiseMonitor(latency_info);
@@ -51,6 +51,16 @@ static const int kMaxBufferCapacity = 20 * kMegabyte;
 // location and will instead reset the request.
 static const int kForwardWaitThreshold = 2 * kMegabyte;
 
+// When the download rate is known, we also wait for reads which start within
+// however many bytes we expect to receive in this long, up to
+// kMaxBufferCapacity.  On fast connections this is cheaper than throwing away
+// the buffered data and starting a new request.
+static const int kForwardWaitSeconds = 1;
+
+// Minimum time over which data must have been received before we trust the
+// measured download rate.
+static const int kMinDownloadRateSampleMs = 250;
+
 // Computes the suggested backward and forward capacity for the buffer
 // if one wants to play at |playback_rate| * the natural playback speed.
 // Use a value of 0 for |bitrate| if it is unknown.
@@ -124,6 +134,8 @@ BufferedResourceLoader::BufferedResourceLoader(
       last_offset_(0),
       bitrate_(bitrate),
       playback_rate_(playback_rate),
+      bytes_received_since_sample_start_(0),
+      download_rate_(0),
       media_log_(media_log) {
 
   // Set the initial capacity of |buffer_| based on |bitrate_| and
@@ -446,6 +458,7 @@ void BufferedResourceLoader::didReceiveData(
   DCHECK_GT(data_length, 0);
 
   buffer_.Append(reinterpret_cast<const uint8*>(data), data_length);
+  UpdateDownloadRate(data_length);
 
   // If there is an active read request, try to fulfill the request.
   if (HasPendingRead() && CanFulfillRead())
@@ -609,6 +622,9 @@ void BufferedResourceLoader::SetDeferred(bool deferred) {
   if (active_loader_->deferred() == deferred)
     return;
 
+  // Time spent deferred isn't spent downloading, so start a new sample.
+  sample_start_time_ = base::TimeTicks();
+
   active_loader_->SetDeferred(deferred);
   loading_cb_.Run(deferred ? kLoadingDeferred : kLoading);
 }
@@ -658,7 +674,7 @@ bool BufferedResourceLoader::WillFulfillRead() const {
     return false;
 
   // Trying to read too far ahead.
-  if ((first_offset_ - buffer_.forward_bytes()) >= kForwardWaitThreshold)
+  if ((first_offset_ - buffer_.forward_bytes()) >= ForwardWaitThreshold())
     return false;
 
   // The resource request has completed, there's no way we can fulfill the
@@ -669,6 +685,33 @@ bool BufferedResourceLoader::WillFulfillRead() const {
   return true;
 }
 
+void BufferedResourceLoader::UpdateDownloadRate(int bytes_received) {
+  base::TimeTicks now = base::TimeTicks::Now();
+
+  // The first bytes after a (re)start also carry the request latency, so they
+  // only mark the start of the sample.
+  if (sample_start_time_.is_null()) {
+    sample_start_time_ = now;
+    bytes_received_since_sample_start_ = 0;
+    return;
+  }
+
+  bytes_received_since_sample_start_ += bytes_received;
+  base::TimeDelta elapsed = now - sample_start_time_;
+  if (elapsed.InMilliseconds() < kMinDownloadRateSampleMs)
+    return;
+
+  download_rate_ = static_cast<int>(std::min<int64>(
+      bytes_received_since_sample_start_ / elapsed.InSecondsF(), kint32max));
+}
+
+int BufferedResourceLoader::ForwardWaitThreshold() const {
+  int64 expected_bytes =
+      static_cast<int64>(download_rate_) * kForwardWaitSeconds;
+  return std::max(kForwardWaitThreshold, static_cast<int>(std::min<int64>(
+      expected_bytes, kMaxBufferCapacity)));
+}
+
 void BufferedResourceLoader::ReadInternal() {
   // Seek to the first byte requested.
   bool ret = buffer_.Seek(first_offset_);
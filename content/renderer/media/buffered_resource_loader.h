@@ -9,6 +9,7 @@
 
 #include "base/callback.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
 #include "base/timer/timer.h"
 #include "content/common/content_export.h"
 #include "content/renderer/media/active_loader.h"
@@ -231,6 +232,13 @@ class CONTENT_EXPORT BufferedResourceLoader
   // Returns true if the current read request will be fulfilled in the future.
   bool WillFulfillRead() const;
 
+  // Accounts for |bytes_received| in the measured download rate.
+  void UpdateDownloadRate(int bytes_received);
+
+  // Returns how far past the buffered data a read may start and still be
+  // waited for, rather than treated as a cache miss.
+  int ForwardWaitThreshold() const;
+
   // Method that does the actual read and calls the |read_cb_|, assuming the
   // request range is in |buffer_|.
   void ReadInternal();
@@ -316,6 +324,13 @@ class CONTENT_EXPORT BufferedResourceLoader
   // Playback rate of the media.
   float playback_rate_;
 
+  // Used to measure the download rate while the load isn't deferred.
+  base::TimeTicks sample_start_time_;
+  int64 bytes_received_since_sample_start_;
+
+  // Measured download rate in bytes per second. Set to 0 if unknown.
+  int download_rate_;
+
   scoped_refptr<media::MediaLog> media_log_;
 
   DISALLOW_COPY_AND_ASSIGN(BufferedResourceLoader);
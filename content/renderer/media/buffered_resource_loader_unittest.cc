@@ -269,6 +269,10 @@ class BufferedResourceLoaderTest : public testing::Test {
     EXPECT_EQ(loader_->buffer_.forward_capacity(), expected_forward_capacity);
   }
 
+  void SetDownloadRate(int download_rate) {
+    loader_->download_rate_ = download_rate;
+  }
+
   // Makes sure the |loader_| buffer window is in a reasonable range.
   void CheckBufferWindowBounds() {
     // Corresponds to value defined in buffered_resource_loader.cc.
@@ -956,6 +960,44 @@ TEST_F(BufferedResourceLoaderTest, Tricky_ReadPastThreshold) {
   StopWhenLoad();
 }
 
+TEST_F(BufferedResourceLoaderTest, Tricky_ReadPastThresholdOnFastConnection) {
+  const int kSize = 5 * 1024 * 1024;
+  const int kThreshold = 2 * 1024 * 1024;
+
+  Initialize(kHttpUrl, 10, kSize);
+  SetLoaderBuffer(10, 10);
+  Start();
+  PartialResponse(10, kSize - 1, kSize);
+
+  uint8 buffer[256];
+  InSequence s;
+
+  // PRECONDITION
+  WriteUntilThreshold();
+  ConfirmBufferState(0, 10, 10, 10);
+  ConfirmLoaderOffsets(10, 0, 0);
+
+  // Read past the forward wait threshold on a connection which downloads
+  // twice as much in a second: keep the request and wait for the data.
+  //
+  // BEFORE
+  //   offset=10 [xxxxxxxxxx] ...
+  //                              ^^^^ requested 10 bytes @ threshold
+  // ADJUSTED OFFSET
+  //   offset=20 [__________] ...
+  //                              ^^^^ requested 10 bytes @ threshold
+  //
+  SetDownloadRate(2 * kThreshold);
+  EXPECT_CALL(*this, LoadingCallback(BufferedResourceLoader::kLoading));
+  ReadLoader(kThreshold + 20, 10, buffer);
+
+  // POSTCONDITION
+  ConfirmLoaderOffsets(20, kThreshold, kThreshold + 10);
+  ConfirmLoaderBufferForwardCapacity(kThreshold + 10);
+
+  StopWhenLoad();
+}
+
 TEST_F(BufferedResourceLoaderTest, HasSingleOrigin) {
   // Make sure no redirect case works as expected.
   Initialize(kHttpUrl, -1, -1);
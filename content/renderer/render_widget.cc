@@ -1058,6 +1058,8 @@ void RenderWidget::OnHandleInputEvent(const blink::WebInputEvent* input_event,
                "event", event_name);
   TRACE_EVENT_SYNTHETIC_DELAY_BEGIN("blink.HandleInputEvent");
 
+  latency_info.AddLatencyNumber(
+      ui::INPUT_EVENT_LATENCY_RENDERER_MAIN_COMPONENT, 0, 0);
   scoped_ptr<cc::SwapPromiseMonitor> latency_info_swap_promise_monitor;
 
   if (compositor_) {
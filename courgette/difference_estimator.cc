@@ -8,6 +8,8 @@
 
 #include "courgette/difference_estimator.h"
 
+#include <limits>
+
 #include "base/containers/hash_tables.h"
 
 namespace courgette {
@@ -94,6 +96,12 @@ DifferenceEstimator::Subject* DifferenceEstimator::MakeSubject(
 }
 
 size_t DifferenceEstimator::Measure(Base* base, Subject* subject) {
+  return MeasureWithLimit(base, subject, std::numeric_limits<size_t>::max());
+}
+
+size_t DifferenceEstimator::MeasureWithLimit(Base* base,
+                                             Subject* subject,
+                                             size_t limit) {
   size_t mismatches = 0;
   const uint8* start = subject->region().start();
   const uint8* end = subject->region().end() - (kTupleSize - 1);
@@ -103,6 +111,9 @@ size_t DifferenceEstimator::Measure(Base* base, Subject* subject) {
     size_t hash = HashTuple(p);
     if (base->hashes_.find(hash) == base->hashes_.end()) {
       ++mismatches;
+      // The result is |mismatches| + 1 from here on, see below.
+      if (mismatches >= limit - 1)
+        return mismatches + 1;
     }
     p += 1;
   }
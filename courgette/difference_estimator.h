@@ -47,6 +47,12 @@ class DifferenceEstimator {
   // are bytewise identical.
   size_t Measure(Base* base,  Subject* subject);
 
+  // Like Measure, but gives up as soon as the estimate reaches |limit| and
+  // then returns a value that is at least |limit|.  Use this when only
+  // estimates below |limit| are of interest, e.g. when searching for the best
+  // match.  Still returns zero iff the regions are bytewise identical.
+  size_t MeasureWithLimit(Base* base,  Subject* subject, size_t limit);
+
  private:
   std::vector<Base*> owned_bases_;
   std::vector<Subject*> owned_subjects_;
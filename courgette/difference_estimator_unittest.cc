@@ -56,3 +56,23 @@ TEST(DifferenceEstimatorTest, TestDifferentSubstring) {
       difference_estimator.MakeSubject(Region(kString2, sizeof(kString2)-1));
   EXPECT_EQ(1U, difference_estimator.Measure(base, subject));
 }
+
+TEST(DifferenceEstimatorTest, TestLimit) {
+  static const char kString1[] = "Hello world";
+  static const char kString2[] = "Hello universe";
+  const char kString3[] = "Hello world";
+  DifferenceEstimator difference_estimator;
+  DifferenceEstimator::Base* base =
+      difference_estimator.MakeBase(Region(kString1, sizeof(kString1)));
+  DifferenceEstimator::Subject* subject =
+      difference_estimator.MakeSubject(Region(kString2, sizeof(kString2)));
+  EXPECT_EQ(10U, difference_estimator.MeasureWithLimit(base, subject, 11));
+  EXPECT_EQ(10U, difference_estimator.MeasureWithLimit(base, subject, 10));
+  EXPECT_EQ(4U, difference_estimator.MeasureWithLimit(base, subject, 4));
+  EXPECT_EQ(2U, difference_estimator.MeasureWithLimit(base, subject, 1));
+
+  // Identical regions are still reported regardless of the limit.
+  DifferenceEstimator::Subject* same =
+      difference_estimator.MakeSubject(Region(kString3, sizeof(kString3)));
+  EXPECT_EQ(0U, difference_estimator.MeasureWithLimit(base, same, 1));
+}
@@ -172,13 +172,11 @@ Status FindGenerators(Ensemble* old_ensemble, Ensemble* new_ensemble,
     // Search through old elements to find the best match.
     //
     // TODO(sra): This is O(N x M), i.e. O(N^2) since old_ensemble and
-    // new_ensemble probably have a very similar structure.  We can make the
-    // search faster by making the comparison provided by DifferenceEstimator
-    // more nuanced, returning early if the measured difference is greater than
-    // the current best.  This will be most effective if we can arrange that the
-    // first elements we try to match are likely the 'right' ones.  We could
-    // prioritize elements that are of a similar size or similar position in the
-    // sequence of elements.
+    // new_ensemble probably have a very similar structure.  Each comparison
+    // gives up once it is no better than the current best, which will be most
+    // effective if we can arrange that the first elements we try to match are
+    // likely the 'right' ones.  We could prioritize elements that are of a
+    // similar size or similar position in the sequence of elements.
     //
     Element* best_old_element = NULL;
     size_t best_difference = std::numeric_limits<size_t>::max();
@@ -193,7 +191,8 @@ Status FindGenerators(Ensemble* old_ensemble, Ensemble* new_ensemble,
 
       base::Time start_compare = base::Time::Now();
       DifferenceEstimator::Base* old_base = bases[old_index];
-      size_t difference = difference_estimator.Measure(old_base, new_subject);
+      size_t difference = difference_estimator.MeasureWithLimit(
+          old_base, new_subject, best_difference);
 
       VLOG(1) << "Compare " << old_element->Name()
               << " to " << new_element->Name()
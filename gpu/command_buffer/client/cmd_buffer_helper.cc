@@ -239,6 +239,11 @@ void CommandBufferHelper::WaitForToken(int32 token) {
   if (token < 0)
     return;
   if (token > token_) return;  // we wrapped
+  if (last_token_read() >= token)
+    return;
+  // Only trace actual stalls. They show up nested in the allocation or call
+  // that had to wait for the service.
+  TRACE_EVENT1("gpu", "CommandBufferHelper::WaitForToken", "token", token);
   while (last_token_read() < token) {
     if (get_offset() == put_) {
       LOG(FATAL) << "Empty command buffer while waiting on a token.";
@@ -2366,8 +2366,10 @@ void GLES2Implementation::ActiveTexture(GLenum texture) {
     return;
   }
 
-  active_texture_unit_ = texture_index;
-  helper_->ActiveTexture(texture);
+  if (active_texture_unit_ != texture_index) {
+    active_texture_unit_ = texture_index;
+    helper_->ActiveTexture(texture);
+  }
   CheckGLError();
 }
 
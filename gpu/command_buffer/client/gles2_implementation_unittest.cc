@@ -2614,6 +2614,25 @@ TEST_F(GLES2ImplementationTest, BindVertexArrayOES) {
   EXPECT_TRUE(NoCommandsWritten());
 }
 
+TEST_F(GLES2ImplementationTest, ActiveTexture) {
+  // The initial texture unit is already active.
+  gl_->ActiveTexture(GL_TEXTURE0);
+  EXPECT_TRUE(NoCommandsWritten());
+
+  struct Cmds {
+    cmds::ActiveTexture cmd;
+  };
+  Cmds expected;
+  expected.cmd.Init(GL_TEXTURE4);
+
+  const void* commands = GetPut();
+  gl_->ActiveTexture(GL_TEXTURE4);
+  EXPECT_EQ(0, memcmp(&expected, commands, sizeof(expected)));
+  ClearCommands();
+  gl_->ActiveTexture(GL_TEXTURE4);
+  EXPECT_TRUE(NoCommandsWritten());
+}
+
 TEST_F(GLES2ImplementationTest, BeginEndQueryEXT) {
   // Test GetQueryivEXT returns 0 if no current query.
   GLint param = -1;
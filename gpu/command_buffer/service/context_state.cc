@@ -46,6 +46,28 @@ GLuint GetArbServiceId(const TextureUnit& unit) {
       ? unit.bound_texture_rectangle_arb->service_id() : 0;
 }
 
+GLuint GetProgramServiceId(const ContextState& state) {
+  return state.current_program.get() ? state.current_program->service_id() : 0;
+}
+
+bool AttribsEqual(const VertexAttrib* a, const VertexAttrib* b) {
+  GLuint buffer_a = a->buffer() ? a->buffer()->service_id() : 0;
+  GLuint buffer_b = b->buffer() ? b->buffer()->service_id() : 0;
+  return buffer_a == buffer_b &&
+         a->offset() == b->offset() &&
+         a->size() == b->size() &&
+         a->type() == b->type() &&
+         a->normalized() == b->normalized() &&
+         a->gl_stride() == b->gl_stride() &&
+         a->divisor() == b->divisor() &&
+         a->enabled() == b->enabled();
+}
+
+bool Vec4sEqual(const Vec4& a, const Vec4& b) {
+  return a.v[0] == b.v[0] && a.v[1] == b.v[1] &&
+         a.v[2] == b.v[2] && a.v[3] == b.v[3];
+}
+
 }  // anonymous namespace.
 
 TextureUnit::TextureUnit()
@@ -130,8 +152,12 @@ void ContextState::RestoreRenderbufferBindings() const {
       bound_renderbuffer.get() ? bound_renderbuffer->service_id() : 0);
 }
 
-void ContextState::RestoreProgramBindings() const {
-  glUseProgram(current_program.get() ? current_program->service_id() : 0);
+void ContextState::RestoreProgramBindings(
+    const ContextState* prev_state) const {
+  GLuint service_id = GetProgramServiceId(*this);
+  if (prev_state && service_id == GetProgramServiceId(*prev_state))
+    return;
+  glUseProgram(service_id);
 }
 
 void ContextState::RestoreActiveTexture() const {
@@ -172,9 +198,9 @@ void ContextState::RestoreAttribute(GLuint attrib_index) const {
   glVertexAttrib4fv(attrib_index, attrib_values[attrib_index].v);
 }
 
-void ContextState::RestoreGlobalState() const {
-  InitCapabilities();
-  InitState();
+void ContextState::RestoreGlobalState(const ContextState* prev_state) const {
+  InitCapabilities(prev_state);
+  InitState(prev_state);
 }
 
 void ContextState::RestoreState(const ContextState* prev_state) const {
@@ -184,17 +210,28 @@ void ContextState::RestoreState(const ContextState* prev_state) const {
   // TODO: This if should not be needed. RestoreState is getting called
   // before GLES2Decoder::Initialize which is a bug.
   if (vertex_attrib_manager.get()) {
+    // Only the attributes which differ from |prev_state| need restoring.
+    VertexAttribManager* prev_attrib_manager =
+        prev_state ? prev_state->vertex_attrib_manager.get() : NULL;
     // TODO(gman): Move this restoration to VertexAttribManager.
     for (size_t attrib = 0; attrib < vertex_attrib_manager->num_attribs();
          ++attrib) {
+      if (prev_attrib_manager &&
+          attrib < prev_attrib_manager->num_attribs() &&
+          AttribsEqual(vertex_attrib_manager->GetVertexAttrib(attrib),
+                       prev_attrib_manager->GetVertexAttrib(attrib)) &&
+          Vec4sEqual(attrib_values[attrib],
+                     prev_state->attrib_values[attrib])) {
+        continue;
+      }
       RestoreAttribute(attrib);
     }
   }
 
   RestoreBufferBindings();
   RestoreRenderbufferBindings();
-  RestoreProgramBindings();
-  RestoreGlobalState();
+  RestoreProgramBindings(prev_state);
+  RestoreGlobalState(prev_state);
 }
 
 ErrorState* ContextState::GetErrorState() {
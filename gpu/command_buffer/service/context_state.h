@@ -99,15 +99,18 @@ struct GPU_EXPORT ContextState {
   void Initialize();
 
   void RestoreState(const ContextState* prev_state) const;
-  void InitCapabilities() const;
-  void InitState() const;
+  // Set the capabilities and state to the tracked values.  If |prev_state| is
+  // not NULL, it is the state the GL context is currently in, and only the
+  // values which differ from it are set.
+  void InitCapabilities(const ContextState* prev_state) const;
+  void InitState(const ContextState* prev_state) const;
 
   void RestoreActiveTexture() const;
   void RestoreAllTextureUnitBindings(const ContextState* prev_state) const;
   void RestoreAttribute(GLuint index) const;
   void RestoreBufferBindings() const;
-  void RestoreGlobalState() const;
-  void RestoreProgramBindings() const;
+  void RestoreGlobalState(const ContextState* prev_state) const;
+  void RestoreProgramBindings(const ContextState* prev_state) const;
   void RestoreRenderbufferBindings() const;
   void RestoreTextureUnitBindings(
       GLuint unit, const ContextState* prev_state) const;
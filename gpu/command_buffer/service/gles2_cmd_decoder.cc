@@ -21,6 +21,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
 #include "build/build_config.h"
 #define GLES2_GPU_SERVICE 1
 #include "gpu/command_buffer/common/debug_marker_manager.h"
@@ -246,6 +247,53 @@ const CommandInfo g_command_info[] = {
   #undef GLES2_CMD_OP
 };
 
+// The number of times each command was processed in a decoding batch, and the
+// CPU time spent on it. Traced as a snapshot of the decoder.
+class CommandProfile : public base::debug::ConvertableToTraceFormat {
+ public:
+  CommandProfile() : entries_(arraysize(g_command_info)) {}
+
+  void AddCommand(unsigned int command_index, base::TimeDelta time) {
+    Entry& entry = entries_[command_index];
+    ++entry.count;
+    entry.time += time;
+  }
+
+  // base::debug::ConvertableToTraceFormat implementation.
+  virtual void AppendAsTraceFormat(std::string* out) const OVERRIDE {
+    *out += "{";
+    bool first = true;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      const Entry& entry = entries_[i];
+      if (!entry.count)
+        continue;
+      base::StringAppendF(
+          out,
+          "%s\"%s\":{\"count\":%d,\"cpu_time_us\":%d}",
+          first ? "" : ",",
+          GetCommandName(static_cast<CommandId>(i + kStartPoint + 1)),
+          entry.count,
+          static_cast<int>(entry.time.InMicroseconds()));
+      first = false;
+    }
+    *out += "}";
+  }
+
+ private:
+  struct Entry {
+    Entry() : count(0) {}
+
+    int count;
+    base::TimeDelta time;
+  };
+
+  virtual ~CommandProfile() {}
+
+  std::vector<Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(CommandProfile);
+};
+
 // Return true if a character belongs to the ASCII subset as defined in
 // GLSL ES 1.0 spec section 3.1.
 static bool CharacterIsValidForGLES(unsigned char c) {
@@ -555,10 +603,10 @@ class GLES2DecoderImpl : public GLES2Decoder,
     state_.RestoreBufferBindings();
   }
   virtual void RestoreGlobalState() const OVERRIDE {
-    state_.RestoreGlobalState();
+    state_.RestoreGlobalState(NULL);
   }
   virtual void RestoreProgramBindings() const OVERRIDE {
-    state_.RestoreProgramBindings();
+    state_.RestoreProgramBindings(NULL);
   }
   virtual void RestoreTextureUnitBindings(unsigned unit) const OVERRIDE {
     state_.RestoreTextureUnitBindings(unit, NULL);
@@ -1701,6 +1749,10 @@ class GLES2DecoderImpl : public GLES2Decoder,
   int gpu_trace_level_;
   bool gpu_trace_commands_;
 
+  // Gathers the commands of the current decoding batch while gpu_tracer_ is
+  // tracing. NULL otherwise.
+  scoped_refptr<CommandProfile> command_profile_;
+
   std::queue<linked_ptr<FenceCallback> > pending_readpixel_fences_;
 
   // Used to validate multisample renderbuffers if needed
@@ -2502,8 +2554,8 @@ bool GLES2DecoderImpl::Initialize(
   state_.scissor_height = state_.viewport_height;
 
   // Set all the default state because some GL drivers get it wrong.
-  state_.InitCapabilities();
-  state_.InitState();
+  state_.InitCapabilities(NULL);
+  state_.InitState(NULL);
   glActiveTexture(GL_TEXTURE0 + state_.active_texture_unit);
 
   DoBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -3132,10 +3184,21 @@ Logger* GLES2DecoderImpl::GetLogger() {
 void GLES2DecoderImpl::BeginDecoding() {
   gpu_tracer_->BeginDecoding();
   gpu_trace_commands_ = gpu_tracer_->IsTracing();
+  if (gpu_trace_commands_)
+    command_profile_ = new CommandProfile;
 }
 
 void GLES2DecoderImpl::EndDecoding() {
   gpu_tracer_->EndDecoding();
+  if (command_profile_.get()) {
+    TRACE_EVENT_OBJECT_SNAPSHOT_WITH_ID(
+        TRACE_DISABLED_BY_DEFAULT("gpu.service"),
+        "gpu::DecoderCommandProfile",
+        this,
+        scoped_refptr<base::debug::ConvertableToTraceFormat>(
+            command_profile_));
+    command_profile_ = NULL;
+  }
 }
 
 ErrorState* GLES2DecoderImpl::GetErrorState() {
@@ -3542,11 +3605,14 @@ error::Error GLES2DecoderImpl::DoCommand(
     if ((info.arg_flags == cmd::kFixed && arg_count == info_arg_count) ||
         (info.arg_flags == cmd::kAtLeastN && arg_count >= info_arg_count)) {
       bool doing_gpu_trace = false;
+      base::TimeTicks begin_time;
       if (gpu_trace_commands_) {
         if (CMD_FLAG_GET_TRACE_LEVEL(info.cmd_flags) <= gpu_trace_level_) {
           doing_gpu_trace = true;
           gpu_tracer_->Begin(GetCommandName(command), kTraceDecoder);
         }
+        if (command_profile_.get())
+          begin_time = base::TimeTicks::HighResNow();
       }
 
       uint32 immediate_data_size =
@@ -3566,6 +3632,11 @@ error::Error GLES2DecoderImpl::DoCommand(
       if (doing_gpu_trace)
         gpu_tracer_->End(kTraceDecoder);
 
+      if (command_profile_.get()) {
+        command_profile_->AddCommand(
+            command_index, base::TimeTicks::HighResNow() - begin_time);
+      }
+
       if (debug()) {
         GLenum error;
         while ((error = glGetError()) != GL_NO_ERROR) {
@@ -8853,6 +8853,74 @@ TEST_F(GLES2DecoderRestoreStateTest, NonDefaultUnit1) {
   GetDecoder()->RestoreAllTextureUnitBindings(&prev_state);
 }
 
+TEST_F(GLES2DecoderRestoreStateTest, GlobalStateWithPreviousState) {
+  InitDecoder(
+      "",      // extensions
+      "3.0",   // gl version
+      false,   // has alpha
+      false,   // has depth
+      false,   // has stencil
+      false,   // request alpha
+      false,   // request depth
+      false,   // request stencil
+      false);  // bind generates resource
+
+  ContextState state(group().feature_info(), NULL);
+  state.enable_flags.blend = true;
+  state.line_width = 2.0f;
+  state.scissor_width = 16;
+  ContextState prev_state(group().feature_info(), NULL);
+
+  // Expect to restore only the state which differs from |prev_state|, plus
+  // the capabilities and write masks which ApplyDirtyState() manages, as GL
+  // may not hold their tracked values.
+  for (int pass = 0; pass < 2; ++pass) {
+    InSequence sequence;
+    EXPECT_CALL(*gl_, Enable(GL_BLEND))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, Disable(GL_CULL_FACE))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, Disable(GL_DEPTH_TEST))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, Disable(GL_SCISSOR_TEST))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, Disable(GL_STENCIL_TEST))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, ColorMask(true, true, true, true))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, DepthMask(true))
+        .Times(1)
+        .RetiresOnSaturation();
+    if (pass == 0) {
+      EXPECT_CALL(*gl_, LineWidth(2.0f))
+          .Times(1)
+          .RetiresOnSaturation();
+      EXPECT_CALL(*gl_, Scissor(0, 0, 16, state.scissor_height))
+          .Times(1)
+          .RetiresOnSaturation();
+    }
+    EXPECT_CALL(*gl_, StencilMaskSeparate(GL_FRONT, 0xFFFFFFFFU))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, StencilMaskSeparate(GL_BACK, 0xFFFFFFFFU))
+        .Times(1)
+        .RetiresOnSaturation();
+
+    state.RestoreGlobalState(&prev_state);
+
+    // The second pass switches between otherwise identical states.
+    prev_state.enable_flags.blend = true;
+    prev_state.line_width = 2.0f;
+    prev_state.scissor_width = 16;
+  }
+}
+
 TEST_F(GLES2DecoderManualInitTest, ClearUniformsBeforeFirstProgramUse) {
   CommandLine command_line(0, NULL);
   command_line.AppendSwitchASCII(
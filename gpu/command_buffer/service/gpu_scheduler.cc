@@ -24,6 +24,9 @@ namespace gpu {
 
 const int64 kUnscheduleFenceTimeOutDelay = 10000;
 
+// How many commands PutChanged processes between checks of its time slice.
+const int kCommandsPerTimeSliceCheck = 32;
+
 #if defined(OS_WIN)
 const int64 kRescheduleTimeOutDelay = 1000;
 #endif
@@ -71,6 +74,7 @@ void GpuScheduler::PutChanged() {
   error::Error error = error::kNoError;
   if (decoder_)
     decoder_->BeginDecoding();
+  int commands_processed = 0;
   while (!parser_->IsEmpty()) {
     if (IsPreempted())
       break;
@@ -103,6 +107,15 @@ void GpuScheduler::PutChanged() {
 
     if (unscheduled_count_ > 0)
       break;
+
+    if (time_slice_ != base::TimeDelta() &&
+        ++commands_processed % kCommandsPerTimeSliceCheck == 0 &&
+        base::TimeTicks::HighResNow() - begin_time > time_slice_) {
+      TRACE_EVENT_INSTANT1("gpu", "GpuScheduler:TimeSliceExpired",
+                           TRACE_EVENT_SCOPE_THREAD,
+                           "commands_processed", commands_processed);
+      break;
+    }
   }
 
   if (decoder_) {
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "base/message_loop/message_loop.h"
+#include "base/threading/platform_thread.h"
 #include "gpu/command_buffer/common/command_buffer_mock.h"
 #include "gpu/command_buffer/service/gles2_cmd_decoder.h"
 #include "gpu/command_buffer/service/gles2_cmd_decoder_mock.h"
@@ -18,6 +19,7 @@
 using testing::_;
 using testing::DoAll;
 using testing::Invoke;
+using testing::InvokeWithoutArgs;
 using testing::NiceMock;
 using testing::Return;
 using testing::SetArgumentPointee;
@@ -28,6 +30,10 @@ namespace gpu {
 const size_t kRingBufferSize = 1024;
 const size_t kRingBufferEntries = kRingBufferSize / sizeof(CommandBufferEntry);
 
+void SleepOneMillisecond() {
+  base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+}
+
 class GpuSchedulerTest : public testing::Test {
  protected:
   static const int32 kTransferBufferId = 123;
@@ -157,6 +163,35 @@ TEST_F(GpuSchedulerTest, ProcessesTwoCommands) {
   scheduler_->PutChanged();
 }
 
+TEST_F(GpuSchedulerTest, StopsWhenTimeSliceExpires) {
+  // 64 single entry commands, each of which takes at least a millisecond.
+  const int kCommandCount = 64;
+  CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
+  for (int i = 0; i < kCommandCount; ++i) {
+    header[i].command = 7;
+    header[i].size = 1;
+  }
+
+  CommandBuffer::State state;
+
+  state.put_offset = kCommandCount;
+  EXPECT_CALL(*command_buffer_, GetState())
+    .WillRepeatedly(Return(state));
+
+  // The time slice is only checked every 32 commands, and it has expired by
+  // then.
+  EXPECT_CALL(*decoder_, DoCommand(7, 0, _))
+    .Times(32)
+    .WillRepeatedly(DoAll(InvokeWithoutArgs(SleepOneMillisecond),
+                          Return(error::kNoError)));
+  EXPECT_CALL(*command_buffer_, SetGetOffset(_))
+    .Times(32);
+
+  scheduler_->SetTimeSlice(base::TimeDelta::FromMilliseconds(1));
+  scheduler_->PutChanged();
+  EXPECT_EQ(32, scheduler_->GetGetOffset());
+}
+
 TEST_F(GpuSchedulerTest, SetsErrorCodeOnCommandBuffer) {
   CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
   header[0].command = 7;
@@ -223,16 +223,7 @@ void MemoryProgramCache::SaveLinkedProgram(
   UMA_HISTOGRAM_COUNTS("GPU.ProgramCache.MemorySizeBeforeKb",
                        curr_size_bytes_ / 1024);
 
-  // Evict any cached program with the same key in favor of the least recently
-  // accessed.
-  ProgramMRUCache::iterator existing = store_.Peek(sha_string);
-  if(existing != store_.end())
-    store_.Erase(existing);
-
-  while (curr_size_bytes_ + length > max_size_bytes_) {
-    DCHECK(!store_.empty());
-    store_.Erase(store_.rbegin());
-  }
+  MakeRoomForProgram(sha_string, length);
 
   if (!shader_callback.is_null() &&
       !CommandLine::ForCurrentProcess()->HasSwitch(
@@ -305,11 +296,18 @@ void MemoryProgramCache::LoadProgram(const std::string& program) {
                          &fragment_varyings);
     }
 
-    scoped_ptr<char[]> binary(new char[proto->program().length()]);
-    memcpy(binary.get(), proto->program().c_str(), proto->program().length());
+    // Programs pushed from the disk cache are held to the same size limit as
+    // the ones linked in this process.
+    const size_t length = proto->program().length();
+    if (length == 0 || length > max_size_bytes_)
+      return;
+    MakeRoomForProgram(proto->sha(), length);
+
+    scoped_ptr<char[]> binary(new char[length]);
+    memcpy(binary.get(), proto->program().c_str(), length);
 
     store_.Put(proto->sha(),
-               new ProgramCacheValue(proto->program().length(),
+               new ProgramCacheValue(length,
                                      proto->format(),
                                      binary.release(),
                                      proto->sha(),
@@ -330,6 +328,20 @@ void MemoryProgramCache::LoadProgram(const std::string& program) {
   }
 }
 
+void MemoryProgramCache::MakeRoomForProgram(const std::string& program_hash,
+                                            size_t length) {
+  // Evict any cached program with the same key in favor of the least recently
+  // accessed.
+  ProgramMRUCache::iterator existing = store_.Peek(program_hash);
+  if (existing != store_.end())
+    store_.Erase(existing);
+
+  while (curr_size_bytes_ + length > max_size_bytes_) {
+    DCHECK(!store_.empty());
+    store_.Erase(store_.rbegin());
+  }
+}
+
 MemoryProgramCache::ProgramCacheValue::ProgramCacheValue(
     GLsizei length,
     GLenum format,
@@ -48,6 +48,10 @@ class GPU_EXPORT MemoryProgramCache : public ProgramCache {
  private:
   virtual void ClearBackend() OVERRIDE;
 
+  // Evicts the program stored under |program_hash|, then the least recently
+  // used programs until one of |length| bytes fits.
+  void MakeRoomForProgram(const std::string& program_hash, size_t length);
+
   class ProgramCacheValue : public base::RefCounted<ProgramCacheValue> {
    public:
     ProgramCacheValue(GLsizei length,
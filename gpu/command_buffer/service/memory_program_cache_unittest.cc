@@ -540,6 +540,66 @@ TEST_F(MemoryProgramCacheTest, MemoryProgramCacheEviction) {
       NULL));
 }
 
+TEST_F(MemoryProgramCacheTest, LoadProgramEviction) {
+  const GLenum kFormat = 1;
+  const int kProgramId = 10;
+  const int kBinaryLength = 20;
+  char test_binary[kBinaryLength];
+  for (int i = 0; i < kBinaryLength; ++i) {
+    test_binary[i] = i;
+  }
+  ProgramBinaryEmulator emulator1(kBinaryLength, kFormat, test_binary);
+
+  SetExpectationsForSaveLinkedProgram(kProgramId, &emulator1);
+  cache_->SaveLinkedProgram(kProgramId, vertex_shader_, NULL,
+                            fragment_shader_, NULL, NULL,
+                            base::Bind(&MemoryProgramCacheTest::ShaderCacheCb,
+                                       base::Unretained(this)));
+  const std::string loaded_shader = shader_cache_shader();
+  const std::string loaded_source = *fragment_shader_->signature_source();
+  cache_->Clear();
+
+  const int kFillingProgramId = 11;
+  const GLuint kFillingBinaryLength = kCacheSizeBytes - kBinaryLength + 1;
+  fragment_shader_->UpdateSource("al sdfkjdk");
+  fragment_shader_->SetStatus(true, NULL, NULL);
+
+  scoped_ptr<char[]> bigTestBinary =
+      scoped_ptr<char[]>(new char[kFillingBinaryLength]);
+  for (size_t i = 0; i < kFillingBinaryLength; ++i) {
+    bigTestBinary[i] = i % 250;
+  }
+  ProgramBinaryEmulator emulator2(kFillingBinaryLength,
+                                  kFormat,
+                                  bigTestBinary.get());
+
+  SetExpectationsForSaveLinkedProgram(kFillingProgramId, &emulator2);
+  cache_->SaveLinkedProgram(kFillingProgramId,
+                            vertex_shader_,
+                            NULL,
+                            fragment_shader_,
+                            NULL,
+                            NULL,
+                            base::Bind(&MemoryProgramCacheTest::ShaderCacheCb,
+                                       base::Unretained(this)));
+
+  // Loading the first program back doesn't fit next to the second one, which
+  // gets evicted.
+  cache_->LoadProgram(loaded_shader);
+  EXPECT_EQ(ProgramCache::LINK_SUCCEEDED, cache_->GetLinkedProgramStatus(
+      *vertex_shader_->signature_source(),
+      NULL,
+      loaded_source,
+      NULL,
+      NULL));
+  EXPECT_EQ(ProgramCache::LINK_UNKNOWN, cache_->GetLinkedProgramStatus(
+      *vertex_shader_->signature_source(),
+      NULL,
+      *fragment_shader_->signature_source(),
+      NULL,
+      NULL));
+}
+
 TEST_F(MemoryProgramCacheTest, SaveCorrectProgram) {
   const GLenum kFormat = 1;
   const int kProgramId = 10;
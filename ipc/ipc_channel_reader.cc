@@ -55,7 +55,8 @@ bool ChannelReader::DispatchInputData(const char* input_data,
   const char* end;
 
   // Possibly combine with the overflow buffer to make a larger buffer.
-  if (input_overflow_buf_.empty()) {
+  bool using_overflow_buf = !input_overflow_buf_.empty();
+  if (!using_overflow_buf) {
     p = input_data;
     end = input_data + input_data_len;
   } else {
@@ -102,8 +103,26 @@ bool ChannelReader::DispatchInputData(const char* input_data,
     }
   }
 
-  // Save any partial data in the overflow buffer.
-  input_overflow_buf_.assign(p, end - p);
+  // Save any partial data in the overflow buffer.  If the data is already in
+  // the overflow buffer, just drop the dispatched messages from its front,
+  // rather than assigning the buffer to itself after every read of a large
+  // message.
+  if (!using_overflow_buf)
+    input_overflow_buf_.assign(p, end - p);
+  else if (p != input_overflow_buf_.data())
+    input_overflow_buf_.erase(0, p - input_overflow_buf_.data());
+
+  // Once the header of the partial message is in, make room for all of it, so
+  // that the buffer doesn't get reallocated and copied as it grows.
+  if (!input_overflow_buf_.empty()) {
+    size_t message_size = Message::GetMessageSize(
+        input_overflow_buf_.data(),
+        input_overflow_buf_.data() + input_overflow_buf_.size());
+    if (message_size > input_overflow_buf_.capacity() &&
+        message_size <= Channel::kMaximumMessageSize) {
+      input_overflow_buf_.reserve(message_size);
+    }
+  }
 
   if (input_overflow_buf_.empty() && !DidEmptyInputBuffers())
     return false;
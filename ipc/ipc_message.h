@@ -179,6 +179,16 @@ class IPC_EXPORT Message : public Pickle {
     return Pickle::FindNext(sizeof(Header), range_start, range_end);
   }
 
+  // Returns the total size of the message that starts at range_start, as
+  // given by its header, or 0 if the range is too short to hold the header.
+  static size_t GetMessageSize(const char* range_start,
+                               const char* range_end) {
+    if (static_cast<size_t>(range_end - range_start) < sizeof(Header))
+      return 0;
+    return sizeof(Header) +
+        reinterpret_cast<const Header*>(range_start)->payload_size;
+  }
+
 #if defined(OS_POSIX)
   // On POSIX, a message supports reading / writing FileDescriptor objects.
   // This is used to pass a file descriptor to the peer of an IPC channel.
@@ -70,4 +70,20 @@ TEST(IPCMessageTest, DictionaryValue) {
   EXPECT_FALSE(IPC::ReadParam(&bad_msg, &iter, &output));
 }
 
+TEST(IPCMessageTest, GetMessageSize) {
+  IPC::Message msg(1, 2, IPC::Message::PRIORITY_NORMAL);
+  msg.WriteString(std::string(100, 'x'));
+  const char* data = static_cast<const char*>(msg.data());
+  size_t header_size = msg.size() - msg.payload_size();
+
+  EXPECT_EQ(msg.size(), IPC::Message::GetMessageSize(data, data + msg.size()));
+
+  // A partial message is enough, as long as the header is there.
+  EXPECT_EQ(msg.size(),
+            IPC::Message::GetMessageSize(data, data + header_size));
+  EXPECT_EQ(0u,
+            IPC::Message::GetMessageSize(data, data + header_size - 1));
+  EXPECT_EQ(0u, IPC::Message::GetMessageSize(data, data));
+}
+
 }  // namespace
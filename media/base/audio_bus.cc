@@ -6,10 +6,15 @@
 
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
+#include "build/build_config.h"
 #include "media/audio/audio_parameters.h"
 #include "media/base/limits.h"
 #include "media/base/vector_math.h"
 
+#if defined(ARCH_CPU_X86_FAMILY) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace media {
 
 static const uint8 kUint8Bias = 128;
@@ -83,6 +88,105 @@ static void ToInterleavedInternal(const AudioBus* source, int start_frame,
   }
 }
 
+// Mono and stereo int16 are what nearly every audio stream uses, so they get
+// their own SSE2 conversions when SSE2 is part of the compile time baseline.
+// They produce the same values as the generic versions above, and return the
+// number of frames they converted; the caller converts the rest.
+#if defined(ARCH_CPU_X86_FAMILY) && defined(__SSE2__)
+// Converts the 8 int16 in |source| to floats in [-1, 1].
+static void Int16ToFloat(__m128i source, __m128* lo, __m128* hi) {
+  const __m128 kNegativeScale = _mm_set1_ps(-1.0f / kint16min);
+  const __m128 kPositiveScale = _mm_set1_ps(1.0f / kint16max);
+  // Sign extend to int32 by unpacking into the upper halves.
+  *lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(source, source), 16));
+  *hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(source, source), 16));
+
+  __m128 negative = _mm_cmplt_ps(*lo, _mm_setzero_ps());
+  *lo = _mm_mul_ps(*lo, _mm_or_ps(_mm_and_ps(negative, kNegativeScale),
+                                  _mm_andnot_ps(negative, kPositiveScale)));
+  negative = _mm_cmplt_ps(*hi, _mm_setzero_ps());
+  *hi = _mm_mul_ps(*hi, _mm_or_ps(_mm_and_ps(negative, kNegativeScale),
+                                  _mm_andnot_ps(negative, kPositiveScale)));
+}
+
+// Converts the 4 floats in |source| to int16 values, widened to int32.
+static __m128i FloatToInt16(__m128 source) {
+  const __m128 kNegativeScale = _mm_set1_ps(-static_cast<float>(kint16min));
+  const __m128 kPositiveScale = _mm_set1_ps(kint16max);
+  source = _mm_min_ps(_mm_max_ps(source, _mm_set1_ps(-1.0f)),
+                      _mm_set1_ps(1.0f));
+  const __m128 negative = _mm_cmplt_ps(source, _mm_setzero_ps());
+  return _mm_cvttps_epi32(_mm_mul_ps(
+      source, _mm_or_ps(_mm_and_ps(negative, kNegativeScale),
+                        _mm_andnot_ps(negative, kPositiveScale))));
+}
+
+static int FromInterleavedInt16SSE2(const int16* source, int start_frame,
+                                    int frames, AudioBus* dest) {
+  __m128 lo;
+  __m128 hi;
+  if (dest->channels() == 1) {
+    float* channel_data = dest->channel(0) + start_frame;
+    const int last_frame = frames - frames % 8;
+    for (int i = 0; i < last_frame; i += 8) {
+      Int16ToFloat(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)),
+          &lo, &hi);
+      _mm_storeu_ps(channel_data + i, lo);
+      _mm_storeu_ps(channel_data + i + 4, hi);
+    }
+    return last_frame;
+  }
+
+  if (dest->channels() == 2) {
+    float* left = dest->channel(0) + start_frame;
+    float* right = dest->channel(1) + start_frame;
+    const int last_frame = frames - frames % 4;
+    for (int i = 0; i < last_frame; i += 4) {
+      Int16ToFloat(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 2 * i)),
+          &lo, &hi);
+      _mm_storeu_ps(left + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(right + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    return last_frame;
+  }
+
+  return 0;
+}
+
+static int ToInterleavedInt16SSE2(const AudioBus* source, int start_frame,
+                                  int frames, int16* dest) {
+  if (source->channels() == 1) {
+    const float* channel_data = source->channel(0) + start_frame;
+    const int last_frame = frames - frames % 8;
+    for (int i = 0; i < last_frame; i += 8) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(
+          FloatToInt16(_mm_loadu_ps(channel_data + i)),
+          FloatToInt16(_mm_loadu_ps(channel_data + i + 4))));
+    }
+    return last_frame;
+  }
+
+  if (source->channels() == 2) {
+    const float* left = source->channel(0) + start_frame;
+    const float* right = source->channel(1) + start_frame;
+    const int last_frame = frames - frames % 4;
+    for (int i = 0; i < last_frame; i += 4) {
+      const __m128i left_samples = FloatToInt16(_mm_loadu_ps(left + i));
+      const __m128i right_samples = FloatToInt16(_mm_loadu_ps(right + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i),
+                       _mm_packs_epi32(
+                           _mm_unpacklo_epi32(left_samples, right_samples),
+                           _mm_unpackhi_epi32(left_samples, right_samples)));
+    }
+    return last_frame;
+  }
+
+  return 0;
+}
+#endif
+
 static void ValidateConfig(int channels, int frames) {
   CHECK_GT(frames, 0);
   CHECK_GT(channels, 0);
@@ -246,11 +350,18 @@ void AudioBus::FromInterleavedPartial(const void* source, int start_frame,
           source, start_frame, frames, this,
           1.0f / kint8min, 1.0f / kint8max);
       break;
-    case 2:
+    case 2: {
+      int converted_frames = 0;
+#if defined(ARCH_CPU_X86_FAMILY) && defined(__SSE2__)
+      converted_frames = FromInterleavedInt16SSE2(
+          static_cast<const int16*>(source), start_frame, frames, this);
+#endif
       FromInterleavedInternal<int16, int16, 0>(
-          source, start_frame, frames, this,
+          static_cast<const int16*>(source) + converted_frames * channels(),
+          start_frame + converted_frames, frames - converted_frames, this,
           1.0f / kint16min, 1.0f / kint16max);
       break;
+    }
     case 4:
       FromInterleavedInternal<int32, int32, 0>(
           source, start_frame, frames, this,
@@ -279,7 +390,6 @@ void AudioBus::ToInterleaved(int frames, int bytes_per_sample,
   ToInterleavedPartial(0, frames, bytes_per_sample, dest);
 }
 
-// TODO(dalecurtis): See if intrinsic optimizations help any here.
 void AudioBus::ToInterleavedPartial(int start_frame, int frames,
                                     int bytes_per_sample, void* dest) const {
   CheckOverflow(start_frame, frames, frames_);
@@ -288,10 +398,18 @@ void AudioBus::ToInterleavedPartial(int start_frame, int frames,
       ToInterleavedInternal<uint8, int16, kUint8Bias>(
           this, start_frame, frames, dest, kint8min, kint8max);
       break;
-    case 2:
+    case 2: {
+      int converted_frames = 0;
+#if defined(ARCH_CPU_X86_FAMILY) && defined(__SSE2__)
+      converted_frames = ToInterleavedInt16SSE2(
+          this, start_frame, frames, static_cast<int16*>(dest));
+#endif
       ToInterleavedInternal<int16, int16, 0>(
-          this, start_frame, frames, dest, kint16min, kint16max);
+          this, start_frame + converted_frames, frames - converted_frames,
+          static_cast<int16*>(dest) + converted_frames * channels(),
+          kint16min, kint16max);
       break;
+    }
     case 4:
       ToInterleavedInternal<int32, int32, 0>(
           this, start_frame, frames, dest, kint32min, kint32max);
@@ -382,6 +382,67 @@ TEST_F(AudioBusTest, ToInterleavedPartial) {
       kPartialFrames * sizeof(*kTestVectorInt16) * kTestVectorChannels), 0);
 }
 
+// Verify int16 conversions of mono and stereo buses, which have optimized
+// implementations on some platforms, match the conversion of other formats
+// over the full range of values, including partial frames.
+TEST_F(AudioBusTest, Int16MonoAndStereo) {
+  // Not a multiple of any vector size.
+  static const int kFrames = 67;
+  static const int kPartialStart = 3;
+
+  for (int channels = 1; channels <= 2; ++channels) {
+    SCOPED_TRACE(base::StringPrintf("channels=%d", channels));
+    scoped_ptr<AudioBus> bus = AudioBus::Create(channels, kFrames);
+    const int samples = channels * kFrames;
+
+    // Spread the values over the whole range, including the extremes.
+    scoped_ptr<int16[]> interleaved(new int16[samples]);
+    for (int i = 0; i < samples; ++i)
+      interleaved[i] = static_cast<int16>(kint16min + i * 977);
+    interleaved[0] = kint16min;
+    interleaved[samples - 1] = kint16max;
+
+    bus->Zero();
+    bus->FromInterleavedPartial(
+        interleaved.get() + kPartialStart * channels, kPartialStart,
+        kFrames - kPartialStart, sizeof(int16));
+    for (int ch = 0; ch < channels; ++ch) {
+      for (int i = 0; i < kFrames; ++i) {
+        SCOPED_TRACE(base::StringPrintf("ch=%d, i=%d", ch, i));
+        if (i < kPartialStart) {
+          ASSERT_EQ(0.0f, bus->channel(ch)[i]);
+          continue;
+        }
+        const int16 v = interleaved[i * channels + ch];
+        ASSERT_EQ(v * (v < 0 ? -1.0f / kint16min : 1.0f / kint16max),
+                  bus->channel(ch)[i]);
+      }
+    }
+
+    // Include values out of range, and the exact range limits.
+    for (int ch = 0; ch < channels; ++ch) {
+      for (int i = 0; i < kFrames; ++i)
+        bus->channel(ch)[i] = -1.5f + (i * channels + ch) * 3.0f / samples;
+      bus->channel(ch)[0] = -1.0f;
+      bus->channel(ch)[1] = 1.0f;
+      bus->channel(ch)[2] = 0.0f;
+    }
+    bus->ToInterleaved(kFrames, sizeof(int16), interleaved.get());
+    for (int ch = 0; ch < channels; ++ch) {
+      for (int i = 0; i < kFrames; ++i) {
+        SCOPED_TRACE(base::StringPrintf("ch=%d, i=%d", ch, i));
+        const float v = bus->channel(ch)[i];
+        int16 expected;
+        if (v < 0)
+          expected = v <= -1 ? kint16min : static_cast<int16>(-v * kint16min);
+        else
+          expected = v >= 1 ? kint16max : static_cast<int16>(v * kint16max);
+        ASSERT_EQ(expected, interleaved[i * channels + ch]);
+      }
+    }
+  }
+}
+
 TEST_F(AudioBusTest, Scale) {
   scoped_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
 
@@ -194,41 +194,45 @@ void AudioConverter::SourceCallback(int fifo_frame_delay, AudioBus* dest) {
   }
 
   // Have each mixer render its data into an output buffer then mix the result.
+  // The first input with non-zero volume is written into |temp_dest| rather
+  // than mixed into it, so silent inputs cost nothing beyond rendering them.
+  bool temp_dest_written = false;
   for (InputCallbackSet::iterator it = transform_inputs_.begin();
        it != transform_inputs_.end(); ++it) {
     InputCallback* input = *it;
 
     float volume = input->ProvideInput(
         mixer_input_audio_bus_.get(), buffer_delay);
+    if (volume <= 0)
+      continue;
 
     // Optimize the most common single input, full volume case.
-    if (it == transform_inputs_.begin()) {
+    if (!temp_dest_written) {
       if (volume == 1.0f) {
         mixer_input_audio_bus_->CopyTo(temp_dest);
-      } else if (volume > 0) {
+      } else {
         for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
           vector_math::FMUL(
               mixer_input_audio_bus_->channel(i), volume,
               mixer_input_audio_bus_->frames(), temp_dest->channel(i));
         }
-      } else {
-        // Zero |temp_dest| otherwise, so we're mixing into a clean buffer.
-        temp_dest->Zero();
       }
-
+      temp_dest_written = true;
       continue;
     }
 
     // Volume adjust and mix each mixer input into |temp_dest| after rendering.
-    if (volume > 0) {
-      for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
-        vector_math::FMAC(
-            mixer_input_audio_bus_->channel(i), volume,
-            mixer_input_audio_bus_->frames(), temp_dest->channel(i));
-      }
+    for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
+      vector_math::FMAC(
+          mixer_input_audio_bus_->channel(i), volume,
+          mixer_input_audio_bus_->frames(), temp_dest->channel(i));
     }
   }
 
+  // Zero |temp_dest| if every input was silent.
+  if (!temp_dest_written)
+    temp_dest->Zero();
+
   if (needs_downmix) {
     DCHECK_EQ(temp_dest->frames(), dest->frames());
     channel_mixer_->Transform(temp_dest, dest);
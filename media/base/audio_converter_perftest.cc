@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/memory/scoped_vector.h"
 #include "base/time/time.h"
 #include "media/base/audio_converter.h"
 #include "media/base/fake_audio_render_callback.h"
@@ -15,14 +16,18 @@ static const int kBenchmarkIterations = 200000;
 // InputCallback that zero's out the provided AudioBus.
 class NullInputProvider : public AudioConverter::InputCallback {
  public:
-  NullInputProvider() {}
+  NullInputProvider() : volume_(1) {}
+  explicit NullInputProvider(double volume) : volume_(volume) {}
   virtual ~NullInputProvider() {}
 
   virtual double ProvideInput(AudioBus* audio_bus,
                               base::TimeDelta buffer_delay) OVERRIDE {
     audio_bus->Zero();
-    return 1;
+    return volume_;
   }
+
+ private:
+  const double volume_;
 };
 
 void RunConvertBenchmark(const AudioParameters& in_params,
@@ -60,6 +65,35 @@ TEST(AudioConverterPerfTest, ConvertBenchmark) {
   RunConvertBenchmark(input_params, output_params, false, "convert");
 }
 
+// Mixes many inputs, as when a page plays dozens of audio elements through
+// the same AudioRendererMixer.  Every fourth input is silent.
+TEST(AudioConverterPerfTest, ConvertBenchmarkManyInputs) {
+  static const int kInputs = 32;
+  static const int kManyInputsBenchmarkIterations = kBenchmarkIterations / 10;
+
+  AudioParameters input_params(
+      AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 48000, 16, 480);
+  AudioParameters output_params(
+      AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 44100, 16, 440);
+  scoped_ptr<AudioBus> output_bus = AudioBus::Create(output_params);
+
+  AudioConverter converter(input_params, output_params, false);
+  ScopedVector<NullInputProvider> inputs;
+  for (int i = 0; i < kInputs; ++i) {
+    inputs.push_back(new NullInputProvider(i % 4 ? 0.5 : 0));
+    converter.AddInput(inputs.back());
+  }
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kManyInputsBenchmarkIterations; ++i) {
+    converter.Convert(output_bus.get());
+  }
+  double runs_per_second = kManyInputsBenchmarkIterations /
+                           (base::TimeTicks::HighResNow() - start).InSecondsF();
+  perf_test::PrintResult("audio_converter", "", "convert_32_inputs",
+                         runs_per_second, "runs/s", true);
+}
+
 TEST(AudioConverterPerfTest, ConvertBenchmarkFIFO) {
   // Create input and output parameters to convert between common buffer sizes
   // without any resampling for the FIFO vs no FIFO benchmarks.
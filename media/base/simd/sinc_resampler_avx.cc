@@ -0,0 +1,47 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/sinc_resampler.h"
+
+#include <immintrin.h>
+
+namespace media {
+
+float SincResampler::Convolve_AVX(const float* input_ptr, const float* k1,
+                                  const float* k2,
+                                  double kernel_interpolation_factor) {
+  __m256 m_input;
+  __m256 m_products1;
+  __m256 m_products2;
+  __m128 m_sums1 = _mm_setzero_ps();
+  __m128 m_sums2 = _mm_setzero_ps();
+
+  // The kernels are only 16-byte aligned, so always use unaligned loads; they
+  // are as fast as aligned loads on aligned data.  The products are summed in
+  // the same order as Convolve_SSE() does, so that both return the same value.
+  for (int i = 0; i < kKernelSize; i += 8) {
+    m_input = _mm256_loadu_ps(input_ptr + i);
+    m_products1 = _mm256_mul_ps(m_input, _mm256_loadu_ps(k1 + i));
+    m_products2 = _mm256_mul_ps(m_input, _mm256_loadu_ps(k2 + i));
+    m_sums1 = _mm_add_ps(m_sums1, _mm256_castps256_ps128(m_products1));
+    m_sums2 = _mm_add_ps(m_sums2, _mm256_castps256_ps128(m_products2));
+    m_sums1 = _mm_add_ps(m_sums1, _mm256_extractf128_ps(m_products1, 1));
+    m_sums2 = _mm_add_ps(m_sums2, _mm256_extractf128_ps(m_products2, 1));
+  }
+
+  // Linearly interpolate the two "convolutions".
+  m_sums1 = _mm_mul_ps(m_sums1, _mm_set_ps1(1.0 - kernel_interpolation_factor));
+  m_sums2 = _mm_mul_ps(m_sums2, _mm_set_ps1(kernel_interpolation_factor));
+  m_sums1 = _mm_add_ps(m_sums1, m_sums2);
+
+  // Sum components together.
+  float result;
+  m_sums2 = _mm_add_ps(_mm_movehl_ps(m_sums1, m_sums1), m_sums1);
+  _mm_store_ss(&result, _mm_add_ss(m_sums2, _mm_shuffle_ps(
+      m_sums2, m_sums2, 1)));
+
+  return result;
+}
+
+}  // namespace media
@@ -0,0 +1,45 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/vector_math_testing.h"
+
+#include <immintrin.h>  // NOLINT
+
+namespace media {
+namespace vector_math {
+
+// Inputs are only guaranteed to be aligned by kRequiredAlignment (16 bytes),
+// so the AVX routines below use unaligned loads and stores.  These are as fast
+// as the aligned ones when the data happens to be 32-byte aligned.
+
+void FMUL_AVX(const float src[], float scale, int len, float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  __m256 m_scale = _mm256_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] = src[i] * scale;
+}
+
+void FMAC_AVX(const float src[], float scale, int len, float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  __m256 m_scale = _mm256_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i),
+                     _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i] * scale;
+}
+
+}  // namespace vector_math
+}  // namespace media
@@ -69,6 +69,15 @@ TEST(SincResamplerPerfTest, Convolve) {
   RunConvolveBenchmark(
       &resampler, SincResampler::CONVOLVE_FUNC, false, "optimized_unaligned");
 #endif
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx()) {
+    RunConvolveBenchmark(
+        &resampler, SincResampler::Convolve_AVX, true, "avx_aligned");
+    RunConvolveBenchmark(
+        &resampler, SincResampler::Convolve_AVX, false, "avx_unaligned");
+  }
+#endif
 }
 
 #undef CONVOLVE_FUNC
@@ -153,6 +153,24 @@ TEST(SincResamplerTest, Convolve) {
       resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
       resampler.kernel_storage_.get(), kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx()) {
+    SCOPED_TRACE("Convolve_AVX");
+    result2 = resampler.Convolve_AVX(
+        resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+    EXPECT_NEAR(result2, result, kEpsilon);
+
+    result = resampler.Convolve_C(
+        resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+    result2 = resampler.Convolve_AVX(
+        resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+    EXPECT_NEAR(result2, result, kEpsilon);
+  }
+#endif
 }
 #endif
 
@@ -22,14 +22,9 @@ namespace vector_math {
 // Force NaCl code to use C routines since (at present) nothing there uses these
 // methods and plumbing the -msse built library is non-trivial.
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
-#if defined(__SSE__)
-#define FMAC_FUNC FMAC_SSE
-#define FMUL_FUNC FMUL_SSE
-#define EWMAAndMaxPower_FUNC EWMAAndMaxPower_SSE
-void Initialize() {}
-#else
-// X86 CPU detection required.  Functions will be set by Initialize().
-// TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
+// X86 CPU detection required.  Functions will be set by Initialize().  Even
+// when SSE is part of the compile time baseline, AVX support has to be
+// detected at run time.
 #define FMAC_FUNC g_fmac_proc_
 #define FMUL_FUNC g_fmul_proc_
 #define EWMAAndMaxPower_FUNC g_ewma_power_proc_
@@ -45,12 +40,16 @@ void Initialize() {
   CHECK(!g_fmac_proc_);
   CHECK(!g_fmul_proc_);
   CHECK(!g_ewma_power_proc_);
-  const bool kUseSSE = base::CPU().has_sse();
-  g_fmac_proc_ = kUseSSE ? FMAC_SSE : FMAC_C;
-  g_fmul_proc_ = kUseSSE ? FMUL_SSE : FMUL_C;
+  base::CPU cpu;
+  // TODO(dalecurtis): Once Chrome moves to an SSE baseline the SSE detection
+  // can be removed.
+  const bool kUseSSE = cpu.has_sse();
+  const bool kUseAVX = cpu.has_avx();
+  g_fmac_proc_ = kUseAVX ? FMAC_AVX : (kUseSSE ? FMAC_SSE : FMAC_C);
+  g_fmul_proc_ = kUseAVX ? FMUL_AVX : (kUseSSE ? FMUL_SSE : FMUL_C);
+  // There is no AVX version of EWMAAndMaxPower().
   g_ewma_power_proc_ = kUseSSE ? EWMAAndMaxPower_SSE : EWMAAndMaxPower_C;
 }
-#endif
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define FMAC_FUNC FMAC_NEON
 #define FMUL_FUNC FMUL_NEON
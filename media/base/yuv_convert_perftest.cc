@@ -0,0 +1,230 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/cpu.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+#include "media/base/simd/convert_yuv_to_rgb.h"
+#include "media/base/yuv_convert.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+using base::TimeTicks;
+
+namespace media {
+
+// Size of the converted frames.
+static const int kWidth = 1280;
+static const int kHeight = 720;
+static const int kYSize = kWidth * kHeight;
+static const int kUVSize = kYSize / 4;
+static const int kBpp = 4;
+
+// Size of the source frames of the scaling benchmarks.
+static const int kScaleSourceWidth = 640;
+static const int kScaleSourceHeight = 360;
+static const int kScaleSourceDx = (kScaleSourceWidth << 16) / kWidth;
+
+static const int kPerfTestIterations = 100;
+
+typedef void (*ConvertRowProc)(const uint8*,
+                               const uint8*,
+                               const uint8*,
+                               uint8*,
+                               ptrdiff_t);
+
+typedef void (*ConvertAlphaRowProc)(const uint8*,
+                                    const uint8*,
+                                    const uint8*,
+                                    const uint8*,
+                                    uint8*,
+                                    ptrdiff_t);
+
+typedef void (*ScaleRowProc)(const uint8*,
+                             const uint8*,
+                             const uint8*,
+                             uint8*,
+                             ptrdiff_t,
+                             ptrdiff_t);
+
+class YUVConvertPerfTest : public testing::Test {
+ public:
+  YUVConvertPerfTest()
+      : y_plane_(new uint8[kYSize]),
+        u_plane_(new uint8[kUVSize]),
+        v_plane_(new uint8[kUVSize]),
+        a_plane_(new uint8[kYSize]),
+        rgb_bytes_(new uint8[kYSize * kBpp]) {
+    // Fill the planes with varying values, so that every entry of the
+    // conversion tables gets used.
+    for (int i = 0; i < kYSize; ++i) {
+      y_plane_[i] = i * 7;
+      a_plane_[i] = i * 3;
+    }
+    for (int i = 0; i < kUVSize; ++i) {
+      u_plane_[i] = i * 5;
+      v_plane_[i] = i * 11;
+    }
+  }
+
+  // Converts a kWidth x kHeight YV12 frame one row at a time with |fn|.
+  void RunConvertRowBenchmark(ConvertRowProc fn, const std::string& name) {
+    TimeTicks start = TimeTicks::HighResNow();
+    for (int i = 0; i < kPerfTestIterations; ++i) {
+      for (int row = 0; row < kHeight; ++row) {
+        fn(y_plane_.get() + row * kWidth,
+           u_plane_.get() + (row / 2) * (kWidth / 2),
+           v_plane_.get() + (row / 2) * (kWidth / 2),
+           rgb_bytes_.get() + row * kWidth * kBpp,
+           kWidth);
+      }
+    }
+    EmptyRegisterState();
+    PrintResult(start, "ConvertYUVToRGB32Row", name);
+  }
+
+  // Like RunConvertRowBenchmark(), with an alpha plane.
+  void RunConvertAlphaRowBenchmark(ConvertAlphaRowProc fn,
+                                   const std::string& name) {
+    TimeTicks start = TimeTicks::HighResNow();
+    for (int i = 0; i < kPerfTestIterations; ++i) {
+      for (int row = 0; row < kHeight; ++row) {
+        fn(y_plane_.get() + row * kWidth,
+           u_plane_.get() + (row / 2) * (kWidth / 2),
+           v_plane_.get() + (row / 2) * (kWidth / 2),
+           a_plane_.get() + row * kWidth,
+           rgb_bytes_.get() + row * kWidth * kBpp,
+           kWidth);
+      }
+    }
+    EmptyRegisterState();
+    PrintResult(start, "ConvertYUVAToARGBRow", name);
+  }
+
+  // Scales a kScaleSourceWidth wide YV12 frame up to kWidth x kHeight one row
+  // at a time with |fn|.
+  void RunScaleRowBenchmark(ScaleRowProc fn,
+                            const std::string& test_name,
+                            const std::string& name) {
+    TimeTicks start = TimeTicks::HighResNow();
+    for (int i = 0; i < kPerfTestIterations; ++i) {
+      for (int row = 0; row < kHeight; ++row) {
+        int source_row = row * kScaleSourceHeight / kHeight;
+        fn(y_plane_.get() + source_row * kScaleSourceWidth,
+           u_plane_.get() + (source_row / 2) * (kScaleSourceWidth / 2),
+           v_plane_.get() + (source_row / 2) * (kScaleSourceWidth / 2),
+           rgb_bytes_.get() + row * kWidth * kBpp,
+           kWidth,
+           kScaleSourceDx);
+      }
+    }
+    EmptyRegisterState();
+    PrintResult(start, test_name, name);
+  }
+
+ protected:
+  void PrintResult(const TimeTicks& start,
+                   const std::string& test_name,
+                   const std::string& name) {
+    double total_time_seconds = (TimeTicks::HighResNow() - start).InSecondsF();
+    perf_test::PrintResult(test_name,
+                           "",
+                           name,
+                           kPerfTestIterations / total_time_seconds,
+                           "frames/second",
+                           true);
+  }
+
+  scoped_ptr<uint8[]> y_plane_;
+  scoped_ptr<uint8[]> u_plane_;
+  scoped_ptr<uint8[]> v_plane_;
+  scoped_ptr<uint8[]> a_plane_;
+  scoped_ptr<uint8[]> rgb_bytes_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(YUVConvertPerfTest);
+};
+
+TEST_F(YUVConvertPerfTest, ConvertYUVToRGB32Row) {
+  RunConvertRowBenchmark(ConvertYUVToRGB32Row_C, "C");
+#if defined(ARCH_CPU_X86_FAMILY)
+  base::CPU cpu;
+  if (cpu.has_mmx())
+    RunConvertRowBenchmark(ConvertYUVToRGB32Row_MMX, "MMX");
+  if (cpu.has_sse())
+    RunConvertRowBenchmark(ConvertYUVToRGB32Row_SSE, "SSE");
+#endif
+}
+
+TEST_F(YUVConvertPerfTest, ConvertYUVAToARGBRow) {
+  RunConvertAlphaRowBenchmark(ConvertYUVAToARGBRow_C, "C");
+#if defined(ARCH_CPU_X86_FAMILY)
+  base::CPU cpu;
+  if (cpu.has_mmx())
+    RunConvertAlphaRowBenchmark(ConvertYUVAToARGBRow_MMX, "MMX");
+#endif
+}
+
+TEST_F(YUVConvertPerfTest, ScaleYUVToRGB32Row) {
+  RunScaleRowBenchmark(ScaleYUVToRGB32Row_C, "ScaleYUVToRGB32Row", "C");
+#if defined(ARCH_CPU_X86_FAMILY)
+  base::CPU cpu;
+  if (cpu.has_mmx()) {
+    RunScaleRowBenchmark(
+        ScaleYUVToRGB32Row_MMX, "ScaleYUVToRGB32Row", "MMX");
+  }
+  if (cpu.has_sse()) {
+    RunScaleRowBenchmark(
+        ScaleYUVToRGB32Row_SSE, "ScaleYUVToRGB32Row", "SSE");
+  }
+#if defined(ARCH_CPU_X86_64)
+  RunScaleRowBenchmark(
+      ScaleYUVToRGB32Row_SSE2_X64, "ScaleYUVToRGB32Row", "SSE2_X64");
+#endif
+#endif
+}
+
+TEST_F(YUVConvertPerfTest, LinearScaleYUVToRGB32Row) {
+  RunScaleRowBenchmark(
+      LinearScaleYUVToRGB32Row_C, "LinearScaleYUVToRGB32Row", "C");
+#if defined(ARCH_CPU_X86_FAMILY)
+  base::CPU cpu;
+  if (cpu.has_mmx()) {
+    RunScaleRowBenchmark(
+        LinearScaleYUVToRGB32Row_MMX, "LinearScaleYUVToRGB32Row", "MMX");
+  }
+  if (cpu.has_sse()) {
+    RunScaleRowBenchmark(
+        LinearScaleYUVToRGB32Row_SSE, "LinearScaleYUVToRGB32Row", "SSE");
+  }
+#if defined(ARCH_CPU_X86_64)
+  RunScaleRowBenchmark(
+      LinearScaleYUVToRGB32Row_MMX_X64, "LinearScaleYUVToRGB32Row", "MMX_X64");
+#endif
+#endif
+}
+
+// Times the frame level entry points, which pick the fastest row functions.
+TEST_F(YUVConvertPerfTest, ConvertYUVToRGB32) {
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < kPerfTestIterations; ++i) {
+    ConvertYUVToRGB32(y_plane_.get(), u_plane_.get(), v_plane_.get(),
+                      rgb_bytes_.get(), kWidth, kHeight, kWidth, kWidth / 2,
+                      kWidth * kBpp, YV12);
+  }
+  PrintResult(start, "ConvertYUVToRGB32", "YV12");
+}
+
+TEST_F(YUVConvertPerfTest, ScaleYUVToRGB32) {
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < kPerfTestIterations; ++i) {
+    ScaleYUVToRGB32(y_plane_.get(), u_plane_.get(), v_plane_.get(),
+                    rgb_bytes_.get(), kScaleSourceWidth, kScaleSourceHeight,
+                    kWidth, kHeight, kScaleSourceWidth, kScaleSourceWidth / 2,
+                    kWidth * kBpp, YV12, ROTATE_0, FILTER_BILINEAR);
+  }
+  PrintResult(start, "ScaleYUVToRGB32", "YV12_bilinear");
+}
+
+}  // namespace media
@@ -52,26 +52,21 @@ bool PacedSender::SendPacketsToTransport(const PacketList& packets,
     return true;
   }
 
-  PacketList packets_to_send;
-  PacketList::const_iterator first_to_store_it = packets.begin();
-
   size_t max_packets_to_send_now = burst_size_ - packets_sent_in_burst_;
+  size_t packets_to_send_now =
+      std::min(max_packets_to_send_now, packets.size());
 
-  if (max_packets_to_send_now > 0) {
-    size_t packets_to_send_now =
-        std::min(max_packets_to_send_now, packets.size());
-
-    std::advance(first_to_store_it, packets_to_send_now);
-    packets_to_send.insert(
-        packets_to_send.begin(), packets.begin(), first_to_store_it);
-  }
+  // Send the first packets straight from |packets|, rather than copying them
+  // into a list of their own first.
+  PacketList::const_iterator first_to_store_it =
+      packets.begin() + packets_to_send_now;
   packets_not_sent->insert(
       packets_not_sent->end(), first_to_store_it, packets.end());
-  packets_sent_in_burst_ = packets_to_send.size();
-  if (packets_to_send.empty())
+  packets_sent_in_burst_ = packets_to_send_now;
+  if (packets_to_send_now == 0)
     return true;
 
-  return TransmitPackets(packets_to_send);
+  return TransmitPackets(packets.begin(), first_to_store_it);
 }
 
 bool PacedSender::SendRtcpPacket(const Packet& packet) {
@@ -103,42 +98,37 @@ void PacedSender::SendStoredPackets() {
     return;
 
   size_t packets_to_send = burst_size_;
-  PacketList packets_to_resend;
 
-  // Send our re-send packets first.
+  // Send our re-send packets first.  The packets are sent from the queues
+  // before being erased, so that they aren't copied on the way out.
+  size_t packets_resent = 0;
   if (!resend_packet_list_.empty()) {
-    PacketList::iterator it = resend_packet_list_.begin();
-    size_t packets_to_send_now =
-        std::min(packets_to_send, resend_packet_list_.size());
-    std::advance(it, packets_to_send_now);
-    packets_to_resend.insert(
-        packets_to_resend.begin(), resend_packet_list_.begin(), it);
+    packets_resent = std::min(packets_to_send, resend_packet_list_.size());
+    PacketList::iterator it = resend_packet_list_.begin() + packets_resent;
+    TransmitPackets(resend_packet_list_.begin(), it);
     resend_packet_list_.erase(resend_packet_list_.begin(), it);
-    packets_to_send -= packets_to_resend.size();
+    packets_to_send -= packets_resent;
   }
   if (!packet_list_.empty() && packets_to_send > 0) {
-    PacketList::iterator it = packet_list_.begin();
     size_t packets_to_send_now = std::min(packets_to_send, packet_list_.size());
-
-    std::advance(it, packets_to_send_now);
-    packets_to_resend.insert(packets_to_resend.end(), packet_list_.begin(), it);
+    PacketList::iterator it = packet_list_.begin() + packets_to_send_now;
+    TransmitPackets(packet_list_.begin(), it);
     packet_list_.erase(packet_list_.begin(), it);
 
     if (packet_list_.empty()) {
       burst_size_ = 1;  // Reset burst size after we sent the last stored packet
       packets_sent_in_burst_ = 0;
     } else {
-      packets_sent_in_burst_ = packets_to_resend.size();
+      packets_sent_in_burst_ = packets_resent + packets_to_send_now;
     }
   }
-  TransmitPackets(packets_to_resend);
 }
 
-bool PacedSender::TransmitPackets(const PacketList& packets) {
+bool PacedSender::TransmitPackets(PacketList::const_iterator begin,
+                                  PacketList::const_iterator end) {
   bool ret = true;
-  for (size_t i = 0; i < packets.size(); i++) {
-    ret &= transport_->SendPacket(packets[i]);
-  }
+  for (PacketList::const_iterator it = begin; it != end; ++it)
+    ret &= transport_->SendPacket(*it);
   return ret;
 }
 
@@ -68,8 +68,9 @@ class PacedSender : public PacedPacketSender,
   bool SendPacketsToTransport(const PacketList& packets,
                               PacketList* packets_not_sent);
 
-  // Actually sends the packets to the transport.
-  bool TransmitPackets(const PacketList& packets);
+  // Actually sends the packets in [|begin|, |end|) to the transport.
+  bool TransmitPackets(PacketList::const_iterator begin,
+                       PacketList::const_iterator end);
   void SendStoredPackets();
   void UpdateBurstSize(size_t num_of_packets);
 
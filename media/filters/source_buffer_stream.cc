@@ -774,8 +774,10 @@ void SourceBufferStream::GarbageCollectIfNeeded() {
     ranges_size += (*itr)->size_in_bytes();
 
   // Return if we're under or at the memory limit.
-  if (ranges_size <= memory_limit_)
+  if (ranges_size <= memory_limit_) {
+    TraceBufferedBytes(ranges_size);
     return;
+  }
 
   int bytes_to_free = ranges_size - memory_limit_;
 
@@ -788,7 +790,31 @@ void SourceBufferStream::GarbageCollectIfNeeded() {
 
   // Begin deleting from the back.
   if (bytes_to_free - bytes_freed > 0)
-    FreeBuffers(bytes_to_free - bytes_freed, true);
+    bytes_freed += FreeBuffers(bytes_to_free - bytes_freed, true);
+
+  DVLOG(1) << __FUNCTION__ << " " << GetStreamTypeName() << ": freed "
+           << bytes_freed << " of " << bytes_to_free << " bytes";
+  TraceBufferedBytes(ranges_size - bytes_freed);
+}
+
+void SourceBufferStream::TraceBufferedBytes(int buffered_bytes) const {
+  // Trace counter names must outlive the trace, so they can't come from
+  // GetStreamTypeName().
+  switch (GetType()) {
+    case kAudio:
+      TRACE_COUNTER_ID1("media", "SourceBufferStream AUDIO bytes", this,
+                        buffered_bytes);
+      return;
+    case kVideo:
+      TRACE_COUNTER_ID1("media", "SourceBufferStream VIDEO bytes", this,
+                        buffered_bytes);
+      return;
+    case kText:
+      TRACE_COUNTER_ID1("media", "SourceBufferStream TEXT bytes", this,
+                        buffered_bytes);
+      return;
+  }
+  NOTREACHED();
 }
 
 int SourceBufferStream::FreeBuffersAfterLastAppended(int total_bytes_to_free) {
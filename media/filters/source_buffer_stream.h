@@ -148,6 +148,10 @@ class MEDIA_EXPORT SourceBufferStream {
   // Frees up space if the SourceBufferStream is taking up too much memory.
   void GarbageCollectIfNeeded();
 
+  // Reports the number of bytes left buffered by this stream, after any
+  // garbage collection, to the "media" trace category.
+  void TraceBufferedBytes(int buffered_bytes) const;
+
   // Attempts to delete approximately |total_bytes_to_free| amount of data
   // |ranges_|, starting at the front of |ranges_| and moving linearly forward
   // through the buffers. Deletes starting from the back if |reverse_direction|
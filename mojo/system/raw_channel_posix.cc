@@ -6,6 +6,7 @@
 
 #include <errno.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -22,6 +23,7 @@
 #include "base/message_loop/message_loop.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/synchronization/lock.h"
+#include "mojo/system/constants.h"
 #include "mojo/system/embedder/platform_handle.h"
 #include "mojo/system/message_in_transit.h"
 
@@ -32,6 +34,9 @@ namespace {
 
 const size_t kReadSize = 4096;
 
+// The maximum number of queued messages written by a single |writev()|.
+const size_t kMaxMessagesPerWrite = 16;
+
 class RawChannelPosix : public RawChannel,
                         public base::MessageLoopForIO::Watcher {
  public:
@@ -57,11 +62,13 @@ class RawChannelPosix : public RawChannel,
   // thread WITHOUT |write_lock_| held.
   void CallOnFatalError(Delegate::FatalError fatal_error);
 
-  // Writes the message at the front of |write_message_queue_|, starting at
-  // |write_message_offset_|. It removes and destroys if the write completes and
-  // otherwise updates |write_message_offset_|. Returns true on success. Must be
-  // called under |write_lock_|.
-  bool WriteFrontMessageNoLock();
+  // Writes the messages at the front of |write_message_queue_| (up to
+  // |kMaxMessagesPerWrite| of them, with a single |writev()|), starting at
+  // |write_message_offset_| in the first one. It removes and destroys the
+  // messages that were written completely and updates |write_message_offset_|
+  // for a partially written one. Returns true on success. Must be called under
+  // |write_lock_|.
+  bool WriteFrontMessagesNoLock();
 
   // Cancels all pending writes and destroys the contents of
   // |write_message_queue_|. Should only be called if |write_stopped_| is false;
@@ -176,7 +183,7 @@ bool RawChannelPosix::WriteMessage(MessageInTransit* message) {
 
   write_message_queue_.push_front(message);
   DCHECK_EQ(write_message_offset_, 0u);
-  bool result = WriteFrontMessageNoLock();
+  bool result = WriteFrontMessagesNoLock();
   DCHECK(result || write_message_queue_.empty());
 
   if (!result) {
@@ -212,16 +219,31 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
   // Currently, we copy data to ensure that this is zero at the beginning.
   size_t read_buffer_start = 0;
   for (;;) {
+    // If we already have the header of a partial message, read all of the rest
+    // of it at once. (Don't trust the header with more than
+    // |kMaxMessageNumBytes| of buffer at a time, though.)
+    size_t bytes_to_read = kReadSize;
+    size_t message_size;
+    if (read_buffer_num_valid_bytes_ > 0 &&
+        MessageInTransit::GetNextMessageSize(
+            &read_buffer_[read_buffer_start], read_buffer_num_valid_bytes_,
+            &message_size) &&
+        message_size > read_buffer_num_valid_bytes_) {
+      bytes_to_read = std::max(
+          bytes_to_read,
+          std::min(message_size - read_buffer_num_valid_bytes_,
+                   kMaxMessageNumBytes));
+    }
+
     if (read_buffer_.size() - (read_buffer_start + read_buffer_num_valid_bytes_)
-            < kReadSize) {
+            < bytes_to_read) {
       // Use power-of-2 buffer sizes.
       // TODO(vtl): Make sure the buffer doesn't get too large (and enforce the
       // maximum message size to whatever extent necessary).
-      // TODO(vtl): We may often be able to peek at the header and get the real
-      // required extra space (which may be much bigger than |kReadSize|).
       size_t new_size = std::max(read_buffer_.size(), kReadSize);
       while (new_size <
-                 read_buffer_start + read_buffer_num_valid_bytes_ + kReadSize)
+                 read_buffer_start + read_buffer_num_valid_bytes_ +
+                     bytes_to_read)
         new_size *= 2;
 
       // TODO(vtl): It's suboptimal to zero out the fresh memory.
@@ -231,7 +253,7 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
     ssize_t bytes_read = HANDLE_EINTR(
         read(fd_.get().fd,
              &read_buffer_[read_buffer_start + read_buffer_num_valid_bytes_],
-             kReadSize));
+             bytes_to_read));
     if (bytes_read < 0) {
       if (errno != EAGAIN && errno != EWOULDBLOCK) {
         PLOG(ERROR) << "read";
@@ -250,7 +272,6 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
     read_buffer_num_valid_bytes_ += static_cast<size_t>(bytes_read);
 
     // Dispatch all the messages that we can.
-    size_t message_size;
     // Note that we rely on short-circuit evaluation here:
     //   - |read_buffer_start| may be an invalid index into |read_buffer_| if
     //     |read_buffer_num_valid_bytes_| is zero.
@@ -290,8 +311,8 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
     if (did_dispatch_message)
       break;
 
-    // If we didn't max out |kReadSize|, stop reading for now.
-    if (static_cast<size_t>(bytes_read) < kReadSize)
+    // If we didn't max out |bytes_to_read|, stop reading for now.
+    if (static_cast<size_t>(bytes_read) < bytes_to_read)
       break;
 
     // Else try to read some more....
@@ -321,7 +342,7 @@ void RawChannelPosix::OnFileCanWriteWithoutBlocking(int fd) {
       return;
     }
 
-    bool result = WriteFrontMessageNoLock();
+    bool result = WriteFrontMessagesNoLock();
     DCHECK(result || write_message_queue_.empty());
 
     if (!result) {
@@ -351,23 +372,32 @@ void RawChannelPosix::CallOnFatalError(Delegate::FatalError fatal_error) {
   delegate()->OnFatalError(fatal_error);
 }
 
-bool RawChannelPosix::WriteFrontMessageNoLock() {
+bool RawChannelPosix::WriteFrontMessagesNoLock() {
   write_lock_.AssertAcquired();
 
   DCHECK(!write_stopped_);
   DCHECK(!write_message_queue_.empty());
 
-  MessageInTransit* message = write_message_queue_.front();
-  DCHECK_LT(write_message_offset_, message->main_buffer_size());
-  size_t bytes_to_write = message->main_buffer_size() - write_message_offset_;
+  struct iovec iov[kMaxMessagesPerWrite];
+  size_t num_iov = 0;
+  size_t bytes_to_write = 0;
+  for (std::deque<MessageInTransit*>::const_iterator it =
+           write_message_queue_.begin();
+       it != write_message_queue_.end() && num_iov < kMaxMessagesPerWrite;
+       ++it, ++num_iov) {
+    size_t offset = num_iov == 0 ? write_message_offset_ : 0;
+    DCHECK_LT(offset, (*it)->main_buffer_size());
+    iov[num_iov].iov_base = const_cast<char*>(
+        static_cast<const char*>((*it)->main_buffer()) + offset);
+    iov[num_iov].iov_len = (*it)->main_buffer_size() - offset;
+    bytes_to_write += iov[num_iov].iov_len;
+  }
+
   ssize_t bytes_written = HANDLE_EINTR(
-      write(fd_.get().fd,
-            static_cast<const char*>(message->main_buffer()) +
-                write_message_offset_,
-            bytes_to_write));
+      writev(fd_.get().fd, iov, static_cast<int>(num_iov)));
   if (bytes_written < 0) {
     if (errno != EAGAIN && errno != EWOULDBLOCK) {
-      PLOG(ERROR) << "write of size " << bytes_to_write;
+      PLOG(ERROR) << "writev of size " << bytes_to_write;
       CancelPendingWritesNoLock();
       return false;
     }
@@ -378,12 +408,20 @@ bool RawChannelPosix::WriteFrontMessageNoLock() {
   }
 
   DCHECK_GE(bytes_written, 0);
-  if (static_cast<size_t>(bytes_written) < bytes_to_write) {
-    // Partial (or no) write.
-    write_message_offset_ += static_cast<size_t>(bytes_written);
-  } else {
+  DCHECK_LE(static_cast<size_t>(bytes_written), bytes_to_write);
+  size_t bytes_left = static_cast<size_t>(bytes_written);
+  while (bytes_left > 0) {
+    MessageInTransit* message = write_message_queue_.front();
+    size_t message_bytes_left =
+        message->main_buffer_size() - write_message_offset_;
+    if (bytes_left < message_bytes_left) {
+      // Partial write.
+      write_message_offset_ += bytes_left;
+      break;
+    }
+
     // Complete write.
-    DCHECK_EQ(static_cast<size_t>(bytes_written), bytes_to_write);
+    bytes_left -= message_bytes_left;
     write_message_queue_.pop_front();
     write_message_offset_ = 0;
     message->Destroy();
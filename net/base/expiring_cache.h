@@ -136,6 +136,21 @@ class ExpiringCache {
     return &it->second.first;
   }
 
+  // Returns the value matching |key| and, if |expiration| is non-NULL, sets
+  // |*expiration| to when it expires, even if that is already in the past.
+  // Unlike Get(), never removes the item from the cache.
+  // Note: The returned pointer remains owned by the ExpiringCache and is
+  // invalidated by a call to a non-const method.
+  const ValueType* Peek(const KeyType& key,
+                        ExpirationType* expiration) const {
+    typename EntryMap::const_iterator it = entries_.find(key);
+    if (it == entries_.end())
+      return NULL;
+    if (expiration)
+      *expiration = it->second.second;
+    return &it->second.first;
+  }
+
   // Updates or replaces the value associated with |key|.
   void Put(const KeyType& key,
            const ValueType& value,
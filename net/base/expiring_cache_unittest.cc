@@ -254,6 +254,31 @@ TEST(ExpiringCacheTest, GetTruncatesExpiredEntries) {
   EXPECT_EQ(6U, cache.size());
 }
 
+TEST(ExpiringCacheTest, PeekKeepsExpiredEntries) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  Cache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+  cache.Put("test1", "foo1", now, now + kTTL);
+  EXPECT_FALSE(cache.Peek("test2", NULL));
+
+  base::TimeTicks expiration;
+  EXPECT_THAT(cache.Peek("test1", &expiration), Pointee(StrEq("foo1")));
+  EXPECT_EQ(now + kTTL, expiration);
+
+  // Peeking at an expired entry neither hides nor removes it.
+  now += 2 * kTTL;
+  EXPECT_THAT(cache.Peek("test1", NULL), Pointee(StrEq("foo1")));
+  EXPECT_EQ(1U, cache.size());
+
+  // Get() still drops it.
+  EXPECT_FALSE(cache.Get("test1", now));
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_FALSE(cache.Peek("test1", NULL));
+}
+
 TEST(ExpiringCacheTest, CustomFunctor) {
   ExpiringCache<std::string, std::string, std::string, TestFunctor> cache(5);
 
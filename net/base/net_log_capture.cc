@@ -0,0 +1,238 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/net_log_capture.h"
+
+#include <algorithm>
+
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/json/json_writer.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_local_storage.h"
+#include "base/values.h"
+
+namespace net {
+
+namespace {
+
+// The buffer of the capture which last saw an event on a thread.  A thread
+// which adds events to several captures in turn falls back to searching for
+// its buffer, but that is not the common case.
+struct ThreadState {
+  ThreadState() : capture_id(0), buffer(NULL) {}
+
+  uint32 capture_id;
+  void* buffer;
+};
+
+void DeleteThreadState(void* thread_state) {
+  delete static_cast<ThreadState*>(thread_state);
+}
+
+struct ThreadStateSlot {
+  ThreadStateSlot() : slot(&DeleteThreadState) {}
+
+  base::ThreadLocalStorage::Slot slot;
+};
+
+base::LazyInstance<ThreadStateSlot>::Leaky g_thread_state_slot =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Capture IDs are never reused, so a thread's cached buffer can't be mistaken
+// for one of a later capture.
+base::subtle::Atomic32 g_last_capture_id = 0;
+
+}  // namespace
+
+const size_t NetLogCapture::kDefaultEntriesPerThread = 10000;
+
+NetLogCapture::Record::Record()
+    : sequence_number(0),
+      time(0),
+      source_id(NetLog::Source::kInvalidId),
+      type(0),
+      source_type(0),
+      phase(0),
+      parameters(NULL) {
+}
+
+NetLogCapture::ThreadBuffer::ThreadBuffer(size_t size,
+                                          base::PlatformThreadId thread_id)
+    : thread_id(thread_id), records_(size), next_(0), wrapped_(false) {
+  DCHECK_GT(size, 0u);
+}
+
+NetLogCapture::ThreadBuffer::~ThreadBuffer() {
+  Clear();
+}
+
+NetLogCapture::Record* NetLogCapture::ThreadBuffer::Next() {
+  lock.AssertAcquired();
+  Record* record = &records_[next_];
+  delete record->parameters;
+  record->parameters = NULL;
+  if (++next_ == records_.size()) {
+    next_ = 0;
+    wrapped_ = true;
+  }
+  return record;
+}
+
+void NetLogCapture::ThreadBuffer::GetRecords(
+    std::vector<Record>* records) const {
+  lock.AssertAcquired();
+  size_t first = wrapped_ ? next_ : 0;
+  size_t count = wrapped_ ? records_.size() : next_;
+  for (size_t i = 0; i < count; ++i) {
+    records->push_back(records_[(first + i) % records_.size()]);
+    Record* copy = &records->back();
+    if (copy->parameters)
+      copy->parameters = copy->parameters->DeepCopy();
+  }
+}
+
+void NetLogCapture::ThreadBuffer::Clear() {
+  for (size_t i = 0; i < records_.size(); ++i) {
+    delete records_[i].parameters;
+    records_[i] = Record();
+  }
+  next_ = 0;
+  wrapped_ = false;
+}
+
+NetLogCapture::NetLogCapture(size_t entries_per_thread,
+                             bool capture_parameters)
+    : id_(base::subtle::NoBarrier_AtomicIncrement(&g_last_capture_id, 1)),
+      entries_per_thread_(entries_per_thread),
+      capture_parameters_(capture_parameters),
+      last_sequence_number_(0) {
+  DCHECK_GT(entries_per_thread, 0u);
+}
+
+NetLogCapture::~NetLogCapture() {
+}
+
+void NetLogCapture::StartObserving(NetLog* net_log,
+                                   NetLog::LogLevel log_level) {
+  net_log->AddThreadSafeObserver(this, log_level);
+}
+
+void NetLogCapture::StopObserving() {
+  net_log()->RemoveThreadSafeObserver(this);
+}
+
+std::string NetLogCapture::Dump(const base::Value& constants) const {
+  std::vector<Record> records;
+  {
+    base::AutoLock locked(lock_);
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      base::AutoLock buffer_locked(buffers_[i]->lock);
+      buffers_[i]->GetRecords(&records);
+    }
+  }
+  std::sort(records.begin(), records.end(), RecordLessThan);
+
+  // Same format as NetLogLogger, so that net-internals can load it.
+  std::string json;
+  base::JSONWriter::Write(&constants, &json);
+  std::string dump = "{\"constants\": " + json + ",\n\"events\": [\n";
+  for (size_t i = 0; i < records.size(); ++i) {
+    const Record& record = records[i];
+    base::DictionaryValue entry_dict;
+    entry_dict.SetString(
+        "time",
+        NetLog::TickCountToString(
+            base::TimeTicks::FromInternalValue(record.time)));
+    base::DictionaryValue* source_dict = new base::DictionaryValue();
+    source_dict->SetInteger("id", record.source_id);
+    source_dict->SetInteger("type", record.source_type);
+    entry_dict.Set("source", source_dict);
+    entry_dict.SetInteger("type", record.type);
+    entry_dict.SetInteger("phase", record.phase);
+    // Hands over the copy made by GetRecords().
+    if (record.parameters)
+      entry_dict.Set("params", record.parameters);
+
+    base::JSONWriter::Write(&entry_dict, &json);
+    if (i > 0)
+      dump.append(",\n");
+    dump.append(json);
+  }
+  dump.append("]}");
+  return dump;
+}
+
+bool NetLogCapture::DumpToFile(const base::FilePath& path,
+                               const base::Value& constants) const {
+  std::string dump = Dump(constants);
+  int size = static_cast<int>(dump.size());
+  return file_util::WriteFile(path, dump.data(), size) == size;
+}
+
+void NetLogCapture::Clear() {
+  base::AutoLock locked(lock_);
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    base::AutoLock buffer_locked(buffers_[i]->lock);
+    buffers_[i]->Clear();
+  }
+}
+
+void NetLogCapture::OnAddEntry(const NetLog::Entry& entry) {
+  // Computed before taking the lock, as the callback may be slow.
+  base::Value* parameters =
+      capture_parameters_ ? entry.ParametersToValue() : NULL;
+
+  ThreadBuffer* buffer = GetThreadBuffer();
+  base::AutoLock locked(buffer->lock);
+  Record* record = buffer->Next();
+  record->sequence_number =
+      base::subtle::NoBarrier_AtomicIncrement(&last_sequence_number_, 1);
+  record->time = entry.time().ToInternalValue();
+  record->source_id = entry.source().id;
+  record->type = static_cast<uint16>(entry.type());
+  record->source_type = static_cast<uint8>(entry.source().type);
+  record->phase = static_cast<uint8>(entry.phase());
+  record->parameters = parameters;
+}
+
+// static
+bool NetLogCapture::RecordLessThan(const Record& a, const Record& b) {
+  return a.sequence_number < b.sequence_number;
+}
+
+NetLogCapture::ThreadBuffer* NetLogCapture::GetThreadBuffer() {
+  base::ThreadLocalStorage::Slot* slot = &g_thread_state_slot.Get().slot;
+  ThreadState* state = static_cast<ThreadState*>(slot->Get());
+  if (state && state->capture_id == id_)
+    return static_cast<ThreadBuffer*>(state->buffer);
+
+  if (!state) {
+    state = new ThreadState();
+    slot->Set(state);
+  }
+
+  base::PlatformThreadId thread_id = base::PlatformThread::CurrentId();
+  ThreadBuffer* buffer = NULL;
+  {
+    base::AutoLock locked(lock_);
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      if (buffers_[i]->thread_id == thread_id) {
+        buffer = buffers_[i];
+        break;
+      }
+    }
+    if (!buffer) {
+      buffer = new ThreadBuffer(entries_per_thread_, thread_id);
+      buffers_.push_back(buffer);
+    }
+  }
+  state->capture_id = id_;
+  state->buffer = buffer;
+  return buffer;
+}
+
+}  // namespace net
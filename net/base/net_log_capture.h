@@ -0,0 +1,142 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_NET_LOG_CAPTURE_H_
+#define NET_BASE_NET_LOG_CAPTURE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_vector.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+#include "net/base/net_log.h"
+
+namespace base {
+class FilePath;
+class Value;
+}
+
+namespace net {
+
+// NetLogCapture watches the NetLog event stream and keeps the most recent
+// events of each thread in a fixed-size ring buffer, without serializing
+// them.  Unlike NetLogLogger, which writes every event to a file as JSON the
+// moment it is added, it only records the event type, source, phase and time
+// in a compact binary record, plus the parameters when asked to.  The JSON
+// is only built when Dump() is called, e.g. when the user asks for a log
+// after something went wrong.
+//
+// Each thread appends to its own buffer, so adding events from different
+// threads doesn't contend on a lock.
+class NET_EXPORT NetLogCapture : public NetLog::ThreadSafeObserver {
+ public:
+  // The number of events kept per thread by default.
+  static const size_t kDefaultEntriesPerThread;
+
+  // Keeps the last |entries_per_thread| events of each thread.  If
+  // |capture_parameters| is false, the parameters of events are never
+  // computed, which is the cheapest way to find out which events happened.
+  NetLogCapture(size_t entries_per_thread, bool capture_parameters);
+  virtual ~NetLogCapture();
+
+  // Starts observing |net_log| at |log_level|.  Must not already be watching
+  // a NetLog.
+  void StartObserving(NetLog* net_log, NetLog::LogLevel log_level);
+
+  // Stops observing net_log().  Must already be watching.  The captured
+  // events are kept, and may still be dumped.
+  void StopObserving();
+
+  // Returns the captured events, oldest first, as a JSON object in the
+  // format written by NetLogLogger, using |constants| as the legend.
+  std::string Dump(const base::Value& constants) const;
+
+  // Writes Dump() to |path|.  Must be called on a thread which allows IO.
+  // Returns false on failure.
+  bool DumpToFile(const base::FilePath& path,
+                  const base::Value& constants) const;
+
+  // Drops all captured events.
+  void Clear();
+
+  // net::NetLog::ThreadSafeObserver implementation:
+  virtual void OnAddEntry(const NetLog::Entry& entry) OVERRIDE;
+
+ private:
+  // A captured event.
+  struct Record {
+    Record();
+
+    // Orders events across threads.
+    uint32 sequence_number;
+    int64 time;
+    uint32 source_id;
+    uint16 type;
+    uint8 source_type;
+    uint8 phase;
+    // Owned.  NULL if there are no parameters, or they weren't captured.
+    base::Value* parameters;
+  };
+
+  // The ring buffer of one thread.
+  class ThreadBuffer {
+   public:
+    ThreadBuffer(size_t size, base::PlatformThreadId thread_id);
+    ~ThreadBuffer();
+
+    // Returns the record to overwrite with the next event.  |lock| must be
+    // held.
+    Record* Next();
+
+    // Appends copies of the records to |records|, oldest first.  The copies
+    // own copies of the parameters, which the caller must delete.  |lock| must
+    // be held.
+    void GetRecords(std::vector<Record>* records) const;
+
+    void Clear();
+
+    // The thread adding events to the buffer.  A thread which starts after
+    // another one exited may be given its ID, and then shares its buffer.
+    const base::PlatformThreadId thread_id;
+
+    // Only ever contended by Dump() and Clear().
+    base::Lock lock;
+
+   private:
+    std::vector<Record> records_;
+    // Where the next event goes.
+    size_t next_;
+    bool wrapped_;
+
+    DISALLOW_COPY_AND_ASSIGN(ThreadBuffer);
+  };
+
+  static bool RecordLessThan(const Record& a, const Record& b);
+
+  // Returns the buffer of the current thread, creating it if needed.
+  ThreadBuffer* GetThreadBuffer();
+
+  // Tells the buffers of different captures apart in thread-local storage.
+  const uint32 id_;
+  const size_t entries_per_thread_;
+  const bool capture_parameters_;
+
+  base::subtle::Atomic32 last_sequence_number_;
+
+  // Protects |buffers_|.
+  mutable base::Lock lock_;
+  // Buffers of threads which have ever added an event.  Buffers outlive their
+  // thread, so that its last events can still be dumped.
+  ScopedVector<ThreadBuffer> buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetLogCapture);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_NET_LOG_CAPTURE_H_
@@ -0,0 +1,193 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/net_log_capture.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/simple_thread.h"
+#include "base/values.h"
+#include "net/base/net_log_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kThreads = 4;
+const int kEvents = 50;
+
+// Parses |dump| and returns its list of events, which is owned by |root|.
+base::ListValue* GetEvents(const std::string& dump,
+                           scoped_ptr<base::Value>* root) {
+  base::JSONReader reader;
+  root->reset(reader.ReadToValue(dump));
+  base::DictionaryValue* dict;
+  base::ListValue* events;
+  if (!root->get() || !(*root)->GetAsDictionary(&dict) ||
+      !dict->HasKey("constants") || !dict->GetList("events", &events)) {
+    return NULL;
+  }
+  return events;
+}
+
+class AddEventsThread : public base::SimpleThread {
+ public:
+  explicit AddEventsThread(NetLog* net_log)
+      : base::SimpleThread("AddEventsThread"), net_log_(net_log) {}
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < kEvents; ++i)
+      net_log_->AddGlobalEntry(NetLog::TYPE_CANCELLED);
+  }
+
+ private:
+  NetLog* net_log_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddEventsThread);
+};
+
+class NetLogCaptureTest : public testing::Test {
+ protected:
+  NetLogCaptureTest() : constants_(NetLogLogger::GetConstants()) {}
+
+  NetLog net_log_;
+  scoped_ptr<base::Value> constants_;
+};
+
+TEST_F(NetLogCaptureTest, Empty) {
+  NetLogCapture capture(4, true);
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = GetEvents(capture.Dump(*constants_), &root);
+  ASSERT_TRUE(events);
+  EXPECT_EQ(0u, events->GetSize());
+}
+
+TEST_F(NetLogCaptureTest, CapturesEvents) {
+  NetLogCapture capture(4, true);
+  capture.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+  BoundNetLog bound_net_log =
+      BoundNetLog::Make(&net_log_, NetLog::SOURCE_URL_REQUEST);
+  bound_net_log.BeginEvent(NetLog::TYPE_REQUEST_ALIVE);
+  bound_net_log.EndEvent(NetLog::TYPE_REQUEST_ALIVE,
+                         NetLog::IntegerCallback("net_error", -2));
+  capture.StopObserving();
+  // Events added after stopping aren't captured.
+  bound_net_log.AddEvent(NetLog::TYPE_CANCELLED);
+
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = GetEvents(capture.Dump(*constants_), &root);
+  ASSERT_TRUE(events);
+  ASSERT_EQ(2u, events->GetSize());
+
+  base::DictionaryValue* event;
+  int value;
+  ASSERT_TRUE(events->GetDictionary(0, &event));
+  ASSERT_TRUE(event->GetInteger("type", &value));
+  EXPECT_EQ(NetLog::TYPE_REQUEST_ALIVE, value);
+  ASSERT_TRUE(event->GetInteger("phase", &value));
+  EXPECT_EQ(NetLog::PHASE_BEGIN, value);
+  ASSERT_TRUE(event->GetInteger("source.type", &value));
+  EXPECT_EQ(NetLog::SOURCE_URL_REQUEST, value);
+  ASSERT_TRUE(event->GetInteger("source.id", &value));
+  EXPECT_EQ(static_cast<int>(bound_net_log.source().id), value);
+  EXPECT_TRUE(event->HasKey("time"));
+  EXPECT_FALSE(event->HasKey("params"));
+
+  ASSERT_TRUE(events->GetDictionary(1, &event));
+  ASSERT_TRUE(event->GetInteger("phase", &value));
+  EXPECT_EQ(NetLog::PHASE_END, value);
+  ASSERT_TRUE(event->GetInteger("params.net_error", &value));
+  EXPECT_EQ(-2, value);
+}
+
+TEST_F(NetLogCaptureTest, WithoutParameters) {
+  NetLogCapture capture(4, false);
+  capture.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+  net_log_.AddGlobalEntry(NetLog::TYPE_CANCELLED,
+                          NetLog::IntegerCallback("net_error", -2));
+  capture.StopObserving();
+
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = GetEvents(capture.Dump(*constants_), &root);
+  ASSERT_TRUE(events);
+  ASSERT_EQ(1u, events->GetSize());
+  base::DictionaryValue* event;
+  ASSERT_TRUE(events->GetDictionary(0, &event));
+  EXPECT_FALSE(event->HasKey("params"));
+}
+
+TEST_F(NetLogCaptureTest, KeepsLatestEvents) {
+  NetLogCapture capture(4, true);
+  capture.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+  for (int i = 0; i < 10; ++i) {
+    net_log_.AddGlobalEntry(NetLog::TYPE_CANCELLED,
+                            NetLog::IntegerCallback("index", i));
+  }
+  capture.StopObserving();
+
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = GetEvents(capture.Dump(*constants_), &root);
+  ASSERT_TRUE(events);
+  ASSERT_EQ(4u, events->GetSize());
+  for (int i = 0; i < 4; ++i) {
+    base::DictionaryValue* event;
+    int index;
+    ASSERT_TRUE(events->GetDictionary(i, &event));
+    ASSERT_TRUE(event->GetInteger("params.index", &index));
+    EXPECT_EQ(6 + i, index);
+  }
+
+  capture.Clear();
+  events = GetEvents(capture.Dump(*constants_), &root);
+  ASSERT_TRUE(events);
+  EXPECT_EQ(0u, events->GetSize());
+}
+
+// Each thread gets its own buffer, so no thread's events push out another's.
+TEST_F(NetLogCaptureTest, Threads) {
+  NetLogCapture capture(kEvents, false);
+  capture.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+  ScopedVector<AddEventsThread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.push_back(new AddEventsThread(&net_log_));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < kThreads; ++i)
+    threads[i]->Join();
+  capture.StopObserving();
+
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = GetEvents(capture.Dump(*constants_), &root);
+  ASSERT_TRUE(events);
+  EXPECT_EQ(static_cast<size_t>(kThreads * kEvents), events->GetSize());
+}
+
+TEST_F(NetLogCaptureTest, DumpToFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII("NetLogFile");
+
+  NetLogCapture capture(4, true);
+  capture.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+  net_log_.AddGlobalEntry(NetLog::TYPE_CANCELLED);
+  capture.StopObserving();
+  ASSERT_TRUE(capture.DumpToFile(path, *constants_));
+
+  std::string input;
+  ASSERT_TRUE(base::ReadFileToString(path, &input));
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = GetEvents(input, &root);
+  ASSERT_TRUE(events);
+  EXPECT_EQ(1u, events->GetSize());
+}
+
+}  // namespace
+
+}  // namespace net
@@ -102,6 +102,10 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_JOB)
 // Jobs was reached.
 EVENT_TYPE(HOST_RESOLVER_IMPL_JOB_EVICTED)
 
+// This event is created when a HostResolverImpl::Job completes its Requests
+// with the A answer, without waiting any longer for the AAAA one.
+EVENT_TYPE(HOST_RESOLVER_IMPL_JOB_SERVED_EARLY)
+
 // This event is created when a HostResolverImpl::Job is started by
 // PriorityDispatch.
 EVENT_TYPE(HOST_RESOLVER_IMPL_JOB_STARTED)
@@ -257,6 +261,19 @@ EVENT_TYPE(PROXY_SERVICE_WAITING_FOR_INIT_PAC)
 //   }
 EVENT_TYPE(PROXY_SERVICE_RESOLVED_PROXY_LIST)
 
+// This event is emitted when a request was answered from the PAC result cache,
+// without running the PAC script.
+EVENT_TYPE(PROXY_SERVICE_PAC_RESULT_CACHE_HIT)
+
+// This event is emitted when the PAC result cache is emptied, because the
+// proxy settings or the network changed. It contains these parameters:
+//   {
+//     "hits": <Number of requests answered from the cache>,
+//     "misses": <Number of requests which had to run the PAC script>,
+//     "path_dependent_hosts": <Number of hosts found not to be cacheable>,
+//   }
+EVENT_TYPE(PROXY_SERVICE_PAC_RESULT_CACHE_STATS)
+
 // This event is emitted whenever the proxy settings used by ProxyService
 // change.
 //
@@ -2279,3 +2296,13 @@ EVENT_TYPE(SIMPLE_CACHE_ENTRY_CLOSE_END)
 // This event is created (in a source of the same name) when the internal DNS
 // resolver creates a UDP socket to check for global IPv6 connectivity.
 EVENT_TYPE(IPV6_REACHABILITY_CHECK)
+
+// This event is emitted by the predictor once it knows whether a preconnect it
+// made was used, or that a subresource host was fetched from without one.
+//   {
+//     "url": <The scheme, host and port which was preconnected or fetched>,
+//     "outcome": <"used", "unused" (the sockets went stale) or "missed">,
+//     "motivation": <Why the predictor preconnected.  Not present if missed>,
+//     "count": <The number of sockets preconnected.  Not present if missed>,
+//   }
+EVENT_TYPE(PREDICTOR_PRECONNECT_OUTCOME)
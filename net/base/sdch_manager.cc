@@ -358,6 +358,22 @@ void SdchManager::FetchDictionary(const GURL& request_url,
     fetcher_->Schedule(dictionary_url);
 }
 
+void SdchManager::PrefetchDictionaries(
+    const std::vector<GURL>& dictionary_urls) {
+  DCHECK(CalledOnValidThread());
+  if (!fetcher_.get())
+    return;
+  for (size_t i = 0; i < dictionary_urls.size(); ++i) {
+    const GURL& dictionary_url = dictionary_urls[i];
+    // A dictionary URL is its own referrer, which leaves only the scheme
+    // checks of CanFetchDictionary().
+    if (IsInSupportedDomain(dictionary_url) &&
+        CanFetchDictionary(dictionary_url, dictionary_url)) {
+      fetcher_->Schedule(dictionary_url);
+    }
+  }
+}
+
 bool SdchManager::CanFetchDictionary(const GURL& referring_url,
                                      const GURL& dictionary_url) const {
   DCHECK(CalledOnValidThread());
@@ -23,6 +23,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
@@ -294,6 +295,13 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // cached in memory.
   void FetchDictionary(const GURL& request_url, const GURL& dictionary_url);
 
+  // Fetches |dictionary_urls| ahead of any response advertising them, e.g.
+  // at startup, so that the first responses from those servers can already
+  // be SDCH encoded.  Only the embedder decides which dictionaries are worth
+  // it, so the URLs are not checked against a referring URL, but the same
+  // scheme restrictions as for FetchDictionary() apply.
+  void PrefetchDictionaries(const std::vector<GURL>& dictionary_urls);
+
   // Security test function used before initiating a FetchDictionary.
   // Return true if fetch is legal.
   bool CanFetchDictionary(const GURL& referring_url,
@@ -5,6 +5,7 @@
 #include <limits.h>
 
 #include <string>
+#include <vector>
 
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -21,6 +22,22 @@ static const char kTestVcdiffDictionary[] = "DictionaryFor"
 
 //------------------------------------------------------------------------------
 
+// Records the dictionaries it is asked to fetch.
+class MockSdchFetcher : public SdchFetcher {
+ public:
+  explicit MockSdchFetcher(std::vector<GURL>* scheduled)
+      : scheduled_(scheduled) {}
+
+  virtual void Schedule(const GURL& dictionary_url) OVERRIDE {
+    scheduled_->push_back(dictionary_url);
+  }
+
+ private:
+  std::vector<GURL>* scheduled_;
+
+  DISALLOW_COPY_AND_ASSIGN(MockSdchFetcher);
+};
+
 class SdchManagerTest : public testing::Test {
  protected:
   SdchManagerTest()
@@ -341,6 +358,28 @@ TEST_F(SdchManagerTest, PathMatch) {
   EXPECT_FALSE(PathMatch("/abc", "/ABC"));
 }
 
+TEST_F(SdchManagerTest, PrefetchDictionaries) {
+  std::vector<GURL> scheduled;
+  sdch_manager_->set_sdch_fetcher(new MockSdchFetcher(&scheduled));
+
+  std::vector<GURL> dictionary_urls;
+  dictionary_urls.push_back(GURL("http://www.google.com/dictionary"));
+  dictionary_urls.push_back(GURL("ftp://www.google.com/dictionary"));
+  dictionary_urls.push_back(GURL("https://www.google.com/dictionary"));
+  SdchManager::EnableSecureSchemeSupport(false);
+  sdch_manager_->PrefetchDictionaries(dictionary_urls);
+
+  // Only the HTTP dictionary may be fetched.
+  ASSERT_EQ(1u, scheduled.size());
+  EXPECT_EQ(dictionary_urls[0], scheduled[0]);
+
+  scheduled.clear();
+  SdchManager::EnableSecureSchemeSupport(true);
+  sdch_manager_->PrefetchDictionaries(dictionary_urls);
+  ASSERT_EQ(2u, scheduled.size());
+  EXPECT_EQ(dictionary_urls[2], scheduled[1]);
+}
+
 // The following are only applicable while we have a latency test in the code,
 // and can be removed when that functionality is stripped.
 TEST_F(SdchManagerTest, LatencyTestControls) {
@@ -0,0 +1,85 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/upload_data_stream.h"
+
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/test/perf_time_logger.h"
+#include "base/threading/thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/base/upload_file_element_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+// The size of the uploaded file.
+const int kFileSize = 32 * 1024 * 1024;
+
+// What HttpStreamParser reads at a time.
+const int kReadSize = 16 * 1024;
+
+class UploadDataStreamPerfTest : public testing::Test {
+ protected:
+  UploadDataStreamPerfTest() : file_thread_("UploadFileThread") {}
+
+  virtual void SetUp() {
+    ASSERT_TRUE(file_thread_.Start());
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(base::CreateTemporaryFileInDir(temp_dir_.path(),
+                                               &temp_file_path_));
+    std::vector<char> data(kFileSize, 'x');
+    ASSERT_EQ(kFileSize,
+              file_util::WriteFile(temp_file_path_, &data[0], kFileSize));
+  }
+
+  // Uploads the file through an UploadDataStream, reading it ahead or not.
+  void Upload(bool read_ahead, const char* description) {
+    UploadFileElementReader::ScopedReadAheadForTests scoped_read_ahead(
+        read_ahead);
+    ScopedVector<UploadElementReader> element_readers;
+    element_readers.push_back(new UploadFileElementReader(
+        file_thread_.message_loop_proxy().get(), temp_file_path_, 0,
+        kuint64max, base::Time()));
+    UploadDataStream stream(element_readers.Pass(), 0);
+
+    base::PerfTimeLogger timer(description);
+    TestCompletionCallback init_callback;
+    ASSERT_EQ(OK, init_callback.GetResult(
+        stream.Init(init_callback.callback())));
+    scoped_refptr<IOBuffer> buffer = new IOBuffer(kReadSize);
+    int total = 0;
+    while (!stream.IsEOF()) {
+      TestCompletionCallback read_callback;
+      int result = read_callback.GetResult(
+          stream.Read(buffer.get(), kReadSize, read_callback.callback()));
+      ASSERT_GT(result, 0);
+      total += result;
+    }
+    timer.Done();
+    EXPECT_EQ(kFileSize, total);
+  }
+
+  base::MessageLoopForIO message_loop_;
+  base::Thread file_thread_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath temp_file_path_;
+};
+
+TEST_F(UploadDataStreamPerfTest, File) {
+  // Warm up the page cache, so that neither run pays for the disk.
+  Upload(false, "Upload_32MB_warm_up");
+
+  Upload(false, "Upload_32MB_no_read_ahead");
+  Upload(true, "Upload_32MB_read_ahead");
+}
+
+}  // namespace net
@@ -4,6 +4,10 @@
 
 #include "net/base/upload_file_element_reader.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/file_util.h"
 #include "base/location.h"
@@ -20,8 +24,19 @@ namespace {
 // UploadFileElementReader::GetContentLength() when set to non-zero.
 uint64 overriding_content_length = 0;
 
+// In tests, this value is used to override whether files are read ahead.
+enum ReadAheadOverride {
+  READ_AHEAD_DEFAULT,
+  READ_AHEAD_DISABLED,
+  READ_AHEAD_ALWAYS,
+};
+ReadAheadOverride read_ahead_override = READ_AHEAD_DEFAULT;
+
 }  // namespace
 
+const uint64 UploadFileElementReader::kReadAheadMinContentLength = 1 << 20;
+const int UploadFileElementReader::kReadAheadChunkSize = 256 * 1024;
+
 UploadFileElementReader::UploadFileElementReader(
     base::TaskRunner* task_runner,
     const base::FilePath& path,
@@ -35,6 +50,10 @@ UploadFileElementReader::UploadFileElementReader(
       expected_modification_time_(expected_modification_time),
       content_length_(0),
       bytes_remaining_(0),
+      read_ahead_(false),
+      bytes_remaining_to_read_ahead_(0),
+      read_ahead_error_(OK),
+      pending_read_buf_length_(0),
       weak_ptr_factory_(this) {
   DCHECK(task_runner_.get());
 }
@@ -76,6 +95,8 @@ int UploadFileElementReader::Read(IOBuffer* buf,
                                   int buf_length,
                                   const CompletionCallback& callback) {
   DCHECK(!callback.is_null());
+  if (read_ahead_)
+    return ReadAhead(buf, buf_length, callback);
 
   uint64 num_bytes_to_read =
       std::min(BytesRemaining(), static_cast<uint64>(buf_length));
@@ -97,6 +118,15 @@ void UploadFileElementReader::Reset() {
   weak_ptr_factory_.InvalidateWeakPtrs();
   bytes_remaining_ = 0;
   content_length_ = 0;
+  read_ahead_ = false;
+  bytes_remaining_to_read_ahead_ = 0;
+  chunk_being_read_ = NULL;
+  current_chunk_ = NULL;
+  next_chunk_ = NULL;
+  read_ahead_error_ = OK;
+  pending_read_buf_ = NULL;
+  pending_read_buf_length_ = 0;
+  pending_read_callback_.Reset();
   file_stream_.reset();
 }
 
@@ -182,6 +212,14 @@ void UploadFileElementReader::OnGetFileInfoCompleted(
 
   content_length_ = length;
   bytes_remaining_ = GetContentLength();
+  read_ahead_ = read_ahead_override == READ_AHEAD_DEFAULT ?
+      bytes_remaining_ >= kReadAheadMinContentLength :
+      read_ahead_override == READ_AHEAD_ALWAYS;
+  if (read_ahead_) {
+    bytes_remaining_to_read_ahead_ = bytes_remaining_;
+    // Get the first chunk going while the request headers are sent.
+    MaybeStartReadingChunk();
+  }
   callback.Run(OK);
 }
 
@@ -201,6 +239,97 @@ int UploadFileElementReader::OnReadCompleted(
   return result;
 }
 
+int UploadFileElementReader::ReadAhead(IOBuffer* buf,
+                                       int buf_length,
+                                       const CompletionCallback& callback) {
+  DCHECK(pending_read_callback_.is_null());
+  if (BytesRemaining() == 0)
+    return 0;
+
+  int result = CopyFromChunks(buf, buf_length);
+  if (result != ERR_IO_PENDING)
+    return result;
+
+  pending_read_buf_ = buf;
+  pending_read_buf_length_ = buf_length;
+  pending_read_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
+void UploadFileElementReader::MaybeStartReadingChunk() {
+  if (chunk_being_read_.get() || next_chunk_.get() ||
+      read_ahead_error_ != OK || bytes_remaining_to_read_ahead_ == 0) {
+    return;
+  }
+
+  int chunk_size = static_cast<int>(std::min(
+      bytes_remaining_to_read_ahead_,
+      static_cast<uint64>(kReadAheadChunkSize)));
+  chunk_being_read_ = new IOBufferWithSize(chunk_size);
+  int result = file_stream_->Read(
+      chunk_being_read_.get(), chunk_size,
+      base::Bind(&UploadFileElementReader::OnChunkReadCompleted,
+                 weak_ptr_factory_.GetWeakPtr()));
+  // Even in async mode, FileStream::Read() may return the result synchronously.
+  if (result != ERR_IO_PENDING)
+    OnChunkRead(result);
+}
+
+void UploadFileElementReader::OnChunkRead(int result) {
+  DCHECK(chunk_being_read_.get());
+  DCHECK(!next_chunk_.get());
+  if (result == 0)  // Reached end-of-file earlier than expected.
+    result = ERR_UPLOAD_FILE_CHANGED;
+
+  if (result < 0) {
+    read_ahead_error_ = result;
+  } else {
+    DCHECK_GE(bytes_remaining_to_read_ahead_, static_cast<uint64>(result));
+    bytes_remaining_to_read_ahead_ -= result;
+    next_chunk_ = new DrainableIOBuffer(chunk_being_read_.get(), result);
+  }
+  chunk_being_read_ = NULL;
+  if (!current_chunk_.get()) {
+    current_chunk_.swap(next_chunk_);
+    MaybeStartReadingChunk();
+  }
+}
+
+void UploadFileElementReader::OnChunkReadCompleted(int result) {
+  OnChunkRead(result);
+  if (pending_read_callback_.is_null())
+    return;
+
+  result = CopyFromChunks(pending_read_buf_.get(), pending_read_buf_length_);
+  if (result == ERR_IO_PENDING)
+    return;
+  pending_read_buf_ = NULL;
+  pending_read_buf_length_ = 0;
+  CompletionCallback callback = pending_read_callback_;
+  pending_read_callback_.Reset();
+  callback.Run(result);
+}
+
+int UploadFileElementReader::CopyFromChunks(IOBuffer* buf, int buf_length) {
+  if (!current_chunk_.get()) {
+    MaybeStartReadingChunk();
+    if (!current_chunk_.get())
+      return read_ahead_error_ != OK ? read_ahead_error_ : ERR_IO_PENDING;
+  }
+
+  int num_bytes = std::min(buf_length, current_chunk_->BytesRemaining());
+  memcpy(buf->data(), current_chunk_->data(), num_bytes);
+  current_chunk_->DidConsume(num_bytes);
+  DCHECK_GE(bytes_remaining_, static_cast<uint64>(num_bytes));
+  bytes_remaining_ -= num_bytes;
+  if (current_chunk_->BytesRemaining() == 0) {
+    current_chunk_.swap(next_chunk_);
+    next_chunk_ = NULL;
+    MaybeStartReadingChunk();
+  }
+  return num_bytes;
+}
+
 UploadFileElementReader::ScopedOverridingContentLengthForTests::
 ScopedOverridingContentLengthForTests(uint64 value) {
   overriding_content_length = value;
@@ -211,4 +340,13 @@ UploadFileElementReader::ScopedOverridingContentLengthForTests::
   overriding_content_length = 0;
 }
 
+UploadFileElementReader::ScopedReadAheadForTests::ScopedReadAheadForTests(
+    bool enabled) {
+  read_ahead_override = enabled ? READ_AHEAD_ALWAYS : READ_AHEAD_DISABLED;
+}
+
+UploadFileElementReader::ScopedReadAheadForTests::~ScopedReadAheadForTests() {
+  read_ahead_override = READ_AHEAD_DEFAULT;
+}
+
 }  // namespace net
@@ -21,11 +21,23 @@ class TaskRunner;
 
 namespace net {
 
+class DrainableIOBuffer;
 class FileStream;
+class IOBufferWithSize;
 
 // An UploadElementReader implementation for file.
+//
+// Large files are read ahead in big chunks: while the consumer sends one
+// chunk, the next is read on |task_runner|, and most Read() calls complete
+// synchronously from memory.  Otherwise each Read(), typically of 16KB,
+// would take a round trip to the file thread.
 class NET_EXPORT UploadFileElementReader : public UploadElementReader {
  public:
+  // Files of at least this many bytes are read ahead.
+  static const uint64 kReadAheadMinContentLength;
+  // The size of the chunks in which files are read ahead.
+  static const int kReadAheadChunkSize;
+
   // |task_runner| is used to perform file operations. It must not be NULL.
   UploadFileElementReader(base::TaskRunner* task_runner,
                           const base::FilePath& path,
@@ -58,6 +70,10 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
                            UploadFileSmallerThanLength);
   FRIEND_TEST_ALL_PREFIXES(HttpNetworkTransactionSpdy3Test,
                            UploadFileSmallerThanLength);
+  FRIEND_TEST_ALL_PREFIXES(UploadFileElementReaderReadAheadTest,
+                           FileSmallerThanLength);
+  friend class UploadFileElementReaderReadAheadTest;
+  friend class UploadDataStreamPerfTest;
 
   // Resets this instance to the uninitialized state.
   void Reset();
@@ -72,6 +88,21 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
   // This method is used to implement Read().
   int OnReadCompleted(const CompletionCallback& callback, int result);
 
+  // These methods are used to implement Read() with read-ahead.
+  int ReadAhead(IOBuffer* buf, int buf_length,
+                const CompletionCallback& callback);
+  // Starts reading the next chunk of the file, unless a chunk is already
+  // being read or waiting for the one before to be consumed.
+  void MaybeStartReadingChunk();
+  // Makes the result of reading a chunk available to CopyFromChunks().
+  void OnChunkRead(int result);
+  // Completes the Read() which was waiting for OnChunkRead().
+  void OnChunkReadCompleted(int result);
+  // Copies up to |buf_length| bytes of the chunks which have been read to
+  // |buf|.  Returns the number of bytes copied, or the error which stopped
+  // reading ahead once all chunks read before it are consumed.
+  int CopyFromChunks(IOBuffer* buf, int buf_length);
+
   // Sets an value to override the result for GetContentLength().
   // Used for tests.
   struct NET_EXPORT_PRIVATE ScopedOverridingContentLengthForTests {
@@ -79,6 +110,13 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
     ~ScopedOverridingContentLengthForTests();
   };
 
+  // Disables reading ahead, or enables it for files of any size, to compare
+  // the two in tests.
+  struct NET_EXPORT_PRIVATE ScopedReadAheadForTests {
+    explicit ScopedReadAheadForTests(bool enabled);
+    ~ScopedReadAheadForTests();
+  };
+
   scoped_refptr<base::TaskRunner> task_runner_;
   const base::FilePath path_;
   const uint64 range_offset_;
@@ -87,6 +125,23 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
   scoped_ptr<FileStream> file_stream_;
   uint64 content_length_;
   uint64 bytes_remaining_;
+
+  // Whether the file is being read ahead.  Decided once the size is known.
+  bool read_ahead_;
+  // The number of bytes which have not been requested from |file_stream_|.
+  uint64 bytes_remaining_to_read_ahead_;
+  // The chunk being read, if any.
+  scoped_refptr<IOBufferWithSize> chunk_being_read_;
+  // The chunk being consumed, and the one read after it.  Either may be NULL.
+  scoped_refptr<DrainableIOBuffer> current_chunk_;
+  scoped_refptr<DrainableIOBuffer> next_chunk_;
+  // The error which stopped reading ahead, or OK.
+  int read_ahead_error_;
+  // The Read() waiting for a chunk, if any.
+  scoped_refptr<IOBuffer> pending_read_buf_;
+  int pending_read_buf_length_;
+  CompletionCallback pending_read_callback_;
+
   base::WeakPtrFactory<UploadFileElementReader> weak_ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(UploadFileElementReader);
@@ -234,4 +234,129 @@ TEST_F(UploadFileElementReaderTest, WrongPath) {
   EXPECT_EQ(ERR_FILE_NOT_FOUND, init_callback.WaitForResult());
 }
 
+// Reads files of any size ahead.
+class UploadFileElementReaderReadAheadTest : public PlatformTest {
+ protected:
+  UploadFileElementReaderReadAheadTest()
+      : read_ahead_(new UploadFileElementReader::ScopedReadAheadForTests(true)) {
+  }
+
+  virtual void SetUp() {
+    PlatformTest::SetUp();
+    // Spans a few chunks, the last one partial.
+    bytes_.resize(UploadFileElementReader::kReadAheadChunkSize * 2 + 123);
+    for (size_t i = 0; i < bytes_.size(); ++i)
+      bytes_[i] = static_cast<char>(i % 251);
+
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(base::CreateTemporaryFileInDir(temp_dir_.path(),
+                                               &temp_file_path_));
+    ASSERT_EQ(
+        static_cast<int>(bytes_.size()),
+        file_util::WriteFile(temp_file_path_, &bytes_[0], bytes_.size()));
+  }
+
+  virtual ~UploadFileElementReaderReadAheadTest() {
+    reader_.reset();
+    base::RunLoop().RunUntilIdle();
+  }
+
+  void InitReader(uint64 range_offset, uint64 range_length) {
+    reader_.reset(
+        new UploadFileElementReader(base::MessageLoopProxy::current().get(),
+                                    temp_file_path_,
+                                    range_offset,
+                                    range_length,
+                                    base::Time()));
+    TestCompletionCallback callback;
+    ASSERT_EQ(ERR_IO_PENDING, reader_->Init(callback.callback()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+  }
+
+  // Reads everything in 16KB pieces, like HttpStreamParser, and returns the
+  // first error, if any.  |sync_reads| is the number that didn't wait for the
+  // file.
+  int ReadAll(std::vector<char>* data, int* sync_reads) {
+    const int kBufferSize = 16 * 1024;
+    scoped_refptr<IOBuffer> buffer = new IOBuffer(kBufferSize);
+    *sync_reads = 0;
+    while (reader_->BytesRemaining() > 0) {
+      TestCompletionCallback callback;
+      int result = reader_->Read(buffer.get(), kBufferSize,
+                                 callback.callback());
+      if (result == ERR_IO_PENDING)
+        result = callback.WaitForResult();
+      else
+        ++*sync_reads;
+      if (result <= 0)
+        return result;
+      data->insert(data->end(), buffer->data(), buffer->data() + result);
+    }
+    return OK;
+  }
+
+  scoped_ptr<UploadFileElementReader::ScopedReadAheadForTests> read_ahead_;
+  std::vector<char> bytes_;
+  scoped_ptr<UploadElementReader> reader_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath temp_file_path_;
+};
+
+TEST_F(UploadFileElementReaderReadAheadTest, ReadAll) {
+  InitReader(0, kuint64max);
+  EXPECT_EQ(bytes_.size(), reader_->GetContentLength());
+
+  std::vector<char> data;
+  int sync_reads;
+  ASSERT_EQ(OK, ReadAll(&data, &sync_reads));
+  EXPECT_EQ(bytes_, data);
+  // Most reads are served from a chunk read before.
+  EXPECT_GT(sync_reads, 0);
+  EXPECT_EQ(0, reader_->Read(new IOBuffer(1), 1,
+                             TestCompletionCallback().callback()));
+}
+
+TEST_F(UploadFileElementReaderReadAheadTest, Range) {
+  const uint64 kOffset = 1000;
+  const uint64 kLength = UploadFileElementReader::kReadAheadChunkSize + 1;
+  InitReader(kOffset, kLength);
+  EXPECT_EQ(kLength, reader_->GetContentLength());
+
+  std::vector<char> data;
+  int sync_reads;
+  ASSERT_EQ(OK, ReadAll(&data, &sync_reads));
+  EXPECT_EQ(std::vector<char>(bytes_.begin() + kOffset,
+                              bytes_.begin() + kOffset + kLength),
+            data);
+}
+
+TEST_F(UploadFileElementReaderReadAheadTest, FileSmallerThanLength) {
+  UploadFileElementReader::ScopedOverridingContentLengthForTests
+      overriding_content_length(bytes_.size() * 2);
+  InitReader(0, kuint64max);
+
+  // The file is read to its end, then the read fails.
+  std::vector<char> data;
+  int sync_reads;
+  EXPECT_EQ(ERR_UPLOAD_FILE_CHANGED, ReadAll(&data, &sync_reads));
+  EXPECT_EQ(bytes_, data);
+}
+
+// Re-initializing drops the chunks read ahead.
+TEST_F(UploadFileElementReaderReadAheadTest, MultipleInit) {
+  InitReader(0, kuint64max);
+  scoped_refptr<IOBuffer> buffer = new IOBuffer(10);
+  TestCompletionCallback read_callback;
+  int result = reader_->Read(buffer.get(), 10, read_callback.callback());
+  EXPECT_EQ(10, read_callback.GetResult(result));
+
+  TestCompletionCallback init_callback;
+  ASSERT_EQ(ERR_IO_PENDING, reader_->Init(init_callback.callback()));
+  EXPECT_EQ(OK, init_callback.WaitForResult());
+  std::vector<char> data;
+  int sync_reads;
+  ASSERT_EQ(OK, ReadAll(&data, &sync_reads));
+  EXPECT_EQ(bytes_, data);
+}
+
 }  // namespace net
@@ -20,6 +20,7 @@
 #include "net/cert/cert_trust_anchor_provider.h"
 #include "net/cert/cert_verify_proc.h"
 #include "net/cert/crl_set.h"
+#include "net/cert/shared_cert_verifier_cache.h"
 #include "net/cert/x509_certificate.h"
 #include "net/cert/x509_certificate_net_log_param.h"
 
@@ -258,6 +259,7 @@ class CertVerifierWorker {
                                      hostname_,
                                      flags_,
                                      additional_trust_anchors_,
+                                     crl_set_ ? crl_set_->sequence() : 0,
                                      error_,
                                      verify_result_);
       }
@@ -391,11 +393,14 @@ class CertVerifierJob {
 MultiThreadedCertVerifier::MultiThreadedCertVerifier(
     CertVerifyProc* verify_proc)
     : cache_(kMaxCacheEntries),
+      crl_set_sequence_(0),
       requests_(0),
       cache_hits_(0),
       inflight_joins_(0),
+      shared_cache_hits_(0),
       verify_proc_(verify_proc),
-      trust_anchor_provider_(NULL) {
+      trust_anchor_provider_(NULL),
+      shared_cache_(NULL) {
   CertDatabase::GetInstance()->AddObserver(this);
 }
 
@@ -410,6 +415,12 @@ void MultiThreadedCertVerifier::SetCertTrustAnchorProvider(
   trust_anchor_provider_ = trust_anchor_provider;
 }
 
+void MultiThreadedCertVerifier::SetSharedCache(
+    SharedCertVerifierCache* shared_cache) {
+  DCHECK(CalledOnValidThread());
+  shared_cache_ = shared_cache;
+}
+
 int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
                                       const std::string& hostname,
                                       int flags,
@@ -427,6 +438,14 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
 
   requests_++;
 
+  // Results verified against an older CRLSet may no longer hold. CRLSets only
+  // ever move forward, so there is no point in keeping those around.
+  uint32 crl_set_sequence = crl_set ? crl_set->sequence() : 0;
+  if (crl_set_sequence != crl_set_sequence_) {
+    ClearCache();
+    crl_set_sequence_ = crl_set_sequence;
+  }
+
   const CertificateList empty_cert_list;
   const CertificateList& additional_trust_anchors =
       trust_anchor_provider_ ?
@@ -443,6 +462,20 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
     return cached_entry->error;
   }
 
+  if (shared_cache_) {
+    int error;
+    const SharedCertVerifierCache::Key shared_key(
+        key.hash_values, key.hostname, key.flags, crl_set_sequence);
+    bool hit = shared_cache_->Get(shared_key, base::Time::Now(), &error,
+                                  verify_result);
+    UMA_HISTOGRAM_BOOLEAN("Net.CertVerifier_SharedCacheHit", hit);
+    if (hit) {
+      ++shared_cache_hits_;
+      *out_req = NULL;
+      return error;
+    }
+  }
+
   // No cache hit. See if an identical request is currently in flight.
   CertVerifierJob* job;
   std::map<RequestParams, CertVerifierJob*>::const_iterator j;
@@ -528,6 +561,7 @@ void MultiThreadedCertVerifier::HandleResult(
     const std::string& hostname,
     int flags,
     const CertificateList& additional_trust_anchors,
+    uint32 crl_set_sequence,
     int error,
     const CertVerifyResult& verify_result) {
   DCHECK(CalledOnValidThread());
@@ -539,9 +573,19 @@ void MultiThreadedCertVerifier::HandleResult(
   cached_result.error = error;
   cached_result.result = verify_result;
   base::Time now = base::Time::Now();
-  cache_.Put(
-      key, cached_result, CacheValidityPeriod(now),
-      CacheValidityPeriod(now, now + base::TimeDelta::FromSeconds(kTTLSecs)));
+  // A job which was started before a CRLSet update doesn't get to fill the
+  // cache.
+  if (crl_set_sequence == crl_set_sequence_) {
+    cache_.Put(
+        key, cached_result, CacheValidityPeriod(now),
+        CacheValidityPeriod(now, now + base::TimeDelta::FromSeconds(kTTLSecs)));
+  }
+  if (shared_cache_) {
+    const SharedCertVerifierCache::Key shared_key(
+        key.hash_values, hostname, flags, crl_set_sequence);
+    shared_cache_->Put(shared_key, error, verify_result, now,
+                       base::TimeDelta::FromSeconds(kTTLSecs));
+  }
 
   std::map<RequestParams, CertVerifierJob*>::iterator j;
   j = inflight_.find(key);
@@ -561,6 +605,8 @@ void MultiThreadedCertVerifier::OnCACertChanged(
   DCHECK(CalledOnValidThread());
 
   ClearCache();
+  if (shared_cache_)
+    shared_cache_->Clear();
 }
 
 }  // namespace net
@@ -29,6 +29,7 @@ class CertVerifierJob;
 class CertVerifierRequest;
 class CertVerifierWorker;
 class CertVerifyProc;
+class SharedCertVerifierCache;
 
 // MultiThreadedCertVerifier is a CertVerifier implementation that runs
 // synchronous CertVerifier implementations on worker threads.
@@ -53,6 +54,13 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   void SetCertTrustAnchorProvider(
       CertTrustAnchorProvider* trust_anchor_provider);
 
+  // Configures a cache which is consulted when this verifier's own cache
+  // misses, and which also stores this verifier's results, so that verifiers
+  // sharing it don't verify the same chain over and over again. Only verifiers
+  // whose CertVerifyProcs trust the same roots may share a cache. It must
+  // outlive the MultiThreadedCertVerifier.
+  void SetSharedCache(SharedCertVerifierCache* shared_cache);
+
   // CertVerifier implementation
   virtual int Verify(X509Certificate* cert,
                      const std::string& hostname,
@@ -78,6 +86,7 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
                            RequestParamsComparators);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
                            CertTrustAnchorProvider);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, SharedCache);
 
   // Input parameters of a certificate verification request.
   struct NET_EXPORT_PRIVATE RequestParams {
@@ -133,6 +142,7 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
                     const std::string& hostname,
                     int flags,
                     const CertificateList& additional_trust_anchors,
+                    uint32 crl_set_sequence,
                     int error,
                     const CertVerifyResult& verify_result);
 
@@ -145,6 +155,7 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   uint64 cache_hits() const { return cache_hits_; }
   uint64 requests() const { return requests_; }
   uint64 inflight_joins() const { return inflight_joins_; }
+  uint64 shared_cache_hits() const { return shared_cache_hits_; }
 
   // cache_ maps from a request to a cached result.
   CertVerifierCache cache_;
@@ -153,14 +164,21 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   // place.
   std::map<RequestParams, CertVerifierJob*> inflight_;
 
+  // The sequence number of the most recent CRLSet seen by Verify(). Results
+  // in cache_ were verified against it (or against no CRLSet at all).
+  uint32 crl_set_sequence_;
+
   uint64 requests_;
   uint64 cache_hits_;
   uint64 inflight_joins_;
+  uint64 shared_cache_hits_;
 
   scoped_refptr<CertVerifyProc> verify_proc_;
 
   CertTrustAnchorProvider* trust_anchor_provider_;
 
+  SharedCertVerifierCache* shared_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(MultiThreadedCertVerifier);
 };
 
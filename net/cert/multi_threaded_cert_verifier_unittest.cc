@@ -15,6 +15,7 @@
 #include "net/cert/cert_trust_anchor_provider.h"
 #include "net/cert/cert_verify_proc.h"
 #include "net/cert/cert_verify_result.h"
+#include "net/cert/shared_cert_verifier_cache.h"
 #include "net/cert/x509_certificate.h"
 #include "net/test/cert_test_util.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -482,4 +483,56 @@ TEST_F(MultiThreadedCertVerifierTest, CertTrustAnchorProvider) {
   ASSERT_EQ(1u, verifier_.cache_hits());
 }
 
+
+// Tests that a result verified by one verifier is reused by another verifier
+// which shares its cache.
+TEST_F(MultiThreadedCertVerifierTest, SharedCache) {
+  base::FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert);
+
+  SharedCertVerifierCache shared_cache(16);
+  verifier_.SetSharedCache(&shared_cache);
+  MultiThreadedCertVerifier other_verifier(new MockCertVerifyProc());
+  other_verifier.SetSharedCache(&shared_cache);
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  CertVerifier::RequestHandle request_handle;
+
+  error = verifier_.Verify(test_cert.get(),
+                           "www.example.com",
+                           0,
+                           NULL,
+                           &verify_result,
+                           callback.callback(),
+                           &request_handle,
+                           BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  ASSERT_TRUE(IsCertificateError(error));
+  EXPECT_EQ(1u, shared_cache.size());
+
+  // Synchronous completion from the shared cache.
+  error = other_verifier.Verify(test_cert.get(),
+                                "www.example.com",
+                                0,
+                                NULL,
+                                &verify_result,
+                                callback.callback(),
+                                &request_handle,
+                                BoundNetLog());
+  EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, error);
+  EXPECT_EQ(CERT_STATUS_COMMON_NAME_INVALID, verify_result.cert_status);
+  EXPECT_TRUE(request_handle == NULL);
+  EXPECT_EQ(0u, other_verifier.cache_hits());
+  EXPECT_EQ(1u, other_verifier.shared_cache_hits());
+
+  // A CA certificate change invalidates the shared results too.
+  verifier_.OnCACertChanged(NULL);
+  EXPECT_EQ(0u, shared_cache.size());
+}
+
 }  // namespace net
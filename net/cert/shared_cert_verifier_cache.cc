@@ -0,0 +1,150 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert/shared_cert_verifier_cache.h"
+
+#include <algorithm>
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "net/base/net_errors.h"
+#include "net/cert/x509_certificate.h"
+
+namespace net {
+
+namespace {
+
+struct SharedCacheHolder {
+  SharedCacheHolder() : cache(SharedCertVerifierCache::kDefaultMaxEntries) {}
+
+  SharedCertVerifierCache cache;
+};
+
+base::LazyInstance<SharedCacheHolder>::Leaky g_shared_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+const size_t SharedCertVerifierCache::kDefaultMaxEntries = 4096;
+
+SharedCertVerifierCache::Key::Key(
+    const std::vector<SHA1HashValue>& hash_values,
+    const std::string& hostname,
+    int flags,
+    uint32 crl_set_sequence)
+    : hash_values(hash_values),
+      hostname(hostname),
+      flags(flags),
+      crl_set_sequence(crl_set_sequence) {
+}
+
+SharedCertVerifierCache::Key::~Key() {}
+
+bool SharedCertVerifierCache::Key::operator<(const Key& other) const {
+  // The integers are compared first, as that is cheaper.
+  if (flags != other.flags)
+    return flags < other.flags;
+  if (crl_set_sequence != other.crl_set_sequence)
+    return crl_set_sequence < other.crl_set_sequence;
+  if (hostname != other.hostname)
+    return hostname < other.hostname;
+  return std::lexicographical_compare(
+      hash_values.begin(), hash_values.end(),
+      other.hash_values.begin(), other.hash_values.end(),
+      SHA1HashValueLessThan());
+}
+
+SharedCertVerifierCache::Entry::Entry() : error(ERR_FAILED) {}
+
+SharedCertVerifierCache::Entry::~Entry() {}
+
+bool SharedCertVerifierCache::Entry::IsValidAt(const base::Time& now) const {
+  return now >= verification_time && now < expiration_time;
+}
+
+SharedCertVerifierCache::Shard::Shard(size_t max_entries)
+    : entries(max_entries) {
+}
+
+SharedCertVerifierCache::Shard::~Shard() {}
+
+SharedCertVerifierCache::SharedCertVerifierCache(size_t max_entries) {
+  size_t max_entries_per_shard =
+      std::max<size_t>(1, (max_entries + kNumShards - 1) / kNumShards);
+  for (size_t i = 0; i < kNumShards; ++i)
+    shards_[i] = new Shard(max_entries_per_shard);
+}
+
+SharedCertVerifierCache::~SharedCertVerifierCache() {
+  for (size_t i = 0; i < kNumShards; ++i)
+    delete shards_[i];
+}
+
+// static
+SharedCertVerifierCache* SharedCertVerifierCache::GetInstance() {
+  return &g_shared_cache.Get().cache;
+}
+
+bool SharedCertVerifierCache::Get(const Key& key,
+                                  const base::Time& now,
+                                  int* error,
+                                  CertVerifyResult* result) {
+  Shard* shard = GetShard(key);
+  base::AutoLock locked(shard->lock);
+
+  EntryMap::iterator it = shard->entries.Get(key);
+  if (it == shard->entries.end())
+    return false;
+  if (!it->second.IsValidAt(now)) {
+    shard->entries.Erase(it);
+    return false;
+  }
+  *error = it->second.error;
+  *result = it->second.result;
+  return true;
+}
+
+void SharedCertVerifierCache::Put(const Key& key,
+                                  int error,
+                                  const CertVerifyResult& result,
+                                  const base::Time& now,
+                                  const base::TimeDelta& ttl) {
+  Entry entry;
+  entry.error = error;
+  entry.result = result;
+  entry.verification_time = now;
+  entry.expiration_time = now + ttl;
+
+  Shard* shard = GetShard(key);
+  base::AutoLock locked(shard->lock);
+  shard->entries.Put(key, entry);
+}
+
+void SharedCertVerifierCache::Clear() {
+  for (size_t i = 0; i < kNumShards; ++i) {
+    base::AutoLock locked(shards_[i]->lock);
+    shards_[i]->entries.Clear();
+  }
+}
+
+size_t SharedCertVerifierCache::size() const {
+  size_t size = 0;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    base::AutoLock locked(shards_[i]->lock);
+    size += shards_[i]->entries.size();
+  }
+  return size;
+}
+
+SharedCertVerifierCache::Shard* SharedCertVerifierCache::GetShard(
+    const Key& key) const {
+  // The first hash is the fingerprint of the certificate, which is as good a
+  // hash of the key as any.
+  DCHECK(!key.hash_values.empty());
+  if (key.hash_values.empty())
+    return shards_[0];
+  return shards_[key.hash_values[0].data[0] % kNumShards];
+}
+
+}  // namespace net
@@ -0,0 +1,113 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_CERT_SHARED_CERT_VERIFIER_CACHE_H_
+#define NET_CERT_SHARED_CERT_VERIFIER_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "net/base/hash_value.h"
+#include "net/base/net_export.h"
+#include "net/cert/cert_verify_result.h"
+
+namespace net {
+
+// SharedCertVerifierCache holds certificate verification results so that they
+// can be shared by any number of MultiThreadedCertVerifiers, across threads.
+// The entries are split over a fixed number of
+// independently locked shards, so concurrent lookups of different chains
+// rarely contend.
+//
+// A result is only reused for exactly the same chain, hostname, flags,
+// additional trust anchors and CRLSet sequence number, so pushing a new CRLSet
+// implicitly invalidates everything verified against the old one.
+class NET_EXPORT SharedCertVerifierCache {
+ public:
+  struct NET_EXPORT_PRIVATE Key {
+    // |hash_values| holds the fingerprint of the certificate, the fingerprint
+    // of its intermediates, and then those of any additional trust anchors.
+    Key(const std::vector<SHA1HashValue>& hash_values,
+        const std::string& hostname,
+        int flags,
+        uint32 crl_set_sequence);
+    ~Key();
+
+    bool operator<(const Key& other) const;
+
+    std::vector<SHA1HashValue> hash_values;
+    std::string hostname;
+    int flags;
+    uint32 crl_set_sequence;
+  };
+
+  // The number of entries of the process-wide cache.
+  static const size_t kDefaultMaxEntries;
+
+  // Creates a cache of at most (about) |max_entries| results.
+  explicit SharedCertVerifierCache(size_t max_entries);
+  ~SharedCertVerifierCache();
+
+  // Returns the process-wide cache.
+  static SharedCertVerifierCache* GetInstance();
+
+  // If there is a result for |key| which is valid at |now|, copies it to
+  // |error| and |result| and returns true.
+  bool Get(const Key& key,
+           const base::Time& now,
+           int* error,
+           CertVerifyResult* result);
+
+  // Stores a result which was verified at |now| and is valid for |ttl|.
+  void Put(const Key& key,
+           int error,
+           const CertVerifyResult& result,
+           const base::Time& now,
+           const base::TimeDelta& ttl);
+
+  void Clear();
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    // Returns true iff |now| is within the validity period of the result. The
+    // period starts when the result was verified, so that the user correcting
+    // clock skew in either direction causes a re-verification.
+    bool IsValidAt(const base::Time& now) const;
+
+    int error;
+    CertVerifyResult result;
+    base::Time verification_time;
+    base::Time expiration_time;
+  };
+  typedef base::MRUCache<Key, Entry> EntryMap;
+
+  struct Shard {
+    explicit Shard(size_t max_entries);
+    ~Shard();
+
+    base::Lock lock;
+    EntryMap entries;
+  };
+
+  enum { kNumShards = 16 };
+
+  Shard* GetShard(const Key& key) const;
+
+  Shard* shards_[kNumShards];
+
+  DISALLOW_COPY_AND_ASSIGN(SharedCertVerifierCache);
+};
+
+}  // namespace net
+
+#endif  // NET_CERT_SHARED_CERT_VERIFIER_CACHE_H_
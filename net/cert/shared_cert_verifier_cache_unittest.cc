@@ -0,0 +1,101 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert/shared_cert_verifier_cache.h"
+
+#include <string.h>
+
+#include "net/base/net_errors.h"
+#include "net/cert/cert_status_flags.h"
+#include "net/cert/x509_certificate.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kTTLSeconds = 1800;
+
+SharedCertVerifierCache::Key MakeKey(char fill, uint32 crl_set_sequence) {
+  std::vector<SHA1HashValue> hash_values(2);
+  memset(hash_values[0].data, fill, sizeof(hash_values[0].data));
+  memset(hash_values[1].data, 'i', sizeof(hash_values[1].data));
+  return SharedCertVerifierCache::Key(hash_values, "www.example.com", 0,
+                                      crl_set_sequence);
+}
+
+CertVerifyResult MakeResult(CertStatus cert_status) {
+  CertVerifyResult result;
+  result.cert_status = cert_status;
+  result.is_issued_by_known_root = true;
+  HashValue hash(HASH_VALUE_SHA1);
+  memset(hash.data(), 'p', hash.size());
+  result.public_key_hashes.push_back(hash);
+  return result;
+}
+
+class SharedCertVerifierCacheTest : public testing::Test {
+ protected:
+  SharedCertVerifierCacheTest()
+      : cache_(64),
+        now_(base::Time::Now()),
+        ttl_(base::TimeDelta::FromSeconds(kTTLSeconds)) {
+  }
+
+  SharedCertVerifierCache cache_;
+  const base::Time now_;
+  const base::TimeDelta ttl_;
+};
+
+TEST_F(SharedCertVerifierCacheTest, GetAndPut) {
+  int error = OK;
+  CertVerifyResult result;
+  EXPECT_FALSE(cache_.Get(MakeKey('a', 0), now_, &error, &result));
+
+  cache_.Put(MakeKey('a', 0), ERR_CERT_DATE_INVALID,
+             MakeResult(CERT_STATUS_DATE_INVALID), now_, ttl_);
+  EXPECT_EQ(1u, cache_.size());
+  ASSERT_TRUE(cache_.Get(MakeKey('a', 0), now_, &error, &result));
+  EXPECT_EQ(ERR_CERT_DATE_INVALID, error);
+  EXPECT_EQ(CERT_STATUS_DATE_INVALID, result.cert_status);
+  EXPECT_TRUE(result.is_issued_by_known_root);
+
+  // Any part of the key differing is a miss.
+  EXPECT_FALSE(cache_.Get(MakeKey('b', 0), now_, &error, &result));
+  EXPECT_FALSE(cache_.Get(MakeKey('a', 1), now_, &error, &result));
+
+  cache_.Clear();
+  EXPECT_EQ(0u, cache_.size());
+  EXPECT_FALSE(cache_.Get(MakeKey('a', 0), now_, &error, &result));
+}
+
+TEST_F(SharedCertVerifierCacheTest, Expiration) {
+  int error;
+  CertVerifyResult result;
+  cache_.Put(MakeKey('a', 0), OK, MakeResult(0), now_, ttl_);
+
+  EXPECT_TRUE(cache_.Get(MakeKey('a', 0), now_ + ttl_ / 2, &error, &result));
+  // The clock being set back before the verification is a miss as well.
+  EXPECT_FALSE(cache_.Get(MakeKey('a', 0),
+                          now_ - base::TimeDelta::FromSeconds(1),
+                          &error, &result));
+  EXPECT_FALSE(cache_.Get(MakeKey('a', 0), now_ + ttl_, &error, &result));
+}
+
+TEST_F(SharedCertVerifierCacheTest, EvictsLeastRecentlyUsed) {
+  SharedCertVerifierCache cache(1);
+  cache.Put(MakeKey('a', 0), OK, MakeResult(0), now_, ttl_);
+  cache.Put(MakeKey('a', 1), OK, MakeResult(0), now_, ttl_);
+
+  // Both keys are of the same certificate, so they share a shard.
+  int error;
+  CertVerifyResult result;
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_FALSE(cache.Get(MakeKey('a', 0), now_, &error, &result));
+  EXPECT_TRUE(cache.Get(MakeKey('a', 1), now_, &error, &result));
+}
+
+}  // namespace
+
+}  // namespace net
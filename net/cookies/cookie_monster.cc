@@ -126,6 +126,14 @@ typedef std::vector<CanonicalCookie*> CanonicalCookieVector;
 // will update it again.
 const int kDefaultAccessUpdateThresholdSeconds = 60;
 
+// Maximum number of hosts per key kept in the host cookies cache, so requests
+// to many subdomains of one site can't grow it without bound.
+const size_t kMaxCachedHostsPerKey = 16;
+
+// Number of cookies GarbageCollectExpiredIncrementally() looks at per call,
+// rounded up to whole keys.
+const size_t kIncrementalGarbageCollectCookies = 100;
+
 // Comparator to sort cookies from highest creation date to lowest
 // creation date.
 struct OrderByCreationTimeDesc {
@@ -1316,9 +1324,12 @@ std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
 
   TimeTicks start_time(TimeTicks::Now());
 
+  const Time current_time(CurrentTime());
+  RecordPeriodicStats(current_time);
+
   std::vector<CanonicalCookie*> cookies;
-  FindCookiesForHostAndDomain(url, options, true, &cookies);
-  std::sort(cookies.begin(), cookies.end(), CookieSorter);
+  FindSortedCookiesForURL(GetKey(url.host()), url, options, current_time,
+                          &cookies);
 
   std::string cookie_line = BuildCookieLine(cookies);
 
@@ -1726,6 +1737,86 @@ void CookieMonster::FindCookiesForKey(const std::string& key,
   }
 }
 
+void CookieMonster::FindSortedCookiesForURL(
+    const std::string& key,
+    const GURL& url,
+    const CookieOptions& options,
+    const Time& current,
+    std::vector<CanonicalCookie*>* cookies) {
+  lock_.AssertAcquired();
+
+  std::string host_key(url.host());
+  host_key.push_back(url.SchemeIsSecure() ? 's' : '-');
+  host_key.push_back(options.exclude_httponly() ? '-' : 'h');
+
+  HostCookies* host_cookies = NULL;
+  HostCookiesCache::iterator key_it = host_cookies_cache_.find(key);
+  if (key_it != host_cookies_cache_.end()) {
+    std::map<std::string, HostCookies>::iterator host_it =
+        key_it->second.find(host_key);
+    if (host_it != key_it->second.end() &&
+        (keep_expired_cookies_ || host_it->second.expiry.is_null() ||
+         current < host_it->second.expiry)) {
+      host_cookies = &host_it->second;
+    }
+  }
+
+  if (!host_cookies) {
+    HostCookies found;
+    bool key_has_cookies = false;
+    for (CookieMapItPair its = cookies_.equal_range(key);
+         its.first != its.second; ) {
+      CookieMap::iterator curit = its.first;
+      CanonicalCookie* cc = curit->second;
+      ++its.first;
+
+      if (cc->IsExpired(current) && !keep_expired_cookies_) {
+        InternalDeleteCookie(curit, true, DELETE_COOKIE_EXPIRED);
+        continue;
+      }
+      key_has_cookies = true;
+
+      // Everything IncludeForRequestURL() checks, except for the path.
+      if (options.exclude_httponly() && cc->IsHttpOnly())
+        continue;
+      if (cc->IsSecure() && !url.SchemeIsSecure())
+        continue;
+      if (!cc->IsDomainMatch(url.host()))
+        continue;
+
+      found.cookies.push_back(cc);
+      if (cc->IsPersistent() &&
+          (found.expiry.is_null() || cc->ExpiryDate() < found.expiry)) {
+        found.expiry = cc->ExpiryDate();
+      }
+    }
+    std::sort(found.cookies.begin(), found.cookies.end(), CookieSorter);
+
+    // Keys without cookies are not cached, which keeps the cache bounded by
+    // the size of |cookies_|.
+    if (!key_has_cookies)
+      return;
+
+    std::map<std::string, HostCookies>& key_cache = host_cookies_cache_[key];
+    if (key_cache.size() >= kMaxCachedHostsPerKey)
+      key_cache.clear();
+    host_cookies = &key_cache[host_key];
+    host_cookies->cookies.swap(found.cookies);
+    host_cookies->expiry = found.expiry;
+  }
+
+  const std::string path(url.path());
+  for (std::vector<CanonicalCookie*>::const_iterator it =
+           host_cookies->cookies.begin();
+       it != host_cookies->cookies.end(); ++it) {
+    CanonicalCookie* cc = *it;
+    if (!cc->IsOnPath(path))
+      continue;
+    InternalUpdateCookieAccessTime(cc, current);
+    cookies->push_back(cc);
+  }
+}
+
 bool CookieMonster::DeleteAnyEquivalentCookie(const std::string& key,
                                               const CanonicalCookie& ecc,
                                               bool skip_httponly,
@@ -1766,6 +1857,7 @@ CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
   if ((cc->IsPersistent() || persist_session_cookies_) && store_.get() &&
       sync_to_store)
     store_->AddCookie(*cc);
+  host_cookies_cache_.erase(key);
   CookieMap::iterator inserted =
       cookies_.insert(CookieMap::value_type(key, cc));
   if (delegate_.get()) {
@@ -1888,6 +1980,7 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
     if (mapping.notify)
       delegate_->OnCookieChanged(*cc, true, mapping.cause);
   }
+  host_cookies_cache_.erase(it->first);
   cookies_.erase(it);
   delete cc;
 }
@@ -1902,6 +1995,10 @@ int CookieMonster::GarbageCollect(const Time& current,
   Time safe_date(
       Time::Now() - TimeDelta::FromDays(kSafeFromGlobalPurgeDays));
 
+  // Sweep a slice of the map for expired cookies on every call, so they don't
+  // pile up until a key or the whole map overflows.
+  num_deleted += GarbageCollectExpiredIncrementally(current);
+
   // Collect garbage for this key, minding cookie priorities.
   if (cookies_.count(key) > kDomainMaxCookies) {
     VLOG(kVlogGarbageCollection) << "GarbageCollect() key: " << key;
@@ -2037,6 +2134,31 @@ int CookieMonster::GarbageCollectExpired(
   return num_deleted;
 }
 
+int CookieMonster::GarbageCollectExpiredIncrementally(const Time& current) {
+  if (keep_expired_cookies_)
+    return 0;
+
+  lock_.AssertAcquired();
+
+  int num_deleted = 0;
+  size_t num_visited = 0;
+  CookieMap::iterator it = gc_cursor_key_.empty() ?
+      cookies_.begin() : cookies_.upper_bound(gc_cursor_key_);
+  while (it != cookies_.end() &&
+         num_visited < kIncrementalGarbageCollectCookies) {
+    gc_cursor_key_ = it->first;
+    CookieMap::iterator key_end = cookies_.upper_bound(gc_cursor_key_);
+    num_visited += std::distance(it, key_end);
+    num_deleted += GarbageCollectExpired(current, CookieMapItPair(it, key_end),
+                                         NULL);
+    it = key_end;
+  }
+  if (it == cookies_.end())
+    gc_cursor_key_.clear();
+
+  return num_deleted;
+}
+
 int CookieMonster::GarbageCollectDeleteRange(
     const Time& current,
     DeletionCause cause,
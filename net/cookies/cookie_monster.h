@@ -347,6 +347,9 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // For FindCookiesForKey.
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, ShortLivedSessionCookies);
 
+  // For host_cookies_cache_.
+  FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, HostCookiesCacheInvalidation);
+
   // Internal reasons for deletion, used to populate informative histograms
   // and to provide a public cause for onCookieChange notifications.
   //
@@ -510,6 +513,15 @@ class NET_EXPORT CookieMonster : public CookieStore {
                          bool update_access_time,
                          std::vector<CanonicalCookie*>* cookies);
 
+  // Like FindCookiesForKey() with |update_access_time| set, but the cookies
+  // come out in cookie line order, and the per-host part of the work is
+  // served from |host_cookies_cache_| when possible.
+  void FindSortedCookiesForURL(const std::string& key,
+                               const GURL& url,
+                               const CookieOptions& options,
+                               const base::Time& current,
+                               std::vector<CanonicalCookie*>* cookies);
+
   // Delete any cookies that are equivalent to |ecc| (same path, domain, etc).
   // If |skip_httponly| is true, httponly cookies will not be deleted.  The
   // return value with be true if |skip_httponly| skipped an httponly cookie.
@@ -568,6 +580,14 @@ class NET_EXPORT CookieMonster : public CookieStore {
                             const CookieMapItPair& itpair,
                             std::vector<CookieMap::iterator>* cookie_its);
 
+  // Helper for GarbageCollect(). Deletes the expired cookies among the next
+  // few keys after |gc_cursor_key_|, wrapping around at the end of the map, so
+  // that cookies of hosts that are never visited again are eventually
+  // reclaimed without scanning the whole map at once.
+  //
+  // Returns the number of cookies deleted.
+  int GarbageCollectExpiredIncrementally(const base::Time& current);
+
   // Helper for GarbageCollect(). Deletes all cookies in the range specified by
   // [|it_begin|, |it_end|). Returns the number of cookies deleted.
   int GarbageCollectDeleteRange(const base::Time& current,
@@ -621,6 +641,25 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   CookieMap cookies_;
 
+  // The cookies of a key that match a given host, scheme security and
+  // httponly option, sorted for the cookie line. Only the path remains to be
+  // checked per request. |expiry| is the earliest expiry date among them, or
+  // null if none of them expire.
+  struct HostCookies {
+    std::vector<CanonicalCookie*> cookies;
+    base::Time expiry;
+  };
+  // Maps a CookieMap key to the HostCookies computed for hosts under it. The
+  // entry for a key is dropped whenever a cookie under that key is inserted
+  // or deleted, so the pointers are never stale.
+  typedef std::map<std::string, std::map<std::string, HostCookies> >
+      HostCookiesCache;
+  HostCookiesCache host_cookies_cache_;
+
+  // The last key visited by GarbageCollectExpiredIncrementally(), or empty to
+  // start from the beginning of |cookies_|.
+  std::string gc_cursor_key_;
+
   // Indicates whether the cookie store has been initialized. This happens
   // lazily in InitStoreIfNecessary().
   bool initialized_;
@@ -276,6 +276,50 @@ TEST_F(CookieMonsterTest, TestDomainLine) {
   timer2.Done();
 }
 
+// Subresource-heavy browsing over a store near the global cookie limit: the
+// same few hosts are queried over and over, mostly without any cookie
+// changing in between.
+TEST_F(CookieMonsterTest, TestQueryLargeStore) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  SetCookieCallback setCookieCallback;
+  GetCookiesCallback getCookiesCallback;
+
+  const int kNumDomains = 100;
+  const int kCookiesPerDomain = 30;
+  std::vector<GURL> gurls;
+  for (int domain_num = 0; domain_num < kNumDomains; domain_num++) {
+    const std::string domain(base::StringPrintf("domain%d.izzle", domain_num));
+    for (int cookie_num = 0; cookie_num < kCookiesPerDomain; cookie_num++) {
+      // Spread the cookies over a few subdomains and paths.
+      GURL gurl(base::StringPrintf("http://www%d.%s/path%d",
+                                   cookie_num % 3, domain.c_str(),
+                                   cookie_num % 5));
+      setCookieCallback.SetCookie(
+          cm.get(), gurl,
+          base::StringPrintf("a%02d=b; domain=%s; path=/path%d", cookie_num,
+                             domain.c_str(), cookie_num % 5));
+    }
+    gurls.push_back(GURL(base::StringPrintf("http://www0.%s/path0/resource",
+                                            domain.c_str())));
+  }
+  std::string cookie_line = getCookiesCallback.GetCookies(cm.get(), gurls[0]);
+  EXPECT_EQ(kCookiesPerDomain / 5, CountInString(cookie_line, '='));
+
+  base::PerfTimeLogger timer("Cookie_monster_query_large_store");
+  for (int i = 0; i < kNumCookies; i++)
+    getCookiesCallback.GetCookies(cm.get(), gurls[i % kNumDomains]);
+  timer.Done();
+
+  // Every query follows a change to the cookies of the queried domain.
+  base::PerfTimeLogger timer2("Cookie_monster_query_large_store_after_set");
+  for (int i = 0; i < kNumCookies; i++) {
+    const GURL& gurl = gurls[i % kNumDomains];
+    setCookieCallback.SetCookie(cm.get(), gurl, "a00=c; path=/path0");
+    getCookiesCallback.GetCookies(cm.get(), gurl);
+  }
+  timer2.Done();
+}
+
 TEST_F(CookieMonsterTest, TestImport) {
   scoped_refptr<MockPersistentCookieStore> store(new MockPersistentCookieStore);
   std::vector<CanonicalCookie*> initial_cookies;
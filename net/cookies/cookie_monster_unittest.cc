@@ -1216,6 +1216,46 @@ TEST_F(CookieMonsterTest, TestLastAccess) {
   EXPECT_FALSE(last_access_date == GetFirstCookieAccessDate(cm.get()));
 }
 
+TEST_F(CookieMonsterTest, HostCookiesCacheInvalidation) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  const std::string key(cm->GetKey(url_google_.host()));
+
+  // Nothing is cached for keys without cookies.
+  EXPECT_EQ("", GetCookies(cm.get(), url_google_));
+  EXPECT_EQ(0u, cm->host_cookies_cache_.count(key));
+
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_, "A=B"));
+  EXPECT_EQ("A=B", GetCookies(cm.get(), url_google_));
+  EXPECT_EQ(1u, cm->host_cookies_cache_[key].size());
+  EXPECT_EQ("A=B", GetCookies(cm.get(), url_google_));
+
+  // Inserting a cookie drops the cached cookies of its key.
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_, "C=D; path=/foo"));
+  EXPECT_EQ(0u, cm->host_cookies_cache_.count(key));
+  EXPECT_EQ("A=B", GetCookies(cm.get(), url_google_));
+
+  // The cached cookies still get matched against the path of each request.
+  EXPECT_EQ("C=D; A=B", GetCookies(cm.get(), url_google_foo_));
+  EXPECT_EQ(1u, cm->host_cookies_cache_[key].size());
+
+  // Secure and httponly requests are cached separately.
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_secure_, "E=F; secure"));
+  EXPECT_EQ("A=B", GetCookies(cm.get(), url_google_));
+  EXPECT_EQ("A=B; E=F", GetCookies(cm.get(), url_google_secure_));
+  EXPECT_EQ(2u, cm->host_cookies_cache_[key].size());
+
+  // So is deleting one.
+  EXPECT_TRUE(FindAndDeleteCookie(cm.get(), url_google_.host(), "A"));
+  EXPECT_EQ(0u, cm->host_cookies_cache_.count(key));
+  EXPECT_EQ("C=D", GetCookies(cm.get(), url_google_foo_));
+  EXPECT_EQ("E=F", GetCookies(cm.get(), url_google_secure_));
+
+  // Overwriting a cookie with an expired one deletes it.
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_secure_,
+                        "E=F; secure; expires=Mon, 18-Apr-1977 22:50:13 GMT"));
+  EXPECT_EQ("", GetCookies(cm.get(), url_google_secure_));
+}
+
 TEST_F(CookieMonsterTest, TestHostGarbageCollection) {
   TestHostGarbageCollectHelper();
 }
@@ -4,6 +4,8 @@
 
 #include "net/disk_cache/backend_impl.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/file_util.h"
@@ -49,6 +51,9 @@ const int kBaseTableLen = 64 * 1024;
 // Avoid trimming the cache for the first 5 minutes (10 timer ticks).
 const int kTrimDelay = 10;
 
+// The number of entries visited by each batch of an EntryRangeWalk.
+const int kWalkBatchSize = 64;
+
 int DesiredIndexTableLen(int32 storage_size) {
   if (storage_size <= k64kEntriesStore)
     return kBaseTableLen;
@@ -107,6 +112,28 @@ void FinalCleanupCallback(disk_cache::BackendImpl* backend) {
 
 namespace disk_cache {
 
+struct EntryRangeWalkCursor {
+  EntryRangeWalkCursor() : iterator(NULL), next(NULL) {}
+
+  void* iterator;  // The enumeration of the rankings.
+  EntryImpl* next;  // The entry the next batch starts with, if any.
+};
+
+EntryRangeWalk::EntryRangeWalk(Time initial_time, Time end_time, bool doom)
+    : initial_time(initial_time),
+      end_time(end_time),
+      doom(doom),
+      cursor(NULL),
+      entries(0),
+      size(0),
+      done(false) {
+}
+
+// The cursor of an unfinished walk belongs to the backend, which releases it
+// on the cache thread when it is cleaned up.
+EntryRangeWalk::~EntryRangeWalk() {
+}
+
 BackendImpl::BackendImpl(const base::FilePath& path,
                          base::MessageLoopProxy* cache_thread,
                          net::NetLog* net_log)
@@ -301,6 +328,10 @@ void BackendImpl::CleanupCache() {
   eviction_.Stop();
   timer_.reset();
 
+  // Walks dropped with the backend still hold an entry and an iterator.
+  while (!walk_cursors_.empty())
+    EndWalk(*walk_cursors_.begin());
+
   if (init_) {
     StoreStats();
     if (data_)
@@ -449,6 +480,71 @@ void BackendImpl::SyncEndEnumeration(void* iter) {
       reinterpret_cast<Rankings::Iterator*>(iter));
 }
 
+// Like SyncDoomEntriesBetween(), this relies on the rankings being ordered by
+// last use, and opens the next entry before dooming the current one.
+int BackendImpl::SyncWalkEntriesBetween(EntryRangeWalk* walk) {
+  DCHECK(!walk->doom || net::APP_CACHE != cache_type_);
+  if (disabled_) {
+    if (walk->cursor)
+      EndWalk(walk->cursor);
+    walk->cursor = NULL;
+    walk->done = true;
+    return net::ERR_FAILED;
+  }
+
+  // The header keeps the totals for the whole cache.
+  if (!walk->doom && walk->initial_time.is_null() &&
+      walk->end_time.is_null()) {
+    walk->entries = data_->header.num_entries;
+    walk->size = data_->header.num_bytes;
+    walk->done = true;
+    return net::OK;
+  }
+
+  EntryRangeWalkCursor* cursor = walk->cursor;
+  if (!cursor) {
+    cursor = new EntryRangeWalkCursor;
+    walk_cursors_.insert(cursor);
+    walk->cursor = cursor;
+  }
+
+  EntryImpl* node =
+      cursor->next ? cursor->next : OpenNextEntryImpl(&cursor->iterator);
+  cursor->next = NULL;
+  for (int i = 0; node && i < kWalkBatchSize; i++) {
+    EntryImpl* next = OpenNextEntryImpl(&cursor->iterator);
+    const Time last_used = node->GetLastUsed();
+    if (last_used < walk->initial_time) {
+      if (next)
+        next->Release();
+      next = NULL;
+      SyncEndEnumeration(cursor->iterator);
+      cursor->iterator = NULL;
+    } else if (walk->end_time.is_null() || last_used < walk->end_time) {
+      walk->entries++;
+      if (walk->doom) {
+        node->DoomImpl();
+      } else {
+        walk->size += node->entry()->Data()->key_len;
+        for (size_t index = 0;
+             index < arraysize(node->entry()->Data()->data_size); index++) {
+          walk->size += node->GetDataSize(index);
+        }
+      }
+    }
+    node->Release();
+    node = next;
+  }
+
+  cursor->next = node;
+  walk->done = !node;
+  if (walk->done) {
+    EndWalk(cursor);
+    walk->cursor = NULL;
+  }
+  return net::OK;
+}
+
 void BackendImpl::SyncOnExternalCacheHit(const std::string& key) {
   if (disabled_)
     return;
@@ -1193,6 +1289,29 @@ int BackendImpl::DoomEntriesSince(const base::Time initial_time,
   return net::ERR_IO_PENDING;
 }
 
+int BackendImpl::DoomEntriesBetweenWithProgress(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  WalkEntriesBetween(
+      make_scoped_ptr(new EntryRangeWalk(initial_time, end_time, true)),
+      progress_callback, callback);
+  return net::ERR_IO_PENDING;
+}
+
+int BackendImpl::CalculateSizeOfEntriesBetween(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  WalkEntriesBetween(
+      make_scoped_ptr(new EntryRangeWalk(initial_time, end_time, false)),
+      ProgressCallback(), callback);
+  return net::ERR_IO_PENDING;
+}
+
 int BackendImpl::OpenNextEntry(void** iter, Entry** next_entry,
                                const CompletionCallback& callback) {
   DCHECK(!callback.is_null());
@@ -1240,6 +1359,47 @@ void BackendImpl::OnExternalCacheHit(const std::string& key) {
 
 // ------------------------------------------------------------------------
 
+void BackendImpl::WalkEntriesBetween(scoped_ptr<EntryRangeWalk> walk,
+                                     const ProgressCallback& progress_callback,
+                                     const CompletionCallback& callback) {
+  // The queue does not run callbacks once the backend is being destroyed.
+  EntryRangeWalk* walk_ptr = walk.get();
+  background_queue_.WalkEntriesBetween(
+      walk_ptr,
+      base::Bind(&BackendImpl::OnWalkEntriesBatchComplete,
+                 base::Unretained(this), base::Passed(&walk),
+                 progress_callback, callback));
+}
+
+void BackendImpl::OnWalkEntriesBatchComplete(
+    scoped_ptr<EntryRangeWalk> walk,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback,
+    int result) {
+  if (result != net::OK) {
+    callback.Run(result);
+    return;
+  }
+  if (walk->doom && !progress_callback.is_null())
+    progress_callback.Run(walk->entries);
+  if (!walk->done) {
+    WalkEntriesBetween(walk.Pass(), progress_callback, callback);
+    return;
+  }
+  if (walk->doom)
+    callback.Run(net::OK);
+  else
+    callback.Run(static_cast<int>(std::min<int64>(walk->size, kint32max)));
+}
+
+void BackendImpl::EndWalk(EntryRangeWalkCursor* cursor) {
+  if (cursor->next)
+    cursor->next->Release();
+  SyncEndEnumeration(cursor->iterator);
+  walk_cursors_.erase(cursor);
+  delete cursor;
+}
+
 // We just created a new file so we're going to write the header and set the
 // file length to include the hash table (zero filled).
 bool BackendImpl::CreateBackingStore(disk_cache::File* file) {
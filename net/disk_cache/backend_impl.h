@@ -7,6 +7,8 @@
 #ifndef NET_DISK_CACHE_BACKEND_IMPL_H_
 #define NET_DISK_CACHE_BACKEND_IMPL_H_
 
+#include <set>
+
 #include "base/containers/hash_tables.h"
 #include "base/files/file_path.h"
 #include "base/timer/timer.h"
@@ -39,6 +41,29 @@ enum BackendFlags {
   kNoBuffering = 1 << 7         // Disable extended IO buffering.
 };
 
+struct EntryRangeWalkCursor;
+
+// The state of a walk through the entries last used in a time range, which
+// BackendImpl::SyncWalkEntriesBetween() does a batch at a time on the cache
+// thread, to doom the entries or to add up their size.
+struct EntryRangeWalk {
+  EntryRangeWalk(base::Time initial_time, base::Time end_time, bool doom);
+  ~EntryRangeWalk();
+
+  const base::Time initial_time;
+  const base::Time end_time;  // Unbounded if null.
+  const bool doom;
+
+  // Where the next batch starts, while the walk is unfinished. Owned by the
+  // backend, so it can be released on the cache thread with the backend even
+  // if the walk is dropped.
+  EntryRangeWalkCursor* cursor;
+
+  int entries;  // The entries found in the range so far.
+  int64 size;  // And their total size.
+  bool done;
+};
+
 // This class implements the Backend interface. An object of this
 // class handles the operations of the cache for a particular profile.
 class NET_EXPORT_PRIVATE BackendImpl : public Backend {
@@ -73,6 +98,7 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   int SyncOpenNextEntry(void** iter, Entry** next_entry);
   int SyncOpenPrevEntry(void** iter, Entry** prev_entry);
   void SyncEndEnumeration(void* iter);
+  int SyncWalkEntriesBetween(EntryRangeWalk* walk);
   void SyncOnExternalCacheHit(const std::string& key);
 
   // Open or create an entry for the given |key| or |iter|.
@@ -271,6 +297,15 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
                                  const CompletionCallback& callback) OVERRIDE;
   virtual int DoomEntriesSince(base::Time initial_time,
                                const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetweenWithProgress(
+      base::Time initial_time,
+      base::Time end_time,
+      const ProgressCallback& progress_callback,
+      const CompletionCallback& callback) OVERRIDE;
+  virtual int CalculateSizeOfEntriesBetween(
+      base::Time initial_time,
+      base::Time end_time,
+      const CompletionCallback& callback) OVERRIDE;
   virtual int OpenNextEntry(void** iter, Entry** next_entry,
                             const CompletionCallback& callback) OVERRIDE;
   virtual void EndEnumeration(void** iter) OVERRIDE;
@@ -280,6 +315,20 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
  private:
   typedef base::hash_map<CacheAddr, EntryImpl*> EntriesMap;
 
+  // Queues the next batch of |walk|, letting other operations run in between.
+  // |progress_callback| may be null.
+  void WalkEntriesBetween(scoped_ptr<EntryRangeWalk> walk,
+                          const ProgressCallback& progress_callback,
+                          const CompletionCallback& callback);
+  void OnWalkEntriesBatchComplete(scoped_ptr<EntryRangeWalk> walk,
+                                  const ProgressCallback& progress_callback,
+                                  const CompletionCallback& callback,
+                                  int result);
+
+  // Releases the entry and the rankings iterator held by |cursor| and deletes
+  // it. Runs on the cache thread.
+  void EndWalk(EntryRangeWalkCursor* cursor);
+
   // Creates a new backing file for the cache index.
   bool CreateBackingStore(disk_cache::File* file);
   bool InitBackingStore(bool* file_created);
@@ -390,6 +439,8 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   scoped_ptr<base::RepeatingTimer<BackendImpl> > timer_;  // Usage timer.
   base::WaitableEvent done_;  // Signals the end of background work.
   scoped_refptr<TraceObject> trace_object_;  // Initializes internal tracing.
+  // Cursors of unfinished walks. Only used on the cache thread.
+  std::set<EntryRangeWalkCursor*> walk_cursors_;
   base::WeakPtrFactory<BackendImpl> ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(BackendImpl);
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/metrics/field_trial.h"
 #include "base/port.h"
@@ -64,6 +65,10 @@ scoped_ptr<disk_cache::BackendImpl> CreateExistingEntryCache(
   return cache.Pass();
 }
 
+void RecordProgress(std::vector<int>* progress, int entries) {
+  progress->push_back(entries);
+}
+
 }  // namespace
 
 // Tests that can run with different types of caches.
@@ -106,6 +111,8 @@ class DiskCacheBackendTest : public DiskCacheTestWithCache {
   void BackendFixEnumerators();
   void BackendDoomRecent();
   void BackendDoomBetween();
+  void BackendDoomBetweenWithProgress();
+  void BackendCalculateSizeBetween();
   void BackendTransaction(const std::string& name, int num_entries, bool load);
   void BackendRecoverInsert();
   void BackendRecoverRemove();
@@ -1643,6 +1650,153 @@ TEST_F(DiskCacheBackendTest, MemoryOnlyDoomBetween) {
   BackendDoomBetween();
 }
 
+void DiskCacheBackendTest::BackendDoomBetweenWithProgress() {
+  InitCache();
+
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry("first", &entry));
+  entry->Close();
+  FlushQueueForTest();
+
+  AddDelay();
+  Time middle_start = Time::Now();
+
+  // Enough entries for several batches.
+  const int kNumMiddleEntries = 300;
+  for (int i = 0; i < kNumMiddleEntries; i++) {
+    ASSERT_EQ(net::OK, CreateEntry(base::StringPrintf("middle %d", i), &entry));
+    entry->Close();
+  }
+  FlushQueueForTest();
+
+  AddDelay();
+  Time middle_end = Time::Now();
+  AddDelay();
+
+  ASSERT_EQ(net::OK, CreateEntry("last", &entry));
+  entry->Close();
+  FlushQueueForTest();
+
+  std::vector<int> progress;
+  EXPECT_EQ(net::OK,
+            DoomEntriesBetweenWithProgress(
+                middle_start, middle_end,
+                base::Bind(&RecordProgress, &progress)));
+  EXPECT_EQ(2, cache_->GetEntryCount());
+  ASSERT_FALSE(progress.empty());
+  for (size_t i = 1; i < progress.size(); i++)
+    EXPECT_LE(progress[i - 1], progress[i]);
+  EXPECT_EQ(kNumMiddleEntries, progress.back());
+
+  ASSERT_EQ(net::OK, OpenEntry("first", &entry));
+  entry->Close();
+  ASSERT_EQ(net::OK, OpenEntry("last", &entry));
+  entry->Close();
+  EXPECT_NE(net::OK, OpenEntry("middle 0", &entry));
+
+  // The progress callback is optional.
+  EXPECT_EQ(net::OK,
+            DoomEntriesBetweenWithProgress(
+                Time(), Time(), disk_cache::Backend::ProgressCallback()));
+  EXPECT_EQ(0, cache_->GetEntryCount());
+}
+
+TEST_F(DiskCacheBackendTest, DoomBetweenWithProgress) {
+  BackendDoomBetweenWithProgress();
+}
+
+TEST_F(DiskCacheBackendTest, NewEvictionDoomBetweenWithProgress) {
+  SetNewEviction();
+  BackendDoomBetweenWithProgress();
+}
+
+TEST_F(DiskCacheBackendTest, MemoryOnlyDoomBetweenWithProgress) {
+  SetMemoryOnlyMode();
+  BackendDoomBetweenWithProgress();
+}
+
+TEST_F(DiskCacheBackendTest, SimpleDoomBetweenWithProgress) {
+  SetSimpleCacheMode();
+  BackendDoomBetweenWithProgress();
+}
+
+// Tests that destroying the backend in the middle of a walk through a time
+// range releases the entry and the iterator the walk holds.
+TEST_F(DiskCacheBackendTest, DestroyDuringWalkBetween) {
+  InitCache();
+
+  const int kNumEntries = 300;
+  disk_cache::Entry* entry;
+  for (int i = 0; i < kNumEntries; i++) {
+    ASSERT_EQ(net::OK, CreateEntry(base::StringPrintf("key %d", i), &entry));
+    entry->Close();
+  }
+  FlushQueueForTest();
+
+  // A bounded range, so the size is not just read from the header.
+  net::TestCompletionCallback cb;
+  int rv = cache_->CalculateSizeOfEntriesBetween(
+      Time(), Time::Now() + base::TimeDelta::FromDays(1), cb.callback());
+  EXPECT_EQ(net::ERR_IO_PENDING, rv);
+  FlushQueueForTest();
+
+  // The remaining batches are dropped with the backend, which checks that no
+  // entry is left open.
+  cache_impl_ = NULL;
+  cache_.reset();
+  EXPECT_FALSE(cb.have_result());
+}
+
+void DiskCacheBackendTest::BackendCalculateSizeBetween() {
+  InitCache();
+  EXPECT_EQ(0, CalculateSizeOfEntriesBetween(Time(), Time()));
+
+  const int kSize1 = 1000;
+  const int kSize2 = 3000;
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(kSize2));
+  CacheTestFillBuffer(buffer->data(), kSize2, false);
+
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry("first", &entry));
+  EXPECT_EQ(kSize1, WriteData(entry, 1, 0, buffer.get(), kSize1, false));
+  entry->Close();
+  FlushQueueForTest();
+
+  AddDelay();
+  Time middle = Time::Now();
+  AddDelay();
+
+  ASSERT_EQ(net::OK, CreateEntry("second", &entry));
+  EXPECT_EQ(kSize2, WriteData(entry, 1, 0, buffer.get(), kSize2, false));
+  entry->Close();
+  FlushQueueForTest();
+
+  // The sizes include the keys and whatever else the backend stores per entry.
+  int first_size = CalculateSizeOfEntriesBetween(Time(), middle);
+  EXPECT_LE(kSize1, first_size);
+  EXPECT_GT(kSize2, first_size);
+  int second_size = CalculateSizeOfEntriesBetween(middle, Time());
+  EXPECT_LE(kSize2, second_size);
+  EXPECT_GT(kSize1 + kSize2, second_size);
+  EXPECT_EQ(first_size + second_size,
+            CalculateSizeOfEntriesBetween(Time(), Time()));
+  EXPECT_EQ(2, cache_->GetEntryCount());
+}
+
+TEST_F(DiskCacheBackendTest, CalculateSizeBetween) {
+  BackendCalculateSizeBetween();
+}
+
+TEST_F(DiskCacheBackendTest, MemoryOnlyCalculateSizeBetween) {
+  SetMemoryOnlyMode();
+  BackendCalculateSizeBetween();
+}
+
+TEST_F(DiskCacheBackendTest, SimpleCalculateSizeBetween) {
+  SetSimpleCacheMode();
+  BackendCalculateSizeBetween();
+}
+
 TEST_F(DiskCacheBackendTest, MemoryOnlyDoomEntriesBetweenSparse) {
   SetMemoryOnlyMode();
   base::Time start, end;
@@ -10,6 +10,7 @@
 #include "net/disk_cache/backend_impl.h"
 #include "net/disk_cache/cache_util.h"
 #include "net/disk_cache/disk_cache.h"
+#include "net/disk_cache/flash/flash_backend_impl.h"
 #include "net/disk_cache/mem_backend_impl.h"
 #include "net/disk_cache/simple/simple_backend_impl.h"
 
@@ -91,6 +92,15 @@ int CacheCreator::Run() {
     return simple_cache->Init(
         base::Bind(&CacheCreator::OnIOComplete, base::Unretained(this)));
   }
+  if (backend_type_ == net::CACHE_BACKEND_FLASH &&
+      (type_ == net::DISK_CACHE || type_ == net::MEDIA_CACHE)) {
+    disk_cache::FlashBackendImpl* flash_cache =
+        new disk_cache::FlashBackendImpl(path_, max_bytes_, type_,
+                                         thread_.get(), net_log_);
+    created_cache_.reset(flash_cache);
+    return flash_cache->Init(
+        base::Bind(&CacheCreator::OnIOComplete, base::Unretained(this)));
+  }
   disk_cache::BackendImpl* new_cache =
       new disk_cache::BackendImpl(path_, thread_.get(), net_log_);
   created_cache_.reset(new_cache);
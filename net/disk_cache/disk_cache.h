@@ -62,6 +62,9 @@ class NET_EXPORT Backend {
  public:
   typedef net::CompletionCallback CompletionCallback;
 
+  // Runs with the number of entries a batched operation has processed so far.
+  typedef base::Callback<void(int)> ProgressCallback;
+
   // If the backend is destroyed when there are operations in progress (any
   // callback that has not been invoked yet), this method cancels said
   // operations so the callbacks are not invoked, possibly leaving the work
@@ -119,6 +122,28 @@ class NET_EXPORT Backend {
   virtual int DoomEntriesSince(base::Time initial_time,
                                const CompletionCallback& callback) = 0;
 
+  // Like DoomEntriesBetween(), but works through the entries in batches so
+  // that clearing a large range does not hold up other operations, and runs
+  // |progress_callback| with the number of entries doomed so far after each
+  // batch. |progress_callback| may be null. Entries used while the operation is
+  // in progress may or may not be doomed.
+  virtual int DoomEntriesBetweenWithProgress(
+      base::Time initial_time,
+      base::Time end_time,
+      const ProgressCallback& progress_callback,
+      const CompletionCallback& callback) = 0;
+
+  // Calculates the space taken by the entries last used in a range, with null
+  // Time values for unbounded ends as in DoomEntriesBetween(). Backends that
+  // keep an index answer from it without opening the entries. The return value
+  // is the size in bytes, clamped to kint32max, or a net error code. If this
+  // method returns ERR_IO_PENDING, the |callback| will be invoked with the
+  // size or the error.
+  virtual int CalculateSizeOfEntriesBetween(
+      base::Time initial_time,
+      base::Time end_time,
+      const CompletionCallback& callback) = 0;
+
   // Enumerates the cache. Initialize |iter| to NULL before calling this method
   // the first time. That will cause the enumeration to start at the head of
   // the cache. For subsequent calls, pass the same |iter| pointer again without
@@ -207,6 +232,21 @@ class NET_EXPORT Entry {
                         const CompletionCallback& callback,
                         bool truncate) = 0;
 
+  // Behaves like ReadData() for stream |index|, and as part of the same
+  // operation reads the start of stream |prefetch_index| into |prefetch_buf|.
+  // This saves a round trip to the cache thread when the caller is going to
+  // read both streams, like the headers and the body of a small resource. The
+  // return value is that of the read from |index|, unless the prefetch fails,
+  // in which case the whole operation fails. On success |prefetch_buf| holds
+  // the first min(|prefetch_buf_len|, GetDataSize(|prefetch_index|)) bytes of
+  // the stream. A reference to both buffers is retained until the callback is
+  // called.
+  virtual int ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                   int buf_len, int prefetch_index,
+                                   IOBuffer* prefetch_buf,
+                                   int prefetch_buf_len,
+                                   const CompletionCallback& callback) = 0;
+
   // Sparse entries support:
   //
   // A Backend implementation can support sparse entries, so the cache keeps
@@ -7,8 +7,13 @@
 #include "base/basictypes.h"
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/file_util.h"
+#include "base/files/file_enumerator.h"
 #include "base/hash.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/run_loop.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/test/perf_time_logger.h"
 #include "base/test/test_file_util.h"
 #include "base/threading/thread.h"
@@ -22,6 +27,9 @@
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/disk_cache_test_base.h"
 #include "net/disk_cache/disk_cache_test_util.h"
+#include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -38,9 +46,10 @@ typedef std::vector<TestEntry> TestEntries;
 const int kMaxSize = 16 * 1024 - 1;
 
 // Creates num_entries on the cache, and writes 200 bytes of metadata and up
-// to kMaxSize of data to each entry.
-bool TimeWrite(int num_entries, disk_cache::Backend* cache,
-              TestEntries* entries) {
+// to kMaxSize of data to each entry.  |name| identifies the backend in the
+// results.
+bool TimeWrite(const char* name, int num_entries, disk_cache::Backend* cache,
+               TestEntries* entries) {
   const int kSize1 = 200;
   scoped_refptr<net::IOBuffer> buffer1(new net::IOBuffer(kSize1));
   scoped_refptr<net::IOBuffer> buffer2(new net::IOBuffer(kMaxSize));
@@ -53,7 +62,8 @@ bool TimeWrite(int num_entries, disk_cache::Backend* cache,
   MessageLoopHelper helper;
   CallbackTest callback(&helper, true);
 
-  base::PerfTimeLogger timer("Write disk cache entries");
+  base::PerfTimeLogger timer(
+      base::StringPrintf("Write %s entries", name).c_str());
 
   for (int i = 0; i < num_entries; i++) {
     TestEntry entry;
@@ -91,8 +101,8 @@ bool TimeWrite(int num_entries, disk_cache::Backend* cache,
 }
 
 // Reads the data and metadata from each entry listed on |entries|.
-bool TimeRead(int num_entries, disk_cache::Backend* cache,
-             const TestEntries& entries, bool cold) {
+bool TimeRead(const char* name, int num_entries, disk_cache::Backend* cache,
+              const TestEntries& entries, bool cold) {
   const int kSize1 = 200;
   scoped_refptr<net::IOBuffer> buffer1(new net::IOBuffer(kSize1));
   scoped_refptr<net::IOBuffer> buffer2(new net::IOBuffer(kMaxSize));
@@ -105,9 +115,8 @@ bool TimeRead(int num_entries, disk_cache::Backend* cache,
   MessageLoopHelper helper;
   CallbackTest callback(&helper, true);
 
-  const char* message = cold ? "Read disk cache entries (cold)" :
-                        "Read disk cache entries (warm)";
-  base::PerfTimeLogger timer(message);
+  base::PerfTimeLogger timer(base::StringPrintf(
+      "Read %s entries (%s)", name, cold ? "cold" : "warm").c_str());
 
   for (int i = 0; i < num_entries; i++) {
     disk_cache::Entry* cache_entry;
@@ -139,35 +148,18 @@ bool TimeRead(int num_entries, disk_cache::Backend* cache,
   return (expected == helper.callbacks_called());
 }
 
-int BlockSize() {
-  // We can use form 1 to 4 blocks.
-  return (rand() & 0x3) + 1;
-}
-
-}  // namespace
-
-TEST_F(DiskCacheTest, Hash) {
-  int seed = static_cast<int>(Time::Now().ToInternalValue());
-  srand(seed);
-
-  base::PerfTimeLogger timer("Hash disk cache keys");
-  for (int i = 0; i < 300000; i++) {
-    std::string key = GenerateKey(true);
-    base::Hash(key);
-  }
-  timer.Done();
-}
-
-TEST_F(DiskCacheTest, CacheBackendPerformance) {
+// Writes entries to a backend of type |backend_type|, then reopens it with
+// its files evicted from the system cache and reads them back twice.
+void TimeBackend(const char* name, net::BackendType backend_type,
+                 const base::FilePath& cache_path) {
   base::Thread cache_thread("CacheThread");
   ASSERT_TRUE(cache_thread.StartWithOptions(
                   base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
 
-  ASSERT_TRUE(CleanupCacheDir());
   net::TestCompletionCallback cb;
   scoped_ptr<disk_cache::Backend> cache;
   int rv = disk_cache::CreateCacheBackend(
-      net::DISK_CACHE, net::CACHE_BACKEND_BLOCKFILE, cache_path_, 0, false,
+      net::DISK_CACHE, backend_type, cache_path, 0, false,
       cache_thread.message_loop_proxy().get(), NULL, &cache, cb.callback());
 
   ASSERT_EQ(net::OK, cb.GetResult(rv));
@@ -178,32 +170,66 @@ TEST_F(DiskCacheTest, CacheBackendPerformance) {
   TestEntries entries;
   int num_entries = 1000;
 
-  EXPECT_TRUE(TimeWrite(num_entries, cache.get(), &entries));
+  EXPECT_TRUE(TimeWrite(name, num_entries, cache.get(), &entries));
 
   base::MessageLoop::current()->RunUntilIdle();
   cache.reset();
 
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("index")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_0")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_1")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_2")));
-  ASSERT_TRUE(file_util::EvictFileFromSystemCache(
-              cache_path_.AppendASCII("data_3")));
+  base::FileEnumerator enumerator(cache_path, false,
+                                  base::FileEnumerator::FILES);
+  for (base::FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    ASSERT_TRUE(file_util::EvictFileFromSystemCache(file));
+  }
 
   rv = disk_cache::CreateCacheBackend(
-      net::DISK_CACHE, net::CACHE_BACKEND_BLOCKFILE, cache_path_, 0, false,
+      net::DISK_CACHE, backend_type, cache_path, 0, false,
       cache_thread.message_loop_proxy().get(), NULL, &cache, cb.callback());
   ASSERT_EQ(net::OK, cb.GetResult(rv));
 
-  EXPECT_TRUE(TimeRead(num_entries, cache.get(), entries, true));
+  EXPECT_TRUE(TimeRead(name, num_entries, cache.get(), entries, true));
 
-  EXPECT_TRUE(TimeRead(num_entries, cache.get(), entries, false));
+  EXPECT_TRUE(TimeRead(name, num_entries, cache.get(), entries, false));
 
   base::MessageLoop::current()->RunUntilIdle();
+  cache.reset();
+  base::MessageLoop::current()->RunUntilIdle();
+}
+
+int BlockSize() {
+  // We can use form 1 to 4 blocks.
+  return (rand() & 0x3) + 1;
+}
+
+}  // namespace
+
+TEST_F(DiskCacheTest, Hash) {
+  int seed = static_cast<int>(Time::Now().ToInternalValue());
+  srand(seed);
+
+  base::PerfTimeLogger timer("Hash disk cache keys");
+  for (int i = 0; i < 300000; i++) {
+    std::string key = GenerateKey(true);
+    base::Hash(key);
+  }
+  timer.Done();
+}
+
+TEST_F(DiskCacheTest, CacheBackendPerformance) {
+  ASSERT_TRUE(CleanupCacheDir());
+  TimeBackend("blockfile cache", net::CACHE_BACKEND_BLOCKFILE, cache_path_);
+}
+
+TEST_F(DiskCacheTest, SimpleCacheBackendPerformance) {
+  ASSERT_TRUE(CleanupCacheDir());
+  TimeBackend("simple cache", net::CACHE_BACKEND_SIMPLE, cache_path_);
+}
+
+// The flash cache keeps every entry in one preallocated file, which avoids the
+// file system overhead of the other backends.
+TEST_F(DiskCacheTest, FlashCacheBackendPerformance) {
+  ASSERT_TRUE(CleanupCacheDir());
+  TimeBackend("flash cache", net::CACHE_BACKEND_FLASH, cache_path_);
 }
 
 // Creating and deleting "entries" on a block-file is something quite frequent
@@ -248,3 +274,40 @@ TEST_F(DiskCacheTest, BlockFilesPerformance) {
   base::MessageLoop::current()->RunUntilIdle();
   delete[] address;
 }
+
+// Measures how long the simple cache takes to rebuild its index from the cache
+// directory, as it does on startup when the index file is missing or stale.
+TEST_F(DiskCacheTest, SimpleCacheIndexRestorePerformance) {
+  const int kEntryCounts[] = { 1000, 10000, 50000 };
+  const std::string kData(100, 'x');
+
+  for (size_t i = 0; i < arraysize(kEntryCounts); ++i) {
+    const int num_entries = kEntryCounts[i];
+    ASSERT_TRUE(CleanupCacheDir());
+    for (int j = 0; j < num_entries; ++j) {
+      const base::FilePath entry_path = cache_path_.AppendASCII(
+          disk_cache::simple_util::GetFilenameFromKeyAndFileIndex(
+              GenerateKey(true), 0));
+      ASSERT_EQ(static_cast<int>(kData.size()),
+                file_util::WriteFile(entry_path, kData.data(),
+                                     static_cast<int>(kData.size())));
+      ASSERT_TRUE(file_util::EvictFileFromSystemCache(entry_path));
+    }
+
+    disk_cache::SimpleIndexFile index_file(
+        base::MessageLoopProxy::current().get(),
+        base::MessageLoopProxy::current().get(),
+        net::DISK_CACHE,
+        cache_path_);
+    disk_cache::SimpleIndexLoadResult result;
+    base::PerfTimeLogger timer(base::StringPrintf(
+        "Restore simple cache index of %d entries", num_entries).c_str());
+    index_file.LoadIndexEntries(base::Time(), base::Bind(&base::DoNothing),
+                                &result);
+    base::RunLoop().RunUntilIdle();
+    timer.Done();
+
+    EXPECT_TRUE(result.did_load);
+    EXPECT_EQ(static_cast<size_t>(num_entries), result.entries.size());
+  }
+}
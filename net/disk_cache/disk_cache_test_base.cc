@@ -151,6 +151,25 @@ int DiskCacheTestWithCache::DoomEntriesSince(const base::Time initial_time) {
   return cb.GetResult(rv);
 }
 
+int DiskCacheTestWithCache::DoomEntriesBetweenWithProgress(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const base::Callback<void(int)>& progress_callback) {
+  net::TestCompletionCallback cb;
+  int rv = cache_->DoomEntriesBetweenWithProgress(
+      initial_time, end_time, progress_callback, cb.callback());
+  return cb.GetResult(rv);
+}
+
+int DiskCacheTestWithCache::CalculateSizeOfEntriesBetween(
+    const base::Time initial_time,
+    const base::Time end_time) {
+  net::TestCompletionCallback cb;
+  int rv = cache_->CalculateSizeOfEntriesBetween(initial_time, end_time,
+                                                 cb.callback());
+  return cb.GetResult(rv);
+}
+
 int DiskCacheTestWithCache::OpenNextEntry(void** iter,
                                           disk_cache::Entry** next_entry) {
   net::TestCompletionCallback cb;
@@ -6,6 +6,7 @@
 #define NET_DISK_CACHE_DISK_CACHE_TEST_BASE_H_
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/files/file_path.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/memory/scoped_ptr.h"
@@ -117,6 +118,12 @@ class DiskCacheTestWithCache : public DiskCacheTest {
   int DoomEntriesBetween(const base::Time initial_time,
                          const base::Time end_time);
   int DoomEntriesSince(const base::Time initial_time);
+  int DoomEntriesBetweenWithProgress(
+      const base::Time initial_time,
+      const base::Time end_time,
+      const base::Callback<void(int)>& progress_callback);
+  int CalculateSizeOfEntriesBetween(const base::Time initial_time,
+                                    const base::Time end_time);
   int OpenNextEntry(void** iter, disk_cache::Entry** next_entry);
   void FlushQueueForTest();
   void RunTaskForTest(const base::Closure& closure);
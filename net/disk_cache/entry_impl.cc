@@ -331,6 +331,21 @@ int EntryImpl::ReadDataImpl(int index, int offset, IOBuffer* buf, int buf_len,
   return result;
 }
 
+int EntryImpl::ReadDataWithPrefetchImpl(int index, int offset, IOBuffer* buf,
+                                        int buf_len, int prefetch_index,
+                                        IOBuffer* prefetch_buf,
+                                        int prefetch_buf_len,
+                                        const CompletionCallback& callback) {
+  // This runs on the cache thread, so the prefetch is a synchronous read ahead
+  // of the regular one.
+  int expected = std::min(prefetch_buf_len, GetDataSize(prefetch_index));
+  int result = ReadDataImpl(prefetch_index, 0, prefetch_buf, prefetch_buf_len,
+                            CompletionCallback());
+  if (result != expected)
+    return result < 0 ? result : net::ERR_CACHE_READ_FAILURE;
+  return ReadDataImpl(index, offset, buf, buf_len, callback);
+}
+
 int EntryImpl::WriteDataImpl(int index, int offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback,
                              bool truncate) {
@@ -852,6 +867,35 @@ int EntryImpl::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
   return net::ERR_IO_PENDING;
 }
 
+int EntryImpl::ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                    int buf_len, int prefetch_index,
+                                    IOBuffer* prefetch_buf,
+                                    int prefetch_buf_len,
+                                    const CompletionCallback& callback) {
+  if (callback.is_null()) {
+    return ReadDataWithPrefetchImpl(index, offset, buf, buf_len,
+                                    prefetch_index, prefetch_buf,
+                                    prefetch_buf_len, callback);
+  }
+
+  DCHECK(node_.Data()->dirty || read_only_);
+  if (index < 0 || index >= kNumStreams || prefetch_index < 0 ||
+      prefetch_index >= kNumStreams) {
+    return net::ERR_INVALID_ARGUMENT;
+  }
+
+  if (buf_len < 0 || prefetch_buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+
+  if (!background_queue_.get())
+    return net::ERR_UNEXPECTED;
+
+  background_queue_->ReadDataWithPrefetch(this, index, offset, buf, buf_len,
+                                          prefetch_index, prefetch_buf,
+                                          prefetch_buf_len, callback);
+  return net::ERR_IO_PENDING;
+}
+
 int EntryImpl::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                               const CompletionCallback& callback) {
   if (callback.is_null())
@@ -44,6 +44,10 @@ class NET_EXPORT_PRIVATE EntryImpl
   void DoomImpl();
   int ReadDataImpl(int index, int offset, IOBuffer* buf, int buf_len,
                    const CompletionCallback& callback);
+  int ReadDataWithPrefetchImpl(int index, int offset, IOBuffer* buf,
+                               int buf_len, int prefetch_index,
+                               IOBuffer* prefetch_buf, int prefetch_buf_len,
+                               const CompletionCallback& callback);
   int WriteDataImpl(int index, int offset, IOBuffer* buf, int buf_len,
                     const CompletionCallback& callback, bool truncate);
   int ReadSparseDataImpl(int64 offset, IOBuffer* buf, int buf_len,
@@ -158,6 +162,11 @@ class NET_EXPORT_PRIVATE EntryImpl
   virtual int WriteData(int index, int offset, IOBuffer* buf, int buf_len,
                         const CompletionCallback& callback,
                         bool truncate) OVERRIDE;
+  virtual int ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                   int buf_len, int prefetch_index,
+                                   IOBuffer* prefetch_buf,
+                                   int prefetch_buf_len,
+                                   const CompletionCallback& callback) OVERRIDE;
   virtual int ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback) OVERRIDE;
   virtual int WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
@@ -19,8 +19,10 @@
 #include "net/disk_cache/disk_cache_test_util.h"
 #include "net/disk_cache/entry_impl.h"
 #include "net/disk_cache/mem_entry_impl.h"
+#include "net/disk_cache/simple/simple_backend_impl.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_entry_impl.h"
+#include "net/disk_cache/simple/simple_shard_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_test_util.h"
 #include "net/disk_cache/simple/simple_util.h"
@@ -42,6 +44,7 @@ class DiskCacheEntryTest : public DiskCacheTestWithCache {
   void ExternalAsyncIO();
   void ReleaseBuffer(int stream_index);
   void StreamAccess();
+  void ReadWithPrefetch();
   void GetKey();
   void GetTimes(int stream_index);
   void GrowData(int stream_index);
@@ -704,6 +707,71 @@ TEST_F(DiskCacheEntryTest, MemoryOnlyStreamAccess) {
   StreamAccess();
 }
 
+void DiskCacheEntryTest::ReadWithPrefetch() {
+  disk_cache::Entry* entry = NULL;
+  ASSERT_EQ(net::OK, CreateEntry("the first key", &entry));
+
+  const int kSize0 = 200;
+  const int kSize1 = 5000;
+  scoped_refptr<net::IOBuffer> buffer0(new net::IOBuffer(kSize0));
+  scoped_refptr<net::IOBuffer> buffer1(new net::IOBuffer(kSize1));
+  CacheTestFillBuffer(buffer0->data(), kSize0, false);
+  CacheTestFillBuffer(buffer1->data(), kSize1, false);
+  EXPECT_EQ(kSize0, WriteData(entry, 0, 0, buffer0.get(), kSize0, false));
+  EXPECT_EQ(kSize1, WriteData(entry, 1, 0, buffer1.get(), kSize1, false));
+  entry->Close();
+
+  ASSERT_EQ(net::OK, OpenEntry("the first key", &entry));
+  scoped_refptr<net::IOBuffer> read0(new net::IOBuffer(kSize0));
+  scoped_refptr<net::IOBuffer> read1(new net::IOBuffer(kSize1));
+
+  // The prefetch takes as much of the stream as fits in its buffer.
+  const int kPrefetchSize = 1000;
+  net::TestCompletionCallback cb;
+  int rv = entry->ReadDataWithPrefetch(0, 0, read0.get(), kSize0, 1,
+                                       read1.get(), kPrefetchSize,
+                                       cb.callback());
+  EXPECT_EQ(kSize0, cb.GetResult(rv));
+  EXPECT_EQ(0, memcmp(buffer0->data(), read0->data(), kSize0));
+  EXPECT_EQ(0, memcmp(buffer1->data(), read1->data(), kPrefetchSize));
+
+  // A buffer larger than the stream takes all of it.
+  memset(read1->data(), 0, kSize1);
+  rv = entry->ReadDataWithPrefetch(0, 100, read0.get(), kSize0, 1, read1.get(),
+                                   kSize1, cb.callback());
+  EXPECT_EQ(kSize0 - 100, cb.GetResult(rv));
+  EXPECT_EQ(0, memcmp(buffer0->data() + 100, read0->data(), kSize0 - 100));
+  EXPECT_EQ(0, memcmp(buffer1->data(), read1->data(), kSize1));
+
+  // Prefetching an empty stream reads nothing.
+  rv = entry->ReadDataWithPrefetch(1, 0, read1.get(), kSize1, 2, read0.get(),
+                                   kSize0, cb.callback());
+  EXPECT_EQ(kSize1, cb.GetResult(rv));
+
+  EXPECT_EQ(net::ERR_INVALID_ARGUMENT,
+            cb.GetResult(entry->ReadDataWithPrefetch(
+                0, 0, read0.get(), kSize0, 3, read1.get(), kSize1,
+                cb.callback())));
+  entry->Close();
+}
+
+TEST_F(DiskCacheEntryTest, ReadWithPrefetch) {
+  InitCache();
+  ReadWithPrefetch();
+}
+
+TEST_F(DiskCacheEntryTest, MemoryOnlyReadWithPrefetch) {
+  SetMemoryOnlyMode();
+  InitCache();
+  ReadWithPrefetch();
+}
+
+TEST_F(DiskCacheEntryTest, SimpleCacheReadWithPrefetch) {
+  SetSimpleCacheMode();
+  InitCache();
+  ReadWithPrefetch();
+}
+
 void DiskCacheEntryTest::GetKey() {
   std::string key("the first key");
   disk_cache::Entry* entry;
@@ -3235,6 +3303,13 @@ TEST_F(DiskCacheEntryTest, SimpleCacheEvictOldEntries) {
 
   std::string key2("the key prefix");
   for (int i = 0; i < kNumExtraEntries; i++) {
+    if (i == kNumExtraEntries - 2) {
+      // Create a distinct timestamp for the last two entries. These entries
+      // will be checked for outliving the eviction. Entries with the same
+      // last used time are evicted in the index's iteration order, which is
+      // unspecified, so without the delay any of them could go first.
+      AddDelay();
+    }
     ASSERT_EQ(net::OK, CreateEntry(key2 + base::StringPrintf("%d", i), &entry));
     ScopedEntryPtr entry_closer(entry);
     EXPECT_EQ(kWriteSize,
@@ -3972,4 +4047,51 @@ TEST_F(DiskCacheEntryTest, SimpleCacheTruncateLargeSparseFile) {
   entry->Close();
 }
 
+// Checks that small entries are packed into the shard files, and get files of
+// their own once they grow.
+TEST_F(DiskCacheEntryTest, SimpleCachePackSmallEntries) {
+  SetSimpleCacheMode();
+  disk_cache::SimpleBackendImpl::SetPackSmallEntriesForTesting(true);
+  InitCache();
+  disk_cache::SimpleBackendImpl::SetPackSmallEntriesForTesting(false);
+
+  const int kSmallSize = 100;
+  const int kLargeSize =
+      disk_cache::SimpleShardStore::kMaxPackedFileSize + 1;
+  const char key[] = "key";
+  const base::FilePath file_0_path = cache_path_.AppendASCII(
+      disk_cache::simple_util::GetFilenameFromKeyAndFileIndex(key, 0));
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(kLargeSize));
+  CacheTestFillBuffer(buffer->data(), kLargeSize, false);
+  scoped_refptr<net::IOBuffer> read_buffer(new net::IOBuffer(kLargeSize));
+
+  disk_cache::Entry* entry;
+  ASSERT_EQ(net::OK, CreateEntry(key, &entry));
+  EXPECT_EQ(kSmallSize, WriteData(entry, 1, 0, buffer, kSmallSize, true));
+  entry->Close();
+  disk_cache::SimpleBackendImpl::FlushWorkerPoolForTesting();
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_FALSE(base::PathExists(file_0_path));
+
+  ASSERT_EQ(net::OK, OpenEntry(key, &entry));
+  EXPECT_EQ(kSmallSize, ReadData(entry, 1, 0, read_buffer, kSmallSize));
+  EXPECT_EQ(0, memcmp(buffer->data(), read_buffer->data(), kSmallSize));
+  EXPECT_EQ(kLargeSize, WriteData(entry, 1, 0, buffer, kLargeSize, true));
+  entry->Close();
+  disk_cache::SimpleBackendImpl::FlushWorkerPoolForTesting();
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_TRUE(base::PathExists(file_0_path));
+
+  ASSERT_EQ(net::OK, OpenEntry(key, &entry));
+  EXPECT_EQ(kLargeSize, ReadData(entry, 1, 0, read_buffer, kLargeSize));
+  EXPECT_EQ(0, memcmp(buffer->data(), read_buffer->data(), kLargeSize));
+  entry->Close();
+  disk_cache::SimpleBackendImpl::FlushWorkerPoolForTesting();
+  base::MessageLoop::current()->RunUntilIdle();
+
+  SyncDoomEntry(key);
+  EXPECT_FALSE(base::PathExists(file_0_path));
+  EXPECT_NE(net::OK, OpenEntry(key, &entry));
+}
+
 #endif  // defined(OS_POSIX)
@@ -0,0 +1,469 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/flash/flash_backend_impl.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/location.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/task_runner_util.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/cache_util.h"
+#include "net/disk_cache/flash/flash_entry_impl.h"
+#include "net/disk_cache/flash/format.h"
+#include "net/disk_cache/flash/internal_entry.h"
+#include "net/disk_cache/flash/log_store.h"
+
+using base::Time;
+
+namespace disk_cache {
+
+namespace {
+
+// The log needs a few segments to rotate through.
+const int32 kMinSegmentCount = 4;
+
+int32 GetStorageSize(int max_bytes) {
+  if (max_bytes <= 0)
+    max_bytes = kDefaultCacheSize;
+  int32 segment_count = std::max(kMinSegmentCount,
+                                 max_bytes / kFlashSegmentSize);
+  return segment_count * kFlashSegmentSize;
+}
+
+// The functions below run on the cache thread.
+
+int InitStore(const base::FilePath& path, LogStore* store) {
+  if (!base::PathExists(path) && !base::CreateDirectory(path)) {
+    LOG(ERROR) << "Failed to create directory: " << path.LossyDisplayName();
+    return net::ERR_FAILED;
+  }
+  return store->Init() ? net::OK : net::ERR_FAILED;
+}
+
+void CloseStore(scoped_ptr<LogStore> store, bool initialized) {
+  if (initialized && !store->Close())
+    LOG(WARNING) << "Failed to close the flash cache store";
+}
+
+// Opens the entry |id|, checking that it has the key |key| unless |key| is
+// empty.
+scoped_ptr<KeyAndStreamSizes> OpenEntryWithId(
+    LogStore* store,
+    int32 id,
+    const std::string& key,
+    scoped_refptr<InternalEntry>* internal_entry) {
+  scoped_refptr<InternalEntry> entry = new InternalEntry(id, store);
+  scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes = entry->Init();
+  if (!key_and_stream_sizes)
+    return scoped_ptr<KeyAndStreamSizes>();
+  if (!key.empty() && key_and_stream_sizes->key != key) {
+    entry->Close();
+    return scoped_ptr<KeyAndStreamSizes>();
+  }
+  *internal_entry = entry;
+  return key_and_stream_sizes.Pass();
+}
+
+scoped_ptr<KeyAndStreamSizes> OpenEntryWithKey(
+    LogStore* store,
+    const std::string& key,
+    scoped_refptr<InternalEntry>* internal_entry) {
+  int32 id;
+  if (!store->FindEntry(InternalEntry::HashKey(key), &id))
+    return scoped_ptr<KeyAndStreamSizes>();
+  return OpenEntryWithId(store, id, key, internal_entry);
+}
+
+int DoomStoredEntry(LogStore* store, uint64 key_hash) {
+  int32 id;
+  if (store->FindEntry(key_hash, &id))
+    store->DeleteEntry(id);
+  return net::OK;
+}
+
+int DoomAllStoredEntries(LogStore* store) {
+  return store->DeleteAllEntries() ? net::OK : net::ERR_FAILED;
+}
+
+bool InRange(const LogStore::EntryInfo& entry, Time initial_time,
+             Time end_time) {
+  return entry.last_modified >= initial_time &&
+         (end_time.is_null() || entry.last_modified < end_time);
+}
+
+// Returns the number of entries doomed.
+int DoomStoredEntriesBetween(LogStore* store, Time initial_time,
+                             Time end_time) {
+  std::vector<LogStore::EntryInfo> entries;
+  store->GetEntries(&entries);
+  int doomed_entries = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (InRange(entries[i], initial_time, end_time)) {
+      store->DeleteEntry(entries[i].id);
+      ++doomed_entries;
+    }
+  }
+  return doomed_entries;
+}
+
+int CalculateStoredSizeBetween(LogStore* store, Time initial_time,
+                               Time end_time) {
+  std::vector<LogStore::EntryInfo> entries;
+  store->GetEntries(&entries);
+  int64 size = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (InRange(entries[i], initial_time, end_time))
+      size += entries[i].size;
+  }
+  return static_cast<int>(std::min<int64>(size, kint32max));
+}
+
+void GetStoredEntryIds(LogStore* store, std::vector<int32>* entry_ids) {
+  std::vector<LogStore::EntryInfo> entries;
+  store->GetEntries(&entries);
+  entry_ids->reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i)
+    entry_ids->push_back(entries[i].id);
+  std::sort(entry_ids->begin(), entry_ids->end());
+}
+
+}  // namespace
+
+const char FlashBackendImpl::kStoreFileName[] = "flash_store";
+
+FlashBackendImpl::Iterator::Iterator() : position(0) {
+}
+
+FlashBackendImpl::Iterator::~Iterator() {
+}
+
+FlashBackendImpl::FlashBackendImpl(const base::FilePath& path,
+                                   int max_bytes,
+                                   net::CacheType cache_type,
+                                   base::MessageLoopProxy* cache_thread,
+                                   net::NetLog* net_log)
+    : path_(path),
+      cache_type_(cache_type),
+      storage_size_(GetStorageSize(max_bytes)),
+      cache_thread_(cache_thread),
+      store_(new LogStore(path.AppendASCII(kStoreFileName), storage_size_)),
+      store_initialized_(false) {
+}
+
+FlashBackendImpl::~FlashBackendImpl() {
+  cache_thread_->PostTask(FROM_HERE,
+                          base::Bind(&CloseStore, base::Passed(&store_),
+                                     store_initialized_));
+}
+
+int FlashBackendImpl::Init(const CompletionCallback& completion_callback) {
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&InitStore, path_, store_.get()),
+      base::Bind(&FlashBackendImpl::OnInitComplete, AsWeakPtr(),
+                 completion_callback));
+  return net::ERR_IO_PENDING;
+}
+
+void FlashBackendImpl::OnEntryDoomed(FlashEntryImpl* entry) {
+  EntryMap::iterator it = active_entries_.find(entry->key_hash());
+  if (it != active_entries_.end() && it->second == entry)
+    active_entries_.erase(it);
+  cache_thread_->PostTask(FROM_HERE,
+                          base::Bind(base::IgnoreResult(&DoomStoredEntry),
+                                     store_.get(), entry->key_hash()));
+}
+
+void FlashBackendImpl::OnEntryClosed(FlashEntryImpl* entry) {
+  EntryMap::iterator it = active_entries_.find(entry->key_hash());
+  if (it != active_entries_.end() && it->second == entry)
+    active_entries_.erase(it);
+}
+
+net::CacheType FlashBackendImpl::GetCacheType() const {
+  return cache_type_;
+}
+
+int32 FlashBackendImpl::GetEntryCount() const {
+  // New entries are counted once they are saved.
+  return store_->GetEntryCount();
+}
+
+int FlashBackendImpl::OpenEntry(const std::string& key, Entry** entry,
+                                const CompletionCallback& callback) {
+  EntryMap::iterator it = active_entries_.find(InternalEntry::HashKey(key));
+  if (it != active_entries_.end()) {
+    if (it->second->GetKey() != key)
+      return net::ERR_FAILED;
+    it->second->AddRef();
+    *entry = it->second;
+    return net::OK;
+  }
+
+  scoped_refptr<InternalEntry>* internal_entry =
+      new scoped_refptr<InternalEntry>;
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&OpenEntryWithKey, store_.get(), key, internal_entry),
+      base::Bind(&FlashBackendImpl::OnOpenEntryComplete, AsWeakPtr(), entry,
+                 callback, base::Owned(internal_entry)));
+  return net::ERR_IO_PENDING;
+}
+
+int FlashBackendImpl::CreateEntry(const std::string& key, Entry** entry,
+                                  const CompletionCallback& callback) {
+  const uint64 key_hash = InternalEntry::HashKey(key);
+  if (active_entries_.find(key_hash) != active_entries_.end())
+    return net::ERR_FAILED;
+
+  FlashEntryImpl* new_entry = new FlashEntryImpl(AsWeakPtr(), key,
+                                                 store_.get(),
+                                                 cache_thread_.get());
+  new_entry->AddRef();
+  active_entries_[key_hash] = new_entry;
+  *entry = new_entry;
+  return net::OK;
+}
+
+int FlashBackendImpl::DoomEntry(const std::string& key,
+                                const CompletionCallback& callback) {
+  const uint64 key_hash = InternalEntry::HashKey(key);
+  EntryMap::iterator it = active_entries_.find(key_hash);
+  if (it != active_entries_.end())
+    it->second->Doom();
+
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&DoomStoredEntry, store_.get(), key_hash),
+      base::Bind(&FlashBackendImpl::OnOperationComplete, AsWeakPtr(),
+                 callback));
+  return net::ERR_IO_PENDING;
+}
+
+int FlashBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
+  DoomActiveEntriesBetween(Time(), Time());
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&DoomAllStoredEntries, store_.get()),
+      base::Bind(&FlashBackendImpl::OnOperationComplete, AsWeakPtr(),
+                 callback));
+  return net::ERR_IO_PENDING;
+}
+
+int FlashBackendImpl::DoomEntriesBetween(Time initial_time,
+                                         Time end_time,
+                                         const CompletionCallback& callback) {
+  return DoomEntriesBetweenWithProgress(initial_time, end_time,
+                                        ProgressCallback(), callback);
+}
+
+int FlashBackendImpl::DoomEntriesSince(Time initial_time,
+                                       const CompletionCallback& callback) {
+  return DoomEntriesBetween(initial_time, Time(), callback);
+}
+
+int FlashBackendImpl::DoomEntriesBetweenWithProgress(
+    Time initial_time,
+    Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback) {
+  // Dooming a stored entry only updates the index of the store, so they are
+  // all doomed in a single batch.
+  DoomActiveEntriesBetween(initial_time, end_time);
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&DoomStoredEntriesBetween, store_.get(), initial_time,
+                 end_time),
+      base::Bind(&FlashBackendImpl::OnDoomEntriesComplete, AsWeakPtr(),
+                 progress_callback, callback));
+  return net::ERR_IO_PENDING;
+}
+
+int FlashBackendImpl::CalculateSizeOfEntriesBetween(
+    Time initial_time,
+    Time end_time,
+    const CompletionCallback& callback) {
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&CalculateStoredSizeBetween, store_.get(), initial_time,
+                 end_time),
+      base::Bind(&FlashBackendImpl::OnOperationComplete, AsWeakPtr(),
+                 callback));
+  return net::ERR_IO_PENDING;
+}
+
+int FlashBackendImpl::OpenNextEntry(void** iter, Entry** next_entry,
+                                    const CompletionCallback& callback) {
+  if (*iter) {
+    OpenNextEntryInIterator(static_cast<Iterator*>(*iter), next_entry,
+                            callback);
+    return net::ERR_IO_PENDING;
+  }
+
+  Iterator* iterator = new Iterator;
+  *iter = iterator;
+  cache_thread_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&GetStoredEntryIds, store_.get(), &iterator->entry_ids),
+      base::Bind(&FlashBackendImpl::OpenNextEntryInIterator, AsWeakPtr(),
+                 iterator, next_entry, callback));
+  return net::ERR_IO_PENDING;
+}
+
+void FlashBackendImpl::EndEnumeration(void** iter) {
+  delete static_cast<Iterator*>(*iter);
+  *iter = NULL;
+}
+
+void FlashBackendImpl::GetStats(
+    std::vector<std::pair<std::string, std::string> >* stats) {
+  std::pair<std::string, std::string> item;
+  item.first = "Cache type";
+  item.second = "Flash Cache";
+  stats->push_back(item);
+
+  item.first = "Entries";
+  item.second = base::IntToString(GetEntryCount());
+  stats->push_back(item);
+
+  item.first = "Storage size";
+  item.second = base::IntToString(storage_size_);
+  stats->push_back(item);
+}
+
+void FlashBackendImpl::OnExternalCacheHit(const std::string& key) {
+  // Segments are evicted in the order they were written, so hits do not
+  // change anything.
+}
+
+void FlashBackendImpl::OnInitComplete(const CompletionCallback& callback,
+                                      int result) {
+  store_initialized_ = result == net::OK;
+  callback.Run(result);
+}
+
+void FlashBackendImpl::OnOperationComplete(const CompletionCallback& callback,
+                                           int result) {
+  if (!callback.is_null())
+    callback.Run(result);
+}
+
+void FlashBackendImpl::OnDoomEntriesComplete(
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback,
+    int doomed_entries) {
+  if (!progress_callback.is_null())
+    progress_callback.Run(doomed_entries);
+  OnOperationComplete(callback, net::OK);
+}
+
+void FlashBackendImpl::OnOpenEntryComplete(
+    Entry** entry,
+    const CompletionCallback& callback,
+    scoped_refptr<InternalEntry>* internal_entry,
+    scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes) {
+  if (!key_and_stream_sizes) {
+    callback.Run(net::ERR_FAILED);
+    return;
+  }
+  FlashEntryImpl* opened_entry =
+      ActivateEntry(internal_entry->get(), *key_and_stream_sizes);
+  if (!opened_entry) {
+    callback.Run(net::ERR_FAILED);
+    return;
+  }
+  *entry = opened_entry;
+  callback.Run(net::OK);
+}
+
+void FlashBackendImpl::OpenNextEntryInIterator(
+    Iterator* iterator,
+    Entry** next_entry,
+    const CompletionCallback& callback) {
+  if (iterator->position >= iterator->entry_ids.size()) {
+    callback.Run(net::ERR_FAILED);
+    return;
+  }
+
+  const int32 id = iterator->entry_ids[iterator->position++];
+  scoped_refptr<InternalEntry>* internal_entry =
+      new scoped_refptr<InternalEntry>;
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&OpenEntryWithId, store_.get(), id, std::string(),
+                 internal_entry),
+      base::Bind(&FlashBackendImpl::OnOpenNextEntryComplete, AsWeakPtr(),
+                 iterator, next_entry, callback,
+                 base::Owned(internal_entry)));
+}
+
+void FlashBackendImpl::OnOpenNextEntryComplete(
+    Iterator* iterator,
+    Entry** next_entry,
+    const CompletionCallback& callback,
+    scoped_refptr<InternalEntry>* internal_entry,
+    scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes) {
+  // Entries removed since the enumeration started are skipped.
+  FlashEntryImpl* entry = NULL;
+  if (key_and_stream_sizes)
+    entry = ActivateEntry(internal_entry->get(), *key_and_stream_sizes);
+  if (!entry) {
+    OpenNextEntryInIterator(iterator, next_entry, callback);
+    return;
+  }
+  *next_entry = entry;
+  callback.Run(net::OK);
+}
+
+FlashEntryImpl* FlashBackendImpl::ActivateEntry(
+    InternalEntry* internal_entry,
+    const KeyAndStreamSizes& key_and_stream_sizes) {
+  const uint64 key_hash = InternalEntry::HashKey(key_and_stream_sizes.key);
+  EntryMap::iterator it = active_entries_.find(key_hash);
+  if (it != active_entries_.end()) {
+    cache_thread_->PostTask(FROM_HERE,
+                            base::Bind(&InternalEntry::Close,
+                                       make_scoped_refptr(internal_entry)));
+    if (it->second->GetKey() != key_and_stream_sizes.key)
+      return NULL;
+    it->second->AddRef();
+    return it->second;
+  }
+
+  FlashEntryImpl* entry = new FlashEntryImpl(AsWeakPtr(), internal_entry,
+                                             key_and_stream_sizes,
+                                             cache_thread_.get());
+  entry->AddRef();
+  active_entries_[key_hash] = entry;
+  return entry;
+}
+
+void FlashBackendImpl::DoomActiveEntriesBetween(Time initial_time,
+                                                Time end_time) {
+  std::vector<FlashEntryImpl*> to_doom;
+  for (EntryMap::const_iterator it = active_entries_.begin();
+       it != active_entries_.end(); ++it) {
+    const Time last_modified = it->second->GetLastModified();
+    if (last_modified >= initial_time &&
+        (end_time.is_null() || last_modified < end_time)) {
+      to_doom.push_back(it->second);
+    }
+  }
+  for (size_t i = 0; i < to_doom.size(); ++i)
+    to_doom[i]->Doom();
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,166 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_FLASH_FLASH_BACKEND_IMPL_H_
+#define NET_DISK_CACHE_FLASH_FLASH_BACKEND_IMPL_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/containers/hash_tables.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "net/base/cache_type.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace base {
+class MessageLoopProxy;
+}
+
+namespace net {
+class NetLog;
+}
+
+namespace disk_cache {
+
+class FlashEntryImpl;
+class InternalEntry;
+class LogStore;
+struct KeyAndStreamSizes;
+
+// FlashBackendImpl is a cache backend that appends entries to a single
+// log-structured file sized up front, which suits flash storage: see LogStore
+// for the layout, the index rebuilt from segment summaries and the eviction of
+// whole segments.  Entries are limited to the free space of a segment.
+//
+// The non-static functions below must be called on the IO thread.  The store
+// is used on the cache thread only.  Creating an entry is optimistic: the new
+// entry replaces any stored one with the same key when it is closed.
+//
+// The store does not record reads, so DoomEntriesBetween() and
+// DoomEntriesSince() go by the time entries were last modified.
+class NET_EXPORT_PRIVATE FlashBackendImpl
+    : public Backend,
+      public base::SupportsWeakPtr<FlashBackendImpl> {
+ public:
+  // The store is the file |kStoreFileName| in the cache directory |path|.  It
+  // takes |max_bytes| rounded down to a whole number of segments, or the
+  // default cache size if |max_bytes| is 0.
+  FlashBackendImpl(const base::FilePath& path, int max_bytes,
+                   net::CacheType cache_type,
+                   base::MessageLoopProxy* cache_thread,
+                   net::NetLog* net_log);
+  virtual ~FlashBackendImpl();
+
+  static const char kStoreFileName[];
+
+  int Init(const CompletionCallback& completion_callback);
+
+  // Called by the entries.
+  void OnEntryDoomed(FlashEntryImpl* entry);
+  void OnEntryClosed(FlashEntryImpl* entry);
+
+  // Backend:
+  virtual net::CacheType GetCacheType() const OVERRIDE;
+  virtual int32 GetEntryCount() const OVERRIDE;
+  virtual int OpenEntry(const std::string& key, Entry** entry,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int CreateEntry(const std::string& key, Entry** entry,
+                          const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntry(const std::string& key,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomAllEntries(const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetween(base::Time initial_time,
+                                 base::Time end_time,
+                                 const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesSince(base::Time initial_time,
+                               const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetweenWithProgress(
+      base::Time initial_time,
+      base::Time end_time,
+      const ProgressCallback& progress_callback,
+      const CompletionCallback& callback) OVERRIDE;
+  virtual int CalculateSizeOfEntriesBetween(
+      base::Time initial_time,
+      base::Time end_time,
+      const CompletionCallback& callback) OVERRIDE;
+  virtual int OpenNextEntry(void** iter, Entry** next_entry,
+                            const CompletionCallback& callback) OVERRIDE;
+  virtual void EndEnumeration(void** iter) OVERRIDE;
+  virtual void GetStats(
+      std::vector<std::pair<std::string, std::string> >* stats) OVERRIDE;
+  virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
+
+ private:
+  typedef base::hash_map<uint64, FlashEntryImpl*> EntryMap;
+
+  // The ids of the entries to enumerate, and the position of the enumeration.
+  struct Iterator {
+    Iterator();
+    ~Iterator();
+
+    std::vector<int32> entry_ids;
+    size_t position;
+  };
+
+  void OnInitComplete(const CompletionCallback& callback, int result);
+
+  // Completes an operation unless the backend is gone.
+  void OnOperationComplete(const CompletionCallback& callback, int result);
+  void OnDoomEntriesComplete(const ProgressCallback& progress_callback,
+                             const CompletionCallback& callback,
+                             int doomed_entries);
+
+  void OnOpenEntryComplete(Entry** entry,
+                           const CompletionCallback& callback,
+                           scoped_refptr<InternalEntry>* internal_entry,
+                           scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes);
+
+  void OpenNextEntryInIterator(Iterator* iterator, Entry** next_entry,
+                               const CompletionCallback& callback);
+  void OnOpenNextEntryComplete(
+      Iterator* iterator,
+      Entry** next_entry,
+      const CompletionCallback& callback,
+      scoped_refptr<InternalEntry>* internal_entry,
+      scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes);
+
+  // Returns the active entry for the key of |internal_entry| after closing
+  // |internal_entry|, or else makes |internal_entry| the active one.  Returns
+  // NULL if there is an active entry for a different key with the same hash.
+  // The caller owns a reference to the returned entry.
+  FlashEntryImpl* ActivateEntry(
+      InternalEntry* internal_entry,
+      const KeyAndStreamSizes& key_and_stream_sizes);
+
+  // Dooms the active entries last modified in [|initial_time|, |end_time|).
+  // A null |end_time| is unbounded.
+  void DoomActiveEntriesBetween(base::Time initial_time, base::Time end_time);
+
+  const base::FilePath path_;
+  const net::CacheType cache_type_;
+  const int32 storage_size_;
+  scoped_refptr<base::MessageLoopProxy> cache_thread_;
+
+  // Used on the cache thread, and deleted there after everything posted to
+  // it by the backend and the entries.
+  scoped_ptr<LogStore> store_;
+  bool store_initialized_;
+
+  // Entries the caller has open, including new ones.  Doomed entries are not
+  // in the map.
+  EntryMap active_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlashBackendImpl);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_FLASH_FLASH_BACKEND_IMPL_H_
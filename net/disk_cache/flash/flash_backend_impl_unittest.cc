@@ -0,0 +1,231 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <set>
+#include <string>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/run_loop.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/disk_cache/flash/flash_backend_impl.h"
+#include "net/disk_cache/flash/flash_cache_test_base.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+class FlashBackendTest : public FlashCacheTest {
+ protected:
+  FlashBackendTest() : cache_thread_("CacheThread") {}
+
+  virtual void SetUp() OVERRIDE {
+    FlashCacheTest::SetUp();
+    ASSERT_TRUE(cache_thread_.StartWithOptions(
+        base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+    CreateBackend();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    backend_.reset();
+    FlushCacheThread();
+    FlashCacheTest::TearDown();
+  }
+
+  void CreateBackend() {
+    backend_.reset(new disk_cache::FlashBackendImpl(
+        path_, kStorageSize, net::DISK_CACHE,
+        cache_thread_.message_loop_proxy().get(), NULL));
+    net::TestCompletionCallback cb;
+    ASSERT_EQ(net::OK, cb.GetResult(backend_->Init(cb.callback())));
+  }
+
+  // Restarts the backend on the same store.
+  void ReopenBackend() {
+    backend_.reset();
+    FlushCacheThread();
+    CreateBackend();
+  }
+
+  // Waits for the tasks posted to the cache thread so far, and their replies.
+  void FlushCacheThread() {
+    base::RunLoop run_loop;
+    cache_thread_.message_loop_proxy()->PostTaskAndReply(
+        FROM_HERE, base::Bind(&base::DoNothing), run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  // Returns the time once it differs from the current one.
+  base::Time WaitForClockToAdvance() {
+    const base::Time start = base::Time::Now();
+    base::Time now = start;
+    while (now == start) {
+      base::PlatformThread::YieldCurrentThread();
+      now = base::Time::Now();
+    }
+    return now;
+  }
+
+  void WriteEntry(const std::string& key, const std::string& data) {
+    disk_cache::Entry* entry = NULL;
+    net::TestCompletionCallback cb;
+    ASSERT_EQ(net::OK,
+              cb.GetResult(backend_->CreateEntry(key, &entry, cb.callback())));
+    scoped_refptr<net::StringIOBuffer> buffer(new net::StringIOBuffer(data));
+    EXPECT_EQ(static_cast<int>(data.size()),
+              cb.GetResult(entry->WriteData(1, 0, buffer.get(), data.size(),
+                                            cb.callback(), true)));
+    entry->Close();
+    FlushCacheThread();
+  }
+
+  // Returns stream 1 of the entry |key|, or "<missing>".
+  std::string ReadEntry(const std::string& key) {
+    disk_cache::Entry* entry = NULL;
+    net::TestCompletionCallback cb;
+    if (cb.GetResult(backend_->OpenEntry(key, &entry, cb.callback())) !=
+        net::OK) {
+      return "<missing>";
+    }
+    const int size = entry->GetDataSize(1);
+    scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(size + 1));
+    int rv = cb.GetResult(entry->ReadData(1, 0, buffer.get(), size,
+                                          cb.callback()));
+    entry->Close();
+    FlushCacheThread();
+    if (rv != size)
+      return "<failed>";
+    return std::string(buffer->data(), size);
+  }
+
+  base::Thread cache_thread_;
+  scoped_ptr<disk_cache::FlashBackendImpl> backend_;
+};
+
+}  // namespace
+
+TEST_F(FlashBackendTest, EntriesSurviveRestart) {
+  WriteEntry("key1", "data1");
+  WriteEntry("key2", "data2");
+  EXPECT_EQ(2, backend_->GetEntryCount());
+  EXPECT_EQ("data1", ReadEntry("key1"));
+
+  ReopenBackend();
+  EXPECT_EQ(2, backend_->GetEntryCount());
+  EXPECT_EQ("data1", ReadEntry("key1"));
+  EXPECT_EQ("data2", ReadEntry("key2"));
+  EXPECT_EQ("<missing>", ReadEntry("key3"));
+}
+
+TEST_F(FlashBackendTest, CreateReplacesStoredEntry) {
+  WriteEntry("key", "old data");
+  WriteEntry("key", "new data");
+  EXPECT_EQ(1, backend_->GetEntryCount());
+  EXPECT_EQ("new data", ReadEntry("key"));
+
+  ReopenBackend();
+  EXPECT_EQ("new data", ReadEntry("key"));
+}
+
+TEST_F(FlashBackendTest, OpenActiveEntry) {
+  disk_cache::Entry* entry1 = NULL;
+  net::TestCompletionCallback cb;
+  ASSERT_EQ(net::OK,
+            cb.GetResult(backend_->CreateEntry("key", &entry1, cb.callback())));
+
+  // The entry is being created, so it can be opened but not created again.
+  disk_cache::Entry* entry2 = NULL;
+  EXPECT_EQ(net::ERR_FAILED,
+            cb.GetResult(backend_->CreateEntry("key", &entry2, cb.callback())));
+  ASSERT_EQ(net::OK,
+            cb.GetResult(backend_->OpenEntry("key", &entry2, cb.callback())));
+  EXPECT_EQ(entry1, entry2);
+  entry1->Close();
+  entry2->Close();
+}
+
+TEST_F(FlashBackendTest, DoomEntry) {
+  WriteEntry("key1", "data1");
+  WriteEntry("key2", "data2");
+
+  net::TestCompletionCallback cb;
+  EXPECT_EQ(net::OK, cb.GetResult(backend_->DoomEntry("key1", cb.callback())));
+  EXPECT_EQ(1, backend_->GetEntryCount());
+  EXPECT_EQ("<missing>", ReadEntry("key1"));
+
+  ReopenBackend();
+  EXPECT_EQ("<missing>", ReadEntry("key1"));
+  EXPECT_EQ("data2", ReadEntry("key2"));
+}
+
+TEST_F(FlashBackendTest, DoomOpenEntry) {
+  WriteEntry("key", "data");
+
+  disk_cache::Entry* entry = NULL;
+  net::TestCompletionCallback cb;
+  ASSERT_EQ(net::OK,
+            cb.GetResult(backend_->OpenEntry("key", &entry, cb.callback())));
+  entry->Doom();
+  entry->Close();
+  FlushCacheThread();
+
+  EXPECT_EQ(0, backend_->GetEntryCount());
+  EXPECT_EQ("<missing>", ReadEntry("key"));
+}
+
+TEST_F(FlashBackendTest, DoomAllEntries) {
+  WriteEntry("key1", "data1");
+  WriteEntry("key2", "data2");
+
+  net::TestCompletionCallback cb;
+  EXPECT_EQ(net::OK, cb.GetResult(backend_->DoomAllEntries(cb.callback())));
+  EXPECT_EQ(0, backend_->GetEntryCount());
+  WriteEntry("key3", "data3");
+
+  ReopenBackend();
+  EXPECT_EQ(1, backend_->GetEntryCount());
+  EXPECT_EQ("<missing>", ReadEntry("key1"));
+  EXPECT_EQ("data3", ReadEntry("key3"));
+}
+
+TEST_F(FlashBackendTest, DoomEntriesSince) {
+  WriteEntry("key1", "data1");
+  const base::Time middle = WaitForClockToAdvance();
+  WaitForClockToAdvance();
+  WriteEntry("key2", "data2");
+
+  net::TestCompletionCallback cb;
+  EXPECT_EQ(net::OK,
+            cb.GetResult(backend_->DoomEntriesSince(middle, cb.callback())));
+  EXPECT_EQ("data1", ReadEntry("key1"));
+  EXPECT_EQ("<missing>", ReadEntry("key2"));
+}
+
+TEST_F(FlashBackendTest, Enumeration) {
+  WriteEntry("key1", "data1");
+  WriteEntry("key2", "data2");
+
+  void* iter = NULL;
+  disk_cache::Entry* entry = NULL;
+  net::TestCompletionCallback cb;
+  std::set<std::string> keys;
+  while (cb.GetResult(backend_->OpenNextEntry(&iter, &entry, cb.callback())) ==
+         net::OK) {
+    keys.insert(entry->GetKey());
+    entry->Close();
+  }
+  backend_->EndEnumeration(&iter);
+
+  EXPECT_EQ(2u, keys.size());
+  EXPECT_EQ(1u, keys.count("key1"));
+  EXPECT_EQ(1u, keys.count("key2"));
+}
@@ -2,149 +2,256 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
 #include "base/location.h"
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/task_runner_util.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
+#include "net/disk_cache/flash/flash_backend_impl.h"
 #include "net/disk_cache/flash/flash_entry_impl.h"
 #include "net/disk_cache/flash/internal_entry.h"
 
 namespace disk_cache {
 
-FlashEntryImpl::FlashEntryImpl(const std::string& key,
+namespace {
+
+// Runs on the cache thread.
+void ReadIntoResult(const scoped_refptr<InternalEntry>& entry, int index,
+                    const scoped_refptr<net::IOBuffer>& buf, int buf_len,
+                    int* result) {
+  *result = entry->ReadData(index, 0, buf.get(), buf_len);
+}
+
+}  // namespace
+
+FlashEntryImpl::FlashEntryImpl(const base::WeakPtr<FlashBackendImpl>& backend,
+                               const std::string& key,
                                LogStore* store,
                                base::MessageLoopProxy* cache_thread)
-    : init_(false),
+    : backend_(backend),
       key_(key),
+      key_hash_(InternalEntry::HashKey(key)),
+      last_used_(base::Time::Now()),
+      last_modified_(last_used_),
+      doomed_(false),
       new_internal_entry_(new InternalEntry(key, store)),
       cache_thread_(cache_thread) {
   memset(stream_sizes_, 0, sizeof(stream_sizes_));
 }
 
-FlashEntryImpl::FlashEntryImpl(int32 id,
-                               LogStore* store,
+FlashEntryImpl::FlashEntryImpl(const base::WeakPtr<FlashBackendImpl>& backend,
+                               InternalEntry* old_internal_entry,
+                               const KeyAndStreamSizes& key_and_stream_sizes,
                                base::MessageLoopProxy* cache_thread)
-    : init_(false),
-      old_internal_entry_(new InternalEntry(id, store)),
+    : backend_(backend),
+      key_(key_and_stream_sizes.key),
+      key_hash_(InternalEntry::HashKey(key_)),
+      last_used_(base::Time::Now()),
+      last_modified_(key_and_stream_sizes.last_modified),
+      doomed_(false),
+      old_internal_entry_(old_internal_entry),
       cache_thread_(cache_thread) {
+  memcpy(stream_sizes_, key_and_stream_sizes.stream_sizes,
+         sizeof(stream_sizes_));
 }
 
-int FlashEntryImpl::Init(const CompletionCallback& callback) {
+void FlashEntryImpl::Doom() {
+  if (doomed_)
+    return;
+  doomed_ = true;
+  if (backend_)
+    backend_->OnEntryDoomed(this);
   if (new_internal_entry_.get()) {
-    DCHECK(callback.is_null());
-    init_ = true;
-    return net::OK;
+    new_internal_entry_->Doom();
+    return;
+  }
+  if (backend_) {
+    cache_thread_->PostTask(FROM_HERE,
+                            Bind(&InternalEntry::Doom, old_internal_entry_));
   }
-  DCHECK(!callback.is_null() && old_internal_entry_.get());
-  callback_ = callback;
-  PostTaskAndReplyWithResult(cache_thread_.get(),
-                             FROM_HERE,
-                             Bind(&InternalEntry::Init, old_internal_entry_),
-                             Bind(&FlashEntryImpl::OnInitComplete, this));
-  return net::ERR_IO_PENDING;
-}
-
-void FlashEntryImpl::Doom() {
-  DCHECK(init_);
-  NOTREACHED();
 }
 
 void FlashEntryImpl::Close() {
-  DCHECK(init_);
   Release();
 }
 
 std::string FlashEntryImpl::GetKey() const {
-  DCHECK(init_);
   return key_;
 }
 
 base::Time FlashEntryImpl::GetLastUsed() const {
-  DCHECK(init_);
-  NOTREACHED();
-  return base::Time::Now();
+  return last_used_;
 }
 
 base::Time FlashEntryImpl::GetLastModified() const {
-  DCHECK(init_);
-  NOTREACHED();
-  return base::Time::Now();
+  return last_modified_;
 }
 
 int32 FlashEntryImpl::GetDataSize(int index) const {
-  DCHECK(init_);
-  return new_internal_entry_->GetDataSize(index);
+  if (InvalidStream(index))
+    return 0;
+  if (new_internal_entry_.get())
+    return new_internal_entry_->GetDataSize(index);
+  return stream_sizes_[index];
 }
 
 int FlashEntryImpl::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback) {
-  DCHECK(init_);
-  return new_internal_entry_->ReadData(index, offset, buf, buf_len, callback);
+  if (InvalidStream(index) || offset < 0 || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+  if (new_internal_entry_.get())
+    return new_internal_entry_->ReadData(index, offset, buf, buf_len);
+
+  if (offset >= stream_sizes_[index] || !buf_len)
+    return 0;
+  if (!backend_)
+    return net::ERR_UNEXPECTED;
+  last_used_ = base::Time::Now();
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      Bind(&InternalEntry::ReadData, old_internal_entry_, index, offset,
+           make_scoped_refptr(buf), buf_len),
+      Bind(&FlashEntryImpl::OnIOComplete, this, callback));
+  return net::ERR_IO_PENDING;
 }
 
 int FlashEntryImpl::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
                               const CompletionCallback& callback,
                               bool truncate) {
-  DCHECK(init_);
-  return new_internal_entry_->WriteData(index, offset, buf, buf_len, callback);
+  if (InvalidStream(index) || offset < 0 || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+  if (offset > kFlashSegmentFreeSpace || buf_len > kFlashSegmentFreeSpace)
+    return net::ERR_FAILED;
+  int new_size = offset + buf_len;
+  if (!truncate)
+    new_size = std::max(new_size, GetDataSize(index));
+  if (!CanResizeStream(index, new_size))
+    return net::ERR_FAILED;
+
+  last_modified_ = base::Time::Now();
+  if (new_internal_entry_.get()) {
+    return new_internal_entry_->WriteData(index, offset, buf, buf_len,
+                                          truncate);
+  }
+
+  if (!backend_)
+    return net::ERR_UNEXPECTED;
+  stream_sizes_[index] = new_size;
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      Bind(&InternalEntry::WriteData, old_internal_entry_, index, offset,
+           make_scoped_refptr(buf), buf_len, truncate),
+      Bind(&FlashEntryImpl::OnIOComplete, this, callback));
+  return net::ERR_IO_PENDING;
+}
+
+int FlashEntryImpl::ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                         int buf_len, int prefetch_index,
+                                         IOBuffer* prefetch_buf,
+                                         int prefetch_buf_len,
+                                         const CompletionCallback& callback) {
+  if (InvalidStream(index) || InvalidStream(prefetch_index) || offset < 0 ||
+      buf_len < 0 || prefetch_buf_len < 0) {
+    return net::ERR_INVALID_ARGUMENT;
+  }
+  const int expected = std::min(prefetch_buf_len, GetDataSize(prefetch_index));
+  if (new_internal_entry_.get()) {
+    int result = new_internal_entry_->ReadData(prefetch_index, 0, prefetch_buf,
+                                               prefetch_buf_len);
+    if (result != expected)
+      return result < 0 ? result : net::ERR_FAILED;
+    return new_internal_entry_->ReadData(index, offset, buf, buf_len);
+  }
+
+  if (!backend_)
+    return net::ERR_UNEXPECTED;
+  last_used_ = base::Time::Now();
+
+  // Both reads are posted back to back, so they take one trip to the cache
+  // thread and the prefetch is done by the time the read completes.
+  int* prefetch_result = new int(net::ERR_IO_PENDING);
+  cache_thread_->PostTask(
+      FROM_HERE,
+      Bind(&ReadIntoResult, old_internal_entry_, prefetch_index,
+           make_scoped_refptr(prefetch_buf), prefetch_buf_len,
+           prefetch_result));
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      Bind(&InternalEntry::ReadData, old_internal_entry_, index, offset,
+           make_scoped_refptr(buf), buf_len),
+      Bind(&FlashEntryImpl::OnReadWithPrefetchComplete, this, callback,
+           expected, base::Owned(prefetch_result)));
+  return net::ERR_IO_PENDING;
 }
 
 int FlashEntryImpl::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                                    const CompletionCallback& callback) {
-  DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 int FlashEntryImpl::WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
                                     const CompletionCallback& callback) {
-  DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 int FlashEntryImpl::GetAvailableRange(int64 offset, int len, int64* start,
                                       const CompletionCallback& callback) {
-  DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 bool FlashEntryImpl::CouldBeSparse() const {
-  DCHECK(init_);
-  NOTREACHED();
   return false;
 }
 
 void FlashEntryImpl::CancelSparseIO() {
-  DCHECK(init_);
-  NOTREACHED();
 }
 
 int FlashEntryImpl::ReadyForSparseIO(const CompletionCallback& callback) {
-  DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
-}
-
-void FlashEntryImpl::OnInitComplete(
-    scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes) {
-  DCHECK(!callback_.is_null());
-  if (!key_and_stream_sizes) {
-    callback_.Run(net::ERR_FAILED);
-  } else {
-    key_ = key_and_stream_sizes->key;
-    memcpy(stream_sizes_, key_and_stream_sizes->stream_sizes,
-           sizeof(stream_sizes_));
-    init_ = true;
-    callback_.Run(net::OK);
-  }
+  return net::OK;
 }
 
 FlashEntryImpl::~FlashEntryImpl() {
+  // Without the backend the store is gone, and the entry with it.
+  if (!backend_)
+    return;
+  backend_->OnEntryClosed(this);
+  scoped_refptr<InternalEntry> internal_entry = new_internal_entry_.get() ?
+      new_internal_entry_ : old_internal_entry_;
   cache_thread_->PostTask(FROM_HERE,
-                          Bind(&InternalEntry::Close, new_internal_entry_));
+                          Bind(&InternalEntry::Close, internal_entry));
+}
+
+bool FlashEntryImpl::InvalidStream(int index) const {
+  // Stream 0 of the internal entry holds the key.
+  return index < 0 || index >= kFlashLogStoreEntryNumStreams - 1;
+}
+
+bool FlashEntryImpl::CanResizeStream(int index, int new_size) const {
+  int64 size = kFlashLogStoreEntryHeaderSize + key_.size();
+  for (int i = 0; i < kFlashLogStoreEntryNumStreams - 1; ++i)
+    size += i == index ? new_size : GetDataSize(i);
+  return size <= kFlashSegmentFreeSpace;
+}
+
+void FlashEntryImpl::OnIOComplete(const CompletionCallback& callback,
+                                  int result) {
+  if (!callback.is_null())
+    callback.Run(result);
+}
+
+void FlashEntryImpl::OnReadWithPrefetchComplete(
+    const CompletionCallback& callback,
+    int expected_prefetch_result,
+    const int* prefetch_result,
+    int result) {
+  if (*prefetch_result != expected_prefetch_result)
+    result = *prefetch_result < 0 ? *prefetch_result : net::ERR_FAILED;
+  OnIOComplete(callback, result);
 }
 
 }  // namespace disk_cache
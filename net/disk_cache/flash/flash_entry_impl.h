@@ -9,6 +9,8 @@
 
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "net/base/net_export.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/flash/internal_entry.h"
@@ -21,6 +23,7 @@ class MessageLoopProxy;
 
 namespace disk_cache {
 
+class FlashBackendImpl;
 class InternalEntry;
 class IOBuffer;
 class LogStore;
@@ -35,19 +38,29 @@ class LogStore;
 // When an entry is not new, every asynchronous call is posted to the cache
 // thread, just as before; synchronous calls like GetKey() and GetDataSize() are
 // served from the main thread.
+//
+// The store does not record reads, so GetLastUsed() is the time the entry was
+// opened, or else its last modification.  Sparse data is not supported.
 class NET_EXPORT_PRIVATE FlashEntryImpl
     : public Entry,
       public base::RefCountedThreadSafe<FlashEntryImpl> {
   friend class base::RefCountedThreadSafe<FlashEntryImpl>;
  public:
-  FlashEntryImpl(const std::string& key,
+  // Creates a new entry for |key|.
+  FlashEntryImpl(const base::WeakPtr<FlashBackendImpl>& backend,
+                 const std::string& key,
                  LogStore* store,
                  base::MessageLoopProxy* cache_thread);
-  FlashEntryImpl(int32 id,
-                 LogStore* store,
+
+  // Wraps |old_internal_entry|, which was initialized on the cache thread and
+  // returned |key_and_stream_sizes|.
+  FlashEntryImpl(const base::WeakPtr<FlashBackendImpl>& backend,
+                 InternalEntry* old_internal_entry,
+                 const KeyAndStreamSizes& key_and_stream_sizes,
                  base::MessageLoopProxy* cache_thread);
 
-  int Init(const CompletionCallback& callback);
+  uint64 key_hash() const { return key_hash_; }
+  bool doomed() const { return doomed_; }
 
   // disk_cache::Entry interface.
   virtual void Doom() OVERRIDE;
@@ -61,6 +74,11 @@ class NET_EXPORT_PRIVATE FlashEntryImpl
   virtual int WriteData(int index, int offset, IOBuffer* buf, int buf_len,
                         const CompletionCallback& callback,
                         bool truncate) OVERRIDE;
+  virtual int ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                   int buf_len, int prefetch_index,
+                                   IOBuffer* prefetch_buf,
+                                   int prefetch_buf_len,
+                                   const CompletionCallback& callback) OVERRIDE;
   virtual int ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback) OVERRIDE;
   virtual int WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
@@ -72,12 +90,27 @@ class NET_EXPORT_PRIVATE FlashEntryImpl
   virtual int ReadyForSparseIO(const CompletionCallback& callback) OVERRIDE;
 
  private:
-  void OnInitComplete(scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes);
   virtual ~FlashEntryImpl();
 
-  bool init_;
+  bool InvalidStream(int index) const;
+
+  // Returns whether the entry still fits in a segment if stream |index| is
+  // |new_size| bytes long.
+  bool CanResizeStream(int index, int new_size) const;
+
+  void OnIOComplete(const CompletionCallback& callback, int result);
+  void OnReadWithPrefetchComplete(const CompletionCallback& callback,
+                                  int expected_prefetch_result,
+                                  const int* prefetch_result,
+                                  int result);
+
+  base::WeakPtr<FlashBackendImpl> backend_;
   std::string key_;
+  const uint64 key_hash_;
   int stream_sizes_[kFlashLogStoreEntryNumStreams];
+  base::Time last_used_;
+  base::Time last_modified_;
+  bool doomed_;
 
   // Used if |this| is an newly created entry.
   scoped_refptr<InternalEntry> new_internal_entry_;
@@ -85,9 +118,6 @@ class NET_EXPORT_PRIVATE FlashEntryImpl
   // Used if |this| is an existing entry.
   scoped_refptr<InternalEntry> old_internal_entry_;
 
-  // Copy of the callback for asynchronous calls on |old_internal_entry_|.
-  CompletionCallback callback_;
-
   scoped_refptr<base::MessageLoopProxy> cache_thread_;
 
   DISALLOW_COPY_AND_ASSIGN(FlashEntryImpl);
@@ -5,6 +5,8 @@
 #ifndef NET_DISK_CACHE_FLASH_FORMAT_H_
 #define NET_DISK_CACHE_FLASH_FORMAT_H_
 
+#include "base/basictypes.h"
+
 namespace disk_cache {
 
 // Storage constants.
@@ -17,9 +19,46 @@ const int32 kFlashSmallEntrySize = 4 * 1024;
 const size_t kFlashMaxEntryCount = kFlashSegmentSize / kFlashSmallEntrySize - 1;
 
 // Segment summary consists of a fixed region at the end of the segment
-// containing a counter specifying the number of saved offsets followed by the
-// offsets.
-const int32 kFlashSummarySize = (1 + kFlashMaxEntryCount) * sizeof(int32);
+// containing a header followed by a record for every entry written to the
+// segment, and for every entry deleted while the segment was being written.
+// The summaries of all segments are enough to rebuild the index of the store
+// without reading the entries themselves.
+const uint32 kFlashSummaryMagic = 0xf1a5ca5e;
+const uint32 kFlashSummaryVersion = 1;
+
+struct FlashSummaryHeader {
+  uint32 magic;
+  uint32 version;
+
+  // Segments are closed in increasing order of sequence number and a later
+  // segment overrides what an earlier one says about an entry.  Sequence
+  // numbers start at 1.
+  int64 sequence_number;
+
+  // Every segment with a lower sequence number than this is empty, which is
+  // how the whole store is cleared at once.
+  int64 first_sequence_number;
+
+  int32 entry_count;
+  int32 unused;
+};
+COMPILE_ASSERT(sizeof(FlashSummaryHeader) == 32, bad_flash_summary_header);
+
+// Flag of a record that deletes the entry at |offset| instead of adding one.
+const uint32 kFlashSummaryEntryDeleted = 1 << 0;
+
+struct FlashSummaryEntry {
+  int32 offset;  // The id of the entry, i.e. its offset on the storage.
+  int32 size;
+  uint64 key_hash;
+  int64 last_modified;  // base::Time internal value.
+  uint32 flags;
+  uint32 unused;
+};
+COMPILE_ASSERT(sizeof(FlashSummaryEntry) == 32, bad_flash_summary_entry);
+
+const int32 kFlashSummarySize = sizeof(FlashSummaryHeader) +
+                                kFlashMaxEntryCount * sizeof(FlashSummaryEntry);
 const int32 kFlashSegmentFreeSpace = kFlashSegmentSize - kFlashSummarySize;
 
 // An entry consists of a fixed number of streams.
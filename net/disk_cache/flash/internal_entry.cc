@@ -5,7 +5,7 @@
 #include "net/disk_cache/flash/internal_entry.h"
 
 #include "base/memory/ref_counted.h"
-#include "net/base/completion_callback.h"
+#include "base/sha1.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/flash/log_store.h"
@@ -13,7 +13,6 @@
 
 using net::IOBuffer;
 using net::StringIOBuffer;
-using net::CompletionCallback;
 
 namespace disk_cache {
 
@@ -24,6 +23,7 @@ InternalEntry::InternalEntry(const std::string& key, LogStore* store)
     : store_(store),
       entry_(new LogStoreEntry(store_)) {
   entry_->Init();
+  entry_->set_key_hash(HashKey(key));
   WriteKey(entry_.get(), key);
 }
 
@@ -35,6 +35,17 @@ InternalEntry::InternalEntry(int32 id, LogStore* store)
 InternalEntry::~InternalEntry() {
 }
 
+// static
+uint64 InternalEntry::HashKey(const std::string& key) {
+  union {
+    unsigned char sha_hash[base::kSHA1Length];
+    uint64 key_hash;
+  } u;
+  base::SHA1HashBytes(reinterpret_cast<const unsigned char*>(key.data()),
+                      key.size(), u.sha_hash);
+  return u.key_hash;
+}
+
 scoped_ptr<KeyAndStreamSizes> InternalEntry::Init() {
   scoped_ptr<KeyAndStreamSizes> null;
   if (entry_->IsNew())
@@ -43,10 +54,15 @@ scoped_ptr<KeyAndStreamSizes> InternalEntry::Init() {
     return null.Pass();
 
   scoped_ptr<KeyAndStreamSizes> rv(new KeyAndStreamSizes);
-  if (!ReadKey(entry_.get(), &rv->key))
+  LogStore::EntryInfo info;
+  if (!ReadKey(entry_.get(), &rv->key) ||
+      !store_->GetEntryInfo(entry_->id(), &info)) {
+    entry_->Close();
     return null.Pass();
+  }
   for (int i = 0; i < kFlashLogStoreEntryNumStreams; ++i)
     rv->stream_sizes[i] = entry_->GetDataSize(i+1);
+  rv->last_modified = info.last_modified;
   return rv.Pass();
 }
 
@@ -54,14 +70,18 @@ int32 InternalEntry::GetDataSize(int index) const {
   return entry_->GetDataSize(++index);
 }
 
-int InternalEntry::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
-                            const CompletionCallback& callback) {
+int InternalEntry::ReadData(int index, int offset, IOBuffer* buf,
+                            int buf_len) {
   return entry_->ReadData(++index, offset, buf, buf_len);
 }
 
 int InternalEntry::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
-                             const CompletionCallback& callback) {
-  return entry_->WriteData(++index, offset, buf, buf_len);
+                             bool truncate) {
+  return entry_->WriteData(++index, offset, buf, buf_len, truncate);
+}
+
+void InternalEntry::Doom() {
+  entry_->Delete();
 }
 
 void InternalEntry::Close() {
@@ -71,7 +91,7 @@ void InternalEntry::Close() {
 bool InternalEntry::WriteKey(LogStoreEntry* entry, const std::string& key) {
   int key_size = static_cast<int>(key.size());
   scoped_refptr<IOBuffer> key_buf(new StringIOBuffer(key));
-  return entry->WriteData(0, 0, key_buf.get(), key_size) == key_size;
+  return entry->WriteData(0, 0, key_buf.get(), key_size, true) == key_size;
 }
 
 bool InternalEntry::ReadKey(LogStoreEntry* entry, std::string* key) {
@@ -8,8 +8,9 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
-#include "net/base/completion_callback.h"
+#include "base/time/time.h"
 #include "net/base/net_export.h"
 #include "net/disk_cache/flash/format.h"
 
@@ -25,13 +26,19 @@ struct KeyAndStreamSizes {
   KeyAndStreamSizes();
   std::string key;
   int stream_sizes[kFlashLogStoreEntryNumStreams];
+  base::Time last_modified;
 };
 
 class LogStore;
 class LogStoreEntry;
 
 // Actual entry implementation that does all the work of reading, writing and
-// storing data.
+// storing data.  Stream 0 of the underlying LogStoreEntry holds the key, and
+// the streams of the disk_cache::Entry follow it.
+//
+// A new entry does not touch |store| until it is closed, so it can be used on
+// any thread until then.  All other calls must be made on the thread |store| is
+// used on.
 class NET_EXPORT_PRIVATE InternalEntry
     : public base::RefCountedThreadSafe<InternalEntry> {
   friend class base::RefCountedThreadSafe<InternalEntry>;
@@ -39,12 +46,15 @@ class NET_EXPORT_PRIVATE InternalEntry
   InternalEntry(const std::string& key, LogStore* store);
   InternalEntry(int32 id, LogStore* store);
 
+  // Returns the hash entries of |key| are stored and looked up with.
+  static uint64 HashKey(const std::string& key);
+
   scoped_ptr<KeyAndStreamSizes> Init();
   int32 GetDataSize(int index) const;
-  int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len,
-               const net::CompletionCallback& callback);
+  int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len);
   int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
-                const net::CompletionCallback& callback);
+                bool truncate);
+  void Doom();
   void Close();
 
  private:
@@ -2,8 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/stl_util.h"
 #include "net/disk_cache/flash/format.h"
 #include "net/disk_cache/flash/log_store.h"
@@ -12,13 +17,32 @@
 
 namespace disk_cache {
 
+namespace {
+
+// The live entries of a reused segment are garbage collected if they take up
+// at most this fraction of the segment, and evicted otherwise.
+const int32 kGarbageCollectionRatio = 4;
+
+bool CompareSequenceNumbers(const Segment* a, const Segment* b) {
+  return a->sequence_number() < b->sequence_number();
+}
+
+}  // namespace
+
+LogStore::EntryInfo::EntryInfo() : id(-1), size(0), key_hash(0) {
+}
+
 LogStore::LogStore(const base::FilePath& path, int32 size)
     : storage_(path, size),
       num_segments_(size / kFlashSegmentSize),
       open_segments_(num_segments_),
       write_index_(0),
+      next_sequence_number_(1),
+      first_sequence_number_(0),
       current_entry_id_(-1),
       current_entry_num_bytes_left_to_write_(0),
+      entry_count_(0),
+      segment_live_bytes_(num_segments_),
       init_(false),
       closed_(false) {
   DCHECK(size % kFlashSegmentSize == 0);
@@ -31,17 +55,8 @@ LogStore::~LogStore() {
 
 bool LogStore::Init() {
   DCHECK(!init_);
-  if (!storage_.Init())
-    return false;
-
-  // TODO(agayev): Once we start persisting segment metadata to disk, we will
-  // start from where we left off during the last shutdown.
-  scoped_ptr<Segment> segment(new Segment(write_index_, false, &storage_));
-  if (!segment->Init())
+  if (!storage_.Init() || !LoadSegments())
     return false;
-
-  segment->AddUser();
-  open_segments_[write_index_] = segment.release();
   init_ = true;
   return true;
 }
@@ -53,46 +68,73 @@ bool LogStore::Close() {
     return false;
   closed_ = true;
   return true;
-  // TODO(agayev): persist metadata to disk.
 }
 
 bool LogStore::CreateEntry(int32 size, int32* id) {
+  return CreateEntry(size, 0, base::Time(), id);
+}
+
+bool LogStore::CreateEntry(int32 size, uint64 key_hash,
+                           base::Time last_modified, int32* id) {
   DCHECK(init_ && !closed_);
   DCHECK(current_entry_id_ == -1 && size <= disk_cache::kFlashSegmentFreeSpace);
 
   // TODO(agayev): Avoid large entries from leaving the segments almost empty.
-  if (!open_segments_[write_index_]->CanHold(size)) {
-    if (!open_segments_[write_index_]->Close())
-      return false;
-
-    open_segments_[write_index_]->ReleaseUser();
-    if (open_segments_[write_index_]->HasNoUsers()) {
-      delete open_segments_[write_index_];
-      open_segments_[write_index_] = NULL;
-    }
-
-    write_index_ = GetNextSegmentIndex();
-    scoped_ptr<Segment> segment(new Segment(write_index_, false, &storage_));
-    if (!segment->Init())
-      return false;
-
-    segment->AddUser();
-    open_segments_[write_index_] = segment.release();
+  if (!open_segments_[write_index_]->CanHold(size) &&
+      !AdvanceWriteSegment(size)) {
+    return false;
   }
 
   *id = open_segments_[write_index_]->write_offset();
-  open_segments_[write_index_]->StoreOffset(*id);
   current_entry_id_ = *id;
+  current_entry_.id = *id;
+  current_entry_.size = size;
+  current_entry_.key_hash = key_hash;
+  current_entry_.last_modified = last_modified;
   current_entry_num_bytes_left_to_write_ = size;
   open_entries_.insert(current_entry_id_);
   return true;
 }
 
-void LogStore::DeleteEntry(int32 id, int32 size) {
+void LogStore::DeleteEntry(int32 id) {
+  DCHECK(init_ && !closed_);
+  DCHECK_EQ(-1, current_entry_id_);
+  EntryMap::iterator entry_iter = entries_.find(id);
+  if (entry_iter == entries_.end())
+    return;
+
+  FlashSummaryEntry record;
+  memset(&record, 0, sizeof(record));
+  record.offset = id;
+  record.key_hash = entry_iter->second.key_hash;
+  record.flags = kFlashSummaryEntryDeleted;
+  RemoveEntry(entry_iter);
+
+  // Without the record the entry comes back after a restart, which is not
+  // worth failing the deletion for.
+  if (!open_segments_[write_index_]->CanHold(0) && !AdvanceWriteSegment(0)) {
+    LOG(WARNING) << "Could not record the deletion of entry " << id;
+    return;
+  }
+  open_segments_[write_index_]->StoreEntry(record);
+}
+
+bool LogStore::DeleteAllEntries() {
   DCHECK(init_ && !closed_);
-  DCHECK(open_entries_.find(id) == open_entries_.end());
-  // TODO(agayev): Increment the number of dead bytes in the segment metadata
-  // for the segment identified by |index|.
+  DCHECK_EQ(-1, current_entry_id_);
+  entries_.clear();
+  entry_ids_by_key_hash_.clear();
+  base::subtle::NoBarrier_Store(&entry_count_, 0);
+  std::fill(segment_live_bytes_.begin(), segment_live_bytes_.end(), 0);
+
+  // Everything written before the next segment is dropped when the summaries
+  // are loaded again.
+  if (!AdvanceWriteSegment(0))
+    return false;
+  Segment* segment = open_segments_[write_index_];
+  first_sequence_number_ = segment->sequence_number();
+  segment->set_first_sequence_number(first_sequence_number_);
+  return segment->Flush();
 }
 
 bool LogStore::WriteData(const void* buffer, int32 size) {
@@ -108,8 +150,10 @@ bool LogStore::WriteData(const void* buffer, int32 size) {
 
 bool LogStore::OpenEntry(int32 id) {
   DCHECK(init_ && !closed_);
-  if (open_entries_.find(id) != open_entries_.end())
+  if (open_entries_.find(id) != open_entries_.end() ||
+      entries_.find(id) == entries_.end()) {
     return false;
+  }
 
   // Segment is already open.
   int32 index = id / disk_cache::kFlashSegmentSize;
@@ -148,9 +192,22 @@ void LogStore::CloseEntry(int32 id) {
   DCHECK(entry_iter != open_entries_.end());
 
   if (current_entry_id_ != -1) {
-    DCHECK(id == current_entry_id_ && !current_entry_num_bytes_left_to_write_);
+    DCHECK(id == current_entry_id_);
     open_entries_.erase(entry_iter);
     current_entry_id_ = -1;
+
+    // The space of an entry that was not written completely is left unused.
+    if (current_entry_num_bytes_left_to_write_)
+      return;
+
+    FlashSummaryEntry record;
+    memset(&record, 0, sizeof(record));
+    record.offset = current_entry_.id;
+    record.size = current_entry_.size;
+    record.key_hash = current_entry_.key_hash;
+    record.last_modified = current_entry_.last_modified.ToInternalValue();
+    open_segments_[write_index_]->StoreEntry(record);
+    AddEntry(current_entry_);
     return;
   }
 
@@ -165,13 +222,210 @@ void LogStore::CloseEntry(int32 id) {
   }
 }
 
+bool LogStore::FindEntry(uint64 key_hash, int32* id) const {
+  DCHECK(init_ && !closed_);
+  KeyHashMap::const_iterator it = entry_ids_by_key_hash_.find(key_hash);
+  if (it == entry_ids_by_key_hash_.end())
+    return false;
+  *id = it->second;
+  return true;
+}
+
+bool LogStore::GetEntryInfo(int32 id, EntryInfo* info) const {
+  DCHECK(init_ && !closed_);
+  EntryMap::const_iterator it = entries_.find(id);
+  if (it == entries_.end())
+    return false;
+  *info = it->second;
+  return true;
+}
+
+void LogStore::GetEntries(std::vector<EntryInfo>* entries) const {
+  DCHECK(init_ && !closed_);
+  entries->reserve(entries->size() + entries_.size());
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    entries->push_back(it->second);
+  }
+}
+
+int32 LogStore::GetEntryCount() const {
+  return base::subtle::NoBarrier_Load(&entry_count_);
+}
+
+bool LogStore::LoadSegments() {
+  ScopedVector<Segment> segments;
+  for (int32 i = 0; i < num_segments_; ++i) {
+    scoped_ptr<Segment> segment(new Segment(i, true, &storage_));
+    if (!segment->Init())
+      return false;
+    if (!segment->sequence_number())
+      continue;
+    first_sequence_number_ = std::max(first_sequence_number_,
+                                      segment->first_sequence_number());
+    segments.push_back(segment.release());
+  }
+  std::sort(segments.begin(), segments.end(), CompareSequenceNumbers);
+
+  // Replay the summaries in the order they were written.
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const Segment* segment = segments[i];
+    if (segment->sequence_number() < first_sequence_number_)
+      continue;
+    const std::vector<FlashSummaryEntry>& records = segment->entries();
+    for (size_t j = 0; j < records.size(); ++j) {
+      const FlashSummaryEntry& record = records[j];
+      EntryMap::iterator entry_iter = entries_.find(record.offset);
+      if (entry_iter != entries_.end())
+        RemoveEntry(entry_iter);
+      if (record.flags & kFlashSummaryEntryDeleted)
+        continue;
+      EntryInfo info;
+      info.id = record.offset;
+      info.size = record.size;
+      info.key_hash = record.key_hash;
+      info.last_modified = base::Time::FromInternalValue(record.last_modified);
+      AddEntry(info);
+    }
+  }
+
+  // Continue writing the segment written last.
+  scoped_ptr<Segment> segment;
+  if (!segments.empty()) {
+    const Segment* last = segments.back();
+    write_index_ = last->index();
+    next_sequence_number_ = last->sequence_number() + 1;
+    segment.reset(new Segment(write_index_, false, &storage_));
+    if (!segment->InitForAppend())
+      return false;
+  } else {
+    write_index_ = 0;
+    segment.reset(new Segment(write_index_, false, &storage_));
+    if (!segment->Init())
+      return false;
+    segment->set_sequence_number(next_sequence_number_++);
+  }
+  segment->set_first_sequence_number(first_sequence_number_);
+  segment->AddUser();
+  open_segments_[write_index_] = segment.release();
+  return true;
+}
+
+bool LogStore::AdvanceWriteSegment(int32 size) {
+  if (!open_segments_[write_index_]->Close())
+    return false;
+
+  open_segments_[write_index_]->ReleaseUser();
+  if (open_segments_[write_index_]->HasNoUsers()) {
+    delete open_segments_[write_index_];
+    open_segments_[write_index_] = NULL;
+  }
+
+  int32 index = GetNextSegmentIndex();
+  if (index == -1) {
+    LOG(WARNING) << "Every segment is in use";
+    return false;
+  }
+  return ReuseSegment(index, size);
+}
+
+bool LogStore::ReuseSegment(int32 index, int32 size) {
+  DCHECK(!InUse(index));
+
+  std::vector<EntryInfo> live_entries;
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    if (it->first / kFlashSegmentSize == index)
+      live_entries.push_back(it->second);
+  }
+
+  int32 live_bytes = segment_live_bytes_[index];
+  bool collect = !live_entries.empty() &&
+      live_bytes <= kFlashSegmentFreeSpace / kGarbageCollectionRatio &&
+      live_bytes + size <= kFlashSegmentFreeSpace &&
+      live_entries.size() < kFlashMaxEntryCount;
+
+  // Read the entries to keep before the segment is overwritten.
+  std::vector<std::vector<char> > live_data;
+  if (collect) {
+    live_data.resize(live_entries.size());
+    for (size_t i = 0; i < live_entries.size(); ++i) {
+      live_data[i].resize(live_entries[i].size);
+      if (live_entries[i].size &&
+          !storage_.Read(&live_data[i][0], live_entries[i].size,
+                         live_entries[i].id)) {
+        live_data[i].clear();
+      }
+    }
+  }
+  for (size_t i = 0; i < live_entries.size(); ++i)
+    RemoveEntry(entries_.find(live_entries[i].id));
+
+  scoped_ptr<Segment> segment(new Segment(index, false, &storage_));
+  if (!segment->Init())
+    return false;
+  segment->set_sequence_number(next_sequence_number_++);
+  segment->set_first_sequence_number(first_sequence_number_);
+
+  for (size_t i = 0; i < live_data.size(); ++i) {
+    EntryInfo info = live_entries[i];
+    if (static_cast<int32>(live_data[i].size()) != info.size)
+      continue;
+
+    info.id = segment->write_offset();
+    if (info.size && !segment->WriteData(&live_data[i][0], info.size))
+      continue;
+    FlashSummaryEntry record;
+    memset(&record, 0, sizeof(record));
+    record.offset = info.id;
+    record.size = info.size;
+    record.key_hash = info.key_hash;
+    record.last_modified = info.last_modified.ToInternalValue();
+    segment->StoreEntry(record);
+    AddEntry(info);
+  }
+
+  segment->AddUser();
+  open_segments_[index] = segment.release();
+  write_index_ = index;
+  return true;
+}
+
+void LogStore::AddEntry(const EntryInfo& info) {
+  if (info.key_hash) {
+    KeyHashMap::iterator it = entry_ids_by_key_hash_.find(info.key_hash);
+    if (it != entry_ids_by_key_hash_.end())
+      RemoveEntry(entries_.find(it->second));
+    entry_ids_by_key_hash_[info.key_hash] = info.id;
+  }
+  entries_[info.id] = info;
+  segment_live_bytes_[info.id / kFlashSegmentSize] += info.size;
+  base::subtle::NoBarrier_Store(&entry_count_,
+                                static_cast<int32>(entries_.size()));
+}
+
+void LogStore::RemoveEntry(EntryMap::iterator entry_iter) {
+  DCHECK(entry_iter != entries_.end());
+  const EntryInfo& info = entry_iter->second;
+  if (info.key_hash) {
+    KeyHashMap::iterator it = entry_ids_by_key_hash_.find(info.key_hash);
+    if (it != entry_ids_by_key_hash_.end() && it->second == info.id)
+      entry_ids_by_key_hash_.erase(it);
+  }
+  segment_live_bytes_[info.id / kFlashSegmentSize] -= info.size;
+  entries_.erase(entry_iter);
+  base::subtle::NoBarrier_Store(&entry_count_,
+                                static_cast<int32>(entries_.size()));
+}
+
 int32 LogStore::GetNextSegmentIndex() {
   DCHECK(init_ && !closed_);
   int32 next_index = (write_index_ + 1) % num_segments_;
 
   while (InUse(next_index)) {
     next_index = (next_index + 1) % num_segments_;
-    DCHECK_NE(next_index, write_index_);
+    if (next_index == write_index_)
+      return -1;
   }
   return next_index;
 }
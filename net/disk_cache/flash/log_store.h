@@ -8,8 +8,11 @@
 #include <set>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/gtest_prod_util.h"
+#include "base/time/time.h"
 #include "net/base/net_export.h"
 #include "net/disk_cache/flash/storage.h"
 
@@ -22,8 +25,25 @@ class Segment;
 // i.e. it's not possible to overwrite data in place.  In order to update an
 // entry, a new version must be written.  Only one entry can be written to at
 // any given time, while concurrent reading of multiple entries is supported.
+//
+// The store keeps an index of its live entries in memory, which Init()
+// rebuilds from the segment summaries.  Segments are reused in FIFO order once
+// the log wraps around.  The live entries of the segment about to be reused
+// are evicted, unless they take up little enough space to be garbage collected
+// instead, i.e. written again at the start of the reused segment under new
+// ids.
 class NET_EXPORT_PRIVATE LogStore {
  public:
+  // What the store knows about a live entry.
+  struct EntryInfo {
+    EntryInfo();
+
+    int32 id;
+    int32 size;
+    uint64 key_hash;
+    base::Time last_modified;
+  };
+
   LogStore(const base::FilePath& path, int32 size);
   ~LogStore();
 
@@ -35,13 +55,22 @@ class NET_EXPORT_PRIVATE LogStore {
   bool Close();
 
   // Creates an entry of |size| bytes.  The id of the created entry is stored in
-  // |entry_id|.
+  // |entry_id|.  The entry has no key hash, so it cannot be found with
+  // FindEntry().
   bool CreateEntry(int32 size, int32* entry_id);
 
-  // Deletes |entry_id|; the client should keep track of |size| and provide it
-  // here.  Only inactive (i.e. not currently open or being created) entries can
-  // be deleted.
-  void DeleteEntry(int32 entry_id, int32 size);
+  // Creates an entry of |size| bytes for the key with hash |key_hash|.  Once the
+  // entry is written and closed, it replaces any live entry with the same key
+  // hash.
+  bool CreateEntry(int32 size, uint64 key_hash, base::Time last_modified,
+                   int32* entry_id);
+
+  // Deletes |entry_id|.  An entry that is open can still be read until it is
+  // closed.  Deleting an entry that is not live is a no-op.
+  void DeleteEntry(int32 entry_id);
+
+  // Deletes every entry in the store.
+  bool DeleteAllEntries();
 
   // Appends data to the end of the last created entry.
   bool WriteData(const void* buffer, int32 size);
@@ -54,15 +83,50 @@ class NET_EXPORT_PRIVATE LogStore {
   bool ReadData(int32 entry_id, void* buffer, int32 size, int32 offset) const;
 
   // Closes an entry that was either opened with OpenEntry or created with
-  // CreateEntry.
+  // CreateEntry.  A created entry becomes live only if all of its |size| bytes
+  // were written.
   void CloseEntry(int32 id);
 
+  // Looks up the live entry with key hash |key_hash|.
+  bool FindEntry(uint64 key_hash, int32* entry_id) const;
+
+  bool GetEntryInfo(int32 entry_id, EntryInfo* info) const;
+
+  // Appends all the live entries to |entries|.
+  void GetEntries(std::vector<EntryInfo>* entries) const;
+
+  // Returns the number of live entries.  Unlike the rest of the class, this can
+  // be called from any thread.
+  int32 GetEntryCount() const;
+
  private:
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreReadFromClosedSegment);
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreSegmentSelectionIsFifo);
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreInUseSegmentIsSkipped);
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreReadFromCurrentAfterClose);
+  FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreResumesAfterReopen);
+  FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreEvictsOldestSegment);
+  FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreCollectsMostlyDeadSegment);
+
+  typedef base::hash_map<int32, EntryInfo> EntryMap;
+  typedef base::hash_map<uint64, int32> KeyHashMap;
 
+  // Rebuilds the index from the summaries of all the segments and opens the
+  // segment written last for appending.
+  bool LoadSegments();
+
+  // Closes the segment being written and starts writing the next one, which
+  // is left with room for an entry of |size| bytes.
+  bool AdvanceWriteSegment(int32 size);
+
+  // Evicts or garbage collects the live entries of the segment |index| and
+  // starts writing it.
+  bool ReuseSegment(int32 index, int32 size);
+
+  void AddEntry(const EntryInfo& info);
+  void RemoveEntry(EntryMap::iterator entry_iter);
+
+  // Returns -1 if every other segment is in use.
   int32 GetNextSegmentIndex();
   bool InUse(int32 segment_index) const;
 
@@ -78,6 +142,14 @@ class NET_EXPORT_PRIVATE LogStore {
   // |open_segments_| vector.
   int32 write_index_;
 
+  // Sequence number of the next segment to be written.
+  int64 next_sequence_number_;
+
+  // Segments with a lower sequence number were written before the store was
+  // last cleared.  Stored in every summary, so that it outlives the segment
+  // that cleared the store.
+  int64 first_sequence_number_;
+
   // Ids of entries currently open, either CreatEntry'ed or OpenEntry'ed.
   std::set<int32> open_entries_;
 
@@ -85,11 +157,23 @@ class NET_EXPORT_PRIVATE LogStore {
   // currently being written to.
   int32 current_entry_id_;
 
+  // The entry identified by |current_entry_id_|, which is added to the index
+  // when it is closed.
+  EntryInfo current_entry_;
+
   // Number of bytes left to be written to the entry identified by
   // |current_entry_id_|.  Its value makes sense iff |current_entry_id_| is not
   // -1.
   int32 current_entry_num_bytes_left_to_write_;
 
+  // The index of live entries.
+  EntryMap entries_;
+  KeyHashMap entry_ids_by_key_hash_;
+  base::subtle::Atomic32 entry_count_;
+
+  // Number of bytes taken by live entries in each segment.
+  std::vector<int32> segment_live_bytes_;
+
   bool init_;  // Init was called.
   bool closed_;  // Close was called.
 
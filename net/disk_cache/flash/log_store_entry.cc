@@ -2,7 +2,12 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "base/logging.h"
+#include "base/time/time.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/flash/format.h"
@@ -12,12 +17,24 @@
 namespace disk_cache {
 
 LogStoreEntry::LogStoreEntry(LogStore* store)
-    : store_(store), id_(-1), init_(false), closed_(false), deleted_(false) {
+    : store_(store),
+      id_(-1),
+      key_hash_(0),
+      replaced_id_(-1),
+      init_(false),
+      closed_(false),
+      deleted_(false) {
   DCHECK(store);
 }
 
 LogStoreEntry::LogStoreEntry(LogStore* store, int32 id)
-    : store_(store), id_(id), init_(false), closed_(false), deleted_(false) {
+    : store_(store),
+      id_(id),
+      key_hash_(0),
+      replaced_id_(-1),
+      init_(false),
+      closed_(false),
+      deleted_(false) {
   DCHECK(store);
 }
 
@@ -36,16 +53,26 @@ bool LogStoreEntry::Init() {
   COMPILE_ASSERT(sizeof(stream_sizes) == kFlashLogStoreEntryHeaderSize,
                  invalid_log_store_entry_header_size);
 
-  if (!store_->OpenEntry(id_) ||
+  if (!store_->OpenEntry(id_))
+    return false;
+  LogStore::EntryInfo info;
+  if (!store_->GetEntryInfo(id_, &info) ||
       !store_->ReadData(id_, stream_sizes, kFlashLogStoreEntryHeaderSize, 0)) {
+    store_->CloseEntry(id_);
     return false;
   }
   for (int i = 0, offset = kFlashLogStoreEntryHeaderSize;
        i < kFlashLogStoreEntryNumStreams; ++i) {
+    if (stream_sizes[i] < 0 || stream_sizes[i] > info.size - offset) {
+      LOG(WARNING) << "Corrupt header of entry " << id_;
+      store_->CloseEntry(id_);
+      return false;
+    }
     streams_[i].offset = offset;
     streams_[i].size = stream_sizes[i];
     offset += stream_sizes[i];
   }
+  key_hash_ = info.key_hash;
   init_ = true;
   return true;
 }
@@ -53,15 +80,16 @@ bool LogStoreEntry::Init() {
 bool LogStoreEntry::Close() {
   DCHECK(init_ && !closed_);
 
-  if (IsNew()) {
-    closed_ = deleted_ ? true : Save();
-  } else {
+  bool result = true;
+  if (!IsNew()) {
     store_->CloseEntry(id_);
-    if (deleted_)
-      store_->DeleteEntry(id_, Size());
-    closed_ = true;
+  } else if (!deleted_) {
+    result = Save();
+    if (result && replaced_id_ != -1)
+      store_->DeleteEntry(replaced_id_);
   }
-  return closed_;
+  closed_ = true;
+  return result;
 }
 
 int32 LogStoreEntry::id() const {
@@ -97,22 +125,26 @@ int LogStoreEntry::ReadData(int index, int offset, net::IOBuffer* buf,
 }
 
 int LogStoreEntry::WriteData(int index, int offset, net::IOBuffer* buf,
-                             int buf_len) {
+                             int buf_len, bool truncate) {
   DCHECK(init_ && !closed_);
   if (InvalidStream(index))
     return net::ERR_INVALID_ARGUMENT;
 
   DCHECK(offset >= 0 && buf_len >= 0);
   Stream& stream = streams_[index];
-  size_t new_size = static_cast<size_t>(offset + buf_len);
-  if (new_size) {
-    // TODO(agayev): Currently, only append and overwrite is supported.  Add
-    // support for arbitrary writes.
-    DCHECK(!offset || offset == stream.size);
-    if (stream.write_buffer.size() < new_size)
-      stream.write_buffer.resize(new_size);
-    memcpy(&streams_[index].write_buffer[offset], buf->data(), buf_len);
-  }
+  int new_size = offset + buf_len;
+  if (!truncate)
+    new_size = std::max(new_size, stream.size);
+  if (new_size - stream.size > kFlashSegmentFreeSpace - Size())
+    return net::ERR_FAILED;
+  if (!IsNew() && !MakeWritable())
+    return net::ERR_FAILED;
+
+  // Growing the buffer fills a gap left before |offset| with zeros.
+  if (stream.write_buffer.size() != static_cast<size_t>(new_size))
+    stream.write_buffer.resize(new_size);
+  if (buf_len)
+    memcpy(&stream.write_buffer[offset], buf->data(), buf_len);
   stream.size = new_size;
   return buf_len;
 }
@@ -120,6 +152,10 @@ int LogStoreEntry::WriteData(int index, int offset, net::IOBuffer* buf,
 void LogStoreEntry::Delete() {
   DCHECK(init_ && !closed_);
   deleted_ = true;
+  if (!IsNew())
+    store_->DeleteEntry(id_);
+  else if (replaced_id_ != -1)
+    store_->DeleteEntry(replaced_id_);
 }
 
 bool LogStoreEntry::IsNew() const {
@@ -148,17 +184,36 @@ bool LogStoreEntry::Save() {
   for (int i = 0; i < kFlashLogStoreEntryNumStreams; ++i)
     stream_sizes[i] = streams_[i].size;
 
-  if (!store_->CreateEntry(Size(), &id_))
-    return false;
-  if (!store_->WriteData(stream_sizes, kFlashLogStoreEntryHeaderSize))
+  if (!store_->CreateEntry(Size(), key_hash_, base::Time::Now(), &id_))
     return false;
+
+  // An entry that was not written completely is dropped when it is closed.
+  bool result =
+      store_->WriteData(stream_sizes, kFlashLogStoreEntryHeaderSize);
+  for (int i = 0; result && i < kFlashLogStoreEntryNumStreams; ++i) {
+    if (streams_[i].size > 0) {
+      result = store_->WriteData(&streams_[i].write_buffer[0],
+                                 streams_[i].size);
+    }
+  }
+  store_->CloseEntry(id_);
+  return result;
+}
+
+bool LogStoreEntry::MakeWritable() {
+  DCHECK(init_ && !closed_ && !IsNew());
   for (int i = 0; i < kFlashLogStoreEntryNumStreams; ++i) {
-    if (streams_[i].size > 0 &&
-        !store_->WriteData(&streams_[i].write_buffer[0], streams_[i].size)) {
+    Stream& stream = streams_[i];
+    stream.write_buffer.resize(stream.size);
+    if (stream.size &&
+        !store_->ReadData(id_, &stream.write_buffer[0], stream.size,
+                          stream.offset)) {
       return false;
     }
   }
   store_->CloseEntry(id_);
+  replaced_id_ = deleted_ ? -1 : id_;
+  id_ = -1;
   return true;
 }
 
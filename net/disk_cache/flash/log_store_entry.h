@@ -20,6 +20,10 @@ namespace disk_cache {
 
 class LogStore;
 
+// An entry of a LogStore made of kFlashLogStoreEntryNumStreams streams.  A new
+// entry is kept in memory and written to the store when it is closed.  Writing
+// to an existing entry reads it into memory first, and closing it then writes
+// a new version that replaces the old one.
 class NET_EXPORT_PRIVATE LogStoreEntry {
  public:
   explicit LogStoreEntry(LogStore* store);
@@ -33,8 +37,15 @@ class NET_EXPORT_PRIVATE LogStoreEntry {
   bool IsNew() const;
   int32 GetDataSize(int index) const;
 
+  // The key hash the entry is saved with, see LogStore::CreateEntry().
+  void set_key_hash(uint64 key_hash) { key_hash_ = key_hash; }
+
   int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len);
-  int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len);
+  int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
+                bool truncate);
+
+  // Deletes the entry from the store right away.  It can still be read until
+  // it is closed, but is not saved.
   void Delete();
 
  private:
@@ -50,8 +61,16 @@ class NET_EXPORT_PRIVATE LogStoreEntry {
   int32 Size() const;
   bool Save();
 
+  // Reads an existing entry into memory, so that it can be changed.
+  bool MakeWritable();
+
   LogStore* store_;
   int32 id_;
+  uint64 key_hash_;
+
+  // Id of the version of the entry that is replaced when a changed existing
+  // entry is saved, -1 if there is none.
+  int32 replaced_id_;
   Stream streams_[kFlashLogStoreEntryNumStreams];
   bool init_;
   bool closed_;
@@ -2,6 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
+#include "base/time/time.h"
 #include "net/disk_cache/flash/flash_cache_test_base.h"
 #include "net/disk_cache/flash/format.h"
 #include "net/disk_cache/flash/log_store.h"
@@ -10,6 +13,31 @@
 
 namespace disk_cache {
 
+namespace {
+
+// Writes an entry of |size| bytes of |c| and returns its id, or -1.
+int32 WriteEntry(LogStore* log_store, int32 size, uint64 key_hash, char c) {
+  const std::vector<char> data(size, c);
+  int32 id;
+  if (!log_store->CreateEntry(size, key_hash, base::Time::Now(), &id))
+    return -1;
+  bool written = log_store->WriteData(&data[0], size);
+  log_store->CloseEntry(id);
+  return written ? id : -1;
+}
+
+// Returns whether the entry |id| holds |size| bytes of |c|.
+bool EntryHasData(LogStore* log_store, int32 id, int32 size, char c) {
+  if (!log_store->OpenEntry(id))
+    return false;
+  std::vector<char> actual(size, 0);
+  bool read = log_store->ReadData(id, &actual[0], size, 0);
+  log_store->CloseEntry(id);
+  return read && actual == std::vector<char>(size, c);
+}
+
+}  // namespace
+
 TEST_F(FlashCacheTest, LogStoreCreateEntry) {
   LogStore log_store(path_, kStorageSize);
   EXPECT_TRUE(log_store.Init());
@@ -125,7 +153,196 @@ TEST_F(FlashCacheTest, LogStoreReadFromCurrentAfterClose) {
   EXPECT_TRUE(log_store.Close());
 }
 
-// TODO(agayev): Add a test that confirms that in-use segment is not selected as
-// the next write segment.
+TEST_F(FlashCacheTest, LogStoreInUseSegmentIsSkipped) {
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+
+  const int32 kSize = disk_cache::kFlashSegmentFreeSpace;
+  int32 id = WriteEntry(&log_store, kSize, 1, 'a');
+  ASSERT_NE(-1, id);
+  EXPECT_TRUE(log_store.OpenEntry(id));
+
+  for (int32 i = 1; i < kNumTestSegments; ++i) {
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 10 + i, 'b'));
+    EXPECT_EQ(i, log_store.write_index_);
+  }
+
+  // Segment 0 is next, but the open entry keeps it in use.
+  EXPECT_NE(-1, WriteEntry(&log_store, kSize, 2, 'c'));
+  EXPECT_EQ(1, log_store.write_index_);
+
+  int32 found_id;
+  EXPECT_TRUE(log_store.FindEntry(1, &found_id));
+  EXPECT_EQ(id, found_id);
+  log_store.CloseEntry(id);
+  EXPECT_TRUE(log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreResumesAfterReopen) {
+  const int32 kSize = 100;
+  int32 id1;
+  {
+    LogStore log_store(path_, kStorageSize);
+    EXPECT_TRUE(log_store.Init());
+    id1 = WriteEntry(&log_store, kSize, 1, 'a');
+    ASSERT_NE(-1, id1);
+    EXPECT_TRUE(log_store.Close());
+  }
+
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+  EXPECT_EQ(1, log_store.GetEntryCount());
+
+  int32 id;
+  EXPECT_TRUE(log_store.FindEntry(1, &id));
+  EXPECT_EQ(id1, id);
+  LogStore::EntryInfo info;
+  EXPECT_TRUE(log_store.GetEntryInfo(id, &info));
+  EXPECT_EQ(kSize, info.size);
+  EXPECT_TRUE(EntryHasData(&log_store, id, kSize, 'a'));
+
+  // New entries are appended to the same segment.
+  int32 id2 = WriteEntry(&log_store, kSize, 2, 'b');
+  EXPECT_EQ(0, log_store.write_index_);
+  EXPECT_EQ(id1 + kSize, id2);
+  EXPECT_TRUE(EntryHasData(&log_store, id1, kSize, 'a'));
+  EXPECT_TRUE(log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreDeletionSurvivesReopen) {
+  const int32 kSize = 100;
+  {
+    LogStore log_store(path_, kStorageSize);
+    EXPECT_TRUE(log_store.Init());
+    int32 id1 = WriteEntry(&log_store, kSize, 1, 'a');
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 2, 'b'));
+    EXPECT_EQ(2, log_store.GetEntryCount());
+    log_store.DeleteEntry(id1);
+    EXPECT_EQ(1, log_store.GetEntryCount());
+    EXPECT_FALSE(log_store.OpenEntry(id1));
+    EXPECT_TRUE(log_store.Close());
+  }
+
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+  EXPECT_EQ(1, log_store.GetEntryCount());
+  int32 id;
+  EXPECT_FALSE(log_store.FindEntry(1, &id));
+  EXPECT_TRUE(log_store.FindEntry(2, &id));
+  EXPECT_TRUE(EntryHasData(&log_store, id, kSize, 'b'));
+  EXPECT_TRUE(log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreSupersedesEntryWithSameKeyHash) {
+  const int32 kSize = 100;
+  {
+    LogStore log_store(path_, kStorageSize);
+    EXPECT_TRUE(log_store.Init());
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 1, 'a'));
+    int32 id2 = WriteEntry(&log_store, kSize, 1, 'b');
+    EXPECT_EQ(1, log_store.GetEntryCount());
+    int32 id;
+    EXPECT_TRUE(log_store.FindEntry(1, &id));
+    EXPECT_EQ(id2, id);
+    EXPECT_TRUE(log_store.Close());
+  }
+
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+  EXPECT_EQ(1, log_store.GetEntryCount());
+  int32 id;
+  EXPECT_TRUE(log_store.FindEntry(1, &id));
+  EXPECT_TRUE(EntryHasData(&log_store, id, kSize, 'b'));
+  EXPECT_TRUE(log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreDeleteAllEntries) {
+  const int32 kSize = 100;
+  {
+    LogStore log_store(path_, kStorageSize);
+    EXPECT_TRUE(log_store.Init());
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 1, 'a'));
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 2, 'a'));
+    EXPECT_TRUE(log_store.DeleteAllEntries());
+    EXPECT_EQ(0, log_store.GetEntryCount());
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 3, 'b'));
+    EXPECT_TRUE(log_store.Close());
+  }
+
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+  EXPECT_EQ(1, log_store.GetEntryCount());
+  int32 id;
+  EXPECT_FALSE(log_store.FindEntry(1, &id));
+  EXPECT_FALSE(log_store.FindEntry(2, &id));
+  EXPECT_TRUE(log_store.FindEntry(3, &id));
+  EXPECT_TRUE(EntryHasData(&log_store, id, kSize, 'b'));
+  EXPECT_TRUE(log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreEvictsOldestSegment) {
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+
+  const int32 kSize = disk_cache::kFlashSegmentFreeSpace;
+  for (int32 i = 0; i < kNumTestSegments; ++i) {
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 1 + i, 'a'));
+    EXPECT_EQ(i, log_store.write_index_);
+  }
+  EXPECT_EQ(kNumTestSegments, log_store.GetEntryCount());
+
+  // The log wraps around and the entry in segment 0 is evicted.
+  EXPECT_NE(-1, WriteEntry(&log_store, kSize, 100, 'b'));
+  EXPECT_EQ(0, log_store.write_index_);
+  EXPECT_EQ(kNumTestSegments, log_store.GetEntryCount());
+  int32 id;
+  EXPECT_FALSE(log_store.FindEntry(1, &id));
+  EXPECT_TRUE(log_store.FindEntry(2, &id));
+  EXPECT_TRUE(log_store.FindEntry(100, &id));
+  EXPECT_TRUE(log_store.Close());
+
+  // The eviction is not undone by a restart.
+  LogStore reopened_log_store(path_, kStorageSize);
+  EXPECT_TRUE(reopened_log_store.Init());
+  EXPECT_EQ(kNumTestSegments, reopened_log_store.GetEntryCount());
+  EXPECT_FALSE(reopened_log_store.FindEntry(1, &id));
+  EXPECT_TRUE(reopened_log_store.FindEntry(100, &id));
+  EXPECT_TRUE(reopened_log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreCollectsMostlyDeadSegment) {
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+
+  // Segment 0 holds a small live entry and a large deleted one.
+  const int32 kSmallSize = 100;
+  const int32 kSize = disk_cache::kFlashSegmentFreeSpace;
+  EXPECT_NE(-1, WriteEntry(&log_store, kSmallSize, 1, 'a'));
+  int32 dead_id = WriteEntry(&log_store, kSize / 2, 2, 'b');
+  ASSERT_NE(-1, dead_id);
+  log_store.DeleteEntry(dead_id);
+
+  for (int32 i = 1; i < kNumTestSegments; ++i) {
+    EXPECT_NE(-1, WriteEntry(&log_store, kSize, 10 + i, 'c'));
+    EXPECT_EQ(i, log_store.write_index_);
+  }
+
+  // Reusing segment 0 moves the small entry instead of evicting it.
+  int32 new_id = WriteEntry(&log_store, kSize / 2, 3, 'd');
+  EXPECT_EQ(0, log_store.write_index_);
+  int32 id;
+  EXPECT_TRUE(log_store.FindEntry(1, &id));
+  EXPECT_EQ(0, id / disk_cache::kFlashSegmentSize);
+  EXPECT_LT(id, new_id);
+  EXPECT_TRUE(EntryHasData(&log_store, id, kSmallSize, 'a'));
+  EXPECT_FALSE(log_store.FindEntry(2, &id));
+  EXPECT_TRUE(log_store.Close());
+
+  LogStore reopened_log_store(path_, kStorageSize);
+  EXPECT_TRUE(reopened_log_store.Init());
+  EXPECT_TRUE(reopened_log_store.FindEntry(1, &id));
+  EXPECT_TRUE(EntryHasData(&reopened_log_store, id, kSmallSize, 'a'));
+  EXPECT_TRUE(reopened_log_store.Close());
+}
 
 }  // namespace disk_cache
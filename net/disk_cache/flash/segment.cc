@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
 #include <algorithm>
 
 #include "base/logging.h"
@@ -19,7 +21,9 @@ Segment::Segment(int32 index, bool read_only, Storage* storage)
       storage_(storage),
       offset_(index * kFlashSegmentSize),
       summary_offset_(offset_ + kFlashSegmentSize - kFlashSummarySize),
-      write_offset_(offset_) {
+      write_offset_(offset_),
+      sequence_number_(0),
+      first_sequence_number_(0) {
   DCHECK(storage);
   DCHECK(storage->size() % kFlashSegmentSize == 0);
 }
@@ -35,6 +39,16 @@ bool Segment::HaveOffset(int32 offset) const {
   return std::binary_search(offsets_.begin(), offsets_.end(), offset);
 }
 
+void Segment::set_sequence_number(int64 sequence_number) {
+  DCHECK(init_ && !read_only_);
+  sequence_number_ = sequence_number;
+}
+
+void Segment::set_first_sequence_number(int64 first_sequence_number) {
+  DCHECK(init_ && !read_only_);
+  first_sequence_number_ = first_sequence_number;
+}
+
 void Segment::AddUser() {
   DCHECK(init_);
   ++num_users_;
@@ -57,19 +71,33 @@ bool Segment::Init() {
     return false;
 
   if (!read_only_) {
+    FlashSummaryHeader header;
+    memset(&header, 0, sizeof(header));
+    if (!storage_->Write(&header, sizeof(header), summary_offset_))
+      return false;
     init_ = true;
     return true;
   }
 
-  int32 summary[kFlashMaxEntryCount + 1];
-  if (!storage_->Read(summary, kFlashSummarySize, summary_offset_))
+  if (!ReadSummary())
     return false;
+  init_ = true;
+  return true;
+}
 
-  size_t entry_count = summary[0];
-  DCHECK_LE(entry_count, kFlashMaxEntryCount);
+bool Segment::InitForAppend() {
+  DCHECK(!init_ && !read_only_);
 
-  std::vector<int32> tmp(summary + 1, summary + 1 + entry_count);
-  offsets_.swap(tmp);
+  if (offset_ < 0 || offset_ + kFlashSegmentSize > storage_->size())
+    return false;
+  if (!ReadSummary())
+    return false;
+
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const FlashSummaryEntry& entry = entries_[i];
+    if (!(entry.flags & kFlashSummaryEntryDeleted))
+      write_offset_ = std::max(write_offset_, entry.offset + entry.size);
+  }
   init_ = true;
   return true;
 }
@@ -84,9 +112,25 @@ bool Segment::WriteData(const void* buffer, int32 size) {
 }
 
 void Segment::StoreOffset(int32 offset) {
+  FlashSummaryEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.offset = offset;
+  StoreEntry(entry);
+}
+
+void Segment::StoreEntry(const FlashSummaryEntry& entry) {
+  DCHECK(init_ && !read_only_);
+  DCHECK(entries_.size() < kFlashMaxEntryCount);
+  entries_.push_back(entry);
+  if (!(entry.flags & kFlashSummaryEntryDeleted)) {
+    DCHECK(offsets_.empty() || offsets_.back() < entry.offset);
+    offsets_.push_back(entry.offset);
+  }
+}
+
+bool Segment::Flush() {
   DCHECK(init_ && !read_only_);
-  DCHECK(offsets_.size() < kFlashMaxEntryCount);
-  offsets_.push_back(offset);
+  return WriteSummary();
 }
 
 bool Segment::ReadData(void* buffer, int32 size, int32 offset) const {
@@ -100,13 +144,7 @@ bool Segment::Close() {
   if (read_only_)
     return true;
 
-  DCHECK(offsets_.size() <= kFlashMaxEntryCount);
-
-  int32 summary[kFlashMaxEntryCount + 1];
-  memset(summary, 0, kFlashSummarySize);
-  summary[0] = offsets_.size();
-  std::copy(offsets_.begin(), offsets_.end(), summary + 1);
-  if (!storage_->Write(summary, kFlashSummarySize, summary_offset_))
+  if (!WriteSummary())
     return false;
 
   read_only_ = true;
@@ -115,8 +153,76 @@ bool Segment::Close() {
 
 bool Segment::CanHold(int32 size) const {
   DCHECK(init_);
-  return offsets_.size() < kFlashMaxEntryCount &&
+  return entries_.size() < kFlashMaxEntryCount &&
       write_offset_ + size <= summary_offset_;
 }
 
+bool Segment::ReadSummary() {
+  std::vector<char> summary(kFlashSummarySize);
+  if (!storage_->Read(&summary[0], kFlashSummarySize, summary_offset_))
+    return false;
+
+  // A segment that was never closed, or whose summary is not understood, is
+  // treated as empty.
+  FlashSummaryHeader header;
+  memcpy(&header, &summary[0], sizeof(header));
+  if (header.magic != kFlashSummaryMagic ||
+      header.version != kFlashSummaryVersion) {
+    return true;
+  }
+  if (header.entry_count < 0 ||
+      static_cast<size_t>(header.entry_count) > kFlashMaxEntryCount) {
+    LOG(WARNING) << "Corrupt summary of segment " << index_;
+    return true;
+  }
+
+  std::vector<FlashSummaryEntry> entries(header.entry_count);
+  std::vector<int32> offsets;
+  if (!entries.empty()) {
+    memcpy(&entries[0], &summary[sizeof(header)],
+           entries.size() * sizeof(FlashSummaryEntry));
+  }
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const FlashSummaryEntry& entry = entries[i];
+    bool valid;
+    if (entry.flags & kFlashSummaryEntryDeleted) {
+      valid = entry.offset >= 0 && entry.offset < storage_->size();
+    } else {
+      valid = entry.offset >= offset_ && entry.size >= 0 &&
+          entry.offset <= summary_offset_ - entry.size &&
+          (offsets.empty() || offsets.back() < entry.offset);
+      offsets.push_back(entry.offset);
+    }
+    if (!valid) {
+      LOG(WARNING) << "Corrupt summary of segment " << index_;
+      return true;
+    }
+  }
+
+  sequence_number_ = header.sequence_number;
+  first_sequence_number_ = header.first_sequence_number;
+  offsets_.swap(offsets);
+  entries_.swap(entries);
+  return true;
+}
+
+bool Segment::WriteSummary() {
+  DCHECK(entries_.size() <= kFlashMaxEntryCount);
+
+  std::vector<char> summary(kFlashSummarySize, 0);
+  FlashSummaryHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kFlashSummaryMagic;
+  header.version = kFlashSummaryVersion;
+  header.sequence_number = sequence_number_;
+  header.first_sequence_number = first_sequence_number_;
+  header.entry_count = static_cast<int32>(entries_.size());
+  memcpy(&summary[0], &header, sizeof(header));
+  if (!entries_.empty()) {
+    memcpy(&summary[sizeof(header)], &entries_[0],
+           entries_.size() * sizeof(FlashSummaryEntry));
+  }
+  return storage_->Write(&summary[0], kFlashSummarySize, summary_offset_);
+}
+
 }  // namespace disk_cache
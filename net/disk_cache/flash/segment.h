@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
 #include "net/base/net_export.h"
+#include "net/disk_cache/flash/format.h"
 
 namespace disk_cache {
 
@@ -50,8 +51,16 @@ class Storage;
 // provides two calls for interacting with metadata: StoreOffset() and
 // GetOffsets().  The former can be used to store an offset that was returned by
 // write_offset() and the latter can be used to retrieve all the offsets that
-// were stored in the Segment.  Before attempting to write an entry, the client
-// should call CanHold() to make sure that there is enough space in the segment.
+// were stored in the Segment.  StoreEntry() also records what the entry is, so
+// that the client can rebuild its index from the summaries alone, and can
+// record the deletion of an entry stored elsewhere.  Before attempting to write
+// an entry, the client should call CanHold() to make sure that there is enough
+// space in the segment.
+//
+// Initializing a writable segment erases the summary it had, so that a crash
+// while the segment is being rewritten does not bring back its old entries.
+// InitForAppend() instead keeps the entries of a segment closed earlier and
+// continues writing after them.
 //
 // ReadData can be called over the range that was previously written with
 // WriteData.  Reading from area that was not written will fail.
@@ -72,6 +81,16 @@ class NET_EXPORT_PRIVATE Segment {
   bool HaveOffset(int32 offset) const;
   std::vector<int32> GetOffsets() const { return offsets_; }
 
+  // All the records of the summary, in the order they were stored.
+  const std::vector<FlashSummaryEntry>& entries() const { return entries_; }
+
+  // Sequence number stored in the summary; 0 if the segment has no summary.
+  int64 sequence_number() const { return sequence_number_; }
+  void set_sequence_number(int64 sequence_number);
+
+  int64 first_sequence_number() const { return first_sequence_number_; }
+  void set_first_sequence_number(int64 first_sequence_number);
+
   // Manage the number of users of this segment.
   void AddUser();
   void ReleaseUser();
@@ -81,6 +100,10 @@ class NET_EXPORT_PRIVATE Segment {
   // segment and further calls should be made only if it is successful.
   bool Init();
 
+  // Like Init() for a writable segment, but keeps the summary the segment was
+  // closed with and continues writing after its last entry.
+  bool InitForAppend();
+
   // Writes |size| bytes of data from |buffer| to segment, returns false if
   // fails and true if succeeds.  Can block for a long time.
   bool WriteData(const void* buffer, int32 size);
@@ -92,14 +115,25 @@ class NET_EXPORT_PRIVATE Segment {
   // Stores the offset in the metadata.
   void StoreOffset(int32 offset);
 
+  // Stores |entry| in the metadata.  Offsets of entries that are not deleted
+  // must be stored in increasing order.
+  void StoreEntry(const FlashSummaryEntry& entry);
+
+  // Writes the summary out without closing the segment.
+  bool Flush();
+
   // Closes the segment, returns true on success and false on failure.  Closing
   // a segment makes it immutable.
   bool Close();
 
-  // Returns true if segment can accommodate an entry of |size| bytes.
+  // Returns true if segment can accommodate an entry of |size| bytes.  A
+  // |size| of 0 checks for room for a record of a deleted entry.
   bool CanHold(int32 size) const;
 
  private:
+  bool ReadSummary();
+  bool WriteSummary();
+
   int32 index_;
   int32 num_users_;
   bool read_only_;  // Indicates whether the segment can be written to.
@@ -108,7 +142,10 @@ class NET_EXPORT_PRIVATE Segment {
   const int32 offset_;  // Offset of the segment on |storage_|.
   const int32 summary_offset_;  // Offset of the segment summary.
   int32 write_offset_;  // Current write offset.
-  std::vector<int32> offsets_;
+  int64 sequence_number_;
+  int64 first_sequence_number_;
+  std::vector<int32> offsets_;  // Offsets of the entries that are not deleted.
+  std::vector<FlashSummaryEntry> entries_;
 
   DISALLOW_COPY_AND_ASSIGN(Segment);
 };
@@ -27,11 +27,14 @@ BackendIO::BackendIO(InFlightIO* controller, BackendImpl* backend,
       entry_ptr_(NULL),
       iter_ptr_(NULL),
       iter_(NULL),
+      walk_(NULL),
       entry_(NULL),
       index_(0),
       offset_(0),
       buf_len_(0),
       truncate_(false),
+      prefetch_index_(0),
+      prefetch_buf_len_(0),
       offset64_(0),
       start_(NULL) {
   start_time_ = base::TimeTicks::Now();
@@ -115,6 +118,11 @@ void BackendIO::DoomEntriesSince(const base::Time initial_time) {
   initial_time_ = initial_time;
 }
 
+void BackendIO::WalkEntriesBetween(EntryRangeWalk* walk) {
+  operation_ = OP_WALK_ENTRIES;
+  walk_ = walk;
+}
+
 void BackendIO::OpenNextEntry(void** iter, Entry** next_entry) {
   operation_ = OP_OPEN_NEXT;
   iter_ptr_ = iter;
@@ -177,6 +185,22 @@ void BackendIO::WriteData(EntryImpl* entry, int index, int offset,
   truncate_ = truncate;
 }
 
+void BackendIO::ReadDataWithPrefetch(EntryImpl* entry, int index, int offset,
+                                     net::IOBuffer* buf, int buf_len,
+                                     int prefetch_index,
+                                     net::IOBuffer* prefetch_buf,
+                                     int prefetch_buf_len) {
+  operation_ = OP_READ_WITH_PREFETCH;
+  entry_ = entry;
+  index_ = index;
+  offset_ = offset;
+  buf_ = buf;
+  buf_len_ = buf_len;
+  prefetch_index_ = prefetch_index;
+  prefetch_buf_ = prefetch_buf;
+  prefetch_buf_len_ = prefetch_buf_len;
+}
+
 void BackendIO::ReadSparseData(EntryImpl* entry, int64 offset,
                                net::IOBuffer* buf, int buf_len) {
   operation_ = OP_READ_SPARSE;
@@ -249,6 +273,9 @@ void BackendIO::ExecuteBackendOperation() {
     case OP_DOOM_SINCE:
       result_ = backend_->SyncDoomEntriesSince(initial_time_);
       break;
+    case OP_WALK_ENTRIES:
+      result_ = backend_->SyncWalkEntriesBetween(walk_);
+      break;
     case OP_OPEN_NEXT:
       result_ = backend_->SyncOpenNextEntry(iter_ptr_, entry_ptr_);
       break;
@@ -300,6 +327,12 @@ void BackendIO::ExecuteEntryOperation() {
                                 base::Bind(&BackendIO::OnIOComplete, this),
                                 truncate_);
       break;
+    case OP_READ_WITH_PREFETCH:
+      result_ = entry_->ReadDataWithPrefetchImpl(
+                    index_, offset_, buf_.get(), buf_len_, prefetch_index_,
+                    prefetch_buf_.get(), prefetch_buf_len_,
+                    base::Bind(&BackendIO::OnIOComplete, this));
+      break;
     case OP_READ_SPARSE:
       result_ = entry_->ReadSparseDataImpl(
                     offset64_, buf_.get(), buf_len_,
@@ -326,6 +359,7 @@ void BackendIO::ExecuteEntryOperation() {
       result_ = net::ERR_UNEXPECTED;
   }
   buf_ = NULL;
+  prefetch_buf_ = NULL;
   if (result_ != net::ERR_IO_PENDING)
     NotifyController();
 }
@@ -389,6 +423,13 @@ void InFlightBackendIO::DoomEntriesSince(
   PostOperation(operation.get());
 }
 
+void InFlightBackendIO::WalkEntriesBetween(
+    EntryRangeWalk* walk, const net::CompletionCallback& callback) {
+  scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
+  operation->WalkEntriesBetween(walk);
+  PostOperation(operation.get());
+}
+
 void InFlightBackendIO::OpenNextEntry(void** iter, Entry** next_entry,
                                       const net::CompletionCallback& callback) {
   scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
@@ -461,6 +502,17 @@ void InFlightBackendIO::WriteData(EntryImpl* entry, int index, int offset,
   PostOperation(operation.get());
 }
 
+void InFlightBackendIO::ReadDataWithPrefetch(
+    EntryImpl* entry, int index, int offset, net::IOBuffer* buf, int buf_len,
+    int prefetch_index, net::IOBuffer* prefetch_buf, int prefetch_buf_len,
+    const net::CompletionCallback& callback) {
+  scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
+  operation->ReadDataWithPrefetch(entry, index, offset, buf, buf_len,
+                                  prefetch_index, prefetch_buf,
+                                  prefetch_buf_len);
+  PostOperation(operation.get());
+}
+
 void InFlightBackendIO::ReadSparseData(
     EntryImpl* entry, int64 offset, net::IOBuffer* buf, int buf_len,
     const net::CompletionCallback& callback) {
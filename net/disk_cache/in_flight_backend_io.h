@@ -19,6 +19,7 @@ namespace disk_cache {
 class BackendImpl;
 class Entry;
 class EntryImpl;
+struct EntryRangeWalk;
 
 // This class represents a single asynchronous disk cache IO operation while it
 // is being bounced between threads.
@@ -54,6 +55,7 @@ class BackendIO : public BackgroundIO {
   void DoomEntriesBetween(const base::Time initial_time,
                           const base::Time end_time);
   void DoomEntriesSince(const base::Time initial_time);
+  void WalkEntriesBetween(EntryRangeWalk* walk);
   void OpenNextEntry(void** iter, Entry** next_entry);
   void OpenPrevEntry(void** iter, Entry** prev_entry);
   void EndEnumeration(void* iterator);
@@ -66,6 +68,10 @@ class BackendIO : public BackgroundIO {
                 int buf_len);
   void WriteData(EntryImpl* entry, int index, int offset, net::IOBuffer* buf,
                  int buf_len, bool truncate);
+  void ReadDataWithPrefetch(EntryImpl* entry, int index, int offset,
+                            net::IOBuffer* buf, int buf_len,
+                            int prefetch_index, net::IOBuffer* prefetch_buf,
+                            int prefetch_buf_len);
   void ReadSparseData(EntryImpl* entry, int64 offset, net::IOBuffer* buf,
                       int buf_len);
   void WriteSparseData(EntryImpl* entry, int64 offset, net::IOBuffer* buf,
@@ -89,6 +95,7 @@ class BackendIO : public BackgroundIO {
     OP_DOOM_ALL,
     OP_DOOM_BETWEEN,
     OP_DOOM_SINCE,
+    OP_WALK_ENTRIES,
     OP_OPEN_NEXT,
     OP_OPEN_PREV,
     OP_END_ENUMERATION,
@@ -100,6 +107,7 @@ class BackendIO : public BackgroundIO {
     OP_MAX_BACKEND,
     OP_READ,
     OP_WRITE,
+    OP_READ_WITH_PREFETCH,
     OP_READ_SPARSE,
     OP_WRITE_SPARSE,
     OP_GET_RANGE,
@@ -129,12 +137,16 @@ class BackendIO : public BackgroundIO {
   base::Time end_time_;
   void** iter_ptr_;
   void* iter_;
+  EntryRangeWalk* walk_;
   EntryImpl* entry_;
   int index_;
   int offset_;
   scoped_refptr<net::IOBuffer> buf_;
   int buf_len_;
   bool truncate_;
+  int prefetch_index_;
+  scoped_refptr<net::IOBuffer> prefetch_buf_;
+  int prefetch_buf_len_;
   int64 offset64_;
   int64* start_;
   base::TimeTicks start_time_;
@@ -164,6 +176,8 @@ class InFlightBackendIO : public InFlightIO {
                           const net::CompletionCallback& callback);
   void DoomEntriesSince(const base::Time initial_time,
                         const net::CompletionCallback& callback);
+  void WalkEntriesBetween(EntryRangeWalk* walk,
+                          const net::CompletionCallback& callback);
   void OpenNextEntry(void** iter, Entry** next_entry,
                      const net::CompletionCallback& callback);
   void OpenPrevEntry(void** iter, Entry** prev_entry,
@@ -180,6 +194,10 @@ class InFlightBackendIO : public InFlightIO {
   void WriteData(
       EntryImpl* entry, int index, int offset, net::IOBuffer* buf,
       int buf_len, bool truncate, const net::CompletionCallback& callback);
+  void ReadDataWithPrefetch(
+      EntryImpl* entry, int index, int offset, net::IOBuffer* buf,
+      int buf_len, int prefetch_index, net::IOBuffer* prefetch_buf,
+      int prefetch_buf_len, const net::CompletionCallback& callback);
   void ReadSparseData(EntryImpl* entry, int64 offset, net::IOBuffer* buf,
                       int buf_len, const net::CompletionCallback& callback);
   void WriteSparseData(EntryImpl* entry, int64 offset, net::IOBuffer* buf,
@@ -4,6 +4,8 @@
 
 #include "net/disk_cache/mem_backend_impl.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/sys_info.h"
 #include "net/base/net_errors.h"
@@ -180,6 +182,29 @@ int MemBackendImpl::DoomEntriesSince(const base::Time initial_time,
   return net::ERR_FAILED;
 }
 
+int MemBackendImpl::DoomEntriesBetweenWithProgress(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback) {
+  // Everything is in memory, so the entries are doomed in a single batch.
+  const int32 entry_count = GetEntryCount();
+  if (!DoomEntriesBetween(initial_time, end_time))
+    return net::ERR_FAILED;
+
+  if (!progress_callback.is_null())
+    progress_callback.Run(entry_count - GetEntryCount());
+  return net::OK;
+}
+
+int MemBackendImpl::CalculateSizeOfEntriesBetween(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const CompletionCallback& callback) {
+  return static_cast<int>(
+      std::min<int64>(SizeOfEntriesBetween(initial_time, end_time), kint32max));
+}
+
 int MemBackendImpl::OpenNextEntry(void** iter, Entry** next_entry,
                                   const CompletionCallback& callback) {
   if (OpenNextEntry(iter, next_entry))
@@ -287,6 +312,21 @@ bool MemBackendImpl::DoomEntriesSince(const Time initial_time) {
   }
 }
 
+int64 MemBackendImpl::SizeOfEntriesBetween(const Time initial_time,
+                                           const Time end_time) {
+  int64 size = 0;
+  // rankings_ is ordered by last used, as in DoomEntriesBetween().
+  for (MemEntryImpl* node = rankings_.GetNext(NULL); node;
+       node = rankings_.GetNext(node)) {
+    if (node->GetLastUsed() < initial_time)
+      break;
+    if (!end_time.is_null() && node->GetLastUsed() >= end_time)
+      continue;
+    size += node->GetStorageSize();
+  }
+  return size;
+}
+
 bool MemBackendImpl::OpenNextEntry(void** iter, Entry** next_entry) {
   MemEntryImpl* current = reinterpret_cast<MemEntryImpl*>(*iter);
   MemEntryImpl* node = rankings_.GetNext(current);
@@ -76,6 +76,15 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
                                  const CompletionCallback& callback) OVERRIDE;
   virtual int DoomEntriesSince(base::Time initial_time,
                                const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetweenWithProgress(
+      base::Time initial_time,
+      base::Time end_time,
+      const ProgressCallback& progress_callback,
+      const CompletionCallback& callback) OVERRIDE;
+  virtual int CalculateSizeOfEntriesBetween(
+      base::Time initial_time,
+      base::Time end_time,
+      const CompletionCallback& callback) OVERRIDE;
   virtual int OpenNextEntry(void** iter, Entry** next_entry,
                             const CompletionCallback& callback) OVERRIDE;
   virtual void EndEnumeration(void** iter) OVERRIDE;
@@ -96,6 +105,11 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
   bool DoomEntriesSince(const base::Time initial_time);
   bool OpenNextEntry(void** iter, Entry** next_entry);
 
+  // Returns the total size of the entries and child entries last used between
+  // |initial_time| and |end_time|.
+  int64 SizeOfEntriesBetween(const base::Time initial_time,
+                             const base::Time end_time);
+
   // Deletes entries from the cache until the current size is below the limit.
   // If empty is true, the whole cache will be trimmed, regardless of being in
   // use.
@@ -139,6 +139,13 @@ bool MemEntryImpl::InUse() {
   }
 }
 
+int32 MemEntryImpl::GetStorageSize() const {
+  int32 size = static_cast<int32>(key_.size());
+  for (int i = 0; i < NUM_STREAMS; i++)
+    size += data_size_[i];
+  return size;
+}
+
 // ------------------------------------------------------------------------
 
 void MemEntryImpl::Doom() {
@@ -219,6 +226,19 @@ int MemEntryImpl::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
   return result;
 }
 
+int MemEntryImpl::ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                       int buf_len, int prefetch_index,
+                                       IOBuffer* prefetch_buf,
+                                       int prefetch_buf_len,
+                                       const CompletionCallback& callback) {
+  // Reads complete synchronously, so there is nothing to save.
+  int result = ReadData(prefetch_index, 0, prefetch_buf, prefetch_buf_len,
+                        CompletionCallback());
+  if (result < 0)
+    return result;
+  return ReadData(index, offset, buf, buf_len, callback);
+}
+
 int MemEntryImpl::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                                  const CompletionCallback& callback) {
   if (net_log_.IsLoggingAllEvents()) {
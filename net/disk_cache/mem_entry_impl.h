@@ -62,6 +62,10 @@ class MemEntryImpl : public Entry {
   void Open();
   bool InUse();
 
+  // Returns the bytes of the key and data of this entry, as accounted for in
+  // the storage size of the backend.
+  int32 GetStorageSize() const;
+
   MemEntryImpl* next() const {
     return next_;
   }
@@ -98,6 +102,11 @@ class MemEntryImpl : public Entry {
   virtual int WriteData(int index, int offset, IOBuffer* buf, int buf_len,
                         const CompletionCallback& callback,
                         bool truncate) OVERRIDE;
+  virtual int ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                   int buf_len, int prefetch_index,
+                                   IOBuffer* prefetch_buf,
+                                   int prefetch_buf_len,
+                                   const CompletionCallback& callback) OVERRIDE;
   virtual int ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback) OVERRIDE;
   virtual int WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
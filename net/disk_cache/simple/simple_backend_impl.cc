@@ -32,6 +32,7 @@
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_shard_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "net/disk_cache/simple/simple_version_upgrade.h"
@@ -59,6 +60,10 @@ const char kThreadNamePrefix[] = "SimpleCache";
 // Maximum fraction of the cache that one entry can consume.
 const int kMaxFileRatio = 8;
 
+// The number of entries whose files one worker pool task deletes in a mass
+// doom. The batches run in parallel.
+const size_t kDoomBatchSize = 128;
+
 // A global sequenced worker pool to use for launching all tasks.
 SequencedWorkerPool* g_sequenced_worker_pool = NULL;
 
@@ -79,6 +84,14 @@ void MaybeCreateSequencedWorkerPool() {
   }
 }
 
+bool g_pack_small_entries_for_testing = false;
+
+bool ShouldPackSmallEntries() {
+  return g_pack_small_entries_for_testing ||
+         base::FieldTrialList::FindFullName("SimpleCachePackSmallEntries") ==
+             "Enabled";
+}
+
 bool g_fd_limit_histogram_has_been_populated = false;
 
 void MaybeHistogramFdLimit(net::CacheType cache_type) {
@@ -218,12 +231,22 @@ SimpleBackendImpl::~SimpleBackendImpl() {
   index_->WriteToDisk();
 }
 
+// static
+void SimpleBackendImpl::SetPackSmallEntriesForTesting(
+    bool pack_small_entries) {
+  g_pack_small_entries_for_testing = pack_small_entries;
+}
+
 int SimpleBackendImpl::Init(const CompletionCallback& completion_callback) {
   MaybeCreateSequencedWorkerPool();
 
   worker_pool_ = g_sequenced_worker_pool->GetTaskRunnerWithShutdownBehavior(
       SequencedWorkerPool::CONTINUE_ON_SHUTDOWN);
 
+  // Entries packed earlier are still served without packing, and moved back
+  // into files of their own as they are closed.
+  shard_store_ = new SimpleShardStore(path_, ShouldPackSmallEntries());
+
   index_.reset(new SimpleIndex(MessageLoopProxy::current(), this, cache_type_,
                                make_scoped_ptr(new SimpleIndexFile(
                                    cache_thread_.get(), worker_pool_.get(),
@@ -276,6 +299,13 @@ void SimpleBackendImpl::OnDoomComplete(uint64 entry_hash) {
 
 void SimpleBackendImpl::DoomEntries(std::vector<uint64>* entry_hashes,
                                     const net::CompletionCallback& callback) {
+  DoomEntriesWithProgress(entry_hashes, ProgressCallback(), callback);
+}
+
+void SimpleBackendImpl::DoomEntriesWithProgress(
+    std::vector<uint64>* entry_hashes,
+    const ProgressCallback& progress_callback,
+    const net::CompletionCallback& callback) {
   scoped_ptr<std::vector<uint64> >
       mass_doom_entry_hashes(new std::vector<uint64>());
   mass_doom_entry_hashes->swap(*entry_hashes);
@@ -305,9 +335,12 @@ void SimpleBackendImpl::DoomEntries(std::vector<uint64>* entry_hashes,
     mass_doom_entry_hashes->resize(mass_doom_entry_hashes->size() - 1);
   }
 
+  const size_t batch_count = std::max<size_t>(
+      1, (mass_doom_entry_hashes->size() + kDoomBatchSize - 1) /
+             kDoomBatchSize);
   net::CompletionCallback barrier_callback =
-      MakeBarrierCompletionCallback(to_doom_individually_hashes.size() + 1,
-                                    callback);
+      MakeBarrierCompletionCallback(
+          to_doom_individually_hashes.size() + batch_count, callback);
   for (std::vector<uint64>::const_iterator
            it = to_doom_individually_hashes.begin(),
            end = to_doom_individually_hashes.end(); it != end; ++it) {
@@ -324,17 +357,30 @@ void SimpleBackendImpl::DoomEntries(std::vector<uint64>* entry_hashes,
     OnDoomStart(*it);
   }
 
-  // Taking this pointer here avoids undefined behaviour from calling
-  // base::Passed before mass_doom_entry_hashes.get().
-  std::vector<uint64>* mass_doom_entry_hashes_ptr =
-      mass_doom_entry_hashes.get();
-  PostTaskAndReplyWithResult(
-      worker_pool_, FROM_HERE,
-      base::Bind(&SimpleSynchronousEntry::DoomEntrySet,
-                 mass_doom_entry_hashes_ptr, path_),
-      base::Bind(&SimpleBackendImpl::DoomEntriesComplete,
-                 AsWeakPtr(), base::Passed(&mass_doom_entry_hashes),
-                 barrier_callback));
+  // The individual dooms are counted as they start.
+  scoped_refptr<DoomProgress> progress(
+      new DoomProgress(to_doom_individually_hashes.size()));
+  for (size_t i = 0; i < batch_count; ++i) {
+    std::vector<uint64>::const_iterator batch_begin =
+        mass_doom_entry_hashes->begin() +
+        std::min(i * kDoomBatchSize, mass_doom_entry_hashes->size());
+    std::vector<uint64>::const_iterator batch_end =
+        mass_doom_entry_hashes->begin() +
+        std::min((i + 1) * kDoomBatchSize, mass_doom_entry_hashes->size());
+    scoped_ptr<std::vector<uint64> > batch(
+        new std::vector<uint64>(batch_begin, batch_end));
+
+    // Taking this pointer here avoids undefined behaviour from calling
+    // base::Passed before batch.get().
+    std::vector<uint64>* batch_ptr = batch.get();
+    PostTaskAndReplyWithResult(
+        worker_pool_, FROM_HERE,
+        base::Bind(&SimpleSynchronousEntry::DoomEntrySet,
+                   batch_ptr, path_, shard_store_),
+        base::Bind(&SimpleBackendImpl::DoomEntriesComplete,
+                   AsWeakPtr(), base::Passed(&batch), progress,
+                   progress_callback, barrier_callback));
+  }
 }
 
 net::CacheType SimpleBackendImpl::GetCacheType() const {
@@ -418,26 +464,41 @@ int SimpleBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
   return DoomEntriesBetween(Time(), Time(), callback);
 }
 
-void SimpleBackendImpl::IndexReadyForDoom(Time initial_time,
-                                          Time end_time,
-                                          const CompletionCallback& callback,
-                                          int result) {
+void SimpleBackendImpl::IndexReadyForDoom(
+    Time initial_time,
+    Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback,
+    int result) {
   if (result != net::OK) {
     callback.Run(result);
     return;
   }
   scoped_ptr<std::vector<uint64> > removed_key_hashes(
       index_->GetEntriesBetween(initial_time, end_time).release());
-  DoomEntries(removed_key_hashes.get(), callback);
+  DoomEntriesWithProgress(removed_key_hashes.get(), progress_callback,
+                          callback);
+}
+
+void SimpleBackendImpl::IndexReadyForSizeCalculation(
+    Time initial_time,
+    Time end_time,
+    const CompletionCallback& callback,
+    int result) {
+  if (result == net::OK) {
+    result = static_cast<int>(
+        std::min<uint64>(index_->GetSizeBetween(initial_time, end_time),
+                         kint32max));
+  }
+  callback.Run(result);
 }
 
 int SimpleBackendImpl::DoomEntriesBetween(
     const Time initial_time,
     const Time end_time,
     const CompletionCallback& callback) {
-  return index_->ExecuteWhenReady(
-      base::Bind(&SimpleBackendImpl::IndexReadyForDoom, AsWeakPtr(),
-                 initial_time, end_time, callback));
+  return DoomEntriesBetweenWithProgress(initial_time, end_time,
+                                        ProgressCallback(), callback);
 }
 
 int SimpleBackendImpl::DoomEntriesSince(
@@ -446,6 +507,25 @@ int SimpleBackendImpl::DoomEntriesSince(
   return DoomEntriesBetween(initial_time, Time(), callback);
 }
 
+int SimpleBackendImpl::DoomEntriesBetweenWithProgress(
+    const Time initial_time,
+    const Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback) {
+  return index_->ExecuteWhenReady(
+      base::Bind(&SimpleBackendImpl::IndexReadyForDoom, AsWeakPtr(),
+                 initial_time, end_time, progress_callback, callback));
+}
+
+int SimpleBackendImpl::CalculateSizeOfEntriesBetween(
+    const Time initial_time,
+    const Time end_time,
+    const CompletionCallback& callback) {
+  return index_->ExecuteWhenReady(
+      base::Bind(&SimpleBackendImpl::IndexReadyForSizeCalculation, AsWeakPtr(),
+                 initial_time, end_time, callback));
+}
+
 int SimpleBackendImpl::OpenNextEntry(void** iter,
                                      Entry** next_entry,
                                      const CompletionCallback& callback) {
@@ -694,12 +774,17 @@ void SimpleBackendImpl::CheckIterationReturnValue(
 
 void SimpleBackendImpl::DoomEntriesComplete(
     scoped_ptr<std::vector<uint64> > entry_hashes,
+    const scoped_refptr<DoomProgress>& progress,
+    const ProgressCallback& progress_callback,
     const net::CompletionCallback& callback,
     int result) {
   std::for_each(
       entry_hashes->begin(), entry_hashes->end(),
       std::bind1st(std::mem_fun(&SimpleBackendImpl::OnDoomComplete),
                    this));
+  progress->data += entry_hashes->size();
+  if (!progress_callback.is_null())
+    progress_callback.Run(progress->data);
   callback.Run(result);
 }
 
@@ -39,6 +39,7 @@ namespace disk_cache {
 
 class SimpleEntryImpl;
 class SimpleIndex;
+class SimpleShardStore;
 
 class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
     public SimpleIndexDelegate,
@@ -56,6 +57,14 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
 
   base::TaskRunner* worker_pool() { return worker_pool_.get(); }
 
+  // Holds the small entries packed into shard files. Packing new entries is
+  // controlled by the "SimpleCachePackSmallEntries" field trial.
+  SimpleShardStore* shard_store() { return shard_store_.get(); }
+
+  // Enables packing small entries in backends initialized from now on,
+  // regardless of the field trial.
+  static void SetPackSmallEntriesForTesting(bool pack_small_entries);
+
   int Init(const CompletionCallback& completion_callback);
 
   // Sets the maximum size for the total amount of data stored by this instance.
@@ -99,6 +108,15 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
                                  const CompletionCallback& callback) OVERRIDE;
   virtual int DoomEntriesSince(base::Time initial_time,
                                const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetweenWithProgress(
+      base::Time initial_time,
+      base::Time end_time,
+      const ProgressCallback& progress_callback,
+      const CompletionCallback& callback) OVERRIDE;
+  virtual int CalculateSizeOfEntriesBetween(
+      base::Time initial_time,
+      base::Time end_time,
+      const CompletionCallback& callback) OVERRIDE;
   virtual int OpenNextEntry(void** iter, Entry** next_entry,
                             const CompletionCallback& callback) OVERRIDE;
   virtual void EndEnumeration(void** iter) OVERRIDE;
@@ -112,6 +130,9 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   typedef base::Callback<void(base::Time mtime, uint64 max_size, int result)>
       InitializeIndexCallback;
 
+  // The number of entries doomed so far by a DoomEntries() call.
+  typedef base::RefCountedData<int> DoomProgress;
+
   // Return value of InitCacheStructureOnDisk().
   struct DiskStatResult {
     base::Time cache_dir_mtime;
@@ -127,9 +148,24 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   // |end_time|. Invoked when the index is ready.
   void IndexReadyForDoom(base::Time initial_time,
                          base::Time end_time,
+                         const ProgressCallback& progress_callback,
                          const CompletionCallback& callback,
                          int result);
 
+  // Runs |callback| with the size of the entries previously accessed between
+  // |initial_time| and |end_time|. Invoked when the index is ready.
+  void IndexReadyForSizeCalculation(base::Time initial_time,
+                                    base::Time end_time,
+                                    const CompletionCallback& callback,
+                                    int result);
+
+  // Dooms the entries of |entry_hashes|, deleting the files of the entries not
+  // in use in batches that run in parallel on the worker pool.
+  // |progress_callback| may be null.
+  void DoomEntriesWithProgress(std::vector<uint64>* entry_hashes,
+                               const ProgressCallback& progress_callback,
+                               const CompletionCallback& callback);
+
   // Try to create the directory if it doesn't exist. This must run on the IO
   // thread.
   static DiskStatResult InitCacheStructureOnDisk(const base::FilePath& path,
@@ -189,8 +225,10 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
                                  int error_code);
 
   // A callback thunk used by DoomEntries to clear the |entries_pending_doom_|
-  // after a mass doom.
+  // after each batch of a mass doom, and to report the progress.
   void DoomEntriesComplete(scoped_ptr<std::vector<uint64> > entry_hashes,
+                           const scoped_refptr<DoomProgress>& progress,
+                           const ProgressCallback& progress_callback,
                            const CompletionCallback& callback,
                            int result);
 
@@ -199,6 +237,7 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   scoped_ptr<SimpleIndex> index_;
   const scoped_refptr<base::SingleThreadTaskRunner> cache_thread_;
   scoped_refptr<base::TaskRunner> worker_pool_;
+  scoped_refptr<SimpleShardStore> shard_store_;
 
   int orig_max_size_;
   const SimpleEntryImpl::OperationsMode entry_operations_mode_;
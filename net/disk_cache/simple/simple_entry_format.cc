@@ -23,4 +23,14 @@ SimpleFileSparseRangeHeader::SimpleFileSparseRangeHeader() {
   std::memset(this, 0, sizeof(*this));
 }
 
+SimpleShardFileHeader::SimpleShardFileHeader() {
+  // Make hashing repeatable: leave no padding bytes untouched.
+  std::memset(this, 0, sizeof(*this));
+}
+
+SimpleShardRecordHeader::SimpleShardRecordHeader() {
+  // Make hashing repeatable: leave no padding bytes untouched.
+  std::memset(this, 0, sizeof(*this));
+}
+
 }  // namespace disk_cache
@@ -19,6 +19,8 @@ namespace disk_cache {
 const uint64 kSimpleInitialMagicNumber = GG_UINT64_C(0xfcfb6d1ba7725c30);
 const uint64 kSimpleFinalMagicNumber = GG_UINT64_C(0xf4fa6f45970d41d8);
 const uint64 kSimpleSparseRangeMagicNumber = GG_UINT64_C(0xeb97bf016553676b);
+const uint64 kSimpleShardInitialMagicNumber = GG_UINT64_C(0x9d4c35a1e0b2f687);
+const uint64 kSimpleShardRecordMagicNumber = GG_UINT64_C(0x6b1e07c3d25fa914);
 
 // A file containing stream 0 and stream 1 in the Simple cache consists of:
 //   - a SimpleFileHeader.
@@ -33,6 +35,14 @@ const uint64 kSimpleSparseRangeMagicNumber = GG_UINT64_C(0xeb97bf016553676b);
 //   - the key.
 //   - the data.
 //   - at the end, a SimpleFileEOF record.
+// When small entries are packed, the file containing stream 0 and stream 1 is
+// not stored on its own but as a record of a shard file. A shard file consists
+// of:
+//   - a SimpleShardFileHeader.
+//   - any number of records, each a SimpleShardRecordHeader followed by
+//     |size| bytes holding the whole stream 0 and stream 1 file of the entry.
+// The last record of an entry hash wins, and a record of size 0 removes the
+// entry. The record headers double as the index of the shard file.
 static const int kSimpleEntryFileCount = 2;
 static const int kSimpleEntryStreamCount = 3;
 
@@ -68,6 +78,24 @@ struct SimpleFileSparseRangeHeader {
   uint32 data_crc32;
 };
 
+struct SimpleShardFileHeader {
+  SimpleShardFileHeader();
+
+  uint64 initial_magic_number;
+  uint32 version;
+  uint32 unused;
+};
+
+struct SimpleShardRecordHeader {
+  SimpleShardRecordHeader();
+
+  uint64 record_magic_number;
+  uint64 entry_hash;
+  int64 last_modified;
+  uint32 size;
+  uint32 data_crc32;
+};
+
 }  // namespace disk_cache
 
 #endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_FORMAT_H_
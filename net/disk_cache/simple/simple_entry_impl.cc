@@ -13,6 +13,7 @@
 #include "base/callback.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/task_runner.h"
 #include "base/task_runner_util.h"
@@ -24,6 +25,7 @@
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_net_log_parameters.h"
+#include "net/disk_cache/simple/simple_shard_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
@@ -68,6 +70,27 @@ enum HeaderSizeChange {
   HEADER_SIZE_CHANGE_MAX
 };
 
+typedef base::RefCountedData<int> PrefetchResult;
+
+void OnPrefetchComplete(const scoped_refptr<PrefetchResult>& prefetch_result,
+                        int result) {
+  prefetch_result->data = result;
+}
+
+// Completes a read that was queued behind a prefetch of |expected| bytes.
+void OnReadWithPrefetchComplete(
+    const scoped_refptr<PrefetchResult>& prefetch_result,
+    int expected,
+    const net::CompletionCallback& callback,
+    int result) {
+  if (prefetch_result->data != expected) {
+    result = prefetch_result->data < 0 ? prefetch_result->data
+                                       : net::ERR_CACHE_READ_FAILURE;
+  }
+  if (!callback.is_null())
+    callback.Run(result);
+}
+
 void RecordReadResult(net::CacheType cache_type, ReadResult result) {
   SIMPLE_CACHE_UMA(ENUMERATION,
                    "ReadResult", cache_type, result, READ_RESULT_MAX);
@@ -170,6 +193,7 @@ SimpleEntryImpl::SimpleEntryImpl(net::CacheType cache_type,
       cache_type_(cache_type),
       worker_pool_(backend->worker_pool()),
       path_(path),
+      shard_store_(backend->shard_store()),
       entry_hash_(entry_hash),
       use_optimistic_operations_(operations_mode == OPTIMISTIC_OPERATIONS),
       last_used_(Time::Now()),
@@ -463,6 +487,44 @@ int SimpleEntryImpl::WriteData(int stream_index,
   return ret_value;
 }
 
+int SimpleEntryImpl::ReadDataWithPrefetch(int stream_index,
+                                          int offset,
+                                          net::IOBuffer* buf,
+                                          int buf_len,
+                                          int prefetch_stream_index,
+                                          net::IOBuffer* prefetch_buf,
+                                          int prefetch_buf_len,
+                                          const CompletionCallback& callback) {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+
+  if (stream_index < 0 || stream_index >= kSimpleEntryStreamCount ||
+      prefetch_stream_index < 0 ||
+      prefetch_stream_index >= kSimpleEntryStreamCount || buf_len < 0 ||
+      prefetch_buf_len < 0) {
+    RecordReadResult(cache_type_, READ_RESULT_INVALID_ARGUMENT);
+    return net::ERR_INVALID_ARGUMENT;
+  }
+
+  // Both reads are queued back to back, so the prefetch completes first and
+  // the other read, which is served from memory if it is for stream 0, right
+  // after it. That costs a single trip to the worker pool.
+  scoped_refptr<PrefetchResult> prefetch_result(new PrefetchResult);
+  const int expected =
+      std::min(prefetch_buf_len, GetDataSize(prefetch_stream_index));
+  bool alone_in_queue =
+      pending_operations_.size() == 0 && state_ == STATE_READY;
+  pending_operations_.push(SimpleEntryOperation::ReadOperation(
+      this, prefetch_stream_index, 0, prefetch_buf_len, prefetch_buf,
+      base::Bind(&OnPrefetchComplete, prefetch_result), alone_in_queue));
+  pending_operations_.push(SimpleEntryOperation::ReadOperation(
+      this, stream_index, offset, buf_len, buf,
+      base::Bind(&OnReadWithPrefetchComplete, prefetch_result, expected,
+                 callback),
+      false));
+  RunNextOperationIfNeeded();
+  return net::ERR_IO_PENDING;
+}
+
 int SimpleEntryImpl::ReadSparseData(int64 offset,
                                     net::IOBuffer* buf,
                                     int buf_len,
@@ -687,6 +749,7 @@ void SimpleEntryImpl::OpenEntryInternal(bool have_index,
   Closure task = base::Bind(&SimpleSynchronousEntry::OpenEntry,
                             cache_type_,
                             path_,
+                            shard_store_,
                             entry_hash_,
                             have_index,
                             results.get());
@@ -736,6 +799,7 @@ void SimpleEntryImpl::CreateEntryInternal(bool have_index,
   Closure task = base::Bind(&SimpleSynchronousEntry::CreateEntry,
                             cache_type_,
                             path_,
+                            shard_store_,
                             key_,
                             entry_hash_,
                             have_index,
@@ -782,7 +846,8 @@ void SimpleEntryImpl::CloseInternal() {
                    SimpleEntryStat(last_used_, last_modified_, data_size_,
                                    sparse_data_size_),
                    base::Passed(&crc32s_to_write),
-                   stream_0_data_);
+                   stream_0_data_,
+                   doomed_);
     Closure reply = base::Bind(&SimpleEntryImpl::CloseOperationComplete, this);
     synchronous_entry_ = NULL;
     worker_pool_->PostTaskAndReply(FROM_HERE, task, reply);
@@ -1077,7 +1142,8 @@ void SimpleEntryImpl::GetAvailableRangeInternal(
 void SimpleEntryImpl::DoomEntryInternal(const CompletionCallback& callback) {
   PostTaskAndReplyWithResult(
       worker_pool_, FROM_HERE,
-      base::Bind(&SimpleSynchronousEntry::DoomEntry, path_, entry_hash_),
+      base::Bind(&SimpleSynchronousEntry::DoomEntry, path_, shard_store_,
+                 entry_hash_),
       base::Bind(&SimpleEntryImpl::DoomOperationComplete, this, callback,
                  state_));
   state_ = STATE_IO_PENDING;
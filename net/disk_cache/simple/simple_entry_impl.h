@@ -32,6 +32,7 @@ class IOBuffer;
 namespace disk_cache {
 
 class SimpleBackendImpl;
+class SimpleShardStore;
 class SimpleSynchronousEntry;
 class SimpleEntryStat;
 struct SimpleEntryCreationResults;
@@ -88,6 +89,14 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
                         int buf_len,
                         const CompletionCallback& callback,
                         bool truncate) OVERRIDE;
+  virtual int ReadDataWithPrefetch(int stream_index,
+                                   int offset,
+                                   net::IOBuffer* buf,
+                                   int buf_len,
+                                   int prefetch_stream_index,
+                                   net::IOBuffer* prefetch_buf,
+                                   int prefetch_buf_len,
+                                   const CompletionCallback& callback) OVERRIDE;
   virtual int ReadSparseData(int64 offset,
                              net::IOBuffer* buf,
                              int buf_len,
@@ -305,6 +314,7 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
   const net::CacheType cache_type_;
   const scoped_refptr<base::TaskRunner> worker_pool_;
   const base::FilePath path_;
+  const scoped_refptr<SimpleShardStore> shard_store_;
   const uint64 entry_hash_;
   const bool use_optimistic_operations_;
   std::string key_;
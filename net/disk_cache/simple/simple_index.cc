@@ -72,6 +72,19 @@ bool CompareHashesForTimestamp::operator()(uint64 hash1, uint64 hash2) {
   return it1->second.GetLastUsedTime() < it2->second.GetLastUsedTime();
 }
 
+// Widens [|initial_time|, |end_time|) by the precision of the timestamps in the
+// index, making a null |end_time| unbounded.
+void ExtendTimeRange(base::Time* initial_time, base::Time* end_time) {
+  typedef disk_cache::EntryMetadata EntryMetadata;
+  if (!initial_time->is_null())
+    *initial_time -= EntryMetadata::GetLowerEpsilonForTimeComparisons();
+  if (end_time->is_null())
+    *end_time = base::Time::Max();
+  else
+    *end_time += EntryMetadata::GetUpperEpsilonForTimeComparisons();
+  DCHECK(*end_time >= *initial_time);
+}
+
 }  // namespace
 
 namespace disk_cache {
@@ -228,26 +241,44 @@ scoped_ptr<SimpleIndex::HashList> SimpleIndex::GetEntriesBetween(
     base::Time initial_time, base::Time end_time) {
   DCHECK_EQ(true, initialized_);
 
-  if (!initial_time.is_null())
-    initial_time -= EntryMetadata::GetLowerEpsilonForTimeComparisons();
-  if (end_time.is_null())
-    end_time = base::Time::Max();
-  else
-    end_time += EntryMetadata::GetUpperEpsilonForTimeComparisons();
-  const base::Time extended_end_time =
-      end_time.is_null() ? base::Time::Max() : end_time;
-  DCHECK(extended_end_time >= initial_time);
+  ExtendTimeRange(&initial_time, &end_time);
   scoped_ptr<HashList> ret_hashes(new HashList());
   for (EntrySet::iterator it = entries_set_.begin(), end = entries_set_.end();
        it != end; ++it) {
     EntryMetadata& metadata = it->second;
     base::Time entry_time = metadata.GetLastUsedTime();
-    if (initial_time <= entry_time && entry_time < extended_end_time)
+    if (initial_time <= entry_time && entry_time < end_time)
       ret_hashes->push_back(it->first);
   }
   return ret_hashes.Pass();
 }
 
+uint64 SimpleIndex::GetSizeBetween(base::Time initial_time,
+                                   base::Time end_time) const {
+  DCHECK_EQ(true, initialized_);
+
+  ExtendTimeRange(&initial_time, &end_time);
+  uint64 size = 0;
+  for (EntrySet::const_iterator it = entries_set_.begin(),
+           end = entries_set_.end(); it != end; ++it) {
+    base::Time entry_time = it->second.GetLastUsedTime();
+    if (initial_time <= entry_time && entry_time < end_time)
+      size += it->second.GetEntrySize();
+  }
+  return size;
+}
+
+scoped_refptr<SimpleIndexKeySet> SimpleIndex::GetKeySet() {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  if (!key_set_) {
+    key_set_ = new SimpleIndexKeySet();
+    key_set_->Assign(entries_set_);
+    if (initialized_)
+      key_set_->SetInitialized();
+  }
+  return key_set_;
+}
+
 scoped_ptr<SimpleIndex::HashList> SimpleIndex::GetAllHashes() {
   return GetEntriesBetween(base::Time(), base::Time());
 }
@@ -264,6 +295,8 @@ void SimpleIndex::Insert(uint64 entry_hash) {
   // creating the new entry, and then UpdateEntrySize will be called.
   InsertInEntrySet(
       entry_hash, EntryMetadata(base::Time::Now(), 0), &entries_set_);
+  if (key_set_)
+    key_set_->Insert(entry_hash);
   if (!initialized_)
     removed_entries_.erase(entry_hash);
   PostponeWritingToDisk();
@@ -276,6 +309,8 @@ void SimpleIndex::Remove(uint64 entry_hash) {
     UpdateEntryIteratorSize(&it, 0);
     entries_set_.erase(it);
   }
+  if (key_set_)
+    key_set_->Remove(entry_hash);
 
   if (!initialized_)
     removed_entries_.insert(entry_hash);
@@ -412,7 +447,7 @@ void SimpleIndex::MergeInitializingSet(
 
   EntrySet* index_file_entries = &load_result->entries;
 
-  for (base::hash_set<uint64>::const_iterator it = removed_entries_.begin();
+  for (base::FlatHashSet<uint64>::const_iterator it = removed_entries_.begin();
        it != removed_entries_.end(); ++it) {
     index_file_entries->erase(*it);
   }
@@ -437,6 +472,10 @@ void SimpleIndex::MergeInitializingSet(
   entries_set_.swap(*index_file_entries);
   cache_size_ = merged_cache_size;
   initialized_ = true;
+  if (key_set_) {
+    key_set_->Assign(entries_set_);
+    key_set_->SetInitialized();
+  }
 
   // The actual IO is asynchronous, so calling WriteToDisk() shouldn't slow the
   // merge down much.
@@ -470,6 +509,51 @@ void SimpleIndex::OnActivityStateChange(
 }
 #endif
 
+SimpleIndexKeySet::SimpleIndexKeySet() : initialized_(0) {
+}
+
+SimpleIndexKeySet::~SimpleIndexKeySet() {
+}
+
+bool SimpleIndexKeySet::Has(uint64 entry_hash) const {
+  if (!base::subtle::Acquire_Load(&initialized_))
+    return true;
+  const Shard* shard = GetShard(entry_hash);
+  base::AutoLock auto_lock(shard->lock);
+  return shard->hashes.count(entry_hash) > 0;
+}
+
+void SimpleIndexKeySet::Insert(uint64 entry_hash) {
+  Shard* shard = GetShard(entry_hash);
+  base::AutoLock auto_lock(shard->lock);
+  shard->hashes.insert(entry_hash);
+}
+
+void SimpleIndexKeySet::Remove(uint64 entry_hash) {
+  Shard* shard = GetShard(entry_hash);
+  base::AutoLock auto_lock(shard->lock);
+  shard->hashes.erase(entry_hash);
+}
+
+void SimpleIndexKeySet::Assign(const SimpleIndex::EntrySet& entries) {
+  // Build the new shards without holding any lock, then swap them in.
+  base::FlatHashSet<uint64> new_hashes[kShardCount];
+  for (size_t i = 0; i < kShardCount; ++i)
+    new_hashes[i].reserve(entries.size() / kShardCount);
+  for (SimpleIndex::EntrySet::const_iterator it = entries.begin();
+       it != entries.end(); ++it) {
+    new_hashes[it->first % kShardCount].insert(it->first);
+  }
+  for (size_t i = 0; i < kShardCount; ++i) {
+    base::AutoLock auto_lock(shards_[i].lock);
+    shards_[i].hashes.swap(new_hashes[i]);
+  }
+}
+
+void SimpleIndexKeySet::SetInitialized() {
+  base::subtle::Release_Store(&initialized_, 1);
+}
+
 void SimpleIndex::WriteToDisk() {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   if (!initialized_)
@@ -8,15 +8,18 @@
 #include <list>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/basictypes.h"
 #include "base/callback.h"
-#include "base/containers/hash_tables.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/containers/flat_hash_set.h"
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/single_thread_task_runner.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
@@ -35,6 +38,7 @@ namespace disk_cache {
 
 class SimpleIndexDelegate;
 class SimpleIndexFile;
+class SimpleIndexKeySet;
 struct SimpleIndexLoadResult;
 
 class NET_EXPORT_PRIVATE EntryMetadata {
@@ -106,7 +110,9 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // entry.
   bool UpdateEntrySize(uint64 entry_hash, int entry_size);
 
-  typedef base::hash_map<uint64, EntryMetadata> EntrySet;
+  // Entries are stored inline in an open-addressing table, 16 bytes per slot
+  // plus a control byte, rather than in one allocated node per entry.
+  typedef base::FlatHashMap<uint64, EntryMetadata> EntrySet;
 
   static void InsertInEntrySet(uint64 entry_hash,
                                const EntryMetadata& entry_metadata,
@@ -122,6 +128,9 @@ class NET_EXPORT_PRIVATE SimpleIndex
   scoped_ptr<HashList> GetEntriesBetween(const base::Time initial_time,
                                          const base::Time end_time);
 
+  // Returns the total size of the entries GetEntriesBetween() would return.
+  uint64 GetSizeBetween(base::Time initial_time, base::Time end_time) const;
+
   // Returns the list of all entries key hash.
   scoped_ptr<HashList> GetAllHashes();
 
@@ -131,6 +140,11 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // Returns whether the index has been initialized yet.
   bool initialized() const { return initialized_; }
 
+  // Returns a set of the entry hashes that other threads can query without
+  // posting to the IO thread. It is created on the first call and then kept
+  // up to date by the index, so it costs memory only if someone asks for it.
+  scoped_refptr<SimpleIndexKeySet> GetKeySet();
+
  private:
   friend class SimpleIndexTest;
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, IndexSizeCorrectOnMerge);
@@ -169,9 +183,12 @@ class NET_EXPORT_PRIVATE SimpleIndex
 
   // This stores all the entry_hash of entries that are removed during
   // initialization.
-  base::hash_set<uint64> removed_entries_;
+  base::FlatHashSet<uint64> removed_entries_;
   bool initialized_;
 
+  // NULL until GetKeySet() is called.
+  scoped_refptr<SimpleIndexKeySet> key_set_;
+
   scoped_ptr<SimpleIndexFile> index_file_;
 
   scoped_refptr<base::SingleThreadTaskRunner> io_thread_;
@@ -203,6 +220,54 @@ class NET_EXPORT_PRIVATE SimpleIndex
   int background_flush_delay_;
 };
 
+// A thread-safe copy of the entry hashes of a SimpleIndex, answering whether
+// an entry may exist from any thread. Only the SimpleIndex that created it
+// modifies it, on the IO thread. The hashes are split over shards with a lock
+// each, so that lookups from several threads rarely contend with each other or
+// with the IO thread.
+class NET_EXPORT_PRIVATE SimpleIndexKeySet
+    : public base::RefCountedThreadSafe<SimpleIndexKeySet> {
+ public:
+  SimpleIndexKeySet();
+
+  // May be called on any thread. Like SimpleIndex::Has(), returns true for
+  // every hash until the index is initialized.
+  bool Has(uint64 entry_hash) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<SimpleIndexKeySet>;
+  friend class SimpleIndex;
+
+  static const size_t kShardCount = 16;
+
+  struct Shard {
+    mutable base::Lock lock;
+    base::FlatHashSet<uint64> hashes;
+  };
+
+  ~SimpleIndexKeySet();
+
+  Shard* GetShard(uint64 entry_hash) {
+    return &shards_[entry_hash % kShardCount];
+  }
+  const Shard* GetShard(uint64 entry_hash) const {
+    return &shards_[entry_hash % kShardCount];
+  }
+
+  void Insert(uint64 entry_hash);
+  void Remove(uint64 entry_hash);
+
+  // Replaces the contents with the hashes of |entries|.
+  void Assign(const SimpleIndex::EntrySet& entries);
+
+  void SetInitialized();
+
+  Shard shards_[kShardCount];
+  base::subtle::Atomic32 initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleIndexKeySet);
+};
+
 }  // namespace disk_cache
 
 #endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_H_
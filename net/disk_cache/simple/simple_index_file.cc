@@ -4,20 +4,26 @@
 
 #include "net/disk_cache/simple/simple_index_file.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "base/file_util.h"
 #include "base/files/memory_mapped_file.h"
 #include "base/hash.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
 #include "base/pickle.h"
 #include "base/single_thread_task_runner.h"
 #include "base/task_runner_util.h"
+#include "base/threading/simple_thread.h"
 #include "base/threading/thread_restrictions.h"
 #include "net/disk_cache/simple/simple_backend_version.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_shard_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
@@ -75,8 +81,26 @@ bool WritePickleFile(Pickle* pickle, const base::FilePath& file_name) {
   return true;
 }
 
-// Called for each cache directory traversal iteration.
-void ProcessEntryFile(SimpleIndex::EntrySet* entries,
+// An entry file found by the directory traversal, along with the entry hash
+// parsed from its name. The name is kept in place of a FilePath to keep the
+// list small for caches with hundreds of thousands of files.
+struct EntryFile {
+  uint64 hash_key;
+  char file_name[kEntryFilesHashLength + kEntryFilesSuffixLength];
+};
+
+typedef std::vector<EntryFile> EntryFiles;
+
+// The directory scan stats the entry files on up to this many threads, each
+// handling at least kMinEntryFilesPerRestoreThread files. On spinning disks
+// keeping several stat() calls in flight lets the I/O scheduler order the
+// seeks; small caches are not worth the threads.
+const size_t kMaxRestoreThreads = 4;
+const size_t kMinEntryFilesPerRestoreThread = 2000;
+
+// Called for each cache directory traversal iteration. Files of the same entry
+// go to the same shard, so merging the shards never finds a key twice.
+void CollectEntryFile(std::vector<EntryFiles>* shards,
                       const base::FilePath& file_path) {
   static const size_t kEntryFilesLength =
       kEntryFilesHashLength + kEntryFilesSuffixLength;
@@ -95,6 +119,18 @@ void ProcessEntryFile(SimpleIndex::EntrySet* entries,
     return;
   }
 
+  EntryFile entry_file;
+  entry_file.hash_key = hash_key;
+  memcpy(entry_file.file_name, file_name.data(), kEntryFilesLength);
+  (*shards)[hash_key % shards->size()].push_back(entry_file);
+}
+
+// Stats |entry_file| in |cache_directory| and adds it to |entries|.
+void ProcessEntryFile(const base::FilePath& cache_directory,
+                      const EntryFile& entry_file,
+                      SimpleIndex::EntrySet* entries) {
+  const base::FilePath file_path = cache_directory.AppendASCII(
+      std::string(entry_file.file_name, sizeof(entry_file.file_name)));
   base::File::Info file_info;
   if (!base::GetFileInfo(file_path, &file_info)) {
     LOG(ERROR) << "Could not get file info for " << file_path.value();
@@ -110,10 +146,10 @@ void ProcessEntryFile(SimpleIndex::EntrySet* entries,
     last_used_time = file_info.last_modified;
 
   int64 file_size = file_info.size;
-  SimpleIndex::EntrySet::iterator it = entries->find(hash_key);
+  SimpleIndex::EntrySet::iterator it = entries->find(entry_file.hash_key);
   if (it == entries->end()) {
     SimpleIndex::InsertInEntrySet(
-        hash_key,
+        entry_file.hash_key,
         EntryMetadata(last_used_time, file_size),
         entries);
   } else {
@@ -122,6 +158,29 @@ void ProcessEntryFile(SimpleIndex::EntrySet* entries,
   }
 }
 
+// Builds the partial EntrySet of one shard of the entry files.
+class RestoreShardDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  RestoreShardDelegate(const base::FilePath& cache_directory,
+                       const EntryFiles* entry_files)
+      : cache_directory_(cache_directory),
+        entry_files_(entry_files) {}
+
+  virtual void Run() OVERRIDE {
+    for (size_t i = 0; i < entry_files_->size(); ++i)
+      ProcessEntryFile(cache_directory_, (*entry_files_)[i], &entries_);
+  }
+
+  SimpleIndex::EntrySet* entries() { return &entries_; }
+
+ private:
+  const base::FilePath cache_directory_;
+  const EntryFiles* const entry_files_;
+  SimpleIndex::EntrySet entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(RestoreShardDelegate);
+};
+
 }  // namespace
 
 SimpleIndexLoadResult::SimpleIndexLoadResult() : did_load(false),
@@ -401,10 +460,7 @@ void SimpleIndexFile::Deserialize(const char* data, int data_len,
     return;
   }
 
-#if !defined(OS_WIN)
-  // TODO(gavinp): Consider using std::unordered_map.
-  entries->resize(index_metadata.GetNumberOfEntries() + kExtraSizeForMerge);
-#endif
+  entries->reserve(index_metadata.GetNumberOfEntries() + kExtraSizeForMerge);
   while (entries->size() < index_metadata.GetNumberOfEntries()) {
     uint64 hash_key;
     EntryMetadata entry_metadata;
@@ -438,12 +494,75 @@ void SimpleIndexFile::SyncRestoreFromDisk(
   out_result->Reset();
   SimpleIndex::EntrySet* entries = &out_result->entries;
 
+  // Listing the directory is cheap next to stat()ing every file in it, so the
+  // listing is done here and only the stat() calls are spread over threads.
+  std::vector<EntryFiles> shards(kMaxRestoreThreads);
   const bool did_succeed = TraverseCacheDirectory(
-      cache_directory, base::Bind(&ProcessEntryFile, entries));
+      cache_directory, base::Bind(&CollectEntryFile, &shards));
   if (!did_succeed) {
     LOG(ERROR) << "Could not reconstruct index from disk";
     return;
   }
+
+  size_t entry_file_count = 0;
+  for (size_t i = 0; i < shards.size(); ++i)
+    entry_file_count += shards[i].size();
+  const size_t thread_count = std::max<size_t>(
+      1, std::min(kMaxRestoreThreads,
+                  entry_file_count / kMinEntryFilesPerRestoreThread));
+
+  if (thread_count == 1) {
+    for (size_t i = 0; i < shards.size(); ++i) {
+      for (size_t j = 0; j < shards[i].size(); ++j)
+        ProcessEntryFile(cache_directory, shards[i][j], entries);
+    }
+  } else {
+    // Shards beyond |thread_count| are folded into the first ones.
+    for (size_t i = thread_count; i < shards.size(); ++i) {
+      EntryFiles* target = &shards[i % thread_count];
+      target->insert(target->end(), shards[i].begin(), shards[i].end());
+      EntryFiles().swap(shards[i]);
+    }
+
+    // The current thread handles the first shard itself.
+    ScopedVector<RestoreShardDelegate> delegates;
+    ScopedVector<base::DelegateSimpleThread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+      delegates.push_back(
+          new RestoreShardDelegate(cache_directory, &shards[i]));
+    }
+    for (size_t i = 1; i < thread_count; ++i) {
+      threads.push_back(new base::DelegateSimpleThread(
+          delegates[i], "SimpleCacheIndexRestore"));
+      threads.back()->Start();
+    }
+    delegates[0]->Run();
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i]->Join();
+
+    entries->swap(*delegates[0]->entries());
+    for (size_t i = 1; i < delegates.size(); ++i) {
+      const SimpleIndex::EntrySet& shard_entries = *delegates[i]->entries();
+      entries->insert(shard_entries.begin(), shard_entries.end());
+    }
+  }
+
+  // Packed entries have no files of their own. The shard file names are not
+  // entry file names, so the traversal above skipped them.
+  std::vector<SimpleShardStore::EntryInfo> packed_entries;
+  SimpleShardStore::GetEntries(cache_directory, &packed_entries);
+  for (size_t i = 0; i < packed_entries.size(); ++i) {
+    const SimpleShardStore::EntryInfo& info = packed_entries[i];
+    SimpleIndex::EntrySet::iterator it = entries->find(info.entry_hash);
+    if (it == entries->end()) {
+      SimpleIndex::InsertInEntrySet(
+          info.entry_hash, EntryMetadata(info.last_modified, info.size),
+          entries);
+    } else {
+      it->second.SetEntrySize(it->second.GetEntrySize() + info.size);
+    }
+  }
+
   out_result->did_load = true;
   // When we restore from disk we write the merged index file to disk right
   // away, this might save us from having to restore again next time.
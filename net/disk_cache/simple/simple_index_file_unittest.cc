@@ -263,6 +263,47 @@ TEST_F(SimpleIndexFileTest, LoadCorruptIndex) {
   EXPECT_TRUE(load_index_result.flush_required);
 }
 
+// Tests that restoring from a directory large enough to be scanned on several
+// threads finds every entry once, with the sizes of all its files summed.
+TEST_F(SimpleIndexFileTest, RestoreFromDisk) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+
+  const int kNumEntries = 5000;
+  const std::string kData = "0123456789";
+  for (int i = 0; i < kNumEntries; ++i) {
+    const std::string hash_string = simple_util::ConvertEntryHashKeyToHexString(
+        static_cast<uint64>(i) * GG_UINT64_C(0x9e3779b97f4a7c15));
+    ASSERT_EQ(1, file_util::WriteFile(
+        cache_dir.path().AppendASCII(hash_string + "_0"), kData.data(), 1));
+    ASSERT_EQ(2, file_util::WriteFile(
+        cache_dir.path().AppendASCII(hash_string + "_1"), kData.data(), 2));
+  }
+  const std::string kJunkName = "not_an_entry_file";
+  ASSERT_EQ(static_cast<int>(kData.size()), file_util::WriteFile(
+      cache_dir.path().AppendASCII(kJunkName), kData.data(), kData.size()));
+
+  WrappedSimpleIndexFile simple_index_file(cache_dir.path());
+  SimpleIndexLoadResult load_index_result;
+  simple_index_file.LoadIndexEntries(base::Time(),
+                                     GetCallback(),
+                                     &load_index_result);
+  base::RunLoop().RunUntilIdle();
+
+  ASSERT_TRUE(callback_called());
+  EXPECT_TRUE(load_index_result.did_load);
+  EXPECT_TRUE(load_index_result.flush_required);
+  ASSERT_EQ(static_cast<size_t>(kNumEntries),
+            load_index_result.entries.size());
+  for (int i = 0; i < kNumEntries; ++i) {
+    SimpleIndex::EntrySet::const_iterator it =
+        load_index_result.entries.find(
+            static_cast<uint64>(i) * GG_UINT64_C(0x9e3779b97f4a7c15));
+    ASSERT_TRUE(it != load_index_result.entries.end());
+    EXPECT_EQ(3, it->second.GetEntrySize());
+  }
+}
+
 // Tests that after an upgrade the backend has the index file put in place.
 TEST_F(SimpleIndexFileTest, SimpleCacheUpgrade) {
   base::ScopedTempDir cache_dir;
@@ -273,6 +273,42 @@ TEST_F(SimpleIndexTest, Has) {
   index()->Remove(kHash1);
 }
 
+TEST_F(SimpleIndexTest, KeySet) {
+  const uint64 kHash1 = hashes_.at<1>();
+  const uint64 kHash2 = hashes_.at<2>();
+  const uint64 kHash3 = hashes_.at<3>();
+  InsertIntoIndexFileReturn(kHash2, base::Time::Now(), 10);
+
+  // Like Has(), the key set answers true for everything until the index is
+  // initialized.
+  scoped_refptr<SimpleIndexKeySet> key_set = index()->GetKeySet();
+  EXPECT_EQ(key_set.get(), index()->GetKeySet().get());
+  EXPECT_TRUE(key_set->Has(kHash1));
+  index()->Insert(kHash1);
+  EXPECT_TRUE(key_set->Has(kHash3));
+
+  ReturnIndexFile();
+  EXPECT_TRUE(key_set->Has(kHash1));
+  EXPECT_TRUE(key_set->Has(kHash2));
+  EXPECT_FALSE(key_set->Has(kHash3));
+
+  index()->Insert(kHash3);
+  index()->Remove(kHash1);
+  EXPECT_FALSE(key_set->Has(kHash1));
+  EXPECT_TRUE(key_set->Has(kHash2));
+  EXPECT_TRUE(key_set->Has(kHash3));
+
+  // A key set created after initialization starts out with the entries.
+  index_.reset();
+  EXPECT_TRUE(key_set->Has(kHash2));
+  SetUp();
+  InsertIntoIndexFileReturn(kHash1, base::Time::Now(), 10);
+  ReturnIndexFile();
+  key_set = index()->GetKeySet();
+  EXPECT_TRUE(key_set->Has(kHash1));
+  EXPECT_FALSE(key_set->Has(kHash2));
+}
+
 TEST_F(SimpleIndexTest, UseIfExists) {
   // Confirm the base index has dispatched the request for index entries.
   EXPECT_TRUE(index_file_.get());
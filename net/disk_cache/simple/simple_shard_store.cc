@@ -0,0 +1,389 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_shard_store.h"
+
+#include "base/containers/flat_hash_map.h"
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "net/disk_cache/simple/simple_entry_format.h"
+#include "third_party/zlib/zlib.h"
+
+using base::File;
+using base::FilePath;
+
+namespace disk_cache {
+
+namespace {
+
+const uint32 kShardFileVersion = 1;
+
+// A shard is compacted when its dead records take more than this and more
+// than its live records.
+const int64 kMinCompactionDeadBytes = 1024 * 1024;
+
+struct RecordLocation {
+  int64 offset;
+  uint32 size;
+  int64 last_modified;
+};
+
+typedef base::FlatHashMap<uint64, RecordLocation> RecordMap;
+
+int64 GetRecordSize(uint32 data_size) {
+  return sizeof(SimpleShardRecordHeader) + data_size;
+}
+
+uint32 GetDataCRC(const char* data, int size) {
+  return crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef*>(data),
+               size);
+}
+
+// Reads the record headers of the shard |file| into |records|. Sets
+// |*out_end_offset| to the end of the last complete record, where the next
+// one goes, and |*out_dead_bytes| to the size of the records that were
+// replaced or removed. Returns false if |file| is not a shard file.
+bool ScanShardFile(File* file,
+                   RecordMap* records,
+                   int64* out_end_offset,
+                   int64* out_dead_bytes) {
+  records->clear();
+  *out_dead_bytes = 0;
+
+  SimpleShardFileHeader file_header;
+  if (file->Read(0, reinterpret_cast<char*>(&file_header),
+                 sizeof(file_header)) != sizeof(file_header) ||
+      file_header.initial_magic_number != kSimpleShardInitialMagicNumber ||
+      file_header.version != kShardFileVersion) {
+    return false;
+  }
+
+  const int64 file_length = file->GetLength();
+  int64 offset = sizeof(file_header);
+  while (true) {
+    SimpleShardRecordHeader header;
+    if (file->Read(offset, reinterpret_cast<char*>(&header), sizeof(header)) !=
+        sizeof(header)) {
+      break;
+    }
+    if (header.record_magic_number != kSimpleShardRecordMagicNumber ||
+        header.size > SimpleShardStore::kMaxPackedFileSize ||
+        offset + GetRecordSize(header.size) > file_length) {
+      DVLOG(1) << "Truncated or corrupt shard record at offset " << offset;
+      break;
+    }
+
+    RecordMap::iterator it = records->find(header.entry_hash);
+    if (it != records->end()) {
+      *out_dead_bytes += GetRecordSize(it->second.size);
+      records->erase(it);
+    }
+    if (header.size) {
+      RecordLocation location;
+      location.offset = offset;
+      location.size = header.size;
+      location.last_modified = header.last_modified;
+      records->insert(std::make_pair(header.entry_hash, location));
+    } else {
+      *out_dead_bytes += GetRecordSize(0);
+    }
+    offset += GetRecordSize(header.size);
+  }
+  *out_end_offset = offset;
+  return true;
+}
+
+bool WriteShardFileHeader(File* file) {
+  SimpleShardFileHeader file_header;
+  file_header.initial_magic_number = kSimpleShardInitialMagicNumber;
+  file_header.version = kShardFileVersion;
+  return file->SetLength(0) &&
+         file->Write(0, reinterpret_cast<const char*>(&file_header),
+                     sizeof(file_header)) == sizeof(file_header);
+}
+
+}  // namespace
+
+class SimpleShardStore::Shard {
+ public:
+  Shard(const FilePath& file_path, bool packing_enabled)
+      : file_path_(file_path),
+        packing_enabled_(packing_enabled),
+        loaded_(false),
+        end_offset_(0),
+        dead_bytes_(0) {}
+
+  bool Has(uint64 entry_hash) {
+    base::AutoLock auto_lock(lock_);
+    EnsureLoaded();
+    return records_.count(entry_hash) > 0;
+  }
+
+  bool Read(uint64 entry_hash, std::string* out_data,
+            base::Time* out_last_modified) {
+    base::AutoLock auto_lock(lock_);
+    EnsureLoaded();
+    RecordMap::const_iterator it = records_.find(entry_hash);
+    if (it == records_.end())
+      return false;
+    const RecordLocation location = it->second;
+
+    // One read for the header and the data.
+    std::string record(GetRecordSize(location.size), '\0');
+    if (file_.Read(location.offset, &record[0], record.size()) !=
+        static_cast<int>(record.size())) {
+      DLOG(WARNING) << "Could not read a shard record in "
+                    << file_path_.value();
+      RemoveLocked(entry_hash);
+      return false;
+    }
+    SimpleShardRecordHeader header;
+    memcpy(&header, record.data(), sizeof(header));
+    const char* data = record.data() + sizeof(header);
+    if (header.record_magic_number != kSimpleShardRecordMagicNumber ||
+        header.entry_hash != entry_hash || header.size != location.size ||
+        header.data_crc32 != GetDataCRC(data, location.size)) {
+      DLOG(WARNING) << "Corrupt shard record in " << file_path_.value();
+      RemoveLocked(entry_hash);
+      return false;
+    }
+    out_data->assign(data, location.size);
+    *out_last_modified = base::Time::FromInternalValue(location.last_modified);
+    return true;
+  }
+
+  bool Write(uint64 entry_hash, const std::string& data,
+             base::Time last_modified) {
+    DCHECK_LT(0u, data.size());
+    DCHECK_GE(static_cast<size_t>(kMaxPackedFileSize), data.size());
+    base::AutoLock auto_lock(lock_);
+    EnsureLoaded();
+    if (!file_.IsValid())
+      return false;
+
+    SimpleShardRecordHeader header;
+    header.record_magic_number = kSimpleShardRecordMagicNumber;
+    header.entry_hash = entry_hash;
+    header.last_modified = last_modified.ToInternalValue();
+    header.size = data.size();
+    header.data_crc32 = GetDataCRC(data.data(), data.size());
+    std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+    record.append(data);
+    if (file_.Write(end_offset_, record.data(), record.size()) !=
+        static_cast<int>(record.size())) {
+      // Whatever made it to the file is cut off the next time it is loaded.
+      return false;
+    }
+
+    RecordMap::iterator it = records_.find(entry_hash);
+    if (it != records_.end()) {
+      dead_bytes_ += GetRecordSize(it->second.size);
+      records_.erase(it);
+    }
+    RecordLocation location;
+    location.offset = end_offset_;
+    location.size = header.size;
+    location.last_modified = header.last_modified;
+    records_.insert(std::make_pair(entry_hash, location));
+    end_offset_ += record.size();
+    MaybeCompact();
+    return true;
+  }
+
+  bool Remove(uint64 entry_hash) {
+    base::AutoLock auto_lock(lock_);
+    EnsureLoaded();
+    return RemoveLocked(entry_hash);
+  }
+
+ private:
+  // Opens and scans the shard file on first use. Without packing, a missing
+  // shard file is not created.
+  void EnsureLoaded() {
+    lock_.AssertAcquired();
+    if (loaded_)
+      return;
+    loaded_ = true;
+
+    int flags = File::FLAG_READ | File::FLAG_WRITE;
+    flags |= packing_enabled_ ? File::FLAG_OPEN_ALWAYS : File::FLAG_OPEN;
+    file_.Initialize(file_path_, flags);
+    if (!file_.IsValid())
+      return;
+    if (!ScanShardFile(&file_, &records_, &end_offset_, &dead_bytes_)) {
+      DVLOG_IF(1, file_.GetLength() > 0) << "Resetting corrupt shard file "
+                                         << file_path_.value();
+      records_.clear();
+      dead_bytes_ = 0;
+      end_offset_ = sizeof(SimpleShardFileHeader);
+      if (!WriteShardFileHeader(&file_))
+        file_.Close();
+    } else if (file_.GetLength() > end_offset_) {
+      // Cut off a record torn by a crash, so that no part of it is left behind
+      // the records appended from now on.
+      file_.SetLength(end_offset_);
+    }
+  }
+
+  bool RemoveLocked(uint64 entry_hash) {
+    lock_.AssertAcquired();
+    RecordMap::iterator it = records_.find(entry_hash);
+    if (it == records_.end())
+      return true;
+    dead_bytes_ += GetRecordSize(it->second.size);
+    records_.erase(it);
+
+    SimpleShardRecordHeader header;
+    header.record_magic_number = kSimpleShardRecordMagicNumber;
+    header.entry_hash = entry_hash;
+    if (file_.Write(end_offset_, reinterpret_cast<const char*>(&header),
+                    sizeof(header)) != sizeof(header)) {
+      // The record would come back the next time the shard is loaded, so
+      // the whole shard has to go.
+      DLOG(ERROR) << "Could not remove a shard record, dropping "
+                  << file_path_.value();
+      records_.clear();
+      end_offset_ = sizeof(SimpleShardFileHeader);
+      dead_bytes_ = 0;
+      if (!WriteShardFileHeader(&file_))
+        file_.Close();
+      return false;
+    }
+    dead_bytes_ += sizeof(header);
+    end_offset_ += sizeof(header);
+    MaybeCompact();
+    return true;
+  }
+
+  // Rewrites the shard file without its dead records if they take most of it.
+  void MaybeCompact() {
+    lock_.AssertAcquired();
+    const int64 live_bytes =
+        end_offset_ - sizeof(SimpleShardFileHeader) - dead_bytes_;
+    if (dead_bytes_ < kMinCompactionDeadBytes || dead_bytes_ < live_bytes)
+      return;
+
+    const FilePath temp_path =
+        file_path_.AddExtension(FILE_PATH_LITERAL("tmp"));
+    File temp_file(temp_path, File::FLAG_CREATE_ALWAYS | File::FLAG_READ |
+                                  File::FLAG_WRITE);
+    if (!temp_file.IsValid() || !WriteShardFileHeader(&temp_file))
+      return;
+
+    RecordMap new_records;
+    new_records.reserve(records_.size());
+    int64 new_end_offset = sizeof(SimpleShardFileHeader);
+    std::string record;
+    for (RecordMap::const_iterator it = records_.begin(); it != records_.end();
+         ++it) {
+      record.resize(GetRecordSize(it->second.size));
+      if (file_.Read(it->second.offset, &record[0], record.size()) !=
+              static_cast<int>(record.size()) ||
+          temp_file.Write(new_end_offset, record.data(), record.size()) !=
+              static_cast<int>(record.size())) {
+        temp_file.Close();
+        base::DeleteFile(temp_path, false);
+        return;
+      }
+      RecordLocation location = it->second;
+      location.offset = new_end_offset;
+      new_records.insert(std::make_pair(it->first, location));
+      new_end_offset += record.size();
+    }
+    temp_file.Close();
+
+    // The shard file has to be closed to be replaced on Windows.
+    file_.Close();
+    const bool replaced = base::ReplaceFile(temp_path, file_path_, NULL);
+    if (!replaced)
+      base::DeleteFile(temp_path, false);
+    file_.Initialize(file_path_, File::FLAG_OPEN | File::FLAG_READ |
+                                     File::FLAG_WRITE);
+    if (replaced) {
+      records_.swap(new_records);
+      end_offset_ = new_end_offset;
+      dead_bytes_ = 0;
+    }
+    if (!file_.IsValid())
+      records_.clear();
+  }
+
+  base::Lock lock_;
+  const FilePath file_path_;
+  const bool packing_enabled_;
+  bool loaded_;
+  File file_;
+  RecordMap records_;
+  int64 end_offset_;
+  int64 dead_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(Shard);
+};
+
+SimpleShardStore::SimpleShardStore(const FilePath& path, bool packing_enabled)
+    : path_(path),
+      packing_enabled_(packing_enabled) {
+  for (int i = 0; i < kShardCount; ++i) {
+    shards_[i].reset(
+        new Shard(path_.AppendASCII(GetShardFilename(i)), packing_enabled_));
+  }
+}
+
+SimpleShardStore::~SimpleShardStore() {
+}
+
+bool SimpleShardStore::Has(uint64 entry_hash) {
+  return GetShard(entry_hash)->Has(entry_hash);
+}
+
+bool SimpleShardStore::Read(uint64 entry_hash,
+                            std::string* out_data,
+                            base::Time* out_last_modified) {
+  return GetShard(entry_hash)->Read(entry_hash, out_data, out_last_modified);
+}
+
+bool SimpleShardStore::Write(uint64 entry_hash,
+                             const std::string& data,
+                             base::Time last_modified) {
+  DCHECK(packing_enabled_);
+  return GetShard(entry_hash)->Write(entry_hash, data, last_modified);
+}
+
+bool SimpleShardStore::Remove(uint64 entry_hash) {
+  return GetShard(entry_hash)->Remove(entry_hash);
+}
+
+// static
+void SimpleShardStore::GetEntries(const FilePath& path,
+                                  std::vector<EntryInfo>* out_entries) {
+  for (int i = 0; i < kShardCount; ++i) {
+    File file(path.AppendASCII(GetShardFilename(i)),
+              File::FLAG_OPEN | File::FLAG_READ);
+    if (!file.IsValid())
+      continue;
+    RecordMap records;
+    int64 end_offset, dead_bytes;
+    if (!ScanShardFile(&file, &records, &end_offset, &dead_bytes))
+      continue;
+    for (RecordMap::const_iterator it = records.begin(); it != records.end();
+         ++it) {
+      EntryInfo info;
+      info.entry_hash = it->first;
+      info.last_modified =
+          base::Time::FromInternalValue(it->second.last_modified);
+      info.size = it->second.size;
+      out_entries->push_back(info);
+    }
+  }
+}
+
+// static
+std::string SimpleShardStore::GetShardFilename(int shard_index) {
+  return base::StringPrintf("shard_%d", shard_index);
+}
+
+}  // namespace disk_cache
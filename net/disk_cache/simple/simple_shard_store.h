@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_SHARD_STORE_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_SHARD_STORE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// Packs the stream 0 and stream 1 files of small entries into a few
+// append-only shard files in the cache directory, so that a cache of many
+// small entries does not cost a file, an inode and an open() per entry. The
+// records hold the files byte for byte, so SimpleSynchronousEntry reads and
+// writes them in the usual entry format. Entries with a stream 2 or sparse
+// data, and entries larger than kMaxPackedFileSize, keep files of their own.
+//
+// Removing or replacing a record only appends to the shard, and a shard is
+// compacted once most of it is dead. The shards are loaded lazily, by reading
+// the record headers, on the first access to each.
+//
+// May be used from any thread. Each shard has its own lock, and all the IO on
+// a shard happens under it.
+class NET_EXPORT_PRIVATE SimpleShardStore
+    : public base::RefCountedThreadSafe<SimpleShardStore> {
+ public:
+  struct EntryInfo {
+    uint64 entry_hash;
+    base::Time last_modified;
+    int size;
+  };
+
+  static const int kShardCount = 4;
+
+  // Files of at most this size are packed.
+  static const int kMaxPackedFileSize = 16 * 1024;
+
+  // If |packing_enabled| is false the store only serves and removes records
+  // packed earlier, which SimpleSynchronousEntry then moves back into files
+  // of their own.
+  SimpleShardStore(const base::FilePath& path, bool packing_enabled);
+
+  bool packing_enabled() const { return packing_enabled_; }
+
+  // Returns whether the store holds a file for |entry_hash|.
+  bool Has(uint64 entry_hash);
+
+  // Copies the file of |entry_hash| into |out_data|. Returns false if there is
+  // no such file, or if it is corrupt, in which case it is removed.
+  bool Read(uint64 entry_hash, std::string* out_data,
+            base::Time* out_last_modified);
+
+  // Stores |data| as the file of |entry_hash|, replacing any previous one.
+  bool Write(uint64 entry_hash, const std::string& data,
+             base::Time last_modified);
+
+  // Removes the file of |entry_hash|. Returns false if it could not be
+  // removed; removing a file that is not there succeeds.
+  bool Remove(uint64 entry_hash);
+
+  // Lists the files packed in the cache directory |path|, for rebuilding the
+  // index. Does not modify the shard files.
+  static void GetEntries(const base::FilePath& path,
+                         std::vector<EntryInfo>* out_entries);
+
+  // Returns the name of the shard file |shard_index| in the cache directory.
+  static std::string GetShardFilename(int shard_index);
+
+ private:
+  friend class base::RefCountedThreadSafe<SimpleShardStore>;
+
+  class Shard;
+
+  ~SimpleShardStore();
+
+  Shard* GetShard(uint64 entry_hash) {
+    return shards_[entry_hash % kShardCount].get();
+  }
+
+  const base::FilePath path_;
+  const bool packing_enabled_;
+  scoped_ptr<Shard> shards_[kShardCount];
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleShardStore);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_SHARD_STORE_H_
@@ -0,0 +1,223 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_shard_store.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/files/file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::FilePath;
+using base::Time;
+
+namespace disk_cache {
+
+namespace {
+
+// Hashes of entries in the same shard.
+const uint64 kHash1 = SimpleShardStore::kShardCount * 1;
+const uint64 kHash2 = SimpleShardStore::kShardCount * 2;
+
+}  // namespace
+
+class SimpleShardStoreTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  }
+
+  scoped_refptr<SimpleShardStore> CreateStore(bool packing_enabled) {
+    return new SimpleShardStore(temp_dir_.path(), packing_enabled);
+  }
+
+  FilePath GetShardPath(uint64 entry_hash) const {
+    return temp_dir_.path().AppendASCII(SimpleShardStore::GetShardFilename(
+        entry_hash % SimpleShardStore::kShardCount));
+  }
+
+  int64 GetShardLength(uint64 entry_hash) const {
+    int64 length = -1;
+    base::GetFileSize(GetShardPath(entry_hash), &length);
+    return length;
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(SimpleShardStoreTest, WriteReadRemove) {
+  scoped_refptr<SimpleShardStore> store = CreateStore(true);
+  const Time last_modified = Time::FromInternalValue(12345);
+  EXPECT_FALSE(store->Has(kHash1));
+  EXPECT_TRUE(store->Write(kHash1, "first", last_modified));
+  EXPECT_TRUE(store->Write(kHash2, "second", last_modified));
+  EXPECT_TRUE(store->Has(kHash1));
+
+  std::string data;
+  Time read_last_modified;
+  ASSERT_TRUE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_EQ("first", data);
+  EXPECT_EQ(last_modified, read_last_modified);
+
+  EXPECT_TRUE(store->Write(kHash1, "replaced", last_modified));
+  ASSERT_TRUE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_EQ("replaced", data);
+
+  EXPECT_TRUE(store->Remove(kHash1));
+  EXPECT_FALSE(store->Has(kHash1));
+  EXPECT_FALSE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_TRUE(store->Remove(kHash1));
+  ASSERT_TRUE(store->Read(kHash2, &data, &read_last_modified));
+  EXPECT_EQ("second", data);
+}
+
+TEST_F(SimpleShardStoreTest, Reload) {
+  const Time last_modified = Time::FromInternalValue(12345);
+  {
+    scoped_refptr<SimpleShardStore> store = CreateStore(true);
+    EXPECT_TRUE(store->Write(kHash1, "first", last_modified));
+    EXPECT_TRUE(store->Write(kHash2, "second", last_modified));
+    EXPECT_TRUE(store->Write(kHash1, "replaced", last_modified));
+    EXPECT_TRUE(store->Remove(kHash2));
+  }
+
+  // Without packing, earlier records can still be read and removed.
+  scoped_refptr<SimpleShardStore> store = CreateStore(false);
+  EXPECT_FALSE(store->packing_enabled());
+  std::string data;
+  Time read_last_modified;
+  ASSERT_TRUE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_EQ("replaced", data);
+  EXPECT_EQ(last_modified, read_last_modified);
+  EXPECT_FALSE(store->Has(kHash2));
+  EXPECT_TRUE(store->Remove(kHash1));
+  EXPECT_FALSE(store->Has(kHash1));
+}
+
+TEST_F(SimpleShardStoreTest, NoShardFileWithoutPacking) {
+  scoped_refptr<SimpleShardStore> store = CreateStore(false);
+  EXPECT_FALSE(store->Has(kHash1));
+  EXPECT_TRUE(store->Remove(kHash1));
+  EXPECT_FALSE(base::PathExists(GetShardPath(kHash1)));
+}
+
+TEST_F(SimpleShardStoreTest, TornRecord) {
+  const Time last_modified = Time::FromInternalValue(12345);
+  {
+    scoped_refptr<SimpleShardStore> store = CreateStore(true);
+    EXPECT_TRUE(store->Write(kHash1, "first", last_modified));
+    EXPECT_TRUE(store->Write(kHash2, "second", last_modified));
+  }
+  // Cut the last record short, as a crash while appending it would.
+  const int64 length = GetShardLength(kHash1);
+  {
+    base::File file(GetShardPath(kHash1),
+                    base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    ASSERT_TRUE(file.SetLength(length - 1));
+  }
+
+  scoped_refptr<SimpleShardStore> store = CreateStore(true);
+  EXPECT_TRUE(store->Has(kHash1));
+  EXPECT_FALSE(store->Has(kHash2));
+
+  // The torn tail does not get in the way of new records.
+  EXPECT_TRUE(store->Write(kHash2, "again", last_modified));
+  store = NULL;
+  store = CreateStore(true);
+  std::string data;
+  Time read_last_modified;
+  ASSERT_TRUE(store->Read(kHash2, &data, &read_last_modified));
+  EXPECT_EQ("again", data);
+}
+
+TEST_F(SimpleShardStoreTest, CorruptRecord) {
+  const Time last_modified = Time::FromInternalValue(12345);
+  {
+    scoped_refptr<SimpleShardStore> store = CreateStore(true);
+    EXPECT_TRUE(store->Write(kHash1, "first", last_modified));
+  }
+  // Flip the last byte of the data.
+  const int64 length = GetShardLength(kHash1);
+  {
+    base::File file(GetShardPath(kHash1),
+                    base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+    ASSERT_EQ(1, file.Write(length - 1, "X", 1));
+  }
+
+  scoped_refptr<SimpleShardStore> store = CreateStore(true);
+  EXPECT_TRUE(store->Has(kHash1));
+  std::string data;
+  Time read_last_modified;
+  EXPECT_FALSE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_FALSE(store->Has(kHash1));
+}
+
+TEST_F(SimpleShardStoreTest, CorruptShardFile) {
+  ASSERT_EQ(4, file_util::WriteFile(GetShardPath(kHash1), "junk", 4));
+  scoped_refptr<SimpleShardStore> store = CreateStore(true);
+  EXPECT_FALSE(store->Has(kHash1));
+  EXPECT_TRUE(store->Write(kHash1, "first", Time::Now()));
+  std::string data;
+  Time read_last_modified;
+  ASSERT_TRUE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_EQ("first", data);
+}
+
+TEST_F(SimpleShardStoreTest, Compaction) {
+  scoped_refptr<SimpleShardStore> store = CreateStore(true);
+  const std::string large_data(SimpleShardStore::kMaxPackedFileSize, 'a');
+  const Time last_modified = Time::FromInternalValue(12345);
+  EXPECT_TRUE(store->Write(kHash2, "second", last_modified));
+
+  // Replacing the same record over and over eventually compacts the shard.
+  const int64 max_length = 2 * 1024 * 1024 + 2 * large_data.size();
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_TRUE(store->Write(kHash1, large_data, last_modified));
+    EXPECT_GT(max_length, GetShardLength(kHash1));
+  }
+  EXPECT_FALSE(base::PathExists(
+      GetShardPath(kHash1).AddExtension(FILE_PATH_LITERAL("tmp"))));
+
+  std::string data;
+  Time read_last_modified;
+  ASSERT_TRUE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_EQ(large_data, data);
+  ASSERT_TRUE(store->Read(kHash2, &data, &read_last_modified));
+  EXPECT_EQ("second", data);
+
+  store = NULL;
+  store = CreateStore(true);
+  ASSERT_TRUE(store->Read(kHash1, &data, &read_last_modified));
+  EXPECT_EQ(large_data, data);
+  ASSERT_TRUE(store->Read(kHash2, &data, &read_last_modified));
+  EXPECT_EQ("second", data);
+}
+
+TEST_F(SimpleShardStoreTest, GetEntries) {
+  scoped_refptr<SimpleShardStore> store = CreateStore(true);
+  const Time last_modified = Time::FromInternalValue(12345);
+  EXPECT_TRUE(store->Write(kHash1, "first", last_modified));
+  EXPECT_TRUE(store->Write(kHash2, "second", last_modified));
+  EXPECT_TRUE(store->Write(kHash2 + 1, "other shard", last_modified));
+  EXPECT_TRUE(store->Remove(kHash2));
+
+  std::vector<SimpleShardStore::EntryInfo> entries;
+  SimpleShardStore::GetEntries(temp_dir_.path(), &entries);
+  ASSERT_EQ(2u, entries.size());
+  if (entries[0].entry_hash != kHash1)
+    std::swap(entries[0], entries[1]);
+  EXPECT_EQ(kHash1, entries[0].entry_hash);
+  EXPECT_EQ(5, entries[0].size);
+  EXPECT_EQ(last_modified, entries[0].last_modified);
+  EXPECT_EQ(kHash2 + 1, entries[1].entry_hash);
+  EXPECT_EQ(11, entries[1].size);
+}
+
+}  // namespace disk_cache
@@ -6,7 +6,6 @@
 
 #include <algorithm>
 #include <cstring>
-#include <functional>
 #include <limits>
 
 #include "base/basictypes.h"
@@ -20,6 +19,7 @@
 #include "net/base/net_errors.h"
 #include "net/disk_cache/simple/simple_backend_version.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
+#include "net/disk_cache/simple/simple_shard_store.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
 
@@ -211,11 +211,12 @@ SimpleSynchronousEntry::EntryOperationData::EntryOperationData(
 void SimpleSynchronousEntry::OpenEntry(
     net::CacheType cache_type,
     const FilePath& path,
+    SimpleShardStore* shard_store,
     const uint64 entry_hash,
     bool had_index,
     SimpleEntryCreationResults *out_results) {
   SimpleSynchronousEntry* sync_entry =
-      new SimpleSynchronousEntry(cache_type, path, "", entry_hash);
+      new SimpleSynchronousEntry(cache_type, path, shard_store, "", entry_hash);
   out_results->result =
       sync_entry->InitializeForOpen(had_index,
                                     &out_results->entry_stat,
@@ -235,13 +236,15 @@ void SimpleSynchronousEntry::OpenEntry(
 void SimpleSynchronousEntry::CreateEntry(
     net::CacheType cache_type,
     const FilePath& path,
+    SimpleShardStore* shard_store,
     const std::string& key,
     const uint64 entry_hash,
     bool had_index,
     SimpleEntryCreationResults *out_results) {
   DCHECK_EQ(entry_hash, GetEntryHashKey(key));
   SimpleSynchronousEntry* sync_entry =
-      new SimpleSynchronousEntry(cache_type, path, key, entry_hash);
+      new SimpleSynchronousEntry(cache_type, path, shard_store, key,
+                                 entry_hash);
   out_results->result = sync_entry->InitializeForCreate(
       had_index, &out_results->entry_stat);
   if (out_results->result != net::OK) {
@@ -257,18 +260,24 @@ void SimpleSynchronousEntry::CreateEntry(
 // static
 int SimpleSynchronousEntry::DoomEntry(
     const FilePath& path,
+    SimpleShardStore* shard_store,
     uint64 entry_hash) {
-  const bool deleted_well = DeleteFilesForEntryHash(path, entry_hash);
+  const bool deleted_well =
+      DeleteFilesForEntryHash(path, shard_store, entry_hash);
   return deleted_well ? net::OK : net::ERR_FAILED;
 }
 
 // static
 int SimpleSynchronousEntry::DoomEntrySet(
     const std::vector<uint64>* key_hashes,
-    const FilePath& path) {
-  const size_t did_delete_count = std::count_if(
-      key_hashes->begin(), key_hashes->end(), std::bind1st(
-          std::ptr_fun(SimpleSynchronousEntry::DeleteFilesForEntryHash), path));
+    const FilePath& path,
+    SimpleShardStore* shard_store) {
+  size_t did_delete_count = 0;
+  for (std::vector<uint64>::const_iterator it = key_hashes->begin();
+       it != key_hashes->end(); ++it) {
+    if (DeleteFilesForEntryHash(path, shard_store, *it))
+      ++did_delete_count;
+  }
   return (did_delete_count == key_hashes->size()) ? net::OK : net::ERR_FAILED;
 }
 
@@ -286,9 +295,8 @@ void SimpleSynchronousEntry::ReadData(const EntryOperationData& in_entry_op,
   // be handled in the SimpleEntryImpl.
   DCHECK_LT(0, in_entry_op.buf_len);
   DCHECK(!empty_file_omitted_[file_index]);
-  File* file = const_cast<File*>(&files_[file_index]);
-  int bytes_read =
-      file->Read(file_offset, out_buf->data(), in_entry_op.buf_len);
+  int bytes_read = ReadFromFile(file_index, file_offset, out_buf->data(),
+                                in_entry_op.buf_len);
   if (bytes_read > 0) {
     entry_stat->set_last_used(Time::Now());
     *out_crc32 = crc32(crc32(0L, Z_NULL, 0),
@@ -350,7 +358,7 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
     // The EOF record and the eventual stream afterward need to be zeroed out.
     const int64 file_eof_offset =
         out_entry_stat->GetEOFOffsetInFile(key_, index);
-    if (!files_[file_index].SetLength(file_eof_offset)) {
+    if (!SetFileLength(file_index, file_eof_offset)) {
       RecordWriteResult(cache_type_, WRITE_RESULT_PRETRUNCATE_FAILURE);
       Doom();
       *out_result = net::ERR_CACHE_WRITE_FAILURE;
@@ -358,7 +366,7 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
     }
   }
   if (buf_len > 0) {
-    if (files_[file_index].Write(file_offset, in_buf->data(), buf_len) !=
+    if (WriteToFile(file_index, file_offset, in_buf->data(), buf_len) !=
         buf_len) {
       RecordWriteResult(cache_type_, WRITE_RESULT_WRITE_FAILURE);
       Doom();
@@ -372,7 +380,7 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
   } else {
     out_entry_stat->set_data_size(index, offset + buf_len);
     int file_eof_offset = out_entry_stat->GetLastEOFOffsetInFile(key_, index);
-    if (!files_[file_index].SetLength(file_eof_offset)) {
+    if (!SetFileLength(file_index, file_eof_offset)) {
       RecordWriteResult(cache_type_, WRITE_RESULT_TRUNCATE_FAILURE);
       Doom();
       *out_result = net::ERR_CACHE_WRITE_FAILURE;
@@ -621,16 +629,18 @@ void SimpleSynchronousEntry::CheckEOFRecord(int index,
 void SimpleSynchronousEntry::Close(
     const SimpleEntryStat& entry_stat,
     scoped_ptr<std::vector<CRCRecord> > crc32s_to_write,
-    net::GrowableIOBuffer* stream_0_data) {
+    net::GrowableIOBuffer* stream_0_data,
+    bool doomed) {
   DCHECK(stream_0_data);
   // Write stream 0 data.
   int stream_0_offset = entry_stat.GetOffsetInFile(key_, 0, 0);
-  if (files_[0].Write(stream_0_offset, stream_0_data->data(),
-                      entry_stat.data_size(0)) !=
+  if (WriteToFile(0, stream_0_offset, stream_0_data->data(),
+                  entry_stat.data_size(0)) !=
       entry_stat.data_size(0)) {
     RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
     DVLOG(1) << "Could not write stream 0 data.";
     Doom();
+    doomed = true;
   }
 
   for (std::vector<CRCRecord>::const_iterator it = crc32s_to_write->begin();
@@ -651,25 +661,27 @@ void SimpleSynchronousEntry::Close(
     // If stream 0 changed size, the file needs to be resized, otherwise the
     // next open will yield wrong stream sizes. On stream 1 and stream 2 proper
     // resizing of the file is handled in SimpleSynchronousEntry::WriteData().
-    if (stream_index == 0 &&
-        !files_[file_index].SetLength(eof_offset)) {
+    if (stream_index == 0 && !SetFileLength(file_index, eof_offset)) {
       RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
       DVLOG(1) << "Could not truncate stream 0 file.";
       Doom();
+      doomed = true;
       break;
     }
-    if (files_[file_index].Write(eof_offset,
-                                 reinterpret_cast<const char*>(&eof_record),
-                                 sizeof(eof_record)) !=
+    if (WriteToFile(file_index, eof_offset,
+                    reinterpret_cast<const char*>(&eof_record),
+                    sizeof(eof_record)) !=
         sizeof(eof_record)) {
       RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
       DVLOG(1) << "Could not write eof record.";
       Doom();
+      doomed = true;
       break;
     }
   }
+  UpdateFile0Packing(entry_stat, doomed);
   for (int i = 0; i < kSimpleEntryFileCount; ++i) {
-    if (empty_file_omitted_[i])
+    if (empty_file_omitted_[i] || (i == 0 && file_0_packed_))
       continue;
 
     files_[i].Close();
@@ -698,14 +710,18 @@ void SimpleSynchronousEntry::Close(
 
 SimpleSynchronousEntry::SimpleSynchronousEntry(net::CacheType cache_type,
                                                const FilePath& path,
+                                               SimpleShardStore* shard_store,
                                                const std::string& key,
                                                const uint64 entry_hash)
     : cache_type_(cache_type),
       path_(path),
+      shard_store_(shard_store),
       entry_hash_(entry_hash),
       key_(key),
       have_open_files_(false),
-      initialized_(false) {
+      initialized_(false),
+      file_0_packed_(false),
+      packed_file_0_dirty_(false) {
   for (int i = 0; i < kSimpleEntryFileCount; ++i)
     empty_file_omitted_[i] = false;
 }
@@ -759,6 +775,22 @@ bool SimpleSynchronousEntry::MaybeCreateFile(
 bool SimpleSynchronousEntry::OpenFiles(
     bool had_index,
     SimpleEntryStat* out_entry_stat) {
+  base::Time packed_last_modified;
+  if (shard_store_.get() &&
+      shard_store_->Read(entry_hash_, &packed_file_0_, &packed_last_modified)) {
+    // Packed entries have neither a stream 2 nor sparse data, so there is no
+    // file to open at all.
+    file_0_packed_ = true;
+    empty_file_omitted_[GetFileIndexFromStreamIndex(2)] = true;
+    have_open_files_ = true;
+    out_entry_stat->set_last_used(packed_last_modified);
+    out_entry_stat->set_last_modified(packed_last_modified);
+    out_entry_stat->set_data_size(1, packed_file_0_.size());
+    out_entry_stat->set_data_size(2, 0);
+    files_created_ = false;
+    return true;
+  }
+
   for (int i = 0; i < kSimpleEntryFileCount; ++i) {
     File::Error error;
     if (!MaybeOpenFile(i, &error)) {
@@ -839,8 +871,25 @@ bool SimpleSynchronousEntry::OpenFiles(
 bool SimpleSynchronousEntry::CreateFiles(
     bool had_index,
     SimpleEntryStat* out_entry_stat) {
+  if (shard_store_.get() && shard_store_->packing_enabled()) {
+    // A new entry starts out packed, and only gets a file 0 of its own if it
+    // grows too large. It must not exist in either form yet.
+    if (shard_store_->Has(entry_hash_) ||
+        base::PathExists(GetFilenameFromFileIndex(0))) {
+      RecordSyncCreateResult(CREATE_ENTRY_PLATFORM_FILE_ERROR, had_index);
+      return false;
+    }
+    file_0_packed_ = true;
+    packed_file_0_dirty_ = true;
+  } else if (shard_store_.get() && shard_store_->Has(entry_hash_)) {
+    RecordSyncCreateResult(CREATE_ENTRY_PLATFORM_FILE_ERROR, had_index);
+    return false;
+  }
+
   for (int i = 0; i < kSimpleEntryFileCount; ++i) {
     File::Error error;
+    if (i == 0 && file_0_packed_)
+      continue;
     if (!MaybeCreateFile(i, FILE_NOT_REQUIRED, &error)) {
       // TODO(ttuttle,gavinp): Remove one each of these triplets of histograms.
       // We can calculate the third as the sum or difference of the other two.
@@ -878,7 +927,10 @@ bool SimpleSynchronousEntry::CreateFiles(
 }
 
 void SimpleSynchronousEntry::CloseFile(int index) {
-  if (empty_file_omitted_[index]) {
+  if (index == 0 && file_0_packed_) {
+    file_0_packed_ = false;
+    packed_file_0_.clear();
+  } else if (empty_file_omitted_[index]) {
     empty_file_omitted_[index] = false;
   } else {
     DCHECK(files_[index].IsValid());
@@ -894,6 +946,132 @@ void SimpleSynchronousEntry::CloseFiles() {
     CloseFile(i);
 }
 
+int SimpleSynchronousEntry::ReadFromFile(int file_index,
+                                         int64 offset,
+                                         char* data,
+                                         int size) const {
+  if (file_index != 0 || !file_0_packed_) {
+    File* file = const_cast<File*>(&files_[file_index]);
+    return file->Read(offset, data, size);
+  }
+  if (offset < 0 || size < 0)
+    return -1;
+  const int64 file_size = packed_file_0_.size();
+  if (offset >= file_size)
+    return 0;
+  const int bytes_read = std::min<int64>(size, file_size - offset);
+  memcpy(data, packed_file_0_.data() + offset, bytes_read);
+  return bytes_read;
+}
+
+int SimpleSynchronousEntry::WriteToFile(int file_index,
+                                        int64 offset,
+                                        const char* data,
+                                        int size) {
+  if (file_index == 0 && file_0_packed_ &&
+      offset + size > SimpleShardStore::kMaxPackedFileSize && !UnpackFile0()) {
+    return -1;
+  }
+  if (file_index != 0 || !file_0_packed_)
+    return files_[file_index].Write(offset, data, size);
+  if (offset < 0 || size < 0)
+    return -1;
+  if (size == 0)
+    return 0;
+  const size_t end = offset + size;
+  if (packed_file_0_.size() < end) {
+    packed_file_0_.resize(end, '\0');
+    packed_file_0_dirty_ = true;
+  }
+  // Rewriting stream 0 on every close does not make the record dirty unless
+  // it changed.
+  if (memcmp(&packed_file_0_[offset], data, size) != 0) {
+    memcpy(&packed_file_0_[offset], data, size);
+    packed_file_0_dirty_ = true;
+  }
+  return size;
+}
+
+bool SimpleSynchronousEntry::SetFileLength(int file_index, int64 length) {
+  if (file_index == 0 && file_0_packed_ &&
+      length > SimpleShardStore::kMaxPackedFileSize && !UnpackFile0()) {
+    return false;
+  }
+  if (file_index != 0 || !file_0_packed_)
+    return files_[file_index].SetLength(length);
+  if (length < 0)
+    return false;
+  if (packed_file_0_.size() != static_cast<size_t>(length)) {
+    packed_file_0_.resize(length, '\0');
+    packed_file_0_dirty_ = true;
+  }
+  return true;
+}
+
+bool SimpleSynchronousEntry::UnpackFile0() {
+  DCHECK(file_0_packed_);
+  const FilePath filename = GetFilenameFromFileIndex(0);
+  files_[0].Initialize(filename, File::FLAG_CREATE_ALWAYS | File::FLAG_READ |
+                                     File::FLAG_WRITE);
+  if (!files_[0].IsValid())
+    return false;
+  if (files_[0].Write(0, packed_file_0_.data(), packed_file_0_.size()) !=
+          static_cast<int>(packed_file_0_.size()) ||
+      !shard_store_->Remove(entry_hash_)) {
+    files_[0].Close();
+    base::DeleteFile(filename, false);
+    return false;
+  }
+  file_0_packed_ = false;
+  packed_file_0_.clear();
+  packed_file_0_dirty_ = false;
+  return true;
+}
+
+void SimpleSynchronousEntry::UpdateFile0Packing(
+    const SimpleEntryStat& entry_stat,
+    bool doomed) {
+  // Whatever is left of a doomed entry goes away with its open files.
+  if (!shard_store_.get() || doomed)
+    return;
+  const int64 file_0_size = entry_stat.GetFileSize(key_, 0);
+  const bool packable =
+      shard_store_->packing_enabled() &&
+      empty_file_omitted_[GetFileIndexFromStreamIndex(2)] &&
+      !sparse_file_open() &&
+      file_0_size <= SimpleShardStore::kMaxPackedFileSize;
+
+  if (file_0_packed_) {
+    if (!packable) {
+      if (!UnpackFile0())
+        Doom();
+      return;
+    }
+    if (packed_file_0_dirty_ &&
+        !shard_store_->Write(entry_hash_, packed_file_0_,
+                             entry_stat.last_modified())) {
+      DVLOG(1) << "Could not write packed entry.";
+      Doom();
+    }
+    return;
+  }
+
+  if (!packable)
+    return;
+  // The entry got small enough to be packed. If that fails it keeps its file.
+  std::string data(file_0_size, '\0');
+  if (files_[0].Read(0, &data[0], data.size()) !=
+          static_cast<int>(data.size()) ||
+      !shard_store_->Write(entry_hash_, data, entry_stat.last_modified())) {
+    return;
+  }
+  files_[0].Close();
+  DeleteFileForEntryHash(path_, entry_hash_, 0);
+  file_0_packed_ = true;
+  packed_file_0_.swap(data);
+  packed_file_0_dirty_ = false;
+}
+
 int SimpleSynchronousEntry::InitializeForOpen(
     bool had_index,
     SimpleEntryStat* out_entry_stat,
@@ -910,7 +1088,7 @@ int SimpleSynchronousEntry::InitializeForOpen(
 
     SimpleFileHeader header;
     int header_read_result =
-        files_[i].Read(0, reinterpret_cast<char*>(&header), sizeof(header));
+        ReadFromFile(i, 0, reinterpret_cast<char*>(&header), sizeof(header));
     if (header_read_result != sizeof(header)) {
       DLOG(WARNING) << "Cannot read header from entry.";
       RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_HEADER, had_index);
@@ -933,8 +1111,8 @@ int SimpleSynchronousEntry::InitializeForOpen(
     }
 
     scoped_ptr<char[]> key(new char[header.key_length]);
-    int key_read_result = files_[i].Read(sizeof(header), key.get(),
-                                         header.key_length);
+    int key_read_result = ReadFromFile(i, sizeof(header), key.get(),
+                                       header.key_length);
     if (key_read_result != implicit_cast<int>(header.key_length)) {
       DLOG(WARNING) << "Cannot read key from entry.";
       RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_KEY, had_index);
@@ -968,7 +1146,7 @@ int SimpleSynchronousEntry::InitializeForOpen(
   }
 
   int32 sparse_data_size = 0;
-  if (!OpenSparseFileIfExists(&sparse_data_size)) {
+  if (!file_0_packed_ && !OpenSparseFileIfExists(&sparse_data_size)) {
     RecordSyncOpenResult(
         cache_type_, OPEN_ENTRY_SPARSE_OPEN_FAILED, had_index);
     return net::ERR_FAILED;
@@ -1005,15 +1183,15 @@ bool SimpleSynchronousEntry::InitializeCreatedFile(
   header.key_length = key_.size();
   header.key_hash = base::Hash(key_);
 
-  int bytes_written = files_[file_index].Write(
-      0, reinterpret_cast<char*>(&header), sizeof(header));
+  int bytes_written = WriteToFile(
+      file_index, 0, reinterpret_cast<char*>(&header), sizeof(header));
   if (bytes_written != sizeof(header)) {
     *out_result = CREATE_ENTRY_CANT_WRITE_HEADER;
     return false;
   }
 
-  bytes_written = files_[file_index].Write(sizeof(header), key_.data(),
-                                           key_.size());
+  bytes_written = WriteToFile(file_index, sizeof(header), key_.data(),
+                              key_.size());
   if (bytes_written != implicit_cast<int>(key_.size())) {
     *out_result = CREATE_ENTRY_CANT_WRITE_KEY;
     return false;
@@ -1075,9 +1253,8 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
   *stream_0_data = new net::GrowableIOBuffer();
   (*stream_0_data)->SetCapacity(stream_0_size);
   int file_offset = out_entry_stat->GetOffsetInFile(key_, 0, 0);
-  File* file = const_cast<File*>(&files_[0]);
   int bytes_read =
-      file->Read(file_offset, (*stream_0_data)->data(), stream_0_size);
+      ReadFromFile(0, file_offset, (*stream_0_data)->data(), stream_0_size);
   if (bytes_read != stream_0_size)
     return net::ERR_FAILED;
 
@@ -1106,9 +1283,8 @@ int SimpleSynchronousEntry::GetEOFRecordData(int index,
   SimpleFileEOF eof_record;
   int file_offset = entry_stat.GetEOFOffsetInFile(key_, index);
   int file_index = GetFileIndexFromStreamIndex(index);
-  File* file = const_cast<File*>(&files_[file_index]);
-  if (file->Read(file_offset, reinterpret_cast<char*>(&eof_record),
-                 sizeof(eof_record)) !=
+  if (ReadFromFile(file_index, file_offset,
+                   reinterpret_cast<char*>(&eof_record), sizeof(eof_record)) !=
       sizeof(eof_record)) {
     RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_READ_FAILURE);
     return net::ERR_CACHE_CHECKSUM_READ_FAILURE;
@@ -1129,7 +1305,7 @@ int SimpleSynchronousEntry::GetEOFRecordData(int index,
 }
 
 void SimpleSynchronousEntry::Doom() const {
-  DeleteFilesForEntryHash(path_, entry_hash_);
+  DeleteFilesForEntryHash(path_, shard_store_.get(), entry_hash_);
 }
 
 // static
@@ -1145,11 +1321,18 @@ bool SimpleSynchronousEntry::DeleteFileForEntryHash(
 // static
 bool SimpleSynchronousEntry::DeleteFilesForEntryHash(
     const FilePath& path,
+    SimpleShardStore* shard_store,
     const uint64 entry_hash) {
   bool result = true;
+  // A packed entry has no file 0 to delete.
+  const bool packed = shard_store && shard_store->Has(entry_hash);
+  if (packed && !shard_store->Remove(entry_hash))
+    result = false;
   for (int i = 0; i < kSimpleEntryFileCount; ++i) {
-    if (!DeleteFileForEntryHash(path, entry_hash, i) && !CanOmitEmptyFile(i))
+    if (!DeleteFileForEntryHash(path, entry_hash, i) && !CanOmitEmptyFile(i) &&
+        !(packed && i == 0)) {
       result = false;
+    }
   }
   FilePath to_delete = path.AppendASCII(
       GetSparseFilenameFromEntryHash(entry_hash));
@@ -27,6 +27,7 @@ class IOBuffer;
 
 namespace disk_cache {
 
+class SimpleShardStore;
 class SimpleSynchronousEntry;
 
 // This class handles the passing of data about the entry between
@@ -112,14 +113,17 @@ class SimpleSynchronousEntry {
     bool doomed;
   };
 
+  // If |shard_store| is not NULL, small entries are packed into it.
   static void OpenEntry(net::CacheType cache_type,
                         const base::FilePath& path,
+                        SimpleShardStore* shard_store,
                         uint64 entry_hash,
                         bool had_index,
                         SimpleEntryCreationResults* out_results);
 
   static void CreateEntry(net::CacheType cache_type,
                           const base::FilePath& path,
+                          SimpleShardStore* shard_store,
                           const std::string& key,
                           uint64 entry_hash,
                           bool had_index,
@@ -129,13 +133,15 @@ class SimpleSynchronousEntry {
   // corresponding instance, if any (allowing operations to continue to be
   // executed through that instance). Returns a net error code.
   static int DoomEntry(const base::FilePath& path,
+                       SimpleShardStore* shard_store,
                        uint64 entry_hash);
 
   // Like |DoomEntry()| above. Deletes all entries corresponding to the
   // |key_hashes|. Succeeds only when all entries are deleted. Returns a net
   // error code.
   static int DoomEntrySet(const std::vector<uint64>* key_hashes,
-                          const base::FilePath& path);
+                          const base::FilePath& path,
+                          SimpleShardStore* shard_store);
 
   // N.B. ReadData(), WriteData(), CheckEOFRecord() and Close() may block on IO.
   void ReadData(const EntryOperationData& in_entry_op,
@@ -166,10 +172,12 @@ class SimpleSynchronousEntry {
                          int* out_result);
 
   // Close all streams, and add write EOF records to streams indicated by the
-  // CRCRecord entries in |crc32s_to_write|.
+  // CRCRecord entries in |crc32s_to_write|. |doomed| is true if the entry was
+  // doomed while open, so that it is not packed back into the shard store.
   void Close(const SimpleEntryStat& entry_stat,
              scoped_ptr<std::vector<CRCRecord> > crc32s_to_write,
-             net::GrowableIOBuffer* stream_0_data);
+             net::GrowableIOBuffer* stream_0_data,
+             bool doomed);
 
   const base::FilePath& path() const { return path_; }
   std::string key() const { return key_; }
@@ -202,6 +210,7 @@ class SimpleSynchronousEntry {
   SimpleSynchronousEntry(
       net::CacheType cache_type,
       const base::FilePath& path,
+      SimpleShardStore* shard_store,
       const std::string& key,
       uint64 entry_hash);
 
@@ -227,6 +236,20 @@ class SimpleSynchronousEntry {
   void CloseFile(int index);
   void CloseFiles();
 
+  // Like base::File::Read(), Write() and SetLength() on |files_[file_index]|,
+  // but on |packed_file_0_| while file 0 is packed. A write that makes a
+  // packed file too large to stay packed unpacks it first.
+  int ReadFromFile(int file_index, int64 offset, char* data, int size) const;
+  int WriteToFile(int file_index, int64 offset, const char* data, int size);
+  bool SetFileLength(int file_index, int64 length);
+
+  // Moves the packed file 0 into a file of its own. Returns false on failure.
+  bool UnpackFile0();
+
+  // On close, moves file 0 into |shard_store_| if the entry is small enough,
+  // or out of it if it is not anymore.
+  void UpdateFile0Packing(const SimpleEntryStat& entry_stat, bool doomed);
+
   // Returns a net error, i.e. net::OK on success. |had_index| is passed
   // from the main entry for metrics purposes, and is true if the index was
   // initialized when the open operation began.
@@ -298,6 +321,7 @@ class SimpleSynchronousEntry {
                                      uint64 entry_hash,
                                      int file_index);
   static bool DeleteFilesForEntryHash(const base::FilePath& path,
+                                      SimpleShardStore* shard_store,
                                       uint64 entry_hash);
 
   void RecordSyncCreateResult(CreateEntryResult result, bool had_index);
@@ -310,6 +334,7 @@ class SimpleSynchronousEntry {
 
   const net::CacheType cache_type_;
   const base::FilePath path_;
+  const scoped_refptr<SimpleShardStore> shard_store_;
   const uint64 entry_hash_;
   std::string key_;
 
@@ -318,6 +343,13 @@ class SimpleSynchronousEntry {
 
   base::File files_[kSimpleEntryFileCount];
 
+  // True if file 0 is packed in |shard_store_|. Its contents are then kept in
+  // |packed_file_0_| instead of being read from |files_[0]|, and written back
+  // on close if |packed_file_0_dirty_|.
+  bool file_0_packed_;
+  std::string packed_file_0_;
+  bool packed_file_0_dirty_;
+
   // True if the corresponding stream is empty and therefore no on-disk file
   // was created to store it.
   bool empty_file_omitted_[kSimpleEntryFileCount];
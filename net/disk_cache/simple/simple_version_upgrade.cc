@@ -170,6 +170,11 @@ bool UpgradeSimpleCacheOnDisk(const base::FilePath& path) {
     }
     version_from++;
   }
+  if (version_from == 6) {
+    // Version 7 can pack small entries into shard files. A version 6 directory
+    // has none, so there is nothing to convert.
+    version_from++;
+  }
   if (version_from == kSimpleVersion) {
     if (!upgrade_needed) {
       return true;
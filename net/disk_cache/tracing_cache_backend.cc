@@ -25,6 +25,11 @@ class EntryProxy : public Entry, public base::RefCountedThreadSafe<EntryProxy> {
   virtual int WriteData(int index, int offset, IOBuffer* buf, int buf_len,
                         const CompletionCallback& callback,
                         bool truncate) OVERRIDE;
+  virtual int ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                   int buf_len, int prefetch_index,
+                                   IOBuffer* prefetch_buf,
+                                   int prefetch_buf_len,
+                                   const CompletionCallback& callback) OVERRIDE;
   virtual int ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback) OVERRIDE;
   virtual int WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
@@ -127,6 +132,28 @@ int EntryProxy::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
   return rv;
 }
 
+int EntryProxy::ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                     int buf_len, int prefetch_index,
+                                     IOBuffer* prefetch_buf,
+                                     int prefetch_buf_len,
+                                     const CompletionCallback& callback) {
+  base::TimeTicks start_time = base::TimeTicks::Now();
+  RwOpExtra extra;
+  extra.index = index;
+  extra.offset = offset;
+  extra.buf_len = buf_len;
+  extra.truncate = false;
+  int rv = entry_->ReadDataWithPrefetch(
+      index, offset, buf, buf_len, prefetch_index, prefetch_buf,
+      prefetch_buf_len,
+      base::Bind(&EntryProxy::EntryOpComplete, this, start_time,
+                 TracingCacheBackend::OP_READ, extra, callback));
+  if (rv != net::ERR_IO_PENDING) {
+    RecordEvent(start_time, TracingCacheBackend::OP_READ, extra, rv);
+  }
+  return rv;
+}
+
 int EntryProxy::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                            const CompletionCallback& callback) {
   // TODO(pasko): Record the event.
@@ -297,6 +324,23 @@ int TracingCacheBackend::DoomEntriesSince(base::Time initial_time,
   return backend_->DoomEntriesSince(initial_time, callback);
 }
 
+int TracingCacheBackend::DoomEntriesBetweenWithProgress(
+    base::Time initial_time,
+    base::Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback) {
+  return backend_->DoomEntriesBetweenWithProgress(initial_time, end_time,
+                                                  progress_callback, callback);
+}
+
+int TracingCacheBackend::CalculateSizeOfEntriesBetween(
+    base::Time initial_time,
+    base::Time end_time,
+    const CompletionCallback& callback) {
+  return backend_->CalculateSizeOfEntriesBetween(initial_time, end_time,
+                                                 callback);
+}
+
 int TracingCacheBackend::OpenNextEntry(void** iter, Entry** next_entry,
                                        const CompletionCallback& callback) {
   return backend_->OpenNextEntry(iter, next_entry, callback);
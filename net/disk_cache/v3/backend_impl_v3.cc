@@ -1584,6 +1584,21 @@ int BackendImplV3::DoomEntriesSince(base::Time initial_time,
   return net::ERR_FAILED;
 }
 
+int BackendImplV3::DoomEntriesBetweenWithProgress(
+    base::Time initial_time,
+    base::Time end_time,
+    const ProgressCallback& progress_callback,
+    const CompletionCallback& callback) {
+  return net::ERR_FAILED;
+}
+
+int BackendImplV3::CalculateSizeOfEntriesBetween(
+    base::Time initial_time,
+    base::Time end_time,
+    const CompletionCallback& callback) {
+  return net::ERR_FAILED;
+}
+
 int BackendImplV3::OpenNextEntry(void** iter, Entry** next_entry,
                                  const CompletionCallback& callback) {
   return net::ERR_FAILED;
@@ -1430,6 +1430,14 @@ int EntryImplV3::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
   return net::ERR_FAILED;
 }
 
+int EntryImplV3::ReadDataWithPrefetch(int index, int offset, IOBuffer* buf,
+                                      int buf_len, int prefetch_index,
+                                      IOBuffer* prefetch_buf,
+                                      int prefetch_buf_len,
+                                      const CompletionCallback& callback) {
+  return net::ERR_FAILED;
+}
+
 int EntryImplV3::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                                 const CompletionCallback& callback) {
   return net::ERR_FAILED;
@@ -49,6 +49,30 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   return entries_.Get(key, now);
 }
 
+const HostCache::Entry* HostCache::LookupStale(const Key& key,
+                                               base::TimeTicks now,
+                                               base::TimeDelta max_stale,
+                                               bool* stale) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(stale);
+  *stale = false;
+  if (caching_is_disabled())
+    return NULL;
+
+  base::TimeTicks expiration;
+  const Entry* entry = entries_.Peek(key, &expiration);
+  if (!entry)
+    return NULL;
+  if (now < expiration)
+    return entry;
+  if (now - expiration < max_stale) {
+    *stale = true;
+    return entry;
+  }
+  // Too old to be used, so let the cache drop it as it does on expiry.
+  return entries_.Get(key, now);
+}
+
 void HostCache::Set(const Key& key,
                     const Entry& entry,
                     base::TimeTicks now,
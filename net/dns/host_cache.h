@@ -82,6 +82,14 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Like Lookup(), but also returns an entry that expired less than
+  // |max_stale| before |now|, in which case |*stale| is set to true. Entries
+  // that expired longer ago are removed, as Lookup() would.
+  const Entry* LookupStale(const Key& key,
+                           base::TimeTicks now,
+                           base::TimeDelta max_stale,
+                           bool* stale);
+
   // Overwrites or creates an entry for |key|.
   // |entry| is the value to set, |now| is the current time
   // |ttl| is the "time to live".
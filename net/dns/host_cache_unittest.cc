@@ -296,6 +296,41 @@ TEST(HostCacheTest, Clear) {
   EXPECT_EQ(0u, cache.size());
 }
 
+TEST(HostCacheTest, LookupStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+  const base::TimeDelta kMaxStale = base::TimeDelta::FromSeconds(5);
+
+  HostCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+  cache.Set(Key("foobar.com"), entry, now, kTTL);
+
+  bool stale = true;
+  EXPECT_TRUE(cache.LookupStale(Key("foobar.com"), now, kMaxStale, &stale));
+  EXPECT_FALSE(stale);
+  EXPECT_FALSE(cache.LookupStale(Key("foobar2.com"), now, kMaxStale, &stale));
+
+  // Advance to t=12; the entry is expired, but can still be used as stale.
+  now += base::TimeDelta::FromSeconds(12);
+  EXPECT_TRUE(cache.LookupStale(Key("foobar.com"), now, kMaxStale, &stale));
+  EXPECT_TRUE(stale);
+  EXPECT_EQ(1U, cache.size());
+
+  // A plain lookup ignores it, as does one that does not accept it as stale.
+  EXPECT_FALSE(cache.LookupStale(Key("foobar.com"), now,
+                                 base::TimeDelta::FromSeconds(1), &stale));
+  EXPECT_FALSE(stale);
+  EXPECT_EQ(0U, cache.size());
+
+  // Advance to t=30; the entry is too old even for a stale lookup.
+  cache.Set(Key("foobar.com"), entry, now, kTTL);
+  now += base::TimeDelta::FromSeconds(18);
+  EXPECT_FALSE(cache.LookupStale(Key("foobar.com"), now, kMaxStale, &stale));
+  EXPECT_EQ(0U, cache.size());
+}
+
 // Tests the less than and equal operators for HostCache::Key work.
 TEST(HostCacheTest, KeyComparators) {
   struct {
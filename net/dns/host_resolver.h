@@ -8,6 +8,7 @@
 #include <string>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
 #include "net/base/address_family.h"
 #include "net/base/completion_callback.h"
 #include "net/base/host_port_pair.h"
@@ -45,12 +46,15 @@ class NET_EXPORT HostResolver {
   // resolution. Pass HostResolver::kDefaultRetryAttempts to choose a default
   // value.
   // |enable_caching| controls whether a HostCache is used.
+  // |max_stale_age| is how long after expiring a cached result may still be
+  // served while it is refreshed. Zero disables serving stale results.
   struct NET_EXPORT Options {
     Options();
 
     size_t max_concurrent_resolves;
     size_t max_retry_attempts;
     bool enable_caching;
+    base::TimeDelta max_stale_age;
   };
 
   // The parameters for doing a Resolve(). A hostname and port are
@@ -29,6 +29,7 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/worker_pool.h"
 #include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
 #include "net/base/address_family.h"
 #include "net/base/address_list.h"
@@ -69,6 +70,10 @@ const unsigned kNegativeCacheEntryTTLSeconds = 0;
 // Minimum TTL for successful resolutions with DnsTask.
 const unsigned kMinimumTTLSeconds = kCacheEntryTTLSeconds;
 
+// How long to wait for the AAAA answer once the A answer is in, before the
+// Requests are served with the IPv4 addresses alone (RFC 6555 Happy Eyeballs).
+const int kAAAAResolutionDelayMs = 50;
+
 // We use a separate histogram name for each platform to facilitate the
 // display of error codes by their symbolic name (since each platform has
 // different mappings).
@@ -994,6 +999,7 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
         delegate_(delegate),
         net_log_(job_net_log),
         num_completed_transactions_(0),
+        ipv4_completed_first_(false),
         task_start_time_(base::TimeTicks::Now()) {
     DCHECK(client);
     DCHECK(delegate_);
@@ -1022,6 +1028,16 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
     StartAAAA();
   }
 
+  // True if the A transaction completed first of two, and the AAAA one is
+  // still outstanding.
+  bool ipv4_completed_first() const {
+    return ipv4_completed_first_ && num_completed_transactions_ == 1;
+  }
+
+  // The addresses and TTL of the transactions completed so far.
+  const AddressList& addr_list() const { return addr_list_; }
+  base::TimeDelta ttl() const { return ttl_; }
+
  private:
   void StartA() {
     DCHECK(!transaction_a_);
@@ -1100,6 +1116,8 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
     }
 
     if (needs_two_transactions() && num_completed_transactions_ == 1) {
+      ipv4_completed_first_ =
+          transaction->GetType() == dns_protocol::kTypeA;
       // No need to repeat the suffix search.
       key_.hostname = transaction->GetHostname();
       delegate_->OnFirstDnsTransactionComplete();
@@ -1177,6 +1195,7 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
   scoped_ptr<DnsTransaction> transaction_aaaa_;
 
   unsigned num_completed_transactions_;
+  bool ipv4_completed_first_;
 
   // These are updated as each transaction completes.
   base::TimeDelta ttl_;
@@ -1203,6 +1222,8 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       : resolver_(resolver),
         key_(key),
         priority_tracker_(priority),
+        is_refresh_(false),
+        served_early_(false),
         had_non_speculative_request_(false),
         had_dns_config_(false),
         num_occupied_job_slots_(0),
@@ -1210,7 +1231,8 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
         creation_time_(base::TimeTicks::Now()),
         priority_change_time_(creation_time_),
         net_log_(BoundNetLog::Make(request_net_log.net_log(),
-                                   NetLog::SOURCE_HOST_RESOLVER_IMPL_JOB)) {
+                                   NetLog::SOURCE_HOST_RESOLVER_IMPL_JOB)),
+        weak_ptr_factory_(this) {
     request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CREATE_JOB);
 
     net_log_.BeginEvent(
@@ -1299,6 +1321,12 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     UpdatePriority();
   }
 
+  // Keeps this Job running, and caching its result, even when it has no
+  // active Requests.
+  void MarkAsRefresh() {
+    is_refresh_ = true;
+  }
+
   // Marks |req| as cancelled. If it was the last active Request, also finishes
   // this Job, marking it as cancelled, and deletes it.
   void CancelRequest(Request* req) {
@@ -1316,7 +1344,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                                  req->request_net_log().source(),
                                  priority()));
 
-    if (num_active_requests() > 0) {
+    if (num_active_requests() > 0 || is_refresh_) {
       UpdatePriority();
     } else {
       // If we were called from a Request's callback within CompleteRequests,
@@ -1358,11 +1386,13 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    DCHECK(num_active_requests() > 0 || is_refresh_);
+    // A refresh may have been started without any Request.
+    const RequestInfo info = requests_.empty() ?
+        RequestInfo(HostPortPair(key_.hostname, 0)) :
+        requests_.front()->info();
     AddressList addr_list;
-    if (resolver_->ServeFromHosts(key(),
-                                  requests_.front()->info(),
-                                  &addr_list)) {
+    if (resolver_->ServeFromHosts(key(), info, &addr_list)) {
       // This will destroy the Job.
       CompleteRequests(
           HostCache::Entry(OK, MakeAddressListForRequest(addr_list)),
@@ -1386,6 +1416,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
  private:
   void KillDnsTask() {
+    aaaa_delay_timer_.Stop();
     if (dns_task_) {
       ReduceToOneJobSlot();
       dns_task_.reset();
@@ -1569,6 +1600,16 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
     dns_task_error_ = net_error;
 
+    if (served_early_) {
+      // The Requests already have the A answer, so cache that rather than
+      // the failure of the AAAA transaction.
+      CompleteRequests(
+          HostCache::Entry(OK, early_addr_list_, early_ttl_),
+          std::max(early_ttl_,
+                   base::TimeDelta::FromSeconds(kMinimumTTLSeconds)));
+      return;
+    }
+
     // TODO(szym): Run ServeFromHosts now if nsswitch.conf says so.
     // http://crbug.com/117655
 
@@ -1635,6 +1676,52 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     // for the second slot.
     if (dns_task_->needs_another_transaction())
       dns_task_->StartSecondTransaction();
+
+    // Don't hold the Requests up for long on a slow AAAA answer.
+    if (dns_task_->ipv4_completed_first() &&
+        !dns_task_->addr_list().empty() && num_active_requests() > 0) {
+      aaaa_delay_timer_.Start(
+          FROM_HERE,
+          base::TimeDelta::FromMilliseconds(kAAAAResolutionDelayMs),
+          this, &Job::OnAAAAResolutionDelayExpired);
+    }
+  }
+
+  // Completes the active Requests with the A answer while DnsTask keeps
+  // waiting for the AAAA one. The Job then carries on as a refresh, so the
+  // full answer still makes it to the cache.
+  void OnAAAAResolutionDelayExpired() {
+    DCHECK(is_dns_running());
+    served_early_ = true;
+    early_ttl_ = dns_task_->ttl();
+    early_addr_list_ = MakeAddressListForRequest(dns_task_->addr_list());
+    MarkAsRefresh();
+
+    net_log_.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB_SERVED_EARLY);
+
+    // Like CompleteRequests, but this Job stays in |jobs_|, so Requests
+    // attached by the callbacks are left for the final answer.
+    base::WeakPtr<Job> self = weak_ptr_factory_.GetWeakPtr();
+    const AddressList addr_list = early_addr_list_;
+    const size_t num_requests = requests_.size();
+    for (size_t i = 0; i < num_requests; ++i) {
+      Request* req = requests_[i];
+      if (req->was_canceled())
+        continue;
+
+      priority_tracker_.Remove(req->priority());
+      LogFinishRequest(req->source_net_log(), req->request_net_log(),
+                       req->info(), OK);
+      RecordTotalTime(had_dns_config_, req->info().is_speculative(),
+                      base::TimeTicks::Now() - req->request_time());
+      req->OnComplete(OK, addr_list);
+
+      // The callback may have aborted this Job, or destroyed the resolver
+      // and this Job with it.
+      if (!self.get())
+        return;
+    }
+    UpdatePriority();
   }
 
   // Performs Job's last rites. Completes all Requests. Deletes this.
@@ -1665,7 +1752,19 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       handle_.Reset();
     }
 
+    bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
+                        (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
+
     if (num_active_requests() == 0) {
+      if (is_refresh_ && did_complete) {
+        // Nobody is waiting, but the result is what the refresh was for. A
+        // failure is not cached, so it does not replace the stale entry.
+        net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
+                                          entry.error);
+        if (entry.error == OK)
+          resolver_->CacheResult(key_, entry, ttl);
+        return;
+      }
       net_log_.AddEvent(NetLog::TYPE_CANCELLED);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
@@ -1684,8 +1783,6 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                             resolver_->received_dns_config_);
     }
 
-    bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
-                        (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
     if (did_complete)
       resolver_->CacheResult(key_, entry, ttl);
 
@@ -1745,6 +1842,18 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Tracks the highest priority across |requests_|.
   PriorityTracker priority_tracker_;
 
+  // True if this Job refreshes the cache rather than serves its Requests.
+  bool is_refresh_;
+
+  // True if the Requests were served with the A answer alone. The answer is
+  // kept in case the AAAA transaction fails.
+  bool served_early_;
+  AddressList early_addr_list_;
+  base::TimeDelta early_ttl_;
+
+  // Caps how long the Requests wait for AAAA once A has been answered.
+  base::OneShotTimer<Job> aaaa_delay_timer_;
+
   bool had_non_speculative_request_;
 
   // Distinguishes measurements taken while DnsClient was fully configured.
@@ -1772,6 +1881,9 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   // A handle used in |HostResolverImpl::dispatcher_|.
   PrioritizedDispatcher::Handle handle_;
+
+  // Lets OnAAAAResolutionDelayExpired() notice that a callback deleted this.
+  base::WeakPtrFactory<Job> weak_ptr_factory_;
 };
 
 //-----------------------------------------------------------------------------
@@ -1857,6 +1969,12 @@ void HostResolverImpl::SetMaxQueuedJobs(size_t value) {
   max_queued_jobs_ = value;
 }
 
+void HostResolverImpl::SetMaxStaleAge(base::TimeDelta max_stale_age) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(max_stale_age >= base::TimeDelta());
+  max_stale_age_ = max_stale_age;
+}
+
 int HostResolverImpl::Resolve(const RequestInfo& info,
                               RequestPriority priority,
                               AddressList* addresses,
@@ -1889,6 +2007,16 @@ int HostResolverImpl::Resolve(const RequestInfo& info,
     return rv;
   }
 
+  // Rather than wait for a fresh result, use a recently expired one and get
+  // the fresh one for the next request.
+  if (ServeStaleFromCache(key, info, addresses)) {
+    request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
+    LogFinishRequest(source_net_log, request_net_log, info, OK);
+    RecordTotalTime(HaveDnsConfig(), info.is_speculative(), base::TimeDelta());
+    StartRefreshJob(key, request_net_log);
+    return OK;
+  }
+
   // Next we need to attach our request to a "job". This job is responsible for
   // calling "getaddrinfo(hostname)" on a worker thread.
 
@@ -2056,9 +2184,11 @@ bool HostResolverImpl::ServeFromCache(const Key& key,
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
-  if (!cache_entry)
+  // Stale entries are left in the cache for ServeStaleFromCache().
+  bool stale = false;
+  const HostCache::Entry* cache_entry = cache_->LookupStale(
+      key, base::TimeTicks::Now(), max_stale_age_, &stale);
+  if (!cache_entry || stale)
     return false;
 
   *net_error = cache_entry->error;
@@ -2070,6 +2200,48 @@ bool HostResolverImpl::ServeFromCache(const Key& key,
   return true;
 }
 
+bool HostResolverImpl::ServeStaleFromCache(const Key& key,
+                                           const RequestInfo& info,
+                                           AddressList* addresses) {
+  DCHECK(addresses);
+  if (max_stale_age_ == base::TimeDelta() || !info.allow_cached_response() ||
+      !cache_.get()) {
+    return false;
+  }
+
+  bool stale = false;
+  const HostCache::Entry* cache_entry = cache_->LookupStale(
+      key, base::TimeTicks::Now(), max_stale_age_, &stale);
+  // Only a success is worth serving after its TTL.
+  if (!cache_entry || cache_entry->error != OK)
+    return false;
+  DCHECK(stale);
+
+  *addresses = EnsurePortOnAddressList(cache_entry->addrlist, info.port());
+  return true;
+}
+
+void HostResolverImpl::StartRefreshJob(const Key& key,
+                                       const BoundNetLog& request_net_log) {
+  if (jobs_.find(key) != jobs_.end())
+    return;
+
+  Job* job = new Job(weak_ptr_factory_.GetWeakPtr(), key, IDLE,
+                     request_net_log);
+  job->MarkAsRefresh();
+  job->Schedule(false);
+
+  // A refresh is the first to go when the queue overflows.
+  if (dispatcher_.num_queued_jobs() > max_queued_jobs_) {
+    Job* evicted = static_cast<Job*>(dispatcher_.EvictOldestLowest());
+    DCHECK(evicted);
+    evicted->OnEvicted();  // Deletes |evicted|.
+    if (evicted == job)
+      return;
+  }
+  jobs_.insert(std::make_pair(key, job));
+}
+
 bool HostResolverImpl::ServeFromHosts(const Key& key,
                                       const RequestInfo& info,
                                       AddressList* addresses) {
@@ -56,6 +56,10 @@ class NetLog;
 // threads using PrioritizedDispatcher::Limits.
 //
 // Jobs are ordered in the queue based on their priority and order of arrival.
+//
+// If a maximum stale age is set, a request whose cache entry expired less than
+// that long ago is answered from the entry right away, and a Job without any
+// Requests is started at IDLE priority to refresh it.
 class NET_EXPORT HostResolverImpl
     : public HostResolver,
       NON_EXPORTED_BASE(public base::NonThreadSafe),
@@ -123,6 +127,11 @@ class NET_EXPORT HostResolverImpl
   // Only allowed when the queue is empty.
   void SetMaxQueuedJobs(size_t value);
 
+  // Configures how long after expiring a successful cache entry may still be
+  // returned by Resolve() while it is refreshed in the background. Zero, the
+  // default, disables serving stale entries.
+  void SetMaxStaleAge(base::TimeDelta max_stale_age);
+
   // Set the DnsClient to be used for resolution. In case of failure, the
   // HostResolverProc from ProcTaskParams will be queried. If the DnsClient is
   // not pre-configured with a valid DnsConfig, a new config is fetched from
@@ -185,6 +194,17 @@ class NET_EXPORT HostResolverImpl
                       int* net_error,
                       AddressList* addresses);
 
+  // If |key| is found in cache as a successful entry that expired less than
+  // |max_stale_age_| ago, returns true and fills |addresses|. Otherwise
+  // returns false.
+  bool ServeStaleFromCache(const Key& key,
+                           const RequestInfo& info,
+                           AddressList* addresses);
+
+  // Starts a Job without Requests to refresh the cache entry for |key|, unless
+  // a Job for |key| already exists.
+  void StartRefreshJob(const Key& key, const BoundNetLog& request_net_log);
+
   // If we have a DnsClient with a valid DnsConfig, and |key| is found in the
   // HOSTS file, returns true and fills |addresses|. Otherwise returns false.
   bool ServeFromHosts(const Key& key,
@@ -253,6 +273,9 @@ class NET_EXPORT HostResolverImpl
   // Limit on the maximum number of jobs queued in |dispatcher_|.
   size_t max_queued_jobs_;
 
+  // How long after expiring a cache entry can be served while refreshed.
+  base::TimeDelta max_stale_age_;
+
   // Parameters for ProcTask.
   ProcTaskParams proc_params_;
 
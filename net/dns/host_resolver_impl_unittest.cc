@@ -413,6 +413,19 @@ class LookupAttemptHostResolverProc : public HostResolverProc {
   base::ConditionVariable all_done_;
 };
 
+// Moves the expiration of every entry in |cache| a minute into the past.
+void ExpireCacheEntries(HostCache* cache) {
+  std::vector<std::pair<HostCache::Key, HostCache::Entry> > entries;
+  for (HostCache::EntryMap::Iterator it(cache->entries()); it.HasNext();
+       it.Advance()) {
+    entries.push_back(std::make_pair(it.key(), it.value()));
+  }
+  const base::TimeDelta kTTL = base::TimeDelta::FromMinutes(1);
+  base::TimeTicks then = base::TimeTicks::Now() - 2 * kTTL;
+  for (size_t i = 0; i < entries.size(); ++i)
+    cache->Set(entries[i].first, entries[i].second, then, kTTL);
+}
+
 }  // namespace
 
 class HostResolverImplTest : public testing::Test {
@@ -1252,6 +1265,90 @@ TEST_F(HostResolverImplTest, ResolveFromCache) {
   EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
 }
 
+// Test that an expired entry is served while the resolver refreshes it.
+TEST_F(HostResolverImplTest, ServeStaleWhileRefreshing) {
+  resolver_->SetMaxStaleAge(base::TimeDelta::FromHours(1));
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+  proc_->SignalMultiple(1u);
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+
+  ExpireCacheEntries(resolver_->GetHostCache());
+  EXPECT_EQ(1u, resolver_->GetHostCache()->size());
+
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.43");
+
+  // The stale entry only answers a request that can wait for a refresh.
+  EXPECT_EQ(ERR_DNS_CACHE_MISS,
+            CreateRequest("just.testing", 80)->ResolveFromCache());
+  EXPECT_EQ(OK, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
+
+  // Bypassing the cache joins the refresh.
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  info.set_allow_cached_response(false);
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info, DEFAULT_PRIORITY)->Resolve());
+  proc_->SignalMultiple(1u);
+  EXPECT_EQ(OK, requests_[3]->WaitForResult());
+  EXPECT_TRUE(requests_[3]->HasOneAddress("192.168.1.43", 80));
+  EXPECT_EQ(2u, proc_->GetCaptureList().size());
+
+  EXPECT_EQ(OK, CreateRequest("just.testing", 80)->ResolveFromCache());
+  EXPECT_TRUE(requests_[4]->HasOneAddress("192.168.1.43", 80));
+}
+
+// Test that a canceled request does not stop the refresh it joined.
+TEST_F(HostResolverImplTest, RefreshOutlivesCanceledRequest) {
+  resolver_->SetMaxStaleAge(base::TimeDelta::FromHours(1));
+  proc_->SignalMultiple(1u);
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+
+  ExpireCacheEntries(resolver_->GetHostCache());
+
+  // The stale entry is served and starts the refresh.
+  EXPECT_EQ(OK, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_TRUE(proc_->WaitFor(1u));
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  info.set_allow_cached_response(false);
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info, DEFAULT_PRIORITY)->Resolve());
+  requests_[2]->Cancel();
+
+  // The refresh still completes and updates the cache.
+  proc_->SignalMultiple(1u);
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info, DEFAULT_PRIORITY)->Resolve());
+  EXPECT_EQ(OK, requests_[3]->WaitForResult());
+  EXPECT_EQ(2u, proc_->GetCaptureList().size());
+  EXPECT_EQ(OK, CreateRequest("just.testing", 80)->ResolveFromCache());
+}
+
+// Test that a failed refresh leaves the stale entry in the cache.
+TEST_F(HostResolverImplTest, FailedRefreshKeepsStaleEntry) {
+  CreateSerialResolver();  // So the refresh finishes before the next job.
+  resolver_->SetMaxStaleAge(base::TimeDelta::FromHours(1));
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+  proc_->AddRuleForAllFamilies("other.testing", "192.168.1.43");
+  proc_->SignalMultiple(3u);
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+
+  ExpireCacheEntries(resolver_->GetHostCache());
+  proc_->AddRuleForAllFamilies("just.testing", std::string());
+
+  // Served stale, and refreshed in the background, which fails.
+  EXPECT_EQ(OK, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("other.testing", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[2]->WaitForResult());
+  EXPECT_EQ(3u, proc_->GetCaptureList().size());
+
+  EXPECT_EQ(OK, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_TRUE(requests_[3]->HasOneAddress("192.168.1.42", 80));
+}
+
 // Test the retry attempts simulating host resolver proc that takes too long.
 TEST_F(HostResolverImplTest, MultipleAttempts) {
   // Total number of attempts would be 3 and we want the 3rd attempt to resolve
@@ -1878,6 +1975,62 @@ TEST_F(HostResolverImplDnsTest, AAAACompletesFirst) {
   EXPECT_EQ(ERR_DNS_TIMED_OUT, requests_[2]->result());
 }
 
+// Test that a slow AAAA answer doesn't hold up the A one for long, and still
+// makes it to the cache.
+TEST_F(HostResolverImplDnsTest, AAAAResolutionDelay) {
+  set_fallback_to_proctask(false);
+  resolver_->SetDefaultAddressFamily(ADDRESS_FAMILY_UNSPECIFIED);
+  ChangeDnsConfig(CreateValidDnsConfig());
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 80)->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 81)->Resolve());
+
+  // Both Requests are served with the A answer once the delay expires.
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_EQ(OK, requests_[1]->WaitForResult());
+  EXPECT_TRUE(requests_[0]->HasOneAddress("127.0.0.1", 80));
+  EXPECT_TRUE(requests_[1]->HasOneAddress("127.0.0.1", 81));
+  // The Job is still waiting for AAAA.
+  EXPECT_EQ(1u, num_running_dispatcher_jobs());
+  EXPECT_EQ(ERR_DNS_CACHE_MISS,
+            CreateRequest("6slow_ok", 80)->ResolveFromCache());
+
+  dns_client_->CompleteDelayedTransactions();
+  EXPECT_EQ(0u, num_running_dispatcher_jobs());
+  EXPECT_EQ(OK, CreateRequest("6slow_ok", 80)->ResolveFromCache());
+  EXPECT_EQ(2u, requests_[3]->NumberOfAddresses());
+  EXPECT_TRUE(requests_[3]->HasAddress("127.0.0.1", 80));
+  EXPECT_TRUE(requests_[3]->HasAddress("::1", 80));
+}
+
+// Test that a Request served with the A answer can abort the Job from its
+// callback without the other Requests being touched afterwards.
+TEST_F(HostResolverImplDnsTest, AbortJobServedEarly) {
+  struct MyHandler : public Handler {
+    virtual void Handle(Request* req) OVERRIDE {
+      if (req->index() != 0)
+        return;
+      // Aborts all jobs, which deletes the one that served |req|.
+      base::MessageLoop::ScopedNestableTaskAllower allow(
+          base::MessageLoop::current());
+      NetworkChangeNotifier::NotifyObserversOfIPAddressChangeForTests();
+      base::MessageLoop::current()->RunUntilIdle();
+    }
+  };
+  set_handler(new MyHandler());
+
+  set_fallback_to_proctask(false);
+  resolver_->SetDefaultAddressFamily(ADDRESS_FAMILY_UNSPECIFIED);
+  ChangeDnsConfig(CreateValidDnsConfig());
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 80)->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 81)->Resolve());
+
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_EQ(ERR_NETWORK_CHANGED, requests_[1]->result());
+  EXPECT_EQ(0u, num_running_dispatcher_jobs());
+}
+
 // Test the case where only a single transaction slot is available.
 TEST_F(HostResolverImplDnsTest, SerialResolver) {
   CreateSerialResolver();
@@ -13,10 +13,71 @@
 #include "base/metrics/histogram.h"
 #include "net/base/sdch_manager.h"
 
+#include "sdch/open-vcdiff/src/google/output_string.h"
 #include "sdch/open-vcdiff/src/google/vcdecoder.h"
 
 namespace net {
 
+namespace {
+
+// Lets the decoder write straight into the destination buffer of
+// ReadFilteredData(), rather than into a string which is then copied.  Only
+// the output which doesn't fit is buffered, in |excess|.
+class DestBufferOutput : public open_vcdiff::OutputStringInterface {
+ public:
+  DestBufferOutput(char* dest_buffer, size_t available_space,
+                   std::string* excess)
+      : dest_buffer_(dest_buffer),
+        available_space_(available_space),
+        excess_(excess),
+        bytes_written_(0),
+        size_(0) {
+  }
+
+  virtual OutputStringInterface& append(const char* s, size_t n) OVERRIDE {
+    size_t amount = std::min(n, available_space_);
+    memcpy(dest_buffer_ + bytes_written_, s, amount);
+    bytes_written_ += amount;
+    available_space_ -= amount;
+    if (amount < n)
+      excess_->append(s + amount, n - amount);
+    size_ += n;
+    return *this;
+  }
+
+  virtual void clear() OVERRIDE {
+    // The streaming decoder only ever appends.
+    NOTREACHED();
+  }
+
+  virtual void push_back(char c) OVERRIDE {
+    append(&c, 1);
+  }
+
+  virtual void ReserveAdditionalBytes(size_t res_arg) OVERRIDE {
+    if (res_arg > available_space_)
+      excess_->reserve(excess_->size() + res_arg - available_space_);
+  }
+
+  virtual size_t size() const OVERRIDE {
+    return size_;
+  }
+
+  // The number of bytes written to the destination buffer.
+  size_t bytes_written() const { return bytes_written_; }
+
+ private:
+  char* const dest_buffer_;
+  size_t available_space_;
+  std::string* const excess_;
+  size_t bytes_written_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(DestBufferOutput);
+};
+
+}  // namespace
+
 SdchFilter::SdchFilter(const FilterContext& filter_context)
     : filter_context_(filter_context),
       decoding_status_(DECODING_UNINITIALIZED),
@@ -287,13 +348,14 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
   if (!next_stream_data_ || stream_data_len_ <= 0)
     return FILTER_NEED_MORE_DATA;
 
-  bool ret = vcdiff_streaming_decoder_->DecodeChunk(
-    next_stream_data_, stream_data_len_, &dest_buffer_excess_);
+  DestBufferOutput output(dest_buffer, available_space, &dest_buffer_excess_);
+  bool ret = vcdiff_streaming_decoder_->DecodeChunkToInterface(
+    next_stream_data_, stream_data_len_, &output);
   // Assume all data was used in decoding.
   next_stream_data_ = NULL;
   source_bytes_ += stream_data_len_;
   stream_data_len_ = 0;
-  output_bytes_ += dest_buffer_excess_.size();
+  output_bytes_ += output.size();
   if (!ret) {
     vcdiff_streaming_decoder_.reset(NULL);  // Don't call it again.
     decoding_status_ = DECODING_ERROR;
@@ -301,9 +363,8 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
     return FILTER_ERROR;
   }
 
-  amount = OutputBufferExcess(dest_buffer, available_space);
+  amount = static_cast<int>(output.bytes_written());
   *dest_len += amount;
-  dest_buffer += amount;
   available_space -= amount;
   if (0 == available_space && !dest_buffer_excess_.empty())
       return FILTER_OK;
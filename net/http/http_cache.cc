@@ -45,6 +45,9 @@
 
 namespace {
 
+// How much of the body a background revalidation reads at a time.
+const int kAsyncValidationBufferSize = 32 * 1024;
+
 // Adaptor to delete a file on a worker thread.
 void DeletePath(base::FilePath path) {
   base::DeleteFile(path, false);
@@ -269,6 +272,89 @@ void HttpCache::MetadataWriter::OnIOComplete(int result) {
 
 //-----------------------------------------------------------------------------
 
+// This class encapsulates a transaction which revalidates a stale entry in the
+// background, on behalf of a request which was served the stale entry.  The
+// body is read and thrown away, so that the cache stores it.
+class HttpCache::AsyncValidation {
+ public:
+  AsyncValidation(const HttpRequestInfo& original_request,
+                  const std::string& key,
+                  HttpCache* cache)
+      : request_(original_request),
+        key_(key),
+        cache_(cache) {
+    // The original request's upload data doesn't outlive it.
+    request_.upload_data_stream = NULL;
+    // Makes sure the revalidation isn't served from the cache itself.
+    request_.load_flags |= LOAD_VALIDATE_CACHE;
+  }
+
+  ~AsyncValidation() {}
+
+  // Starts revalidating, with |transaction|.  May delete this object before
+  // returning.
+  void Start(scoped_ptr<HttpCache::Transaction> transaction,
+             const BoundNetLog& net_log);
+
+ private:
+  void OnStarted(int result);
+  void DoRead();
+  void OnRead(int result);
+
+  // Deletes this object.
+  void Terminate();
+
+  HttpRequestInfo request_;
+  const std::string key_;
+  HttpCache* const cache_;
+  scoped_ptr<HttpCache::Transaction> transaction_;
+  scoped_refptr<IOBuffer> buf_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncValidation);
+};
+
+void HttpCache::AsyncValidation::Start(
+    scoped_ptr<HttpCache::Transaction> transaction,
+    const BoundNetLog& net_log) {
+  transaction_ = transaction.Pass();
+  int rv = transaction_->Start(
+      &request_,
+      base::Bind(&AsyncValidation::OnStarted, base::Unretained(this)),
+      net_log);
+  if (rv != ERR_IO_PENDING)
+    OnStarted(rv);
+}
+
+void HttpCache::AsyncValidation::OnStarted(int result) {
+  if (result != OK)
+    return Terminate();
+  buf_ = new IOBuffer(kAsyncValidationBufferSize);
+  DoRead();
+}
+
+void HttpCache::AsyncValidation::DoRead() {
+  int rv;
+  do {
+    rv = transaction_->Read(
+        buf_.get(), kAsyncValidationBufferSize,
+        base::Bind(&AsyncValidation::OnRead, base::Unretained(this)));
+  } while (rv > 0);
+  if (rv != ERR_IO_PENDING)
+    Terminate();
+}
+
+void HttpCache::AsyncValidation::OnRead(int result) {
+  if (result > 0)
+    return DoRead();
+  Terminate();
+}
+
+void HttpCache::AsyncValidation::Terminate() {
+  cache_->DeleteAsyncValidation(key_);
+}
+
+//-----------------------------------------------------------------------------
+
 class HttpCache::QuicServerInfoFactoryAdaptor : public QuicServerInfoFactory {
  public:
   QuicServerInfoFactoryAdaptor(HttpCache* http_cache)
@@ -316,6 +402,10 @@ HttpCache::HttpCache(HttpTransactionFactory* network_layer,
 }
 
 HttpCache::~HttpCache() {
+  // Background revalidations are abandoned.  Their transactions still tell
+  // their entries that they are going away, so they go first.
+  STLDeleteValues(&async_validations_);
+
   // If we have any active entries remaining, then we need to deactivate them.
   // We may have some pending calls to OnProcessPendingQueue, but since those
   // won't run (due to our destruction), we can simply ignore the corresponding
@@ -1007,6 +1097,29 @@ void HttpCache::ProcessPendingQueue(ActiveEntry* entry) {
       base::Bind(&HttpCache::OnProcessPendingQueue, AsWeakPtr(), entry));
 }
 
+void HttpCache::PerformAsyncValidation(const HttpRequestInfo& original_request,
+                                       const BoundNetLog& net_log) {
+  std::string key = GenerateCacheKey(&original_request);
+  // Only one revalidation is needed, however many requests see the stale
+  // entry.
+  if (async_validations_.find(key) != async_validations_.end())
+    return;
+
+  AsyncValidation* validation =
+      new AsyncValidation(original_request, key, this);
+  async_validations_[key] = validation;
+  validation->Start(
+      scoped_ptr<Transaction>(new Transaction(IDLE, this)), net_log);
+}
+
+void HttpCache::DeleteAsyncValidation(const std::string& key) {
+  AsyncValidationMap::iterator it = async_validations_.find(key);
+  DCHECK(it != async_validations_.end());
+  AsyncValidation* validation = it->second;
+  async_validations_.erase(it);
+  delete validation;
+}
+
 void HttpCache::OnProcessPendingQueue(ActiveEntry* entry) {
   entry->will_process_pending_queue = false;
   DCHECK(!entry->writer);
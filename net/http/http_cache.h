@@ -43,6 +43,7 @@ class Entry;
 
 namespace net {
 
+class BoundNetLog;
 class CertVerifier;
 class HostResolver;
 class HttpAuthHandlerFactory;
@@ -218,6 +219,7 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
  private:
   // Types --------------------------------------------------------------------
 
+  class AsyncValidation;
   class MetadataWriter;
   class QuicServerInfoFactoryAdaptor;
   class Transaction;
@@ -244,6 +246,7 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   typedef base::hash_map<std::string, PendingOp*> PendingOpsMap;
   typedef std::set<ActiveEntry*> ActiveEntriesSet;
   typedef base::hash_map<std::string, int> PlaybackCacheMap;
+  typedef base::hash_map<std::string, AsyncValidation*> AsyncValidationMap;
 
   // Methods ------------------------------------------------------------------
 
@@ -358,6 +361,15 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // Resumes processing the pending list of |entry|.
   void ProcessPendingQueue(ActiveEntry* entry);
 
+  // Revalidates the cached response to |original_request| in the background,
+  // unless that is already happening.  The revalidation bypasses the
+  // stale-while-revalidate window, and may update or replace the entry.
+  void PerformAsyncValidation(const HttpRequestInfo& original_request,
+                              const BoundNetLog& net_log);
+
+  // Called by an AsyncValidation when it is done, and deletes it.
+  void DeleteAsyncValidation(const std::string& key);
+
   // Events (called via PostTask) ---------------------------------------------
 
   void OnProcessPendingQueue(ActiveEntry* entry);
@@ -407,6 +419,10 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
 
   scoped_ptr<PlaybackCacheMap> playback_cache_map_;
 
+  // The background revalidations in progress, indexed by cache key.  There is
+  // at most one per entry.
+  AsyncValidationMap async_validations_;
+
   DISALLOW_COPY_AND_ASSIGN(HttpCache);
 };
 
@@ -121,6 +121,10 @@ void RecordVaryHeaderHistogram(const net::HttpResponseInfo* response) {
 
 namespace net {
 
+// The most body data that is read from the cache along with the headers of a
+// cached response.
+static const int kMaxPrefetchSize = 32 * 1024;
+
 struct HeaderNameAndValue {
   const char* name;
   const char* value;
@@ -205,6 +209,7 @@ HttpCache::Transaction::Transaction(
       couldnt_conditionalize_request_(false),
       io_buf_len_(0),
       read_offset_(0),
+      prefetch_len_(0),
       effective_load_flags_(0),
       write_len_(0),
       weak_factory_(this),
@@ -1437,6 +1442,22 @@ int HttpCache::Transaction::DoCacheReadResponse() {
   read_buf_ = new IOBuffer(io_buf_len_);
 
   net_log_.BeginEvent(NetLog::TYPE_HTTP_CACHE_READ_INFO);
+
+  // When the body is likely to be served from the cache, read its start with
+  // the headers so that small responses take a single trip to the backend.
+  prefetch_buf_ = NULL;
+  prefetch_len_ = 0;
+  int body_size = entry_->disk_entry->GetDataSize(kResponseContentIndex);
+  if (!partial_.get() && !range_requested_ && (mode_ & READ_DATA) &&
+      body_size > 0) {
+    prefetch_len_ = std::min(body_size, kMaxPrefetchSize);
+    prefetch_buf_ = new IOBuffer(prefetch_len_);
+    return entry_->disk_entry->ReadDataWithPrefetch(
+        kResponseInfoIndex, 0, read_buf_.get(), io_buf_len_,
+        kResponseContentIndex, prefetch_buf_.get(), prefetch_len_,
+        io_callback_);
+  }
+
   return entry_->disk_entry->ReadData(kResponseInfoIndex, 0, read_buf_.get(),
                                       io_buf_len_, io_callback_);
 }
@@ -1454,6 +1475,11 @@ int HttpCache::Transaction::DoCacheReadResponseComplete(int result) {
   if (response_.headers->GetContentLength() == current_size)
     truncated_ = false;
 
+  // The prefetched body is only usable for complete entries read from the
+  // start.
+  if (truncated_)
+    prefetch_buf_ = NULL;
+
   // We now have access to the cache entry.
   //
   //  o if we are a reader for the transaction, then we can start reading the
@@ -1572,6 +1598,15 @@ int HttpCache::Transaction::DoCacheReadData() {
                                io_callback_);
   }
 
+  if (prefetch_buf_.get()) {
+    if (read_offset_ < prefetch_len_) {
+      int len = std::min(io_buf_len_, prefetch_len_ - read_offset_);
+      memcpy(read_buf_->data(), prefetch_buf_->data() + read_offset_, len);
+      return len;
+    }
+    prefetch_buf_ = NULL;
+  }
+
   return entry_->disk_entry->ReadData(kResponseContentIndex, read_offset_,
                                       read_buf_.get(), io_buf_len_,
                                       io_callback_);
@@ -1818,7 +1853,15 @@ int HttpCache::Transaction::BeginCacheRead() {
 int HttpCache::Transaction::BeginCacheValidation() {
   DCHECK(mode_ == READ_WRITE);
 
-  bool skip_validation = !RequiresValidation();
+  ValidationType required_validation = RequiresValidation();
+  bool skip_validation = required_validation == VALIDATION_NONE;
+
+  if (required_validation == VALIDATION_ASYNCHRONOUS && !truncated_ &&
+      !partial_.get()) {
+    // Serve the stale entry now, and let the cache refresh it.
+    cache_->PerformAsyncValidation(*request_, net_log_);
+    skip_validation = true;
+  }
 
   if (truncated_) {
     // Truncated entries can cause partial gets, so we shouldn't record this
@@ -1970,37 +2013,46 @@ int HttpCache::Transaction::RestartNetworkRequestWithAuth(
   return rv;
 }
 
-bool HttpCache::Transaction::RequiresValidation() {
+HttpCache::Transaction::ValidationType
+HttpCache::Transaction::RequiresValidation() {
   // TODO(darin): need to do more work here:
   //  - make sure we have a matching request method
   //  - watch out for cached responses that depend on authentication
 
   // In playback mode, nothing requires validation.
   if (cache_->mode() == net::HttpCache::PLAYBACK)
-    return false;
+    return VALIDATION_NONE;
 
   if (response_.vary_data.is_valid() &&
       !response_.vary_data.MatchesRequest(*request_,
                                           *response_.headers.get())) {
     vary_mismatch_ = true;
-    return true;
+    return VALIDATION_SYNCHRONOUS;
   }
 
   if (effective_load_flags_ & LOAD_PREFERRING_CACHE)
-    return false;
+    return VALIDATION_NONE;
 
+  // This includes the background revalidations started by the cache.
   if (effective_load_flags_ & LOAD_VALIDATE_CACHE)
-    return true;
+    return VALIDATION_SYNCHRONOUS;
 
   if (request_->method == "PUT" || request_->method == "DELETE")
-    return true;
+    return VALIDATION_SYNCHRONOUS;
 
-  if (response_.headers->RequiresValidation(
-          response_.request_time, response_.response_time, Time::Now())) {
-    return true;
+  Time now = Time::Now();
+  if (!response_.headers->RequiresValidation(
+          response_.request_time, response_.response_time, now)) {
+    return VALIDATION_NONE;
   }
 
-  return false;
+  if (request_->method == "GET" &&
+      response_.headers->CanRevalidateAsynchronously(
+          response_.request_time, response_.response_time, now)) {
+    return VALIDATION_ASYNCHRONOUS;
+  }
+
+  return VALIDATION_SYNCHRONOUS;
 }
 
 bool HttpCache::Transaction::ConditionalizeRequest() {
@@ -2248,6 +2300,10 @@ int HttpCache::Transaction::WriteToEntry(int index, int offset,
   if (!entry_)
     return data_len;
 
+  // Anything written invalidates the body read along with the headers.
+  if (index == kResponseContentIndex)
+    prefetch_buf_ = NULL;
+
   int rv = 0;
   if (!partial_.get() || !data_len) {
     rv = entry_->disk_entry->WriteData(index, offset, data, data_len, callback,
@@ -2329,6 +2385,8 @@ int HttpCache::Transaction::OnCacheReadError(int result, bool restart) {
                                 result_for_histogram);
   }
 
+  prefetch_buf_ = NULL;
+
   // Avoid using this entry in the future.
   if (cache_.get())
     cache_->DoomActiveEntry(cache_key_);
@@ -207,6 +207,17 @@ class HttpCache::Transaction : public HttpTransaction {
     PATTERN_MAX,
   };
 
+  // What a cached response needs before it can be used.
+  enum ValidationType {
+    // Nothing, the response is fresh.
+    VALIDATION_NONE,
+    // The response is stale, but may be used while it is revalidated in the
+    // background.
+    VALIDATION_ASYNCHRONOUS,
+    // The response can't be used until it has been revalidated.
+    VALIDATION_SYNCHRONOUS,
+  };
+
   // This is a helper function used to trigger a completion callback.  It may
   // only be called if callback_ is non-null.
   void DoCallback(int rv);
@@ -299,8 +310,9 @@ class HttpCache::Transaction : public HttpTransaction {
   // Returns network error code.
   int RestartNetworkRequestWithAuth(const AuthCredentials& credentials);
 
-  // Called to determine if we need to validate the cache entry before using it.
-  bool RequiresValidation();
+  // Called to determine if we need to validate the cache entry before using it,
+  // and whether that can happen in the background.
+  ValidationType RequiresValidation();
 
   // Called to make the request conditional (to ask the server if the cached
   // copy is valid).  Returns true if able to make the request conditional.
@@ -415,6 +427,9 @@ class HttpCache::Transaction : public HttpTransaction {
   scoped_refptr<IOBuffer> read_buf_;
   int io_buf_len_;
   int read_offset_;
+  // The start of the body, read along with the response info.
+  scoped_refptr<IOBuffer> prefetch_buf_;
+  int prefetch_len_;
   int effective_load_flags_;
   int write_len_;
   scoped_ptr<PartialData> partial_;  // We are dealing with range requests.
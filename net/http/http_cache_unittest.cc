@@ -1977,6 +1977,109 @@ TEST(HttpCache, ETagGET_ConditionalRequest_304) {
   TestLoadTimingNetworkRequest(load_timing_info);
 }
 
+// Tests that a stale entry within its stale-while-revalidate window is used
+// right away, and revalidated in the background.
+TEST(HttpCache, ETagGET_StaleWhileRevalidate) {
+  MockHttpCache cache;
+
+  ScopedMockTransaction transaction(kETagGET_Transaction);
+  transaction.response_headers =
+      "Cache-Control: max-age=0, stale-while-revalidate=86400\n"
+      "Etag: \"foopy\"\n";
+
+  // Write to the cache.
+  RunTransactionTest(cache.http_cache(), transaction);
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+
+  // The stale entry is used without waiting for the network.
+  transaction.handler = ETagGet_ConditionalRequest_Handler;
+  net::HttpResponseInfo response_info;
+  RunTransactionTestWithResponseInfo(cache.http_cache(), transaction,
+                                     &response_info);
+  EXPECT_FALSE(response_info.network_accessed);
+  EXPECT_TRUE(response_info.was_cached);
+
+  // Let the revalidation finish.
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+
+  // The 304 made the entry fresh again.
+  transaction.handler = NULL;
+  RunTransactionTestWithResponseInfo(cache.http_cache(), transaction,
+                                     &response_info);
+  EXPECT_FALSE(response_info.network_accessed);
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+}
+
+// Tests that requests which see the same stale entry share one background
+// revalidation.
+TEST(HttpCache, ETagGET_StaleWhileRevalidate_Coalesced) {
+  MockHttpCache cache;
+
+  ScopedMockTransaction transaction(kETagGET_Transaction);
+  transaction.response_headers =
+      "Cache-Control: max-age=0, stale-while-revalidate=86400\n"
+      "Etag: \"foopy\"\n";
+  RunTransactionTest(cache.http_cache(), transaction);
+
+  transaction.handler = ETagGet_ConditionalRequest_Handler;
+  std::vector<Context*> context_list;
+  const int kNumTransactions = 3;
+  for (int i = 0; i < kNumTransactions; ++i) {
+    context_list.push_back(new Context());
+    Context* c = context_list[i];
+    c->result = cache.CreateTransaction(&c->trans);
+    ASSERT_EQ(net::OK, c->result);
+  }
+
+  // Start all the transactions before any revalidation can complete.
+  MockHttpRequest request(transaction);
+  for (int i = 0; i < kNumTransactions; ++i) {
+    Context* c = context_list[i];
+    c->result = c->trans->Start(&request, c->callback.callback(),
+                                net::BoundNetLog());
+  }
+  for (int i = 0; i < kNumTransactions; ++i) {
+    Context* c = context_list[i];
+    if (c->result == net::ERR_IO_PENDING)
+      c->result = c->callback.WaitForResult();
+    ASSERT_EQ(net::OK, c->result);
+    EXPECT_FALSE(c->trans->GetResponseInfo()->network_accessed);
+    ReadAndVerifyTransaction(c->trans.get(), transaction);
+  }
+  STLDeleteElements(&context_list);
+
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+}
+
+// Tests that a stale entry past its stale-while-revalidate window is
+// revalidated before being used.
+TEST(HttpCache, ETagGET_StaleWhileRevalidate_Expired) {
+  MockHttpCache cache;
+
+  ScopedMockTransaction transaction(kETagGET_Transaction);
+  transaction.response_headers =
+      "Cache-Control: max-age=0, stale-while-revalidate=60\n"
+      "Etag: \"foopy\"\n";
+  transaction.request_time =
+      base::Time::Now() - base::TimeDelta::FromMinutes(5);
+  transaction.response_time = transaction.request_time;
+  RunTransactionTest(cache.http_cache(), transaction);
+
+  transaction.handler = ETagGet_ConditionalRequest_Handler;
+  net::HttpResponseInfo response_info;
+  RunTransactionTestWithResponseInfo(cache.http_cache(), transaction,
+                                     &response_info);
+  EXPECT_TRUE(response_info.network_accessed);
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+}
+
 class RevalidationServer {
  public:
   RevalidationServer() {
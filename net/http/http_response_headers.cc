@@ -919,6 +919,44 @@ bool HttpResponseHeaders::RequiresValidation(const Time& request_time,
   return lifetime <= GetCurrentAge(request_time, response_time, current_time);
 }
 
+// From RFC 5861 section 3:
+//
+//   When present in an HTTP response, the stale-while-revalidate Cache-
+//   Control extension indicates that caches MAY serve the response in
+//   which it appears after it becomes stale, up to the indicated number
+//   of seconds.
+//
+// The cache revalidates the response in the background while it does so.
+// Responses which may never be used without validation, or which have
+// must-revalidate, don't qualify.
+//
+bool HttpResponseHeaders::CanRevalidateAsynchronously(
+    const Time& request_time,
+    const Time& response_time,
+    const Time& current_time) const {
+  if (IsNeverFresh() || HasHeaderValue("cache-control", "must-revalidate"))
+    return false;
+
+  TimeDelta stale_while_revalidate;
+  if (!GetStaleWhileRevalidateValue(&stale_while_revalidate))
+    return false;
+
+  // Written as a difference, as the freshness lifetime may be "infinite".
+  TimeDelta staleness =
+      GetCurrentAge(request_time, response_time, current_time) -
+      GetFreshnessLifetime(response_time);
+  return staleness < stale_while_revalidate;
+}
+
+bool HttpResponseHeaders::IsNeverFresh() const {
+  // For backwards compat, we treat "Pragma: no-cache" as a synonym for
+  // "Cache-Control: no-cache" even though RFC 2616 does not specify it.
+  return HasHeaderValue("cache-control", "no-cache") ||
+         HasHeaderValue("cache-control", "no-store") ||
+         HasHeaderValue("pragma", "no-cache") ||
+         HasHeaderValue("vary", "*");  // see RFC 2616 section 13.6
+}
+
 // From RFC 2616 section 13.2.4:
 //
 // The max-age directive takes priority over Expires, so if max-age is present
@@ -941,13 +979,8 @@ bool HttpResponseHeaders::RequiresValidation(const Time& request_time,
 //
 TimeDelta HttpResponseHeaders::GetFreshnessLifetime(
     const Time& response_time) const {
-  // Check for headers that force a response to never be fresh.  For backwards
-  // compat, we treat "Pragma: no-cache" as a synonym for "Cache-Control:
-  // no-cache" even though RFC 2616 does not specify it.
-  if (HasHeaderValue("cache-control", "no-cache") ||
-      HasHeaderValue("cache-control", "no-store") ||
-      HasHeaderValue("pragma", "no-cache") ||
-      HasHeaderValue("vary", "*"))  // see RFC 2616 section 13.6
+  // Check for headers that force a response to never be fresh.
+  if (IsNeverFresh())
     return TimeDelta();  // not fresh
 
   // NOTE: "Cache-Control: max-age" overrides Expires, so we only check the
@@ -1065,20 +1098,29 @@ TimeDelta HttpResponseHeaders::GetCurrentAge(const Time& request_time,
 }
 
 bool HttpResponseHeaders::GetMaxAgeValue(TimeDelta* result) const {
+  return GetCacheControlDelta("max-age=", result);
+}
+
+bool HttpResponseHeaders::GetStaleWhileRevalidateValue(
+    TimeDelta* result) const {
+  return GetCacheControlDelta("stale-while-revalidate=", result);
+}
+
+bool HttpResponseHeaders::GetCacheControlDelta(const char* directive,
+                                               TimeDelta* result) const {
   std::string name = "cache-control";
   std::string value;
 
-  const char kMaxAgePrefix[] = "max-age=";
-  const size_t kMaxAgePrefixLen = arraysize(kMaxAgePrefix) - 1;
+  const size_t directive_len = strlen(directive);
 
   void* iter = NULL;
   while (EnumerateHeader(&iter, name, &value)) {
-    if (value.size() > kMaxAgePrefixLen) {
+    if (value.size() > directive_len) {
       if (LowerCaseEqualsASCII(value.begin(),
-                               value.begin() + kMaxAgePrefixLen,
-                               kMaxAgePrefix)) {
+                               value.begin() + directive_len,
+                               directive)) {
         int64 seconds;
-        base::StringToInt64(StringPiece(value.begin() + kMaxAgePrefixLen,
+        base::StringToInt64(StringPiece(value.begin() + directive_len,
                                         value.end()),
                             &seconds);
         *result = TimeDelta::FromSeconds(seconds);
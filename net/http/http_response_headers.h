@@ -199,6 +199,14 @@ class NET_EXPORT HttpResponseHeaders
                           const base::Time& response_time,
                           const base::Time& current_time) const;
 
+  // Returns true if a response which RequiresValidation() may still be used
+  // while it is revalidated in the background, as allowed by the
+  // stale-while-revalidate Cache-Control extension (RFC 5861).  See
+  // RequiresValidation for a description of this method's parameters.
+  bool CanRevalidateAsynchronously(const base::Time& request_time,
+                                   const base::Time& response_time,
+                                   const base::Time& current_time) const;
+
   // Returns the amount of time the server claims the response is fresh from
   // the time the response was generated.  See section 13.2.4 of RFC 2616.  See
   // RequiresValidation for a description of the response_time parameter.
@@ -214,6 +222,7 @@ class NET_EXPORT HttpResponseHeaders
   // value is not present, then false is returned.  Otherwise, true is returned
   // and the out param is assigned to the corresponding value.
   bool GetMaxAgeValue(base::TimeDelta* value) const;
+  bool GetStaleWhileRevalidateValue(base::TimeDelta* value) const;
   bool GetAgeValue(base::TimeDelta* value) const;
   bool GetDateValue(base::Time* value) const;
   bool GetLastModifiedValue(base::Time* value) const;
@@ -330,6 +339,15 @@ class NET_EXPORT HttpResponseHeaders
                        std::string::const_iterator line_end,
                        bool has_headers);
 
+  // Returns true if the response may never be used without validation.
+  bool IsNeverFresh() const;
+
+  // Extracts the value of the |directive| Cache-Control directive, which is
+  // given in seconds, e.g. "max-age=".  |directive| is lower case and
+  // includes the "=".
+  bool GetCacheControlDelta(const char* directive,
+                            base::TimeDelta* result) const;
+
   // Find the header in our list (case-insensitive) starting with parsed_ at
   // index |from|.  Returns string::npos if not found.
   size_t FindHeader(size_t from, const base::StringPiece& name) const;
@@ -872,6 +872,60 @@ TEST(HttpResponseHeadersTest, RequiresValidation) {
   }
 }
 
+TEST(HttpResponseHeadersTest, CanRevalidateAsynchronously) {
+  const struct {
+    const char* headers;
+    bool can_revalidate_asynchronously;
+  } tests[] = {
+    // no stale-while-revalidate
+    { "HTTP/1.1 200 OK\n"
+      "cache-control: max-age=300\n"
+      "\n",
+      false
+    },
+    // stale, but within the stale-while-revalidate window
+    { "HTTP/1.1 200 OK\n"
+      "cache-control: max-age=300, stale-while-revalidate=3600\n"
+      "\n",
+      true
+    },
+    // past the stale-while-revalidate window
+    { "HTTP/1.1 200 OK\n"
+      "cache-control: max-age=0, stale-while-revalidate=10\n"
+      "\n",
+      false
+    },
+    // must-revalidate forbids using stale responses
+    { "HTTP/1.1 200 OK\n"
+      "cache-control: max-age=300, stale-while-revalidate=3600\n"
+      "cache-control: must-revalidate\n"
+      "\n",
+      false
+    },
+    // no-cache responses are never used without validation
+    { "HTTP/1.1 200 OK\n"
+      "cache-control: no-cache, stale-while-revalidate=3600\n"
+      "\n",
+      false
+    },
+  };
+  base::Time request_time, response_time, current_time;
+  base::Time::FromString("Wed, 28 Nov 2007 00:40:09 GMT", &request_time);
+  base::Time::FromString("Wed, 28 Nov 2007 00:40:12 GMT", &response_time);
+  base::Time::FromString("Wed, 28 Nov 2007 00:45:20 GMT", &current_time);
+
+  for (size_t i = 0; i < ARRAYSIZE_UNSAFE(tests); ++i) {
+    std::string headers(tests[i].headers);
+    HeadersToRaw(&headers);
+    scoped_refptr<net::HttpResponseHeaders> parsed(
+        new net::HttpResponseHeaders(headers));
+
+    EXPECT_EQ(tests[i].can_revalidate_asynchronously,
+              parsed->CanRevalidateAsynchronously(request_time, response_time,
+                                                  current_time)) << i;
+  }
+}
+
 TEST(HttpResponseHeadersTest, Update) {
   const struct {
     const char* orig_headers;
@@ -132,6 +132,22 @@ int MockDiskEntry::WriteData(
   return net::ERR_IO_PENDING;
 }
 
+int MockDiskEntry::ReadDataWithPrefetch(
+    int index, int offset, net::IOBuffer* buf, int buf_len,
+    int prefetch_index, net::IOBuffer* prefetch_buf, int prefetch_buf_len,
+    const net::CompletionCallback& callback) {
+  DCHECK(prefetch_index >= 0 && prefetch_index < kNumCacheEntryDataIndices);
+
+  if (fail_requests_)
+    return net::ERR_CACHE_READ_FAILURE;
+
+  int num = std::min(prefetch_buf_len,
+                     static_cast<int>(data_[prefetch_index].size()));
+  if (num)
+    memcpy(prefetch_buf->data(), &data_[prefetch_index][0], num);
+  return ReadData(index, offset, buf, buf_len, callback);
+}
+
 int MockDiskEntry::ReadSparseData(int64 offset, net::IOBuffer* buf, int buf_len,
                                   const net::CompletionCallback& callback) {
   DCHECK(!callback.is_null());
@@ -457,6 +473,21 @@ int MockDiskCache::DoomEntriesSince(const base::Time initial_time,
   return net::ERR_NOT_IMPLEMENTED;
 }
 
+int MockDiskCache::DoomEntriesBetweenWithProgress(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const ProgressCallback& progress_callback,
+    const net::CompletionCallback& callback) {
+  return net::ERR_NOT_IMPLEMENTED;
+}
+
+int MockDiskCache::CalculateSizeOfEntriesBetween(
+    const base::Time initial_time,
+    const base::Time end_time,
+    const net::CompletionCallback& callback) {
+  return net::ERR_NOT_IMPLEMENTED;
+}
+
 int MockDiskCache::OpenNextEntry(void** iter, disk_cache::Entry** next_entry,
                                  const net::CompletionCallback& callback) {
   return net::ERR_NOT_IMPLEMENTED;
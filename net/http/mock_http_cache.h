@@ -36,6 +36,10 @@ class MockDiskEntry : public disk_cache::Entry,
   virtual int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
                         const net::CompletionCallback& callback,
                         bool truncate) OVERRIDE;
+  virtual int ReadDataWithPrefetch(
+      int index, int offset, net::IOBuffer* buf, int buf_len,
+      int prefetch_index, net::IOBuffer* prefetch_buf, int prefetch_buf_len,
+      const net::CompletionCallback& callback) OVERRIDE;
   virtual int ReadSparseData(int64 offset, net::IOBuffer* buf, int buf_len,
                              const net::CompletionCallback& callback) OVERRIDE;
   virtual int WriteSparseData(
@@ -114,6 +118,15 @@ class MockDiskCache : public disk_cache::Backend {
   virtual int DoomEntriesSince(
       base::Time initial_time,
       const net::CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetweenWithProgress(
+      base::Time initial_time,
+      base::Time end_time,
+      const ProgressCallback& progress_callback,
+      const net::CompletionCallback& callback) OVERRIDE;
+  virtual int CalculateSizeOfEntriesBetween(
+      base::Time initial_time,
+      base::Time end_time,
+      const net::CompletionCallback& callback) OVERRIDE;
   virtual int OpenNextEntry(void** iter, disk_cache::Entry** next_entry,
                             const net::CompletionCallback& callback) OVERRIDE;
   virtual void EndEnumeration(void** iter) OVERRIDE;
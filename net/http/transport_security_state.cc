@@ -16,14 +16,17 @@
 #endif
 
 #include <algorithm>
+#include <vector>
 
 #include "base/base64.h"
 #include "base/build_time.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
 #include "base/sha1.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/time/time.h"
@@ -544,45 +547,122 @@ struct HSTSPreload {
   SecondLevelDomainName second_level_domain_name;
 };
 
-static bool HasPreload(const struct HSTSPreload* entries, size_t num_entries,
+// PreloadIndex orders the entries of a preload table by name, so that they can
+// be found with a binary search of the canonicalized host, rather than a scan
+// of the whole table for every label of it. Entries with the same name keep
+// their order in the table.
+class PreloadIndex {
+ public:
+  typedef std::vector<const HSTSPreload*>::const_iterator Iterator;
+
+  PreloadIndex(const struct HSTSPreload* entries, size_t num_entries) {
+    entries_.reserve(num_entries);
+    for (size_t i = 0; i < num_entries; ++i)
+      entries_.push_back(entries + i);
+    std::stable_sort(entries_.begin(), entries_.end(), NameLessThan());
+  }
+
+  // Sets [|*begin|, |*end|) to the entries named by the |length| bytes at
+  // |dns_name|. This doesn't allocate.
+  void Find(const char* dns_name, size_t length,
+            Iterator* begin, Iterator* end) const {
+    Name name = { dns_name, length };
+    std::pair<Iterator, Iterator> range =
+        std::equal_range(entries_.begin(), entries_.end(), name,
+                         NameLessThan());
+    *begin = range.first;
+    *end = range.second;
+  }
+
+ private:
+  struct Name {
+    const char* dns_name;
+    size_t length;
+  };
+
+  // Orders by length first, as that is cheaper to compare.
+  struct NameLessThan {
+    static bool Compare(const char* a, size_t a_length,
+                        const char* b, size_t b_length) {
+      if (a_length != b_length)
+        return a_length < b_length;
+      return memcmp(a, b, a_length) < 0;
+    }
+    bool operator()(const HSTSPreload* a, const HSTSPreload* b) const {
+      return Compare(a->dns_name, a->length, b->dns_name, b->length);
+    }
+    bool operator()(const HSTSPreload* a, const Name& b) const {
+      return Compare(a->dns_name, a->length, b.dns_name, b.length);
+    }
+    bool operator()(const Name& a, const HSTSPreload* b) const {
+      return Compare(a.dns_name, a.length, b->dns_name, b->length);
+    }
+  };
+
+  std::vector<const HSTSPreload*> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(PreloadIndex);
+};
+
+static bool HasPreload(const PreloadIndex& index,
                        const std::string& canonicalized_host, size_t i,
                        TransportSecurityState::DomainState* out, bool* ret) {
-  for (size_t j = 0; j < num_entries; j++) {
-    if (entries[j].length == canonicalized_host.size() - i &&
-        memcmp(entries[j].dns_name, &canonicalized_host[i],
-               entries[j].length) == 0) {
-      if (!entries[j].include_subdomains && i != 0) {
-        *ret = false;
-      } else {
-        out->sts_include_subdomains = entries[j].include_subdomains;
-        out->pkp_include_subdomains = entries[j].include_subdomains;
-        *ret = true;
-        if (!entries[j].https_required)
-          out->upgrade_mode = TransportSecurityState::DomainState::MODE_DEFAULT;
-        if (entries[j].pins.required_hashes) {
-          const char* const* sha1_hash = entries[j].pins.required_hashes;
-          while (*sha1_hash) {
-            AddHash(*sha1_hash, &out->static_spki_hashes);
-            sha1_hash++;
-          }
-        }
-        if (entries[j].pins.excluded_hashes) {
-          const char* const* sha1_hash = entries[j].pins.excluded_hashes;
-          while (*sha1_hash) {
-            AddHash(*sha1_hash, &out->bad_static_spki_hashes);
-            sha1_hash++;
-          }
-        }
+  PreloadIndex::Iterator begin;
+  PreloadIndex::Iterator end;
+  index.Find(&canonicalized_host[i], canonicalized_host.size() - i,
+             &begin, &end);
+  if (begin == end)
+    return false;
+
+  const struct HSTSPreload* entry = *begin;
+  out->domain = DNSDomainToString(base::StringPiece(
+      &canonicalized_host[i], canonicalized_host.size() - i));
+  if (!entry->include_subdomains && i != 0) {
+    *ret = false;
+  } else {
+    out->sts_include_subdomains = entry->include_subdomains;
+    out->pkp_include_subdomains = entry->include_subdomains;
+    *ret = true;
+    if (!entry->https_required)
+      out->upgrade_mode = TransportSecurityState::DomainState::MODE_DEFAULT;
+    if (entry->pins.required_hashes) {
+      const char* const* sha1_hash = entry->pins.required_hashes;
+      while (*sha1_hash) {
+        AddHash(*sha1_hash, &out->static_spki_hashes);
+        sha1_hash++;
+      }
+    }
+    if (entry->pins.excluded_hashes) {
+      const char* const* sha1_hash = entry->pins.excluded_hashes;
+      while (*sha1_hash) {
+        AddHash(*sha1_hash, &out->bad_static_spki_hashes);
+        sha1_hash++;
       }
-      return true;
     }
   }
-  return false;
+  return true;
 }
 
 #include "net/http/transport_security_state_static.h"
 
-// Returns the HSTSPreload entry for the |canonicalized_host| in |entries|,
+namespace {
+
+struct PreloadIndices {
+  PreloadIndices()
+      : sts(kPreloadedSTS, kNumPreloadedSTS),
+        sni_sts(kPreloadedSNISTS, kNumPreloadedSNISTS) {
+  }
+
+  const PreloadIndex sts;
+  const PreloadIndex sni_sts;
+};
+
+base::LazyInstance<PreloadIndices>::Leaky g_preload_indices =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// Returns the HSTSPreload entry for the |canonicalized_host| in |index|,
 // or NULL if there is none. Prefers exact hostname matches to those that
 // match only because HSTSPreload.include_subdomains is true.
 //
@@ -590,19 +670,15 @@ static bool HasPreload(const struct HSTSPreload* entries, size_t num_entries,
 // CanonicalizeHost.
 static const struct HSTSPreload* GetHSTSPreload(
     const std::string& canonicalized_host,
-    const struct HSTSPreload* entries,
-    size_t num_entries) {
+    const PreloadIndex& index) {
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    for (size_t j = 0; j < num_entries; j++) {
-      const struct HSTSPreload* entry = entries + j;
-
-      if (i != 0 && !entry->include_subdomains)
-        continue;
-
-      if (entry->length == canonicalized_host.size() - i &&
-          memcmp(entry->dns_name, &canonicalized_host[i], entry->length) == 0) {
-        return entry;
-      }
+    PreloadIndex::Iterator begin;
+    PreloadIndex::Iterator end;
+    index.Find(&canonicalized_host[i], canonicalized_host.size() - i,
+               &begin, &end);
+    for (PreloadIndex::Iterator it = begin; it != end; ++it) {
+      if (i == 0 || (*it)->include_subdomains)
+        return *it;
     }
   }
 
@@ -702,14 +778,13 @@ bool TransportSecurityState::IsGooglePinnedProperty(const std::string& host,
                                                     bool sni_enabled) {
   std::string canonicalized_host = CanonicalizeHost(host);
   const struct HSTSPreload* entry =
-      GetHSTSPreload(canonicalized_host, kPreloadedSTS, kNumPreloadedSTS);
+      GetHSTSPreload(canonicalized_host, g_preload_indices.Get().sts);
 
   if (entry && entry->pins.required_hashes == kGoogleAcceptableCerts)
     return true;
 
   if (sni_enabled) {
-    entry = GetHSTSPreload(canonicalized_host, kPreloadedSNISTS,
-                           kNumPreloadedSNISTS);
+    entry = GetHSTSPreload(canonicalized_host, g_preload_indices.Get().sni_sts);
     if (entry && entry->pins.required_hashes == kGoogleAcceptableCerts)
       return true;
   }
@@ -722,11 +797,11 @@ void TransportSecurityState::ReportUMAOnPinFailure(const std::string& host) {
   std::string canonicalized_host = CanonicalizeHost(host);
 
   const struct HSTSPreload* entry =
-      GetHSTSPreload(canonicalized_host, kPreloadedSTS, kNumPreloadedSTS);
+      GetHSTSPreload(canonicalized_host, g_preload_indices.Get().sts);
 
   if (!entry) {
-    entry = GetHSTSPreload(canonicalized_host, kPreloadedSNISTS,
-                           kNumPreloadedSNISTS);
+    entry = GetHSTSPreload(canonicalized_host,
+                           g_preload_indices.Get().sni_sts);
   }
 
   if (!entry) {
@@ -759,22 +834,16 @@ bool TransportSecurityState::GetStaticDomainState(
   out->sts_include_subdomains = false;
   out->pkp_include_subdomains = false;
 
-  const bool is_build_timely = IsBuildTimely();
+  if (!IsBuildTimely())
+    return false;
 
+  const PreloadIndices& indices = g_preload_indices.Get();
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    std::string host_sub_chunk(&canonicalized_host[i],
-                               canonicalized_host.size() - i);
-    out->domain = DNSDomainToString(host_sub_chunk);
     bool ret;
-    if (is_build_timely &&
-        HasPreload(kPreloadedSTS, kNumPreloadedSTS, canonicalized_host, i, out,
-                   &ret)) {
+    if (HasPreload(indices.sts, canonicalized_host, i, out, &ret))
       return ret;
-    }
-    if (sni_enabled &&
-        is_build_timely &&
-        HasPreload(kPreloadedSNISTS, kNumPreloadedSNISTS, canonicalized_host, i,
-                   out, &ret)) {
+    if (sni_enabled && HasPreload(indices.sni_sts, canonicalized_host, i, out,
+                                  &ret)) {
       return ret;
     }
   }
@@ -267,6 +267,7 @@ class NET_EXPORT TransportSecurityState
   static bool IsBuildTimely();
 
  private:
+  friend class TransportSecurityStatePerfTest;
   friend class TransportSecurityStateTest;
   FRIEND_TEST_ALL_PREFIXES(HttpSecurityHeadersTest,
                            UpdateDynamicPKPOnly);
@@ -0,0 +1,71 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "net/http/transport_security_state.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+// How many times the hosts are looked up for timing.
+const int kIterations = 20000;
+
+// A mix of preloaded hosts, subdomains of preloaded hosts and hosts with no
+// preload at all, which is the common case.
+const char* const kHosts[] = {
+  "www.google.com",
+  "mail.google.com",
+  "accounts.google.com",
+  "www.paypal.com",
+  "a.b.c.d.e.f.twitter.com",
+  "www.example.com",
+  "static.example.net",
+  "cdn1.images.example.org",
+  "news.ycombinator.com",
+  "en.wikipedia.org",
+};
+
+class TransportSecurityStatePerfTest : public testing::Test {
+ protected:
+  bool GetStaticDomainState(TransportSecurityState* state,
+                            const std::string& canonicalized_host,
+                            bool sni_enabled) {
+    TransportSecurityState::DomainState domain_state;
+    return state->GetStaticDomainState(canonicalized_host, sni_enabled,
+                                       &domain_state);
+  }
+
+  std::string CanonicalizeHost(const std::string& host) {
+    return TransportSecurityState::CanonicalizeHost(host);
+  }
+};
+
+TEST_F(TransportSecurityStatePerfTest, GetStaticDomainState) {
+  TransportSecurityState state;
+  std::string canonicalized_hosts[arraysize(kHosts)];
+  for (size_t i = 0; i < arraysize(kHosts); ++i)
+    canonicalized_hosts[i] = CanonicalizeHost(kHosts[i]);
+
+  // The first lookup builds the index of the preload.
+  EXPECT_TRUE(GetStaticDomainState(&state, canonicalized_hosts[0], true));
+
+  base::PerfTimeLogger timer(base::StringPrintf(
+      "GetStaticDomainState %d hosts",
+      static_cast<int>(kIterations * arraysize(kHosts))).c_str());
+  int num_preloaded = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < arraysize(kHosts); ++j) {
+      if (GetStaticDomainState(&state, canonicalized_hosts[j], true))
+        ++num_preloaded;
+    }
+  }
+  timer.Done();
+  EXPECT_LT(0, num_preloaded);
+}
+
+}  // namespace net
@@ -65,6 +65,12 @@ class NET_EXPORT_PRIVATE ProxyResolver {
   // no-op implementation.
   virtual void PurgeMemory() {}
 
+  // Called when a PAC script is about to be fetched, so that the resolver can
+  // get ready to evaluate one while the download is in flight. A call to
+  // SetPacScript() is not guaranteed to follow. The default implementation
+  // does nothing.
+  virtual void PrepareForPacScript() {}
+
   // Called to set the PAC script backend to use.
   // Returns ERR_IO_PENDING in the case of asynchronous completion, and notifies
   // the result through |callback|.
@@ -9,11 +9,17 @@
 #include "base/strings/string_util.h"
 #include "base/test/perf_time_logger.h"
 #include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
 #include "net/dns/mock_host_resolver.h"
+#include "net/proxy/dhcp_proxy_script_fetcher.h"
+#include "net/proxy/mock_proxy_script_fetcher.h"
+#include "net/proxy/proxy_config_service_fixed.h"
 #include "net/proxy/proxy_info.h"
 #include "net/proxy/proxy_resolver_v8.h"
+#include "net/proxy/proxy_service.h"
 #include "net/test/spawned_test_server/spawned_test_server.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
 
 #if defined(OS_WIN)
 #include "net/proxy/proxy_resolver_winhttp.h"
@@ -76,6 +82,22 @@ int PacPerfTest::NumQueries() const {
 // The number of URLs to resolve when testing a PAC script.
 const int kNumIterations = 500;
 
+// Reads the PAC script |script_name| from the test data directory.
+bool ReadPacScript(const std::string& script_name, std::string* contents) {
+  base::FilePath path;
+  PathService::Get(base::DIR_SOURCE_ROOT, &path);
+  path = path.AppendASCII("net");
+  path = path.AppendASCII("data");
+  path = path.AppendASCII("proxy_resolver_perftest");
+  path = path.AppendASCII(script_name);
+
+  bool ok = base::ReadFileToString(path, contents);
+
+  // If we can't load the file from disk, something is misconfigured.
+  LOG_IF(ERROR, !ok) << "Failed to read file: " << path.value();
+  return ok;
+}
+
 // Helper class to run through all the performance tests using the specified
 // proxy resolver implementation.
 class PacPerfSuiteRunner {
@@ -154,20 +176,8 @@ class PacPerfSuiteRunner {
 
   // Read the PAC script from disk and initialize the proxy resolver with it.
   void LoadPacScriptIntoResolver(const std::string& script_name) {
-    base::FilePath path;
-    PathService::Get(base::DIR_SOURCE_ROOT, &path);
-    path = path.AppendASCII("net");
-    path = path.AppendASCII("data");
-    path = path.AppendASCII("proxy_resolver_perftest");
-    path = path.AppendASCII(script_name);
-
-    // Try to read the file from disk.
     std::string file_contents;
-    bool ok = base::ReadFileToString(path, &file_contents);
-
-    // If we can't load the file from disk, something is misconfigured.
-    LOG_IF(ERROR, !ok) << "Failed to read file: " << path.value();
-    ASSERT_TRUE(ok);
+    ASSERT_TRUE(ReadPacScript(script_name, &file_contents));
 
     // Load the PAC script into the ProxyResolver.
     int rv = resolver_->SetPacScript(
@@ -227,3 +237,81 @@ TEST(ProxyResolverPerfTest, ProxyResolverV8) {
   PacPerfSuiteRunner runner(&resolver, "ProxyResolverV8");
   runner.RunAllTests();
 }
+
+// Resolves the queries of every test through a ProxyService running the PAC
+// script in ProxyResolverV8, to measure the PAC result cache in |mode|.
+void RunProxyServicePerfTests(net::ProxyService::PacResultCacheMode mode,
+                              const std::string& mode_name) {
+  for (size_t i = 0; i < arraysize(kPerfTests); ++i) {
+    const PacPerfTest& test_data = kPerfTests[i];
+    std::string script;
+    ASSERT_TRUE(ReadPacScript(test_data.pac_name, &script));
+
+    MockJSBindings js_bindings;
+    net::ProxyResolverV8* resolver = new net::ProxyResolverV8;
+    resolver->set_js_bindings(&js_bindings);
+    net::ProxyService service(
+        new net::ProxyConfigServiceFixed(
+            net::ProxyConfig::CreateFromCustomPacURL(GURL("http://pac/"))),
+        resolver, NULL);
+    net::MockProxyScriptFetcher* fetcher = new net::MockProxyScriptFetcher;
+    service.SetProxyScriptFetchers(fetcher,
+                                   new net::DoNothingDhcpProxyScriptFetcher);
+    service.set_pac_result_cache_mode(mode);
+
+    // The first resolve fetches the PAC script, and warms things up.
+    {
+      net::ProxyInfo proxy_info;
+      net::TestCompletionCallback callback;
+      int result = service.ResolveProxy(
+          GURL("http://www.warmup.com"), &proxy_info, callback.callback(),
+          NULL, net::BoundNetLog());
+      ASSERT_EQ(net::ERR_IO_PENDING, result);
+      ASSERT_TRUE(fetcher->has_pending_request());
+      fetcher->NotifyFetchCompletion(net::OK, script);
+      ASSERT_EQ(net::OK, callback.WaitForResult());
+    }
+
+    std::string perf_test_name =
+        "ProxyService_" + mode_name + "_" + test_data.pac_name;
+    base::PerfTimeLogger timer(perf_test_name.c_str());
+
+    int queries_len = test_data.NumQueries();
+    for (int j = 0; j < kNumIterations; ++j) {
+      const PacQuery& query = test_data.queries[j % queries_len];
+
+      // ProxyResolverV8 completes synchronously, and so do cache hits.
+      net::ProxyInfo proxy_info;
+      net::TestCompletionCallback callback;
+      int result = service.ResolveProxy(
+          GURL(query.query_url), &proxy_info, callback.callback(), NULL,
+          net::BoundNetLog());
+      ASSERT_EQ(net::OK, result);
+      ASSERT_EQ(query.expected_result, proxy_info.ToPacString());
+    }
+
+    timer.Done();
+    perf_test::PrintResult(
+        "pac_result_cache_hits", "_" + mode_name, test_data.pac_name,
+        static_cast<size_t>(service.pac_result_cache_hits()), "count", false);
+    perf_test::PrintResult(
+        "pac_result_cache_misses", "_" + mode_name, test_data.pac_name,
+        static_cast<size_t>(service.pac_result_cache_misses()), "count",
+        false);
+  }
+}
+
+// PAC_RESULT_CACHE_BY_HOST isn't measured, as no-ads.pac looks at the path
+// and so would get wrong results from it.
+TEST(ProxyResolverPerfTest, ProxyServiceWithoutPacResultCache) {
+  net::ProxyResolverV8::RememberDefaultIsolate();
+  RunProxyServicePerfTests(net::ProxyService::PAC_RESULT_CACHE_DISABLED,
+                           "NoCache");
+}
+
+TEST(ProxyResolverPerfTest, ProxyServiceWithPacResultCache) {
+  net::ProxyResolverV8::RememberDefaultIsolate();
+  RunProxyServicePerfTests(
+      net::ProxyService::PAC_RESULT_CACHE_BY_HOST_WITH_PATH_CHECK,
+      "CacheWithPathCheck");
+}
@@ -414,7 +414,8 @@ class ProxyResolverV8::Context {
     return OK;
   }
 
-  int InitV8(const scoped_refptr<ProxyResolverScriptData>& pac_script) {
+  // Creates the V8 context and loads the PAC utility functions into it.
+  int InitEnvironment() {
     v8::Locker locked(isolate_);
     v8::Isolate::Scope isolate_scope(isolate_);
     v8::HandleScope scope(isolate_);
@@ -486,8 +487,20 @@ class ProxyResolverV8::Context {
       return rv;
     }
 
-    // Add the user's PAC code to the environment.
-    rv =
+    return OK;
+  }
+
+  // Adds the user's PAC code to the environment set up by InitEnvironment().
+  int LoadPacScript(const scoped_refptr<ProxyResolverScriptData>& pac_script) {
+    v8::Locker locked(isolate_);
+    v8::Isolate::Scope isolate_scope(isolate_);
+    v8::HandleScope scope(isolate_);
+
+    v8::Local<v8::Context> context =
+        v8::Local<v8::Context>::New(isolate_, v8_context_);
+    v8::Context::Scope ctx(context);
+
+    int rv =
         RunScript(ScriptDataToV8String(isolate_, pac_script), kPacResourceName);
     if (rv != OK)
       return rv;
@@ -766,14 +779,32 @@ int ProxyResolverV8::SetPacScript(
   if (script_data->utf16().empty())
     return ERR_PAC_SCRIPT_FAILED;
 
+  // A context is only ever used for a single script, since the previous one
+  // may have left globals behind.
+  scoped_ptr<Context> context(prepared_context_.Pass());
+  if (!context) {
+    context.reset(new Context(this, GetDefaultIsolate()));
+    int rv = context->InitEnvironment();
+    if (rv != OK)
+      return rv;
+  }
+
   // Try parsing the PAC script.
-  scoped_ptr<Context> context(new Context(this, GetDefaultIsolate()));
-  int rv = context->InitV8(script_data);
+  int rv = context->LoadPacScript(script_data);
   if (rv == OK)
     context_.reset(context.release());
   return rv;
 }
 
+void ProxyResolverV8::PrepareForPacScript() {
+  if (prepared_context_)
+    return;
+
+  scoped_ptr<Context> context(new Context(this, GetDefaultIsolate()));
+  if (context->InitEnvironment() == OK)
+    prepared_context_.reset(context.release());
+}
+
 // static
 void ProxyResolverV8::RememberDefaultIsolate() {
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
@@ -90,6 +90,7 @@ class NET_EXPORT_PRIVATE ProxyResolverV8 : public ProxyResolver {
   virtual int SetPacScript(
       const scoped_refptr<ProxyResolverScriptData>& script_data,
       const net::CompletionCallback& /*callback*/) OVERRIDE;
+  virtual void PrepareForPacScript() OVERRIDE;
 
   // Remember the default Isolate, must be called from the main thread. This
   // hack can be removed when the "default Isolate" concept is gone.
@@ -121,6 +122,11 @@ class NET_EXPORT_PRIVATE ProxyResolverV8 : public ProxyResolver {
 
   scoped_ptr<Context> context_;
 
+  // A context which has the bindings and the PAC utility functions loaded, but
+  // no PAC script yet. It is built by PrepareForPacScript() and consumed by
+  // the next SetPacScript(), which then only has to compile the PAC script.
+  scoped_ptr<Context> prepared_context_;
+
   JSBindings* js_bindings_;
 
   DISALLOW_COPY_AND_ASSIGN(ProxyResolverV8);
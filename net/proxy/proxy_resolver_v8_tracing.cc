@@ -388,7 +388,9 @@ void ProxyResolverV8Tracing::Job::StartGetProxyForURL(
   user_results_ = results;
   bound_net_log_ = net_log;
 
-  Start(GET_PROXY_FOR_URL, false /*non-blocking*/, callback);
+  // A pure script gains nothing from being re-executed after each DNS
+  // lookup, the result is the same as waiting for the lookup in place.
+  Start(GET_PROXY_FOR_URL, parent_->pac_script_is_pure_, callback);
 }
 
 void ProxyResolverV8Tracing::Job::Cancel() {
@@ -1097,7 +1099,8 @@ ProxyResolverV8Tracing::ProxyResolverV8Tracing(
       host_resolver_(host_resolver),
       error_observer_(error_observer),
       net_log_(net_log),
-      num_outstanding_callbacks_(0) {
+      num_outstanding_callbacks_(0),
+      pac_script_is_pure_(false) {
   DCHECK(host_resolver);
   // Start up the thread.
   thread_.reset(new base::Thread("Proxy resolver"));
@@ -1161,6 +1164,15 @@ void ProxyResolverV8Tracing::PurgeMemory() {
                  base::Unretained(v8_resolver_.get())));
 }
 
+void ProxyResolverV8Tracing::PrepareForPacScript() {
+  thread_->message_loop()->PostTask(
+      FROM_HERE,
+      base::Bind(&ProxyResolverV8::PrepareForPacScript,
+                 // The use of unretained is safe, since the worker thread
+                 // cannot outlive |this|.
+                 base::Unretained(v8_resolver_.get())));
+}
+
 int ProxyResolverV8Tracing::SetPacScript(
     const scoped_refptr<ProxyResolverScriptData>& script_data,
     const CompletionCallback& callback) {
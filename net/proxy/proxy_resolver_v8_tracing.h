@@ -44,6 +44,15 @@ class NET_EXPORT_PRIVATE ProxyResolverV8Tracing
 
   virtual ~ProxyResolverV8Tracing();
 
+  // By default a PAC script runs without blocking the worker thread on DNS:
+  // whenever it needs a result which isn't cached yet the execution is
+  // abandoned, and re-run from the start once the lookup completes. When the
+  // script is known to be pure (its only input besides the URL is DNS), set
+  // |pure| to run it just once per request instead, waiting for each lookup
+  // in place. This trades tying up the worker thread during DNS for not
+  // repeating the work of FindProxyForURL() after every lookup.
+  void set_pac_script_is_pure(bool pure) { pac_script_is_pure_ = pure; }
+
   // ProxyResolver implementation:
   virtual int GetProxyForURL(const GURL& url,
                              ProxyInfo* results,
@@ -54,6 +63,7 @@ class NET_EXPORT_PRIVATE ProxyResolverV8Tracing
   virtual LoadState GetLoadState(RequestHandle request) const OVERRIDE;
   virtual void CancelSetPacScript() OVERRIDE;
   virtual void PurgeMemory() OVERRIDE;
+  virtual void PrepareForPacScript() OVERRIDE;
   virtual int SetPacScript(
       const scoped_refptr<ProxyResolverScriptData>& script_data,
       const CompletionCallback& callback) OVERRIDE;
@@ -77,6 +87,9 @@ class NET_EXPORT_PRIVATE ProxyResolverV8Tracing
   // The number of outstanding (non-cancelled) jobs.
   int num_outstanding_callbacks_;
 
+  // Whether Jobs should start out in blocking DNS mode.
+  bool pac_script_is_pure_;
+
   DISALLOW_COPY_AND_ASSIGN(ProxyResolverV8Tracing);
 };
 
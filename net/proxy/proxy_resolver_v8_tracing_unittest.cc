@@ -347,6 +347,62 @@ TEST_F(ProxyResolverV8TracingTest, Dns) {
   }
 }
 
+// Same as the Dns test, but with the script declared pure, so it is run once
+// with blocking DNS rather than being restarted after each lookup.
+TEST_F(ProxyResolverV8TracingTest, DnsPureScript) {
+  CapturingNetLog log;
+  CapturingBoundNetLog request_log;
+  MockCachingHostResolver host_resolver;
+  MockErrorObserver* error_observer = new MockErrorObserver;
+  ProxyResolverV8Tracing resolver(&host_resolver, error_observer, &log);
+  resolver.set_pac_script_is_pure(true);
+
+  host_resolver.rules()->AddRuleForAddressFamily(
+      "host1", ADDRESS_FAMILY_IPV4, "166.155.144.44");
+  host_resolver.rules()
+      ->AddIPLiteralRule("host1", "::1,192.168.1.1", std::string());
+  host_resolver.rules()->AddSimulatedFailure("host2");
+  host_resolver.rules()->AddRule("host3", "166.155.144.33");
+  host_resolver.rules()->AddRule("host5", "166.155.144.55");
+  host_resolver.rules()->AddSimulatedFailure("host6");
+  host_resolver.rules()->AddRuleForAddressFamily(
+      "*", ADDRESS_FAMILY_IPV4, "122.133.144.155");
+  host_resolver.rules()->AddRule("*", "133.122.100.200");
+
+  InitResolver(&resolver, "dns.js");
+
+  TestCompletionCallback callback;
+  ProxyInfo proxy_info;
+
+  int rv = resolver.GetProxyForURL(
+      GURL("http://foo/"),
+      &proxy_info,
+      callback.callback(),
+      NULL,
+      request_log.bound());
+
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, callback.WaitForResult());
+
+  // The lookups are the same as in non-blocking mode.
+  EXPECT_EQ(7u, host_resolver.num_resolve());
+  EXPECT_EQ("122.133.144.155-null-__1_192.168.1.1-null-166.155.144.33-"
+            "122.133.144.155-166.155.144.33-__1_192.168.1.1-122.133.144.155-"
+            "null--133.122.100.200-166.155.144.44:99",
+            proxy_info.proxy_server().ToURI());
+  EXPECT_EQ("", error_observer->GetOutput());
+
+  // But FindProxyForURL() only ran once (the script alerts its execution
+  // count before incrementing it).
+  CapturingNetLog::CapturedEntryList entries;
+  request_log.GetEntries(&entries);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_TRUE(
+      LogContainsEvent(entries, 0, NetLog::TYPE_PAC_JAVASCRIPT_ALERT,
+                       NetLog::PHASE_NONE));
+  EXPECT_EQ("{\"message\":\"iteration: 0\"}", entries[0].GetParamsJson());
+}
+
 // This test runs a PAC script that does "myIpAddress()" followed by
 // "dnsResolve()". This requires 2 restarts. However once the HostResolver's
 // cache is warmed, subsequent calls should take 0 restarts.
@@ -311,6 +311,41 @@ TEST(ProxyResolverV8Test, SideEffects) {
   }
 }
 
+// A context prepared ahead of time is only used for one script, so globals
+// don't leak from one script into the next.
+TEST(ProxyResolverV8Test, PrepareForPacScript) {
+  ProxyResolverV8WithMockBindings resolver;
+  resolver.PrepareForPacScript();
+  int result = resolver.SetPacScriptFromDisk("side_effects.js");
+  EXPECT_EQ(OK, result);
+
+  for (int i = 0; i < 2; ++i) {
+    ProxyInfo proxy_info;
+    result = resolver.GetProxyForURL(
+        kQueryUrl, &proxy_info, CompletionCallback(), NULL, BoundNetLog());
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ(base::StringPrintf("sideffect_%d:80", i),
+              proxy_info.proxy_server().ToURI());
+  }
+
+  // Whether or not a context was prepared in between, reloading the script
+  // starts it over.
+  for (int reload = 0; reload < 2; ++reload) {
+    if (reload == 0)
+      resolver.PrepareForPacScript();
+    result = resolver.SetPacScriptFromDisk("side_effects.js");
+    EXPECT_EQ(OK, result);
+
+    ProxyInfo proxy_info;
+    result = resolver.GetProxyForURL(
+        kQueryUrl, &proxy_info, CompletionCallback(), NULL, BoundNetLog());
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ("sideffect_0:80", proxy_info.proxy_server().ToURI());
+  }
+
+  EXPECT_EQ(0U, resolver.mock_js_bindings()->errors.size());
+}
+
 // Execute a PAC script which throws an exception in FindProxyForURL.
 TEST(ProxyResolverV8Test, UnhandledException) {
   ProxyResolverV8WithMockBindings resolver;
@@ -76,6 +76,15 @@ namespace {
 // sorts of problems.
 const int64 kDelayAfterNetworkChangesMs = 2000;
 
+// Bounds on the PAC result cache. The lifetime bounds how stale a result can
+// get for scripts which depend on the time of day, or on DNS results.
+const size_t kMaxPacResultCacheEntries = 1000;
+const int64 kPacResultCacheLifetimeSeconds = 5 * 60;
+
+// Bounds the origins remembered as path dependent. Once it is reached, the
+// cache starts over, and origins need two matching results to be cached again.
+const size_t kMaxPathDependentOrigins = 1000;
+
 // This is the default policy for polling the PAC script.
 //
 // In response to a failure, the poll intervals are:
@@ -310,6 +319,20 @@ base::Value* NetLogFinishedResolvingProxyCallback(
   return dict;
 }
 
+// Returns NetLog parameters describing how useful the PAC result cache was.
+base::Value* NetLogPacResultCacheStatsCallback(
+    int hits,
+    int misses,
+    size_t path_dependent_hosts,
+    NetLog::LogLevel /* log_level */) {
+  base::DictionaryValue* dict = new base::DictionaryValue();
+  dict->SetInteger("hits", hits);
+  dict->SetInteger("misses", misses);
+  dict->SetInteger("path_dependent_hosts",
+                   static_cast<int>(path_dependent_hosts));
+  return dict;
+}
+
 #if defined(OS_CHROMEOS)
 class UnsetProxyConfigService : public ProxyConfigService {
  public:
@@ -773,7 +796,7 @@ class ProxyService::PacRequest
   }
 
   void StartAndCompleteCheckingForSynchronous() {
-    int rv = service_->TryToCompleteSynchronously(url_, results_);
+    int rv = service_->TryToCompleteSynchronously(url_, results_, net_log_);
     if (rv == ERR_IO_PENDING)
       rv = Start();
     if (rv != ERR_IO_PENDING)
@@ -812,6 +835,11 @@ class ProxyService::PacRequest
   int QueryDidComplete(int result_code) {
     DCHECK(!was_cancelled());
 
+    // Cache the result before DidFinishResolvingProxy() reorders it around
+    // the currently bad proxies.
+    if (result_code == OK && config_id_ == service_->config_.id())
+      service_->AddToPacResultCache(url_, *results_);
+
     // Note that DidFinishResolvingProxy might modify |results_|.
     int rv = service_->DidFinishResolvingProxy(results_, result_code, net_log_);
 
@@ -886,7 +914,11 @@ ProxyService::ProxyService(ProxyConfigService* config_service,
       net_log_(net_log),
       stall_proxy_auto_config_delay_(TimeDelta::FromMilliseconds(
           kDelayAfterNetworkChangesMs)),
-      quick_check_enabled_(true) {
+      quick_check_enabled_(true),
+      pac_result_cache_mode_(PAC_RESULT_CACHE_DISABLED),
+      pac_result_cache_(kMaxPacResultCacheEntries),
+      pac_result_cache_hits_(0),
+      pac_result_cache_misses_(0) {
   NetworkChangeNotifier::AddIPAddressObserver(this);
   NetworkChangeNotifier::AddDNSObserver(this);
   ResetConfigService(config_service);
@@ -991,7 +1023,7 @@ int ProxyService::ResolveProxy(const GURL& raw_url,
 
   // Check if the request can be completed right away. (This is the case when
   // using a direct connection for example).
-  int rv = TryToCompleteSynchronously(url, result);
+  int rv = TryToCompleteSynchronously(url, result, net_log);
   if (rv != ERR_IO_PENDING)
     return DidFinishResolvingProxy(result, rv, net_log);
 
@@ -1019,7 +1051,8 @@ int ProxyService::ResolveProxy(const GURL& raw_url,
 }
 
 int ProxyService::TryToCompleteSynchronously(const GURL& url,
-                                             ProxyInfo* result) {
+                                             ProxyInfo* result,
+                                             const BoundNetLog& net_log) {
   DCHECK_NE(STATE_NONE, current_state_);
 
   if (current_state_ != STATE_READY)
@@ -1032,8 +1065,13 @@ int ProxyService::TryToCompleteSynchronously(const GURL& url,
   if (permanent_error_ != OK)
     return permanent_error_;
 
-  if (config_.HasAutomaticSettings())
+  if (config_.HasAutomaticSettings()) {
+    if (LookupPacResultCache(url, result)) {
+      net_log.AddEvent(NetLog::TYPE_PROXY_SERVICE_PAC_RESULT_CACHE_HIT);
+      return OK;
+    }
     return ERR_IO_PENDING;  // Must submit the request to the proxy resolver.
+  }
 
   // Use the manual proxy settings.
   config_.proxy_rules().Apply(url, result);
@@ -1042,6 +1080,87 @@ int ProxyService::TryToCompleteSynchronously(const GURL& url,
   return OK;
 }
 
+bool ProxyService::LookupPacResultCache(const GURL& url, ProxyInfo* result) {
+  if (pac_result_cache_mode_ == PAC_RESULT_CACHE_DISABLED)
+    return false;
+
+  GURL origin = url.GetOrigin();
+  const PacResultCacheEntry* entry = NULL;
+  if (!path_dependent_origins_.count(origin))
+    entry = pac_result_cache_.Get(origin, TimeTicks::Now());
+  if (!entry || (!entry->confirmed && entry->first_url != url)) {
+    ++pac_result_cache_misses_;
+    return false;
+  }
+
+  ++pac_result_cache_hits_;
+  result->UseProxyList(entry->proxy_list);
+  result->config_source_ = config_.source();
+  result->config_id_ = config_.id();
+  result->did_use_pac_script_ = true;
+  return true;
+}
+
+void ProxyService::AddToPacResultCache(const GURL& url,
+                                       const ProxyInfo& result) {
+  if (pac_result_cache_mode_ == PAC_RESULT_CACHE_DISABLED)
+    return;
+
+  GURL origin = url.GetOrigin();
+  if (path_dependent_origins_.count(origin))
+    return;
+
+  TimeTicks now = TimeTicks::Now();
+  bool confirmed = pac_result_cache_mode_ == PAC_RESULT_CACHE_BY_HOST;
+  const PacResultCacheEntry* entry = pac_result_cache_.Get(origin, now);
+  if (entry && !confirmed) {
+    if (entry->confirmed || entry->first_url == url)
+      return;
+    if (!entry->proxy_list.Equals(result.proxy_list_)) {
+      // The script looks at more than the host, so never cache it.
+      if (path_dependent_origins_.size() >= kMaxPathDependentOrigins) {
+        pac_result_cache_.Clear();
+        path_dependent_origins_.clear();
+      }
+      path_dependent_origins_.insert(origin);
+      return;
+    }
+    confirmed = true;
+  }
+  pac_result_cache_.Put(
+      origin,
+      PacResultCacheEntry(result.proxy_list_,
+                          entry ? entry->first_url : url,
+                          confirmed),
+      now,
+      now + TimeDelta::FromSeconds(kPacResultCacheLifetimeSeconds));
+}
+
+void ProxyService::ClearPacResultCache() {
+  if (net_log_ && (pac_result_cache_hits_ || pac_result_cache_misses_)) {
+    net_log_->AddGlobalEntry(
+        NetLog::TYPE_PROXY_SERVICE_PAC_RESULT_CACHE_STATS,
+        base::Bind(&NetLogPacResultCacheStatsCallback,
+                   pac_result_cache_hits_, pac_result_cache_misses_,
+                   path_dependent_origins_.size()));
+  }
+  pac_result_cache_.Clear();
+  path_dependent_origins_.clear();
+  pac_result_cache_hits_ = 0;
+  pac_result_cache_misses_ = 0;
+}
+
+ProxyService::PacResultCacheEntry::PacResultCacheEntry(
+    const ProxyList& proxy_list,
+    const GURL& first_url,
+    bool confirmed)
+    : proxy_list(proxy_list),
+      first_url(first_url),
+      confirmed(confirmed) {
+}
+
+ProxyService::PacResultCacheEntry::~PacResultCacheEntry() {}
+
 ProxyService::~ProxyService() {
   NetworkChangeNotifier::RemoveIPAddressObserver(this);
   NetworkChangeNotifier::RemoveDNSObserver(this);
@@ -1323,6 +1442,7 @@ ProxyService::State ProxyService::ResetProxyConfig(bool reset_fetched_config) {
 
   permanent_error_ = OK;
   proxy_retry_info_.clear();
+  ClearPacResultCache();
   script_poller_.reset();
   init_proxy_resolver_.reset();
   SuspendAllPendingRequests();
@@ -1351,6 +1471,12 @@ void ProxyService::ResetConfigService(
     ApplyProxyConfigIfAvailable();
 }
 
+void ProxyService::set_pac_result_cache_mode(PacResultCacheMode mode) {
+  DCHECK(CalledOnValidThread());
+  ClearPacResultCache();
+  pac_result_cache_mode_ = mode;
+}
+
 void ProxyService::PurgeMemory() {
   DCHECK(CalledOnValidThread());
   if (resolver_.get())
@@ -1499,6 +1625,9 @@ void ProxyService::InitializeUsingLastFetchedConfig() {
   TimeDelta wait_delay =
       stall_proxy_autoconfig_until_ - TimeTicks::Now();
 
+  // Let the resolver warm up while the script is being downloaded.
+  resolver_->PrepareForPacScript();
+
   init_proxy_resolver_.reset(new InitProxyResolver());
   init_proxy_resolver_->set_quick_check_enabled(quick_check_enabled_);
   int rv = init_proxy_resolver_->Start(
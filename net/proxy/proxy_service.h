@@ -5,6 +5,8 @@
 #ifndef NET_PROXY_PROXY_SERVICE_H_
 #define NET_PROXY_PROXY_SERVICE_H_
 
+#include <functional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -14,15 +16,16 @@
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/non_thread_safe.h"
 #include "net/base/completion_callback.h"
+#include "net/base/expiring_cache.h"
 #include "net/base/load_states.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
 #include "net/base/network_change_notifier.h"
 #include "net/proxy/proxy_config_service.h"
 #include "net/proxy/proxy_info.h"
+#include "net/proxy/proxy_list.h"
 #include "net/proxy/proxy_server.h"
-
-class GURL;
+#include "url/gurl.h"
 
 namespace base {
 class MessageLoop;
@@ -50,6 +53,28 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
  public:
   static const size_t kDefaultNumPacThreads = 4;
 
+  // Controls whether the results of the PAC script are reused between
+  // requests. A result stays cached until the proxy settings, the PAC script
+  // or the network change, or for at most a few minutes (the script may
+  // look at the time of day).
+  enum PacResultCacheMode {
+    // Every request runs the PAC script.
+    PAC_RESULT_CACHE_DISABLED,
+
+    // Requests with the same scheme, host and port share one result. This is
+    // only correct for PAC scripts which don't look at the URL's path.
+    PAC_RESULT_CACHE_BY_HOST,
+
+    // As above, but a host's result is only reused for other URLs once a
+    // second URL on that host gave the same result. Hosts whose URLs give
+    // different results always run the PAC script.
+    //
+    // This is a heuristic, not a guarantee: a script which gives the same
+    // result for the first two URLs on a host but branches on other paths
+    // (e.g. only "/ads/" goes DIRECT) still gets the shared result for them.
+    PAC_RESULT_CACHE_BY_HOST_WITH_PATH_CHECK,
+  };
+
   // This interface defines the set of policies for when to poll the PAC
   // script for changes.
   //
@@ -269,6 +294,19 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
 
   bool quick_check_enabled() const { return quick_check_enabled_; }
 
+  // Defaults to PAC_RESULT_CACHE_DISABLED. Changing the mode empties the
+  // cache.
+  void set_pac_result_cache_mode(PacResultCacheMode mode);
+
+  PacResultCacheMode pac_result_cache_mode() const {
+    return pac_result_cache_mode_;
+  }
+
+  // The number of requests answered from, or missing in, the PAC result cache
+  // since it was last emptied.
+  int pac_result_cache_hits() const { return pac_result_cache_hits_; }
+  int pac_result_cache_misses() const { return pac_result_cache_misses_; }
+
 #if defined(SPDY_PROXY_AUTH_ORIGIN)
   // Values of the UMA DataReductionProxy.BypassInfo{Primary|Fallback}
   // histograms. This enum must remain synchronized with the enum of the same
@@ -314,6 +352,24 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   // which expects requests to finish in the order they were added.
   typedef std::vector<scoped_refptr<PacRequest> > PendingRequests;
 
+  struct PacResultCacheEntry {
+    PacResultCacheEntry(const ProxyList& proxy_list,
+                        const GURL& first_url,
+                        bool confirmed);
+    ~PacResultCacheEntry();
+
+    ProxyList proxy_list;
+    // The URL the result was first computed for.
+    GURL first_url;
+    // False while the result has only been seen for |first_url|, in
+    // PAC_RESULT_CACHE_BY_HOST_WITH_PATH_CHECK mode.
+    bool confirmed;
+  };
+
+  // Keyed by the origin of the URL.
+  typedef ExpiringCache<GURL, PacResultCacheEntry, base::TimeTicks,
+                        std::less<base::TimeTicks> > PacResultCache;
+
   enum State {
     STATE_NONE,
     STATE_WAITING_FOR_PROXY_CONFIG,
@@ -340,7 +396,20 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   // Returns ERR_IO_PENDING if the request cannot be completed synchronously.
   // Otherwise it fills |result| with the proxy information for |url|.
   // Completing synchronously means we don't need to query ProxyResolver.
-  int TryToCompleteSynchronously(const GURL& url, ProxyInfo* result);
+  int TryToCompleteSynchronously(const GURL& url,
+                                 ProxyInfo* result,
+                                 const BoundNetLog& net_log);
+
+  // Fills |result| and returns true if the PAC result cache has an entry that
+  // may be used for |url|.
+  bool LookupPacResultCache(const GURL& url, ProxyInfo* result);
+
+  // Remembers |result|, which the ProxyResolver gave for |url| with the
+  // current configuration.
+  void AddToPacResultCache(const GURL& url, const ProxyInfo& result);
+
+  // Empties the PAC result cache, logging its hit rate to |net_log_|.
+  void ClearPacResultCache();
 
   // Cancels all of the requests sent to the ProxyResolver. These will be
   // restarted when calling SetReady().
@@ -447,6 +516,17 @@ class NET_EXPORT ProxyService : public NetworkChangeNotifier::IPAddressObserver,
   // Whether child ProxyScriptDeciders should use QuickCheck
   bool quick_check_enabled_;
 
+  PacResultCacheMode pac_result_cache_mode_;
+  PacResultCache pac_result_cache_;
+
+  // Origins whose URLs were seen to get different results from the PAC
+  // script, in PAC_RESULT_CACHE_BY_HOST_WITH_PATH_CHECK mode. Bounded in
+  // size; reaching the bound clears it along with |pac_result_cache_|.
+  std::set<GURL> path_dependent_origins_;
+
+  int pac_result_cache_hits_;
+  int pac_result_cache_misses_;
+
   DISALLOW_COPY_AND_ASSIGN(ProxyService);
 };
 
@@ -2790,4 +2790,209 @@ TEST_F(ProxyServiceTest, PACScriptRefetchAfterActivity) {
   EXPECT_TRUE(info3.is_direct());
 }
 
+namespace {
+
+// Resolves |url| with |service|, which must have its PAC script set already.
+// If the request reaches |resolver| it is answered with |pac_result|. Returns
+// whether the PAC script was run.
+bool ResolveWithPacResult(ProxyService* service,
+                          MockAsyncProxyResolver* resolver,
+                          const std::string& url,
+                          const std::string& pac_result,
+                          ProxyInfo* info,
+                          const BoundNetLog& net_log) {
+  TestCompletionCallback callback;
+  int rv = service->ResolveProxy(GURL(url), info, callback.callback(), NULL,
+                                 net_log);
+  if (rv == OK)
+    return false;
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(1u, resolver->pending_requests().size());
+  if (resolver->pending_requests().size() != 1u)
+    return true;
+  resolver->pending_requests()[0]->results()->UsePacString(pac_result);
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+  return true;
+}
+
+}  // namespace
+
+TEST_F(ProxyServiceTest, PacResultCacheDisabledByDefault) {
+  MockProxyConfigService* config_service =
+      new MockProxyConfigService("http://foopy/proxy.pac");
+  MockAsyncProxyResolver* resolver = new MockAsyncProxyResolver;
+  ProxyService service(config_service, resolver, NULL);
+  EXPECT_EQ(ProxyService::PAC_RESULT_CACHE_DISABLED,
+            service.pac_result_cache_mode());
+
+  ProxyInfo info;
+  TestCompletionCallback callback;
+  int rv = service.ResolveProxy(GURL("http://www.google.com/"), &info,
+                                callback.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("foopy");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver,
+                                   "http://www.google.com/", "PROXY foopy:80",
+                                   &info, BoundNetLog()));
+  EXPECT_EQ(0, service.pac_result_cache_hits());
+  EXPECT_EQ(0, service.pac_result_cache_misses());
+}
+
+TEST_F(ProxyServiceTest, PacResultCacheByHost) {
+  MockProxyConfigService* config_service =
+      new MockProxyConfigService("http://foopy/proxy.pac");
+  MockAsyncProxyResolver* resolver = new MockAsyncProxyResolver;
+  ProxyService service(config_service, resolver, NULL);
+  service.set_pac_result_cache_mode(ProxyService::PAC_RESULT_CACHE_BY_HOST);
+
+  ProxyInfo info;
+  TestCompletionCallback callback;
+  int rv = service.ResolveProxy(GURL("http://www.google.com/a"), &info,
+                                callback.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("foopy");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+
+  // Another path on the same host is answered without running the script.
+  CapturingBoundNetLog log;
+  ProxyInfo info2;
+  EXPECT_FALSE(ResolveWithPacResult(&service, resolver,
+                                    "http://www.google.com/b", "DIRECT",
+                                    &info2, log.bound()));
+  EXPECT_EQ("foopy:80", info2.proxy_server().ToURI());
+  EXPECT_TRUE(info2.did_use_pac_script());
+  EXPECT_EQ(service.config().id(), info2.config_id());
+
+  CapturingNetLog::CapturedEntryList entries;
+  log.GetEntries(&entries);
+  ASSERT_EQ(4u, entries.size());
+  EXPECT_TRUE(LogContainsEvent(
+      entries, 1, NetLog::TYPE_PROXY_SERVICE_PAC_RESULT_CACHE_HIT,
+      NetLog::PHASE_NONE));
+
+  // Other schemes and ports are other origins.
+  ProxyInfo info3;
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver,
+                                   "https://www.google.com/a", "DIRECT",
+                                   &info3, BoundNetLog()));
+  EXPECT_TRUE(info3.is_direct());
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver,
+                                   "http://www.google.com:8080/a", "DIRECT",
+                                   &info3, BoundNetLog()));
+
+  EXPECT_EQ(1, service.pac_result_cache_hits());
+  EXPECT_EQ(3, service.pac_result_cache_misses());
+}
+
+TEST_F(ProxyServiceTest, PacResultCacheWithPathCheck) {
+  MockProxyConfigService* config_service =
+      new MockProxyConfigService("http://foopy/proxy.pac");
+  MockAsyncProxyResolver* resolver = new MockAsyncProxyResolver;
+  ProxyService service(config_service, resolver, NULL);
+  service.set_pac_result_cache_mode(
+      ProxyService::PAC_RESULT_CACHE_BY_HOST_WITH_PATH_CHECK);
+
+  ProxyInfo info;
+  TestCompletionCallback callback;
+  int rv = service.ResolveProxy(GURL("http://a.com/1"), &info,
+                                callback.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("foopy");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+
+  // The same URL may reuse the result, but another path on the host has to
+  // run the script until it has been seen to give the same result.
+  EXPECT_FALSE(ResolveWithPacResult(&service, resolver, "http://a.com/1",
+                                    "DIRECT", &info, BoundNetLog()));
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver, "http://a.com/2",
+                                   "PROXY foopy:80", &info, BoundNetLog()));
+  EXPECT_FALSE(ResolveWithPacResult(&service, resolver, "http://a.com/3",
+                                    "DIRECT", &info, BoundNetLog()));
+  EXPECT_EQ("foopy:80", info.proxy_server().ToURI());
+
+  // A host whose paths get different results is never cached.
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver, "http://b.com/1",
+                                   "PROXY foopy:80", &info, BoundNetLog()));
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver, "http://b.com/2",
+                                   "DIRECT", &info, BoundNetLog()));
+  EXPECT_TRUE(info.is_direct());
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver, "http://b.com/1",
+                                   "PROXY foopy:80", &info, BoundNetLog()));
+  EXPECT_TRUE(ResolveWithPacResult(&service, resolver, "http://b.com/2",
+                                   "DIRECT", &info, BoundNetLog()));
+
+  EXPECT_EQ(2, service.pac_result_cache_hits());
+}
+
+TEST_F(ProxyServiceTest, PacResultCacheClearedOnConfigChange) {
+  MockProxyConfigService* config_service =
+      new MockProxyConfigService("http://foopy/proxy.pac");
+  MockAsyncProxyResolver* resolver = new MockAsyncProxyResolver;
+  CapturingNetLog log;
+  ProxyService service(config_service, resolver, &log);
+  service.set_pac_result_cache_mode(ProxyService::PAC_RESULT_CACHE_BY_HOST);
+
+  ProxyInfo info;
+  TestCompletionCallback callback;
+  int rv = service.ResolveProxy(GURL("http://www.google.com/"), &info,
+                                callback.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseNamedProxy("foopy");
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+  EXPECT_FALSE(ResolveWithPacResult(&service, resolver,
+                                    "http://www.google.com/", "DIRECT",
+                                    &info, BoundNetLog()));
+
+  // Switching to another PAC script throws the results away.
+  config_service->SetConfig(
+      ProxyConfig::CreateFromCustomPacURL(GURL("http://foopy/proxy2.pac")));
+  EXPECT_EQ(0, service.pac_result_cache_hits());
+  EXPECT_EQ(0, service.pac_result_cache_misses());
+
+  rv = service.ResolveProxy(GURL("http://www.google.com/"), &info,
+                            callback.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(GURL("http://foopy/proxy2.pac"),
+            resolver->pending_set_pac_script_request()->script_data()->url());
+  resolver->pending_set_pac_script_request()->CompleteNow(OK);
+  ASSERT_EQ(1u, resolver->pending_requests().size());
+  resolver->pending_requests()[0]->results()->UseDirect();
+  resolver->pending_requests()[0]->CompleteNow(OK);
+  EXPECT_EQ(OK, callback.WaitForResult());
+  EXPECT_TRUE(info.is_direct());
+
+  // The hit rate of the old cache was logged.
+  CapturingNetLog::CapturedEntryList entries;
+  log.GetEntries(&entries);
+  bool found_stats = false;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].type != NetLog::TYPE_PROXY_SERVICE_PAC_RESULT_CACHE_STATS)
+      continue;
+    EXPECT_FALSE(found_stats);
+    found_stats = true;
+    int hits = 0;
+    int misses = 0;
+    EXPECT_TRUE(entries[i].GetIntegerValue("hits", &hits));
+    EXPECT_TRUE(entries[i].GetIntegerValue("misses", &misses));
+    EXPECT_EQ(1, hits);
+    EXPECT_EQ(1, misses);
+  }
+  EXPECT_TRUE(found_stats);
+}
+
 }  // namespace net
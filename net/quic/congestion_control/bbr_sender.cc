@@ -0,0 +1,407 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_sender.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "base/logging.h"
+
+using std::max;
+using std::min;
+
+namespace net {
+
+namespace {
+const QuicByteCount kMaxSegmentSize = kMaxPacketSize;
+const QuicByteCount kDefaultReceiveWindow = 64000;
+const QuicByteCount kInitialCongestionWindow = 10 * kMaxSegmentSize;
+// Enough to keep an ack clock going while the pipe drains in PROBE_RTT.
+const QuicByteCount kMinimumCongestionWindow = 4 * kMaxSegmentSize;
+// The gain of STARTUP, 2/ln(2), is the smallest which doubles the delivery
+// rate every round trip.
+const float kHighGain = 2.885f;
+const float kDrainGain = 1 / kHighGain;
+// The PROBE_BW window leaves room for delayed and aggregated acks.
+const float kProbeBwCongestionWindowGain = 2.0f;
+// PROBE_BW sends faster than the estimate for one min RTT, then slower for
+// one to drain what that queued, then at the estimate for six.
+const float kPacingGainCycle[] = { 1.25f, 0.75f, 1, 1, 1, 1, 1, 1 };
+const size_t kPacingGainCycleLength = arraysize(kPacingGainCycle);
+// STARTUP ends once the bandwidth has grown by less than 25% for three
+// rounds in a row.
+const float kStartupGrowthTarget = 1.25f;
+const int kRoundTripsWithoutGrowthBeforeExitingStartup = 3;
+// The min RTT is measured again after ten seconds without a lower sample,
+// by holding the window at its minimum for 200ms.
+const int64 kMinRttExpirySeconds = 10;
+const int64 kProbeRttTimeMs = 200;
+// Constants used for RTT calculation.
+const int kInitialRttMs = 100;  // At a typical RTT 100 ms.
+const float kAlpha = 0.125f;
+const float kOneMinusAlpha = (1 - kAlpha);
+const float kBeta = 0.25f;
+const float kOneMinusBeta = (1 - kBeta);
+}  // namespace
+
+// static
+const size_t BbrSender::kBandwidthWindowSize;
+
+BbrSender::SentPacket::SentPacket(QuicTime sent_time,
+                                  QuicByteCount bytes,
+                                  QuicTime first_sent_time,
+                                  QuicByteCount delivered,
+                                  QuicTime delivered_time)
+    : sent_time(sent_time),
+      bytes(bytes),
+      first_sent_time(first_sent_time),
+      delivered(delivered),
+      delivered_time(delivered_time) {
+}
+
+BbrSender::BbrSender(const QuicClock* clock)
+    : clock_(clock),
+      mode_(STARTUP),
+      receive_window_(kDefaultReceiveWindow),
+      initial_congestion_window_(kInitialCongestionWindow),
+      bytes_in_flight_(0),
+      delivered_(0),
+      delivered_time_(QuicTime::Zero()),
+      round_count_(0),
+      next_round_delivered_(0),
+      last_acked_sent_time_(QuicTime::Zero()),
+      max_bandwidth_per_round_(kBandwidthWindowSize, QuicBandwidth::Zero()),
+      startup_bandwidth_target_(QuicBandwidth::Zero()),
+      rounds_without_growth_(0),
+      is_at_full_bandwidth_(false),
+      cycle_index_(0),
+      cycle_start_(QuicTime::Zero()),
+      min_rtt_(QuicTime::Delta::Zero()),
+      min_rtt_timestamp_(QuicTime::Zero()),
+      probe_rtt_done_time_(QuicTime::Zero()),
+      next_send_time_(QuicTime::Zero()),
+      smoothed_rtt_(QuicTime::Delta::Zero()),
+      mean_deviation_(QuicTime::Delta::Zero()) {
+}
+
+BbrSender::~BbrSender() {}
+
+void BbrSender::SetFromConfig(const QuicConfig& config, bool is_server) {
+  if (is_server) {
+    // Set the initial window size.
+    initial_congestion_window_ =
+        config.server_initial_congestion_window() * kMaxSegmentSize;
+  }
+}
+
+void BbrSender::OnIncomingQuicCongestionFeedbackFrame(
+    const QuicCongestionFeedbackFrame& feedback,
+    QuicTime feedback_receive_time) {
+  if (feedback.type == kTCP) {
+    receive_window_ = feedback.tcp.receive_window;
+  }
+}
+
+void BbrSender::OnPacketAcked(QuicPacketSequenceNumber acked_sequence_number,
+                              QuicByteCount acked_bytes) {
+  SentPacketMap::iterator it = sent_packets_.find(acked_sequence_number);
+  if (it == sent_packets_.end()) {
+    // Sent before this sender took over, or already given up on.
+    return;
+  }
+  const SentPacket& packet = it->second;
+  QuicTime now = clock_->ApproximateNow();
+  delivered_ += packet.bytes;
+  delivered_time_ = now;
+  last_acked_sent_time_ = packet.sent_time;
+
+  if (packet.delivered >= next_round_delivered_) {
+    // Everything sent in the previous round has been acked.
+    next_round_delivered_ = delivered_;
+    ++round_count_;
+    max_bandwidth_per_round_[round_count_ % kBandwidthWindowSize] =
+        QuicBandwidth::Zero();
+    if (mode_ == STARTUP) {
+      CheckStartupDone();
+    }
+  }
+
+  // The delivery rate is measured over the longer of the send and the ack
+  // intervals, so neither bursts of sends nor of acks inflate it. An interval
+  // shorter than the min RTT is too short to measure the bottleneck.
+  QuicTime::Delta interval = QuicTime::Delta::Max(
+      packet.sent_time.Subtract(packet.first_sent_time),
+      now.Subtract(packet.delivered_time));
+  if (!interval.IsZero() && interval >= min_rtt_) {
+    QuicBandwidth sample = QuicBandwidth::FromBytesAndTimeDelta(
+        delivered_ - packet.delivered, interval);
+    QuicBandwidth* round_max =
+        &max_bandwidth_per_round_[round_count_ % kBandwidthWindowSize];
+    if (*round_max < sample) {
+      *round_max = sample;
+    }
+  }
+
+  RemovePacket(acked_sequence_number);
+  UpdateMode(now);
+}
+
+void BbrSender::OnPacketLost(QuicPacketSequenceNumber sequence_number,
+                             QuicTime /*ack_receive_time*/) {
+  // Random loss says nothing about the bottleneck, so the model ignores it.
+  // Loss from an overflowing queue is kept in check by the congestion window,
+  // which tracks the bandwidth-delay product. The packet is abandoned next.
+  DVLOG(1) << "Ignoring loss of " << sequence_number;
+}
+
+bool BbrSender::OnPacketSent(QuicTime sent_time,
+                             QuicPacketSequenceNumber sequence_number,
+                             QuicByteCount bytes,
+                             TransmissionType /*transmission_type*/,
+                             HasRetransmittableData is_retransmittable) {
+  // Only data packets take up the window.
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    return false;
+  }
+  if (bytes_in_flight_ == 0) {
+    // Restarting after an idle period, so measure the delivery rate from now
+    // rather than across the idle time.
+    delivered_time_ = sent_time;
+    last_acked_sent_time_ = sent_time;
+  }
+  sent_packets_.insert(std::make_pair(
+      sequence_number,
+      SentPacket(sent_time, bytes, last_acked_sent_time_, delivered_,
+                 delivered_time_)));
+  bytes_in_flight_ += bytes;
+
+  QuicBandwidth pacing_rate = PacingRate();
+  if (!pacing_rate.IsZero()) {
+    next_send_time_ = QuicTime::Max(next_send_time_, sent_time).Add(
+        pacing_rate.TransferTime(bytes));
+  }
+  return true;
+}
+
+void BbrSender::OnRetransmissionTimeout(bool /*packets_retransmitted*/) {
+  // Nothing outstanding will be acked or abandoned, but the model is still
+  // the best guess of the path.
+  sent_packets_.clear();
+  bytes_in_flight_ = 0;
+}
+
+void BbrSender::OnPacketAbandoned(QuicPacketSequenceNumber sequence_number,
+                                  QuicByteCount /*abandoned_bytes*/) {
+  RemovePacket(sequence_number);
+}
+
+QuicTime::Delta BbrSender::TimeUntilSend(
+    QuicTime now,
+    TransmissionType transmission_type,
+    HasRetransmittableData has_retransmittable_data,
+    IsHandshake handshake) {
+  if (transmission_type == TLP_RETRANSMISSION ||
+      has_retransmittable_data == NO_RETRANSMITTABLE_DATA ||
+      handshake == IS_HANDSHAKE) {
+    // ACKs, handshake messages and tail loss probes go out immediately, as
+    // they do for TCP.
+    return QuicTime::Delta::Zero();
+  }
+  if (bytes_in_flight_ >= min(receive_window_, GetCongestionWindow())) {
+    return QuicTime::Delta::Infinite();
+  }
+  if (next_send_time_ > now) {
+    return next_send_time_.Subtract(now);
+  }
+  return QuicTime::Delta::Zero();
+}
+
+QuicBandwidth BbrSender::BandwidthEstimate() const {
+  return *std::max_element(max_bandwidth_per_round_.begin(),
+                           max_bandwidth_per_round_.end());
+}
+
+void BbrSender::UpdateRtt(QuicTime::Delta rtt) {
+  if (rtt.IsInfinite() || rtt.IsZero()) {
+    DVLOG(1) << "Ignoring rtt, because it's "
+             << (rtt.IsZero() ? "Zero" : "Infinite");
+    return;
+  }
+  QuicTime now = clock_->ApproximateNow();
+  bool min_rtt_expired = !min_rtt_.IsZero() &&
+      now > min_rtt_timestamp_.Add(
+          QuicTime::Delta::FromSeconds(kMinRttExpirySeconds));
+  if (min_rtt_.IsZero() || rtt <= min_rtt_ || min_rtt_expired) {
+    min_rtt_ = rtt;
+    min_rtt_timestamp_ = now;
+  }
+  if (min_rtt_expired && mode_ != PROBE_RTT) {
+    DVLOG(1) << "Min RTT expired; probing RTT.";
+    mode_ = PROBE_RTT;
+    probe_rtt_done_time_ = QuicTime::Zero();
+  }
+
+  if (smoothed_rtt_.IsZero()) {
+    smoothed_rtt_ = rtt;
+    mean_deviation_ = QuicTime::Delta::FromMicroseconds(
+        rtt.ToMicroseconds() / 2);
+  } else {
+    mean_deviation_ = QuicTime::Delta::FromMicroseconds(
+        kOneMinusBeta * mean_deviation_.ToMicroseconds() +
+        kBeta *
+            std::abs(smoothed_rtt_.ToMicroseconds() - rtt.ToMicroseconds()));
+    smoothed_rtt_ = QuicTime::Delta::FromMicroseconds(
+        kOneMinusAlpha * smoothed_rtt_.ToMicroseconds() +
+        kAlpha * rtt.ToMicroseconds());
+  }
+}
+
+QuicTime::Delta BbrSender::SmoothedRtt() const {
+  if (smoothed_rtt_.IsZero()) {
+    return QuicTime::Delta::FromMilliseconds(kInitialRttMs);
+  }
+  return smoothed_rtt_;
+}
+
+QuicTime::Delta BbrSender::RetransmissionDelay() const {
+  return QuicTime::Delta::FromMicroseconds(
+      smoothed_rtt_.ToMicroseconds() + 4 * mean_deviation_.ToMicroseconds());
+}
+
+QuicByteCount BbrSender::GetCongestionWindow() const {
+  if (mode_ == PROBE_RTT) {
+    return kMinimumCongestionWindow;
+  }
+  QuicByteCount bandwidth_delay_product = BandwidthDelayProduct();
+  if (bandwidth_delay_product == 0) {
+    return initial_congestion_window_;
+  }
+  QuicByteCount congestion_window = max(
+      kMinimumCongestionWindow,
+      static_cast<QuicByteCount>(bandwidth_delay_product *
+                                 CongestionWindowGain()));
+  if (mode_ == STARTUP) {
+    // Don't shrink below the initial window on an early, low estimate.
+    congestion_window = max(congestion_window, initial_congestion_window_);
+  }
+  return congestion_window;
+}
+
+QuicByteCount BbrSender::BandwidthDelayProduct() const {
+  if (min_rtt_.IsZero()) {
+    return 0;
+  }
+  return BandwidthEstimate().ToBytesPerPeriod(min_rtt_);
+}
+
+QuicBandwidth BbrSender::PacingRate() const {
+  QuicBandwidth bandwidth = BandwidthEstimate();
+  if (bandwidth.IsZero()) {
+    // Until the first estimate, pace the initial window over the min RTT, if
+    // there is one.
+    if (min_rtt_.IsZero()) {
+      return QuicBandwidth::Zero();
+    }
+    bandwidth = QuicBandwidth::FromBytesAndTimeDelta(
+        initial_congestion_window_, min_rtt_);
+  }
+  return bandwidth.Scale(PacingGain());
+}
+
+float BbrSender::PacingGain() const {
+  switch (mode_) {
+    case STARTUP:
+      return kHighGain;
+    case DRAIN:
+      return kDrainGain;
+    case PROBE_BW:
+      return kPacingGainCycle[cycle_index_];
+    case PROBE_RTT:
+      return 1;
+  }
+  NOTREACHED();
+  return 1;
+}
+
+float BbrSender::CongestionWindowGain() const {
+  if (mode_ == STARTUP || mode_ == DRAIN) {
+    return kHighGain;
+  }
+  return kProbeBwCongestionWindowGain;
+}
+
+void BbrSender::CheckStartupDone() {
+  QuicBandwidth bandwidth = BandwidthEstimate();
+  if (startup_bandwidth_target_ <= bandwidth) {
+    startup_bandwidth_target_ = bandwidth.Scale(kStartupGrowthTarget);
+    rounds_without_growth_ = 0;
+    return;
+  }
+  if (++rounds_without_growth_ >=
+      kRoundTripsWithoutGrowthBeforeExitingStartup) {
+    DVLOG(1) << "Bandwidth stopped growing at "
+             << bandwidth.ToKBitsPerSecond() << " Kbps; draining.";
+    is_at_full_bandwidth_ = true;
+    mode_ = DRAIN;
+  }
+}
+
+void BbrSender::UpdateMode(QuicTime now) {
+  switch (mode_) {
+    case STARTUP:
+      break;
+    case DRAIN:
+      if (bytes_in_flight_ <= BandwidthDelayProduct()) {
+        EnterProbeBw(now);
+      }
+      break;
+    case PROBE_BW: {
+      // Leave the draining phase as soon as the queue is gone.
+      bool queue_drained = kPacingGainCycle[cycle_index_] < 1 &&
+          bytes_in_flight_ <= BandwidthDelayProduct();
+      if (queue_drained || now.Subtract(cycle_start_) > min_rtt_) {
+        cycle_index_ = (cycle_index_ + 1) % kPacingGainCycleLength;
+        cycle_start_ = now;
+      }
+      break;
+    }
+    case PROBE_RTT:
+      if (probe_rtt_done_time_ == QuicTime::Zero()) {
+        if (bytes_in_flight_ <= kMinimumCongestionWindow) {
+          probe_rtt_done_time_ =
+              now.Add(QuicTime::Delta::FromMilliseconds(kProbeRttTimeMs));
+        }
+      } else if (now >= probe_rtt_done_time_) {
+        // The samples taken while the queue was empty are the min RTT now.
+        min_rtt_timestamp_ = now;
+        if (is_at_full_bandwidth_) {
+          EnterProbeBw(now);
+        } else {
+          mode_ = STARTUP;
+        }
+      }
+      break;
+  }
+}
+
+void BbrSender::EnterProbeBw(QuicTime now) {
+  mode_ = PROBE_BW;
+  // Start the cycle anywhere but in the draining phase.
+  cycle_index_ = (round_count_ % (kPacingGainCycleLength - 1) + 2) %
+      kPacingGainCycleLength;
+  cycle_start_ = now;
+}
+
+void BbrSender::RemovePacket(QuicPacketSequenceNumber sequence_number) {
+  SentPacketMap::iterator it = sent_packets_.find(sequence_number);
+  if (it == sent_packets_.end()) {
+    return;
+  }
+  DCHECK_GE(bytes_in_flight_, it->second.bytes);
+  bytes_in_flight_ -= it->second.bytes;
+  sent_packets_.erase(it);
+}
+
+}  // namespace net
@@ -0,0 +1,166 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A model based send algorithm. Rather than reacting to loss, it estimates
+// the bottleneck bandwidth from the rate at which acks arrive and the
+// propagation delay from the minimum RTT, and paces packets at the estimated
+// bandwidth with a congestion window of a small multiple of their product.
+
+#ifndef NET_QUIC_CONGESTION_CONTROL_BBR_SENDER_H_
+#define NET_QUIC_CONGESTION_CONTROL_BBR_SENDER_H_
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "net/base/net_export.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+namespace test {
+class BbrSenderPeer;
+}  // namespace test
+
+class NET_EXPORT_PRIVATE BbrSender : public SendAlgorithmInterface {
+ public:
+  enum Mode {
+    // Doubles the sending rate every round trip until the bandwidth estimate
+    // stops growing.
+    STARTUP,
+    // Sends slower than the estimate to drain the queue built in STARTUP.
+    DRAIN,
+    // Cycles the sending rate around the estimate to discover more bandwidth.
+    PROBE_BW,
+    // Shrinks the window to let the queue empty and measure the minimum RTT.
+    PROBE_RTT,
+  };
+
+  explicit BbrSender(const QuicClock* clock);
+  virtual ~BbrSender();
+
+  // Start implementation of SendAlgorithmInterface.
+  virtual void SetFromConfig(const QuicConfig& config, bool is_server) OVERRIDE;
+  virtual void OnIncomingQuicCongestionFeedbackFrame(
+      const QuicCongestionFeedbackFrame& feedback,
+      QuicTime feedback_receive_time) OVERRIDE;
+  virtual void OnPacketAcked(QuicPacketSequenceNumber acked_sequence_number,
+                             QuicByteCount acked_bytes) OVERRIDE;
+  virtual void OnPacketLost(QuicPacketSequenceNumber sequence_number,
+                            QuicTime ack_receive_time) OVERRIDE;
+  virtual bool OnPacketSent(QuicTime sent_time,
+                            QuicPacketSequenceNumber sequence_number,
+                            QuicByteCount bytes,
+                            TransmissionType transmission_type,
+                            HasRetransmittableData is_retransmittable) OVERRIDE;
+  virtual void OnRetransmissionTimeout(bool packets_retransmitted) OVERRIDE;
+  virtual void OnPacketAbandoned(QuicPacketSequenceNumber sequence_number,
+                                 QuicByteCount abandoned_bytes) OVERRIDE;
+  virtual QuicTime::Delta TimeUntilSend(
+      QuicTime now,
+      TransmissionType transmission_type,
+      HasRetransmittableData has_retransmittable_data,
+      IsHandshake handshake) OVERRIDE;
+  virtual QuicBandwidth BandwidthEstimate() const OVERRIDE;
+  virtual void UpdateRtt(QuicTime::Delta rtt_sample) OVERRIDE;
+  virtual QuicTime::Delta SmoothedRtt() const OVERRIDE;
+  virtual QuicTime::Delta RetransmissionDelay() const OVERRIDE;
+  virtual QuicByteCount GetCongestionWindow() const OVERRIDE;
+  // End implementation of SendAlgorithmInterface.
+
+  Mode mode() const { return mode_; }
+
+ private:
+  friend class test::BbrSenderPeer;
+
+  // What is known about a packet when it is sent, used to compute the
+  // delivery rate when it is acked.
+  struct SentPacket {
+    SentPacket(QuicTime sent_time,
+               QuicByteCount bytes,
+               QuicTime first_sent_time,
+               QuicByteCount delivered,
+               QuicTime delivered_time);
+
+    QuicTime sent_time;
+    QuicByteCount bytes;
+    // When the last packet acked before this one was sent, was sent.
+    QuicTime first_sent_time;
+    // The bytes delivered, and the time of the delivery, when it was sent.
+    QuicByteCount delivered;
+    QuicTime delivered_time;
+  };
+  typedef std::map<QuicPacketSequenceNumber, SentPacket> SentPacketMap;
+
+  // The number of round trips the maximum bandwidth is taken over.
+  static const size_t kBandwidthWindowSize = 10;
+
+  // Returns the estimated bandwidth-delay product, or zero without an
+  // estimate.
+  QuicByteCount BandwidthDelayProduct() const;
+  QuicBandwidth PacingRate() const;
+
+  float PacingGain() const;
+  float CongestionWindowGain() const;
+
+  void CheckStartupDone();
+  void UpdateMode(QuicTime now);
+  void EnterProbeBw(QuicTime now);
+  void RemovePacket(QuicPacketSequenceNumber sequence_number);
+
+  const QuicClock* clock_;
+  Mode mode_;
+
+  // Receiver side advertised window.
+  QuicByteCount receive_window_;
+  QuicByteCount initial_congestion_window_;
+
+  SentPacketMap sent_packets_;
+  QuicByteCount bytes_in_flight_;
+
+  // Total bytes acked, and when the last of them was.
+  QuicByteCount delivered_;
+  QuicTime delivered_time_;
+
+  // A round trip ends when a packet sent after it began is acked.
+  int64 round_count_;
+  QuicByteCount next_round_delivered_;
+
+  // When the most recently acked packet was sent.
+  QuicTime last_acked_sent_time_;
+
+  // The largest delivery rate of each of the last kBandwidthWindowSize rounds.
+  std::vector<QuicBandwidth> max_bandwidth_per_round_;
+
+  // STARTUP ends when the bandwidth stops growing.
+  QuicBandwidth startup_bandwidth_target_;
+  int rounds_without_growth_;
+  bool is_at_full_bandwidth_;
+
+  // The gain cycle of PROBE_BW.
+  size_t cycle_index_;
+  QuicTime cycle_start_;
+
+  // The minimum RTT, and when it was measured.
+  QuicTime::Delta min_rtt_;
+  QuicTime min_rtt_timestamp_;
+  // When PROBE_RTT may end, or zero until the window has drained.
+  QuicTime probe_rtt_done_time_;
+
+  // The next time a packet may be sent at the pacing rate.
+  QuicTime next_send_time_;
+
+  QuicTime::Delta smoothed_rtt_;
+  QuicTime::Delta mean_deviation_;
+
+  DISALLOW_COPY_AND_ASSIGN(BbrSender);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CONGESTION_CONTROL_BBR_SENDER_H_
@@ -0,0 +1,197 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_sender.h"
+
+#include "base/memory/scoped_ptr.h"
+#include "net/quic/congestion_control/send_algorithm_simulator.h"
+#include "net/quic/congestion_control/tcp_cubic_sender.h"
+#include "net/quic/test_tools/mock_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+class BbrSenderPeer {
+ public:
+  static QuicTime::Delta min_rtt(const BbrSender& sender) {
+    return sender.min_rtt_;
+  }
+};
+
+namespace {
+
+const QuicByteCount kPacketSize = kMaxPacketSize;
+
+class BbrSenderTest : public ::testing::Test {
+ protected:
+  BbrSenderTest()
+      : sender_(&clock_),
+        sequence_number_(1) {
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+  }
+
+  bool CanSend() {
+    return sender_.TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                 HAS_RETRANSMITTABLE_DATA,
+                                 NOT_HANDSHAKE).IsZero();
+  }
+
+  QuicPacketSequenceNumber SendPacket() {
+    sender_.OnPacketSent(clock_.Now(), sequence_number_, kPacketSize,
+                         NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA);
+    return sequence_number_++;
+  }
+
+  MockClock clock_;
+  BbrSender sender_;
+  QuicPacketSequenceNumber sequence_number_;
+};
+
+TEST_F(BbrSenderTest, InitialWindow) {
+  EXPECT_EQ(BbrSender::STARTUP, sender_.mode());
+  EXPECT_TRUE(sender_.BandwidthEstimate().IsZero());
+  EXPECT_EQ(10 * kPacketSize, sender_.GetCongestionWindow());
+  // Without an RTT there is nothing to pace to, so the initial window goes
+  // out at once.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(CanSend());
+    SendPacket();
+  }
+  EXPECT_TRUE(sender_.TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                    HAS_RETRANSMITTABLE_DATA,
+                                    NOT_HANDSHAKE).IsInfinite());
+  // ACKs and handshake packets aren't held back.
+  EXPECT_TRUE(sender_.TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                    NO_RETRANSMITTABLE_DATA,
+                                    NOT_HANDSHAKE).IsZero());
+  EXPECT_TRUE(sender_.TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                    HAS_RETRANSMITTABLE_DATA,
+                                    IS_HANDSHAKE).IsZero());
+}
+
+TEST_F(BbrSenderTest, EstimatesBandwidthFromAcks) {
+  const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+  const QuicTime::Delta kSpacing = QuicTime::Delta::FromMilliseconds(10);
+  for (int i = 0; i < 10; ++i) {
+    SendPacket();
+  }
+  clock_.AdvanceTime(kRtt);
+  for (QuicPacketSequenceNumber acked = 1; acked <= 10; ++acked) {
+    clock_.AdvanceTime(kSpacing);
+    sender_.UpdateRtt(kRtt.Add(kSpacing.Multiply(static_cast<int>(acked))));
+    sender_.OnPacketAcked(acked, kPacketSize);
+  }
+  EXPECT_EQ(kRtt.Add(kSpacing), BbrSenderPeer::min_rtt(sender_));
+  // The rate is measured over each packet's flight, so the best sample is
+  // the whole window delivered in the 200ms since it was sent.
+  EXPECT_EQ(QuicBandwidth::FromBytesAndTimeDelta(
+                10 * kPacketSize, QuicTime::Delta::FromMilliseconds(200)),
+            sender_.BandwidthEstimate());
+
+  // Packets are now paced faster than the estimate, but no longer sent
+  // back to back.
+  ASSERT_TRUE(CanSend());
+  SendPacket();
+  QuicTime::Delta time_until_send = sender_.TimeUntilSend(
+      clock_.Now(), NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA,
+      NOT_HANDSHAKE);
+  EXPECT_FALSE(time_until_send.IsZero());
+  EXPECT_GT(kSpacing, time_until_send);
+}
+
+TEST_F(BbrSenderTest, IgnoresPacketsItDidNotSend) {
+  // The sender may take over a connection with packets in flight.
+  sender_.OnPacketAcked(5, kPacketSize);
+  sender_.OnPacketAbandoned(6, kPacketSize);
+  sender_.OnPacketLost(7, clock_.Now());
+  EXPECT_TRUE(sender_.BandwidthEstimate().IsZero());
+  EXPECT_TRUE(CanSend());
+}
+
+TEST_F(BbrSenderTest, RetransmissionTimeoutEmptiesWindow) {
+  while (CanSend()) {
+    SendPacket();
+  }
+  sender_.OnRetransmissionTimeout(true);
+  EXPECT_TRUE(CanSend());
+}
+
+// Transfers over a clean link settle to the link's bandwidth.
+TEST_F(BbrSenderTest, SimulatedTransferFillsLink) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  SendAlgorithmSimulator simulator(&clock_, kBandwidth,
+                                   QuicTime::Delta::FromMilliseconds(100));
+  simulator.TransferBytes(&sender_, 10 * 1024 * 1024,
+                          QuicTime::Delta::FromSeconds(60));
+
+  EXPECT_EQ(10u * 1024 * 1024, simulator.stats().bytes_acked);
+  EXPECT_EQ(BbrSender::PROBE_BW, sender_.mode());
+  EXPECT_LE(kBandwidth.Scale(0.95f), sender_.BandwidthEstimate());
+  EXPECT_GE(kBandwidth.Scale(1.05f), sender_.BandwidthEstimate());
+  EXPECT_LE(kBandwidth.Scale(0.85f), simulator.Goodput());
+}
+
+// Random loss, unlike congestion, doesn't slow the sender down, where it
+// cripples cubic.
+TEST_F(BbrSenderTest, SimulatedTransferWithRandomLoss) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+  const QuicByteCount kTransferSize = 10 * 1024 * 1024;
+  const QuicTime::Delta kTimeout = QuicTime::Delta::FromSeconds(120);
+
+  SendAlgorithmSimulator bbr_simulator(&clock_, kBandwidth, kRtt);
+  bbr_simulator.set_loss_rate(0.02f);
+  bbr_simulator.set_jitter(QuicTime::Delta::FromMilliseconds(20));
+  bbr_simulator.TransferBytes(&sender_, kTransferSize, kTimeout);
+  EXPECT_EQ(kTransferSize, bbr_simulator.stats().bytes_acked);
+  EXPECT_LT(0u, bbr_simulator.stats().packets_lost);
+  EXPECT_LE(kBandwidth.Scale(0.7f), bbr_simulator.Goodput());
+
+  TcpCubicSender cubic(&clock_, false, kMaxTcpCongestionWindow);
+  SendAlgorithmSimulator cubic_simulator(&clock_, kBandwidth, kRtt);
+  cubic_simulator.set_loss_rate(0.02f);
+  cubic_simulator.set_jitter(QuicTime::Delta::FromMilliseconds(20));
+  cubic_simulator.TransferBytes(&cubic, kTransferSize, kTimeout);
+  EXPECT_LT(cubic_simulator.Goodput().Scale(2), bbr_simulator.Goodput());
+}
+
+// A shallow queue overflows in STARTUP, but the sender then keeps the queue
+// short and stops losing packets to it.
+TEST_F(BbrSenderTest, SimulatedTransferWithShallowBuffer) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+  SendAlgorithmSimulator simulator(&clock_, kBandwidth, kRtt);
+  simulator.set_buffer_size(kBandwidth.ToBytesPerPeriod(kRtt) / 4);
+  simulator.TransferBytes(&sender_, 10 * 1024 * 1024,
+                          QuicTime::Delta::FromSeconds(60));
+
+  EXPECT_EQ(10u * 1024 * 1024, simulator.stats().bytes_acked);
+  EXPECT_LE(kBandwidth.Scale(0.8f), simulator.Goodput());
+  EXPECT_GT(simulator.stats().packets_sent / 20,
+            simulator.stats().packets_dropped);
+}
+
+// The min RTT is measured again, so it follows a path which gets longer.
+TEST_F(BbrSenderTest, MinRttExpires) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  SendAlgorithmSimulator short_path(&clock_, kBandwidth,
+                                    QuicTime::Delta::FromMilliseconds(50));
+  short_path.TransferBytes(&sender_, 1024 * 1024,
+                           QuicTime::Delta::FromSeconds(60));
+  EXPECT_GT(QuicTime::Delta::FromMilliseconds(60),
+            BbrSenderPeer::min_rtt(sender_));
+
+  SendAlgorithmSimulator long_path(&clock_, kBandwidth,
+                                   QuicTime::Delta::FromMilliseconds(150));
+  long_path.TransferBytes(&sender_, 20 * 1024 * 1024,
+                          QuicTime::Delta::FromSeconds(60));
+  EXPECT_EQ(20u * 1024 * 1024, long_path.stats().bytes_acked);
+  EXPECT_LE(QuicTime::Delta::FromMilliseconds(150),
+            BbrSenderPeer::min_rtt(sender_));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
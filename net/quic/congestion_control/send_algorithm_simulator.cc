@@ -0,0 +1,257 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/send_algorithm_simulator.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/congestion_control/tcp_receiver.h"
+#include "net/quic/test_tools/mock_clock.h"
+
+using std::min;
+
+namespace net {
+
+namespace {
+const QuicByteCount kPacketSize = kMaxPacketSize;
+// Like the sent packet manager, a packet is lost once three packets sent
+// after it are acked.
+const QuicPacketSequenceNumber kNumberOfNacksBeforeLoss = 3;
+const int64 kMinRetransmissionTimeMs = 200;
+const int kMaxRetransmissionBackoff = 10;
+const uint64 kDefaultSeed = GG_UINT64_C(0x9E3779B97F4A7C15);
+}  // namespace
+
+SendAlgorithmSimulator::Stats::Stats()
+    : bytes_acked(0),
+      packets_sent(0),
+      packets_dropped(0),
+      packets_lost(0),
+      retransmission_timeouts(0),
+      transfer_time(QuicTime::Delta::Zero()) {
+}
+
+SendAlgorithmSimulator::SentPacket::SentPacket(QuicTime send_time,
+                                               QuicByteCount bytes)
+    : send_time(send_time),
+      bytes(bytes) {
+}
+
+SendAlgorithmSimulator::PendingAck::PendingAck(
+    QuicPacketSequenceNumber sequence_number,
+    QuicTime ack_time)
+    : sequence_number(sequence_number),
+      ack_time(ack_time) {
+}
+
+SendAlgorithmSimulator::SendAlgorithmSimulator(MockClock* clock,
+                                               QuicBandwidth bandwidth,
+                                               QuicTime::Delta rtt)
+    : clock_(clock),
+      bandwidth_(bandwidth),
+      one_way_delay_(QuicTime::Delta::FromMicroseconds(
+          rtt.ToMicroseconds() / 2)),
+      loss_rate_(0),
+      jitter_(QuicTime::Delta::Zero()),
+      buffer_size_(bandwidth.ToBytesPerPeriod(rtt)),
+      random_state_(kDefaultSeed),
+      link_free_time_(QuicTime::Zero()),
+      last_ack_time_(QuicTime::Zero()),
+      next_sequence_number_(1),
+      bytes_to_send_(0),
+      bytes_to_retransmit_(0),
+      retransmission_base_time_(QuicTime::Zero()),
+      consecutive_retransmission_timeouts_(0) {
+  DCHECK(!bandwidth.IsZero());
+}
+
+SendAlgorithmSimulator::~SendAlgorithmSimulator() {}
+
+void SendAlgorithmSimulator::set_seed(uint64 seed) {
+  // Zero is a fixed point of the generator.
+  random_state_ = seed == 0 ? kDefaultSeed : seed;
+}
+
+void SendAlgorithmSimulator::TransferBytes(
+    SendAlgorithmInterface* send_algorithm,
+    QuicByteCount num_bytes,
+    QuicTime::Delta timeout) {
+  stats_ = Stats();
+  pending_acks_.clear();
+  sent_packets_.clear();
+  link_free_time_ = clock_->Now();
+  last_ack_time_ = clock_->Now();
+  bytes_to_send_ = num_bytes;
+  bytes_to_retransmit_ = 0;
+  consecutive_retransmission_timeouts_ = 0;
+
+  const QuicTime start_time = clock_->Now();
+  const QuicTime end_time = start_time.Add(timeout);
+  // The peer advertises the receive window of a TCP style receiver.
+  TcpReceiver receiver;
+  QuicCongestionFeedbackFrame feedback;
+  receiver.GenerateCongestionFeedback(&feedback);
+  send_algorithm->OnIncomingQuicCongestionFeedbackFrame(feedback, start_time);
+  while (stats_.bytes_acked < num_bytes && clock_->Now() < end_time) {
+    QuicTime::Delta time_until_send = QuicTime::Delta::Infinite();
+    while (bytes_to_send_ + bytes_to_retransmit_ > 0) {
+      TransmissionType transmission_type = bytes_to_retransmit_ > 0 ?
+          NACK_RETRANSMISSION : NOT_RETRANSMISSION;
+      time_until_send = send_algorithm->TimeUntilSend(
+          clock_->Now(), transmission_type, HAS_RETRANSMITTABLE_DATA,
+          NOT_HANDSHAKE);
+      if (!time_until_send.IsZero()) {
+        break;
+      }
+      SendPacket(send_algorithm);
+    }
+
+    QuicTime next_event = end_time;
+    if (!pending_acks_.empty()) {
+      next_event = min(next_event, pending_acks_.front().ack_time);
+    }
+    if (!time_until_send.IsInfinite()) {
+      next_event = min(next_event, clock_->Now().Add(time_until_send));
+    }
+    QuicTime retransmission_time = RetransmissionTime(send_algorithm);
+    if (!sent_packets_.empty()) {
+      next_event = min(next_event, retransmission_time);
+    }
+    if (next_event > clock_->Now()) {
+      clock_->AdvanceTime(next_event.Subtract(clock_->Now()));
+    }
+
+    while (!pending_acks_.empty() &&
+           pending_acks_.front().ack_time <= clock_->Now()) {
+      QuicPacketSequenceNumber sequence_number =
+          pending_acks_.front().sequence_number;
+      pending_acks_.pop_front();
+      OnAck(send_algorithm, sequence_number);
+    }
+    if (!sent_packets_.empty() &&
+        RetransmissionTime(send_algorithm) <= clock_->Now()) {
+      OnRetransmissionTimeout(send_algorithm);
+    }
+  }
+  stats_.transfer_time = clock_->Now().Subtract(start_time);
+}
+
+QuicBandwidth SendAlgorithmSimulator::Goodput() const {
+  if (stats_.transfer_time.IsZero()) {
+    return QuicBandwidth::Zero();
+  }
+  return QuicBandwidth::FromBytesAndTimeDelta(stats_.bytes_acked,
+                                              stats_.transfer_time);
+}
+
+void SendAlgorithmSimulator::SendPacket(
+    SendAlgorithmInterface* send_algorithm) {
+  QuicTime now = clock_->Now();
+  TransmissionType transmission_type = NOT_RETRANSMISSION;
+  QuicByteCount bytes;
+  if (bytes_to_retransmit_ > 0) {
+    transmission_type = NACK_RETRANSMISSION;
+    bytes = min(kPacketSize, bytes_to_retransmit_);
+    bytes_to_retransmit_ -= bytes;
+  } else {
+    bytes = min(kPacketSize, bytes_to_send_);
+    bytes_to_send_ -= bytes;
+  }
+  QuicPacketSequenceNumber sequence_number = next_sequence_number_++;
+  if (sent_packets_.empty()) {
+    retransmission_base_time_ = now;
+  }
+  sent_packets_.insert(
+      std::make_pair(sequence_number, SentPacket(now, bytes)));
+  send_algorithm->OnPacketSent(now, sequence_number, bytes, transmission_type,
+                               HAS_RETRANSMITTABLE_DATA);
+  ++stats_.packets_sent;
+
+  // Tail drop once the bottleneck's queue is full.
+  QuicByteCount queued_bytes = link_free_time_ > now ?
+      bandwidth_.ToBytesPerPeriod(link_free_time_.Subtract(now)) : 0;
+  if (queued_bytes + bytes > buffer_size_) {
+    ++stats_.packets_dropped;
+    return;
+  }
+  link_free_time_ = QuicTime::Max(link_free_time_, now).Add(
+      bandwidth_.TransferTime(bytes));
+  if (RandDouble() < loss_rate_) {
+    ++stats_.packets_dropped;
+    return;
+  }
+  QuicTime::Delta jitter = QuicTime::Delta::FromMicroseconds(
+      static_cast<int64>(RandDouble() * jitter_.ToMicroseconds()));
+  QuicTime ack_time = link_free_time_.Add(one_way_delay_).Add(jitter)
+      .Add(one_way_delay_);
+  last_ack_time_ = QuicTime::Max(last_ack_time_, ack_time);
+  pending_acks_.push_back(PendingAck(sequence_number, last_ack_time_));
+}
+
+void SendAlgorithmSimulator::OnAck(SendAlgorithmInterface* send_algorithm,
+                                   QuicPacketSequenceNumber sequence_number) {
+  SentPacketMap::iterator it = sent_packets_.find(sequence_number);
+  if (it == sent_packets_.end()) {
+    // Already retransmitted after a timeout.
+    return;
+  }
+  QuicTime now = clock_->Now();
+  // The sent packet manager updates the RTT before reporting the ack.
+  send_algorithm->UpdateRtt(now.Subtract(it->second.send_time));
+  send_algorithm->OnPacketAcked(sequence_number, it->second.bytes);
+  stats_.bytes_acked += it->second.bytes;
+  sent_packets_.erase(it);
+  retransmission_base_time_ = now;
+  consecutive_retransmission_timeouts_ = 0;
+
+  // Acks arrive in order, so anything sent well before this is gone.
+  while (!sent_packets_.empty() &&
+         sent_packets_.begin()->first + kNumberOfNacksBeforeLoss <=
+             sequence_number) {
+    QuicPacketSequenceNumber lost = sent_packets_.begin()->first;
+    QuicByteCount lost_bytes = sent_packets_.begin()->second.bytes;
+    sent_packets_.erase(sent_packets_.begin());
+    send_algorithm->OnPacketLost(lost, now);
+    send_algorithm->OnPacketAbandoned(lost, lost_bytes);
+    bytes_to_retransmit_ += lost_bytes;
+    ++stats_.packets_lost;
+  }
+}
+
+void SendAlgorithmSimulator::OnRetransmissionTimeout(
+    SendAlgorithmInterface* send_algorithm) {
+  ++stats_.retransmission_timeouts;
+  ++consecutive_retransmission_timeouts_;
+  for (SentPacketMap::const_iterator it = sent_packets_.begin();
+       it != sent_packets_.end(); ++it) {
+    bytes_to_retransmit_ += it->second.bytes;
+  }
+  sent_packets_.clear();
+  send_algorithm->OnRetransmissionTimeout(true);
+  retransmission_base_time_ = clock_->Now();
+}
+
+QuicTime SendAlgorithmSimulator::RetransmissionTime(
+    SendAlgorithmInterface* send_algorithm) const {
+  QuicTime::Delta delay = QuicTime::Delta::Max(
+      send_algorithm->RetransmissionDelay(),
+      QuicTime::Delta::FromMilliseconds(kMinRetransmissionTimeMs));
+  return retransmission_base_time_.Add(delay.Multiply(
+      1 << min(consecutive_retransmission_timeouts_,
+               kMaxRetransmissionBackoff)));
+}
+
+double SendAlgorithmSimulator::RandDouble() {
+  // xorshift64*, which is plenty for picking losses and is the same on every
+  // platform.
+  random_state_ ^= random_state_ >> 12;
+  random_state_ ^= random_state_ << 25;
+  random_state_ ^= random_state_ >> 27;
+  uint64 value = random_state_ * GG_UINT64_C(2685821657736338717);
+  return (value >> 11) * (1.0 / (GG_UINT64_C(1) << 53));
+}
+
+}  // namespace net
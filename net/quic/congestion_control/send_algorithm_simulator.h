@@ -0,0 +1,126 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Runs whole transfers with a send algorithm over a simulated bottleneck
+// link, on a MockClock, so that algorithms can be compared offline. The link
+// has a fixed bandwidth and queue, and adds propagation delay, jitter and
+// random loss. Acks return over an uncongested path. The same seed always
+// gives the same run.
+
+#ifndef NET_QUIC_CONGESTION_CONTROL_SEND_ALGORITHM_SIMULATOR_H_
+#define NET_QUIC_CONGESTION_CONTROL_SEND_ALGORITHM_SIMULATOR_H_
+
+#include <deque>
+#include <map>
+
+#include "base/basictypes.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+class MockClock;
+class SendAlgorithmInterface;
+
+class SendAlgorithmSimulator {
+ public:
+  struct Stats {
+    Stats();
+
+    QuicByteCount bytes_acked;
+    size_t packets_sent;
+    // Packets the link dropped, either from a full queue or at random.
+    size_t packets_dropped;
+    // Packets the simulated loss detection gave to the send algorithm as lost.
+    size_t packets_lost;
+    size_t retransmission_timeouts;
+    // From the first packet sent to the last ack.
+    QuicTime::Delta transfer_time;
+  };
+
+  // |rtt| is the round trip time of an empty link.
+  SendAlgorithmSimulator(MockClock* clock,
+                         QuicBandwidth bandwidth,
+                         QuicTime::Delta rtt);
+  ~SendAlgorithmSimulator();
+
+  // The fraction of packets dropped at random. Defaults to none.
+  void set_loss_rate(float loss_rate) { loss_rate_ = loss_rate; }
+  // The most extra one way delay added to a packet, uniformly at random.
+  // Acks are never reordered. Defaults to none.
+  void set_jitter(QuicTime::Delta jitter) { jitter_ = jitter; }
+  // The bytes the bottleneck queues before dropping packets. Defaults to one
+  // bandwidth-delay product.
+  void set_buffer_size(QuicByteCount buffer_size) {
+    buffer_size_ = buffer_size;
+  }
+  void set_seed(uint64 seed);
+
+  // Sends |num_bytes| with |send_algorithm|, retransmitting lost data, and
+  // returns once it has all been acked or |timeout| has passed.
+  void TransferBytes(SendAlgorithmInterface* send_algorithm,
+                     QuicByteCount num_bytes,
+                     QuicTime::Delta timeout);
+
+  // The bandwidth achieved by the last transfer.
+  QuicBandwidth Goodput() const;
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct SentPacket {
+    SentPacket(QuicTime send_time, QuicByteCount bytes);
+
+    QuicTime send_time;
+    QuicByteCount bytes;
+  };
+  typedef std::map<QuicPacketSequenceNumber, SentPacket> SentPacketMap;
+
+  struct PendingAck {
+    PendingAck(QuicPacketSequenceNumber sequence_number, QuicTime ack_time);
+
+    QuicPacketSequenceNumber sequence_number;
+    QuicTime ack_time;
+  };
+
+  // Sends one packet, preferring data which needs to be retransmitted.
+  void SendPacket(SendAlgorithmInterface* send_algorithm);
+  void OnAck(SendAlgorithmInterface* send_algorithm,
+             QuicPacketSequenceNumber sequence_number);
+  void OnRetransmissionTimeout(SendAlgorithmInterface* send_algorithm);
+  QuicTime RetransmissionTime(SendAlgorithmInterface* send_algorithm) const;
+
+  // Returns a value in [0, 1).
+  double RandDouble();
+
+  MockClock* clock_;
+  const QuicBandwidth bandwidth_;
+  const QuicTime::Delta one_way_delay_;
+  float loss_rate_;
+  QuicTime::Delta jitter_;
+  QuicByteCount buffer_size_;
+  uint64 random_state_;
+
+  // When the bottleneck has sent everything queued at it.
+  QuicTime link_free_time_;
+  // Acks are delivered in order.
+  std::deque<PendingAck> pending_acks_;
+  QuicTime last_ack_time_;
+
+  SentPacketMap sent_packets_;
+  QuicPacketSequenceNumber next_sequence_number_;
+  QuicByteCount bytes_to_send_;
+  QuicByteCount bytes_to_retransmit_;
+  QuicTime retransmission_base_time_;
+  int consecutive_retransmission_timeouts_;
+
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(SendAlgorithmSimulator);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CONGESTION_CONTROL_SEND_ALGORITHM_SIMULATOR_H_
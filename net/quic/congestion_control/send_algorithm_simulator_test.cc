@@ -0,0 +1,102 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/send_algorithm_simulator.h"
+
+#include "net/quic/congestion_control/tcp_cubic_sender.h"
+#include "net/quic/test_tools/mock_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+const QuicByteCount kTransferSize = 1024 * 1024;
+
+class SendAlgorithmSimulatorTest : public ::testing::Test {
+ protected:
+  SendAlgorithmSimulatorTest()
+      : bandwidth_(QuicBandwidth::FromKBitsPerSecond(10000)),
+        rtt_(QuicTime::Delta::FromMilliseconds(100)),
+        timeout_(QuicTime::Delta::FromSeconds(60)) {
+  }
+
+  const QuicBandwidth bandwidth_;
+  const QuicTime::Delta rtt_;
+  const QuicTime::Delta timeout_;
+  MockClock clock_;
+};
+
+TEST_F(SendAlgorithmSimulatorTest, CleanLink) {
+  TcpCubicSender sender(&clock_, false, kMaxTcpCongestionWindow);
+  SendAlgorithmSimulator simulator(&clock_, bandwidth_, rtt_);
+  simulator.TransferBytes(&sender, kTransferSize, timeout_);
+
+  const SendAlgorithmSimulator::Stats& stats = simulator.stats();
+  EXPECT_EQ(kTransferSize, stats.bytes_acked);
+  EXPECT_EQ(0u, stats.packets_dropped);
+  EXPECT_EQ(0u, stats.packets_lost);
+  EXPECT_EQ(0u, stats.retransmission_timeouts);
+  EXPECT_EQ((kTransferSize + kMaxPacketSize - 1) / kMaxPacketSize,
+            stats.packets_sent);
+  // It takes at least the time to send it all and a round trip.
+  EXPECT_LE(bandwidth_.TransferTime(kTransferSize).Add(rtt_),
+            stats.transfer_time);
+  EXPECT_GE(bandwidth_, simulator.Goodput());
+}
+
+TEST_F(SendAlgorithmSimulatorTest, RandomLossIsRetransmitted) {
+  TcpCubicSender sender(&clock_, false, kMaxTcpCongestionWindow);
+  SendAlgorithmSimulator simulator(&clock_, bandwidth_, rtt_);
+  simulator.set_loss_rate(0.05f);
+  simulator.TransferBytes(&sender, kTransferSize, timeout_);
+
+  const SendAlgorithmSimulator::Stats& stats = simulator.stats();
+  EXPECT_EQ(kTransferSize, stats.bytes_acked);
+  EXPECT_LT(0u, stats.packets_dropped);
+  EXPECT_LE(stats.packets_dropped, stats.packets_lost +
+            stats.retransmission_timeouts * kMaxTcpCongestionWindow);
+}
+
+TEST_F(SendAlgorithmSimulatorTest, FullQueueDropsPackets) {
+  TcpCubicSender sender(&clock_, true, kMaxTcpCongestionWindow);
+  SendAlgorithmSimulator simulator(&clock_, bandwidth_, rtt_);
+  simulator.set_buffer_size(10 * kMaxPacketSize);
+  simulator.TransferBytes(&sender, kTransferSize, timeout_);
+
+  EXPECT_EQ(kTransferSize, simulator.stats().bytes_acked);
+  EXPECT_LT(0u, simulator.stats().packets_dropped);
+}
+
+TEST_F(SendAlgorithmSimulatorTest, Reproducible) {
+  SendAlgorithmSimulator::Stats stats[2];
+  for (int i = 0; i < 2; ++i) {
+    TcpCubicSender sender(&clock_, false, kMaxTcpCongestionWindow);
+    SendAlgorithmSimulator simulator(&clock_, bandwidth_, rtt_);
+    simulator.set_seed(42);
+    simulator.set_loss_rate(0.02f);
+    simulator.set_jitter(QuicTime::Delta::FromMilliseconds(30));
+    simulator.TransferBytes(&sender, kTransferSize, timeout_);
+    stats[i] = simulator.stats();
+  }
+  EXPECT_LT(0u, stats[0].packets_dropped);
+  EXPECT_EQ(stats[0].packets_sent, stats[1].packets_sent);
+  EXPECT_EQ(stats[0].packets_dropped, stats[1].packets_dropped);
+  EXPECT_EQ(stats[0].packets_lost, stats[1].packets_lost);
+  EXPECT_EQ(stats[0].transfer_time, stats[1].transfer_time);
+}
+
+TEST_F(SendAlgorithmSimulatorTest, StopsAtTimeout) {
+  TcpCubicSender sender(&clock_, false, kMaxTcpCongestionWindow);
+  SendAlgorithmSimulator simulator(&clock_, bandwidth_, rtt_);
+  QuicTime start = clock_.Now();
+  simulator.TransferBytes(&sender, 100 * kTransferSize,
+                          QuicTime::Delta::FromSeconds(1));
+  EXPECT_EQ(QuicTime::Delta::FromSeconds(1), clock_.Now().Subtract(start));
+  EXPECT_GT(100 * kTransferSize, simulator.stats().bytes_acked);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -91,18 +91,34 @@ QuicData* Aes128Gcm12Decrypter::DecryptPacket(
   }
   size_t plaintext_size = ciphertext.length();
   scoped_ptr<char[]> plaintext(new char[plaintext_size]);
+  if (!DecryptPacketInto(sequence_number, associated_data, ciphertext,
+                         plaintext.get(), &plaintext_size,
+                         ciphertext.length())) {
+    return NULL;
+  }
+  return new QuicData(plaintext.release(), plaintext_size, true);
+}
+
+bool Aes128Gcm12Decrypter::DecryptPacketInto(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece ciphertext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  if (ciphertext.length() < kAuthTagSize ||
+      max_output_length < ciphertext.length()) {
+    return false;
+  }
+  *output_length = ciphertext.length();
 
   uint8 nonce[kNoncePrefixSize + sizeof(sequence_number)];
   COMPILE_ASSERT(sizeof(nonce) == kAESNonceSize, bad_sequence_number_size);
   memcpy(nonce, nonce_prefix_, kNoncePrefixSize);
   memcpy(nonce + kNoncePrefixSize, &sequence_number, sizeof(sequence_number));
-  if (!Decrypt(StringPiece(reinterpret_cast<char*>(nonce), sizeof(nonce)),
-               associated_data, ciphertext,
-               reinterpret_cast<uint8*>(plaintext.get()),
-               &plaintext_size)) {
-    return NULL;
-  }
-  return new QuicData(plaintext.release(), plaintext_size, true);
+  return Decrypt(StringPiece(reinterpret_cast<char*>(nonce), sizeof(nonce)),
+                 associated_data, ciphertext,
+                 reinterpret_cast<uint8*>(output), output_length);
 }
 
 StringPiece Aes128Gcm12Decrypter::GetKey() const {
@@ -46,6 +46,12 @@ class NET_EXPORT_PRIVATE Aes128Gcm12Encrypter : public QuicEncrypter {
   virtual QuicData* EncryptPacket(QuicPacketSequenceNumber sequence_number,
                                   base::StringPiece associated_data,
                                   base::StringPiece plaintext) OVERRIDE;
+  virtual bool EncryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 base::StringPiece associated_data,
+                                 base::StringPiece plaintext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) OVERRIDE;
   virtual size_t GetKeySize() const OVERRIDE;
   virtual size_t GetNoncePrefixSize() const OVERRIDE;
   virtual size_t GetMaxPlaintextSize(size_t ciphertext_size) const OVERRIDE;
@@ -95,6 +95,26 @@ QuicData* Aes128Gcm12Encrypter::EncryptPacket(
     StringPiece plaintext) {
   size_t ciphertext_size = GetCiphertextSize(plaintext.length());
   scoped_ptr<char[]> ciphertext(new char[ciphertext_size]);
+  if (!EncryptPacketInto(sequence_number, associated_data, plaintext,
+                         ciphertext.get(), &ciphertext_size,
+                         ciphertext_size)) {
+    return NULL;
+  }
+
+  return new QuicData(ciphertext.release(), ciphertext_size, true);
+}
+
+bool Aes128Gcm12Encrypter::EncryptPacketInto(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece plaintext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  size_t ciphertext_size = GetCiphertextSize(plaintext.length());
+  if (max_output_length < ciphertext_size) {
+    return false;
+  }
 
   // TODO(ianswett): Introduce a check to ensure that we don't encrypt with the
   // same sequence number twice.
@@ -104,11 +124,11 @@ QuicData* Aes128Gcm12Encrypter::EncryptPacket(
   memcpy(nonce + kNoncePrefixSize, &sequence_number, sizeof(sequence_number));
   if (!Encrypt(StringPiece(reinterpret_cast<char*>(nonce), sizeof(nonce)),
                associated_data, plaintext,
-               reinterpret_cast<unsigned char*>(ciphertext.get()))) {
-    return NULL;
+               reinterpret_cast<unsigned char*>(output))) {
+    return false;
   }
-
-  return new QuicData(ciphertext.release(), ciphertext_size, true);
+  *output_length = ciphertext_size;
+  return true;
 }
 
 size_t Aes128Gcm12Encrypter::GetKeySize() const { return kKeySize; }
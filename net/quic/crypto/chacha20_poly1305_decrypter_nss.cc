@@ -0,0 +1,70 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/chacha20_poly1305_decrypter.h"
+
+#include "base/logging.h"
+
+using base::StringPiece;
+
+namespace net {
+
+// NSS does not implement ChaCha20-Poly1305, so this cipher is only offered in
+// OpenSSL builds. IsSupported() keeps it out of the AEAD lists here, and the
+// remaining methods are never reached.
+
+ChaCha20Poly1305Decrypter::ChaCha20Poly1305Decrypter() {}
+
+ChaCha20Poly1305Decrypter::~ChaCha20Poly1305Decrypter() {}
+
+// static
+bool ChaCha20Poly1305Decrypter::IsSupported() { return false; }
+
+bool ChaCha20Poly1305Decrypter::SetKey(StringPiece key) {
+  NOTREACHED();
+  return false;
+}
+
+bool ChaCha20Poly1305Decrypter::SetNoncePrefix(StringPiece nonce_prefix) {
+  NOTREACHED();
+  return false;
+}
+
+bool ChaCha20Poly1305Decrypter::Decrypt(StringPiece nonce,
+                                        StringPiece associated_data,
+                                        StringPiece ciphertext,
+                                        unsigned char* output,
+                                        size_t* output_length) {
+  NOTREACHED();
+  return false;
+}
+
+QuicData* ChaCha20Poly1305Decrypter::DecryptPacket(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece ciphertext) {
+  NOTREACHED();
+  return NULL;
+}
+
+bool ChaCha20Poly1305Decrypter::DecryptPacketInto(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece ciphertext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  NOTREACHED();
+  return false;
+}
+
+StringPiece ChaCha20Poly1305Decrypter::GetKey() const {
+  return StringPiece(reinterpret_cast<const char*>(key_), sizeof(key_));
+}
+
+StringPiece ChaCha20Poly1305Decrypter::GetNoncePrefix() const {
+  return StringPiece();
+}
+
+}  // namespace net
@@ -0,0 +1,125 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/chacha20_poly1305_decrypter.h"
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <string.h>
+
+#include "base/memory/scoped_ptr.h"
+
+using base::StringPiece;
+
+namespace net {
+
+namespace {
+
+const size_t kNonceSize = 8;
+
+}  // namespace
+
+ChaCha20Poly1305Decrypter::ChaCha20Poly1305Decrypter() {}
+
+ChaCha20Poly1305Decrypter::~ChaCha20Poly1305Decrypter() {}
+
+// static
+bool ChaCha20Poly1305Decrypter::IsSupported() { return true; }
+
+bool ChaCha20Poly1305Decrypter::SetKey(StringPiece key) {
+  DCHECK_EQ(key.size(), sizeof(key_));
+  if (key.size() != sizeof(key_)) {
+    return false;
+  }
+  memcpy(key_, key.data(), key.size());
+
+  EVP_AEAD_CTX_cleanup(ctx_.get());
+  if (!EVP_AEAD_CTX_init(ctx_.get(), EVP_aead_chacha20_poly1305(), key_,
+                         sizeof(key_), kAuthTagSize, NULL)) {
+    // Clear OpenSSL error stack.
+    while (ERR_get_error()) {}
+    return false;
+  }
+
+  return true;
+}
+
+bool ChaCha20Poly1305Decrypter::SetNoncePrefix(StringPiece nonce_prefix) {
+  // The whole nonce is the sequence number; there is no fixed prefix.
+  return nonce_prefix.empty();
+}
+
+bool ChaCha20Poly1305Decrypter::Decrypt(StringPiece nonce,
+                                        StringPiece associated_data,
+                                        StringPiece ciphertext,
+                                        uint8* output,
+                                        size_t* output_length) {
+  if (ciphertext.length() < kAuthTagSize || nonce.size() != kNonceSize) {
+    return false;
+  }
+
+  ssize_t len = EVP_AEAD_CTX_open(
+      ctx_.get(), output, ciphertext.size(),
+      reinterpret_cast<const uint8_t*>(nonce.data()), nonce.size(),
+      reinterpret_cast<const uint8_t*>(ciphertext.data()), ciphertext.size(),
+      reinterpret_cast<const uint8_t*>(associated_data.data()),
+      associated_data.size());
+
+  if (len < 0) {
+    // Clear OpenSSL error stack.
+    while (ERR_get_error()) {}
+    return false;
+  }
+
+  *output_length = len;
+  return true;
+}
+
+QuicData* ChaCha20Poly1305Decrypter::DecryptPacket(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece ciphertext) {
+  if (ciphertext.length() < kAuthTagSize) {
+    return NULL;
+  }
+  size_t plaintext_size = ciphertext.length();
+  scoped_ptr<char[]> plaintext(new char[plaintext_size]);
+  if (!DecryptPacketInto(sequence_number, associated_data, ciphertext,
+                         plaintext.get(), &plaintext_size,
+                         ciphertext.length())) {
+    return NULL;
+  }
+  return new QuicData(plaintext.release(), plaintext_size, true);
+}
+
+bool ChaCha20Poly1305Decrypter::DecryptPacketInto(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece ciphertext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  if (ciphertext.length() < kAuthTagSize ||
+      max_output_length < ciphertext.length()) {
+    return false;
+  }
+  *output_length = ciphertext.length();
+
+  uint8 nonce[sizeof(sequence_number)];
+  COMPILE_ASSERT(sizeof(nonce) == kNonceSize, bad_sequence_number_size);
+  memcpy(nonce, &sequence_number, sizeof(sequence_number));
+  return Decrypt(StringPiece(reinterpret_cast<char*>(nonce), sizeof(nonce)),
+                 associated_data, ciphertext,
+                 reinterpret_cast<uint8*>(output), output_length);
+}
+
+StringPiece ChaCha20Poly1305Decrypter::GetKey() const {
+  return StringPiece(reinterpret_cast<const char*>(key_), sizeof(key_));
+}
+
+StringPiece ChaCha20Poly1305Decrypter::GetNoncePrefix() const {
+  return StringPiece();
+}
+
+}  // namespace net
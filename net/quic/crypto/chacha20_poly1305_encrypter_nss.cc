@@ -0,0 +1,83 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/chacha20_poly1305_encrypter.h"
+
+#include "base/logging.h"
+
+using base::StringPiece;
+
+namespace net {
+
+// NSS does not implement ChaCha20-Poly1305, so this cipher is only offered in
+// OpenSSL builds. IsSupported() keeps it out of the AEAD lists here, and the
+// remaining methods are never reached.
+
+ChaCha20Poly1305Encrypter::ChaCha20Poly1305Encrypter() {}
+
+ChaCha20Poly1305Encrypter::~ChaCha20Poly1305Encrypter() {}
+
+// static
+bool ChaCha20Poly1305Encrypter::IsSupported() { return false; }
+
+bool ChaCha20Poly1305Encrypter::SetKey(StringPiece key) {
+  NOTREACHED();
+  return false;
+}
+
+bool ChaCha20Poly1305Encrypter::SetNoncePrefix(StringPiece nonce_prefix) {
+  NOTREACHED();
+  return false;
+}
+
+bool ChaCha20Poly1305Encrypter::Encrypt(StringPiece nonce,
+                                        StringPiece associated_data,
+                                        StringPiece plaintext,
+                                        unsigned char* output) {
+  NOTREACHED();
+  return false;
+}
+
+QuicData* ChaCha20Poly1305Encrypter::EncryptPacket(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece plaintext) {
+  NOTREACHED();
+  return NULL;
+}
+
+bool ChaCha20Poly1305Encrypter::EncryptPacketInto(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece plaintext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  NOTREACHED();
+  return false;
+}
+
+size_t ChaCha20Poly1305Encrypter::GetKeySize() const { return sizeof(key_); }
+
+size_t ChaCha20Poly1305Encrypter::GetNoncePrefixSize() const { return 0; }
+
+size_t ChaCha20Poly1305Encrypter::GetMaxPlaintextSize(
+    size_t ciphertext_size) const {
+  return ciphertext_size - kAuthTagSize;
+}
+
+size_t ChaCha20Poly1305Encrypter::GetCiphertextSize(
+    size_t plaintext_size) const {
+  return plaintext_size + kAuthTagSize;
+}
+
+StringPiece ChaCha20Poly1305Encrypter::GetKey() const {
+  return StringPiece(reinterpret_cast<const char*>(key_), sizeof(key_));
+}
+
+StringPiece ChaCha20Poly1305Encrypter::GetNoncePrefix() const {
+  return StringPiece();
+}
+
+}  // namespace net
@@ -0,0 +1,152 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/chacha20_poly1305_encrypter.h"
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <string.h>
+
+#include "base/memory/scoped_ptr.h"
+
+using base::StringPiece;
+
+namespace net {
+
+namespace {
+
+const size_t kKeySize = 32;
+const size_t kNonceSize = 8;
+
+void ClearOpenSslErrors() {
+#ifdef NDEBUG
+  while (ERR_get_error()) {}
+#else
+  while (long error = ERR_get_error()) {
+    char buf[120];
+    ERR_error_string_n(error, buf, arraysize(buf));
+    DLOG(ERROR) << "OpenSSL error: " << buf;
+  }
+#endif
+}
+
+}  // namespace
+
+ChaCha20Poly1305Encrypter::ChaCha20Poly1305Encrypter() {}
+
+ChaCha20Poly1305Encrypter::~ChaCha20Poly1305Encrypter() {}
+
+// static
+bool ChaCha20Poly1305Encrypter::IsSupported() { return true; }
+
+bool ChaCha20Poly1305Encrypter::SetKey(StringPiece key) {
+  DCHECK_EQ(key.size(), sizeof(key_));
+  if (key.size() != sizeof(key_)) {
+    return false;
+  }
+  memcpy(key_, key.data(), key.size());
+
+  EVP_AEAD_CTX_cleanup(ctx_.get());
+
+  if (!EVP_AEAD_CTX_init(ctx_.get(), EVP_aead_chacha20_poly1305(), key_,
+                         sizeof(key_), kAuthTagSize, NULL)) {
+    ClearOpenSslErrors();
+    return false;
+  }
+
+  return true;
+}
+
+bool ChaCha20Poly1305Encrypter::SetNoncePrefix(StringPiece nonce_prefix) {
+  // The whole nonce is the sequence number; there is no fixed prefix.
+  return nonce_prefix.empty();
+}
+
+bool ChaCha20Poly1305Encrypter::Encrypt(StringPiece nonce,
+                                        StringPiece associated_data,
+                                        StringPiece plaintext,
+                                        unsigned char* output) {
+  if (nonce.size() != kNonceSize) {
+    return false;
+  }
+
+  ssize_t len = EVP_AEAD_CTX_seal(
+      ctx_.get(), output, plaintext.size() + kAuthTagSize,
+      reinterpret_cast<const uint8_t*>(nonce.data()), nonce.size(),
+      reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(),
+      reinterpret_cast<const uint8_t*>(associated_data.data()),
+      associated_data.size());
+
+  if (len < 0) {
+    ClearOpenSslErrors();
+    return false;
+  }
+
+  return true;
+}
+
+QuicData* ChaCha20Poly1305Encrypter::EncryptPacket(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece plaintext) {
+  size_t ciphertext_size = GetCiphertextSize(plaintext.length());
+  scoped_ptr<char[]> ciphertext(new char[ciphertext_size]);
+  if (!EncryptPacketInto(sequence_number, associated_data, plaintext,
+                         ciphertext.get(), &ciphertext_size,
+                         ciphertext_size)) {
+    return NULL;
+  }
+
+  return new QuicData(ciphertext.release(), ciphertext_size, true);
+}
+
+bool ChaCha20Poly1305Encrypter::EncryptPacketInto(
+    QuicPacketSequenceNumber sequence_number,
+    StringPiece associated_data,
+    StringPiece plaintext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  size_t ciphertext_size = GetCiphertextSize(plaintext.length());
+  if (max_output_length < ciphertext_size) {
+    return false;
+  }
+
+  uint8 nonce[sizeof(sequence_number)];
+  COMPILE_ASSERT(sizeof(nonce) == kNonceSize, bad_sequence_number_size);
+  memcpy(nonce, &sequence_number, sizeof(sequence_number));
+  if (!Encrypt(StringPiece(reinterpret_cast<char*>(nonce), sizeof(nonce)),
+               associated_data, plaintext,
+               reinterpret_cast<unsigned char*>(output))) {
+    return false;
+  }
+  *output_length = ciphertext_size;
+  return true;
+}
+
+size_t ChaCha20Poly1305Encrypter::GetKeySize() const { return kKeySize; }
+
+size_t ChaCha20Poly1305Encrypter::GetNoncePrefixSize() const { return 0; }
+
+size_t ChaCha20Poly1305Encrypter::GetMaxPlaintextSize(
+    size_t ciphertext_size) const {
+  return ciphertext_size - kAuthTagSize;
+}
+
+// A ChaCha20-Poly1305 ciphertext is exactly 12 bytes longer than its
+// corresponding plaintext.
+size_t ChaCha20Poly1305Encrypter::GetCiphertextSize(
+    size_t plaintext_size) const {
+  return plaintext_size + kAuthTagSize;
+}
+
+StringPiece ChaCha20Poly1305Encrypter::GetKey() const {
+  return StringPiece(reinterpret_cast<const char*>(key_), sizeof(key_));
+}
+
+StringPiece ChaCha20Poly1305Encrypter::GetNoncePrefix() const {
+  return StringPiece();
+}
+
+}  // namespace net
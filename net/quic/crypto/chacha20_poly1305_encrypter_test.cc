@@ -0,0 +1,72 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/chacha20_poly1305_encrypter.h"
+
+#include "base/memory/scoped_ptr.h"
+#include "net/quic/crypto/chacha20_poly1305_decrypter.h"
+#include "net/quic/quic_protocol.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::StringPiece;
+using std::string;
+
+namespace net {
+namespace test {
+
+namespace {
+
+const char kKey[] = "0123456789abcdef0123456789abcdef";
+const char kAssociatedData[] = "associated data";
+const char kPlaintext[] = "a packet payload";
+
+}  // namespace
+
+TEST(ChaCha20Poly1305EncrypterTest, RoundTrip) {
+  if (!ChaCha20Poly1305Encrypter::IsSupported()) {
+    LOG(INFO) << "ChaCha20-Poly1305 not supported. Test skipped.";
+    return;
+  }
+
+  ChaCha20Poly1305Encrypter encrypter;
+  ASSERT_TRUE(encrypter.SetKey(StringPiece(kKey, 32)));
+  ASSERT_TRUE(encrypter.SetNoncePrefix(StringPiece()));
+  ChaCha20Poly1305Decrypter decrypter;
+  ASSERT_TRUE(decrypter.SetKey(StringPiece(kKey, 32)));
+  ASSERT_TRUE(decrypter.SetNoncePrefix(StringPiece()));
+
+  const QuicPacketSequenceNumber sequence_number = 42;
+  scoped_ptr<QuicData> ciphertext(encrypter.EncryptPacket(
+      sequence_number, kAssociatedData, kPlaintext));
+  ASSERT_TRUE(ciphertext.get());
+  EXPECT_EQ(encrypter.GetCiphertextSize(strlen(kPlaintext)),
+            ciphertext->length());
+
+  scoped_ptr<QuicData> plaintext(decrypter.DecryptPacket(
+      sequence_number, kAssociatedData, ciphertext->AsStringPiece()));
+  ASSERT_TRUE(plaintext.get());
+  EXPECT_EQ(kPlaintext, plaintext->AsStringPiece());
+
+  // The wrong sequence number, associated data or a modified ciphertext must
+  // fail authentication.
+  EXPECT_FALSE(decrypter.DecryptPacket(
+      sequence_number + 1, kAssociatedData, ciphertext->AsStringPiece()));
+  EXPECT_FALSE(decrypter.DecryptPacket(
+      sequence_number, "other data", ciphertext->AsStringPiece()));
+  string corrupt = ciphertext->AsStringPiece().as_string();
+  corrupt[0] ^= 0x80;
+  EXPECT_FALSE(decrypter.DecryptPacket(
+      sequence_number, kAssociatedData, corrupt));
+}
+
+TEST(ChaCha20Poly1305EncrypterTest, GetSizes) {
+  ChaCha20Poly1305Encrypter encrypter;
+  EXPECT_EQ(32u, encrypter.GetKeySize());
+  EXPECT_EQ(0u, encrypter.GetNoncePrefixSize());
+  EXPECT_EQ(1012u, encrypter.GetMaxPlaintextSize(1024));
+  EXPECT_EQ(1024u, encrypter.GetCiphertextSize(1012));
+}
+
+}  // namespace test
+}  // namespace net
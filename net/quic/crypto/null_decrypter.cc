@@ -7,8 +7,6 @@
 #include "net/quic/quic_data_reader.h"
 
 using base::StringPiece;
-using std::string;
-
 namespace net {
 
 NullDecrypter::NullDecrypter() {}
@@ -32,11 +30,7 @@ bool NullDecrypter::Decrypt(StringPiece /*nonce*/,
   }
 
   StringPiece plaintext = reader.ReadRemainingPayload();
-
-  // TODO(rch): avoid buffer copy here
-  string buffer = associated_data.as_string();
-  plaintext.AppendToString(&buffer);
-  if (hash != ComputeHash(buffer)) {
+  if (hash != ComputeHash(associated_data, plaintext)) {
     return false;
   }
   memcpy(output, plaintext.data(), plaintext.length());
@@ -57,17 +51,25 @@ QuicData* NullDecrypter::DecryptPacket(QuicPacketSequenceNumber /*seq_number*/,
   }
 
   StringPiece plaintext = reader.ReadRemainingPayload();
-
-  // TODO(rch): avoid buffer copy here
-  string buffer = associated_data.as_string();
-  plaintext.AppendToString(&buffer);
-
-  if (hash != ComputeHash(buffer)) {
+  if (hash != ComputeHash(associated_data, plaintext)) {
     return NULL;
   }
   return new QuicData(plaintext.data(), plaintext.length());
 }
 
+bool NullDecrypter::DecryptPacketInto(QuicPacketSequenceNumber /*seq_number*/,
+                                      StringPiece associated_data,
+                                      StringPiece ciphertext,
+                                      char* output,
+                                      size_t* output_length,
+                                      size_t max_output_length) {
+  if (max_output_length < ciphertext.length()) {
+    return false;
+  }
+  return Decrypt(StringPiece(), associated_data, ciphertext,
+                 reinterpret_cast<unsigned char*>(output), output_length);
+}
+
 StringPiece NullDecrypter::GetKey() const { return StringPiece(); }
 
 StringPiece NullDecrypter::GetNoncePrefix() const { return StringPiece(); }
@@ -85,8 +87,10 @@ bool NullDecrypter::ReadHash(QuicDataReader* reader, uint128* hash) {
   return true;
 }
 
-uint128 NullDecrypter::ComputeHash(const string& data) const {
-  uint128 correct_hash = QuicUtils::FNV1a_128_Hash(data.data(), data.length());
+uint128 NullDecrypter::ComputeHash(StringPiece data1,
+                                   StringPiece data2) const {
+  uint128 correct_hash = QuicUtils::FNV1a_128_Hash_Two(
+      data1.data(), data1.length(), data2.data(), data2.length());
   uint128 mask(GG_UINT64_C(0x0), GG_UINT64_C(0xffffffff));
   mask <<= 96;
   correct_hash &= ~mask;
@@ -32,12 +32,18 @@ class NET_EXPORT_PRIVATE NullDecrypter : public QuicDecrypter {
   virtual QuicData* DecryptPacket(QuicPacketSequenceNumber sequence_number,
                                   base::StringPiece associated_data,
                                   base::StringPiece ciphertext) OVERRIDE;
+  virtual bool DecryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 base::StringPiece associated_data,
+                                 base::StringPiece ciphertext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) OVERRIDE;
   virtual base::StringPiece GetKey() const OVERRIDE;
   virtual base::StringPiece GetNoncePrefix() const OVERRIDE;
 
  private:
   bool ReadHash(QuicDataReader* reader, uint128* hash);
-  uint128 ComputeHash(const std::string& data) const;
+  uint128 ComputeHash(base::StringPiece data1, base::StringPiece data2) const;
 };
 
 }  // namespace net
@@ -7,8 +7,6 @@
 #include "net/quic/quic_utils.h"
 
 using base::StringPiece;
-using std::string;
-
 namespace net {
 
 const size_t kHashSizeShort = 12;  // size of uint128 serialized short
@@ -26,9 +24,9 @@ bool NullEncrypter::Encrypt(
     StringPiece associated_data,
     StringPiece plaintext,
     unsigned char* output) {
-  string buffer = associated_data.as_string();
-  plaintext.AppendToString(&buffer);
-  uint128 hash = QuicUtils::FNV1a_128_Hash(buffer.data(), buffer.length());
+  uint128 hash = QuicUtils::FNV1a_128_Hash_Two(
+      associated_data.data(), associated_data.length(),
+      plaintext.data(), plaintext.length());
   QuicUtils::SerializeUint128Short(hash, output);
   memcpy(output + GetHashLength(), plaintext.data(), plaintext.size());
   return true;
@@ -44,6 +42,23 @@ QuicData* NullEncrypter::EncryptPacket(
   return new QuicData(reinterpret_cast<char*>(buffer), len, true);
 }
 
+bool NullEncrypter::EncryptPacketInto(
+    QuicPacketSequenceNumber /*sequence_number*/,
+    StringPiece associated_data,
+    StringPiece plaintext,
+    char* output,
+    size_t* output_length,
+    size_t max_output_length) {
+  const size_t len = plaintext.size() + GetHashLength();
+  if (max_output_length < len) {
+    return false;
+  }
+  Encrypt(StringPiece(), associated_data, plaintext,
+          reinterpret_cast<unsigned char*>(output));
+  *output_length = len;
+  return true;
+}
+
 size_t NullEncrypter::GetKeySize() const { return 0; }
 
 size_t NullEncrypter::GetNoncePrefixSize() const { return 0; }
@@ -4,8 +4,10 @@
 
 #include "net/quic/crypto/quic_crypto_client_config.h"
 
+#include "base/cpu.h"
 #include "base/stl_util.h"
 #include "net/quic/crypto/cert_compressor.h"
+#include "net/quic/crypto/chacha20_poly1305_encrypter.h"
 #include "net/quic/crypto/channel_id.h"
 #include "net/quic/crypto/common_cert_set.h"
 #include "net/quic/crypto/crypto_framer.h"
@@ -293,9 +295,17 @@ void QuicCryptoClientConfig::SetDefaults() {
   kexs[0] = kC255;
   kexs[1] = kP256;
 
-  // Authenticated encryption algorithms.
-  aead.resize(1);
-  aead[0] = kAESG;
+  // Authenticated encryption algorithms. ChaCha20-Poly1305 is much faster
+  // than AES-GCM in software, so prefer it when the CPU lacks AES
+  // instructions.
+  aead.clear();
+  bool has_chacha20 = ChaCha20Poly1305Encrypter::IsSupported();
+  bool prefer_chacha20 = has_chacha20 && !base::CPU().has_aesni();
+  if (prefer_chacha20)
+    aead.push_back(kCC12);
+  aead.push_back(kAESG);
+  if (has_chacha20 && !prefer_chacha20)
+    aead.push_back(kCC12);
 }
 
 QuicCryptoClientConfig::CachedState* QuicCryptoClientConfig::Create(
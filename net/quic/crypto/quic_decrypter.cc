@@ -5,6 +5,7 @@
 #include "net/quic/crypto/quic_decrypter.h"
 
 #include "net/quic/crypto/aes_128_gcm_12_decrypter.h"
+#include "net/quic/crypto/chacha20_poly1305_decrypter.h"
 #include "net/quic/crypto/null_decrypter.h"
 
 namespace net {
@@ -14,6 +15,8 @@ QuicDecrypter* QuicDecrypter::Create(QuicTag algorithm) {
   switch (algorithm) {
     case kAESG:
       return new Aes128Gcm12Decrypter();
+    case kCC12:
+      return new ChaCha20Poly1305Decrypter();
     case kNULL:
       return new NullDecrypter();
     default:
@@ -62,6 +62,17 @@ class NET_EXPORT_PRIVATE QuicDecrypter {
                                   base::StringPiece associated_data,
                                   base::StringPiece ciphertext) = 0;
 
+  // Like DecryptPacket(), but writes the plaintext to |output| instead of
+  // allocating it and sets |*output_length| to its length. Returns false
+  // if |max_output_length| is smaller than |ciphertext.length()| or if there
+  // is an error.
+  virtual bool DecryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 base::StringPiece associated_data,
+                                 base::StringPiece ciphertext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) = 0;
+
   // For use by unit tests only.
   virtual base::StringPiece GetKey() const = 0;
   virtual base::StringPiece GetNoncePrefix() const = 0;
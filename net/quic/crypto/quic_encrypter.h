@@ -58,6 +58,17 @@ class NET_EXPORT_PRIVATE QuicEncrypter {
                                   base::StringPiece associated_data,
                                   base::StringPiece plaintext) = 0;
 
+  // Like EncryptPacket(), but writes the ciphertext to |output| instead of
+  // allocating it and sets |*output_length| to its length. Returns false
+  // if |max_output_length| is smaller than
+  // |GetCiphertextSize(plaintext.size())| or if there is an error.
+  virtual bool EncryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 base::StringPiece associated_data,
+                                 base::StringPiece plaintext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) = 0;
+
   // GetKeySize() and GetNoncePrefixSize() tell the HKDF class how many bytes
   // of key material needs to be derived from the master secret.
   // NOTE: the sizes returned by GetKeySize() and GetNoncePrefixSize() are
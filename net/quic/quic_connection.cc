@@ -869,6 +869,7 @@ void QuicConnection::SendVersionNegotiationPacket() {
   }
 
   pending_version_negotiation_packet_ = false;
+  FlushPacketWriter();
 }
 
 QuicConsumedData QuicConnection::SendStreamData(
@@ -1167,8 +1168,25 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
   DCHECK_LE(sequence_number_of_last_sent_packet_, sequence_number);
   sequence_number_of_last_sent_packet_ = sequence_number;
 
-  QuicEncryptedPacket* encrypted = framer_.EncryptPacket(
-      packet.encryption_level, sequence_number, *packet.packet);
+  // Packets other than CONNECTION_CLOSE are only needed for the duration of
+  // this call, so those that fit are encrypted into a buffer on the stack.
+  char buffer[kMaxPacketSize];
+  size_t buffer_length = 0;
+  QuicEncryptedPacket* encrypted = NULL;
+  if (packet.type != CONNECTION_CLOSE &&
+      packet.packet->length() <=
+          framer_.GetMaxPlaintextSize(arraysize(buffer))) {
+    buffer_length = framer_.EncryptPacket(packet.encryption_level,
+                                          sequence_number, *packet.packet,
+                                          buffer, arraysize(buffer));
+  } else {
+    encrypted = framer_.EncryptPacket(
+        packet.encryption_level, sequence_number, *packet.packet);
+  }
+  QuicEncryptedPacket buffered(buffer, buffer_length);
+  if (buffer_length > 0) {
+    encrypted = &buffered;
+  }
   if (encrypted == NULL) {
     LOG(DFATAL) << ENDPOINT << "Failed to encrypt packet number "
                 << sequence_number;
@@ -1178,7 +1196,7 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
   }
 
   // Connection close packets are eventually owned by TimeWaitListManager.
-  // Others are deleted at the end of this call.
+  // Others encrypted onto the heap are deleted at the end of this call.
   scoped_ptr<QuicEncryptedPacket> encrypted_deleter;
   if (packet.type == CONNECTION_CLOSE) {
     DCHECK(connection_close_packet_.get() == NULL);
@@ -1189,7 +1207,7 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
       visitor_->OnWriteBlocked();
       return true;
     }
-  } else {
+  } else if (encrypted != &buffered) {
     encrypted_deleter.reset(encrypted);
   }
 
@@ -1242,10 +1260,30 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
     return false;
   }
 
-  if (OnPacketSent(result)) {
-    return true;
+  if (!OnPacketSent(result)) {
+    return false;
+  }
+  // Outside of batch mode nothing is going to follow this packet, so a writer
+  // which batches must not hold on to it.
+  if (!packet_generator_.InBatchMode()) {
+    FlushPacketWriter();
+  }
+  return true;
+}
+
+void QuicConnection::FlushPacketWriter() {
+  WriteResult result = writer_->Flush();
+  if (result.status == WRITE_STATUS_BLOCKED) {
+    // The writer keeps the packets it has accepted and resends them, but the
+    // visitor needs to know that nothing more can be written for now.
+    visitor_->OnWriteBlocked();
+    return;
+  }
+  if (result.status == WRITE_STATUS_ERROR && connected_) {
+    DVLOG(1) << "Flush failed with error code: " << result.error_code;
+    // We can't send an error as the socket is presumably borked.
+    CloseConnection(QUIC_PACKET_WRITE_ERROR, false);
   }
-  return false;
 }
 
 bool QuicConnection::ShouldDiscardPacket(
@@ -1723,6 +1761,8 @@ QuicConnection::ScopedPacketBundler::~ScopedPacketBundler() {
   if (!already_in_batch_mode_) {
     DVLOG(1) << "Leaving Batch Mode.";
     connection_->packet_generator_.FinishBatchOperations();
+    // Send everything the batch produced in as few writes as the writer can.
+    connection_->FlushPacketWriter();
   }
   DCHECK_EQ(already_in_batch_mode_,
             connection_->packet_generator_.InBatchMode());
@@ -503,6 +503,10 @@ class NET_EXPORT_PRIVATE QuicConnection
   // will not be consulted.
   bool WritePacket(QueuedPacket packet);
 
+  // Asks the writer to send any packets it is batching, and handles the
+  // writer becoming blocked or failing.
+  void FlushPacketWriter();
+
   // Make sure an ack we got from our peer is sane.
   bool ValidateAckFrame(const QuicAckFrame& incoming_ack);
 
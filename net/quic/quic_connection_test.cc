@@ -120,6 +120,22 @@ class TaggingEncrypter : public QuicEncrypter {
     return new QuicData(reinterpret_cast<char*>(buffer), len, true);
   }
 
+  virtual bool EncryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 StringPiece associated_data,
+                                 StringPiece plaintext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) OVERRIDE {
+    const size_t len = plaintext.size() + kTagSize;
+    if (max_output_length < len) {
+      return false;
+    }
+    Encrypt(StringPiece(), associated_data, plaintext,
+            reinterpret_cast<unsigned char*>(output));
+    *output_length = len;
+    return true;
+  }
+
   virtual size_t GetKeySize() const OVERRIDE { return 0; }
   virtual size_t GetNoncePrefixSize() const OVERRIDE { return 0; }
 
@@ -191,6 +207,19 @@ class TaggingDecrypter : public QuicDecrypter {
                         true /* owns buffer */);
   }
 
+  virtual bool DecryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 StringPiece associated_data,
+                                 StringPiece ciphertext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) OVERRIDE {
+    if (max_output_length < ciphertext.size()) {
+      return false;
+    }
+    return Decrypt(StringPiece(), associated_data, ciphertext,
+                   reinterpret_cast<unsigned char*>(output), output_length);
+  }
+
   virtual StringPiece GetKey() const OVERRIDE { return StringPiece(); }
   virtual StringPiece GetNoncePrefix() const OVERRIDE { return StringPiece(); }
 
@@ -316,6 +345,10 @@ class TestPacketWriter : public QuicPacketWriter {
     return WriteResult(WRITE_STATUS_OK, last_packet_size_);
   }
 
+  virtual WriteResult Flush() OVERRIDE {
+    return WriteResult(WRITE_STATUS_OK, 0);
+  }
+
   virtual bool IsWriteBlockedDataBuffered() const OVERRIDE {
     return is_write_blocked_data_buffered_;
   }
@@ -120,7 +120,7 @@ class NET_EXPORT_PRIVATE QuicDataReader {
   const char* data_;
 
   // The length of the data buffer that we're reading from.
-  const size_t len_;
+  size_t len_;
 
   // The location of the next read from our data buffer.
   size_t pos_;
@@ -48,6 +48,10 @@ WriteResult QuicDefaultPacketWriter::WritePacket(
   return WriteResult(status, rv);
 }
 
+WriteResult QuicDefaultPacketWriter::Flush() {
+  return WriteResult(WRITE_STATUS_OK, 0);
+}
+
 bool QuicDefaultPacketWriter::IsWriteBlockedDataBuffered() const {
   // Chrome sockets' Write() methods buffer the data until the Write is
   // permitted.
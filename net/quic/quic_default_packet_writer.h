@@ -30,6 +30,7 @@ class NET_EXPORT_PRIVATE QuicDefaultPacketWriter : public QuicPacketWriter {
       const char* buffer, size_t buf_len,
       const net::IPAddressNumber& self_address,
       const net::IPEndPoint& peer_address) OVERRIDE;
+  virtual WriteResult Flush() OVERRIDE;
   virtual bool IsWriteBlockedDataBuffered() const OVERRIDE;
   virtual bool IsWriteBlocked() const OVERRIDE;
   virtual void SetWritable() OVERRIDE;
@@ -158,7 +158,9 @@ bool QuicFramerVisitorInterface::OnBlockedFrame(const QuicBlockedFrame& frame) {
 QuicFramer::QuicFramer(const QuicVersionVector& supported_versions,
                        QuicTime creation_time,
                        bool is_server)
-    : visitor_(NULL),
+    : reader_(NULL),
+      decrypted_reader_(NULL, 0),
+      visitor_(NULL),
       fec_builder_(NULL),
       entropy_calculator_(NULL),
       error_(QUIC_NO_ERROR),
@@ -547,8 +549,9 @@ QuicEncryptedPacket* QuicFramer::BuildVersionNegotiationPacket(
 }
 
 bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
-  DCHECK(!reader_.get());
-  reader_.reset(new QuicDataReader(packet.data(), packet.length()));
+  DCHECK(!reader_);
+  QuicDataReader reader(packet.data(), packet.length());
+  reader_ = &reader;
 
   visitor_->OnPacket();
 
@@ -562,14 +565,14 @@ bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
 
   if (!visitor_->OnUnauthenticatedPublicHeader(public_header)) {
     // The visitor suppresses further processing of the packet.
-    reader_.reset(NULL);
+    reader_ = NULL;
     return true;
   }
 
   if (is_server_ && public_header.version_flag &&
       public_header.versions[0] != quic_version_) {
     if (!visitor_->OnProtocolVersionMismatch(public_header.versions[0])) {
-      reader_.reset(NULL);
+      reader_ = NULL;
       return true;
     }
   }
@@ -583,7 +586,7 @@ bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
     rv = ProcessDataPacket(public_header, packet);
   }
 
-  reader_.reset(NULL);
+  reader_ = NULL;
   return rv;
 }
 
@@ -705,7 +708,7 @@ bool QuicFramer::ProcessPublicResetPacket(
 
 bool QuicFramer::ProcessRevivedPacket(QuicPacketHeader* header,
                                       StringPiece payload) {
-  DCHECK(!reader_.get());
+  DCHECK(!reader_);
 
   visitor_->OnRevivedPacket();
 
@@ -720,7 +723,8 @@ bool QuicFramer::ProcessRevivedPacket(QuicPacketHeader* header,
     return RaiseError(QUIC_PACKET_TOO_LARGE);
   }
 
-  reader_.reset(new QuicDataReader(payload.data(), payload.length()));
+  QuicDataReader reader(payload.data(), payload.length());
+  reader_ = &reader;
   if (!ProcessFrameData(*header)) {
     DCHECK_NE(QUIC_NO_ERROR, error_);  // ProcessFrameData sets the error.
     DLOG(WARNING) << "Unable to process frame data.";
@@ -728,7 +732,7 @@ bool QuicFramer::ProcessRevivedPacket(QuicPacketHeader* header,
   }
 
   visitor_->OnPacketComplete();
-  reader_.reset(NULL);
+  reader_ = NULL;
   return true;
 }
 
@@ -1097,11 +1101,10 @@ bool QuicFramer::ProcessFrameData(const QuicPacketHeader& header) {
     if (frame_type & kQuicFrameTypeSpecialMask) {
       // Stream Frame
       if (frame_type & kQuicFrameTypeStreamMask) {
-        QuicStreamFrame frame;
-        if (!ProcessStreamFrame(frame_type, &frame)) {
+        if (!ProcessStreamFrame(frame_type, &stream_frame_)) {
           return RaiseError(QUIC_INVALID_STREAM_DATA);
         }
-        if (!visitor_->OnStreamFrame(frame)) {
+        if (!visitor_->OnStreamFrame(stream_frame_)) {
           DVLOG(1) << "Visitor asked to stop further processing.";
           // Returning true since there was no parsing error.
           return true;
@@ -1718,12 +1721,35 @@ QuicEncryptedPacket* QuicFramer::EncryptPacket(
   StringPiece header_data = packet.BeforePlaintext();
   size_t len =  header_data.length() + out->length();
   char* buffer = new char[len];
-  // TODO(rch): eliminate this buffer copy by passing in a buffer to Encrypt().
   memcpy(buffer, header_data.data(), header_data.length());
   memcpy(buffer + header_data.length(), out->data(), out->length());
   return new QuicEncryptedPacket(buffer, len, true);
 }
 
+size_t QuicFramer::EncryptPacket(EncryptionLevel level,
+                                 QuicPacketSequenceNumber packet_sequence_number,
+                                 const QuicPacket& packet,
+                                 char* buffer,
+                                 size_t buffer_len) {
+  DCHECK(encrypter_[level].get() != NULL);
+
+  StringPiece header_data = packet.BeforePlaintext();
+  if (header_data.length() > buffer_len) {
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+  memcpy(buffer, header_data.data(), header_data.length());
+  size_t output_length = 0;
+  if (!encrypter_[level]->EncryptPacketInto(
+          packet_sequence_number, packet.AssociatedData(), packet.Plaintext(),
+          buffer + header_data.length(), &output_length,
+          buffer_len - header_data.length())) {
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+  return header_data.length() + output_length;
+}
+
 size_t QuicFramer::GetMaxPlaintextSize(size_t ciphertext_size) {
   // In order to keep the code simple, we don't have the current encryption
   // level to hand. Both the NullEncrypter and AES-GCM have a tag length of 12.
@@ -1748,24 +1774,19 @@ bool QuicFramer::DecryptPayload(const QuicPacketHeader& header,
     return false;
   }
   DCHECK(decrypter_.get() != NULL);
-  decrypted_.reset(decrypter_->DecryptPacket(
-      header.packet_sequence_number,
-      GetAssociatedDataFromEncryptedPacket(
-          packet,
-          header.public_header.guid_length,
-          header.public_header.version_flag,
-          header.public_header.sequence_number_length),
-      encrypted));
-  if  (decrypted_.get() == NULL && alternative_decrypter_.get() != NULL) {
-    decrypted_.reset(alternative_decrypter_->DecryptPacket(
-        header.packet_sequence_number,
-        GetAssociatedDataFromEncryptedPacket(
-            packet,
-            header.public_header.guid_length,
-            header.public_header.version_flag,
-            header.public_header.sequence_number_length),
-        encrypted));
-    if (decrypted_.get() != NULL) {
+  const StringPiece associated_data = GetAssociatedDataFromEncryptedPacket(
+      packet,
+      header.public_header.guid_length,
+      header.public_header.version_flag,
+      header.public_header.sequence_number_length);
+  StringPiece decrypted;
+  bool success = DecryptWith(decrypter_.get(), header.packet_sequence_number,
+                             associated_data, encrypted, &decrypted);
+  if (!success && alternative_decrypter_.get() != NULL) {
+    success = DecryptWith(alternative_decrypter_.get(),
+                          header.packet_sequence_number, associated_data,
+                          encrypted, &decrypted);
+    if (success) {
       if (alternative_decrypter_latch_) {
         // Switch to the alternative decrypter and latch so that we cannot
         // switch back.
@@ -1777,11 +1798,40 @@ bool QuicFramer::DecryptPayload(const QuicPacketHeader& header,
     }
   }
 
-  if  (decrypted_.get() == NULL) {
+  if (!success) {
     return false;
   }
 
-  reader_.reset(new QuicDataReader(decrypted_->data(), decrypted_->length()));
+  decrypted_reader_ = QuicDataReader(decrypted.data(), decrypted.length());
+  reader_ = &decrypted_reader_;
+  return true;
+}
+
+bool QuicFramer::DecryptWith(QuicDecrypter* decrypter,
+                             QuicPacketSequenceNumber sequence_number,
+                             StringPiece associated_data,
+                             StringPiece encrypted,
+                             StringPiece* decrypted) {
+  if (encrypted.length() > arraysize(decrypted_buffer_)) {
+    // Oversized packets are rejected after the header has been processed, so
+    // they still need to be decrypted somewhere.
+    decrypted_.reset(decrypter->DecryptPacket(sequence_number,
+                                              associated_data, encrypted));
+    if (decrypted_.get() == NULL) {
+      return false;
+    }
+    *decrypted = StringPiece(decrypted_->data(), decrypted_->length());
+    return true;
+  }
+
+  size_t decrypted_length = 0;
+  if (!decrypter->DecryptPacketInto(sequence_number, associated_data,
+                                    encrypted, decrypted_buffer_,
+                                    &decrypted_length,
+                                    arraysize(decrypted_buffer_))) {
+    return false;
+  }
+  *decrypted = StringPiece(decrypted_buffer_, decrypted_length);
   return true;
 }
 
@@ -2333,7 +2383,7 @@ bool QuicFramer::RaiseError(QuicErrorCode error) {
   DVLOG(1) << "Error detail: " << detailed_error_;
   set_error(error);
   visitor_->OnError(this);
-  reader_.reset(NULL);
+  reader_ = NULL;
   return false;
 }
 
@@ -12,6 +12,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
+#include "net/quic/quic_data_reader.h"
 #include "net/quic/quic_protocol.h"
 
 namespace net {
@@ -20,7 +21,6 @@ namespace test {
 class QuicFramerPeer;
 }  // namespace test
 
-class QuicDataReader;
 class QuicDataWriter;
 class QuicDecrypter;
 class QuicEncrypter;
@@ -347,6 +347,15 @@ class NET_EXPORT_PRIVATE QuicFramer {
                                      QuicPacketSequenceNumber sequence_number,
                                      const QuicPacket& packet);
 
+  // Encrypts |packet| into |buffer| without allocating. Returns the length
+  // of the encrypted packet, or 0 if it does not fit in |buffer_len| bytes or
+  // encryption fails.
+  size_t EncryptPacket(EncryptionLevel level,
+                       QuicPacketSequenceNumber sequence_number,
+                       const QuicPacket& packet,
+                       char* buffer,
+                       size_t buffer_len);
+
   // Returns the maximum length of plaintext that can be encrypted
   // to ciphertext no larger than |ciphertext_size|.
   size_t GetMaxPlaintextSize(size_t ciphertext_size);
@@ -414,6 +423,15 @@ class NET_EXPORT_PRIVATE QuicFramer {
   bool DecryptPayload(const QuicPacketHeader& header,
                       const QuicEncryptedPacket& packet);
 
+  // Decrypts |encrypted| with |decrypter| into |decrypted_buffer_|, or into
+  // |decrypted_| if it is too large for the buffer, and points |decrypted|
+  // at the plaintext.
+  bool DecryptWith(QuicDecrypter* decrypter,
+                   QuicPacketSequenceNumber sequence_number,
+                   base::StringPiece associated_data,
+                   base::StringPiece encrypted,
+                   base::StringPiece* decrypted);
+
   // Returns the full packet sequence number from the truncated
   // wire format version and the last seen packet sequence number.
   QuicPacketSequenceNumber CalculatePacketSequenceNumberFromWire(
@@ -476,7 +494,12 @@ class NET_EXPORT_PRIVATE QuicFramer {
   }
 
   std::string detailed_error_;
-  scoped_ptr<QuicDataReader> reader_;
+  // Reader for the packet being processed. Not owned; it points either at a
+  // reader on the stack of ProcessPacket() or ProcessRevivedPacket(), or at
+  // |decrypted_reader_|, and is NULL between packets.
+  QuicDataReader* reader_;
+  // Reader over the decrypted payload of the packet being processed.
+  QuicDataReader decrypted_reader_;
   QuicFramerVisitorInterface* visitor_;
   QuicFecBuilderInterface* fec_builder_;
   QuicReceivedEntropyHashCalculatorInterface* entropy_calculator_;
@@ -485,8 +508,14 @@ class NET_EXPORT_PRIVATE QuicFramer {
   QuicPacketSequenceNumber last_sequence_number_;
   // Updated by WritePacketHeader.
   QuicGuid last_serialized_guid_;
-  // Buffer containing decrypted payload data during parsing.
+  // Buffer containing decrypted payload data during parsing. Stream frames
+  // handed to the visitor point into it, so it is reused for every packet.
+  char decrypted_buffer_[kMaxPacketSize];
+  // Heap buffer for decrypted payloads too large for |decrypted_buffer_|.
   scoped_ptr<QuicData> decrypted_;
+  // Stream frame filled in while parsing, reused so that its IOVector keeps
+  // its storage across packets.
+  QuicStreamFrame stream_frame_;
   // Version of the protocol being used.
   QuicVersion quic_version_;
   // This vector contains QUIC versions which we currently support.
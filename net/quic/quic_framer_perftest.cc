@@ -0,0 +1,126 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Measures how many full sized data packets a single core can build and
+// encrypt, and decrypt and parse, with the NULL encrypter.
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/stl_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/time/time.h"
+#include "net/quic/quic_framer.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace net {
+namespace test {
+namespace {
+
+const int kNumPackets = 200000;
+// Distinct packets parsed in turn, so that parsing sees varying data.
+const size_t kNumDistinctPackets = 64;
+const QuicGuid kGuid = GG_UINT64_C(0xFEDCBA9876543210);
+const QuicStreamId kStreamId = 5;
+
+QuicPacketHeader MakeHeader(QuicPacketSequenceNumber sequence_number) {
+  QuicPacketHeader header;
+  header.public_header.guid = kGuid;
+  header.public_header.guid_length = PACKET_8BYTE_GUID;
+  header.public_header.reset_flag = false;
+  header.public_header.version_flag = false;
+  header.public_header.sequence_number_length = PACKET_6BYTE_SEQUENCE_NUMBER;
+  header.fec_flag = false;
+  header.entropy_flag = false;
+  header.packet_sequence_number = sequence_number;
+  header.is_in_fec_group = NOT_IN_FEC_GROUP;
+  header.fec_group = 0;
+  return header;
+}
+
+void ReportResult(const std::string& trace, int packets,
+                  base::TimeDelta elapsed) {
+  perf_test::PrintResult("quic_framer_packets_per_second", "", trace,
+                         packets / elapsed.InSecondsF(), "packets/s", true);
+}
+
+class QuicFramerPerfTest : public ::testing::Test {
+ protected:
+  QuicFramerPerfTest()
+      : framer_(QuicSupportedVersions(), QuicTime::Zero(), false),
+        data_(kMaxPacketSize, 'x') {
+    // Fill the packet with as much stream data as fits.
+    const size_t max_data = framer_.GetMaxPlaintextSize(kMaxPacketSize) -
+        GetPacketHeaderSize(PACKET_8BYTE_GUID, false,
+                            PACKET_6BYTE_SEQUENCE_NUMBER, NOT_IN_FEC_GROUP) -
+        QuicFramer::GetMinStreamFrameSize(framer_.version(), kStreamId, 0,
+                                          true);
+    data_.resize(max_data);
+    stream_frame_.stream_id = kStreamId;
+    stream_frame_.fin = false;
+    stream_frame_.offset = 0;
+    stream_frame_.data.Append(const_cast<char*>(data_.data()), data_.size());
+    frames_.push_back(QuicFrame(&stream_frame_));
+  }
+
+  QuicFramer framer_;
+  std::string data_;
+  QuicStreamFrame stream_frame_;
+  QuicFrames frames_;
+};
+
+TEST_F(QuicFramerPerfTest, BuildAndEncrypt) {
+  char buffer[kMaxPacketSize];
+  size_t total_length = 0;
+  base::PerfTimeLogger timer(base::StringPrintf(
+      "Build and encrypt %d packets", kNumPackets).c_str());
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 1; i <= kNumPackets; ++i) {
+    QuicPacketHeader header = MakeHeader(i);
+    scoped_ptr<QuicPacket> packet(
+        framer_.BuildUnsizedDataPacket(header, frames_).packet);
+    ASSERT_TRUE(packet.get() != NULL);
+    size_t length = framer_.EncryptPacket(
+        ENCRYPTION_NONE, i, *packet, buffer, arraysize(buffer));
+    ASSERT_NE(0u, length);
+    total_length += length;
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  timer.Done();
+  EXPECT_EQ(kNumPackets * kMaxPacketSize, total_length);
+  ReportResult("build_and_encrypt", kNumPackets, elapsed);
+}
+
+TEST_F(QuicFramerPerfTest, DecryptAndParse) {
+  std::vector<QuicEncryptedPacket*> packets;
+  for (size_t i = 1; i <= kNumDistinctPackets; ++i) {
+    scoped_ptr<QuicPacket> packet(
+        framer_.BuildUnsizedDataPacket(MakeHeader(i), frames_).packet);
+    packets.push_back(framer_.EncryptPacket(ENCRYPTION_NONE, i, *packet));
+  }
+
+  QuicFramer server_framer(QuicSupportedVersions(), QuicTime::Zero(), true);
+  NoOpFramerVisitor visitor;
+  server_framer.set_visitor(&visitor);
+  base::PerfTimeLogger timer(base::StringPrintf(
+      "Decrypt and parse %d packets", kNumPackets).c_str());
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kNumPackets; ++i) {
+    ASSERT_TRUE(server_framer.ProcessPacket(
+        *packets[i % kNumDistinctPackets]));
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  timer.Done();
+  ReportResult("decrypt_and_parse", kNumPackets, elapsed);
+  STLDeleteElements(&packets);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -134,6 +134,22 @@ class TestEncrypter : public QuicEncrypter {
     plaintext_ = plaintext.as_string();
     return new QuicData(plaintext.data(), plaintext.length());
   }
+  virtual bool EncryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 StringPiece associated_data,
+                                 StringPiece plaintext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) OVERRIDE {
+    if (max_output_length < plaintext.length()) {
+      return false;
+    }
+    sequence_number_ = sequence_number;
+    associated_data_ = associated_data.as_string();
+    plaintext_ = plaintext.as_string();
+    memcpy(output, plaintext.data(), plaintext.length());
+    *output_length = plaintext.length();
+    return true;
+  }
   virtual size_t GetKeySize() const OVERRIDE {
     return 0;
   }
@@ -182,6 +198,22 @@ class TestDecrypter : public QuicDecrypter {
     ciphertext_ = ciphertext.as_string();
     return new QuicData(ciphertext.data(), ciphertext.length());
   }
+  virtual bool DecryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                 StringPiece associated_data,
+                                 StringPiece ciphertext,
+                                 char* output,
+                                 size_t* output_length,
+                                 size_t max_output_length) OVERRIDE {
+    if (max_output_length < ciphertext.length()) {
+      return false;
+    }
+    sequence_number_ = sequence_number;
+    associated_data_ = associated_data.as_string();
+    ciphertext_ = ciphertext.as_string();
+    memcpy(output, ciphertext.data(), ciphertext.length());
+    *output_length = ciphertext.length();
+    return true;
+  }
   virtual StringPiece GetKey() const OVERRIDE {
     return StringPiece();
   }
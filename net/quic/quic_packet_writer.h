@@ -28,6 +28,13 @@ class NET_EXPORT_PRIVATE QuicPacketWriter {
       const IPAddressNumber& self_address,
       const IPEndPoint& peer_address) = 0;
 
+  // Sends any packets the writer is holding back from earlier WritePacket
+  // calls so that they can go out in one batch. Packets accepted by
+  // WritePacket are owned by the writer, so a WRITE_STATUS_BLOCKED result
+  // means the writer keeps them and resends them once it is writable again.
+  // Writers which do not batch return WRITE_STATUS_OK with no bytes written.
+  virtual WriteResult Flush() = 0;
+
   // Returns true if the writer buffers and subsequently rewrites data
   // when an attempt to write results in the underlying socket becoming
   // write blocked.
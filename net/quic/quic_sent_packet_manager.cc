@@ -6,6 +6,7 @@
 
 #include "base/logging.h"
 #include "base/stl_util.h"
+#include "net/quic/congestion_control/bbr_sender.h"
 #include "net/quic/congestion_control/pacing_sender.h"
 #include "net/quic/crypto/crypto_protocol.h"
 #include "net/quic/quic_ack_notifier_manager.h"
@@ -31,6 +32,11 @@ bool FLAGS_track_retransmission_history = false;
 // request pacing for the server to enable it.
 bool FLAGS_enable_quic_pacing = false;
 
+// If true, QUIC connections will offer the model based BbrSender, which paces
+// to its own estimate of the bottleneck bandwidth and ignores random loss.
+// Both ends must set it for it to be used.
+bool FLAGS_enable_quic_bbr = false;
+
 namespace net {
 namespace {
 static const int kDefaultRetransmissionTimeMs = 500;
@@ -99,6 +105,13 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
   }
   if (config.congestion_control() == kPACE) {
     MaybeEnablePacing();
+  } else if (config.congestion_control() == kTBBR) {
+    // The handshake packets still in flight are unknown to the new sender,
+    // which ignores their acks. It paces itself.
+    send_algorithm_.reset(new BbrSender(clock_));
+    if (!rtt_sample_.IsInfinite()) {
+      send_algorithm_->UpdateRtt(rtt_sample_);
+    }
   }
   send_algorithm_->SetFromConfig(config, is_server_);
 }
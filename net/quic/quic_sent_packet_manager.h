@@ -23,6 +23,7 @@
 
 NET_EXPORT_PRIVATE extern bool FLAGS_track_retransmission_history;
 NET_EXPORT_PRIVATE extern bool FLAGS_enable_quic_pacing;
+NET_EXPORT_PRIVATE extern bool FLAGS_enable_quic_bbr;
 
 namespace net {
 
@@ -39,6 +39,14 @@ uint64 QuicUtils::FNV1a_64_Hash(const char* data, int len) {
 
 // static
 uint128 QuicUtils::FNV1a_128_Hash(const char* data, int len) {
+  return FNV1a_128_Hash_Two(data, len, NULL, 0);
+}
+
+// static
+uint128 QuicUtils::FNV1a_128_Hash_Two(const char* data1,
+                                      int len1,
+                                      const char* data2,
+                                      int len2) {
   // The following two constants are defined as part of the hash algorithm.
   // see http://www.isthe.com/chongo/tech/comp/fnv/
   // 309485009821345068724781371
@@ -47,11 +55,16 @@ uint128 QuicUtils::FNV1a_128_Hash(const char* data, int len) {
   const uint128 kOffset(GG_UINT64_C(7809847782465536322),
                         GG_UINT64_C(7113472399480571277));
 
-  const uint8* octets = reinterpret_cast<const uint8*>(data);
-
   uint128 hash = kOffset;
 
-  for (int i = 0; i < len; ++i) {
+  const uint8* octets = reinterpret_cast<const uint8*>(data1);
+  for (int i = 0; i < len1; ++i) {
+    hash  = hash ^ uint128(0, octets[i]);
+    hash = hash * kPrime;
+  }
+
+  octets = reinterpret_cast<const uint8*>(data2);
+  for (int i = 0; i < len2; ++i) {
     hash  = hash ^ uint128(0, octets[i]);
     hash = hash * kPrime;
   }
@@ -28,6 +28,13 @@ class NET_EXPORT_PRIVATE QuicUtils {
   // http://www.isthe.com/chongo/tech/comp/fnv/index.html#FNV-param
   static uint128 FNV1a_128_Hash(const char* data, int len);
 
+  // Returns the 128 bit FNV1a hash of |data1| followed by |data2|, without
+  // concatenating them first.
+  static uint128 FNV1a_128_Hash_Two(const char* data1,
+                                    int len1,
+                                    const char* data2,
+                                    int len2);
+
   // FindMutualTag sets |out_result| to the first tag in the priority list that
   // is also in the other list and returns true. If there is no intersection it
   // returns false.
@@ -349,6 +349,8 @@ QuicCryptoStream* TestSession::GetCryptoStream() {
 }
 
 MockPacketWriter::MockPacketWriter() {
+  ON_CALL(*this, Flush())
+      .WillByDefault(testing::Return(WriteResult(WRITE_STATUS_OK, 0)));
 }
 
 MockPacketWriter::~MockPacketWriter() {
@@ -394,6 +394,7 @@ class MockPacketWriter : public QuicPacketWriter {
                            size_t buf_len,
                            const IPAddressNumber& self_address,
                            const IPEndPoint& peer_address));
+  MOCK_METHOD0(Flush, WriteResult());
   MOCK_CONST_METHOD0(IsWriteBlockedDataBuffered, bool());
   MOCK_CONST_METHOD0(IsWriteBlocked, bool());
   MOCK_METHOD0(SetWritable, void());
@@ -109,6 +109,7 @@
 #include "net/ssl/ssl_cert_request_info.h"
 #include "net/ssl/ssl_connection_status_flags.h"
 #include "net/ssl/ssl_info.h"
+#include "net/ssl/ssl_session_cache.h"
 
 #if defined(OS_WIN)
 #include <windows.h>
@@ -2803,6 +2804,8 @@ SSLClientSocketNSS::~SSLClientSocketNSS() {
 
 // static
 void SSLClientSocket::ClearSessionCache() {
+  SSLSessionCache::GetInstance()->Clear();
+
   // SSL_ClearSessionCache can't be called before NSS is initialized.  Don't
   // bother initializing NSS just to clear an empty SSL session cache.
   if (!NSS_IsInitialized())
@@ -3258,14 +3261,12 @@ int SSLClientSocketNSS::InitializeSSLPeerName() {
   // Set the peer ID for session reuse.  This is necessary when we create an
   // SSL tunnel through a proxy -- GetPeerName returns the proxy's address
   // rather than the destination server's address in that case.
-  std::string peer_id = host_and_port_.ToString();
-  // If the ssl_session_cache_shard_ is non-empty, we append it to the peer id.
-  // This will cause session cache misses between sockets with different values
-  // of ssl_session_cache_shard_ and this is used to partition the session cache
-  // for incognito mode.
-  if (!ssl_session_cache_shard_.empty()) {
-    peer_id += "/" + ssl_session_cache_shard_;
-  }
+  // The peer ID is the key the OpenSSL implementation uses too, so it includes
+  // ssl_session_cache_shard_. This will cause session cache misses between
+  // sockets with different values of ssl_session_cache_shard_ and this is used
+  // to partition the session cache for incognito mode.
+  std::string peer_id = SSLSessionCache::GetKey(
+      host_and_port_, ssl_config_, ssl_session_cache_shard_);
   SECStatus rv = SSL_SetSockPeerID(nss_fd_, const_cast<char*>(peer_id.c_str()));
   if (rv != SECSuccess)
     LogFailedNSSFunction(net_log_, "SSL_SetSockPeerID", peer_id.c_str());
@@ -29,6 +29,7 @@
 #include "net/ssl/ssl_cert_request_info.h"
 #include "net/ssl/ssl_connection_status_flags.h"
 #include "net/ssl/ssl_info.h"
+#include "net/ssl/ssl_session_cache.h"
 
 namespace net {
 
@@ -235,12 +236,55 @@ struct SslSetClearMask {
 // Compute a unique key string for the SSL session cache. |socket| is an
 // input socket object. Return a string.
 std::string GetSocketSessionCacheKey(const SSLClientSocketOpenSSL& socket) {
-  std::string result = socket.host_and_port().ToString();
-  result.append("/");
-  result.append(socket.ssl_session_cache_shard());
+  return SSLSessionCache::GetKey(socket.host_and_port(), socket.ssl_config(),
+                                 socket.ssl_session_cache_shard());
+}
+
+// Associates the session for |cache_key| in the shared SSLSessionCache with
+// |ssl|. The in-memory cache of SSL_SESSIONs doesn't survive restarts, but the
+// shared cache may be persisted by the embedder. Returns true iff a session
+// was associated with |ssl|.
+bool SetSSLSessionFromSharedCache(SSL* ssl, const std::string& cache_key) {
+  SSLSessionCache* shared_cache = SSLSessionCache::GetInstance();
+  std::string der;
+  if (!shared_cache->Lookup(cache_key, base::Time::Now(), &der))
+    return false;
+
+  const unsigned char* der_data =
+      reinterpret_cast<const unsigned char*>(der.data());
+  SSL_SESSION* session = d2i_SSL_SESSION(NULL, &der_data, der.size());
+  if (!session) {
+    shared_cache->Remove(cache_key);
+    return false;
+  }
+  bool result = SSL_set_session(ssl, session) == 1;
+  SSL_SESSION_free(session);
   return result;
 }
 
+// Stores the session of |ssl|, which has been validated, in the shared
+// SSLSessionCache under |cache_key|.
+void StoreSSLSessionInSharedCache(SSL* ssl, const std::string& cache_key) {
+  SSL_SESSION* session = SSL_get_session(ssl);
+  if (!session)
+    return;
+
+  int der_length = i2d_SSL_SESSION(session, NULL);
+  if (der_length <= 0)
+    return;
+  std::string der(der_length, '\0');
+  unsigned char* der_data = reinterpret_cast<unsigned char*>(&der[0]);
+  if (i2d_SSL_SESSION(session, &der_data) != der_length)
+    return;
+
+  base::Time creation_time =
+      base::Time::FromTimeT(SSL_SESSION_get_time(session));
+  SSLSessionCache::GetInstance()->Insert(
+      cache_key, der, base::Time::Now(),
+      creation_time +
+          base::TimeDelta::FromSeconds(SSL_SESSION_get_timeout(session)));
+}
+
 }  // namespace
 
 class SSLClientSocketOpenSSL::SSLContext {
@@ -333,6 +377,7 @@ void SSLClientSocket::ClearSessionCache() {
   SSLClientSocketOpenSSL::SSLContext* context =
       SSLClientSocketOpenSSL::SSLContext::GetInstance();
   context->session_cache()->Flush();
+  SSLSessionCache::GetInstance()->Clear();
   OpenSSLClientKeyStore::GetInstance()->Flush();
 }
 
@@ -659,8 +704,10 @@ bool SSLClientSocketOpenSSL::Init() {
   if (!SSL_set_tlsext_host_name(ssl_, host_and_port_.host().c_str()))
     return false;
 
-  trying_cached_session_ = context->session_cache()->SetSSLSessionWithKey(
-      ssl_, GetSocketSessionCacheKey(*this));
+  const std::string cache_key = GetSocketSessionCacheKey(*this);
+  trying_cached_session_ =
+      context->session_cache()->SetSSLSessionWithKey(ssl_, cache_key) ||
+      SetSSLSessionFromSharedCache(ssl_, cache_key);
 
   BIO* ssl_bio = NULL;
   // 0 => use default buffer sizes.
@@ -897,6 +944,9 @@ int SSLClientSocketOpenSSL::DoVerifyCertComplete(int result) {
     // TODO(joth): Work out if we need to remember the intermediate CA certs
     // when the server sends them to us, and do so here.
     SSLContext::GetInstance()->session_cache()->MarkSSLSessionAsGood(ssl_);
+    // A resumed session is already in the shared cache.
+    if (!SSL_session_reused(ssl_))
+      StoreSSLSessionInSharedCache(ssl_, GetSocketSessionCacheKey(*this));
   } else {
     DVLOG(1) << "DoVerifyCertComplete error " << ErrorToString(result)
              << " (" << result << ")";
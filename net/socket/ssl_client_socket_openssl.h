@@ -52,6 +52,7 @@ class SSLClientSocketOpenSSL : public SSLClientSocket {
   const std::string& ssl_session_cache_shard() const {
     return ssl_session_cache_shard_;
   }
+  const SSLConfig& ssl_config() const { return ssl_config_; }
 
   // SSLClientSocket implementation.
   virtual void GetSSLCertRequestInfo(
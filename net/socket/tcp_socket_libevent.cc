@@ -11,11 +11,15 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 
+#include <set>
+
 #include "base/callback_helpers.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
 #include "base/metrics/stats_counters.h"
 #include "base/posix/eintr_wrapper.h"
+#include "base/synchronization/lock.h"
 #include "build/build_config.h"
 #include "net/base/address_list.h"
 #include "net/base/connection_type_histograms.h"
@@ -86,6 +90,38 @@ int MapAcceptError(int os_error) {
   }
 }
 
+// Destinations where a TCP FastOpen connection failed before any data came
+// back. Middleboxes that drop SYNs carrying data or the FastOpen option make
+// every FastOpen attempt to such a host stall until it times out, so
+// connections to them fall back to a regular connect().
+class FastOpenBlacklist {
+ public:
+  FastOpenBlacklist() {}
+
+  bool Contains(const IPAddressNumber& address) {
+    base::AutoLock lock(lock_);
+    return addresses_.count(address) > 0;
+  }
+
+  void Add(const IPAddressNumber& address) {
+    base::AutoLock lock(lock_);
+    if (addresses_.size() < kMaxEntries)
+      addresses_.insert(address);
+  }
+
+ private:
+  // Bounds memory use; FastOpen simply stays on for peers past the limit.
+  static const size_t kMaxEntries = 256;
+
+  base::Lock lock_;
+  std::set<IPAddressNumber> addresses_;
+
+  DISALLOW_COPY_AND_ASSIGN(FastOpenBlacklist);
+};
+
+base::LazyInstance<FastOpenBlacklist>::Leaky g_fast_open_blacklist =
+    LAZY_INSTANCE_INITIALIZER;
+
 int MapConnectError(int os_error) {
   switch (os_error) {
     case EACCES:
@@ -153,6 +189,7 @@ TCPSocketLibevent::TCPSocketLibevent(NetLog* net_log,
       write_buf_len_(0),
       use_tcp_fastopen_(IsTCPFastOpenEnabled()),
       tcp_fastopen_connected_(false),
+      tcp_fastopen_data_received_(false),
       fast_open_status_(FAST_OPEN_STATUS_UNKNOWN),
       waiting_connect_(false),
       connect_os_error_(0),
@@ -289,6 +326,11 @@ int TCPSocketLibevent::Connect(const IPEndPoint& address,
 
   peer_address_.reset(new IPEndPoint(address));
 
+  if (use_tcp_fastopen_ &&
+      g_fast_open_blacklist.Get().Contains(address.address())) {
+    use_tcp_fastopen_ = false;
+  }
+
   int rv = DoConnect();
   if (rv == ERR_IO_PENDING) {
     // Synchronous operation not supported.
@@ -364,12 +406,15 @@ int TCPSocketLibevent::Read(IOBuffer* buf,
     net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_RECEIVED, nread,
                                   buf->data());
     RecordFastOpenStatus();
+    if (nread > 0)
+      tcp_fastopen_data_received_ = true;
     return nread;
   }
   if (errno != EAGAIN && errno != EWOULDBLOCK) {
     int net_error = MapSystemError(errno);
     net_log_.AddEvent(NetLog::TYPE_SOCKET_READ_ERROR,
                       CreateNetLogSocketErrorCallback(net_error, errno));
+    RecordFastOpenFailure();
     return net_error;
   }
 
@@ -564,6 +609,7 @@ void TCPSocketLibevent::Close() {
   }
 
   tcp_fastopen_connected_ = false;
+  tcp_fastopen_data_received_ = false;
   fast_open_status_ = FAST_OPEN_STATUS_UNKNOWN;
   waiting_connect_ = false;
   peer_address_.reset();
@@ -731,11 +777,14 @@ void TCPSocketLibevent::DidCompleteRead() {
     read_bytes.Add(bytes_transferred);
     net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_RECEIVED, result,
                                   read_buf_->data());
+    if (result > 0)
+      tcp_fastopen_data_received_ = true;
   } else {
     result = MapSystemError(errno);
     if (result != ERR_IO_PENDING) {
       net_log_.AddEvent(NetLog::TYPE_SOCKET_READ_ERROR,
                         CreateNetLogSocketErrorCallback(result, errno));
+      RecordFastOpenFailure();
     }
   }
 
@@ -858,6 +907,7 @@ int TCPSocketLibevent::InternalWrite(IOBuffer* buf, int buf_len) {
         fast_open_status_ = FAST_OPEN_SLOW_CONNECT_RETURN;
       } else {
         fast_open_status_ = FAST_OPEN_ERROR;
+        RecordFastOpenFailure();
       }
     } else {
       fast_open_status_ = FAST_OPEN_FAST_CONNECT_RETURN;
@@ -901,4 +951,12 @@ void TCPSocketLibevent::RecordFastOpenStatus() {
   }
 }
 
+void TCPSocketLibevent::RecordFastOpenFailure() {
+  if (!use_tcp_fastopen_ || !tcp_fastopen_connected_ ||
+      tcp_fastopen_data_received_ || !peer_address_) {
+    return;
+  }
+  g_fast_open_blacklist.Get().Add(peer_address_->address());
+}
+
 }  // namespace net
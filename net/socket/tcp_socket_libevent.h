@@ -176,6 +176,11 @@ class NET_EXPORT TCPSocketLibevent : public base::NonThreadSafe {
   // Called when the socket is known to be in a connected state.
   void RecordFastOpenStatus();
 
+  // Called when a read or write fails. If this socket used TCP FastOpen and
+  // has not received any data yet, the peer is remembered so that later
+  // connections to it skip FastOpen.
+  void RecordFastOpenFailure();
+
   int socket_;
 
   base::MessageLoopForIO::FileDescriptorWatcher accept_socket_watcher_;
@@ -207,12 +212,16 @@ class NET_EXPORT TCPSocketLibevent : public base::NonThreadSafe {
   // External callback; called when write or connect is complete.
   CompletionCallback write_callback_;
 
-  // Enables experimental TCP FastOpen option.
-  const bool use_tcp_fastopen_;
+  // Enables experimental TCP FastOpen option. Cleared by Connect() for peers
+  // where FastOpen has failed before.
+  bool use_tcp_fastopen_;
 
   // True when TCP FastOpen is in use and we have done the connect.
   bool tcp_fastopen_connected_;
 
+  // True once a read on a TCP FastOpen connection has returned data.
+  bool tcp_fastopen_data_received_;
+
   FastOpenStatus fast_open_status_;
 
   // A connect operation is pending. In this case, |write_callback_| needs to be
@@ -5,6 +5,7 @@
 #include "net/socket/transport_client_socket_pool.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "base/lazy_instance.h"
@@ -33,6 +34,9 @@ namespace net {
 // don't synchronize.
 const int TransportConnectJob::kIPv6FallbackTimerInMs = 300;
 
+const int AddressFamilyRaceStats::kIPv4WinsToPreferIPv4 = 3;
+const int AddressFamilyRaceStats::kConnectsPerIPv6Probe = 10;
+
 namespace {
 
 // Returns true iff all addresses in |list| are in the IPv6 family.
@@ -46,6 +50,16 @@ bool AddressListOnlyContainsIPv6(const AddressList& list) {
   return true;
 }
 
+// Returns the family of the address |socket| connected to, assuming it is the
+// one of |addresses| if the socket can't tell.
+AddressFamily GetConnectedFamily(const StreamSocket& socket,
+                                 const AddressList& addresses) {
+  IPEndPoint peer;
+  if (socket.GetPeerAddress(&peer) == OK)
+    return peer.GetFamily();
+  return addresses.front().GetFamily();
+}
+
 }  // namespace
 
 // This lock protects |g_last_connect_time|.
@@ -70,6 +84,39 @@ TransportSocketParams::TransportSocketParams(
 
 TransportSocketParams::~TransportSocketParams() {}
 
+AddressFamilyRaceStats::AddressFamilyRaceStats()
+    : consecutive_ipv4_wins_(0),
+      connects_since_ipv6_probe_(0) {
+  NetworkChangeNotifier::AddIPAddressObserver(this);
+}
+
+AddressFamilyRaceStats::~AddressFamilyRaceStats() {
+  NetworkChangeNotifier::RemoveIPAddressObserver(this);
+}
+
+void AddressFamilyRaceStats::RecordRaceWinner(AddressFamily family) {
+  if (family == ADDRESS_FAMILY_IPV4)
+    ++consecutive_ipv4_wins_;
+  else
+    consecutive_ipv4_wins_ = 0;
+}
+
+AddressFamily AddressFamilyRaceStats::GetFamilyForNextConnect() {
+  if (consecutive_ipv4_wins_ < kIPv4WinsToPreferIPv4)
+    return ADDRESS_FAMILY_UNSPECIFIED;
+  if (++connects_since_ipv6_probe_ < kConnectsPerIPv6Probe)
+    return ADDRESS_FAMILY_IPV4;
+  // Race this one, which records a winner again.
+  connects_since_ipv6_probe_ = 0;
+  return ADDRESS_FAMILY_UNSPECIFIED;
+}
+
+void AddressFamilyRaceStats::OnIPAddressChanged() {
+  // IPv6 may work on the new network.
+  consecutive_ipv4_wins_ = 0;
+  connects_since_ipv6_probe_ = 0;
+}
+
 // TransportConnectJobs will time out after this many seconds.  Note this is
 // the total time, including both host resolution and TCP connect() times.
 //
@@ -89,13 +136,16 @@ TransportConnectJob::TransportConnectJob(
     ClientSocketFactory* client_socket_factory,
     HostResolver* host_resolver,
     Delegate* delegate,
-    NetLog* net_log)
+    NetLog* net_log,
+    AddressFamilyRaceStats* race_stats)
     : ConnectJob(group_name, timeout_duration, priority, delegate,
                  BoundNetLog::Make(net_log, NetLog::SOURCE_CONNECT_JOB)),
       params_(params),
       client_socket_factory_(client_socket_factory),
       resolver_(host_resolver),
       next_state_(STATE_NONE),
+      race_stats_(race_stats),
+      is_raceable_(false),
       interval_between_connects_(CONNECT_INTERVAL_GT_20MS) {
 }
 
@@ -129,6 +179,26 @@ void TransportConnectJob::MakeAddressListStartWithIPv4(AddressList* list) {
   }
 }
 
+// static
+void TransportConnectJob::InterleaveAddressFamilies(AddressList* list) {
+  if (list->empty())
+    return;
+  const AddressFamily first_family = list->front().GetFamily();
+  std::vector<IPEndPoint> first;
+  std::vector<IPEndPoint> others;
+  for (AddressList::const_iterator i = list->begin(); i != list->end(); ++i)
+    (i->GetFamily() == first_family ? first : others).push_back(*i);
+
+  // Assign in place to keep the canonical name.
+  size_t out = 0;
+  for (size_t i = 0; i < first.size() || i < others.size(); ++i) {
+    if (i < first.size())
+      (*list)[out++] = first[i];
+    if (i < others.size())
+      (*list)[out++] = others[i];
+  }
+}
+
 void TransportConnectJob::OnIOComplete(int result) {
   int rv = DoLoop(result);
   if (rv != ERR_IO_PENDING)
@@ -216,14 +286,23 @@ int TransportConnectJob::DoTransportConnect() {
       interval_between_connects_ = CONNECT_INTERVAL_GT_20MS;
   }
 
+  is_raceable_ = addresses_.front().GetFamily() == ADDRESS_FAMILY_IPV6 &&
+                 !AddressListOnlyContainsIPv6(addresses_);
+  // IPv6 keeps losing to IPv4 on this network, so don't wait for it.
+  if (is_raceable_ && race_stats_ &&
+      race_stats_->GetFamilyForNextConnect() == ADDRESS_FAMILY_IPV4) {
+    MakeAddressListStartWithIPv4(&addresses_);
+    is_raceable_ = false;
+  }
+  if (is_raceable_)
+    InterleaveAddressFamilies(&addresses_);
+
   next_state_ = STATE_TRANSPORT_CONNECT_COMPLETE;
   transport_socket_ = client_socket_factory_->CreateTransportClientSocket(
         addresses_, net_log().net_log(), net_log().source());
   int rv = transport_socket_->Connect(
       base::Bind(&TransportConnectJob::OnIOComplete, base::Unretained(this)));
-  if (rv == ERR_IO_PENDING &&
-      addresses_.front().GetFamily() == ADDRESS_FAMILY_IPV6 &&
-      !AddressListOnlyContainsIPv6(addresses_)) {
+  if (rv == ERR_IO_PENDING && is_raceable_) {
     fallback_timer_.Start(FROM_HERE,
         base::TimeDelta::FromMilliseconds(kIPv6FallbackTimerInMs),
         this, &TransportConnectJob::DoIPv6FallbackTransportConnect);
@@ -303,6 +382,10 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
                                    100);
       }
     }
+    if (is_raceable_ && race_stats_) {
+      race_stats_->RecordRaceWinner(
+          GetConnectedFamily(*transport_socket_, addresses_));
+    }
     SetSocket(transport_socket_.Pass());
     fallback_timer_.Stop();
   } else {
@@ -327,6 +410,7 @@ void TransportConnectJob::DoIPv6FallbackTransportConnect() {
 
   fallback_addresses_.reset(new AddressList(addresses_));
   MakeAddressListStartWithIPv4(fallback_addresses_.get());
+  InterleaveAddressFamilies(fallback_addresses_.get());
   fallback_transport_socket_ =
       client_socket_factory_->CreateTransportClientSocket(
           *fallback_addresses_, net_log().net_log(), net_log().source());
@@ -374,6 +458,11 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
         base::TimeDelta::FromMilliseconds(1),
         base::TimeDelta::FromMinutes(10),
         100);
+    if (race_stats_) {
+      race_stats_->RecordRaceWinner(
+          GetConnectedFamily(*fallback_transport_socket_,
+                             *fallback_addresses_));
+    }
     SetSocket(fallback_transport_socket_.Pass());
     next_state_ = STATE_NONE;
     transport_socket_.reset();
@@ -403,7 +492,8 @@ scoped_ptr<ConnectJob>
                               client_socket_factory_,
                               host_resolver_,
                               delegate,
-                              net_log_));
+                              net_log_,
+                              race_stats_));
 }
 
 base::TimeDelta
@@ -423,7 +513,8 @@ TransportClientSocketPool::TransportClientSocketPool(
             ClientSocketPool::unused_idle_socket_timeout(),
             ClientSocketPool::used_idle_socket_timeout(),
             new TransportConnectJobFactory(client_socket_factory,
-                                           host_resolver, net_log)) {
+                                           host_resolver, net_log,
+                                           &race_stats_)) {
   base_.EnableConnectBackupJobs();
 }
 
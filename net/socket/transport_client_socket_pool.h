@@ -12,7 +12,9 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
+#include "net/base/address_family.h"
 #include "net/base/host_port_pair.h"
+#include "net/base/network_change_notifier.h"
 #include "net/dns/host_resolver.h"
 #include "net/dns/single_request_host_resolver.h"
 #include "net/socket/client_socket_pool.h"
@@ -55,6 +57,42 @@ class NET_EXPORT_PRIVATE TransportSocketParams
   DISALLOW_COPY_AND_ASSIGN(TransportSocketParams);
 };
 
+// Tracks which address family wins the IPv6/IPv4 connect races on the current
+// network. Once IPv4 has won a few races in a row, IPv6 is likely broken or
+// slow on this network, so TransportConnectJob stops giving it a head start,
+// except for an occasional race to notice IPv6 recovering. The record is
+// dropped when the IP address changes.
+class NET_EXPORT_PRIVATE AddressFamilyRaceStats
+    : public NetworkChangeNotifier::IPAddressObserver {
+ public:
+  AddressFamilyRaceStats();
+  virtual ~AddressFamilyRaceStats();
+
+  // Records that a connection over |family| won a race.
+  void RecordRaceWinner(AddressFamily family);
+
+  // Returns ADDRESS_FAMILY_IPV4 if the next connect that could race should
+  // try IPv4 first, or ADDRESS_FAMILY_UNSPECIFIED to keep the resolver's
+  // order. While IPv4 is preferred, every kConnectsPerIPv6Probe-th connect
+  // races anyway, so an IPv6 win can end the preference.
+  AddressFamily GetFamilyForNextConnect();
+
+  // NetworkChangeNotifier::IPAddressObserver methods.
+  virtual void OnIPAddressChanged() OVERRIDE;
+
+  // Number of consecutive IPv4 wins after which IPv4 is tried first.
+  static const int kIPv4WinsToPreferIPv4;
+
+  // How often IPv6 still gets to race while IPv4 is preferred.
+  static const int kConnectsPerIPv6Probe;
+
+ private:
+  int consecutive_ipv4_wins_;
+  int connects_since_ipv6_probe_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddressFamilyRaceStats);
+};
+
 // TransportConnectJob handles the host resolution necessary for socket creation
 // and the transport (likely TCP) connect. TransportConnectJob also has fallback
 // logic for IPv6 connect() timeouts (which may happen due to networks / routers
@@ -63,6 +101,11 @@ class NET_EXPORT_PRIVATE TransportSocketParams
 // (kIPv6FallbackTimerInMs) and start a connect() to a IPv4 address if the timer
 // fires. Then we race the IPv4 connect() against the IPv6 connect() (which has
 // a headstart) and return the one that completes first to the socket pool.
+// Both connects walk their address lists with the families interleaved, so a
+// dead address of one family doesn't hold up the next address of the other.
+//
+// |race_stats|, if not NULL, is told which family won a race, and may decide
+// that IPv4 goes first without a race; it must outlive the job.
 class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
  public:
   TransportConnectJob(const std::string& group_name,
@@ -72,7 +115,8 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
                       ClientSocketFactory* client_socket_factory,
                       HostResolver* host_resolver,
                       Delegate* delegate,
-                      NetLog* net_log);
+                      NetLog* net_log,
+                      AddressFamilyRaceStats* race_stats);
   virtual ~TransportConnectJob();
 
   // ConnectJob methods.
@@ -82,6 +126,11 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   // WARNING: this method should only be used to implement the prefer-IPv4 hack.
   static void MakeAddressListStartWithIPv4(AddressList* addrlist);
 
+  // Reorders |addrlist| to alternate between the address families, starting
+  // with the family of its first address. The order within each family is
+  // kept.
+  static void InterleaveAddressFamilies(AddressList* addrlist);
+
   static const int kIPv6FallbackTimerInMs;
 
  private:
@@ -123,6 +172,10 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   SingleRequestHostResolver resolver_;
   AddressList addresses_;
   State next_state_;
+  AddressFamilyRaceStats* const race_stats_;
+
+  // True if the IPv6 connect may be raced against an IPv4 one.
+  bool is_raceable_;
 
   scoped_ptr<StreamSocket> transport_socket_;
 
@@ -195,10 +248,12 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
    public:
     TransportConnectJobFactory(ClientSocketFactory* client_socket_factory,
                          HostResolver* host_resolver,
-                         NetLog* net_log)
+                         NetLog* net_log,
+                         AddressFamilyRaceStats* race_stats)
         : client_socket_factory_(client_socket_factory),
           host_resolver_(host_resolver),
-          net_log_(net_log) {}
+          net_log_(net_log),
+          race_stats_(race_stats) {}
 
     virtual ~TransportConnectJobFactory() {}
 
@@ -215,10 +270,14 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
     ClientSocketFactory* const client_socket_factory_;
     HostResolver* const host_resolver_;
     NetLog* net_log_;
+    AddressFamilyRaceStats* const race_stats_;
 
     DISALLOW_COPY_AND_ASSIGN(TransportConnectJobFactory);
   };
 
+  // Declared before |base_|, so that it outlives the ConnectJobs.
+  AddressFamilyRaceStats race_stats_;
+
   PoolBase base_;
 
   DISALLOW_COPY_AND_ASSIGN(TransportClientSocketPool);
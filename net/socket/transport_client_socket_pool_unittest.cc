@@ -10,6 +10,7 @@
 #include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/threading/platform_thread.h"
 #include "net/base/capturing_net_log.h"
 #include "net/base/ip_endpoint.h"
@@ -572,6 +573,59 @@ TEST(TransportConnectJobTest, MakeAddrListStartWithIPv4) {
   EXPECT_EQ(ADDRESS_FAMILY_IPV6, addrlist[3].GetFamily());
 }
 
+TEST(TransportConnectJobTest, InterleaveAddressFamilies) {
+  IPAddressNumber ip_number;
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.1", &ip_number));
+  IPEndPoint addrlist_v4_1(ip_number, 80);
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.2", &ip_number));
+  IPEndPoint addrlist_v4_2(ip_number, 80);
+  ASSERT_TRUE(ParseIPLiteralToNumber("2001:4860:b006::64", &ip_number));
+  IPEndPoint addrlist_v6_1(ip_number, 80);
+  ASSERT_TRUE(ParseIPLiteralToNumber("2001:4860:b006::66", &ip_number));
+  IPEndPoint addrlist_v6_2(ip_number, 80);
+  ASSERT_TRUE(ParseIPLiteralToNumber("2001:4860:b006::68", &ip_number));
+  IPEndPoint addrlist_v6_3(ip_number, 80);
+
+  AddressList addrlist;
+
+  // Test 1: IPv6 only.  Expect no change.
+  addrlist.push_back(addrlist_v6_1);
+  addrlist.push_back(addrlist_v6_2);
+  TransportConnectJob::InterleaveAddressFamilies(&addrlist);
+  ASSERT_EQ(2u, addrlist.size());
+  EXPECT_TRUE(addrlist[0] == addrlist_v6_1);
+  EXPECT_TRUE(addrlist[1] == addrlist_v6_2);
+
+  // Test 2: IPv6, IPv6, IPv6, IPv4, IPv4.  Expect the families to alternate,
+  // starting with IPv6, and the leftover IPv6 at the end.
+  addrlist.clear();
+  addrlist.set_canonical_name("canonical.name");
+  addrlist.push_back(addrlist_v6_1);
+  addrlist.push_back(addrlist_v6_2);
+  addrlist.push_back(addrlist_v6_3);
+  addrlist.push_back(addrlist_v4_1);
+  addrlist.push_back(addrlist_v4_2);
+  TransportConnectJob::InterleaveAddressFamilies(&addrlist);
+  ASSERT_EQ(5u, addrlist.size());
+  EXPECT_TRUE(addrlist[0] == addrlist_v6_1);
+  EXPECT_TRUE(addrlist[1] == addrlist_v4_1);
+  EXPECT_TRUE(addrlist[2] == addrlist_v6_2);
+  EXPECT_TRUE(addrlist[3] == addrlist_v4_2);
+  EXPECT_TRUE(addrlist[4] == addrlist_v6_3);
+  EXPECT_EQ("canonical.name", addrlist.canonical_name());
+
+  // Test 3: IPv4, IPv4, IPv6.  Expect IPv4 to stay first.
+  addrlist.clear();
+  addrlist.push_back(addrlist_v4_1);
+  addrlist.push_back(addrlist_v4_2);
+  addrlist.push_back(addrlist_v6_1);
+  TransportConnectJob::InterleaveAddressFamilies(&addrlist);
+  ASSERT_EQ(3u, addrlist.size());
+  EXPECT_TRUE(addrlist[0] == addrlist_v4_1);
+  EXPECT_TRUE(addrlist[1] == addrlist_v6_1);
+  EXPECT_TRUE(addrlist[2] == addrlist_v4_2);
+}
+
 TEST_F(TransportClientSocketPoolTest, Basic) {
   TestCompletionCallback callback;
   ClientSocketHandle handle;
@@ -1370,6 +1424,153 @@ TEST_F(TransportClientSocketPoolTest, IPv4HasNoFallback) {
   EXPECT_EQ(1, client_socket_factory_.allocation_count());
 }
 
+// Test that IPv4 goes first, without a race, once it has won a few races in a
+// row, until the IP address changes.
+TEST_F(TransportClientSocketPoolTest, IPv4FirstAfterIPv4WinsRaces) {
+  // Create a pool without backup jobs.
+  ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(false);
+  TransportClientSocketPool pool(kMaxSockets,
+                                 kMaxSocketsPerGroup,
+                                 histograms_.get(),
+                                 host_resolver_.get(),
+                                 &client_socket_factory_,
+                                 NULL);
+
+  // Resolve an AddressList with a IPv6 address first and then a IPv4 address.
+  host_resolver_->rules()
+      ->AddIPLiteralRule("*", "2:abcd::3:4:ff,2.2.2.2", std::string());
+
+  MockClientSocketFactory::ClientSocketType race_types[] = {
+    // This is the IPv6 socket.
+    MockClientSocketFactory::MOCK_STALLED_CLIENT_SOCKET,
+    // This is the IPv4 socket.
+    MockClientSocketFactory::MOCK_PENDING_CLIENT_SOCKET
+  };
+
+  int expected_allocation_count = 0;
+  for (int i = 0; i < AddressFamilyRaceStats::kIPv4WinsToPreferIPv4; ++i) {
+    client_socket_factory_.set_client_socket_types(race_types, 2);
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init(base::IntToString(i), params_, LOW,
+                          callback.callback(), &pool, BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+    IPEndPoint endpoint;
+    handle.socket()->GetLocalAddress(&endpoint);
+    EXPECT_EQ(kIPv4AddressSize, endpoint.address().size());
+    expected_allocation_count += 2;
+    EXPECT_EQ(expected_allocation_count,
+              client_socket_factory_.allocation_count());
+  }
+
+  // IPv4 is now tried first, with a single socket.
+  client_socket_factory_.set_client_socket_type(
+      MockClientSocketFactory::MOCK_PENDING_CLIENT_SOCKET);
+  {
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init("ipv4_first", params_, LOW, callback.callback(),
+                          &pool, BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+    IPEndPoint endpoint;
+    handle.socket()->GetLocalAddress(&endpoint);
+    EXPECT_EQ(kIPv4AddressSize, endpoint.address().size());
+    EXPECT_EQ(expected_allocation_count + 1,
+              client_socket_factory_.allocation_count());
+  }
+
+  // On a new network, IPv6 goes first again.
+  NetworkChangeNotifier::NotifyObserversOfIPAddressChangeForTests();
+  base::MessageLoop::current()->RunUntilIdle();  // Notification happens async.
+  {
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init("ipv6_first", params_, LOW, callback.callback(),
+                          &pool, BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+    IPEndPoint endpoint;
+    handle.socket()->GetLocalAddress(&endpoint);
+    EXPECT_EQ(kIPv6AddressSize, endpoint.address().size());
+  }
+}
+
+// Test that IPv6 still races now and then while IPv4 goes first, and that an
+// IPv6 win ends the preference.
+TEST_F(TransportClientSocketPoolTest, IPv6RacesAgainWhileIPv4Preferred) {
+  // Create a pool without backup jobs.
+  ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(false);
+  TransportClientSocketPool pool(kMaxSockets,
+                                 kMaxSocketsPerGroup,
+                                 histograms_.get(),
+                                 host_resolver_.get(),
+                                 &client_socket_factory_,
+                                 NULL);
+
+  // Resolve an AddressList with a IPv6 address first and then a IPv4 address.
+  host_resolver_->rules()
+      ->AddIPLiteralRule("*", "2:abcd::3:4:ff,2.2.2.2", std::string());
+
+  MockClientSocketFactory::ClientSocketType ipv4_wins[] = {
+    MockClientSocketFactory::MOCK_STALLED_CLIENT_SOCKET,
+    MockClientSocketFactory::MOCK_PENDING_CLIENT_SOCKET
+  };
+  for (int i = 0; i < AddressFamilyRaceStats::kIPv4WinsToPreferIPv4; ++i) {
+    client_socket_factory_.set_client_socket_types(ipv4_wins, 2);
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init(base::IntToString(i), params_, LOW,
+                          callback.callback(), &pool, BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+  }
+
+  // All but the last connect of a probe interval go to IPv4 alone.
+  client_socket_factory_.set_client_socket_type(
+      MockClientSocketFactory::MOCK_PENDING_CLIENT_SOCKET);
+  for (int i = 1; i < AddressFamilyRaceStats::kConnectsPerIPv6Probe; ++i) {
+    int allocation_count = client_socket_factory_.allocation_count();
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init("ipv4_first" + base::IntToString(i), params_, LOW,
+                          callback.callback(), &pool, BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+    IPEndPoint endpoint;
+    handle.socket()->GetLocalAddress(&endpoint);
+    EXPECT_EQ(kIPv4AddressSize, endpoint.address().size());
+    EXPECT_EQ(allocation_count + 1, client_socket_factory_.allocation_count());
+  }
+
+  // The next one races, and IPv6 wins it.
+  {
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init("probe", params_, LOW, callback.callback(), &pool,
+                          BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+    IPEndPoint endpoint;
+    handle.socket()->GetLocalAddress(&endpoint);
+    EXPECT_EQ(kIPv6AddressSize, endpoint.address().size());
+  }
+
+  // So IPv6 goes first again.
+  {
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    EXPECT_EQ(ERR_IO_PENDING,
+              handle.Init("ipv6_first", params_, LOW, callback.callback(),
+                          &pool, BoundNetLog()));
+    EXPECT_EQ(OK, callback.WaitForResult());
+    IPEndPoint endpoint;
+    handle.socket()->GetLocalAddress(&endpoint);
+    EXPECT_EQ(kIPv6AddressSize, endpoint.address().size());
+  }
+}
+
 }  // namespace
 
 }  // namespace net
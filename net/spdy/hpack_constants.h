@@ -5,7 +5,10 @@
 #ifndef NET_SPDY_HPACK_CONSTANTS_H_
 #define NET_SPDY_HPACK_CONSTANTS_H_
 
+#include <vector>
+
 #include "base/basictypes.h"
+#include "net/base/net_export.h"
 
 // All section references below are to
 // http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
@@ -20,10 +23,24 @@ struct HpackPrefix {
   size_t bit_size;
 };
 
+// A HpackHuffmanSymbol is a (code, length, id) triple. |code| is
+// stored left-justified, i.e. in the top |length| bits.
+struct HpackHuffmanSymbol {
+  uint32 code;
+  uint8 length;
+  uint16 id;
+};
+
+class HpackHuffmanTable;
+
 // The marker for a string literal that is stored unmodified (i.e.,
 // without Huffman encoding) (from 4.1.2).
 const HpackPrefix kStringLiteralIdentityEncoded = { 0x0, 1 };
 
+// The marker for a string literal that is stored with Huffman
+// encoding (from 4.1.2).
+const HpackPrefix kStringLiteralHuffmanEncoded = { 0x1, 1 };
+
 // The opcode for an indexed header field (from 4.2).
 const HpackPrefix kIndexedOpcode = { 0x1, 1 };
 
@@ -35,6 +52,21 @@ const HpackPrefix kLiteralNoIndexOpcode = { 0x01, 2 };
 // (from 4.3.2).
 const HpackPrefix kLiteralIncrementalIndexOpcode = { 0x00, 2 };
 
+// The id of the end-of-string symbol of the Huffman code.
+const uint16 kHpackHuffmanEosId = 256;
+
+// Returns the symbols of the static Huffman code, ordered by id,
+// with the end-of-string symbol last. Unlike everything else here,
+// the code is not from draft-05, which has separate request and
+// response codes, but from Appendix C of
+// http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-08
+// , which replaced them with this single one.
+NET_EXPORT_PRIVATE std::vector<HpackHuffmanSymbol> HpackHuffmanCode();
+
+// Returns a process-wide HpackHuffmanTable initialized with
+// HpackHuffmanCode().
+NET_EXPORT_PRIVATE const HpackHuffmanTable& ObtainHpackHuffmanTable();
+
 }  // namespace net
 
 #endif  // NET_SPDY_HPACK_CONSTANTS_H_
@@ -5,6 +5,7 @@
 #include "net/spdy/hpack_decoder.h"
 
 #include "base/basictypes.h"
+#include "base/logging.h"
 #include "net/spdy/hpack_constants.h"
 #include "net/spdy/hpack_output_stream.h"
 
@@ -13,16 +14,33 @@ namespace net {
 using base::StringPiece;
 
 HpackDecoder::HpackDecoder(uint32 max_string_literal_size)
-    : max_string_literal_size_(max_string_literal_size) {}
+    : max_string_literal_size_(max_string_literal_size),
+      header_list_(NULL),
+      header_block_(NULL) {}
 
 HpackDecoder::~HpackDecoder() {}
 
 bool HpackDecoder::DecodeHeaderSet(StringPiece input,
                                    HpackHeaderPairVector* header_list) {
+  header_list_ = header_list;
+  bool result = DecodeHeaders(input);
+  header_list_ = NULL;
+  return result;
+}
+
+bool HpackDecoder::DecodeHeaderBlock(StringPiece input,
+                                     SpdyHeaderBlock* header_block) {
+  header_block_ = header_block;
+  bool result = DecodeHeaders(input);
+  header_block_ = NULL;
+  return result;
+}
+
+bool HpackDecoder::DecodeHeaders(StringPiece input) {
   HpackInputStream input_stream(max_string_literal_size_, input);
   while (input_stream.HasMoreData()) {
-    // May add to |header_list|.
-    if (!ProcessNextHeaderRepresentation(&input_stream, header_list))
+    // May emit headers.
+    if (!ProcessNextHeaderRepresentation(&input_stream))
       return false;
   }
 
@@ -31,9 +49,7 @@ bool HpackDecoder::DecodeHeaderSet(StringPiece input,
   for (size_t i = 1; i <= context_.GetMutableEntryCount(); ++i) {
     if (context_.IsReferencedAt(i) &&
         (context_.GetTouchCountAt(i) == HpackEncodingContext::kUntouched)) {
-      header_list->push_back(
-          HpackHeaderPair(context_.GetNameAt(i).as_string(),
-                          context_.GetValueAt(i).as_string()));
+      EmitHeader(context_.GetNameAt(i), context_.GetValueAt(i));
     }
     context_.ClearTouchesAt(i);
   }
@@ -41,8 +57,24 @@ bool HpackDecoder::DecodeHeaderSet(StringPiece input,
   return true;
 }
 
+void HpackDecoder::EmitHeader(StringPiece name, StringPiece value) {
+  if (header_list_) {
+    header_list_->push_back(
+        HpackHeaderPair(name.as_string(), value.as_string()));
+    return;
+  }
+
+  DCHECK(header_block_);
+  std::pair<SpdyHeaderBlock::iterator, bool> result =
+      header_block_->insert(std::make_pair(name.as_string(), std::string()));
+  std::string* block_value = &result.first->second;
+  if (!result.second)
+    block_value->push_back('\0');
+  block_value->append(value.data(), value.size());
+}
+
 bool HpackDecoder::ProcessNextHeaderRepresentation(
-    HpackInputStream* input_stream, HpackHeaderPairVector* header_list) {
+    HpackInputStream* input_stream) {
   // Touches are used below to track which headers have been emitted.
 
   // Implements 4.2. Indexed Header Field Representation.
@@ -59,9 +91,7 @@ bool HpackDecoder::ProcessNextHeaderRepresentation(
       uint32 index = index_or_zero;
       // The index will be put into the reference set.
       if (!context_.IsReferencedAt(index)) {
-        header_list->push_back(
-            HpackHeaderPair(context_.GetNameAt(index).as_string(),
-                            context_.GetValueAt(index).as_string()));
+        EmitHeader(context_.GetNameAt(index), context_.GetValueAt(index));
         emitted = true;
       }
     }
@@ -87,8 +117,7 @@ bool HpackDecoder::ProcessNextHeaderRepresentation(
     if (!DecodeNextValue(input_stream, &value))
       return false;
 
-    header_list->push_back(
-        HpackHeaderPair(name.as_string(), value.as_string()));
+    EmitHeader(name, value);
     return true;
   }
 
@@ -102,8 +131,7 @@ bool HpackDecoder::ProcessNextHeaderRepresentation(
     if (!DecodeNextValue(input_stream, &value))
       return false;
 
-    header_list->push_back(
-        HpackHeaderPair(name.as_string(), value.as_string()));
+    EmitHeader(name, value);
 
     uint32 new_index = 0;
     std::vector<uint32> removed_referenced_indices;
@@ -125,8 +153,10 @@ bool HpackDecoder::DecodeNextName(
   if (!input_stream->DecodeNextUint32(&index_or_zero))
     return false;
 
-  if (index_or_zero == 0)
-    return input_stream->DecodeNextStringLiteral(next_name);
+  if (index_or_zero == 0) {
+    return input_stream->DecodeNextStringLiteral(next_name,
+                                                 &huffman_name_buffer_);
+  }
 
   uint32 index = index_or_zero;
   if (index > context_.GetEntryCount())
@@ -138,7 +168,8 @@ bool HpackDecoder::DecodeNextName(
 
 bool HpackDecoder::DecodeNextValue(
     HpackInputStream* input_stream, StringPiece* next_name) {
-  return input_stream->DecodeNextStringLiteral(next_name);
+  return input_stream->DecodeNextStringLiteral(next_name,
+                                               &huffman_value_buffer_);
 }
 
 }  // namespace net
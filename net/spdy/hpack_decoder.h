@@ -14,12 +14,14 @@
 #include "net/base/net_export.h"
 #include "net/spdy/hpack_encoding_context.h"
 #include "net/spdy/hpack_input_stream.h"  // For HpackHeaderPairVector.
+#include "net/spdy/spdy_header_block.h"
 
 namespace net {
 
 // An HpackDecoder decodes header sets as outlined in
 // http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
-// .
+// , except that Huffman-encoded literals use the code of a later
+// draft (see HpackHuffmanCode()).
 class NET_EXPORT_PRIVATE HpackDecoder {
  public:
   explicit HpackDecoder(uint32 max_string_literal_size);
@@ -33,6 +35,12 @@ class NET_EXPORT_PRIVATE HpackDecoder {
   bool DecodeHeaderSet(base::StringPiece input,
                        HpackHeaderPairVector* header_list);
 
+  // Like DecodeHeaderSet(), but adds the headers straight to
+  // |header_block|. Values of repeated names are joined with NUL, as
+  // in SPDY. Names and values are copied only into |header_block|.
+  bool DecodeHeaderBlock(base::StringPiece input,
+                         SpdyHeaderBlock* header_block);
+
   // Accessors for testing.
 
   bool DecodeNextNameForTest(HpackInputStream* input_stream,
@@ -44,12 +52,27 @@ class NET_EXPORT_PRIVATE HpackDecoder {
   const uint32 max_string_literal_size_;
   HpackEncodingContext context_;
 
+  // Storage for Huffman-decoded names and values, kept between calls
+  // so that their capacity is reused.
+  std::string huffman_name_buffer_;
+  std::string huffman_value_buffer_;
+
+  // Where decoded headers go: exactly one of these is set while a
+  // header set is being decoded.
+  HpackHeaderPairVector* header_list_;
+  SpdyHeaderBlock* header_block_;
+
+  // Decodes |input| into whichever of |header_list_| or
+  // |header_block_| is set.
+  bool DecodeHeaders(base::StringPiece input);
+
+  // Adds the given header to the output.
+  void EmitHeader(base::StringPiece name, base::StringPiece value);
+
   // Tries to process the next header representation and maybe emit
-  // headers into |header_list| according to it. Returns true if
-  // successful, or false if an error was encountered.
-  bool ProcessNextHeaderRepresentation(
-      HpackInputStream* input_stream,
-      HpackHeaderPairVector* header_list);
+  // headers according to it. Returns true if successful, or false if
+  // an error was encountered.
+  bool ProcessNextHeaderRepresentation(HpackInputStream* input_stream);
 
   bool DecodeNextName(HpackInputStream* input_stream,
                       base::StringPiece* next_name);
@@ -11,6 +11,7 @@
 #include "base/strings/string_piece.h"
 #include "net/spdy/hpack_encoder.h"
 #include "net/spdy/hpack_input_stream.h"
+#include "net/spdy/spdy_header_block.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -187,6 +188,53 @@ TEST(HpackDecoderTest, BasicE21) {
   EXPECT_EQ(expected_header_set, header_set);
 }
 
+// Huffman-encoded names and values should be decoded.
+TEST(HpackDecoderTest, LiteralHeaderHuffman) {
+  HpackDecoder decoder(kuint32max);
+  // :authority with a Huffman-encoded value, then a literal name and
+  // value that are both Huffman encoded.
+  std::map<string, string> header_set = DecodeUniqueHeaderSet(
+      &decoder,
+      "\x41\x8c\xf1\xe3\xc2\xe5\xf2\x3a\x6b\xa0\xab\x90\xf4\xff"
+      "\x40\x88\x25\xa8\x49\xe9\x5b\xa9\x7d\x7f"
+      "\x89\x25\xa8\x49\xe9\x5b\xb8\xe8\xb4\xbf");
+
+  std::map<string, string> expected_header_set;
+  expected_header_set[":authority"] = "www.example.com";
+  expected_header_set["custom-key"] = "custom-value";
+  EXPECT_EQ(expected_header_set, header_set);
+}
+
+// Decoding into a SpdyHeaderBlock should produce the same headers,
+// including those emitted from the reference set, and join values of
+// repeated names with NUL.
+TEST(HpackDecoderTest, DecodeHeaderBlock) {
+  HpackDecoder decoder(kuint32max);
+
+  // :method GET from the static table, :path with an indexed name
+  // (now #5 because of the copy of #2), and two cookies.
+  SpdyHeaderBlock header_block;
+  EXPECT_TRUE(decoder.DecodeHeaderBlock(
+      StringPiece("\x82\x05\x0c/sample/path"
+                  "\x00\x06" "cookie\x01" "a"
+                  "\x00\x06" "cookie\x01" "b", 35),
+      &header_block));
+
+  SpdyHeaderBlock expected_header_block;
+  expected_header_block[":method"] = "GET";
+  expected_header_block[":path"] = "/sample/path";
+  expected_header_block["cookie"] = string("a\0b", 3);
+  EXPECT_EQ(expected_header_block, header_block);
+
+  // Only the reference set this time.
+  header_block.clear();
+  EXPECT_TRUE(decoder.DecodeHeaderBlock("", &header_block));
+  EXPECT_EQ(3u, header_block.size());
+  EXPECT_EQ("GET", header_block[":method"]);
+
+  EXPECT_FALSE(decoder.DecodeHeaderBlock("\xff", &header_block));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -4,33 +4,219 @@
 
 #include "net/spdy/hpack_encoder.h"
 
+#include "base/logging.h"
+#include "net/spdy/hpack_constants.h"
+#include "net/spdy/hpack_entry.h"
 #include "net/spdy/hpack_output_stream.h"
 
 namespace net {
 
+using base::StringPiece;
 using std::string;
 
+namespace {
+
+typedef std::map<string, string> HeaderSet;
+
+// The most header names whose value history is kept. The history is
+// simply reset when it grows past this, which only costs some
+// compression for a little while.
+const size_t kMaxValueHistorySize = 128;
+
+}  // namespace
+
+const int HpackEncoder::kMaxConsecutiveValueChanges = 2;
+
 HpackEncoder::HpackEncoder(uint32 max_string_literal_size)
     : max_string_literal_size_(max_string_literal_size) {}
 
 HpackEncoder::~HpackEncoder() {}
 
-bool HpackEncoder::EncodeHeaderSet(const std::map<string, string>& header_set,
+bool HpackEncoder::EncodeHeaderSet(const HeaderSet& header_set,
                                    string* output) {
-  // TOOD(akalin): Do more sophisticated encoding.
-  HpackOutputStream output_stream(max_string_literal_size_);
-  for (std::map<string, string>::const_iterator it = header_set.begin();
+  // Check sizes up front, so that nothing below can fail and a
+  // failure leaves the encoding context untouched.
+  for (HeaderSet::const_iterator it = header_set.begin();
        it != header_set.end(); ++it) {
-    // TODO(akalin): Clarify in the spec that encoding with the name
-    // as a literal is OK even if the name already exists in the
-    // header table.
-    if (!output_stream.AppendLiteralHeaderNoIndexingWithName(
-            it->first, it->second)) {
+    if (it->first.size() > max_string_literal_size_ ||
+        it->second.size() > max_string_literal_size_) {
       return false;
     }
   }
+
+  HpackOutputStream output_stream(max_string_literal_size_);
+  output_stream.set_huffman_table(&ObtainHpackHuffmanTable());
+
+  // Touches mark the referenced entries which the decoder will emit,
+  // as in HpackDecoder. First, keep the referenced entries that are
+  // in |header_set|; those need no representation at all.
+  std::vector<HeaderSet::const_iterator> kept_headers;
+  std::vector<HeaderSet::const_iterator> new_headers;
+  for (HeaderSet::const_iterator it = header_set.begin();
+       it != header_set.end(); ++it) {
+    bool kept = false;
+    for (uint32 i = 1; i <= context_.GetMutableEntryCount(); ++i) {
+      if (context_.IsReferencedAt(i) &&
+          context_.GetTouchCountAt(i) == HpackEncodingContext::kUntouched &&
+          context_.GetNameAt(i) == it->first &&
+          context_.GetValueAt(i) == it->second) {
+        context_.AddTouchesAt(i, 0);
+        kept = true;
+        break;
+      }
+    }
+    if (kept)
+      kept_headers.push_back(it);
+    else
+      new_headers.push_back(it);
+  }
+
+  // Then remove the other entries from the reference set, all at
+  // once if that is shorter.
+  std::vector<uint32> stale_indices;
+  for (uint32 i = 1; i <= context_.GetMutableEntryCount(); ++i) {
+    if (context_.IsReferencedAt(i) &&
+        context_.GetTouchCountAt(i) == HpackEncodingContext::kUntouched) {
+      stale_indices.push_back(i);
+    }
+  }
+  if (kept_headers.empty() && stale_indices.size() > 1)
+    stale_indices.assign(1, 0);
+  for (size_t i = 0; i < stale_indices.size(); ++i) {
+    output_stream.AppendIndexedHeader(stale_indices[i]);
+    uint32 new_index = 0;
+    std::vector<uint32> removed_referenced_indices;
+    context_.ProcessIndexedHeader(
+        stale_indices[i], &new_index, &removed_referenced_indices);
+  }
+
+  for (size_t i = 0; i < new_headers.size(); ++i) {
+    EncodeHeader(new_headers[i]->first, new_headers[i]->second, true,
+                 &output_stream);
+  }
+
+  // Adding entries may have evicted some of the kept ones, which the
+  // decoder then won't emit. Encode those again, without touching the
+  // header table this time.
+  for (size_t i = 0; i < kept_headers.size(); ++i) {
+    const string& name = kept_headers[i]->first;
+    const string& value = kept_headers[i]->second;
+    bool still_referenced = false;
+    for (uint32 j = 1; j <= context_.GetMutableEntryCount(); ++j) {
+      if (context_.IsReferencedAt(j) &&
+          context_.GetTouchCountAt(j) != HpackEncodingContext::kUntouched &&
+          context_.GetNameAt(j) == name && context_.GetValueAt(j) == value) {
+        still_referenced = true;
+        break;
+      }
+    }
+    if (!still_referenced)
+      EncodeHeader(name, value, false, &output_stream);
+  }
+
+  for (uint32 i = 1; i <= context_.GetMutableEntryCount(); ++i)
+    context_.ClearTouchesAt(i);
+
+  UpdateValueHistory(header_set);
   output_stream.TakeString(output);
   return true;
 }
 
+uint32 HpackEncoder::FindUnreferencedEntry(StringPiece name,
+                                           StringPiece value,
+                                           bool mutable_only) const {
+  uint32 entry_count = mutable_only ?
+      context_.GetMutableEntryCount() : context_.GetEntryCount();
+  for (uint32 i = 1; i <= entry_count; ++i) {
+    if (context_.IsReferencedAt(i))
+      continue;
+    if (context_.GetNameAt(i) == name && context_.GetValueAt(i) == value)
+      return i;
+  }
+  return 0;
+}
+
+uint32 HpackEncoder::FindName(StringPiece name) const {
+  for (uint32 i = 1; i <= context_.GetEntryCount(); ++i) {
+    if (context_.GetNameAt(i) == name)
+      return i;
+  }
+  return 0;
+}
+
+bool HpackEncoder::ShouldIndex(StringPiece name, StringPiece value) const {
+  // Large entries would evict much of the table.
+  size_t size = name.size() + value.size() + HpackEntry::kSizeOverhead;
+  if (size > context_.GetMaxSize() / 2)
+    return false;
+
+  // Values that change on every header set would only churn the
+  // table.
+  ValueHistoryMap::const_iterator it = value_history_.find(name.as_string());
+  return it == value_history_.end() ||
+      it->second.consecutive_changes < kMaxConsecutiveValueChanges;
+}
+
+void HpackEncoder::EncodeHeader(StringPiece name,
+                                StringPiece value,
+                                bool allow_indexing,
+                                HpackOutputStream* output_stream) {
+  // An indexed representation of a static entry copies it into the
+  // header table, so only mutable entries are used without indexing.
+  uint32 index = FindUnreferencedEntry(name, value, !allow_indexing);
+  if (index > 0) {
+    output_stream->AppendIndexedHeader(index);
+    uint32 new_index = 0;
+    std::vector<uint32> removed_referenced_indices;
+    context_.ProcessIndexedHeader(
+        index, &new_index, &removed_referenced_indices);
+    if (new_index > 0)
+      context_.AddTouchesAt(new_index, 0);
+    return;
+  }
+
+  // The literals fit, as EncodeHeaderSet() checked, so appending them
+  // always succeeds.
+  uint32 name_index = FindName(name);
+  if (!allow_indexing || !ShouldIndex(name, value)) {
+    bool result = name_index > 0 ?
+        output_stream->AppendLiteralHeaderNoIndexingWithIndexedName(
+            name_index, value) :
+        output_stream->AppendLiteralHeaderNoIndexingWithName(name, value);
+    DCHECK(result);
+    return;
+  }
+
+  bool result = name_index > 0 ?
+      output_stream->AppendLiteralHeaderIncrementalIndexingWithIndexedName(
+          name_index, value) :
+      output_stream->AppendLiteralHeaderIncrementalIndexingWithName(
+          name, value);
+  DCHECK(result);
+  uint32 new_index = 0;
+  std::vector<uint32> removed_referenced_indices;
+  context_.ProcessLiteralHeaderWithIncrementalIndexing(
+      name, value, &new_index, &removed_referenced_indices);
+  if (new_index > 0)
+    context_.AddTouchesAt(new_index, 0);
+}
+
+void HpackEncoder::UpdateValueHistory(const HeaderSet& header_set) {
+  if (value_history_.size() + header_set.size() > kMaxValueHistorySize)
+    value_history_.clear();
+  for (HeaderSet::const_iterator it = header_set.begin();
+       it != header_set.end(); ++it) {
+    std::pair<ValueHistoryMap::iterator, bool> result =
+        value_history_.insert(std::make_pair(it->first, ValueHistory()));
+    ValueHistory* history = &result.first->second;
+    if (!result.second) {
+      if (history->last_value != it->second)
+        ++history->consecutive_changes;
+      else
+        history->consecutive_changes = 0;
+    }
+    history->last_value = it->second;
+  }
+}
+
 }  // namespace net
@@ -7,30 +7,93 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
 #include "net/spdy/hpack_encoding_context.h"
 
+// All section references below are to
+// http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
+// .
+
 namespace net {
 
+class HpackOutputStream;
+
 // An HpackEncoder encodes header sets as outlined in
 // http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
 // .
+//
+// Headers that are unchanged from the previous header set are left in
+// the reference set and cost nothing on the wire. Other headers are
+// added to the header table unless they are large relative to it, or
+// their value keeps changing from one header set to the next. String
+// literals are Huffman encoded whenever that makes them shorter, with
+// the code of a later draft (see HpackHuffmanCode()).
 class NET_EXPORT_PRIVATE HpackEncoder {
  public:
+  // A header whose value changed in this many consecutive header sets
+  // is not added to the header table anymore.
+  static const int kMaxConsecutiveValueChanges;
+
   explicit HpackEncoder(uint32 max_string_literal_size);
   ~HpackEncoder();
 
   // Encodes the given header set into the given string. Returns
-  // whether or not the encoding was successful.
+  // whether or not the encoding was successful. Encoding fails only
+  // if a header name or value is longer than the maximum string
+  // literal size, which is checked before anything is encoded, so on
+  // failure the encoding context is unchanged.
   bool EncodeHeaderSet(const std::map<std::string, std::string>& header_set,
                        std::string* output);
 
  private:
+  // What is known about the values a header name had in previous
+  // header sets.
+  struct ValueHistory {
+    ValueHistory() : consecutive_changes(0) {}
+
+    std::string last_value;
+    int consecutive_changes;
+  };
+
+  typedef std::map<std::string, ValueHistory> ValueHistoryMap;
+
+  // Returns the index of the first entry not in the reference set
+  // whose name and value match the given ones, considering only
+  // mutable entries if |mutable_only| is true, or 0 if there is none.
+  uint32 FindUnreferencedEntry(base::StringPiece name,
+                               base::StringPiece value,
+                               bool mutable_only) const;
+
+  // Returns the index of the first entry with the given name, or 0 if
+  // there is none.
+  uint32 FindName(base::StringPiece name) const;
+
+  // Returns whether the given header should be added to the header
+  // table.
+  bool ShouldIndex(base::StringPiece name, base::StringPiece value) const;
+
+  // Appends a representation of the given header to |output_stream|
+  // and updates the encoding context to match what the decoder will
+  // do with it. If |allow_indexing| is false, the header table is
+  // not modified, so no entry is evicted. The name and value must
+  // not be longer than the maximum string literal size.
+  void EncodeHeader(base::StringPiece name,
+                    base::StringPiece value,
+                    bool allow_indexing,
+                    HpackOutputStream* output_stream);
+
+  // Records the values of |header_set| for ShouldIndex().
+  void UpdateValueHistory(
+      const std::map<std::string, std::string>& header_set);
+
   const uint32 max_string_literal_size_;
   HpackEncodingContext context_;
+  ValueHistoryMap value_history_;
 
   DISALLOW_COPY_AND_ASSIGN(HpackEncoder);
 };
@@ -0,0 +1,159 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "net/spdy/hpack_decoder.h"
+#include "net/spdy/hpack_encoder.h"
+#include "net/spdy/hpack_output_stream.h"
+#include "net/spdy/spdy_header_block.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace net {
+
+namespace {
+
+typedef std::map<std::string, std::string> HeaderSet;
+
+// How many times the corpus is encoded or decoded for timing.
+const int kIterations = 2000;
+
+// Returns the request header sets of a typical page load: the page,
+// then its subresources, all on a single connection.
+std::vector<HeaderSet> MakePageLoadCorpus() {
+  const char* const kResources[][2] = {
+    { "/", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8" },
+    { "/static/css/main.css?v=20140212", "text/css,*/*;q=0.1" },
+    { "/static/css/widgets.css?v=20140212", "text/css,*/*;q=0.1" },
+    { "/static/js/jquery-1.10.2.min.js", "*/*" },
+    { "/static/js/app.js?v=20140212", "*/*" },
+    { "/static/js/analytics.js", "*/*" },
+    { "/static/img/logo.png", "image/webp,*/*;q=0.8" },
+    { "/static/img/sprite-2x.png", "image/webp,*/*;q=0.8" },
+    { "/static/img/banner/spring-sale.jpg", "image/webp,*/*;q=0.8" },
+    { "/static/fonts/opensans-regular.woff", "*/*" },
+    { "/api/v1/user/session", "application/json, text/javascript, */*" },
+    { "/api/v1/recommendations?count=12", "application/json, text/javascript, */*" },
+  };
+
+  std::vector<HeaderSet> corpus;
+  for (int pass = 0; pass < 3; ++pass) {
+    for (size_t i = 0; i < arraysize(kResources); ++i) {
+      HeaderSet header_set;
+      header_set[":method"] = "GET";
+      header_set[":scheme"] = "https";
+      header_set[":authority"] = "www.example.com";
+      header_set[":path"] = pass == 0 ? kResources[i][0] :
+          base::StringPrintf("%s#%d", kResources[i][0], pass);
+      header_set["accept"] = kResources[i][1];
+      header_set["accept-encoding"] = "gzip,deflate,sdch";
+      header_set["accept-language"] = "en-US,en;q=0.8";
+      header_set["user-agent"] =
+          "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+          "(KHTML, like Gecko) Chrome/33.0.1750.117 Safari/537.36";
+      header_set["cookie"] =
+          "SID=DQAAAPMAAAB4Nbe0XJ9kVZAk0Z1ZJ5t-3aF; "
+          "PREF=ID=5c1a3ca2c4a8d9b1:U=2ea1a9813e0a:FF=0:LD=en:TM=1390000000; "
+          "NID=67=ZMfIPKkVVYu3FBHRAjf8HxtLxiZqQ";
+      if (i > 0)
+        header_set["referer"] = "https://www.example.com/";
+      if (i >= 10)
+        header_set["x-requested-with"] = "XMLHttpRequest";
+      corpus.push_back(header_set);
+    }
+  }
+  return corpus;
+}
+
+// Encodes |header_set| the way HpackEncoder did before it indexed
+// anything: every header as a literal without indexing, with no
+// Huffman coding.
+bool EncodeLiterals(const HeaderSet& header_set, std::string* output) {
+  HpackOutputStream output_stream(kuint32max);
+  for (HeaderSet::const_iterator it = header_set.begin();
+       it != header_set.end(); ++it) {
+    if (!output_stream.AppendLiteralHeaderNoIndexingWithName(
+            it->first, it->second)) {
+      return false;
+    }
+  }
+  output_stream.TakeString(output);
+  return true;
+}
+
+TEST(HpackEncoderPerfTest, PageLoad) {
+  const std::vector<HeaderSet> corpus = MakePageLoadCorpus();
+
+  size_t plain_bytes = 0;
+  size_t literal_bytes = 0;
+  size_t encoded_bytes = 0;
+  std::vector<std::string> encoded_corpus;
+  {
+    HpackEncoder encoder(kuint32max);
+    for (size_t i = 0; i < corpus.size(); ++i) {
+      for (HeaderSet::const_iterator it = corpus[i].begin();
+           it != corpus[i].end(); ++it) {
+        plain_bytes += it->first.size() + it->second.size();
+      }
+
+      std::string literals;
+      ASSERT_TRUE(EncodeLiterals(corpus[i], &literals));
+      literal_bytes += literals.size();
+
+      std::string encoded;
+      ASSERT_TRUE(encoder.EncodeHeaderSet(corpus[i], &encoded));
+      encoded_bytes += encoded.size();
+      encoded_corpus.push_back(encoded);
+    }
+  }
+
+  perf_test::PrintResult("hpack_bytes", "", "plain", plain_bytes, "bytes",
+                         false);
+  perf_test::PrintResult("hpack_bytes", "", "literals", literal_bytes,
+                         "bytes", false);
+  perf_test::PrintResult("hpack_bytes", "", "encoded", encoded_bytes,
+                         "bytes", true);
+  perf_test::PrintResult("hpack_bytes_per_frame", "", "encoded",
+                         static_cast<double>(encoded_bytes) / corpus.size(),
+                         "bytes", true);
+
+  {
+    base::PerfTimeLogger timer(base::StringPrintf(
+        "Encode %d header frames",
+        static_cast<int>(kIterations * corpus.size())).c_str());
+    for (int i = 0; i < kIterations; ++i) {
+      HpackEncoder encoder(kuint32max);
+      std::string encoded;
+      for (size_t j = 0; j < corpus.size(); ++j)
+        ASSERT_TRUE(encoder.EncodeHeaderSet(corpus[j], &encoded));
+    }
+    timer.Done();
+  }
+
+  {
+    base::PerfTimeLogger timer(base::StringPrintf(
+        "Decode %d header frames",
+        static_cast<int>(kIterations * corpus.size())).c_str());
+    for (int i = 0; i < kIterations; ++i) {
+      HpackDecoder decoder(kuint32max);
+      SpdyHeaderBlock header_block;
+      for (size_t j = 0; j < encoded_corpus.size(); ++j) {
+        header_block.clear();
+        ASSERT_TRUE(
+            decoder.DecodeHeaderBlock(encoded_corpus[j], &header_block));
+      }
+    }
+    timer.Done();
+  }
+}
+
+}  // namespace
+
+}  // namespace net
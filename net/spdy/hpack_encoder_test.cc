@@ -7,6 +7,8 @@
 #include <map>
 #include <string>
 
+#include "net/spdy/hpack_decoder.h"
+#include "net/spdy/hpack_input_stream.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -15,8 +17,9 @@ namespace {
 
 using std::string;
 
-// Test that EncoderHeaderSet() simply encodes everything as literals
-// without indexing.
+// Test that EncodeHeaderSet() adds new headers to the header table
+// with Huffman-encoded literals, and removes stale ones from the
+// reference set with a single index 0 when nothing is kept.
 TEST(HpackEncoderTest, Basic) {
   HpackEncoder encoder(kuint32max);
 
@@ -26,17 +29,108 @@ TEST(HpackEncoderTest, Basic) {
 
   string encoded_header_set1;
   EXPECT_TRUE(encoder.EncodeHeaderSet(header_set1, &encoded_header_set1));
-  EXPECT_EQ("\x40\x05name1\x06value1"
-            "\x40\x05name2\x06value2", encoded_header_set1);
+  EXPECT_EQ(string("\x00\x84\xa8\x74\x94\x3f\x85\xee\x3a\x2d\x28\x7f"
+                   "\x00\x84\xa8\x74\x94\x5f\x85\xee\x3a\x2d\x28\xbf", 24),
+            encoded_header_set1);
 
   std::map<string, string> header_set2;
   header_set2["name2"] = "different-value";
   header_set2["name3"] = "value3";
 
+  // Clear the reference set, then reuse the name of entry #1
+  // (name2: value2).
   string encoded_header_set2;
   EXPECT_TRUE(encoder.EncodeHeaderSet(header_set2, &encoded_header_set2));
-  EXPECT_EQ("\x40\x05name2\x0f" "different-value"
-            "\x40\x05name3\x06value3", encoded_header_set2);
+  EXPECT_EQ(string("\x80"
+                   "\x01\x8b\x90\xd2\xca\x5b\x0b\x52\x56\xee\x3a\x2d\x2f"
+                   "\x00\x84\xa8\x74\x95\x9f\x85\xee\x3a\x2d\x2b\x3f", 26),
+            encoded_header_set2);
+}
+
+// Encodes |header_set| with |encoder|, decodes it with |decoder| and
+// checks that the result matches. Returns the encoded size.
+size_t RoundTrip(HpackEncoder* encoder,
+                 HpackDecoder* decoder,
+                 const std::map<string, string>& header_set) {
+  string encoded_header_set;
+  EXPECT_TRUE(encoder->EncodeHeaderSet(header_set, &encoded_header_set));
+  HpackHeaderPairVector header_list;
+  EXPECT_TRUE(decoder->DecodeHeaderSet(encoded_header_set, &header_list));
+  EXPECT_EQ(header_set.size(), header_list.size());
+  std::map<string, string> decoded_header_set(header_list.begin(),
+                                              header_list.end());
+  EXPECT_EQ(header_set, decoded_header_set);
+  return encoded_header_set.size();
+}
+
+// Headers repeated from the previous header set should cost nothing,
+// and removing one should cost a single octet.
+TEST(HpackEncoderTest, ReferenceSet) {
+  HpackEncoder encoder(kuint32max);
+  HpackDecoder decoder(kuint32max);
+
+  std::map<string, string> header_set;
+  header_set[":method"] = "GET";
+  header_set[":path"] = "/index.html";
+  header_set["user-agent"] = "Mozilla/5.0";
+  header_set["accept"] = "*/*";
+  EXPECT_LT(0u, RoundTrip(&encoder, &decoder, header_set));
+  EXPECT_EQ(0u, RoundTrip(&encoder, &decoder, header_set));
+
+  header_set.erase("accept");
+  EXPECT_EQ(1u, RoundTrip(&encoder, &decoder, header_set));
+
+  // A header that was added to the header table before is simply
+  // indexed.
+  header_set["accept"] = "*/*";
+  EXPECT_EQ(1u, RoundTrip(&encoder, &decoder, header_set));
+
+  header_set.clear();
+  EXPECT_EQ(1u, RoundTrip(&encoder, &decoder, header_set));
+}
+
+// Headers whose value keeps changing should stop being added to the
+// header table, and large headers should never be.
+TEST(HpackEncoderTest, IndexingHeuristics) {
+  HpackEncoder encoder(kuint32max);
+  HpackDecoder decoder(kuint32max);
+
+  std::map<string, string> header_set;
+  header_set["static"] = "value";
+  header_set["large"] = string(3000, 'x');
+  for (int i = 0; i < 5; ++i) {
+    header_set["changing"] = std::string(1, static_cast<char>('a' + i));
+    size_t size = RoundTrip(&encoder, &decoder, header_set);
+    if (i > 0) {
+      // "large" must be sent every time, while "static" must not.
+      EXPECT_LT(3000u / 2, size);
+      EXPECT_GT(3000u, size);
+    }
+  }
+
+  // "changing" isn't indexed anymore, so it is sent as a literal
+  // with an indexed name and a one-octet value. "large" was never
+  // indexed, so there is nothing to remove from the reference set.
+  header_set.erase("large");
+  EXPECT_EQ(3u, RoundTrip(&encoder, &decoder, header_set));
+}
+
+// Kept headers that get evicted by new ones should be sent again.
+TEST(HpackEncoderTest, KeptHeaderEvicted) {
+  HpackEncoder encoder(kuint32max);
+  HpackDecoder decoder(kuint32max);
+
+  std::map<string, string> header_set;
+  header_set["a"] = string(1000, 'a');
+  header_set["b"] = string(1000, 'b');
+  header_set["c"] = string(1000, 'c');
+  RoundTrip(&encoder, &decoder, header_set);
+
+  // Adding these evicts the entries for "a" and "b".
+  header_set["d"] = string(1000, 'd');
+  header_set["e"] = string(1000, 'e');
+  RoundTrip(&encoder, &decoder, header_set);
+  RoundTrip(&encoder, &decoder, header_set);
 }
 
 // Test that trying to encode a header set with a too-long header
@@ -54,6 +148,24 @@ TEST(HpackEncoderTest, HeaderTooLarge) {
   EXPECT_FALSE(encoder.EncodeHeaderSet(header_set, &encoded_header_set));
 }
 
+// Test that a failed encoding leaves the encoder in sync with the
+// decoder.
+TEST(HpackEncoderTest, FailureLeavesContextUnchanged) {
+  HpackEncoder encoder(10);
+  HpackDecoder decoder(10);
+
+  std::map<string, string> header_set;
+  header_set["name1"] = "value1";
+  RoundTrip(&encoder, &decoder, header_set);
+
+  header_set["name2"] = "too-long value";
+  string encoded_header_set;
+  EXPECT_FALSE(encoder.EncodeHeaderSet(header_set, &encoded_header_set));
+
+  header_set.erase("name2");
+  EXPECT_EQ(0u, RoundTrip(&encoder, &decoder, header_set));
+}
+
 }  // namespace
 
 }  // namespace net
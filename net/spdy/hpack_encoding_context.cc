@@ -164,6 +164,10 @@ void HpackEncodingContext::ClearTouchesAt(uint32 index) {
   header_table_.GetMutableEntry(index)->ClearTouches();
 }
 
+uint32 HpackEncodingContext::GetMaxSize() const {
+  return header_table_.max_size();
+}
+
 void HpackEncodingContext::SetMaxSize(uint32 max_size) {
   header_table_.SetMaxSize(max_size);
 }
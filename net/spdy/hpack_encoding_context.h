@@ -69,6 +69,9 @@ class NET_EXPORT_PRIVATE HpackEncodingContext {
   // kUntouched.
   void ClearTouchesAt(uint32 index);
 
+  // Returns the maximum size of the header table.
+  uint32 GetMaxSize() const;
+
   // Sets the maximum size of the encoding text, evicting entries if
   // necessary.
   void SetMaxSize(uint32 max_size);
@@ -0,0 +1,188 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_huffman_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "base/logging.h"
+
+namespace net {
+
+using base::StringPiece;
+using std::string;
+
+namespace {
+
+const uint8 kMaxCodeLength = 32;
+
+// Orders symbols canonically: by code length, then by id.
+bool SymbolLengthAndIdLessThan(const HpackHuffmanSymbol& a,
+                               const HpackHuffmanSymbol& b) {
+  if (a.length != b.length)
+    return a.length < b.length;
+  return a.id < b.id;
+}
+
+// Returns the left-justified mask of the top |length| bits.
+uint32 LeftJustifiedMask(uint8 length) {
+  return length == 0 ? 0 : kuint32max << (kMaxCodeLength - length);
+}
+
+}  // namespace
+
+HpackHuffmanTable::HpackHuffmanTable() : max_length_(0) {
+  memset(min_lengths_by_octet_, 0, sizeof(min_lengths_by_octet_));
+}
+
+HpackHuffmanTable::~HpackHuffmanTable() {}
+
+bool HpackHuffmanTable::Initialize(const HpackHuffmanSymbol* input_symbols,
+                                   size_t symbol_count) {
+  CHECK(!IsInitialized());
+  if (symbol_count != kHpackHuffmanEosId + 1u)
+    return false;
+
+  std::vector<HpackHuffmanSymbol> symbols(input_symbols,
+                                          input_symbols + symbol_count);
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    const HpackHuffmanSymbol& symbol = symbols[i];
+    if (symbol.id != i || symbol.length == 0 ||
+        symbol.length > kMaxCodeLength ||
+        (symbol.code & ~LeftJustifiedMask(symbol.length)) != 0) {
+      return false;
+    }
+  }
+  const HpackHuffmanSymbol& eos = symbols.back();
+  if (eos.code != LeftJustifiedMask(eos.length))
+    return false;
+
+  std::stable_sort(symbols.begin(), symbols.end(), SymbolLengthAndIdLessThan);
+
+  std::vector<uint32> first_codes(kMaxCodeLength + 1, 0);
+  std::vector<uint64> limits(kMaxCodeLength + 1, 0);
+  std::vector<uint16> first_indices(kMaxCodeLength + 1, 0);
+  std::vector<uint16> decode_ids(symbols.size());
+
+  // Each code must pick up where the previous one left off, with
+  // nothing left over at the end.
+  uint64 next_code = 0;
+  uint8 length = 0;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    const HpackHuffmanSymbol& symbol = symbols[i];
+    if (symbol.code != next_code)
+      return false;
+    while (length < symbol.length) {
+      limits[length] = next_code;
+      ++length;
+      first_codes[length] = symbol.code;
+      first_indices[length] = static_cast<uint16>(i);
+    }
+    decode_ids[i] = symbol.id;
+    next_code += GG_UINT64_C(1) << (kMaxCodeLength - symbol.length);
+  }
+  if (next_code != GG_UINT64_C(1) << kMaxCodeLength)
+    return false;
+  limits[length] = next_code;
+
+  codes_.resize(symbols.size());
+  lengths_.resize(symbols.size());
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    codes_[symbols[i].id] = symbols[i].code;
+    lengths_[symbols[i].id] = symbols[i].length;
+  }
+  first_codes_.swap(first_codes);
+  limits_.swap(limits);
+  first_indices_.swap(first_indices);
+  decode_ids_.swap(decode_ids);
+  max_length_ = length;
+
+  uint8 min_length = 1;
+  for (size_t octet = 0; octet < arraysize(min_lengths_by_octet_); ++octet) {
+    const uint64 window = static_cast<uint64>(octet) << (kMaxCodeLength - 8);
+    while (window >= limits_[min_length])
+      ++min_length;
+    min_lengths_by_octet_[octet] = min_length;
+  }
+  return true;
+}
+
+bool HpackHuffmanTable::IsInitialized() const {
+  return max_length_ != 0;
+}
+
+void HpackHuffmanTable::EncodeString(StringPiece in, string* out) const {
+  DCHECK(IsInitialized());
+  // The pending bits, left-justified. Fewer than eight are pending
+  // before each symbol is added, so 64 bits always have room.
+  uint64 bits = 0;
+  size_t bit_count = 0;
+  for (size_t i = 0; i < in.size(); ++i) {
+    const uint8 symbol = static_cast<uint8>(in[i]);
+    bits |= static_cast<uint64>(codes_[symbol]) << (kMaxCodeLength - bit_count);
+    bit_count += lengths_[symbol];
+    while (bit_count >= 8) {
+      out->push_back(static_cast<char>(bits >> 56));
+      bits <<= 8;
+      bit_count -= 8;
+    }
+  }
+  if (bit_count > 0) {
+    // Pad with the prefix of the end-of-string code.
+    out->push_back(static_cast<char>((bits >> 56) | (0xff >> bit_count)));
+  }
+}
+
+size_t HpackHuffmanTable::EncodedSize(StringPiece in) const {
+  DCHECK(IsInitialized());
+  size_t bit_count = 0;
+  for (size_t i = 0; i < in.size(); ++i)
+    bit_count += lengths_[static_cast<uint8>(in[i])];
+  return (bit_count + 7) / 8;
+}
+
+bool HpackHuffmanTable::DecodeString(StringPiece in,
+                                     size_t out_capacity,
+                                     string* out) const {
+  DCHECK(IsInitialized());
+  out->clear();
+  // The bits not decoded yet, left-justified.
+  uint64 bits = 0;
+  size_t bit_count = 0;
+  size_t next_octet = 0;
+  while (true) {
+    while (bit_count <= 56 && next_octet < in.size()) {
+      bits |= static_cast<uint64>(static_cast<uint8>(in[next_octet++])) <<
+          (56 - bit_count);
+      bit_count += 8;
+    }
+    if (bit_count == 0)
+      return true;
+    // The input is exhausted if fewer than eight bits are left. No
+    // code that short is all ones, so ones must be padding.
+    if (bit_count < 8 &&
+        (bits >> (64 - bit_count)) == (GG_UINT64_C(1) << bit_count) - 1) {
+      return true;
+    }
+
+    const uint32 window = static_cast<uint32>(bits >> 32);
+    size_t length = min_lengths_by_octet_[window >> 24];
+    while (window >= limits_[length])
+      ++length;
+    DCHECK_LE(length, max_length_);
+    if (length > bit_count)
+      return false;
+
+    const uint16 id = decode_ids_[first_indices_[length] +
+        ((window - first_codes_[length]) >> (kMaxCodeLength - length))];
+    if (id == kHpackHuffmanEosId || out->size() >= out_capacity)
+      return false;
+    out->push_back(static_cast<char>(id));
+    bits <<= length;
+    bit_count -= length;
+  }
+}
+
+}  // namespace net
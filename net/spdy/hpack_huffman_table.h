@@ -0,0 +1,86 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SPDY_HPACK_HUFFMAN_TABLE_H_
+#define NET_SPDY_HPACK_HUFFMAN_TABLE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+#include "net/spdy/hpack_constants.h"  // For HpackHuffmanSymbol.
+
+// All section references below are to
+// http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
+// .
+
+namespace net {
+
+// An HpackHuffmanTable encodes and decodes string literals with a
+// canonical Huffman code (see 4.1.2). Octets are symbols 0 to 255,
+// and the last symbol is the end-of-string marker, whose code must be
+// all ones; its prefix is used to pad the last octet.
+class NET_EXPORT_PRIVATE HpackHuffmanTable {
+ public:
+  HpackHuffmanTable();
+  ~HpackHuffmanTable();
+
+  // Prepares the table for use with the given code. |input_symbols|
+  // must hold |symbol_count| == 257 symbols, ordered by id. Returns
+  // false, leaving the table unusable, if the code is not canonical
+  // or the end-of-string code isn't all ones.
+  bool Initialize(const HpackHuffmanSymbol* input_symbols,
+                  size_t symbol_count);
+
+  // Returns whether Initialize() has succeeded.
+  bool IsInitialized() const;
+
+  // Appends the encoding of |in| to |out|, padded to a whole octet.
+  void EncodeString(base::StringPiece in, std::string* out) const;
+
+  // Returns the number of octets EncodeString() would append for
+  // |in|.
+  size_t EncodedSize(base::StringPiece in) const;
+
+  // Decodes |in| into |out|, replacing its contents. Returns false if
+  // |in| is not a valid encoding: it is truncated, holds the
+  // end-of-string symbol, is padded with more than seven bits or with
+  // anything other than ones, or decodes to more than |out_capacity|
+  // octets.
+  bool DecodeString(base::StringPiece in,
+                    size_t out_capacity,
+                    std::string* out) const;
+
+ private:
+  // Left-justified codes and their lengths, indexed by symbol id.
+  std::vector<uint32> codes_;
+  std::vector<uint8> lengths_;
+
+  // For canonical decoding, indexed by code length: the
+  // left-justified first code of that length, the limit (as a 33-bit
+  // value) below which a left-justified 32-bit window holds a code of
+  // at most that length, and the index in |decode_ids_| of the
+  // symbol with the first code.
+  std::vector<uint32> first_codes_;
+  std::vector<uint64> limits_;
+  std::vector<uint16> first_indices_;
+
+  // Symbol ids in canonical order.
+  std::vector<uint16> decode_ids_;
+
+  // The shortest code length that can start with each octet, so that
+  // decoding doesn't have to check every length.
+  uint8 min_lengths_by_octet_[256];
+
+  uint8 max_length_;
+
+  DISALLOW_COPY_AND_ASSIGN(HpackHuffmanTable);
+};
+
+}  // namespace net
+
+#endif  // NET_SPDY_HPACK_HUFFMAN_TABLE_H_
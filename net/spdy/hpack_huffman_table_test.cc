@@ -0,0 +1,166 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_huffman_table.h"
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/spdy/hpack_constants.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+using std::string;
+
+// Returns |hex| as octets.
+string DecodeHex(const string& hex) {
+  std::vector<uint8> bytes;
+  EXPECT_TRUE(base::HexStringToBytes(hex, &bytes));
+  return string(bytes.begin(), bytes.end());
+}
+
+// The static code should be accepted, and the shared table should be
+// initialized with it.
+TEST(HpackHuffmanTableTest, InitializeStaticCode) {
+  std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+  ASSERT_EQ(kHpackHuffmanEosId + 1u, code.size());
+
+  HpackHuffmanTable table;
+  EXPECT_FALSE(table.IsInitialized());
+  EXPECT_TRUE(table.Initialize(&code[0], code.size()));
+  EXPECT_TRUE(table.IsInitialized());
+  EXPECT_TRUE(ObtainHpackHuffmanTable().IsInitialized());
+}
+
+// Codes that aren't canonical, or don't end with an all-ones
+// end-of-string code, should be rejected.
+TEST(HpackHuffmanTableTest, InitializeInvalidCode) {
+  {
+    // Swap the codes of two symbols with different lengths.
+    std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+    std::swap(code['a'].code, code['z'].code);
+    std::swap(code['a'].length, code['z'].length);
+    HpackHuffmanTable table;
+    EXPECT_FALSE(table.Initialize(&code[0], code.size()));
+    EXPECT_FALSE(table.IsInitialized());
+  }
+  {
+    // Leave a hole in the code space.
+    std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+    code[kHpackHuffmanEosId].length = 31;
+    code[kHpackHuffmanEosId].code = 0xfffffffe;
+    HpackHuffmanTable table;
+    EXPECT_FALSE(table.Initialize(&code[0], code.size()));
+  }
+  {
+    // Ids out of order.
+    std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+    code[1].id = 2;
+    HpackHuffmanTable table;
+    EXPECT_FALSE(table.Initialize(&code[0], code.size()));
+  }
+  {
+    // Too few symbols.
+    std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+    HpackHuffmanTable table;
+    EXPECT_FALSE(table.Initialize(&code[0], code.size() - 1));
+  }
+}
+
+// The examples from the spec should encode and decode as expected.
+TEST(HpackHuffmanTableTest, SpecExamples) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  const char* const kExamples[][2] = {
+    { "www.example.com", "f1e3c2e5f23a6ba0ab90f4ff" },
+    { "no-cache", "a8eb10649cbf" },
+    { "custom-key", "25a849e95ba97d7f" },
+    { "custom-value", "25a849e95bb8e8b4bf" },
+    { "302", "6402" },
+    { "private", "aec3771a4b" },
+  };
+  for (size_t i = 0; i < arraysize(kExamples); ++i) {
+    const string plain = kExamples[i][0];
+    const string encoded = DecodeHex(kExamples[i][1]);
+
+    string out;
+    table.EncodeString(plain, &out);
+    EXPECT_EQ(encoded, out) << plain;
+    EXPECT_EQ(encoded.size(), table.EncodedSize(plain)) << plain;
+
+    EXPECT_TRUE(table.DecodeString(encoded, plain.size(), &out)) << plain;
+    EXPECT_EQ(plain, out);
+  }
+}
+
+// Every octet should make it through an encode and decode.
+TEST(HpackHuffmanTableTest, RoundTripAllOctets) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string plain;
+  for (int i = 0; i < 256; ++i)
+    plain.push_back(static_cast<char>(i));
+  plain.append(plain.rbegin(), plain.rend());
+
+  string encoded;
+  table.EncodeString(plain, &encoded);
+  EXPECT_EQ(encoded.size(), table.EncodedSize(plain));
+
+  // Decoding replaces the contents of the output.
+  string decoded = "garbage";
+  EXPECT_TRUE(table.DecodeString(encoded, plain.size(), &decoded));
+  EXPECT_EQ(plain, decoded);
+
+  // Also try every prefix, which exercises all padding lengths.
+  for (size_t size = 0; size < 64; ++size) {
+    encoded.clear();
+    table.EncodeString(plain.substr(0, size), &encoded);
+    EXPECT_TRUE(table.DecodeString(encoded, size, &decoded));
+    EXPECT_EQ(plain.substr(0, size), decoded);
+  }
+}
+
+// Padding must be shorter than an octet and all ones.
+TEST(HpackHuffmanTableTest, InvalidPadding) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string out;
+
+  // "no-cache" takes 43 bits, padded with five ones.
+  EXPECT_TRUE(table.DecodeString(DecodeHex("a8eb10649cbf"), 8, &out));
+  EXPECT_EQ("no-cache", out);
+  EXPECT_FALSE(table.DecodeString(DecodeHex("a8eb10649cbe"), 8, &out));
+
+  // A whole octet of padding.
+  EXPECT_FALSE(table.DecodeString(DecodeHex("a8eb10649cbfff"), 8, &out));
+
+  // A truncated code.
+  EXPECT_FALSE(table.DecodeString(DecodeHex("fe"), 1, &out));
+}
+
+// The end-of-string symbol must not be decoded.
+TEST(HpackHuffmanTableTest, RejectEndOfString) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string out;
+  // The 30-bit end-of-string code, padded with ones.
+  EXPECT_FALSE(table.DecodeString(DecodeHex("ffffffff"), 1, &out));
+  // The same, after "302", which takes exactly two octets.
+  EXPECT_FALSE(table.DecodeString(DecodeHex("6402ffffffff"), 4, &out));
+}
+
+// Decoding to more than the given capacity should fail.
+TEST(HpackHuffmanTableTest, DecodeCapacity) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  const string encoded = DecodeHex("a8eb10649cbf");
+  string out;
+  EXPECT_TRUE(table.DecodeString(encoded, 8, &out));
+  EXPECT_EQ("no-cache", out);
+  EXPECT_FALSE(table.DecodeString(encoded, 7, &out));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -6,6 +6,7 @@
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "net/spdy/hpack_huffman_table.h"
 
 namespace net {
 
@@ -90,9 +91,8 @@ bool HpackInputStream::DecodeNextUint32(uint32* I) {
   return !has_more;
 }
 
-// TODO(akalin): Figure out how to handle the storage for
-// Huffman-encoded sequences.
-bool HpackInputStream::DecodeNextStringLiteral(StringPiece* str) {
+bool HpackInputStream::DecodeNextStringLiteral(StringPiece* str,
+                                               std::string* huffman_buffer) {
   if (MatchPrefixAndConsume(kStringLiteralIdentityEncoded)) {
     uint32 size = 0;
     if (!DecodeNextUint32(&size))
@@ -109,7 +109,24 @@ bool HpackInputStream::DecodeNextStringLiteral(StringPiece* str) {
     return true;
   }
 
-  // TODO(akalin): Handle Huffman-encoded sequences.
+  if (MatchPrefixAndConsume(kStringLiteralHuffmanEncoded)) {
+    uint32 encoded_size = 0;
+    if (!DecodeNextUint32(&encoded_size))
+      return false;
+
+    if (encoded_size > buffer_.size())
+      return false;
+
+    // The decoded size is what |max_string_literal_size_| limits.
+    if (!ObtainHpackHuffmanTable().DecodeString(
+            StringPiece(buffer_.data(), encoded_size),
+            max_string_literal_size_, huffman_buffer)) {
+      return false;
+    }
+    *str = StringPiece(*huffman_buffer);
+    buffer_.remove_prefix(encoded_size);
+    return true;
+  }
 
   return false;
 }
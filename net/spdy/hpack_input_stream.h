@@ -46,7 +46,12 @@ class NET_EXPORT_PRIVATE HpackInputStream {
   // decoding was successful, or false if an error was encountered.
 
   bool DecodeNextUint32(uint32* I);
-  bool DecodeNextStringLiteral(base::StringPiece* str);
+
+  // An identity-encoded string literal is returned in place, pointing
+  // into the buffer. A Huffman-encoded one is decoded into
+  // |huffman_buffer|, which |str| then points to.
+  bool DecodeNextStringLiteral(base::StringPiece* str,
+                               std::string* huffman_buffer);
 
   // Accessors for testing.
 
@@ -58,8 +63,9 @@ class NET_EXPORT_PRIVATE HpackInputStream {
     return DecodeNextUint32(I);
   }
 
-  bool DecodeNextStringLiteralForTest(base::StringPiece *str) {
-    return DecodeNextStringLiteral(str);
+  bool DecodeNextStringLiteralForTest(base::StringPiece* str,
+                                      std::string* huffman_buffer) {
+    return DecodeNextStringLiteral(str, huffman_buffer);
   }
 
  private:
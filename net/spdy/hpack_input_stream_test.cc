@@ -459,7 +459,9 @@ TEST(HpackInputStreamTest, DecodeNextStringLiteral) {
 
   EXPECT_TRUE(input_stream.HasMoreData());
   StringPiece string_piece;
-  EXPECT_TRUE(input_stream.DecodeNextStringLiteralForTest(&string_piece));
+  string huffman_buffer;
+  EXPECT_TRUE(input_stream.DecodeNextStringLiteralForTest(&string_piece,
+                                                          &huffman_buffer));
   EXPECT_EQ("string literal", string_piece);
   EXPECT_FALSE(input_stream.HasMoreData());
 }
@@ -471,7 +473,9 @@ TEST(HpackInputStreamTest, DecodeNextStringLiteralSizeLimit) {
 
   EXPECT_TRUE(input_stream.HasMoreData());
   StringPiece string_piece;
-  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece));
+  string huffman_buffer;
+  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece,
+                                                           &huffman_buffer));
 }
 
 // Decoding an encoded string literal with size larger than the
@@ -482,7 +486,36 @@ TEST(HpackInputStreamTest, DecodeNextStringLiteralInvalidSize) {
 
   EXPECT_TRUE(input_stream.HasMoreData());
   StringPiece string_piece;
-  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece));
+  string huffman_buffer;
+  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece,
+                                                           &huffman_buffer));
+}
+
+// Decoding a valid Huffman-encoded string literal should decode it
+// into the given buffer.
+TEST(HpackInputStreamTest, DecodeNextHuffmanStringLiteral) {
+  HpackInputStream input_stream(
+      kuint32max, "\x8c\xf1\xe3\xc2\xe5\xf2\x3a\x6b\xa0\xab\x90\xf4\xff");
+
+  StringPiece string_piece;
+  string huffman_buffer;
+  EXPECT_TRUE(input_stream.DecodeNextStringLiteralForTest(&string_piece,
+                                                          &huffman_buffer));
+  EXPECT_EQ("www.example.com", string_piece);
+  EXPECT_EQ(huffman_buffer.data(), string_piece.data());
+  EXPECT_FALSE(input_stream.HasMoreData());
+}
+
+// The size limit applies to the decoded size of a Huffman-encoded
+// string literal.
+TEST(HpackInputStreamTest, DecodeNextHuffmanStringLiteralSizeLimit) {
+  HpackInputStream input_stream(
+      14, "\x8c\xf1\xe3\xc2\xe5\xf2\x3a\x6b\xa0\xab\x90\xf4\xff");
+
+  StringPiece string_piece;
+  string huffman_buffer;
+  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece,
+                                                           &huffman_buffer));
 }
 
 }  // namespace
@@ -5,6 +5,7 @@
 #include "net/spdy/hpack_output_stream.h"
 
 #include "base/logging.h"
+#include "net/spdy/hpack_huffman_table.h"
 
 using base::StringPiece;
 
@@ -14,6 +15,7 @@ using std::string;
 
 HpackOutputStream::HpackOutputStream(uint32 max_string_literal_size)
     : max_string_literal_size_(max_string_literal_size),
+      huffman_table_(NULL),
       bit_offset_(0) {}
 
 HpackOutputStream::~HpackOutputStream() {}
@@ -23,15 +25,28 @@ void HpackOutputStream::AppendIndexedHeader(uint32 index_or_zero) {
   AppendUint32(index_or_zero);
 }
 
+bool HpackOutputStream::AppendLiteralHeaderNoIndexingWithIndexedName(
+    uint32 name_index, StringPiece value) {
+  DCHECK_GT(name_index, 0u);
+  return AppendLiteralHeader(
+      kLiteralNoIndexOpcode, name_index, StringPiece(), value);
+}
+
 bool HpackOutputStream::AppendLiteralHeaderNoIndexingWithName(
     StringPiece name, StringPiece value) {
-  AppendPrefix(kLiteralNoIndexOpcode);
-  AppendBits(0x0, 8 - kLiteralNoIndexOpcode.bit_size);
-  if (!AppendStringLiteral(name))
-    return false;
-  if (!AppendStringLiteral(value))
-    return false;
-  return true;
+  return AppendLiteralHeader(kLiteralNoIndexOpcode, 0, name, value);
+}
+
+bool HpackOutputStream::AppendLiteralHeaderIncrementalIndexingWithIndexedName(
+    uint32 name_index, StringPiece value) {
+  DCHECK_GT(name_index, 0u);
+  return AppendLiteralHeader(
+      kLiteralIncrementalIndexOpcode, name_index, StringPiece(), value);
+}
+
+bool HpackOutputStream::AppendLiteralHeaderIncrementalIndexingWithName(
+    StringPiece name, StringPiece value) {
+  return AppendLiteralHeader(kLiteralIncrementalIndexOpcode, 0, name, value);
 }
 
 void HpackOutputStream::TakeString(string* output) {
@@ -69,6 +84,19 @@ void HpackOutputStream::AppendPrefix(HpackPrefix prefix) {
   AppendBits(prefix.bits, prefix.bit_size);
 }
 
+bool HpackOutputStream::AppendLiteralHeader(HpackPrefix opcode,
+                                            uint32 name_index_or_zero,
+                                            StringPiece name,
+                                            StringPiece value) {
+  AppendPrefix(opcode);
+  AppendUint32(name_index_or_zero);
+  if (name_index_or_zero == 0 && !AppendStringLiteral(name))
+    return false;
+  if (!AppendStringLiteral(value))
+    return false;
+  return true;
+}
+
 void HpackOutputStream::AppendUint32(uint32 I) {
   // The algorithm below is adapted from the pseudocode in 4.1.1.
   size_t N = 8 - bit_offset_;
@@ -88,10 +116,18 @@ void HpackOutputStream::AppendUint32(uint32 I) {
 
 bool HpackOutputStream::AppendStringLiteral(base::StringPiece str) {
   DCHECK_EQ(bit_offset_, 0u);
-  // TODO(akalin): Implement Huffman encoding.
-  AppendPrefix(kStringLiteralIdentityEncoded);
   if (str.size() > max_string_literal_size_)
     return false;
+  if (huffman_table_) {
+    size_t encoded_size = huffman_table_->EncodedSize(str);
+    if (encoded_size < str.size()) {
+      AppendPrefix(kStringLiteralHuffmanEncoded);
+      AppendUint32(static_cast<uint32>(encoded_size));
+      huffman_table_->EncodeString(str, &buffer_);
+      return true;
+    }
+  }
+  AppendPrefix(kStringLiteralIdentityEncoded);
   AppendUint32(static_cast<uint32>(str.size()));
   buffer_.append(str.data(), str.size());
   return true;
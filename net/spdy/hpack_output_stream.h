@@ -21,6 +21,8 @@
 
 namespace net {
 
+class HpackHuffmanTable;
+
 // An HpackOutputStream handles all the low-level details of encoding
 // header fields.
 class NET_EXPORT_PRIVATE HpackOutputStream {
@@ -30,15 +32,41 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   explicit HpackOutputStream(uint32 max_string_literal_size);
   ~HpackOutputStream();
 
+  // If |huffman_table| is not NULL, string literals are Huffman
+  // encoded with it whenever that makes them shorter. The table must
+  // outlive this stream.
+  void set_huffman_table(const HpackHuffmanTable* huffman_table) {
+    huffman_table_ = huffman_table;
+  }
+
   // Corresponds to 4.2.
   void AppendIndexedHeader(uint32 index_or_zero);
 
+  // Corresponds to 4.3.1 (first form). Returns whether or not the
+  // append was successful; if the append was unsuccessful, no other
+  // member function may be called.
+  bool AppendLiteralHeaderNoIndexingWithIndexedName(uint32 name_index,
+                                                    base::StringPiece value);
+
   // Corresponds to 4.3.1 (second form). Returns whether or not the
   // append was successful; if the append was unsuccessful, no other
   // member function may be called.
   bool AppendLiteralHeaderNoIndexingWithName(base::StringPiece name,
                                              base::StringPiece value);
 
+  // Corresponds to 4.3.2 (first form). Returns whether or not the
+  // append was successful; if the append was unsuccessful, no other
+  // member function may be called.
+  bool AppendLiteralHeaderIncrementalIndexingWithIndexedName(
+      uint32 name_index,
+      base::StringPiece value);
+
+  // Corresponds to 4.3.2 (second form). Returns whether or not the
+  // append was successful; if the append was unsuccessful, no other
+  // member function may be called.
+  bool AppendLiteralHeaderIncrementalIndexingWithName(base::StringPiece name,
+                                                      base::StringPiece value);
+
   // Moves the internal buffer to the given string and clears all
   // internal state.
   void TakeString(std::string* output);
@@ -67,6 +95,14 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   // Simply forwards to AppendBits(prefix.bits, prefix.bit-size).
   void AppendPrefix(HpackPrefix prefix);
 
+  // Appends a literal header with the given opcode (4.3.1 and 4.3.2),
+  // with the name taken from |name_index_or_zero| or, if that is 0,
+  // from |name|.
+  bool AppendLiteralHeader(HpackPrefix opcode,
+                           uint32 name_index_or_zero,
+                           base::StringPiece name,
+                           base::StringPiece value);
+
   // Appends the given integer using the representation described in
   // 4.1.1. If the internal buffer ends on a byte boundary, the prefix
   // length N is taken to be 8; otherwise, it is taken to be the
@@ -77,7 +113,8 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   void AppendUint32(uint32 I);
 
   // Appends the given string using the representation described in
-  // 4.1.2. The internal buffer must end on a byte boundary, and it is
+  // 4.1.2, Huffman encoded if there is a Huffman table and that is
+  // shorter. The internal buffer must end on a byte boundary, and it is
   // guaranteed that the internal buffer will end on a byte boundary
   // after this function is called. Returns whether or not the append
   // was successful; if the append was unsuccessful, no other member
@@ -85,6 +122,7 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   bool AppendStringLiteral(base::StringPiece str);
 
   const uint32 max_string_literal_size_;
+  const HpackHuffmanTable* huffman_table_;
 
   // The internal bit buffer.
   std::string buffer_;
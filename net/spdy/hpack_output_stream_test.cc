@@ -7,6 +7,7 @@
 #include <cstddef>
 
 #include "base/basictypes.h"
+#include "net/spdy/hpack_constants.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -258,6 +259,22 @@ TEST(HpackOutputStreamTest, AppendStringLiteralNoHuffmanEncoding) {
   EXPECT_EQ(string("\x7f\x00", 2) + literal, str);
 }
 
+// Test that with a Huffman table, a string literal is Huffman encoded
+// when that is shorter, and left alone otherwise.
+TEST(HpackOutputStreamTest, AppendStringLiteralHuffmanEncoding) {
+  HpackOutputStream output_stream(kuint32max);
+  output_stream.set_huffman_table(&ObtainHpackHuffmanTable());
+
+  EXPECT_TRUE(output_stream.AppendStringLiteralForTest("www.example.com"));
+  // Control characters have long codes.
+  EXPECT_TRUE(output_stream.AppendStringLiteralForTest("\x01\x02"));
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ("\x8c\xf1\xe3\xc2\xe5\xf2\x3a\x6b\xa0\xab\x90\xf4\xff"
+            "\x02\x01\x02", str);
+}
+
 // Test that trying to encode a too-long string literal will fail.
 TEST(HpackOutputStreamTest, AppendStringLiteralTooLong) {
   HpackOutputStream output_stream(kuint32max - 1);
@@ -288,6 +305,36 @@ TEST(HpackOutputStreamTest, AppendLiteralHeaderNoIndexingWithName) {
   EXPECT_EQ("\x40\x04name\x05value", str);
 }
 
+// Test that encoding a literal header without indexing with an
+// indexed name encodes the index with a 6-bit prefix and the value as
+// a string literal.
+TEST(HpackOutputStreamTest, AppendLiteralHeaderNoIndexingWithIndexedName) {
+  HpackOutputStream output_stream(kuint32max);
+  EXPECT_TRUE(output_stream.AppendLiteralHeaderNoIndexingWithIndexedName(
+      0x04, "/sample/path"));
+  EXPECT_TRUE(output_stream.AppendLiteralHeaderNoIndexingWithIndexedName(
+      0x3f, "value"));
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ(string("\x44\x0c/sample/path\x7f\x00\x05value", 22), str);
+}
+
+// Test that encoding a literal header with incremental indexing uses
+// the 0 opcode bits, with either an indexed name or a literal one.
+TEST(HpackOutputStreamTest, AppendLiteralHeaderIncrementalIndexing) {
+  HpackOutputStream output_stream(kuint32max);
+  EXPECT_TRUE(
+      output_stream.AppendLiteralHeaderIncrementalIndexingWithIndexedName(
+          0x04, "/sample/path"));
+  EXPECT_TRUE(output_stream.AppendLiteralHeaderIncrementalIndexingWithName(
+      "name", "value"));
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ(string("\x04\x0c/sample/path\x00\x04name\x05value", 26), str);
+}
+
 // Test that trying to encode a header with a too-long header name or
 // value will fail.
 TEST(HpackOutputStreamTest, AppendLiteralHeaderNoIndexingWithNameTooLong) {
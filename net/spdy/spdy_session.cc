@@ -5,6 +5,7 @@
 #include "net/spdy/spdy_session.h"
 
 #include <algorithm>
+#include <cstring>
 #include <map>
 
 #include "base/basictypes.h"
@@ -425,6 +426,17 @@ SpdySession::PushedStreamInfo::PushedStreamInfo(
 
 SpdySession::PushedStreamInfo::~PushedStreamInfo() {}
 
+SpdySession::InFlightWrite::InFlightWrite(
+    SpdyFrameType frame_type,
+    scoped_ptr<SpdyBuffer> buffer,
+    const base::WeakPtr<SpdyStream>& stream)
+    : frame_type(frame_type),
+      buffer(buffer.Pass()),
+      frame_size(this->buffer->GetRemainingSize()),
+      stream(stream) {}
+
+SpdySession::InFlightWrite::~InFlightWrite() {}
+
 SpdySession::SpdySession(
     const SpdySessionKey& spdy_session_key,
     const base::WeakPtr<HttpServerProperties>& http_server_properties,
@@ -446,8 +458,8 @@ SpdySession::SpdySession(
       http_server_properties_(http_server_properties),
       read_buffer_(new IOBuffer(kReadBufferSize)),
       stream_hi_water_mark_(kFirstStreamId),
-      in_flight_write_frame_type_(DATA),
-      in_flight_write_frame_size_(0),
+      write_buffer_used_(0),
+      write_buffer_offset_(0),
       is_secure_(false),
       certificate_error_code_(OK),
       availability_state_(STATE_AVAILABLE),
@@ -1347,44 +1359,15 @@ int SpdySession::DoWrite() {
   DCHECK_NE(availability_state_, STATE_CLOSED);
 
   DCHECK(buffered_spdy_framer_);
-  if (in_flight_write_) {
-    DCHECK_GT(in_flight_write_->GetRemainingSize(), 0u);
-  } else {
-    // Grab the next frame to send.
-    SpdyFrameType frame_type = DATA;
-    scoped_ptr<SpdyBufferProducer> producer;
-    base::WeakPtr<SpdyStream> stream;
-    if (!write_queue_.Dequeue(&frame_type, &producer, &stream)) {
+  if (in_flight_writes_.empty()) {
+    // Grab the next frames to send.
+    int rv = DequeueWrites();
+    if (rv != OK)
+      return rv;
+    if (in_flight_writes_.empty()) {
       write_state_ = WRITE_STATE_IDLE;
       return ERR_IO_PENDING;
     }
-
-    if (stream.get())
-      DCHECK(!stream->IsClosed());
-
-    // Activate the stream only when sending the SYN_STREAM frame to
-    // guarantee monotonically-increasing stream IDs.
-    if (frame_type == SYN_STREAM) {
-      if (stream.get() && stream->stream_id() == 0) {
-        scoped_ptr<SpdyStream> owned_stream =
-            ActivateCreatedStream(stream.get());
-        InsertActivatedStream(owned_stream.Pass());
-      } else {
-        NOTREACHED();
-        return ERR_UNEXPECTED;
-      }
-    }
-
-    in_flight_write_ = producer->ProduceBuffer();
-    if (!in_flight_write_) {
-      NOTREACHED();
-      return ERR_UNEXPECTED;
-    }
-    in_flight_write_frame_type_ = frame_type;
-    in_flight_write_frame_size_ = in_flight_write_->GetRemainingSize();
-    DCHECK_GE(in_flight_write_frame_size_,
-              buffered_spdy_framer_->GetFrameMinimumSize());
-    in_flight_write_stream_ = stream;
   }
 
   write_state_ = WRITE_STATE_DO_WRITE_COMPLETE;
@@ -1392,11 +1375,23 @@ int SpdySession::DoWrite() {
   // Explicitly store in a scoped_refptr<IOBuffer> to avoid problems
   // with Socket implementations that don't store their IOBuffer
   // argument in a scoped_refptr<IOBuffer> (see crbug.com/232345).
-  scoped_refptr<IOBuffer> write_io_buffer =
-      in_flight_write_->GetIOBufferForRemainingData();
+  scoped_refptr<IOBuffer> write_io_buffer;
+  size_t write_size = 0;
+  if (write_buffer_offset_ < write_buffer_used_) {
+    scoped_refptr<DrainableIOBuffer> coalesced_buffer =
+        new DrainableIOBuffer(write_buffer_.get(), write_buffer_used_);
+    coalesced_buffer->SetOffset(write_buffer_offset_);
+    write_io_buffer = coalesced_buffer;
+    write_size = write_buffer_used_ - write_buffer_offset_;
+  } else {
+    SpdyBuffer* buffer = in_flight_writes_.front()->buffer.get();
+    DCHECK_GT(buffer->GetRemainingSize(), 0u);
+    write_io_buffer = buffer->GetIOBufferForRemainingData();
+    write_size = buffer->GetRemainingSize();
+  }
   return connection_->socket()->Write(
       write_io_buffer.get(),
-      in_flight_write_->GetRemainingSize(),
+      write_size,
       base::Bind(&SpdySession::PumpWriteLoop,
                  weak_factory_.GetWeakPtr(), WRITE_STATE_DO_WRITE_COMPLETE));
 }
@@ -1405,16 +1400,13 @@ int SpdySession::DoWriteComplete(int result) {
   CHECK(in_io_loop_);
   DCHECK_NE(availability_state_, STATE_CLOSED);
   DCHECK_NE(result, ERR_IO_PENDING);
-  DCHECK_GT(in_flight_write_->GetRemainingSize(), 0u);
+  DCHECK(!in_flight_writes_.empty());
 
   last_activity_time_ = time_func_();
 
   if (result < 0) {
     DCHECK_NE(result, ERR_IO_PENDING);
-    in_flight_write_.reset();
-    in_flight_write_frame_type_ = DATA;
-    in_flight_write_frame_size_ = 0;
-    in_flight_write_stream_.reset();
+    ResetInFlightWrites();
     CloseSessionResult close_session_result =
         DoCloseSession(static_cast<Error>(result), "Write error");
     DCHECK_EQ(close_session_result, SESSION_CLOSED_BUT_NOT_REMOVED);
@@ -1423,37 +1415,114 @@ int SpdySession::DoWriteComplete(int result) {
     return result;
   }
 
-  // It should not be possible to have written more bytes than our
-  // in_flight_write_.
-  DCHECK_LE(static_cast<size_t>(result),
-            in_flight_write_->GetRemainingSize());
+  size_t bytes_written = static_cast<size_t>(result);
+  if (write_buffer_offset_ < write_buffer_used_) {
+    // It should not be possible to have written more bytes than we
+    // coalesced.
+    DCHECK_LE(bytes_written, write_buffer_used_ - write_buffer_offset_);
+    write_buffer_offset_ += bytes_written;
+    if (write_buffer_offset_ == write_buffer_used_) {
+      write_buffer_offset_ = 0;
+      write_buffer_used_ = 0;
+    }
+  } else {
+    // It should not be possible to have written more bytes than the
+    // frame we wrote from.
+    DCHECK_LE(bytes_written,
+              in_flight_writes_.front()->buffer->GetRemainingSize());
+  }
+
+  // Consume the written bytes from the frames they belong to. We only
+  // notify a stream when we've fully written its frame.
+  while (bytes_written > 0) {
+    DCHECK(!in_flight_writes_.empty());
+    InFlightWrite* write = in_flight_writes_.front();
+    size_t consume_size =
+        std::min(bytes_written, write->buffer->GetRemainingSize());
+    write->buffer->Consume(consume_size);
+    bytes_written -= consume_size;
+    if (write->buffer->GetRemainingSize() > 0)
+      break;
 
-  if (result > 0) {
-    in_flight_write_->Consume(static_cast<size_t>(result));
+    // Cleanup the write which just completed before notifying the
+    // stream, which may enqueue more writes.
+    scoped_ptr<InFlightWrite> completed_write(write);
+    in_flight_writes_.weak_erase(in_flight_writes_.begin());
+
+    // It is possible that the stream was cancelled while we were
+    // writing to the socket.
+    if (completed_write->stream.get()) {
+      DCHECK_GT(completed_write->frame_size, 0u);
+      completed_write->stream->OnFrameWriteComplete(
+          completed_write->frame_type,
+          completed_write->frame_size);
+    }
+  }
 
-    // We only notify the stream when we've fully written the pending frame.
-    if (in_flight_write_->GetRemainingSize() == 0) {
-      // It is possible that the stream was cancelled while we were
-      // writing to the socket.
-      if (in_flight_write_stream_.get()) {
-        DCHECK_GT(in_flight_write_frame_size_, 0u);
-        in_flight_write_stream_->OnFrameWriteComplete(
-            in_flight_write_frame_type_,
-            in_flight_write_frame_size_);
+  write_state_ = WRITE_STATE_DO_WRITE;
+  return OK;
+}
+
+int SpdySession::DequeueWrites() {
+  DCHECK(in_flight_writes_.empty());
+  DCHECK_EQ(write_buffer_used_, 0u);
+
+  while (true) {
+    SpdyFrameType frame_type = DATA;
+    scoped_ptr<SpdyBufferProducer> producer;
+    base::WeakPtr<SpdyStream> stream;
+    if (!write_queue_.Dequeue(&frame_type, &producer, &stream))
+      break;
+
+    if (stream.get())
+      DCHECK(!stream->IsClosed());
+
+    // Activate the stream only when sending the SYN_STREAM frame to
+    // guarantee monotonically-increasing stream IDs.
+    if (frame_type == SYN_STREAM) {
+      if (stream.get() && stream->stream_id() == 0) {
+        scoped_ptr<SpdyStream> owned_stream =
+            ActivateCreatedStream(stream.get());
+        InsertActivatedStream(owned_stream.Pass());
+      } else {
+        NOTREACHED();
+        return ERR_UNEXPECTED;
       }
+    }
 
-      // Cleanup the write which just completed.
-      in_flight_write_.reset();
-      in_flight_write_frame_type_ = DATA;
-      in_flight_write_frame_size_ = 0;
-      in_flight_write_stream_.reset();
+    scoped_ptr<SpdyBuffer> buffer = producer->ProduceBuffer();
+    if (!buffer) {
+      NOTREACHED();
+      return ERR_UNEXPECTED;
     }
+    size_t frame_size = buffer->GetRemainingSize();
+    DCHECK_GE(frame_size, buffered_spdy_framer_->GetFrameMinimumSize());
+
+    bool coalesce = frame_size <= kMaxCoalescedFrameSize &&
+        write_buffer_used_ + frame_size <= kWriteBufferSize;
+    if (coalesce) {
+      if (write_buffer_used_ == 0 &&
+          (!write_buffer_.get() || !write_buffer_->HasOneRef())) {
+        write_buffer_ = new IOBufferWithSize(kWriteBufferSize);
+      }
+      memcpy(write_buffer_->data() + write_buffer_used_,
+             buffer->GetRemainingData(), frame_size);
+      write_buffer_used_ += frame_size;
+    }
+    in_flight_writes_.push_back(
+        new InFlightWrite(frame_type, buffer.Pass(), stream));
+    if (!coalesce)
+      break;
   }
-
-  write_state_ = WRITE_STATE_DO_WRITE;
   return OK;
 }
 
+void SpdySession::ResetInFlightWrites() {
+  in_flight_writes_.clear();
+  write_buffer_used_ = 0;
+  write_buffer_offset_ = 0;
+}
+
 void SpdySession::DcheckGoingAway() const {
   DCHECK_GE(availability_state_, STATE_GOING_AWAY);
   if (DCHECK_IS_ON()) {
@@ -1735,7 +1804,7 @@ void SpdySession::EnqueueWrite(RequestPriority priority,
   write_queue_.Enqueue(priority, frame_type, producer.Pass(), stream);
   if (write_state_ == WRITE_STATE_IDLE) {
     DCHECK(was_idle);
-    DCHECK(!in_flight_write_);
+    DCHECK(in_flight_writes_.empty());
     write_state_ = WRITE_STATE_DO_WRITE;
     base::MessageLoop::current()->PostTask(
         FROM_HERE,
@@ -1773,12 +1842,14 @@ void SpdySession::InsertActivatedStream(scoped_ptr<SpdyStream> stream) {
 }
 
 void SpdySession::DeleteStream(scoped_ptr<SpdyStream> stream, int status) {
-  if (in_flight_write_stream_.get() == stream.get()) {
-    // If we're deleting the stream for the in-flight write, we still
-    // need to let the write complete, so we clear
-    // |in_flight_write_stream_| and let the write finish on its own
-    // without notifying |in_flight_write_stream_|.
-    in_flight_write_stream_.reset();
+  for (ScopedVector<InFlightWrite>::iterator it = in_flight_writes_.begin();
+       it != in_flight_writes_.end(); ++it) {
+    if ((*it)->stream.get() == stream.get()) {
+      // If we're deleting the stream for an in-flight write, we still
+      // need to let the write complete, so we clear its stream and let
+      // the write finish on its own without notifying the stream.
+      (*it)->stream.reset();
+    }
   }
 
   write_queue_.RemovePendingWritesForStream(stream->GetWeakPtr());
@@ -14,6 +14,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
 #include "base/time/time.h"
 #include "net/base/io_buffer.h"
@@ -58,6 +59,15 @@ const int kMaxConcurrentPushedStreams = 1000;
 // yielding.
 const int kMaxReadBytesWithoutYielding = 32 * 1024;
 
+// Frames no larger than this are copied into the session's write
+// buffer and written together with the frames queued after them.
+// Larger frames (mostly full DATA frames) are written straight from
+// their own buffer.
+const size_t kMaxCoalescedFrameSize = 1024;
+
+// The size of the buffer small frames are coalesced into.
+const size_t kWriteBufferSize = 16 * 1024;
+
 // The initial receive window size for both streams and sessions.
 const int32 kDefaultInitialRecvWindowSize = 10 * 1024 * 1024;  // 10MB
 
@@ -513,6 +523,22 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
 
   typedef std::set<SpdyStream*> CreatedStreamSet;
 
+  // A frame taken from |write_queue_| that is being written.
+  struct InFlightWrite {
+    InFlightWrite(SpdyFrameType frame_type,
+                  scoped_ptr<SpdyBuffer> buffer,
+                  const base::WeakPtr<SpdyStream>& stream);
+    ~InFlightWrite();
+
+    SpdyFrameType frame_type;
+    scoped_ptr<SpdyBuffer> buffer;
+    // The size of the whole frame.
+    size_t frame_size;
+    // The stream to notify when the frame has been written to the
+    // socket completely.
+    base::WeakPtr<SpdyStream> stream;
+  };
+
   enum AvailabilityState {
     // The session is available in its socket pool and can be used
     // freely.
@@ -639,6 +665,15 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   int DoWrite();
   int DoWriteComplete(int result);
 
+  // Moves frames from |write_queue_| to |in_flight_writes_|, copying
+  // small ones into |write_buffer_| as long as they fit. Stops after
+  // the first frame that isn't copied. Returns OK, or ERR_UNEXPECTED
+  // if a frame could not be produced.
+  int DequeueWrites();
+
+  // Drops whatever is being written, e.g. on a write error.
+  void ResetInFlightWrites();
+
   // TODO(akalin): Rename the Send* and Write* functions below to
   // Enqueue*.
 
@@ -980,17 +1015,19 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // The write queue.
   SpdyWriteQueue write_queue_;
 
-  // Data for the frame we are currently sending.
-
-  // The buffer we're currently writing.
-  scoped_ptr<SpdyBuffer> in_flight_write_;
-  // The type of the frame in |in_flight_write_|.
-  SpdyFrameType in_flight_write_frame_type_;
-  // The size of the frame in |in_flight_write_|.
-  size_t in_flight_write_frame_size_;
-  // The stream to notify when |in_flight_write_| has been written to
-  // the socket completely.
-  base::WeakPtr<SpdyStream> in_flight_write_stream_;
+  // The frames we are currently sending, in order. The first
+  // |write_buffer_used_| bytes of them are copied into |write_buffer_|
+  // and are written from there; any frame after those is written
+  // from its own buffer.
+  ScopedVector<InFlightWrite> in_flight_writes_;
+
+  // The buffer small frames are coalesced into. It is reused for the
+  // next batch of frames unless the socket still holds on to it.
+  scoped_refptr<IOBufferWithSize> write_buffer_;
+  // The number of bytes copied into |write_buffer_|, and how many of
+  // those have been written.
+  size_t write_buffer_used_;
+  size_t write_buffer_offset_;
 
   // Flag if we're using an SSL connection for this SpdySession.
   bool is_secure_;
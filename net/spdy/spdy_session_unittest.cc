@@ -1506,6 +1506,74 @@ TEST_P(SpdySessionTest, OutOfOrderSynStreams) {
   EXPECT_EQ(1u, delegate_highest.stream_id());
 }
 
+// Small frames queued together should go out in a single socket
+// write.
+TEST_P(SpdySessionTest, CoalesceSmallFrames) {
+  MockConnect connect_data(SYNCHRONOUS, OK);
+  scoped_ptr<SpdyFrame> req1(
+      spdy_util_.ConstructSpdyGet(NULL, 0, false, 1, MEDIUM, true));
+  scoped_ptr<SpdyFrame> req2(
+      spdy_util_.ConstructSpdyGet(NULL, 0, false, 3, MEDIUM, true));
+  const SpdyFrame* reqs[] = { req1.get(), req2.get() };
+  char combined_reqs[1024];
+  int combined_reqs_len = CombineFrames(reqs, arraysize(reqs), combined_reqs,
+                                        arraysize(combined_reqs));
+  // Had the frames been written separately, the first write would be
+  // shorter than this one and not match it.
+  MockWrite writes[] = {
+    MockWrite(ASYNC, combined_reqs, combined_reqs_len, 0),
+  };
+
+  MockRead reads[] = {
+    MockRead(ASYNC, 0, 1)  // EOF
+  };
+
+  session_deps_.host_resolver->set_synchronous_mode(true);
+
+  DeterministicSocketData data(reads, arraysize(reads),
+                               writes, arraysize(writes));
+  data.set_connect_data(connect_data);
+  session_deps_.deterministic_socket_factory->AddSocketDataProvider(&data);
+
+  CreateDeterministicNetworkSession();
+
+  base::WeakPtr<SpdySession> session =
+      CreateInsecureSpdySession(http_session_, key_, BoundNetLog());
+
+  GURL url(kDefaultURL);
+
+  base::WeakPtr<SpdyStream> spdy_stream1 =
+      CreateStreamSynchronously(SPDY_REQUEST_RESPONSE_STREAM,
+                                session, url, MEDIUM, BoundNetLog());
+  ASSERT_TRUE(spdy_stream1);
+  test::StreamDelegateDoNothing delegate1(spdy_stream1);
+  spdy_stream1->SetDelegate(&delegate1);
+
+  base::WeakPtr<SpdyStream> spdy_stream2 =
+      CreateStreamSynchronously(SPDY_REQUEST_RESPONSE_STREAM,
+                                session, url, MEDIUM, BoundNetLog());
+  ASSERT_TRUE(spdy_stream2);
+  test::StreamDelegateDoNothing delegate2(spdy_stream2);
+  spdy_stream2->SetDelegate(&delegate2);
+
+  scoped_ptr<SpdyHeaderBlock> headers1(
+      spdy_util_.ConstructGetHeaderBlock(url.spec()));
+  spdy_stream1->SendRequestHeaders(headers1.Pass(), NO_MORE_DATA_TO_SEND);
+  scoped_ptr<SpdyHeaderBlock> headers2(
+      spdy_util_.ConstructGetHeaderBlock(url.spec()));
+  spdy_stream2->SendRequestHeaders(headers2.Pass(), NO_MORE_DATA_TO_SEND);
+
+  data.RunFor(1);
+
+  // Both streams were activated and notified of their write.
+  EXPECT_EQ(1u, delegate1.stream_id());
+  EXPECT_EQ(3u, delegate2.stream_id());
+  EXPECT_TRUE(data.at_write_eof());
+
+  data.RunFor(1);
+  EXPECT_TRUE(session == NULL);
+}
+
 TEST_P(SpdySessionTest, CancelStream) {
   MockConnect connect_data(SYNCHRONOUS, OK);
   // Request 1, at HIGHEST priority, will be cancelled before it writes data.
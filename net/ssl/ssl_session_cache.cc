@@ -0,0 +1,167 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/ssl/ssl_session_cache.h"
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/base/host_port_pair.h"
+#include "net/ssl/ssl_config_service.h"
+
+namespace net {
+
+namespace {
+
+struct SessionCacheHolder {
+  SessionCacheHolder() : cache(SSLSessionCache::kDefaultMaxEntries) {}
+
+  SSLSessionCache cache;
+};
+
+base::LazyInstance<SessionCacheHolder>::Leaky g_session_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+const size_t SSLSessionCache::kDefaultMaxEntries = 1024;
+
+SSLSessionCache::Entry::Entry() {}
+
+SSLSessionCache::Entry::~Entry() {}
+
+SSLSessionCache::SSLSessionCache(size_t max_entries)
+    : entries_(max_entries) {
+  DCHECK_GT(max_entries, 0u);
+  for (size_t i = 0; i < arraysize(eviction_counts_); ++i)
+    eviction_counts_[i] = 0;
+}
+
+SSLSessionCache::~SSLSessionCache() {}
+
+// static
+SSLSessionCache* SSLSessionCache::GetInstance() {
+  return &g_session_cache.Get().cache;
+}
+
+// static
+std::string SSLSessionCache::GetKey(
+    const HostPortPair& host_and_port,
+    const SSLConfig& ssl_config,
+    const std::string& ssl_session_cache_shard) {
+  std::string key = host_and_port.ToString();
+  key.append("/");
+  key.append(ssl_session_cache_shard);
+  key.append("/");
+  key.append(base::UintToString(ssl_config.version_min));
+  key.append("-");
+  key.append(base::UintToString(ssl_config.version_max));
+  return key;
+}
+
+bool SSLSessionCache::Lookup(const std::string& key,
+                             const base::Time& now,
+                             std::string* session) {
+  bool hit = false;
+  bool expired = false;
+  base::TimeDelta expired_age;
+  {
+    base::AutoLock locked(lock_);
+    EntryMap::iterator it = entries_.Get(key);
+    if (it != entries_.end()) {
+      if (now >= it->second.expiration_time) {
+        expired = true;
+        expired_age = now - it->second.creation_time;
+        ++eviction_counts_[EVICTION_EXPIRED];
+        entries_.Erase(it);
+      } else {
+        hit = true;
+        *session = it->second.session;
+      }
+    }
+  }
+  if (expired)
+    RecordEviction(EVICTION_EXPIRED, expired_age);
+  UMA_HISTOGRAM_BOOLEAN("Net.SSLSessionCache.Hit", hit);
+  return hit;
+}
+
+void SSLSessionCache::Insert(const std::string& key,
+                             const std::string& session,
+                             const base::Time& now,
+                             const base::Time& expiration) {
+  Entry entry;
+  entry.session = session;
+  entry.creation_time = now;
+  entry.expiration_time = expiration;
+
+  bool replaced = false;
+  base::TimeDelta replaced_age;
+  bool evicted = false;
+  base::TimeDelta evicted_age;
+  {
+    base::AutoLock locked(lock_);
+    EntryMap::iterator it = entries_.Peek(key);
+    if (it != entries_.end()) {
+      // Each full handshake with a server replaces its previous session.
+      replaced = true;
+      replaced_age = now - it->second.creation_time;
+      ++eviction_counts_[EVICTION_REPLACED];
+      entries_.Erase(it);
+    }
+    // Evict here rather than leaving it to the MRUCache, so that it is
+    // counted.
+    if (entries_.size() >= entries_.max_size()) {
+      EntryMap::reverse_iterator oldest = entries_.rbegin();
+      evicted = true;
+      evicted_age = now - oldest->second.creation_time;
+      ++eviction_counts_[EVICTION_CAPACITY];
+      entries_.Erase(oldest);
+    }
+    entries_.Put(key, entry);
+  }
+  if (replaced)
+    RecordEviction(EVICTION_REPLACED, replaced_age);
+  if (evicted)
+    RecordEviction(EVICTION_CAPACITY, evicted_age);
+}
+
+void SSLSessionCache::Remove(const std::string& key) {
+  base::AutoLock locked(lock_);
+  EntryMap::iterator it = entries_.Peek(key);
+  if (it != entries_.end())
+    entries_.Erase(it);
+}
+
+void SSLSessionCache::Clear() {
+  base::AutoLock locked(lock_);
+  entries_.Clear();
+}
+
+size_t SSLSessionCache::size() const {
+  base::AutoLock locked(lock_);
+  return entries_.size();
+}
+
+size_t SSLSessionCache::eviction_count(EvictionReason reason) const {
+  DCHECK_LT(reason, EVICTION_MAX);
+  base::AutoLock locked(lock_);
+  return eviction_counts_[reason];
+}
+
+// static
+void SSLSessionCache::RecordEviction(EvictionReason reason,
+                                     const base::TimeDelta& age) {
+  UMA_HISTOGRAM_ENUMERATION("Net.SSLSessionCache.Eviction", reason,
+                            EVICTION_MAX);
+  if (reason == EVICTION_CAPACITY) {
+    // If sessions are evicted young, the cache is too small.
+    UMA_HISTOGRAM_CUSTOM_TIMES("Net.SSLSessionCache.EvictedSessionAge", age,
+                               base::TimeDelta::FromSeconds(1),
+                               base::TimeDelta::FromDays(1), 50);
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,105 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SSL_SSL_SESSION_CACHE_H_
+#define NET_SSL_SSL_SESSION_CACHE_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class HostPortPair;
+struct SSLConfig;
+
+// SSLSessionCache holds serialized SSL sessions, so that they can be resumed
+// by any SSLClientSocket, from any socket pool. The format of a session is up
+// to the SSLClientSocket implementation which stored it.
+//
+// This class is thread-safe.
+class NET_EXPORT SSLSessionCache {
+ public:
+  // Why a session was removed from the cache, for the
+  // Net.SSLSessionCache.Eviction histogram.
+  enum EvictionReason {
+    // The cache was full and the session was the least recently used.
+    EVICTION_CAPACITY = 0,
+    // The session expired before it was resumed again.
+    EVICTION_EXPIRED = 1,
+    // A new session was negotiated with the same server.
+    EVICTION_REPLACED = 2,
+    EVICTION_MAX,
+  };
+
+  // The number of sessions of the process-wide cache.
+  static const size_t kDefaultMaxEntries;
+
+  explicit SSLSessionCache(size_t max_entries);
+  ~SSLSessionCache();
+
+  // Returns the process-wide cache.
+  static SSLSessionCache* GetInstance();
+
+  // Returns the key of the sessions negotiated with |host_and_port| under
+  // |ssl_config|. Connections in different partitions of the session cache
+  // (see SSLClientSocketContext::ssl_session_cache_shard) have different
+  // keys, as do connections which allow different protocol versions.
+  static std::string GetKey(const HostPortPair& host_and_port,
+                            const SSLConfig& ssl_config,
+                            const std::string& ssl_session_cache_shard);
+
+  // If there is a session for |key| which can be resumed at |now|, copies it
+  // to |session| and returns true.
+  bool Lookup(const std::string& key,
+              const base::Time& now,
+              std::string* session);
+
+  // Stores |session|, which was negotiated at |now| and can be resumed until
+  // |expiration|, replacing any previous session for |key|.
+  void Insert(const std::string& key,
+              const std::string& session,
+              const base::Time& now,
+              const base::Time& expiration);
+
+  // Removes the session for |key|, e.g. because resuming it failed.
+  void Remove(const std::string& key);
+
+  void Clear();
+
+  size_t size() const;
+
+  // Returns the number of sessions which were evicted for |reason| since the
+  // cache was created.
+  size_t eviction_count(EvictionReason reason) const;
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    std::string session;
+    base::Time creation_time;
+    base::Time expiration_time;
+  };
+  typedef base::MRUCache<std::string, Entry> EntryMap;
+
+  // Records an eviction for |reason| of a session which was |age| old. Called
+  // once |lock_| is released, so that the histograms aren't updated under it.
+  static void RecordEviction(EvictionReason reason, const base::TimeDelta& age);
+
+  mutable base::Lock lock_;
+  EntryMap entries_;
+  size_t eviction_counts_[EVICTION_MAX];
+
+  DISALLOW_COPY_AND_ASSIGN(SSLSessionCache);
+};
+
+}  // namespace net
+
+#endif  // NET_SSL_SSL_SESSION_CACHE_H_
@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/ssl/ssl_session_cache.h"
+
+#include "net/base/host_port_pair.h"
+#include "net/ssl/ssl_config_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class SSLSessionCacheTest : public testing::Test {
+ protected:
+  SSLSessionCacheTest()
+      : cache_(4),
+        now_(base::Time::Now()),
+        expiration_(now_ + base::TimeDelta::FromHours(1)) {
+  }
+
+  SSLSessionCache cache_;
+  const base::Time now_;
+  const base::Time expiration_;
+};
+
+TEST_F(SSLSessionCacheTest, GetKey) {
+  HostPortPair host_and_port("www.example.com", 443);
+  SSLConfig ssl_config;
+  std::string key = SSLSessionCache::GetKey(host_and_port, ssl_config, "");
+  EXPECT_EQ(key, SSLSessionCache::GetKey(host_and_port, ssl_config, ""));
+
+  EXPECT_NE(key, SSLSessionCache::GetKey(host_and_port, ssl_config, "shard"));
+  EXPECT_NE(key, SSLSessionCache::GetKey(HostPortPair("www.example.com", 444),
+                                         ssl_config, ""));
+  SSLConfig fallback_ssl_config;
+  fallback_ssl_config.version_max = fallback_ssl_config.version_min;
+  EXPECT_NE(key, SSLSessionCache::GetKey(host_and_port, fallback_ssl_config,
+                                         ""));
+}
+
+TEST_F(SSLSessionCacheTest, LookupAndInsert) {
+  std::string session;
+  EXPECT_FALSE(cache_.Lookup("a", now_, &session));
+
+  cache_.Insert("a", "session a", now_, expiration_);
+  ASSERT_TRUE(cache_.Lookup("a", now_, &session));
+  EXPECT_EQ("session a", session);
+  EXPECT_FALSE(cache_.Lookup("b", now_, &session));
+
+  cache_.Insert("a", "session a2", now_, expiration_);
+  EXPECT_EQ(1u, cache_.size());
+  ASSERT_TRUE(cache_.Lookup("a", now_, &session));
+  EXPECT_EQ("session a2", session);
+  EXPECT_EQ(1u, cache_.eviction_count(SSLSessionCache::EVICTION_REPLACED));
+
+  cache_.Remove("a");
+  EXPECT_FALSE(cache_.Lookup("a", now_, &session));
+  // Removing a session isn't an eviction.
+  EXPECT_EQ(1u, cache_.eviction_count(SSLSessionCache::EVICTION_REPLACED));
+}
+
+TEST_F(SSLSessionCacheTest, Expiration) {
+  cache_.Insert("a", "session a", now_, expiration_);
+
+  std::string session;
+  EXPECT_TRUE(cache_.Lookup("a", expiration_ - base::TimeDelta::FromSeconds(1),
+                            &session));
+  EXPECT_FALSE(cache_.Lookup("a", expiration_, &session));
+  EXPECT_EQ(0u, cache_.size());
+  EXPECT_EQ(1u, cache_.eviction_count(SSLSessionCache::EVICTION_EXPIRED));
+}
+
+TEST_F(SSLSessionCacheTest, EvictsLeastRecentlyUsed) {
+  cache_.Insert("a", "session a", now_, expiration_);
+  cache_.Insert("b", "session b", now_, expiration_);
+  cache_.Insert("c", "session c", now_, expiration_);
+  cache_.Insert("d", "session d", now_, expiration_);
+
+  // Looking up "a" makes "b" the least recently used.
+  std::string session;
+  EXPECT_TRUE(cache_.Lookup("a", now_, &session));
+  cache_.Insert("e", "session e", now_, expiration_);
+
+  EXPECT_EQ(4u, cache_.size());
+  EXPECT_FALSE(cache_.Lookup("b", now_, &session));
+  EXPECT_TRUE(cache_.Lookup("a", now_, &session));
+  EXPECT_TRUE(cache_.Lookup("e", now_, &session));
+  EXPECT_EQ(1u, cache_.eviction_count(SSLSessionCache::EVICTION_CAPACITY));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -0,0 +1,131 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_batch_packet_writer.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "base/logging.h"
+
+namespace net {
+namespace tools {
+
+// static
+const size_t QuicBatchPacketWriter::kMaxBatchSize;
+
+QuicBatchPacketWriter::QuicBatchPacketWriter(int fd)
+    : fd_(fd),
+      write_blocked_(false),
+      num_packets_(0) {
+  for (size_t i = 0; i < kMaxBatchSize; ++i) {
+    packets_[i].buffer = buffers_[i];
+    packets_[i].buf_len = 0;
+  }
+}
+
+QuicBatchPacketWriter::~QuicBatchPacketWriter() {
+  LOG_IF(WARNING, num_packets_ > 0)
+      << "Destroying a writer with " << num_packets_ << " unsent packets.";
+}
+
+WriteResult QuicBatchPacketWriter::WritePacket(
+    const char* buffer, size_t buf_len,
+    const net::IPAddressNumber& self_address,
+    const net::IPEndPoint& peer_address) {
+  DCHECK(!IsWriteBlocked());
+  if (num_packets_ == kMaxBatchSize || buf_len > kMaxPacketSize) {
+    // If the batch can't be sent, the packet is not taken and the caller
+    // writes it again once the socket is writable.
+    WriteResult result = WriteBatch();
+    if (result.status != WRITE_STATUS_OK) {
+      return result;
+    }
+  }
+  if (buf_len > kMaxPacketSize) {
+    LOG(DFATAL) << "Packet of " << buf_len << " bytes is too large to batch.";
+    WriteResult result = QuicSocketUtils::WritePacket(
+        fd_, buffer, buf_len, self_address, peer_address);
+    if (result.status == WRITE_STATUS_BLOCKED) {
+      write_blocked_ = true;
+    }
+    return result;
+  }
+
+  QuicSocketUtils::OutgoingPacket* packet = &packets_[num_packets_];
+  memcpy(buffers_[num_packets_], buffer, buf_len);
+  ++num_packets_;
+  packet->buf_len = buf_len;
+  packet->self_address = self_address;
+  packet->peer_address = peer_address;
+  return WriteResult(WRITE_STATUS_OK, buf_len);
+}
+
+WriteResult QuicBatchPacketWriter::Flush() {
+  if (IsWriteBlocked()) {
+    return WriteResult(WRITE_STATUS_BLOCKED, EAGAIN);
+  }
+  return WriteBatch();
+}
+
+bool QuicBatchPacketWriter::IsWriteBlockedDataBuffered() const {
+  // Packets are only taken when there is room for them, so a blocked write
+  // has not buffered the packet.
+  return false;
+}
+
+bool QuicBatchPacketWriter::IsWriteBlocked() const {
+  return write_blocked_;
+}
+
+void QuicBatchPacketWriter::SetWritable() {
+  write_blocked_ = false;
+  // Resend what was left over when the socket blocked. If the socket blocks
+  // again, the writer is marked blocked, which the caller checks.
+  WriteResult result = WriteBatch();
+  DCHECK_NE(WRITE_STATUS_ERROR, result.status);
+}
+
+WriteResult QuicBatchPacketWriter::WriteBatch() {
+  int bytes_written = 0;
+  size_t num_sent = 0;
+  while (num_sent < num_packets_) {
+    size_t packets_written = 0;
+    WriteResult result = QuicSocketUtils::WritePackets(
+        fd_, packets_ + num_sent, num_packets_ - num_sent, &packets_written);
+    num_sent += packets_written;
+    if (result.status == WRITE_STATUS_OK) {
+      bytes_written += result.bytes_written;
+      break;
+    }
+    if (result.status == WRITE_STATUS_BLOCKED) {
+      write_blocked_ = true;
+      KeepUnsentPackets(num_sent);
+      return result;
+    }
+    // The packets may belong to any connection, not just to the one that
+    // flushed, so the error is not handed back. The packet is dropped, as if
+    // it had been lost, and the rest of the batch still goes out.
+    LOG(WARNING) << "Dropping a batched packet to "
+                 << packets_[num_sent].peer_address.ToString()
+                 << " after a write error: " << strerror(result.error_code);
+    ++num_sent;
+  }
+  num_packets_ = 0;
+  return WriteResult(WRITE_STATUS_OK, bytes_written);
+}
+
+void QuicBatchPacketWriter::KeepUnsentPackets(size_t num_sent) {
+  for (size_t i = num_sent; i < num_packets_; ++i) {
+    size_t dest = i - num_sent;
+    memcpy(buffers_[dest], buffers_[i], packets_[i].buf_len);
+    packets_[dest].buf_len = packets_[i].buf_len;
+    packets_[dest].self_address = packets_[i].self_address;
+    packets_[dest].peer_address = packets_[i].peer_address;
+  }
+  num_packets_ -= num_sent;
+}
+
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,69 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+#define NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+
+#include "base/basictypes.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/quic_packet_writer.h"
+#include "net/quic/quic_protocol.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+namespace net {
+
+struct WriteResult;
+
+namespace tools {
+
+// A packet writer which copies packets into a batch rather than sending each
+// one as it is written, and sends the batch with sendmmsg when it is flushed
+// or fills up. Connections flush when their packet generator leaves batch
+// mode, so a burst of packets costs one system call rather than one each.
+// The writer is shared by all of a server's connections, so a packet which
+// fails to send is dropped like a lost packet rather than reported to
+// whichever connection happens to flush.
+class QuicBatchPacketWriter : public QuicPacketWriter {
+ public:
+  // The most packets held before the batch is sent.
+  static const size_t kMaxBatchSize = 16;
+
+  explicit QuicBatchPacketWriter(int fd);
+  virtual ~QuicBatchPacketWriter();
+
+  // QuicPacketWriter
+  virtual WriteResult WritePacket(
+      const char* buffer, size_t buf_len,
+      const net::IPAddressNumber& self_address,
+      const net::IPEndPoint& peer_address) OVERRIDE;
+  virtual WriteResult Flush() OVERRIDE;
+  virtual bool IsWriteBlockedDataBuffered() const OVERRIDE;
+  virtual bool IsWriteBlocked() const OVERRIDE;
+  virtual void SetWritable() OVERRIDE;
+
+  size_t num_batched_packets() const { return num_packets_; }
+
+ private:
+  // Sends the batched packets. Packets which could not be sent because the
+  // socket is blocked are kept for the next attempt. A packet that fails to
+  // send is dropped, and the ones after it are still sent, so the result is
+  // never WRITE_STATUS_ERROR.
+  WriteResult WriteBatch();
+
+  // Moves the packets after the first |num_sent| to the front of the batch.
+  void KeepUnsentPackets(size_t num_sent);
+
+  int fd_;
+  bool write_blocked_;
+  size_t num_packets_;
+  QuicSocketUtils::OutgoingPacket packets_[kMaxBatchSize];
+  char buffers_[kMaxBatchSize][kMaxPacketSize];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicBatchPacketWriter);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
@@ -0,0 +1,164 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Compares packet throughput over loopback when every packet is its own
+// sendmsg/recvmsg with batching through sendmmsg/recvmmsg.
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/time/time.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_util.h"
+#include "net/tools/quic/quic_batch_packet_writer.h"
+#include "net/tools/quic/quic_default_packet_writer.h"
+#include "net/tools/quic/quic_packet_reader.h"
+#include "net/tools/quic/quic_process_packet_interface.h"
+#include "net/tools/quic/quic_socket_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace net {
+namespace tools {
+namespace test {
+namespace {
+
+// A typical full size packet of bulk data.
+const size_t kPacketSize = 1350;
+// Packets a connection writes in one burst before the receiver reads them.
+// Small enough that the receive buffer never overflows.
+const int kPacketsPerBurst = 32;
+const int kNumBursts = 20000;
+
+class CountingProcessor : public ProcessPacketInterface {
+ public:
+  CountingProcessor() : packets_(0), bytes_(0) {}
+
+  virtual void ProcessPacket(const IPEndPoint& server_address,
+                             const IPEndPoint& client_address,
+                             const QuicEncryptedPacket& packet) OVERRIDE {
+    ++packets_;
+    bytes_ += packet.length();
+  }
+
+  int packets_;
+  int64 bytes_;
+};
+
+int CreateLoopbackSocket(IPEndPoint* address) {
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  if (fd < 0)
+    return -1;
+  IPAddressNumber loopback;
+  CHECK(ParseIPLiteralToNumber("127.0.0.1", &loopback));
+  sockaddr_storage raw_address;
+  socklen_t address_len = sizeof(raw_address);
+  CHECK(IPEndPoint(loopback, 0).ToSockAddr(
+      reinterpret_cast<sockaddr*>(&raw_address), &address_len));
+  if (bind(fd, reinterpret_cast<sockaddr*>(&raw_address), address_len) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&raw_address),
+                  &address_len) < 0 ||
+      !address->FromSockAddr(reinterpret_cast<sockaddr*>(&raw_address),
+                             address_len)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+class QuicBatchPacketWriterPerfTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    send_fd_ = CreateLoopbackSocket(&send_address_);
+    ASSERT_LE(0, send_fd_);
+    receive_fd_ = CreateLoopbackSocket(&receive_address_);
+    ASSERT_LE(0, receive_fd_);
+    ASSERT_EQ(0, QuicSocketUtils::SetGetAddressInfo(receive_fd_, AF_INET));
+  }
+
+  virtual void TearDown() OVERRIDE {
+    close(send_fd_);
+    close(receive_fd_);
+  }
+
+  // Sends kNumBursts bursts of packets through |writer| and reads each burst
+  // back, one packet per recvmsg or a batch per recvmmsg, and reports the
+  // throughput as |trace|.
+  void RunBursts(QuicPacketWriter* writer, bool use_reader,
+                 const std::string& trace) {
+    const std::string packet(kPacketSize, 'a');
+    QuicPacketReader reader;
+    CountingProcessor processor;
+    char buf[2 * kMaxPacketSize];
+
+    base::PerfTimeLogger timer(base::StringPrintf(
+        "%s %d packets", trace.c_str(),
+        kNumBursts * kPacketsPerBurst).c_str());
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kNumBursts; ++i) {
+      for (int j = 0; j < kPacketsPerBurst; ++j) {
+        ASSERT_EQ(WRITE_STATUS_OK,
+                  writer->WritePacket(packet.data(), packet.length(),
+                                      send_address_.address(),
+                                      receive_address_).status);
+      }
+      ASSERT_EQ(WRITE_STATUS_OK, writer->Flush().status);
+
+      if (use_reader) {
+        while (reader.ReadAndDispatchPackets(receive_fd_,
+                                             receive_address_.port(),
+                                             &processor, NULL)) {
+        }
+      } else {
+        IPEndPoint client_address;
+        IPAddressNumber server_ip;
+        int bytes_read;
+        while ((bytes_read = QuicSocketUtils::ReadPacket(
+                    receive_fd_, buf, arraysize(buf), NULL, &server_ip,
+                    &client_address)) >= 0) {
+          processor.ProcessPacket(IPEndPoint(server_ip,
+                                             receive_address_.port()),
+                                  client_address,
+                                  QuicEncryptedPacket(buf, bytes_read));
+        }
+      }
+    }
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    timer.Done();
+
+    // Loopback may still drop under load; report what actually arrived.
+    EXPECT_LT(0, processor.packets_);
+    perf_test::PrintResult("quic_packets_per_second", "", trace,
+                           processor.packets_ / elapsed.InSecondsF(),
+                           "packets/s", true);
+    perf_test::PrintResult("quic_throughput", "", trace,
+                           processor.bytes_ * 8 / elapsed.InSecondsF() / 1e6,
+                           "Mbit/s", true);
+  }
+
+  int send_fd_;
+  int receive_fd_;
+  IPEndPoint send_address_;
+  IPEndPoint receive_address_;
+};
+
+TEST_F(QuicBatchPacketWriterPerfTest, SinglePacketSyscalls) {
+  QuicDefaultPacketWriter writer(send_fd_);
+  RunBursts(&writer, false, "sendmsg_recvmsg");
+}
+
+TEST_F(QuicBatchPacketWriterPerfTest, BatchedSyscalls) {
+  QuicBatchPacketWriter writer(send_fd_);
+  RunBursts(&writer, true, "sendmmsg_recvmmsg");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace tools
+}  // namespace net
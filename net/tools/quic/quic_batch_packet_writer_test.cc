@@ -0,0 +1,199 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_batch_packet_writer.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_util.h"
+#include "net/tools/quic/quic_packet_reader.h"
+#include "net/tools/quic/quic_process_packet_interface.h"
+#include "net/tools/quic/quic_socket_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using std::string;
+using std::vector;
+
+namespace net {
+namespace tools {
+namespace test {
+namespace {
+
+// Records the packets a QuicPacketReader dispatches.
+class RecordingProcessor : public ProcessPacketInterface {
+ public:
+  virtual void ProcessPacket(const IPEndPoint& server_address,
+                             const IPEndPoint& client_address,
+                             const QuicEncryptedPacket& packet) OVERRIDE {
+    server_addresses_.push_back(server_address);
+    client_addresses_.push_back(client_address);
+    packets_.push_back(packet.AsStringPiece().as_string());
+  }
+
+  vector<IPEndPoint> server_addresses_;
+  vector<IPEndPoint> client_addresses_;
+  vector<string> packets_;
+};
+
+// Returns a non-blocking UDP socket bound to an ephemeral loopback port, and
+// sets |address| to the address it is bound to.
+int CreateLoopbackSocket(IPEndPoint* address) {
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  if (fd < 0)
+    return -1;
+  IPAddressNumber loopback;
+  CHECK(ParseIPLiteralToNumber("127.0.0.1", &loopback));
+  sockaddr_storage raw_address;
+  socklen_t address_len = sizeof(raw_address);
+  CHECK(IPEndPoint(loopback, 0).ToSockAddr(
+      reinterpret_cast<sockaddr*>(&raw_address), &address_len));
+  if (bind(fd, reinterpret_cast<sockaddr*>(&raw_address), address_len) < 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&raw_address),
+                  &address_len) < 0 ||
+      !address->FromSockAddr(reinterpret_cast<sockaddr*>(&raw_address),
+                             address_len)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+class QuicBatchPacketWriterTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    send_fd_ = CreateLoopbackSocket(&send_address_);
+    ASSERT_LE(0, send_fd_);
+    receive_fd_ = CreateLoopbackSocket(&receive_address_);
+    ASSERT_LE(0, receive_fd_);
+    ASSERT_EQ(0, QuicSocketUtils::SetGetAddressInfo(receive_fd_, AF_INET));
+  }
+
+  virtual void TearDown() OVERRIDE {
+    close(send_fd_);
+    close(receive_fd_);
+  }
+
+  WriteResult WritePacket(QuicPacketWriter* writer, const string& data) {
+    return writer->WritePacket(data.data(), data.length(),
+                               send_address_.address(), receive_address_);
+  }
+
+  // Returns true if a packet arrives within a second.
+  bool WaitForPacket() {
+    pollfd poll_fd = { receive_fd_, POLLIN, 0 };
+    return poll(&poll_fd, 1, 1000) == 1;
+  }
+
+  int send_fd_;
+  int receive_fd_;
+  IPEndPoint send_address_;
+  IPEndPoint receive_address_;
+  QuicPacketReader reader_;
+  RecordingProcessor processor_;
+};
+
+TEST_F(QuicBatchPacketWriterTest, HoldsPacketsUntilFlush) {
+  QuicBatchPacketWriter writer(send_fd_);
+  for (int i = 0; i < 3; ++i) {
+    WriteResult result = WritePacket(&writer, base::StringPrintf("packet %d",
+                                                                 i));
+    EXPECT_EQ(WRITE_STATUS_OK, result.status);
+    EXPECT_EQ(8, result.bytes_written);
+  }
+  EXPECT_EQ(3u, writer.num_batched_packets());
+  EXPECT_FALSE(reader_.ReadAndDispatchPackets(
+      receive_fd_, receive_address_.port(), &processor_, NULL));
+  EXPECT_TRUE(processor_.packets_.empty());
+
+  WriteResult result = writer.Flush();
+  EXPECT_EQ(WRITE_STATUS_OK, result.status);
+  EXPECT_EQ(24, result.bytes_written);
+  EXPECT_EQ(0u, writer.num_batched_packets());
+
+  ASSERT_TRUE(WaitForPacket());
+  EXPECT_FALSE(reader_.ReadAndDispatchPackets(
+      receive_fd_, receive_address_.port(), &processor_, NULL));
+  ASSERT_EQ(3u, processor_.packets_.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(base::StringPrintf("packet %d", i), processor_.packets_[i]);
+    EXPECT_EQ(send_address_.ToString(),
+              processor_.client_addresses_[i].ToString());
+    EXPECT_EQ(receive_address_.ToString(),
+              processor_.server_addresses_[i].ToString());
+  }
+
+  // Flushing an empty batch writes nothing.
+  result = writer.Flush();
+  EXPECT_EQ(WRITE_STATUS_OK, result.status);
+  EXPECT_EQ(0, result.bytes_written);
+}
+
+TEST_F(QuicBatchPacketWriterTest, SendsFullBatch) {
+  QuicBatchPacketWriter writer(send_fd_);
+  const size_t kNumPackets = QuicBatchPacketWriter::kMaxBatchSize + 1;
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(WRITE_STATUS_OK,
+              WritePacket(&writer, base::StringPrintf("packet %02d",
+                          static_cast<int>(i))).status);
+  }
+  // The full batch went out to make room for the last packet.
+  EXPECT_EQ(1u, writer.num_batched_packets());
+
+  ASSERT_TRUE(WaitForPacket());
+  EXPECT_TRUE(reader_.ReadAndDispatchPackets(
+      receive_fd_, receive_address_.port(), &processor_, NULL));
+  EXPECT_EQ(QuicPacketReader::kNumPacketsPerRead, processor_.packets_.size());
+  EXPECT_FALSE(reader_.ReadAndDispatchPackets(
+      receive_fd_, receive_address_.port(), &processor_, NULL));
+  EXPECT_EQ(QuicBatchPacketWriter::kMaxBatchSize, processor_.packets_.size());
+
+  EXPECT_EQ(WRITE_STATUS_OK, writer.Flush().status);
+  ASSERT_TRUE(WaitForPacket());
+  EXPECT_FALSE(reader_.ReadAndDispatchPackets(
+      receive_fd_, receive_address_.port(), &processor_, NULL));
+  ASSERT_EQ(kNumPackets, processor_.packets_.size());
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(base::StringPrintf("packet %02d", static_cast<int>(i)),
+              processor_.packets_[i]);
+  }
+}
+
+TEST_F(QuicBatchPacketWriterTest, SkipsPacketThatFails) {
+  QuicBatchPacketWriter writer(send_fd_);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket(&writer, "packet 0").status);
+  // Sending to port 0 fails with EINVAL. The packet may belong to another
+  // connection, so it must not fail the flush or hold back the rest.
+  string bad_packet("unsendable");
+  EXPECT_EQ(WRITE_STATUS_OK,
+            writer.WritePacket(bad_packet.data(), bad_packet.length(),
+                               send_address_.address(),
+                               IPEndPoint(receive_address_.address(), 0))
+                .status);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket(&writer, "packet 1").status);
+
+  WriteResult result = writer.Flush();
+  EXPECT_EQ(WRITE_STATUS_OK, result.status);
+  EXPECT_EQ(0u, writer.num_batched_packets());
+  EXPECT_FALSE(writer.IsWriteBlocked());
+
+  ASSERT_TRUE(WaitForPacket());
+  EXPECT_FALSE(reader_.ReadAndDispatchPackets(
+      receive_fd_, receive_address_.port(), &processor_, NULL));
+  ASSERT_EQ(2u, processor_.packets_.size());
+  EXPECT_EQ("packet 0", processor_.packets_[0]);
+  EXPECT_EQ("packet 1", processor_.packets_[1]);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace tools
+}  // namespace net
@@ -28,6 +28,10 @@ WriteResult QuicDefaultPacketWriter::WritePacket(
   return result;
 }
 
+WriteResult QuicDefaultPacketWriter::Flush() {
+  return WriteResult(WRITE_STATUS_OK, 0);
+}
+
 bool QuicDefaultPacketWriter::IsWriteBlockedDataBuffered() const {
   return false;
 }
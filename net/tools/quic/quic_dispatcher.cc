@@ -11,7 +11,7 @@
 #include "base/stl_util.h"
 #include "net/quic/quic_blocked_writer_interface.h"
 #include "net/quic/quic_utils.h"
-#include "net/tools/quic/quic_default_packet_writer.h"
+#include "net/tools/quic/quic_batch_packet_writer.h"
 #include "net/tools/quic/quic_epoll_connection_helper.h"
 #include "net/tools/quic/quic_packet_writer_wrapper.h"
 #include "net/tools/quic/quic_socket_utils.h"
@@ -252,6 +252,10 @@ void QuicDispatcher::DeleteSessions() {
 void QuicDispatcher::OnCanWrite() {
   // We got an EPOLLOUT: the socket should not be blocked.
   writer_->SetWritable();
+  if (writer_->IsWriteBlocked()) {
+    // Resending the packets the writer held on to blocked it again.
+    return;
+  }
 
   // Give each writer one attempt to write.
   int num_writers = write_blocked_list_.size();
@@ -312,7 +316,7 @@ void QuicDispatcher::OnWriteBlocked(QuicBlockedWriterInterface* writer) {
 }
 
 QuicPacketWriter* QuicDispatcher::CreateWriter(int fd) {
-  return new QuicDefaultPacketWriter(fd);
+  return new QuicBatchPacketWriter(fd);
 }
 
 QuicPacketWriterWrapper* QuicDispatcher::CreateWriterWrapper(
@@ -18,6 +18,7 @@
 #include "net/quic/quic_blocked_writer_interface.h"
 #include "net/quic/quic_protocol.h"
 #include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/quic_process_packet_interface.h"
 #include "net/tools/quic/quic_server_session.h"
 #include "net/tools/quic/quic_time_wait_list_manager.h"
 
@@ -52,7 +53,8 @@ class QuicDispatcherPeer;
 class DeleteSessionsAlarm;
 class QuicEpollConnectionHelper;
 
-class QuicDispatcher : public QuicServerSessionVisitor {
+class QuicDispatcher : public QuicServerSessionVisitor,
+                       public ProcessPacketInterface {
  public:
   // Ideally we'd have a linked_hash_set: the  boolean is unused.
   typedef linked_hash_map<QuicBlockedWriterInterface*, bool> WriteBlockedList;
@@ -73,7 +75,7 @@ class QuicDispatcher : public QuicServerSessionVisitor {
   // an existing session, or passing it to the TimeWaitListManager.
   virtual void ProcessPacket(const IPEndPoint& server_address,
                              const IPEndPoint& client_address,
-                             const QuicEncryptedPacket& packet);
+                             const QuicEncryptedPacket& packet) OVERRIDE;
 
   // Called when the socket becomes writable to allow queued writes to happen.
   virtual void OnCanWrite();
@@ -0,0 +1,102 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_packet_reader.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "net/base/ip_endpoint.h"
+#include "net/tools/quic/quic_process_packet_interface.h"
+
+namespace net {
+namespace tools {
+
+// static
+const size_t QuicPacketReader::kNumPacketsPerRead;
+
+QuicPacketReader::QuicPacketReader() {
+  memset(packets_, 0, sizeof(packets_));
+  memset(mmsg_hdrs_, 0, sizeof(mmsg_hdrs_));
+  for (size_t i = 0; i < kNumPacketsPerRead; ++i) {
+    packets_[i].iov.iov_base = packets_[i].buf;
+    packets_[i].iov.iov_len = sizeof(packets_[i].buf);
+    msghdr* hdr = &mmsg_hdrs_[i].msg_hdr;
+    hdr->msg_name = &packets_[i].raw_address;
+    hdr->msg_iov = &packets_[i].iov;
+    hdr->msg_iovlen = 1;
+    hdr->msg_control = packets_[i].cbuf;
+  }
+}
+
+QuicPacketReader::~QuicPacketReader() {}
+
+bool QuicPacketReader::ReadAndDispatchPackets(
+    int fd,
+    int port,
+    ProcessPacketInterface* processor,
+    uint32* packets_dropped) {
+  // The kernel overwrites these with the sizes it filled in.
+  for (size_t i = 0; i < kNumPacketsPerRead; ++i) {
+    msghdr* hdr = &mmsg_hdrs_[i].msg_hdr;
+    hdr->msg_namelen = sizeof(sockaddr_storage);
+    hdr->msg_controllen = sizeof(packets_[i].cbuf);
+    hdr->msg_flags = 0;
+    mmsg_hdrs_[i].msg_len = 0;
+  }
+
+  int packets_read = recvmmsg(fd, mmsg_hdrs_, kNumPacketsPerRead, 0, NULL);
+  if (packets_read < 0) {
+    if (errno == ENOSYS) {
+      return ReadAndDispatchSinglePacket(fd, port, processor, packets_dropped);
+    }
+    if (errno != EAGAIN) {
+      LOG(ERROR) << "Error reading " << strerror(errno);
+    }
+    return false;
+  }
+
+  for (int i = 0; i < packets_read; ++i) {
+    msghdr* hdr = &mmsg_hdrs_[i].msg_hdr;
+    IPEndPoint client_address;
+    CHECK(client_address.FromSockAddr(
+        reinterpret_cast<const sockaddr*>(&packets_[i].raw_address),
+        hdr->msg_namelen));
+    IPEndPoint server_address(QuicSocketUtils::GetAddressFromMsghdr(hdr),
+                              port);
+    if (packets_dropped != NULL) {
+      QuicSocketUtils::GetOverflowFromMsghdr(hdr, packets_dropped);
+    }
+
+    QuicEncryptedPacket packet(packets_[i].buf, mmsg_hdrs_[i].msg_len, false);
+    processor->ProcessPacket(server_address, client_address, packet);
+  }
+
+  return packets_read == static_cast<int>(kNumPacketsPerRead);
+}
+
+bool QuicPacketReader::ReadAndDispatchSinglePacket(
+    int fd,
+    int port,
+    ProcessPacketInterface* processor,
+    uint32* packets_dropped) {
+  IPEndPoint client_address;
+  IPAddressNumber server_ip;
+  int bytes_read =
+      QuicSocketUtils::ReadPacket(fd, packets_[0].buf,
+                                  sizeof(packets_[0].buf), packets_dropped,
+                                  &server_ip, &client_address);
+  if (bytes_read < 0) {
+    return false;  // We failed to read.
+  }
+
+  QuicEncryptedPacket packet(packets_[0].buf, bytes_read, false);
+  IPEndPoint server_address(server_ip, port);
+  processor->ProcessPacket(server_address, client_address, packet);
+  return true;
+}
+
+}  // namespace tools
+}  // namespace net
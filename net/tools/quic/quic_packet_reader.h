@@ -0,0 +1,67 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Reads packets from a socket several at a time with recvmmsg, so that a
+// burst of incoming packets costs one system call rather than one each.
+
+#ifndef NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
+#define NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "base/basictypes.h"
+#include "net/quic/quic_protocol.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+namespace net {
+namespace tools {
+
+class ProcessPacketInterface;
+
+class QuicPacketReader {
+ public:
+  // The most packets read by a single ReadAndDispatchPackets call.
+  static const size_t kNumPacketsPerRead = 16;
+
+  QuicPacketReader();
+  ~QuicPacketReader();
+
+  // Reads the packets waiting on |fd|, up to kNumPacketsPerRead of them, and
+  // passes each to |processor|. The server address of each packet is the
+  // address it was sent to, with |port|. Returns true if the whole batch was
+  // filled, in which case more packets may be waiting, and false otherwise.
+  // If packets_dropped is non-null, the socket is configured to track
+  // dropped packets, and some packets are read, it will be set to the number
+  // of dropped packets.
+  bool ReadAndDispatchPackets(int fd, int port,
+                              ProcessPacketInterface* processor,
+                              uint32* packets_dropped);
+
+ private:
+  // Reads and dispatches a single packet, for kernels without recvmmsg.
+  bool ReadAndDispatchSinglePacket(int fd, int port,
+                                   ProcessPacketInterface* processor,
+                                   uint32* packets_dropped);
+
+  // Storage for one packet, which mmsg_hdrs_ point into.
+  struct PacketData {
+    iovec iov;
+    sockaddr_storage raw_address;
+    char cbuf[QuicSocketUtils::kSpaceForOverflowAndIp];
+    // Allocate some extra space so we can send an error if the client goes
+    // over the limit.
+    char buf[2 * kMaxPacketSize];
+  };
+
+  PacketData packets_[kNumPacketsPerRead];
+  mmsghdr mmsg_hdrs_[kNumPacketsPerRead];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketReader);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
@@ -24,6 +24,10 @@ WriteResult QuicPacketWriterWrapper::WritePacket(
   return writer_->WritePacket(buffer, buf_len, self_address, peer_address);
 }
 
+WriteResult QuicPacketWriterWrapper::Flush() {
+  return writer_->Flush();
+}
+
 bool QuicPacketWriterWrapper::IsWriteBlockedDataBuffered() const {
   return writer_->IsWriteBlockedDataBuffered();
 }
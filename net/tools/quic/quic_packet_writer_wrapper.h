@@ -28,6 +28,7 @@ class QuicPacketWriterWrapper : public net::QuicPacketWriter {
       size_t buf_len,
       const IPAddressNumber& self_address,
       const IPEndPoint& peer_address) OVERRIDE;
+  virtual WriteResult Flush() OVERRIDE;
   virtual bool IsWriteBlockedDataBuffered() const OVERRIDE;
   virtual bool IsWriteBlocked() const OVERRIDE;
   virtual void SetWritable() OVERRIDE;
@@ -19,14 +19,19 @@
 #include "net/quic/quic_data_reader.h"
 #include "net/quic/quic_protocol.h"
 #include "net/tools/quic/quic_in_memory_cache.h"
+#include "net/tools/quic/quic_packet_reader.h"
 #include "net/tools/quic/quic_socket_utils.h"
 
-#define MMSG_MORE 0
+#define MMSG_MORE 1
 
 #ifndef SO_RXQ_OVFL
 #define SO_RXQ_OVFL 40
 #endif
 
+#ifndef SO_REUSEPORT
+#define SO_REUSEPORT 15
+#endif
+
 const int kEpollFlags = EPOLLIN | EPOLLOUT | EPOLLET;
 static const char kSourceAddressTokenSecret[] = "secret";
 
@@ -39,6 +44,7 @@ QuicServer::QuicServer()
       packets_dropped_(0),
       overflow_supported_(false),
       use_recvmmsg_(false),
+      reuse_port_(false),
       crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance()),
       supported_versions_(QuicSupportedVersions()) {
   // Use hardcoded crypto parameters for now.
@@ -56,6 +62,7 @@ QuicServer::QuicServer(const QuicConfig& config,
       packets_dropped_(0),
       overflow_supported_(false),
       use_recvmmsg_(false),
+      reuse_port_(false),
       config_(config),
       crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance()),
       supported_versions_(supported_versions) {
@@ -65,6 +72,7 @@ QuicServer::QuicServer(const QuicConfig& config,
 void QuicServer::Initialize() {
 #if MMSG_MORE
   use_recvmmsg_ = true;
+  packet_reader_.reset(new QuicPacketReader());
 #endif
   epoll_server_.set_timeout_in_us(50 * 1000);
   // Initialize the in memory cache now.
@@ -121,6 +129,16 @@ bool QuicServer::Listen(const IPEndPoint& address) {
     return false;
   }
 
+  if (reuse_port_) {
+    int reuse_port = 1;
+    rc = setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT,
+                    &reuse_port, sizeof(reuse_port));
+    if (rc < 0) {
+      LOG(ERROR) << "SO_REUSEPORT not supported: " << strerror(errno);
+      return false;
+    }
+  }
+
   sockaddr_storage raw_addr;
   socklen_t raw_addr_len = sizeof(raw_addr);
   CHECK(address.ToSockAddr(reinterpret_cast<sockaddr*>(&raw_addr),
@@ -175,9 +193,15 @@ void QuicServer::OnEvent(int fd, EpollEvent* event) {
     DVLOG(1) << "EPOLLIN";
     bool read = true;
     while (read) {
+      if (use_recvmmsg_) {
+        read = packet_reader_->ReadAndDispatchPackets(
+            fd_, port_, dispatcher_.get(),
+            overflow_supported_ ? &packets_dropped_ : NULL);
+      } else {
         read = ReadAndDispatchSinglePacket(
             fd_, port_, dispatcher_.get(),
             overflow_supported_ ? &packets_dropped_ : NULL);
+      }
     }
   }
   if (event->in_events & EPOLLOUT) {
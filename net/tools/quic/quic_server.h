@@ -26,6 +26,7 @@ class QuicServerPeer;
 }  // namespace test
 
 class QuicDispatcher;
+class QuicPacketReader;
 
 class QuicServer : public EpollCallbackInterface {
  public:
@@ -74,6 +75,11 @@ class QuicServer : public EpollCallbackInterface {
 
   int port() { return port_; }
 
+  // If set before Listen(), the socket is bound with SO_REUSEPORT so that
+  // several servers, each with its own epoll loop, can share one port. The
+  // kernel spreads incoming flows across them.
+  void set_reuse_port(bool reuse_port) { reuse_port_ = reuse_port; }
+
  private:
   friend class net::tools::test::QuicServerPeer;
 
@@ -103,6 +109,12 @@ class QuicServer : public EpollCallbackInterface {
   // If true, use recvmmsg for reading.
   bool use_recvmmsg_;
 
+  // If true, Listen() sets SO_REUSEPORT on the socket.
+  bool reuse_port_;
+
+  // Reads batches of packets when use_recvmmsg_ is true.
+  scoped_ptr<QuicPacketReader> packet_reader_;
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   QuicConfig config_;
@@ -3,15 +3,20 @@
 // found in the LICENSE file.
 //
 // A binary wrapper for QuicServer.  It listens forever on --port
-// (default 6121) until it's killed or ctrl-cd to death.
+// (default 6121) until it's killed or ctrl-cd to death.  With
+// --num_threads=N it runs N servers, each on its own thread and socket, that
+// share the port through SO_REUSEPORT.
 
 #include <iostream>
 
 #include "base/at_exit.h"
 #include "base/basictypes.h"
 #include "base/command_line.h"
+#include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/threading/simple_thread.h"
 #include "net/base/ip_endpoint.h"
 #include "net/tools/quic/quic_in_memory_cache.h"
 #include "net/tools/quic/quic_server.h"
@@ -20,6 +25,31 @@
 
 int32 FLAGS_port = 6121;
 
+// The number of server threads.  Each thread has its own socket, epoll loop
+// and dispatcher; the in memory cache is shared read-only.
+int32 FLAGS_num_threads = 1;
+
+namespace {
+
+// Runs a QuicServer that has already been set up with Listen().
+class ServerLoop : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit ServerLoop(net::tools::QuicServer* server) : server_(server) {}
+
+  virtual void Run() OVERRIDE {
+    while (1) {
+      server_->WaitForEvents();
+    }
+  }
+
+ private:
+  net::tools::QuicServer* server_;
+
+  DISALLOW_COPY_AND_ASSIGN(ServerLoop);
+};
+
+}  // namespace
+
 int main(int argc, char *argv[]) {
   CommandLine::Init(argc, argv);
   CommandLine* line = CommandLine::ForCurrentProcess();
@@ -35,6 +65,8 @@ int main(int argc, char *argv[]) {
         "Options:\n"
         "-h, --help                  show this help message and exit\n"
         "--port=<port>               specify the port to listen on\n"
+        "--num_threads=<n>           number of server threads sharing\n"
+        "                            the port\n"
         "--quic_in_memory_cache_dir  directory containing response data\n"
         "                            to load\n";
     std::cout << help_str;
@@ -53,20 +85,45 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (line->HasSwitch("num_threads")) {
+    int num_threads;
+    if (base::StringToInt(line->GetSwitchValueASCII("num_threads"),
+                          &num_threads) && num_threads > 0) {
+      FLAGS_num_threads = num_threads;
+    }
+  }
+
   base::AtExitManager exit_manager;
 
   net::IPAddressNumber ip;
   CHECK(net::ParseIPLiteralToNumber("::", &ip));
 
-  net::tools::QuicServer server;
-
-  if (!server.Listen(net::IPEndPoint(ip, FLAGS_port))) {
-    return 1;
+  // Bind every socket before any loop starts, so that a port assigned by the
+  // kernel to the first server is reused by the others.
+  ScopedVector<net::tools::QuicServer> servers;
+  int port = FLAGS_port;
+  for (int i = 0; i < FLAGS_num_threads; ++i) {
+    net::tools::QuicServer* server = new net::tools::QuicServer();
+    servers.push_back(server);
+    server->set_reuse_port(FLAGS_num_threads > 1);
+    if (!server->Listen(net::IPEndPoint(ip, port))) {
+      return 1;
+    }
+    port = server->port();
   }
 
-  while (1) {
-    server.WaitForEvents();
+  ScopedVector<ServerLoop> loops;
+  ScopedVector<base::DelegateSimpleThread> threads;
+  for (size_t i = 1; i < servers.size(); ++i) {
+    ServerLoop* loop = new ServerLoop(servers[i]);
+    loops.push_back(loop);
+    base::DelegateSimpleThread* thread =
+        new base::DelegateSimpleThread(loop, "QuicServer");
+    threads.push_back(thread);
+    thread->Start();
   }
 
+  ServerLoop(servers[0]).Run();
+
   return 0;
 }
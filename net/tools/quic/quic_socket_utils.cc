@@ -9,6 +9,7 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <algorithm>
 #include <string>
 
 #include "base/basictypes.h"
@@ -22,6 +23,78 @@
 namespace net {
 namespace tools {
 
+namespace {
+
+// The most packets handed to the kernel in one sendmmsg call.
+const size_t kMaxPacketsPerWrite = 16;
+
+const int kSpaceForIpv4 = CMSG_SPACE(sizeof(in_pktinfo));
+const int kSpaceForIpv6 = CMSG_SPACE(sizeof(in6_pktinfo));
+// kSpaceForIp should be big enough to hold both IPv4 and IPv6 packet info.
+const int kSpaceForIp =
+    (kSpaceForIpv4 < kSpaceForIpv6) ? kSpaceForIpv6 : kSpaceForIpv4;
+
+// Everything sendmsg needs to send one packet. |hdr| points into the rest of
+// the struct, so it must not be copied once initialized.
+struct WriteHeader {
+  msghdr hdr;
+  iovec iov;
+  sockaddr_storage raw_address;
+  char cbuf[kSpaceForIp];
+};
+
+void InitWriteHeader(const char* buffer,
+                     size_t buf_len,
+                     const IPAddressNumber& self_address,
+                     const IPEndPoint& peer_address,
+                     WriteHeader* header) {
+  socklen_t address_len = sizeof(header->raw_address);
+  CHECK(peer_address.ToSockAddr(
+      reinterpret_cast<struct sockaddr*>(&header->raw_address),
+      &address_len));
+  header->iov.iov_base = const_cast<char*>(buffer);
+  header->iov.iov_len = buf_len;
+
+  msghdr* hdr = &header->hdr;
+  hdr->msg_name = &header->raw_address;
+  hdr->msg_namelen = address_len;
+  hdr->msg_iov = &header->iov;
+  hdr->msg_iovlen = 1;
+  hdr->msg_flags = 0;
+
+  if (self_address.empty()) {
+    hdr->msg_control = 0;
+    hdr->msg_controllen = 0;
+  } else if (GetAddressFamily(self_address) == ADDRESS_FAMILY_IPV4) {
+    hdr->msg_control = header->cbuf;
+    hdr->msg_controllen = kSpaceForIp;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+
+    cmsg->cmsg_len = CMSG_LEN(sizeof(in_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_PKTINFO;
+    in_pktinfo* pktinfo = reinterpret_cast<in_pktinfo*>(CMSG_DATA(cmsg));
+    memset(pktinfo, 0, sizeof(in_pktinfo));
+    pktinfo->ipi_ifindex = 0;
+    memcpy(&pktinfo->ipi_spec_dst, &self_address[0], self_address.size());
+    hdr->msg_controllen = cmsg->cmsg_len;
+  } else {
+    hdr->msg_control = header->cbuf;
+    hdr->msg_controllen = kSpaceForIp;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+
+    cmsg->cmsg_len = CMSG_LEN(sizeof(in6_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type = IPV6_PKTINFO;
+    in6_pktinfo* pktinfo = reinterpret_cast<in6_pktinfo*>(CMSG_DATA(cmsg));
+    memset(pktinfo, 0, sizeof(in6_pktinfo));
+    memcpy(&pktinfo->ipi6_addr, &self_address[0], self_address.size());
+    hdr->msg_controllen = cmsg->cmsg_len;
+  }
+}
+
+}  // namespace
+
 // static
 IPAddressNumber QuicSocketUtils::GetAddressFromMsghdr(struct msghdr *hdr) {
   if (hdr->msg_controllen > 0) {
@@ -32,14 +105,12 @@ IPAddressNumber QuicSocketUtils::GetAddressFromMsghdr(struct msghdr *hdr) {
       int len = 0;
       if (cmsg->cmsg_type == IPV6_PKTINFO) {
         in6_pktinfo* info = reinterpret_cast<in6_pktinfo*>CMSG_DATA(cmsg);
-        in6_addr addr = info->ipi6_addr;
-        addr_data = reinterpret_cast<const uint8*>(&addr);
-        len = sizeof(addr);
+        addr_data = reinterpret_cast<const uint8*>(&info->ipi6_addr);
+        len = sizeof(info->ipi6_addr);
       } else if (cmsg->cmsg_type == IP_PKTINFO) {
         in_pktinfo* info = reinterpret_cast<in_pktinfo*>CMSG_DATA(cmsg);
-        in_addr addr = info->ipi_addr;
-        addr_data = reinterpret_cast<const uint8*>(&addr);
-        len = sizeof(addr);
+        addr_data = reinterpret_cast<const uint8*>(&info->ipi_addr);
+        len = sizeof(info->ipi_addr);
       } else {
         continue;
       }
@@ -85,8 +156,6 @@ int QuicSocketUtils::ReadPacket(int fd, char* buffer, size_t buf_len,
                                 IPAddressNumber* self_address,
                                 IPEndPoint* peer_address) {
   CHECK(peer_address != NULL);
-  const int kSpaceForOverflowAndIp =
-      CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(in6_pktinfo));
   char cbuf[kSpaceForOverflowAndIp];
   memset(cbuf, 0, arraysize(cbuf));
 
@@ -142,57 +211,10 @@ WriteResult QuicSocketUtils::WritePacket(int fd,
                                          size_t buf_len,
                                          const IPAddressNumber& self_address,
                                          const IPEndPoint& peer_address) {
-  sockaddr_storage raw_address;
-  socklen_t address_len = sizeof(raw_address);
-  CHECK(peer_address.ToSockAddr(
-      reinterpret_cast<struct sockaddr*>(&raw_address),
-      &address_len));
-  iovec iov = {const_cast<char*>(buffer), buf_len};
+  WriteHeader header;
+  InitWriteHeader(buffer, buf_len, self_address, peer_address, &header);
 
-  msghdr hdr;
-  hdr.msg_name = &raw_address;
-  hdr.msg_namelen = address_len;
-  hdr.msg_iov = &iov;
-  hdr.msg_iovlen = 1;
-  hdr.msg_flags = 0;
-
-  const int kSpaceForIpv4 = CMSG_SPACE(sizeof(in_pktinfo));
-  const int kSpaceForIpv6 = CMSG_SPACE(sizeof(in6_pktinfo));
-  // kSpaceForIp should be big enough to hold both IPv4 and IPv6 packet info.
-  const int kSpaceForIp =
-      (kSpaceForIpv4 < kSpaceForIpv6) ? kSpaceForIpv6 : kSpaceForIpv4;
-  char cbuf[kSpaceForIp];
-  if (self_address.empty()) {
-    hdr.msg_control = 0;
-    hdr.msg_controllen = 0;
-  } else if (GetAddressFamily(self_address) == ADDRESS_FAMILY_IPV4) {
-    hdr.msg_control = cbuf;
-    hdr.msg_controllen = kSpaceForIp;
-    cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
-
-    cmsg->cmsg_len = CMSG_LEN(sizeof(in_pktinfo));
-    cmsg->cmsg_level = IPPROTO_IP;
-    cmsg->cmsg_type = IP_PKTINFO;
-    in_pktinfo* pktinfo = reinterpret_cast<in_pktinfo*>(CMSG_DATA(cmsg));
-    memset(pktinfo, 0, sizeof(in_pktinfo));
-    pktinfo->ipi_ifindex = 0;
-    memcpy(&pktinfo->ipi_spec_dst, &self_address[0], self_address.size());
-    hdr.msg_controllen = cmsg->cmsg_len;
-  } else {
-    hdr.msg_control = cbuf;
-    hdr.msg_controllen = kSpaceForIp;
-    cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
-
-    cmsg->cmsg_len = CMSG_LEN(sizeof(in6_pktinfo));
-    cmsg->cmsg_level = IPPROTO_IPV6;
-    cmsg->cmsg_type = IPV6_PKTINFO;
-    in6_pktinfo* pktinfo = reinterpret_cast<in6_pktinfo*>(CMSG_DATA(cmsg));
-    memset(pktinfo, 0, sizeof(in6_pktinfo));
-    memcpy(&pktinfo->ipi6_addr, &self_address[0], self_address.size());
-    hdr.msg_controllen = cmsg->cmsg_len;
-  }
-
-  int rc = sendmsg(fd, &hdr, 0);
+  int rc = sendmsg(fd, &header.hdr, 0);
   if (rc >= 0) {
     return WriteResult(WRITE_STATUS_OK, rc);
   }
@@ -200,5 +222,48 @@ WriteResult QuicSocketUtils::WritePacket(int fd,
       WRITE_STATUS_BLOCKED : WRITE_STATUS_ERROR, errno);
 }
 
+// static
+WriteResult QuicSocketUtils::WritePackets(int fd,
+                                          const OutgoingPacket* packets,
+                                          size_t num_packets,
+                                          size_t* packets_written) {
+  *packets_written = 0;
+  int bytes_written = 0;
+  WriteHeader headers[kMaxPacketsPerWrite];
+  mmsghdr mmsg_hdrs[kMaxPacketsPerWrite];
+  while (*packets_written < num_packets) {
+    const OutgoingPacket* next = packets + *packets_written;
+    size_t num_headers =
+        std::min(num_packets - *packets_written, kMaxPacketsPerWrite);
+    for (size_t i = 0; i < num_headers; ++i) {
+      InitWriteHeader(next[i].buffer, next[i].buf_len, next[i].self_address,
+                      next[i].peer_address, &headers[i]);
+      mmsg_hdrs[i].msg_hdr = headers[i].hdr;
+      mmsg_hdrs[i].msg_len = 0;
+    }
+
+    int rc = sendmmsg(fd, mmsg_hdrs, num_headers, 0);
+    if (rc < 0 && errno == ENOSYS) {
+      // The kernel predates sendmmsg, so send the packets one at a time.
+      rc = sendmsg(fd, &mmsg_hdrs[0].msg_hdr, 0);
+      if (rc >= 0) {
+        mmsg_hdrs[0].msg_len = rc;
+        rc = 1;
+      }
+    }
+    if (rc < 0) {
+      return WriteResult((errno == EAGAIN || errno == EWOULDBLOCK) ?
+          WRITE_STATUS_BLOCKED : WRITE_STATUS_ERROR, errno);
+    }
+    // A short count means the next packet failed. Its error is reported by
+    // the next call.
+    for (int i = 0; i < rc; ++i) {
+      bytes_written += mmsg_hdrs[i].msg_len;
+    }
+    *packets_written += rc;
+  }
+  return WriteResult(WRITE_STATUS_OK, bytes_written);
+}
+
 }  // namespace tools
 }  // namespace net
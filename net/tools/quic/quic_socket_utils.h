@@ -7,6 +7,7 @@
 #ifndef NET_TOOLS_QUIC_QUIC_SOCKET_UTILS_H_
 #define NET_TOOLS_QUIC_QUIC_SOCKET_UTILS_H_
 
+#include <netinet/in.h>
 #include <stddef.h>
 #include <sys/socket.h>
 #include <string>
@@ -19,6 +20,19 @@ namespace tools {
 
 class QuicSocketUtils {
  public:
+  // Control message space needed to receive a packet's destination address
+  // and the socket's dropped packet count.
+  static const int kSpaceForOverflowAndIp =
+      CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(in6_pktinfo));
+
+  // A packet to be sent by WritePackets.
+  struct OutgoingPacket {
+    const char* buffer;
+    size_t buf_len;
+    IPAddressNumber self_address;
+    IPEndPoint peer_address;
+  };
+
   // If the msghdr contains IP_PKTINFO or IPV6_PKTINFO, this will return the
   // IPAddressNumber in that header.  Returns an uninitialized IPAddress on
   // failure.
@@ -54,6 +68,16 @@ class QuicSocketUtils {
   static WriteResult WritePacket(int fd, const char* buffer, size_t buf_len,
                                  const IPAddressNumber& self_address,
                                  const IPEndPoint& peer_address);
+
+  // Writes |num_packets| packets in order, handing as many as possible to the
+  // kernel in each sendmmsg call. Sets packets_written to the number of
+  // packets sent. If all of them are sent, the result's status is
+  // WRITE_STATUS_OK and bytes_written is their total size. Otherwise the
+  // result is that of the first packet which could not be written.
+  static WriteResult WritePackets(int fd,
+                                  const OutgoingPacket* packets,
+                                  size_t num_packets,
+                                  size_t* packets_written);
 };
 
 }  // namespace tools
@@ -215,6 +215,15 @@ bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
       queued_packet->packet()->length(),
       queued_packet->server_address().address(),
       queued_packet->client_address());
+  if (result.status == WRITE_STATUS_OK) {
+    // Nothing else is batched with the reset or close, so send it right away.
+    // If that blocks the writer holds on to the packet and resends it.
+    result = writer_->Flush();
+    if (result.status == WRITE_STATUS_BLOCKED) {
+      visitor_->OnWriteBlocked(this);
+      return true;
+    }
+  }
   if (result.status == WRITE_STATUS_BLOCKED) {
     // If blocked and unbuffered, return false to retry sending.
     DCHECK(writer_->IsWriteBlocked());
@@ -81,6 +81,8 @@ class QuicTimeWaitListManagerTest : public testing::Test {
         .WillRepeatedly(ReturnPointee(&writer_is_blocked_));
     EXPECT_CALL(writer_, IsWriteBlockedDataBuffered())
         .WillRepeatedly(Return(false));
+    EXPECT_CALL(writer_, Flush())
+        .WillRepeatedly(Return(WriteResult(WRITE_STATUS_OK, 0)));
   }
 
   void AddGuid(QuicGuid guid) {
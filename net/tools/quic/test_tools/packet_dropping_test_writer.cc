@@ -170,6 +170,7 @@ QuicTime PacketDroppingTestWriter::ReleaseNextPacket() {
   QuicPacketWriterWrapper::WritePacket(
       iter->buffer.data(), iter->buffer.length(),
       iter->self_address, iter->peer_address);
+  QuicPacketWriterWrapper::Flush();
   DCHECK_GE(cur_buffer_size_, iter->buffer.length());
   cur_buffer_size_ -= iter->buffer.length();
   delayed_packets_.erase(iter);
@@ -91,6 +91,8 @@ QuicCryptoStream* TestSession::GetCryptoStream() {
 }
 
 MockPacketWriter::MockPacketWriter() {
+  ON_CALL(*this, Flush())
+      .WillByDefault(testing::Return(WriteResult(WRITE_STATUS_OK, 0)));
 }
 
 MockPacketWriter::~MockPacketWriter() {
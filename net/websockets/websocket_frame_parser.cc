@@ -34,7 +34,9 @@ const uint64 kPayloadLengthWithEightByteExtendedLengthField = 127;
 namespace net {
 
 WebSocketFrameParser::WebSocketFrameParser()
-    : current_read_pos_(0),
+    : input_(NULL),
+      input_size_(0),
+      current_read_pos_(0),
       frame_offset_(0),
       websocket_error_(kWebSocketNormalClosure) {
   std::fill(masking_key_.key,
@@ -53,10 +55,16 @@ bool WebSocketFrameParser::Decode(
   if (!length)
     return true;
 
-  // TODO(yutak): Remove copy.
-  buffer_.insert(buffer_.end(), data, data + length);
+  input_ = data;
+  input_size_ = length;
+  if (!buffer_.empty()) {
+    // Complete the frame header carried over from the previous round.
+    buffer_.insert(buffer_.end(), data, data + length);
+    input_ = &buffer_.front();
+    input_size_ = buffer_.size();
+  }
 
-  while (current_read_pos_ < buffer_.size()) {
+  while (current_read_pos_ < input_size_) {
     bool first_chunk = false;
     if (!current_frame_header_.get()) {
       DecodeFrameHeader();
@@ -75,13 +83,17 @@ bool WebSocketFrameParser::Decode(
     frame_chunks->push_back(frame_chunk.release());
 
     if (current_frame_header_.get()) {
-      DCHECK(current_read_pos_ == buffer_.size());
+      DCHECK(current_read_pos_ == input_size_);
       break;
     }
   }
 
-  // Drain unnecessary data. TODO(yutak): Remove copy. (but how?)
-  buffer_.erase(buffer_.begin(), buffer_.begin() + current_read_pos_);
+  // Keep an incomplete frame header for the next round of Decode().
+  std::vector<char> remaining(input_ + current_read_pos_,
+                              input_ + input_size_);
+  buffer_.swap(remaining);
+  input_ = NULL;
+  input_size_ = 0;
   current_read_pos_ = 0;
 
   // Sanity check: the size of carried-over data should not exceed
@@ -101,9 +113,9 @@ void WebSocketFrameParser::DecodeFrameHeader() {
 
   DCHECK(!current_frame_header_.get());
 
-  const char* start = &buffer_.front() + current_read_pos_;
+  const char* start = input_ + current_read_pos_;
   const char* current = start;
-  const char* end = &buffer_.front() + buffer_.size();
+  const char* end = input_ + input_size_;
 
   // Header needs 2 bytes at minimum.
   if (end - current < 2)
@@ -143,6 +155,8 @@ void WebSocketFrameParser::DecodeFrameHeader() {
   }
   if (websocket_error_ != kWebSocketNormalClosure) {
     buffer_.clear();
+    input_ = NULL;
+    input_size_ = 0;
     current_read_pos_ = 0;
     current_frame_header_.reset();
     frame_offset_ = 0;
@@ -171,8 +185,8 @@ void WebSocketFrameParser::DecodeFrameHeader() {
 
 scoped_ptr<WebSocketFrameChunk> WebSocketFrameParser::DecodeFramePayload(
     bool first_chunk) {
-  const char* current = &buffer_.front() + current_read_pos_;
-  const char* end = &buffer_.front() + buffer_.size();
+  const char* current = input_ + current_read_pos_;
+  const char* end = input_ + input_size_;
   uint64 next_size = std::min<uint64>(
       end - current, current_frame_header_->payload_length - frame_offset_);
   // This check must pass because |payload_length| is already checked to be
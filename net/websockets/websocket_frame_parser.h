@@ -63,10 +63,16 @@ class NET_EXPORT WebSocketFrameParser {
   // |current_frame_header_|, |frame_offset_| and |masking_key_|.
   scoped_ptr<WebSocketFrameChunk> DecodeFramePayload(bool first_chunk);
 
-  // Internal buffer to store the data to parse.
+  // Holds a frame header that was split across Decode() calls. Data is only
+  // copied here while such a partial header is pending.
   std::vector<char> buffer_;
 
-  // Position in |buffer_| where the next round of parsing starts.
+  // The data being parsed by the current Decode() call. Points either at the
+  // caller's data or, if a partial header was carried over, at |buffer_|.
+  const char* input_;
+  size_t input_size_;
+
+  // Position in |input_| where the next round of parsing starts.
   size_t current_read_pos_;
 
   // Frame header and masking key of the current frame.
@@ -29,6 +29,10 @@ namespace {
 // map for the encoder.
 const int kMacroBlockSize = 16;
 
+// Frames at least this tall are encoded with 4 threads on machines with more
+// than 4 processors.
+const int kMinHeightForFourThreads = 1440;
+
 ScopedVpxCodec CreateVP8Codec(const webrtc::DesktopSize& size) {
   ScopedVpxCodec codec(new vpx_codec_ctx_t);
 
@@ -55,7 +59,13 @@ ScopedVpxCodec CreateVP8Codec(const webrtc::DesktopSize& size) {
   // adequate processing power. NB: Going to multiple threads on low end
   // windows systems can really hurt performance.
   // http://crbug.com/99179
-  config.g_threads = (base::SysInfo::NumberOfProcessors() > 2) ? 2 : 1;
+  // VP8 spreads macroblock rows across threads, so very tall desktops keep
+  // more threads busy; allow 4 of them when there are cores to spare.
+  int number_of_processors = base::SysInfo::NumberOfProcessors();
+  if (number_of_processors > 4 && size.height() >= kMinHeightForFourThreads)
+    config.g_threads = 4;
+  else
+    config.g_threads = (number_of_processors > 2) ? 2 : 1;
   config.rc_min_quantizer = 20;
   config.rc_max_quantizer = 30;
   config.g_timebase.num = 1;
@@ -74,6 +84,16 @@ ScopedVpxCodec CreateVP8Codec(const webrtc::DesktopSize& size) {
   if (vpx_codec_control(codec.get(), VP8E_SET_NOISE_SENSITIVITY, 0))
     return ScopedVpxCodec();
 
+  // Splitting the coefficient tokens into one partition per thread lets the
+  // encoder pack them in parallel, and lets the client decode them in
+  // parallel too.
+  if (config.g_threads > 1) {
+    vp8e_token_partitions partitions = config.g_threads > 2 ?
+        VP8_FOUR_TOKENPARTITION : VP8_TWO_TOKENPARTITION;
+    if (vpx_codec_control(codec.get(), VP8E_SET_TOKEN_PARTITIONS, partitions))
+      return ScopedVpxCodec();
+  }
+
   return codec.Pass();
 }
 
@@ -76,7 +76,9 @@ AnalysisDevice::AnalysisDevice(const SkBitmap& bitmap)
       is_forced_not_transparent_(false),
       is_solid_color_(true),
       is_transparent_(true),
-      has_text_(false) {}
+      has_text_(false),
+      draw_op_count_(0),
+      has_image_filters_(false) {}
 
 AnalysisDevice::~AnalysisDevice() {}
 
@@ -96,6 +98,14 @@ bool AnalysisDevice::HasText() const {
   return has_text_;
 }
 
+int AnalysisDevice::GetDrawOpCount() const {
+  return draw_op_count_;
+}
+
+bool AnalysisDevice::HasImageFilters() const {
+  return has_image_filters_;
+}
+
 void AnalysisDevice::SetForceNotSolid(bool flag) {
   is_forced_not_solid_ = flag;
   if (is_forced_not_solid_)
@@ -121,6 +131,7 @@ void AnalysisDevice::clear(SkColor color) {
 }
 
 void AnalysisDevice::drawPaint(const SkDraw& draw, const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -130,6 +141,7 @@ void AnalysisDevice::drawPoints(const SkDraw& draw,
                                 size_t count,
                                 const SkPoint points[],
                                 const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -137,6 +149,7 @@ void AnalysisDevice::drawPoints(const SkDraw& draw,
 void AnalysisDevice::drawRect(const SkDraw& draw,
                               const SkRect& rect,
                               const SkPaint& paint) {
+  ++draw_op_count_;
   bool does_cover_canvas =
       IsFullQuad(draw, SkRect::MakeWH(width(), height()), rect);
 
@@ -178,6 +191,7 @@ void AnalysisDevice::drawRect(const SkDraw& draw,
 void AnalysisDevice::drawOval(const SkDraw& draw,
                               const SkRect& oval,
                               const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -185,6 +199,7 @@ void AnalysisDevice::drawOval(const SkDraw& draw,
 void AnalysisDevice::drawRRect(const SkDraw& draw,
                                const SkRRect& rr,
                                const SkPaint& paint) {
+  ++draw_op_count_;
   // This should add the SkRRect to an SkPath, and call
   // drawPath, but since drawPath ignores the SkPath, just
   // do the same work here.
@@ -197,6 +212,7 @@ void AnalysisDevice::drawPath(const SkDraw& draw,
                               const SkPaint& paint,
                               const SkMatrix* pre_path_matrix,
                               bool path_is_mutable) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -205,6 +221,7 @@ void AnalysisDevice::drawBitmap(const SkDraw& draw,
                                 const SkBitmap& bitmap,
                                 const SkMatrix& matrix,
                                 const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -214,6 +231,9 @@ void AnalysisDevice::drawSprite(const SkDraw& draw,
                                 int x,
                                 int y,
                                 const SkPaint& paint) {
+  ++draw_op_count_;
+  if (paint.getImageFilter())
+    has_image_filters_ = true;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -236,6 +256,7 @@ void AnalysisDevice::drawText(const SkDraw& draw,
                               SkScalar x,
                               SkScalar y,
                               const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
   has_text_ = true;
@@ -248,6 +269,7 @@ void AnalysisDevice::drawPosText(const SkDraw& draw,
                                  SkScalar const_y,
                                  int scalars_per_pos,
                                  const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
   has_text_ = true;
@@ -259,6 +281,7 @@ void AnalysisDevice::drawTextOnPath(const SkDraw& draw,
                                     const SkPath& path,
                                     const SkMatrix* matrix,
                                     const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
   has_text_ = true;
@@ -274,6 +297,7 @@ void AnalysisDevice::drawVertices(const SkDraw& draw,
                                   const uint16_t indices[],
                                   int index_count,
                                   const SkPaint& paint) {
+  ++draw_op_count_;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -283,6 +307,9 @@ void AnalysisDevice::drawDevice(const SkDraw& draw,
                                 int x,
                                 int y,
                                 const SkPaint& paint) {
+  ++draw_op_count_;
+  if (paint.getImageFilter())
+    has_image_filters_ = true;
   is_solid_color_ = false;
   is_transparent_ = false;
 }
@@ -303,6 +330,14 @@ bool AnalysisCanvas::HasText() const {
   return (static_cast<AnalysisDevice*>(getDevice()))->HasText();
 }
 
+int AnalysisCanvas::GetDrawOpCount() const {
+  return (static_cast<AnalysisDevice*>(getDevice()))->GetDrawOpCount();
+}
+
+bool AnalysisCanvas::HasImageFilters() const {
+  return (static_cast<AnalysisDevice*>(getDevice()))->HasImageFilters();
+}
+
 bool AnalysisCanvas::abortDrawing() {
   // Early out as soon as we have detected that the tile has text.
   return HasText();
@@ -28,6 +28,13 @@ class SK_API AnalysisCanvas : public SkCanvas, public SkDrawPictureCallback {
   // Returns true when a SkColor can be used to represent result.
   bool GetColorIfSolid(SkColor* color) const;
   bool HasText() const;
+  // The number of draw calls which reached the device, as an estimate of the
+  // cost of rasterizing the region. Playback stops at the first text, so this
+  // is a lower bound when HasText() is true.
+  int GetDrawOpCount() const;
+  // Returns true when something was drawn with an image filter, which may
+  // read pixels from outside the region.
+  bool HasImageFilters() const;
 
   // SkDrawPictureCallback override.
   virtual bool abortDrawing() OVERRIDE;
@@ -68,6 +75,8 @@ class SK_API AnalysisDevice : public SkBitmapDevice {
 
   bool GetColorIfSolid(SkColor* color) const;
   bool HasText() const;
+  int GetDrawOpCount() const;
+  bool HasImageFilters() const;
 
   void SetForceNotSolid(bool flag);
   void SetForceNotTransparent(bool flag);
@@ -154,6 +163,8 @@ class SK_API AnalysisDevice : public SkBitmapDevice {
   SkColor color_;
   bool is_transparent_;
   bool has_text_;
+  int draw_op_count_;
+  bool has_image_filters_;
 };
 
 }  // namespace skia
@@ -404,4 +404,29 @@ TEST(AnalysisCanvasTest, HasText) {
   }
 }
 
+
+TEST(AnalysisCanvasTest, DrawOpCount) {
+  SkBitmap bitmap;
+  bitmap.setConfig(SkBitmap::kNo_Config, 255, 255);
+  skia::AnalysisDevice device(bitmap);
+  skia::AnalysisCanvas canvas(&device);
+  EXPECT_EQ(0, canvas.GetDrawOpCount());
+
+  // Clearing doesn't count as drawing.
+  SolidColorFill(canvas);
+  EXPECT_EQ(0, canvas.GetDrawOpCount());
+
+  SkPaint paint;
+  paint.setColor(SK_ColorGRAY);
+  canvas.drawRect(SkRect::MakeWH(100, 100), paint);
+  canvas.drawOval(SkRect::MakeWH(100, 100), paint);
+  EXPECT_EQ(2, canvas.GetDrawOpCount());
+
+  // Draws outside the clip don't reach the device.
+  canvas.clipRect(SkRect::MakeWH(100, 100));
+  canvas.drawRect(SkRect::MakeXYWH(150, 150, 50, 50), paint);
+  EXPECT_EQ(2, canvas.GetDrawOpCount());
+  EXPECT_FALSE(canvas.HasImageFilters());
+}
+
 }  // namespace skia
@@ -31,6 +31,9 @@ namespace {
 // TODO(shess): Better story on this.  http://crbug.com/56559
 const int kBusyTimeoutSeconds = 1;
 
+// Number of recently used statements GetUniqueStatement() keeps compiled.
+const size_t kUniqueStatementCacheSize = 16;
+
 class ScopedBusyTimeout {
  public:
   explicit ScopedBusyTimeout(sqlite3* db)
@@ -216,6 +219,8 @@ Connection::Connection()
       cache_size_(0),
       exclusive_locking_(false),
       restrict_to_user_(false),
+      wal_mode_(false),
+      unique_statement_cache_(kUniqueStatementCacheSize),
       transaction_nesting_(0),
       needs_rollback_(false),
       in_memory_(false),
@@ -267,6 +272,7 @@ void Connection::CloseInternal(bool forced) {
 
   // Release cached statements.
   statement_cache_.clear();
+  unique_statement_cache_.Clear();
 
   // With cached statements released, in-use statements will remain.
   // Closing the database while statements are in use is an API
@@ -721,6 +727,15 @@ scoped_refptr<Connection::StatementRef> Connection::GetUniqueStatement(
   if (!db_)
     return new StatementRef(NULL, NULL, poisoned_);
 
+  // Reuse the statement compiled by an earlier call with the same SQL, unless
+  // the cache holds the only reference to it.
+  UniqueStatementCache::iterator i = unique_statement_cache_.Get(sql);
+  if (i != unique_statement_cache_.end() && i->second->HasOneRef()) {
+    DCHECK(i->second->is_valid());
+    sqlite3_reset(i->second->stmt());
+    return i->second;
+  }
+
   sqlite3_stmt* stmt = NULL;
   int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL);
   if (rc != SQLITE_OK) {
@@ -731,7 +746,13 @@ scoped_refptr<Connection::StatementRef> Connection::GetUniqueStatement(
     OnSqliteError(rc, NULL, sql);
     return new StatementRef(NULL, NULL, false);
   }
-  return new StatementRef(this, stmt, true);
+  scoped_refptr<StatementRef> statement(new StatementRef(this, stmt, true));
+
+  // If the cached statement is in use, leave it there; it becomes available
+  // again once its user is done with it.
+  if (i == unique_statement_cache_.end())
+    unique_statement_cache_.Put(sql, statement);
+  return statement;
 }
 
 scoped_refptr<Connection::StatementRef> Connection::GetUntrackedStatement(
@@ -977,7 +998,10 @@ bool Connection::OpenInternal(const std::string& file_name,
   // TODO(shess): Figure out if PERSIST and journal_size_limit really
   // matter.  In theory, it keeps pages pre-allocated, so if
   // transactions usually fit, it should be faster.
-  ignore_result(Execute("PRAGMA journal_mode = PERSIST"));
+  // With |wal_mode_|, the journal mode is set below, once |page_size_| has
+  // been applied.  journal_size_limit then bounds the -wal file.
+  if (!wal_mode_)
+    ignore_result(Execute("PRAGMA journal_mode = PERSIST"));
   ignore_result(Execute("PRAGMA journal_size_limit = 16384"));
 
   const base::TimeDelta kBusyTimeout =
@@ -1000,6 +1024,15 @@ bool Connection::OpenInternal(const std::string& file_name,
     ignore_result(ExecuteWithTimeout(sql.c_str(), kBusyTimeout));
   }
 
+  // The page size of a database in WAL mode can't be changed, so this has to
+  // come after the page_size pragma.  In WAL mode, synchronous=NORMAL only
+  // syncs on checkpoint rather than on every commit.
+  if (wal_mode_) {
+    ignore_result(ExecuteWithTimeout("PRAGMA journal_mode = WAL",
+                                     kBusyTimeout));
+    ignore_result(Execute("PRAGMA synchronous = NORMAL"));
+  }
+
   if (!ExecuteWithTimeout("PRAGMA secure_delete=ON", kBusyTimeout)) {
     bool was_poisoned = poisoned_;
     Close();
@@ -13,6 +13,7 @@
 #include "base/basictypes.h"
 #include "base/callback.h"
 #include "base/compiler_specific.h"
+#include "base/containers/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/thread_restrictions.h"
@@ -117,6 +118,18 @@ class SQL_EXPORT Connection {
   // This must be called before Open() to have an effect.
   void set_exclusive_locking() { exclusive_locking_ = true; }
 
+  // Call to use a write-ahead log instead of a rollback journal. Commits
+  // append to the -wal file and don't sync it; SQLite syncs when it
+  // checkpoints the log back into the database. A commit can be lost on power
+  // failure, but the database stays consistent. Readers and the writer don't
+  // block each other.
+  //
+  // Every connection to the database should call this; a connection without
+  // it tries to switch the database back to a rollback journal on Open().
+  //
+  // This must be called before Open() to have an effect.
+  void set_wal_mode() { wal_mode_ = true; }
+
   // Call to cause Open() to restrict access permissions of the
   // database file to only the owner.
   // TODO(shess): Currently only supported on OS_POSIX, is a noop on
@@ -352,9 +365,10 @@ class SQL_EXPORT Connection {
   // valid SQL, returns true.
   bool IsSQLValid(const char* sql);
 
-  // Returns a non-cached statement for the given SQL. Use this for SQL that
-  // is only executed once or only rarely (there is overhead associated with
-  // keeping a statement cached).
+  // Returns a statement for the given SQL without a caller-managed
+  // StatementID. Use this for SQL that is only executed once or only rarely.
+  // The last few compiled statements are kept in a small MRU cache keyed by
+  // the SQL text, and are handed out again if no one else is using them.
   //
   // See GetCachedStatement above for examples and error information.
   scoped_refptr<StatementRef> GetUniqueStatement(const char* sql);
@@ -557,6 +571,7 @@ class SQL_EXPORT Connection {
   int cache_size_;
   bool exclusive_locking_;
   bool restrict_to_user_;
+  bool wal_mode_;
 
   // All cached statements. Keeping a reference to these statements means that
   // they'll remain active.
@@ -564,6 +579,12 @@ class SQL_EXPORT Connection {
       CachedStatementMap;
   CachedStatementMap statement_cache_;
 
+  // Recently compiled statements handed out by GetUniqueStatement(), keyed by
+  // their SQL.
+  typedef base::MRUCache<std::string, scoped_refptr<StatementRef> >
+      UniqueStatementCache;
+  UniqueStatementCache unique_statement_cache_;
+
   // A list of all StatementRefs we've given out. Each ref must register with
   // us when it's created or destroyed. This allows us to potentially close
   // any open statements when we encounter an error.
@@ -167,6 +167,41 @@ TEST_F(SQLConnectionTest, CachedStatement) {
   EXPECT_FALSE(db().HasCachedStatement(SQL_FROM_HERE));
 }
 
+// GetUniqueStatement() may hand out a statement compiled by an earlier call,
+// but never one that is still in use.
+TEST_F(SQLConnectionTest, UniqueStatementReuse) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (1)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (2)"));
+
+  const char kSql[] = "SELECT a FROM foo WHERE a >= ? ORDER BY a";
+  {
+    sql::Statement s(db().GetUniqueStatement(kSql));
+    s.BindInt(0, 2);
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(2, s.ColumnInt(0));
+  }
+
+  // A reused statement starts out reset, with no bindings left over.
+  sql::Statement outer(db().GetUniqueStatement(kSql));
+  outer.BindInt(0, 1);
+  ASSERT_TRUE(outer.Step());
+  EXPECT_EQ(1, outer.ColumnInt(0));
+
+  // A second statement with the same SQL doesn't disturb the first one.
+  {
+    sql::Statement inner(db().GetUniqueStatement(kSql));
+    inner.BindInt(0, 2);
+    ASSERT_TRUE(inner.Step());
+    EXPECT_EQ(2, inner.ColumnInt(0));
+    EXPECT_FALSE(inner.Step());
+  }
+
+  ASSERT_TRUE(outer.Step());
+  EXPECT_EQ(2, outer.ColumnInt(0));
+  EXPECT_FALSE(outer.Step());
+}
+
 TEST_F(SQLConnectionTest, IsSQLValidTest) {
   ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
   ASSERT_TRUE(db().IsSQLValid("SELECT a FROM foo"));
@@ -363,6 +398,49 @@ TEST_F(SQLConnectionTest, RazePageSize) {
   ASSERT_EQ(kPageSize, s.ColumnInt(0));
 }
 
+// Test that set_wal_mode() keeps the requested page size, lets readers run
+// alongside a writer, and works with Raze().
+TEST_F(SQLConnectionTest, WALMode) {
+  const int kPageSize = 4096;
+  db().Close();
+  db().set_page_size(kPageSize);
+  db().set_wal_mode();
+  ASSERT_TRUE(db().Open(db_path()));
+
+  {
+    sql::Statement s(db().GetUniqueStatement("PRAGMA journal_mode"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ("wal", s.ColumnString(0));
+  }
+  {
+    sql::Statement s(db().GetUniqueStatement("PRAGMA page_size"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(kPageSize, s.ColumnInt(0));
+  }
+
+  const char* kCreateSql = "CREATE TABLE foo (id INTEGER PRIMARY KEY, value)";
+  ASSERT_TRUE(db().Execute(kCreateSql));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (12)"));
+
+  // An uncommitted write doesn't block a reader in another connection, which
+  // sees the last committed state.
+  sql::Connection other_db;
+  other_db.set_wal_mode();
+  ASSERT_TRUE(other_db.Open(db_path()));
+  ASSERT_TRUE(db().BeginTransaction());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (13)"));
+  {
+    sql::Statement s(other_db.GetUniqueStatement("SELECT COUNT(*) FROM foo"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(1, s.ColumnInt(0));
+  }
+  ASSERT_TRUE(db().CommitTransaction());
+
+  other_db.Close();
+  ASSERT_TRUE(db().Raze());
+  EXPECT_FALSE(db().DoesTableExist("foo"));
+}
+
 // Test that Raze() results are seen in other connections.
 TEST_F(SQLConnectionTest, RazeMultiple) {
   const char* kCreateSql = "CREATE TABLE foo (id INTEGER PRIMARY KEY, value)";
@@ -8,6 +8,7 @@
 #include "base/metrics/histogram.h"
 #include "base/strings/utf_string_conversions.h"
 #include "env_chromium_stdio.h"
+#include "leveldb/cache.h"
 #include "third_party/re2/re2/re2.h"
 
 #if defined(OS_WIN)
@@ -109,6 +110,22 @@ class IDBEnvWin : public ChromiumEnvWin {
 ::base::LazyInstance<ChromiumEnvStdio>::Leaky default_env =
     LAZY_INSTANCE_INITIALIZER;
 
+// Every origin gets its own IndexedDB database. Rather than give each one
+// LevelDB's default 8MB block cache, they all share a cache of that size.
+const size_t kIDBBlockCacheSize = 8 * 1024 * 1024;
+
+class IDBBlockCacheHolder {
+ public:
+  IDBBlockCacheHolder() : cache_(NewLRUCache(kIDBBlockCacheSize)) {}
+  Cache* cache() { return cache_; }
+
+ private:
+  Cache* cache_;
+};
+
+::base::LazyInstance<IDBBlockCacheHolder>::Leaky idb_block_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // unnamed namespace
 
 const char* MethodIDToString(MethodID method) {
@@ -849,6 +866,10 @@ Env* IDBEnv() {
   return leveldb_env::idb_env.Pointer();
 }
 
+Cache* IDBBlockCache() {
+  return leveldb_env::idb_block_cache.Pointer()->cache();
+}
+
 Env* Env::Default() {
   return leveldb_env::default_env.Pointer();
 }
@@ -7,8 +7,13 @@
 
 namespace leveldb {
 
+class Cache;
+
 Env* IDBEnv();
 
+// Block cache shared by all IndexedDB databases in the process.
+Cache* IDBBlockCache();
+
 }
 
 #endif
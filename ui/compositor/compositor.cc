@@ -214,6 +214,10 @@ Compositor::Compositor(gfx::AcceleratedWidget widget)
 #if defined(OS_CHROMEOS)
   settings.per_tile_painting_enabled = true;
 #endif
+  settings.impl_side_painting =
+      command_line->HasSwitch(switches::kUIEnableImplSidePainting);
+  settings.gpu_rasterization = settings.impl_side_painting &&
+      command_line->HasSwitch(switches::kUIEnableGPURasterization);
 
   // These flags should be mirrored by renderer versions in content/renderer/.
   settings.initial_debug_state.show_debug_borders =
@@ -15,6 +15,14 @@ const char kEnablePixelOutputInTests[] = "enable-pixel-output-in-tests";
 
 const char kUIDisableThreadedCompositing[] = "ui-disable-threaded-compositing";
 
+// Rasterizes browser UI layers with Ganesh. Only effective together with
+// kUIEnableImplSidePainting.
+const char kUIEnableGPURasterization[] = "ui-enable-gpu-rasterization";
+
+// Records browser UI layers into cc::PictureLayers that are rasterized on the
+// impl side instead of painting and uploading them on the UI thread.
+const char kUIEnableImplSidePainting[] = "ui-enable-impl-side-painting";
+
 const char kUIShowPaintRects[] = "ui-show-paint-rects";
 
 }  // namespace switches
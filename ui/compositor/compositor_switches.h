@@ -12,6 +12,8 @@ namespace switches {
 COMPOSITOR_EXPORT extern const char kDisableTestCompositor[];
 COMPOSITOR_EXPORT extern const char kEnablePixelOutputInTests[];
 COMPOSITOR_EXPORT extern const char kUIDisableThreadedCompositing[];
+COMPOSITOR_EXPORT extern const char kUIEnableGPURasterization[];
+COMPOSITOR_EXPORT extern const char kUIEnableImplSidePainting[];
 COMPOSITOR_EXPORT extern const char kUIShowPaintRects[];
 
 }  // namespace switches
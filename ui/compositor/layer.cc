@@ -14,6 +14,7 @@
 #include "cc/base/scoped_ptr_algorithm.h"
 #include "cc/layers/content_layer.h"
 #include "cc/layers/delegated_renderer_layer.h"
+#include "cc/layers/picture_layer.h"
 #include "cc/layers/solid_color_layer.h"
 #include "cc/layers/texture_layer.h"
 #include "cc/output/copy_output_request.h"
@@ -40,6 +41,17 @@ const ui::Layer* GetRoot(const ui::Layer* layer) {
   return layer;
 }
 
+// Creates the cc layer that paints the contents of a LAYER_TEXTURED layer.
+// Picture layers record the contents and rasterize them on the impl side,
+// which requires the Compositor to run with impl-side painting, see
+// switches::kUIEnableImplSidePainting.
+scoped_refptr<cc::Layer> CreateContentLayer(cc::ContentLayerClient* client) {
+  if (CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kUIEnableImplSidePainting))
+    return cc::PictureLayer::Create(client);
+  return cc::ContentLayer::Create(client);
+}
+
 }  // namespace
 
 namespace ui {
@@ -469,7 +481,7 @@ void Layer::SwitchToLayer(scoped_refptr<cc::Layer> new_layer) {
 }
 
 void Layer::SwitchCCLayerForTest() {
-  scoped_refptr<cc::ContentLayer> new_layer = cc::ContentLayer::Create(this);
+  scoped_refptr<cc::Layer> new_layer = CreateContentLayer(this);
   SwitchToLayer(new_layer);
   content_layer_ = new_layer;
 }
@@ -536,7 +548,7 @@ void Layer::SetShowPaintedContent() {
   if (content_layer_.get())
     return;
 
-  scoped_refptr<cc::ContentLayer> new_layer = cc::ContentLayer::Create(this);
+  scoped_refptr<cc::Layer> new_layer = CreateContentLayer(this);
   SwitchToLayer(new_layer);
   content_layer_ = new_layer;
 
@@ -882,7 +894,7 @@ void Layer::CreateWebLayer() {
     solid_color_layer_ = cc::SolidColorLayer::Create();
     cc_layer_ = solid_color_layer_.get();
   } else {
-    content_layer_ = cc::ContentLayer::Create(this);
+    content_layer_ = CreateContentLayer(this);
     cc_layer_ = content_layer_.get();
   }
   cc_layer_->SetAnchorPoint(gfx::PointF());
@@ -31,7 +31,6 @@
 class SkCanvas;
 
 namespace cc {
-class ContentLayer;
 class CopyOutputRequest;
 class DelegatedFrameProvider;
 class DelegatedRendererLayer;
@@ -457,7 +456,7 @@ class COMPOSITOR_EXPORT Layer
 
   // Ownership of the layer is held through one of the strongly typed layer
   // pointers, depending on which sort of layer this is.
-  scoped_refptr<cc::ContentLayer> content_layer_;
+  scoped_refptr<cc::Layer> content_layer_;
   scoped_refptr<cc::TextureLayer> texture_layer_;
   scoped_refptr<cc::SolidColorLayer> solid_color_layer_;
   scoped_refptr<cc::DelegatedRendererLayer> delegated_renderer_layer_;
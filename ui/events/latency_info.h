@@ -34,6 +34,10 @@ enum LatencyComponentType {
   INPUT_EVENT_LATENCY_ORIGINAL_COMPONENT,
   // Timestamp when the UI event is created.
   INPUT_EVENT_LATENCY_UI_COMPONENT,
+  // Timestamp when the event reaches the renderer's compositor thread.
+  INPUT_EVENT_LATENCY_RENDERER_IMPL_COMPONENT,
+  // Timestamp when the event reaches the renderer's main thread.
+  INPUT_EVENT_LATENCY_RENDERER_MAIN_COMPONENT,
   // This is special component indicating there is rendering scheduled for
   // the event associated with this LatencyInfo.
   INPUT_EVENT_LATENCY_RENDERING_SCHEDULED_COMPONENT,
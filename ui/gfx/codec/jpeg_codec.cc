@@ -455,15 +455,43 @@ class DecompressDestroyer {
   jpeg_decompress_struct* cinfo_;
 };
 
-}  // namespace
+// Destination of the decoded pixels: either a vector of bytes or the pixel
+// memory of an SkBitmap, so that bitmaps are decoded in place.
+class DecodeOutput {
+ public:
+  explicit DecodeOutput(std::vector<unsigned char>* vector)
+      : vector_(vector), bitmap_(NULL) {
+    vector_->clear();
+  }
+  explicit DecodeOutput(SkBitmap* bitmap) : vector_(NULL), bitmap_(bitmap) {}
+
+  // Returns storage for |height| rows of |row_stride| bytes, or NULL on
+  // failure.
+  unsigned char* Allocate(int width, int height, int row_stride) {
+    if (vector_) {
+      vector_->resize(row_stride * height);
+      return vector_->empty() ? NULL : &(*vector_)[0];
+    }
+    // Only FORMAT_SkBitmap is decoded into a bitmap, which is 4 bytes per
+    // pixel with no row padding.
+    DCHECK_EQ(width * 4, row_stride);
+    bitmap_->setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    if (!bitmap_->allocPixels())
+      return NULL;
+    return static_cast<unsigned char*>(bitmap_->getPixels());
+  }
 
-bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
-                       ColorFormat format, std::vector<unsigned char>* output,
-                       int* w, int* h) {
+ private:
+  std::vector<unsigned char>* vector_;
+  SkBitmap* bitmap_;
+};
+
+bool DecodeImpl(const unsigned char* input, size_t input_size,
+                JPEGCodec::ColorFormat format, DecodeOutput* output,
+                int* w, int* h) {
   jpeg_decompress_struct cinfo;
   DecompressDestroyer destroyer;
   destroyer.SetManagedObject(&cinfo);
-  output->clear();
 
   // We set up the normal JPEG error routines, then override error_exit.
   // This must be done before the call to create_decompress.
@@ -509,15 +537,15 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
       // Same as JPEGCodec::Encode(), libjpeg-turbo supports all input formats
       // used by Chromium (i.e. RGB, RGBA, and BGRA) and we just map the input
       // parameters to a colorspace.
-      if (format == FORMAT_RGB) {
+      if (format == JPEGCodec::FORMAT_RGB) {
         cinfo.out_color_space = JCS_RGB;
         cinfo.output_components = 3;
-      } else if (format == FORMAT_RGBA ||
-                 (format == FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
+      } else if (format == JPEGCodec::FORMAT_RGBA ||
+                 (format == JPEGCodec::FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
         cinfo.out_color_space = JCS_EXT_RGBX;
         cinfo.output_components = 4;
-      } else if (format == FORMAT_BGRA ||
-                 (format == FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
+      } else if (format == JPEGCodec::FORMAT_BGRA ||
+                 (format == JPEGCodec::FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
         cinfo.out_color_space = JCS_EXT_BGRX;
         cinfo.output_components = 4;
       } else {
@@ -556,21 +584,29 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   // Create memory for a decoded image and write decoded lines to the memory
   // without conversions same as JPEGCodec::Encode().
   int row_write_stride = row_read_stride;
-  output->resize(row_write_stride * cinfo.output_height);
+  unsigned char* pixels =
+      output->Allocate(cinfo.output_width, cinfo.output_height,
+                       row_write_stride);
+  if (!pixels)
+    return false;
 
   for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
-    unsigned char* rowptr = &(*output)[row * row_write_stride];
+    unsigned char* rowptr = pixels + row * row_write_stride;
     if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
       return false;
   }
 #else
-  if (format == FORMAT_RGB) {
+  if (format == JPEGCodec::FORMAT_RGB) {
     // easy case, row needs no conversion
     int row_write_stride = row_read_stride;
-    output->resize(row_write_stride * cinfo.output_height);
+    unsigned char* pixels =
+        output->Allocate(cinfo.output_width, cinfo.output_height,
+                         row_write_stride);
+    if (!pixels)
+      return false;
 
     for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
-      unsigned char* rowptr = &(*output)[row * row_write_stride];
+      unsigned char* rowptr = pixels + row * row_write_stride;
       if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
         return false;
     }
@@ -580,12 +616,12 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
     // allocation by doing the expansion in-place.
     int row_write_stride;
     void (*converter)(const unsigned char* rgb, int w, unsigned char* out);
-    if (format == FORMAT_RGBA ||
-        (format == FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
+    if (format == JPEGCodec::FORMAT_RGBA ||
+        (format == JPEGCodec::FORMAT_SkBitmap && SK_R32_SHIFT == 0)) {
       row_write_stride = cinfo.output_width * 4;
       converter = AddAlpha;
-    } else if (format == FORMAT_BGRA ||
-               (format == FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
+    } else if (format == JPEGCodec::FORMAT_BGRA ||
+               (format == JPEGCodec::FORMAT_SkBitmap && SK_B32_SHIFT == 0)) {
       row_write_stride = cinfo.output_width * 4;
       converter = RGBtoBGRA;
     } else {
@@ -594,14 +630,18 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
       return false;
     }
 
-    output->resize(row_write_stride * cinfo.output_height);
+    unsigned char* pixels =
+        output->Allocate(cinfo.output_width, cinfo.output_height,
+                         row_write_stride);
+    if (!pixels)
+      return false;
 
     scoped_ptr<unsigned char[]> row_data(new unsigned char[row_read_stride]);
     unsigned char* rowptr = row_data.get();
     for (int row = 0; row < static_cast<int>(cinfo.output_height); row++) {
       if (!jpeg_read_scanlines(&cinfo, &rowptr, 1))
         return false;
-      converter(rowptr, *w, &(*output)[row * row_write_stride]);
+      converter(rowptr, *w, pixels + row * row_write_stride);
     }
   }
 #endif
@@ -611,22 +651,24 @@ bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
   return true;
 }
 
+}  // namespace
+
+bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
+                       ColorFormat format, std::vector<unsigned char>* output,
+                       int* w, int* h) {
+  DecodeOutput decode_output(output);
+  return DecodeImpl(input, input_size, format, &decode_output, w, h);
+}
+
 // static
 SkBitmap* JPEGCodec::Decode(const unsigned char* input, size_t input_size) {
+  // Skia only handles 32 bit images, so decode straight into its pixels.
   int w, h;
-  std::vector<unsigned char> data_vector;
-  if (!Decode(input, input_size, FORMAT_SkBitmap, &data_vector, &w, &h))
+  scoped_ptr<SkBitmap> bitmap(new SkBitmap());
+  DecodeOutput decode_output(bitmap.get());
+  if (!DecodeImpl(input, input_size, FORMAT_SkBitmap, &decode_output, &w, &h))
     return NULL;
-
-  // Skia only handles 32 bit images.
-  int data_length = w * h * 4;
-
-  SkBitmap* bitmap = new SkBitmap();
-  bitmap->setConfig(SkBitmap::kARGB_8888_Config, w, h);
-  bitmap->allocPixels();
-  memcpy(bitmap->getAddr32(0, 0), &data_vector[0], data_length);
-
-  return bitmap;
+  return bitmap.release();
 }
 
 }  // namespace gfx
@@ -8,12 +8,15 @@
 #include <pango/pango.h>
 
 #include <algorithm>
+#include <map>
 #include <string>
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_split.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkString.h"
 #include "third_party/skia/include/core/SkTypeface.h"
@@ -62,6 +65,42 @@ std::string FindBestMatchFontFamilyName(
   return font_family;
 }
 
+// Caches the results of FindBestMatchFontFamilyName(), keyed by the
+// comma-separated family list of a Pango font description. Fontconfig
+// matching is expensive and the same few descriptions are converted over
+// and over, e.g. whenever a FontList is turned into a Font.
+class FamilyNameCache {
+ public:
+  FamilyNameCache() {}
+
+  std::string Lookup(const std::string& family_list) {
+    {
+      base::AutoLock lock(lock_);
+      std::map<std::string, std::string>::const_iterator it =
+          map_.find(family_list);
+      if (it != map_.end())
+        return it->second;
+    }
+
+    std::vector<std::string> family_names;
+    base::SplitString(family_list, ',', &family_names);
+    std::string font_family = FindBestMatchFontFamilyName(family_names);
+
+    base::AutoLock lock(lock_);
+    map_[family_list] = font_family;
+    return font_family;
+  }
+
+ private:
+  base::Lock lock_;
+  std::map<std::string, std::string> map_;
+
+  DISALLOW_COPY_AND_ASSIGN(FamilyNameCache);
+};
+
+base::LazyInstance<FamilyNameCache>::Leaky g_family_name_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 namespace gfx {
@@ -93,10 +132,8 @@ PlatformFontPango::PlatformFontPango() {
 }
 
 PlatformFontPango::PlatformFontPango(NativeFont native_font) {
-  std::vector<std::string> family_names;
-  base::SplitString(pango_font_description_get_family(native_font), ',',
-                    &family_names);
-  std::string font_family = FindBestMatchFontFamilyName(family_names);
+  std::string font_family = g_family_name_cache.Get().Lookup(
+      pango_font_description_get_family(native_font));
   InitWithNameAndSize(font_family, gfx::GetPangoFontSizeInPixels(native_font));
 
   int style = 0;
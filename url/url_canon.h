@@ -501,6 +501,14 @@ URL_EXPORT void CanonicalizeRef(const base::char16* spec,
 //
 // The 8-bit versions require UTF-8 encoding.
 
+// Returns true if the standard URL |spec|, as parsed by ParseStandardURL() into
+// |parsed|, is already canonical ASCII, so that canonicalizing it would give
+// the same spec and components. This only validates; it never copies. It may
+// return false for some canonical URLs, e.g. those with escape sequences.
+URL_EXPORT bool IsCanonicalStandardURL(const char* spec,
+                                       int spec_len,
+                                       const url_parse::Parsed& parsed);
+
 // Use for standard URLs with authorities and paths.
 URL_EXPORT bool CanonicalizeStandardURL(const char* spec,
                                         int spec_len,
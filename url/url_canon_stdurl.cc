@@ -89,6 +89,132 @@ bool DoCanonicalizeStandardURL(const URLComponentSource<CHAR>& source,
   return success;
 }
 
+// Flags of kCanonicalCharLookup.
+enum CanonicalCharFlags {
+  NONE = 0,
+  // The character may appear in a canonical host name.
+  HOST = 1,
+  // The character may appear unescaped in a canonical path.
+  PATH = 2,
+  BOTH = HOST | PATH,
+};
+
+// Which 7-bit characters the canonicalizer copies unchanged into the host and
+// the path. This is deliberately stricter than the canonicalizer: anything
+// which it might rewrite, like '%' sequences, upper case host names or
+// backslashes, is left out so that such URLs take the slow path.
+const unsigned char kCanonicalCharLookup[0x80] = {
+//   NULL    control chars...
+     NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE,
+//   control chars...
+     NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE, NONE,
+//   ' '   !     "     #     $     %     &     '     (     )     *     +     ,     -     .     /
+     NONE, PATH, NONE, NONE, PATH, NONE, PATH, PATH, PATH, PATH, PATH, PATH, PATH, BOTH, BOTH, PATH,
+//   0     1     2     3     4     5     6     7     8     9     :     ;     <     =     >     ?
+     BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, PATH, PATH, NONE, PATH, NONE, NONE,
+//   @     A     B     C     D     E     F     G     H     I     J     K     L     M     N     O
+     PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH,
+//   P     Q     R     S     T     U     V     W     X     Y     Z     [     \     ]     ^     _
+     PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, PATH, NONE, PATH, NONE, PATH,
+//   `     a     b     c     d     e     f     g     h     i     j     k     l     m     n     o
+     NONE, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH,
+//   p     q     r     s     t     u     v     w     x     y     z     {     |     }     ~     DEL
+     BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, BOTH, NONE, NONE, NONE, PATH, NONE,
+};
+
+inline bool IsCanonicalChar(char c, CanonicalCharFlags flag) {
+  unsigned char uc = static_cast<unsigned char>(c);
+  return uc < 0x80 && (kCanonicalCharLookup[uc] & flag);
+}
+
+bool IsCanonicalScheme(const char* spec, const url_parse::Component& scheme) {
+  if (scheme.len <= 0 || spec[scheme.begin] < 'a' || spec[scheme.begin] > 'z')
+    return false;
+  for (int i = scheme.begin + 1; i < scheme.end(); i++) {
+    char c = spec[i];
+    if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+          c == '+' || c == '-' || c == '.'))
+      return false;
+  }
+  return true;
+}
+
+// Only plain host names are accepted. A host whose last label starts with a
+// digit may be an IPv4 address in some non-canonical form, like "0x7f.1".
+bool IsCanonicalHost(const char* spec, const url_parse::Component& host) {
+  if (host.len <= 0 || spec[host.begin] == '.')
+    return false;
+  int last_label = host.begin;
+  for (int i = host.begin; i < host.end(); i++) {
+    if (!IsCanonicalChar(spec[i], HOST))
+      return false;
+    if (spec[i] == '.') {
+      if (spec[i - 1] == '.')
+        return false;
+      if (i + 1 < host.end())
+        last_label = i + 1;
+    }
+  }
+  return spec[last_label] < '0' || spec[last_label] > '9';
+}
+
+// The canonical port has no leading zeros and is omitted when it is the
+// default port of |scheme|.
+bool IsCanonicalPort(const char* spec,
+                     const url_parse::Component& scheme,
+                     const url_parse::Component& port) {
+  if (port.len <= 0 || port.len > 5 || spec[port.begin] == '0')
+    return false;
+  int port_number = 0;
+  for (int i = port.begin; i < port.end(); i++) {
+    if (spec[i] < '0' || spec[i] > '9')
+      return false;
+    port_number = port_number * 10 + (spec[i] - '0');
+  }
+  return port_number <= 65535 &&
+      port_number != DefaultPortForScheme(&spec[scheme.begin], scheme.len);
+}
+
+// Dot segments would be removed, so they aren't canonical.
+bool IsCanonicalPath(const char* spec, const url_parse::Component& path) {
+  if (path.len <= 0 || spec[path.begin] != '/')
+    return false;
+  int segment_begin = path.begin + 1;
+  for (int i = path.begin + 1; i <= path.end(); i++) {
+    if (i == path.end() || spec[i] == '/') {
+      int segment_len = i - segment_begin;
+      if ((segment_len == 1 || segment_len == 2) &&
+          spec[segment_begin] == '.' &&
+          (segment_len == 1 || spec[segment_begin + 1] == '.'))
+        return false;
+      segment_begin = i + 1;
+    } else if (!IsCanonicalChar(spec[i], PATH)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsCanonicalQuery(const char* spec, const url_parse::Component& query) {
+  for (int i = query.begin; i < query.end(); i++) {
+    unsigned char uc = static_cast<unsigned char>(spec[i]);
+    if (uc >= 0x80 || !IsQueryChar(uc))
+      return false;
+  }
+  return true;
+}
+
+// Control characters are escaped, and non-ASCII characters may be replaced
+// if they are invalid.
+bool IsCanonicalRef(const char* spec, const url_parse::Component& ref) {
+  for (int i = ref.begin; i < ref.end(); i++) {
+    unsigned char uc = static_cast<unsigned char>(spec[i]);
+    if (uc < 0x20 || uc >= 0x80)
+      return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 
@@ -123,12 +249,67 @@ int DefaultPortForScheme(const char* scheme, int scheme_len) {
   return default_port;
 }
 
+bool IsCanonicalStandardURL(const char* spec,
+                            int spec_len,
+                            const url_parse::Parsed& parsed) {
+  // The components must cover the whole spec, separated by exactly the
+  // canonical delimiters: "scheme://host[:port]/path[?query][#ref]".
+  if (parsed.scheme.begin != 0 || !IsCanonicalScheme(spec, parsed.scheme))
+    return false;
+  int cur = parsed.scheme.end();
+  if (spec_len < cur + 3 || spec[cur] != ':' || spec[cur + 1] != '/' ||
+      spec[cur + 2] != '/')
+    return false;
+  cur += 3;
+
+  if (parsed.username.is_valid() || parsed.password.is_valid())
+    return false;
+  if (parsed.host.begin != cur || !IsCanonicalHost(spec, parsed.host))
+    return false;
+  cur = parsed.host.end();
+
+  if (parsed.port.is_valid()) {
+    if (parsed.port.begin != cur + 1 ||
+        !IsCanonicalPort(spec, parsed.scheme, parsed.port))
+      return false;
+    cur = parsed.port.end();
+  }
+
+  if (parsed.path.begin != cur || !IsCanonicalPath(spec, parsed.path))
+    return false;
+  cur = parsed.path.end();
+
+  if (parsed.query.is_valid()) {
+    if (parsed.query.begin != cur + 1 || !IsCanonicalQuery(spec, parsed.query))
+      return false;
+    cur = parsed.query.end();
+  }
+
+  if (parsed.ref.is_valid()) {
+    if (parsed.ref.begin != cur + 1 || !IsCanonicalRef(spec, parsed.ref))
+      return false;
+    cur = parsed.ref.end();
+  }
+
+  return cur == spec_len;
+}
+
 bool CanonicalizeStandardURL(const char* spec,
                              int spec_len,
                              const url_parse::Parsed& parsed,
                              CharsetConverter* query_converter,
                              CanonOutput* output,
                              url_parse::Parsed* new_parsed) {
+  // Most URLs are canonical already, in which case they are copied as a whole
+  // rather than rebuilt component by component. |parsed| can only be reused
+  // as is when the copy starts at the beginning of |output|.
+  if (output->length() == 0 &&
+      IsCanonicalStandardURL(spec, spec_len, parsed)) {
+    output->Append(spec, spec_len);
+    *new_parsed = parsed;
+    return true;
+  }
+
   return DoCanonicalizeStandardURL<char, unsigned char>(
       URLComponentSource<char>(spec), parsed, query_converter,
       output, new_parsed);
@@ -0,0 +1,121 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/string16.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "url/url_canon.h"
+#include "url/url_canon_stdstring.h"
+#include "url/url_parse.h"
+
+namespace {
+
+// How many times each URL is canonicalized for timing.
+const int kIterations = 100000;
+
+// Typical canonical URLs, the common case.
+const char* const kCanonicalURLs[] = {
+  "http://www.google.com/search?q=url+parsing&ie=utf-8&oe=utf-8&aq=t&rls=org.mozilla:en-US:official&client=firefox-a",
+  "http://www.amazon.com/Stephen-King-Thrillers-Horror-People/dp/0766012336/ref=sr_1_2/133-4144931-4505264?ie=UTF8&s=books&qid=2144880915&sr=8-2",
+  "http://store.apple.com/1-800-MY-APPLE/WebObjects/AppleStore.woa/wa/RSLID?nnmm=browse&mco=578E9744&node=home/desktop/mac_pro",
+  "https://ssl.gstatic.com/gb/images/v1_76783e20.png",
+  "https://www.example.com:8443/static/js/app.js?v=20140212#main",
+};
+
+// Canonicalizes |url| with the 8-bit canonicalizer, which has the fast path
+// for canonical URLs.
+void Canonicalize8(const std::string& url, std::string* output) {
+  url_parse::Parsed parsed;
+  url_parse::ParseStandardURL(url.data(), static_cast<int>(url.size()),
+                              &parsed);
+  output->clear();
+  url_canon::StdStringCanonOutput canon_output(output);
+  url_parse::Parsed out_parsed;
+  url_canon::CanonicalizeStandardURL(url.data(), static_cast<int>(url.size()),
+                                     parsed, NULL, &canon_output, &out_parsed);
+  canon_output.Complete();
+}
+
+// Canonicalizes |url| with the 16-bit canonicalizer, which always rebuilds the
+// URL component by component.
+void Canonicalize16(const base::string16& url, std::string* output) {
+  url_parse::Parsed parsed;
+  url_parse::ParseStandardURL(url.data(), static_cast<int>(url.size()),
+                              &parsed);
+  output->clear();
+  url_canon::StdStringCanonOutput canon_output(output);
+  url_parse::Parsed out_parsed;
+  url_canon::CanonicalizeStandardURL(url.data(), static_cast<int>(url.size()),
+                                     parsed, NULL, &canon_output, &out_parsed);
+  canon_output.Complete();
+}
+
+TEST(URLPerfTest, CanonicalURLs) {
+  std::string urls[arraysize(kCanonicalURLs)];
+  base::string16 urls16[arraysize(kCanonicalURLs)];
+  // Upper case schemes aren't canonical, so these take the slow path.
+  std::string upper_case_urls[arraysize(kCanonicalURLs)];
+  for (size_t i = 0; i < arraysize(kCanonicalURLs); ++i) {
+    urls[i] = kCanonicalURLs[i];
+    urls16[i] = base::UTF8ToUTF16(urls[i]);
+    upper_case_urls[i] = urls[i];
+    for (size_t j = 0; upper_case_urls[i][j] != ':'; ++j)
+      upper_case_urls[i][j] = upper_case_urls[i][j] - 'a' + 'A';
+  }
+
+  std::string output;
+  for (size_t i = 0; i < arraysize(urls); ++i) {
+    Canonicalize8(urls[i], &output);
+    EXPECT_EQ(urls[i], output);
+    Canonicalize16(urls16[i], &output);
+    EXPECT_EQ(urls[i], output);
+    Canonicalize8(upper_case_urls[i], &output);
+    EXPECT_EQ(urls[i], output);
+  }
+
+  {
+    base::PerfTimeLogger timer("Canonicalize_canonical_fast_path");
+    for (int i = 0; i < kIterations; ++i) {
+      for (size_t j = 0; j < arraysize(urls); ++j)
+        Canonicalize8(urls[j], &output);
+    }
+    timer.Done();
+  }
+
+  {
+    base::PerfTimeLogger timer("Canonicalize_canonical_16_bit");
+    for (int i = 0; i < kIterations; ++i) {
+      for (size_t j = 0; j < arraysize(urls16); ++j)
+        Canonicalize16(urls16[j], &output);
+    }
+    timer.Done();
+  }
+
+  {
+    base::PerfTimeLogger timer("Canonicalize_upper_case_scheme");
+    for (int i = 0; i < kIterations; ++i) {
+      for (size_t j = 0; j < arraysize(upper_case_urls); ++j)
+        Canonicalize8(upper_case_urls[j], &output);
+    }
+    timer.Done();
+  }
+
+  {
+    base::PerfTimeLogger timer("GURL_canonical");
+    for (int i = 0; i < kIterations; ++i) {
+      for (size_t j = 0; j < arraysize(urls); ++j)
+        GURL gurl(urls[j]);
+    }
+    timer.Done();
+  }
+}
+
+}  // namespace
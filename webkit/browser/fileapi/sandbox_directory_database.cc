@@ -92,6 +92,10 @@ enum RepairResult {
   DB_REPAIR_MAX
 };
 
+// Bounds the memory used by SandboxDirectoryDatabase's child id cache. The
+// cache is simply dropped when it fills up.
+const size_t kMaxCachedChildIds = 1024;
+
 std::string GetChildLookupKey(
     fileapi::SandboxDirectoryDatabase::FileId parent_id,
     const base::FilePath::StringType& child_name) {
@@ -427,6 +431,12 @@ bool SandboxDirectoryDatabase::GetChildWithName(
     return false;
   DCHECK(child_id);
   std::string child_key = GetChildLookupKey(parent_id, name);
+  std::map<std::string, FileId>::const_iterator cached =
+      child_id_cache_.find(child_key);
+  if (cached != child_id_cache_.end()) {
+    *child_id = cached->second;
+    return true;
+  }
   std::string child_id_string;
   leveldb::Status status =
       db_->Get(leveldb::ReadOptions(), child_key, &child_id_string);
@@ -437,6 +447,9 @@ bool SandboxDirectoryDatabase::GetChildWithName(
       LOG(ERROR) << "Hit database corruption!";
       return false;
     }
+    if (child_id_cache_.size() >= kMaxCachedChildIds)
+      child_id_cache_.clear();
+    child_id_cache_[child_key] = *child_id;
     return true;
   }
   HandleError(FROM_HERE, status);
@@ -732,6 +745,7 @@ bool SandboxDirectoryDatabase::Init(RecoveryOption recovery_option) {
   ReportInitStatus(status);
   if (status.ok()) {
     db_.reset(db);
+    child_id_cache_.clear();
     return true;
   }
   HandleError(FROM_HERE, status);
@@ -800,6 +814,8 @@ bool SandboxDirectoryDatabase::IsDirectory(FileId file_id) {
 bool SandboxDirectoryDatabase::IsFileSystemConsistent() {
   if (!Init(FAIL_ON_CORRUPTION))
     return false;
+  // Check what is actually on disk, not what earlier lookups remembered.
+  child_id_cache_.clear();
   DatabaseCheckHelper helper(this, db_.get(), filesystem_data_directory_);
   return helper.IsFileSystemConsistent();
 }
@@ -922,7 +938,9 @@ bool SandboxDirectoryDatabase::RemoveFileInfoHelper(
       return false;
     }
   }
-  batch->Delete(GetChildLookupKey(info.parent_id, info.name));
+  std::string child_key = GetChildLookupKey(info.parent_id, info.name);
+  child_id_cache_.erase(child_key);
+  batch->Delete(child_key);
   batch->Delete(GetFileLookupKey(file_id));
   return true;
 }
@@ -5,6 +5,7 @@
 #ifndef WEBKIT_BROWSER_FILEAPI_SANDBOX_DIRECTORY_DATABASE_H_
 #define WEBKIT_BROWSER_FILEAPI_SANDBOX_DIRECTORY_DATABASE_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -123,6 +124,12 @@ class WEBKIT_STORAGE_BROWSER_EXPORT_PRIVATE SandboxDirectoryDatabase {
   leveldb::Env* env_override_;
   scoped_ptr<leveldb::DB> db_;
   base::Time last_reported_time_;
+
+  // Results of GetChildWithName() lookups that found a child, keyed by the
+  // child lookup key. Only hits are cached, so adding a file needs no
+  // invalidation; removing or moving one erases its entry.
+  std::map<std::string, FileId> child_id_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(SandboxDirectoryDatabase);
 };
 